@@ -40,6 +40,12 @@ for f in $sources; do
     echo "Building gen/bin/example-$f"
     # example/crc32 is unusual in that it's C++, not C.
     g++ -O3 example/$f/*.cc -o gen/bin/example-$f
+  elif [ $f = gifparallel ] || [ $f = pngencparallel ] ||
+       [ $f = pngparallel ] || [ $f = tiffparallel ]; then
+    echo "Building gen/bin/example-$f"
+    # example/gifparallel, example/pngencparallel, example/pngparallel and
+    # example/tiffparallel are unusual in that they use POSIX threads.
+    gcc -O3 -pthread example/$f/*.c -o gen/bin/example-$f
   elif [ $f = library ]; then
     # example/library is unusual in that it uses separately compiled libraries
     # (built by "wuffs genlib", e.g. by running build-all.sh) instead of
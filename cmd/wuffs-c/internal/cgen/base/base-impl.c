@@ -24,6 +24,8 @@
 
 // !! INSERT wuffs_base__status strings.
 
+// !! INSERT image-impl.c.
+
 #endif  // !defined(WUFFS_CONFIG__MODULES) ||
         // defined(WUFFS_CONFIG__MODULE__BASE)
 
@@ -17,6 +17,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// WUFFS_BASE__HAVE_SSE2 and WUFFS_BASE__HAVE_SSSE3 are defined when the
+// compiler targets those x86 instruction set extensions, such as SSE2 for any
+// x86_64 CPU, or SSSE3 with "-mssse3", unless WUFFS_CONFIG__NO_SIMD is
+// defined. Wuffs does not detect CPU features at run time.
+#if !defined(WUFFS_CONFIG__NO_SIMD) && defined(__SSE2__)
+#define WUFFS_BASE__HAVE_SSE2
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#define WUFFS_BASE__HAVE_SSSE3
+#include <tmmintrin.h>
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -420,6 +433,1267 @@ wuffs_base__table_u8__row(wuffs_base__table_u8 t, uint32_t y) {
   return ((wuffs_base__slice_u8){});
 }
 
+// ---------------- Unfilters
+
+// The wuffs_base__slice_u8__unfilter_etc functions undo, in place, the PNG
+// image format's per-row filters (Sub, Up, Average and Paeth), which predict
+// each byte from the byte distance bytes to its left (or zero, if there is
+// none) and from the byte above it in prev. An empty prev means that the row
+// above is all zeroes, as it is for an image's first row. Otherwise, only the
+// first min(curr.len, prev.len) bytes of curr are unfiltered. The distance is
+// the number of bytes per (whole) pixel, from 1 to 8, and zero is a no-op.
+//
+// When WUFFS_BASE__HAVE_SSE2 is defined, Average and Paeth with distances of 3
+// and 4 (RGB and RGBA) process a pixel at a time in SIMD registers. The
+// __fallback variants are portable C, used for other distances and for CPUs
+// without SSE2. Sub and Up always use them: compilers already vectorize Up,
+// and Sub's byte loop, with distance independent dependency chains, measured
+// faster than a pixel at a time SSE2 loop.
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_sub__fallback(wuffs_base__slice_u8 curr,
+                                             uint32_t distance) {
+  if ((distance == 0) || (distance > curr.len)) {
+    return;
+  }
+  uint8_t* c = curr.ptr + distance;
+  uint8_t* end = curr.ptr + curr.len;
+  for (; c < end; c++) {
+    c[0] += *(c - distance);
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_up__fallback(wuffs_base__slice_u8 curr,
+                                            wuffs_base__slice_u8 prev) {
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    curr.ptr[i] += prev.ptr[i];
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_average__fallback(wuffs_base__slice_u8 curr,
+                                                 wuffs_base__slice_u8 prev,
+                                                 uint32_t distance) {
+  if ((distance == 0) || (distance > curr.len)) {
+    return;
+  }
+  size_t i;
+  if (prev.len == 0) {
+    for (i = distance; i < curr.len; i++) {
+      curr.ptr[i] += curr.ptr[i - distance] / 2;
+    }
+    return;
+  }
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  for (i = 0; (i < distance) && (i < n); i++) {
+    curr.ptr[i] += prev.ptr[i] / 2;
+  }
+  for (; i < n; i++) {
+    curr.ptr[i] += (uint8_t)(
+        ((uint32_t)(curr.ptr[i - distance]) + (uint32_t)(prev.ptr[i])) / 2);
+  }
+}
+
+// wuffs_base__private_paeth returns whichever of a (left), b (above) and c
+// (above-left) is closest to (a + b - c), breaking ties in that order.
+static inline uint8_t  //
+wuffs_base__private_paeth(uint8_t a, uint8_t b, uint8_t c) {
+  int32_t pa = (int32_t)(b) - (int32_t)(c);
+  int32_t pb = (int32_t)(a) - (int32_t)(c);
+  int32_t pc = pa + pb;
+  pa = pa < 0 ? -pa : pa;
+  pb = pb < 0 ? -pb : pb;
+  pc = pc < 0 ? -pc : pc;
+  if ((pa <= pb) && (pa <= pc)) {
+    return a;
+  } else if (pb <= pc) {
+    return b;
+  }
+  return c;
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_paeth__fallback(wuffs_base__slice_u8 curr,
+                                               wuffs_base__slice_u8 prev,
+                                               uint32_t distance) {
+  if (prev.len == 0) {
+    // With a row of zeroes above, the Paeth predictor is the left byte.
+    wuffs_base__slice_u8__unfilter_sub__fallback(curr, distance);
+    return;
+  }
+  if ((distance == 0) || (distance > curr.len)) {
+    return;
+  }
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  size_t i;
+  for (i = 0; (i < distance) && (i < n); i++) {
+    curr.ptr[i] += prev.ptr[i];
+  }
+  for (; i < n; i++) {
+    curr.ptr[i] += wuffs_base__private_paeth(
+        curr.ptr[i - distance], prev.ptr[i], prev.ptr[i - distance]);
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_load_pixel and wuffs_base__private_store_pixel move a 3
+// or 4 byte pixel between memory and the low bytes of a SIMD register,
+// without touching any memory beyond that pixel. A 3 byte pixel is assembled
+// in a general purpose register, not via memcpy to and from the stack, as
+// mixing narrow stores with a wide load stalls store-to-load forwarding.
+static inline __m128i  //
+wuffs_base__private_load_pixel(uint8_t* p, uint32_t distance) {
+  uint32_t x = (distance == 3) ? wuffs_base__load_u24le(p)
+                               : wuffs_base__load_u32le(p);
+  return _mm_cvtsi32_si128((int)(x));
+}
+
+static inline void  //
+wuffs_base__private_store_pixel(uint8_t* p, __m128i v, uint32_t distance) {
+  uint32_t x = (uint32_t)(_mm_cvtsi128_si32(v));
+  if (distance == 3) {
+    wuffs_base__store_u24le(p, x);
+  } else {
+    wuffs_base__store_u32le(p, x);
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_average__sse2(wuffs_base__slice_u8 curr,
+                                             wuffs_base__slice_u8 prev,
+                                             uint32_t distance) {
+  __m128i one = _mm_set1_epi8(1);
+  __m128i a = _mm_setzero_si128();
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  uint8_t* c = curr.ptr;
+  uint8_t* p = prev.ptr;
+  for (; n >= distance; n -= distance, c += distance, p += distance) {
+    // _mm_avg_epu8 rounds up, but the Average filter rounds down.
+    __m128i b = wuffs_base__private_load_pixel(p, distance);
+    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                               _mm_and_si128(_mm_xor_si128(a, b), one));
+    a = _mm_add_epi8(avg, wuffs_base__private_load_pixel(c, distance));
+    wuffs_base__private_store_pixel(c, a, distance);
+  }
+  for (; n > 0; n--, c++, p++) {
+    c[0] += (uint8_t)(((uint32_t)(*(c - distance)) + p[0]) / 2);
+  }
+}
+
+static inline __m128i  //
+wuffs_base__private_abs_epi16(__m128i x) {
+#if defined(WUFFS_BASE__HAVE_SSSE3)
+  return _mm_abs_epi16(x);
+#else
+  return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+#endif
+}
+
+// wuffs_base__slice_u8__unfilter_paeth__sse2 widens each pixel's bytes to 16
+// bit lanes, so that the Paeth distances can be computed without overflow.
+static inline void  //
+wuffs_base__slice_u8__unfilter_paeth__sse2(wuffs_base__slice_u8 curr,
+                                           wuffs_base__slice_u8 prev,
+                                           uint32_t distance) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i a = zero;
+  __m128i c = zero;
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  uint8_t* q = curr.ptr;
+  uint8_t* p = prev.ptr;
+  for (; n >= distance; n -= distance, q += distance, p += distance) {
+    __m128i b = _mm_unpacklo_epi8(wuffs_base__private_load_pixel(p, distance),
+                                  zero);
+    __m128i x = _mm_unpacklo_epi8(wuffs_base__private_load_pixel(q, distance),
+                                  zero);
+    __m128i pa = _mm_sub_epi16(b, c);
+    __m128i pb = _mm_sub_epi16(a, c);
+    __m128i pc = wuffs_base__private_abs_epi16(_mm_add_epi16(pa, pb));
+    pa = wuffs_base__private_abs_epi16(pa);
+    pb = wuffs_base__private_abs_epi16(pb);
+    // Select a, else b, else c, breaking ties in that order.
+    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+    __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+    __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+    __m128i use_c = _mm_andnot_si128(_mm_or_si128(use_a, use_b),
+                                     _mm_set1_epi16(-1));
+    __m128i predictor = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),
+        _mm_and_si128(use_c, c));
+    // The high byte of each 16 bit lane is zero in both x and predictor, so
+    // a byte-wise add wraps modulo 256 and keeps those high bytes zero.
+    a = _mm_add_epi8(x, predictor);
+    c = b;
+    wuffs_base__private_store_pixel(q, _mm_packus_epi16(a, a), distance);
+  }
+  for (; n > 0; n--, q++, p++) {
+    q[0] += wuffs_base__private_paeth(*(q - distance), p[0],
+                                      *(p - distance));
+  }
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_sub(wuffs_base__slice_u8 curr,
+                                   uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_sub__fallback(curr, distance);
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_up(wuffs_base__slice_u8 curr,
+                                  wuffs_base__slice_u8 prev) {
+  wuffs_base__slice_u8__unfilter_up__fallback(curr, prev);
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_average(wuffs_base__slice_u8 curr,
+                                       wuffs_base__slice_u8 prev,
+                                       uint32_t distance) {
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  if (((distance == 3) || (distance == 4)) && (distance <= curr.len) &&
+      (distance <= prev.len)) {
+    wuffs_base__slice_u8__unfilter_average__sse2(curr, prev, distance);
+    return;
+  }
+#endif
+  wuffs_base__slice_u8__unfilter_average__fallback(curr, prev, distance);
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_paeth(wuffs_base__slice_u8 curr,
+                                     wuffs_base__slice_u8 prev,
+                                     uint32_t distance) {
+  if (prev.len == 0) {
+    // With a row of zeroes above, the Paeth predictor is the left byte.
+    wuffs_base__slice_u8__unfilter_sub(curr, distance);
+    return;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  if (((distance == 3) || (distance == 4)) && (distance <= curr.len) &&
+      (distance <= prev.len)) {
+    wuffs_base__slice_u8__unfilter_paeth__sse2(curr, prev, distance);
+    return;
+  }
+#endif
+  wuffs_base__slice_u8__unfilter_paeth__fallback(curr, prev, distance);
+}
+
+// ---------------- Filters
+
+// The wuffs_base__slice_u8__filter_etc functions apply the PNG image format's
+// per-row filters (None, Sub, Up, Average and Paeth) to curr, writing the
+// filtered bytes to dst. They are the inverse of the unfilter_etc functions,
+// with the same prev and distance conventions, except that curr is not
+// modified, dst must not overlap curr or prev, and a zero distance (for every
+// filter but None and Up) means that nothing is written. Only the first
+// min(dst.len, curr.len) bytes are filtered, or fewer if prev is non-empty
+// but shorter than that.
+//
+// They return the sum, over the filtered bytes, of each byte's absolute value
+// when read as a signed byte. Picking the filter with the smallest sum is the
+// "minimum sum of absolute differences" heuristic that the PNG specification
+// recommends, and that libpng uses by default.
+//
+// When WUFFS_BASE__HAVE_SSE2 is defined, every filter processes 16 bytes at a
+// time, for any distance. Unlike unfiltering, every filtered byte depends only
+// on the unfiltered curr and prev bytes, so there are no dependency chains.
+
+// wuffs_base__private_sum_abs_i8 returns the sum of the absolute values of
+// the n bytes at p, as signed bytes.
+static inline uint64_t  //
+wuffs_base__private_sum_abs_i8(uint8_t* p, size_t n) {
+  uint64_t sum = 0;
+  for (; n > 0; n--, p++) {
+    sum += (p[0] < 0x80) ? p[0] : (0x100 - (uint32_t)(p[0]));
+  }
+  return sum;
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_none(wuffs_base__slice_u8 dst,
+                                  wuffs_base__slice_u8 curr) {
+  size_t n = dst.len < curr.len ? dst.len : curr.len;
+  if (n > 0) {
+    memmove(dst.ptr, curr.ptr, n);
+  }
+  return wuffs_base__private_sum_abs_i8(dst.ptr, n);
+}
+
+// wuffs_base__private_filter_len returns how many bytes the filter_etc
+// functions filter.
+static inline size_t  //
+wuffs_base__private_filter_len(wuffs_base__slice_u8 dst,
+                               wuffs_base__slice_u8 curr,
+                               wuffs_base__slice_u8 prev) {
+  size_t n = dst.len < curr.len ? dst.len : curr.len;
+  if ((prev.len > 0) && (n > prev.len)) {
+    n = prev.len;
+  }
+  return n;
+}
+
+// wuffs_base__private_filter_etc_1 filters the i'th byte, for one of the
+// Sub, Up, Average and Paeth filters (numbered 1 to 4, as per the PNG
+// specification), when prev is not empty and i >= distance.
+static inline uint8_t  //
+wuffs_base__private_filter_etc_1(uint8_t* c,
+                                 uint8_t* p,
+                                 size_t i,
+                                 uint32_t distance,
+                                 uint32_t filter) {
+  switch (filter) {
+    case 1:
+      return c[i] - c[i - distance];
+    case 2:
+      return c[i] - p[i];
+    case 3:
+      return c[i] -
+             (uint8_t)(((uint32_t)(c[i - distance]) + (uint32_t)(p[i])) / 2);
+  }
+  return c[i] -
+         wuffs_base__private_paeth(c[i - distance], p[i], p[i - distance]);
+}
+
+// wuffs_base__private_filter_etc__fallback filters curr, for one of the Sub,
+// Up, Average and Paeth filters, starting at the i'th byte.
+static inline uint64_t  //
+wuffs_base__private_filter_etc__fallback(wuffs_base__slice_u8 dst,
+                                         wuffs_base__slice_u8 curr,
+                                         wuffs_base__slice_u8 prev,
+                                         uint32_t distance,
+                                         uint32_t filter,
+                                         size_t i) {
+  size_t n = wuffs_base__private_filter_len(dst, curr, prev);
+  size_t i0 = i;
+  uint8_t* d = dst.ptr;
+  uint8_t* c = curr.ptr;
+  uint8_t* p = prev.ptr;
+
+  // The first distance bytes have no left neighbor, which the filters treat
+  // as zero. So does an empty prev.
+  if (prev.len == 0) {
+    for (; i < n; i++) {
+      uint8_t a = (i >= distance) ? c[i - distance] : 0;
+      switch (filter) {
+        case 1:
+        case 4:
+          d[i] = c[i] - a;
+          break;
+        case 2:
+          d[i] = c[i];
+          break;
+        default:
+          d[i] = c[i] - (a / 2);
+          break;
+      }
+    }
+    return wuffs_base__private_sum_abs_i8(d + i0, n - i0);
+  }
+  for (; (i < distance) && (i < n); i++) {
+    switch (filter) {
+      case 1:
+        d[i] = c[i];
+        break;
+      case 3:
+        d[i] = c[i] - (p[i] / 2);
+        break;
+      default:
+        d[i] = c[i] - p[i];
+        break;
+    }
+  }
+  for (; i < n; i++) {
+    d[i] = wuffs_base__private_filter_etc_1(c, p, i, distance, filter);
+  }
+  return wuffs_base__private_sum_abs_i8(d + i0, n - i0);
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_sum_abs_i8__sse2 adds, to the two 64 bit lanes of acc,
+// the sum of the absolute values of v's 16 signed bytes.
+static inline __m128i  //
+wuffs_base__private_sum_abs_i8__sse2(__m128i acc, __m128i v) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i abs = _mm_min_epu8(v, _mm_sub_epi8(zero, v));
+  return _mm_add_epi64(acc, _mm_sad_epu8(abs, zero));
+}
+
+// wuffs_base__private_paeth_epi16 returns the Paeth predictor for 8 lanes of
+// 16 bit values, each of which holds a byte.
+static inline __m128i  //
+wuffs_base__private_paeth_epi16(__m128i a, __m128i b, __m128i c) {
+  __m128i pa = _mm_sub_epi16(b, c);
+  __m128i pb = _mm_sub_epi16(a, c);
+  __m128i pc = wuffs_base__private_abs_epi16(_mm_add_epi16(pa, pb));
+  pa = wuffs_base__private_abs_epi16(pa);
+  pb = wuffs_base__private_abs_epi16(pb);
+  // Select a, else b, else c, breaking ties in that order.
+  __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+  __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+  __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+  __m128i use_c =
+      _mm_andnot_si128(_mm_or_si128(use_a, use_b), _mm_set1_epi16(-1));
+  return _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),
+      _mm_and_si128(use_c, c));
+}
+
+// wuffs_base__private_filter_etc__sse2 is like the __fallback version, but
+// filters 16 bytes at a time. It requires a non-empty prev and, for every
+// filter other than Up, a non-zero distance.
+static inline uint64_t  //
+wuffs_base__private_filter_etc__sse2(wuffs_base__slice_u8 dst,
+                                     wuffs_base__slice_u8 curr,
+                                     wuffs_base__slice_u8 prev,
+                                     uint32_t distance,
+                                     uint32_t filter) {
+  size_t n = wuffs_base__private_filter_len(dst, curr, prev);
+  uint8_t* d = dst.ptr;
+  uint8_t* c = curr.ptr;
+  uint8_t* p = prev.ptr;
+  uint64_t sum = 0;
+  size_t i = 0;
+  if (filter != 2) {
+    // Filter the first distance bytes, which have no left neighbor.
+    wuffs_base__slice_u8 d0 = dst;
+    d0.len = n < distance ? n : distance;
+    sum = wuffs_base__private_filter_etc__fallback(d0, curr, prev, distance,
+                                                   filter, 0);
+    i = d0.len;
+  }
+
+  __m128i zero = _mm_setzero_si128();
+  __m128i one = _mm_set1_epi8(1);
+  __m128i acc = zero;
+  for (; (n - i) >= 16; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(c + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(p + i));
+    __m128i v;
+    if (filter == 2) {
+      v = _mm_sub_epi8(x, b);
+    } else {
+      __m128i a = _mm_loadu_si128((const __m128i*)(c + i - distance));
+      if (filter == 1) {
+        v = _mm_sub_epi8(x, a);
+      } else if (filter == 3) {
+        // _mm_avg_epu8 rounds up, but the Average filter rounds down.
+        __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                   _mm_and_si128(_mm_xor_si128(a, b), one));
+        v = _mm_sub_epi8(x, avg);
+      } else {
+        __m128i q = _mm_loadu_si128((const __m128i*)(p + i - distance));
+        __m128i lo = wuffs_base__private_paeth_epi16(
+            _mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero),
+            _mm_unpacklo_epi8(q, zero));
+        __m128i hi = wuffs_base__private_paeth_epi16(
+            _mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero),
+            _mm_unpackhi_epi8(q, zero));
+        v = _mm_sub_epi8(x, _mm_packus_epi16(lo, hi));
+      }
+    }
+    _mm_storeu_si128((__m128i*)(d + i), v);
+    acc = wuffs_base__private_sum_abs_i8__sse2(acc, v);
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i*)(lanes), acc);
+  sum += lanes[0] + lanes[1];
+
+  for (; i < n; i++) {
+    d[i] = wuffs_base__private_filter_etc_1(c, p, i, distance, filter);
+    sum += (d[i] < 0x80) ? d[i] : (0x100 - (uint32_t)(d[i]));
+  }
+  return sum;
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_filter_etc dispatches to the __sse2 or __fallback
+// implementation.
+static inline uint64_t  //
+wuffs_base__private_filter_etc(wuffs_base__slice_u8 dst,
+                               wuffs_base__slice_u8 curr,
+                               wuffs_base__slice_u8 prev,
+                               uint32_t distance,
+                               uint32_t filter) {
+  if ((distance == 0) && (filter != 2)) {
+    return 0;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  if (prev.len > 0) {
+    return wuffs_base__private_filter_etc__sse2(dst, curr, prev, distance,
+                                                filter);
+  }
+#endif
+  return wuffs_base__private_filter_etc__fallback(dst, curr, prev, distance,
+                                                  filter, 0);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_sub(wuffs_base__slice_u8 dst,
+                                 wuffs_base__slice_u8 curr,
+                                 uint32_t distance) {
+  // Sub does not look at prev, but the SIMD code path requires a non-empty
+  // prev. Passing curr as prev is harmless.
+  return wuffs_base__private_filter_etc(dst, curr, curr, distance, 1);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_up(wuffs_base__slice_u8 dst,
+                                wuffs_base__slice_u8 curr,
+                                wuffs_base__slice_u8 prev) {
+  return wuffs_base__private_filter_etc(dst, curr, prev, 0, 2);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_average(wuffs_base__slice_u8 dst,
+                                     wuffs_base__slice_u8 curr,
+                                     wuffs_base__slice_u8 prev,
+                                     uint32_t distance) {
+  return wuffs_base__private_filter_etc(dst, curr, prev, distance, 3);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_paeth(wuffs_base__slice_u8 dst,
+                                   wuffs_base__slice_u8 curr,
+                                   wuffs_base__slice_u8 prev,
+                                   uint32_t distance) {
+  return wuffs_base__private_filter_etc(dst, curr, prev, distance, 4);
+}
+
+// ---------------- JPEG
+
+// wuffs_base__slice_u8__idct_8x8 undoes the JPEG image format's 8×8 forward
+// DCT (Discrete Cosine Transform). coeffs holds the 64 coefficients (as signed
+// 16 bit little-endian integers) and quant the 64 quantization factors (as
+// unsigned 16 bit little-endian integers) to multiply them by, both in natural
+// (row major), not zig-zag, order. The 8×8 block of samples, level shifted by
+// +128 and clamped to the range [0, 255], is written to dst, whose rows are
+// stride bytes apart. It is a no-op if any of the slices are too short.
+//
+// The arithmetic is libjpeg's "islow" (accurate integer) algorithm, with 13
+// bits of fixed point precision and 2 extra bits between the two passes, so
+// that the output matches libjpeg's, and libjpeg-turbo's, exactly. When
+// WUFFS_BASE__HAVE_SSE2 is defined, each pass transforms all 8 columns (or
+// rows) at once, in 16 bit lanes that are widened to 32 bits for the
+// multiplications.
+//
+// Hostile input can hold arbitrary coefficients and 16 bit quantization
+// factors. Both the dequantized coefficients and the first pass's outputs
+// therefore saturate to [-0x4000, +0x3FFF], far beyond what a conforming JPEG
+// encoder produces. Within that range, no 32 bit (or, for SSE2's additions, 16
+// bit) arithmetic can overflow, so the SSE2 and fallback implementations give
+// identical output for every input.
+
+// wuffs_base__private_idct_saturate clamps v to [-0x4000, +0x3FFF].
+static inline int32_t  //
+wuffs_base__private_idct_saturate(int32_t v) {
+  return (v < -0x4000) ? -0x4000 : (v > 0x3FFF) ? 0x3FFF : v;
+}
+
+// wuffs_base__private_idct_dequantize multiplies the i16le coefficient at c by
+// the u16le quantization factor at q. The product cannot overflow an int32_t,
+// as 0x8000 * 0xFFFF < 0x80000000.
+static inline int32_t  //
+wuffs_base__private_idct_dequantize(uint8_t* c, uint8_t* q) {
+  return wuffs_base__private_idct_saturate(
+      ((int32_t)((int16_t)(wuffs_base__load_u16le(c)))) *
+      ((int32_t)(wuffs_base__load_u16le(q))));
+}
+
+static inline void  //
+wuffs_base__private_idct_1d(int32_t* v, uint32_t shift) {
+  // Even part.
+  int32_t z1 = (v[2] + v[6]) * 4433;          // FIX(0.541196100)
+  int32_t tmp2 = z1 + (v[6] * -15137);        // FIX(1.847759065)
+  int32_t tmp3 = z1 + (v[2] * 6270);          // FIX(0.765366865)
+  int32_t tmp0 = (int32_t)((uint32_t)(v[0] + v[4]) << 13);
+  int32_t tmp1 = (int32_t)((uint32_t)(v[0] - v[4]) << 13);
+  int32_t tmp10 = tmp0 + tmp3;
+  int32_t tmp13 = tmp0 - tmp3;
+  int32_t tmp11 = tmp1 + tmp2;
+  int32_t tmp12 = tmp1 - tmp2;
+
+  // Odd part.
+  tmp0 = v[7];
+  tmp1 = v[5];
+  tmp2 = v[3];
+  tmp3 = v[1];
+  z1 = tmp0 + tmp3;
+  int32_t z2 = tmp1 + tmp2;
+  int32_t z3 = tmp0 + tmp2;
+  int32_t z4 = tmp1 + tmp3;
+  int32_t z5 = (z3 + z4) * 9633;  // FIX(1.175875602)
+  tmp0 *= 2446;                   // FIX(0.298631336)
+  tmp1 *= 16819;                  // FIX(2.053119869)
+  tmp2 *= 25172;                  // FIX(3.072711026)
+  tmp3 *= 12299;                  // FIX(1.501321110)
+  z1 *= -7373;                    // FIX(0.899976223)
+  z2 *= -20995;                   // FIX(2.562915447)
+  z3 *= -16069;                   // FIX(1.961570560)
+  z4 *= -3196;                    // FIX(0.390180644)
+  z3 += z5;
+  z4 += z5;
+  tmp0 += z1 + z3;
+  tmp1 += z2 + z4;
+  tmp2 += z2 + z3;
+  tmp3 += z1 + z4;
+
+  int32_t bias = ((int32_t)1) << (shift - 1);
+  v[0] = (tmp10 + tmp3 + bias) >> shift;
+  v[7] = (tmp10 - tmp3 + bias) >> shift;
+  v[1] = (tmp11 + tmp2 + bias) >> shift;
+  v[6] = (tmp11 - tmp2 + bias) >> shift;
+  v[2] = (tmp12 + tmp1 + bias) >> shift;
+  v[5] = (tmp12 - tmp1 + bias) >> shift;
+  v[3] = (tmp13 + tmp0 + bias) >> shift;
+  v[4] = (tmp13 - tmp0 + bias) >> shift;
+}
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8__fallback(wuffs_base__slice_u8 dst,
+                                         uint64_t stride,
+                                         wuffs_base__slice_u8 coeffs,
+                                         wuffs_base__slice_u8 quant) {
+  int32_t ws[64];
+  int32_t v[8];
+  int x;
+  int y;
+  int k;
+
+  // Pass 1: process columns, dequantizing the input and storing the
+  // (saturated) result, scaled up by 2 bits, in the ws work space.
+  for (x = 0; x < 8; x++) {
+    for (k = 0; k < 8; k++) {
+      v[k] = wuffs_base__private_idct_dequantize(
+          coeffs.ptr + (2 * ((8 * k) + x)), quant.ptr + (2 * ((8 * k) + x)));
+    }
+    wuffs_base__private_idct_1d(v, 11);
+    for (k = 0; k < 8; k++) {
+      ws[(8 * k) + x] = wuffs_base__private_idct_saturate(v[k]);
+    }
+  }
+
+  // Pass 2: process rows, from the work space to dst.
+  for (y = 0; y < 8; y++) {
+    for (k = 0; k < 8; k++) {
+      v[k] = ws[(8 * y) + k];
+    }
+    wuffs_base__private_idct_1d(v, 18);
+    uint8_t* d = dst.ptr + (y * stride);
+    for (k = 0; k < 8; k++) {
+      int32_t s = v[k] + 128;
+      d[k] = (s < 0) ? 0 : (s > 255) ? 255 : ((uint8_t)s);
+    }
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__private_transpose_8x8_epi16(__m128i* r) {
+  __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+  __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+  __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+  __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+  __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+  __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+  __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+  __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+  __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+  __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+  __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+  __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+  __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+  __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+  __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+  __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+  r[0] = _mm_unpacklo_epi64(b0, b4);
+  r[1] = _mm_unpackhi_epi64(b0, b4);
+  r[2] = _mm_unpacklo_epi64(b1, b5);
+  r[3] = _mm_unpackhi_epi64(b1, b5);
+  r[4] = _mm_unpacklo_epi64(b2, b6);
+  r[5] = _mm_unpackhi_epi64(b2, b6);
+  r[6] = _mm_unpacklo_epi64(b3, b7);
+  r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// wuffs_base__private_idct_1d__sse2 is wuffs_base__private_idct_1d for 8
+// independent lanes: v[k] holds every lane's k'th input (and output). The
+// multiplications are paired up, as _mm_madd_epi16 computes (a*b + c*d), by
+// folding the shared z1 .. z5 terms into per-input constants.
+static inline void  //
+wuffs_base__private_idct_1d__sse2(__m128i* v, int shift) {
+  const __m128i k_tmp3 = _mm_set_epi16(4433, 10703, 4433, 10703,  //
+                                       4433, 10703, 4433, 10703);
+  const __m128i k_tmp2 = _mm_set_epi16(-10704, 4433, -10704, 4433,  //
+                                       -10704, 4433, -10704, 4433);
+  const __m128i k_z3 = _mm_set_epi16(9633, -6436, 9633, -6436,  //
+                                     9633, -6436, 9633, -6436);
+  const __m128i k_z4 = _mm_set_epi16(6437, 9633, 6437, 9633,  //
+                                     6437, 9633, 6437, 9633);
+  const __m128i k_tmp0 = _mm_set_epi16(-7373, -4927, -7373, -4927,  //
+                                       -7373, -4927, -7373, -4927);
+  const __m128i k_tmp3o = _mm_set_epi16(4926, -7373, 4926, -7373,  //
+                                        4926, -7373, 4926, -7373);
+  const __m128i k_tmp1 = _mm_set_epi16(-20995, -4176, -20995, -4176,  //
+                                       -20995, -4176, -20995, -4176);
+  const __m128i k_tmp2o = _mm_set_epi16(4177, -20995, 4177, -20995,  //
+                                        4177, -20995, 4177, -20995);
+  const __m128i bias = _mm_set1_epi32(1 << (shift - 1));
+  const __m128i zero = _mm_setzero_si128();
+
+  // Even part.
+  __m128i p26l = _mm_unpacklo_epi16(v[2], v[6]);
+  __m128i p26h = _mm_unpackhi_epi16(v[2], v[6]);
+  __m128i tmp3l = _mm_madd_epi16(p26l, k_tmp3);
+  __m128i tmp3h = _mm_madd_epi16(p26h, k_tmp3);
+  __m128i tmp2l = _mm_madd_epi16(p26l, k_tmp2);
+  __m128i tmp2h = _mm_madd_epi16(p26h, k_tmp2);
+
+  // Shifting the 16 bit (v[0] ± v[4]) into the top of a 32 bit lane and then
+  // arithmetic shifting right by 3 is a sign-extending shift left by 13.
+  __m128i s04 = _mm_add_epi16(v[0], v[4]);
+  __m128i d04 = _mm_sub_epi16(v[0], v[4]);
+  __m128i tmp0l = _mm_srai_epi32(_mm_unpacklo_epi16(zero, s04), 3);
+  __m128i tmp0h = _mm_srai_epi32(_mm_unpackhi_epi16(zero, s04), 3);
+  __m128i tmp1l = _mm_srai_epi32(_mm_unpacklo_epi16(zero, d04), 3);
+  __m128i tmp1h = _mm_srai_epi32(_mm_unpackhi_epi16(zero, d04), 3);
+
+  __m128i tmp10l = _mm_add_epi32(tmp0l, tmp3l);
+  __m128i tmp10h = _mm_add_epi32(tmp0h, tmp3h);
+  __m128i tmp13l = _mm_sub_epi32(tmp0l, tmp3l);
+  __m128i tmp13h = _mm_sub_epi32(tmp0h, tmp3h);
+  __m128i tmp11l = _mm_add_epi32(tmp1l, tmp2l);
+  __m128i tmp11h = _mm_add_epi32(tmp1h, tmp2h);
+  __m128i tmp12l = _mm_sub_epi32(tmp1l, tmp2l);
+  __m128i tmp12h = _mm_sub_epi32(tmp1h, tmp2h);
+
+  // Odd part.
+  __m128i z3 = _mm_add_epi16(v[7], v[3]);
+  __m128i z4 = _mm_add_epi16(v[5], v[1]);
+  __m128i p34l = _mm_unpacklo_epi16(z3, z4);
+  __m128i p34h = _mm_unpackhi_epi16(z3, z4);
+  __m128i z3l = _mm_madd_epi16(p34l, k_z3);
+  __m128i z3h = _mm_madd_epi16(p34h, k_z3);
+  __m128i z4l = _mm_madd_epi16(p34l, k_z4);
+  __m128i z4h = _mm_madd_epi16(p34h, k_z4);
+
+  __m128i p71l = _mm_unpacklo_epi16(v[7], v[1]);
+  __m128i p71h = _mm_unpackhi_epi16(v[7], v[1]);
+  __m128i p53l = _mm_unpacklo_epi16(v[5], v[3]);
+  __m128i p53h = _mm_unpackhi_epi16(v[5], v[3]);
+  __m128i o0l = _mm_add_epi32(_mm_madd_epi16(p71l, k_tmp0), z3l);
+  __m128i o0h = _mm_add_epi32(_mm_madd_epi16(p71h, k_tmp0), z3h);
+  __m128i o3l = _mm_add_epi32(_mm_madd_epi16(p71l, k_tmp3o), z4l);
+  __m128i o3h = _mm_add_epi32(_mm_madd_epi16(p71h, k_tmp3o), z4h);
+  __m128i o1l = _mm_add_epi32(_mm_madd_epi16(p53l, k_tmp1), z4l);
+  __m128i o1h = _mm_add_epi32(_mm_madd_epi16(p53h, k_tmp1), z4h);
+  __m128i o2l = _mm_add_epi32(_mm_madd_epi16(p53l, k_tmp2o), z3l);
+  __m128i o2h = _mm_add_epi32(_mm_madd_epi16(p53h, k_tmp2o), z3h);
+
+#define WUFFS_BASE__PRIVATE_IDCT_OUT(i, j, a, b)                             \
+  v[i] = _mm_packs_epi32(                                                    \
+      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(a##l, b##l), bias), shift), \
+      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(a##h, b##h), bias), shift)); \
+  v[j] = _mm_packs_epi32(                                                    \
+      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(a##l, b##l), bias), shift), \
+      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(a##h, b##h), bias), shift))
+
+  WUFFS_BASE__PRIVATE_IDCT_OUT(0, 7, tmp10, o3);
+  WUFFS_BASE__PRIVATE_IDCT_OUT(1, 6, tmp11, o2);
+  WUFFS_BASE__PRIVATE_IDCT_OUT(2, 5, tmp12, o1);
+  WUFFS_BASE__PRIVATE_IDCT_OUT(3, 4, tmp13, o0);
+
+#undef WUFFS_BASE__PRIVATE_IDCT_OUT
+}
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8__sse2(wuffs_base__slice_u8 dst,
+                                     uint64_t stride,
+                                     wuffs_base__slice_u8 coeffs,
+                                     wuffs_base__slice_u8 quant) {
+  const __m128i k7FFF = _mm_set1_epi16(0x7FFF);
+  const __m128i lo = _mm_set1_epi16(-0x4000);
+  const __m128i hi = _mm_set1_epi16(+0x3FFF);
+  __m128i v[8];
+  int k;
+  for (k = 0; k < 8; k++) {
+    // Dequantize to 32 bits and saturate, as the fallback implementation
+    // does. _mm_mulhi_epi16 is a signed multiply, so quantization factors of
+    // 0x8000 or more are first replaced by 0x7FFF. As every non-zero
+    // coefficient's product saturates either way, this does not change the
+    // result.
+    __m128i c = _mm_loadu_si128((const __m128i*)(coeffs.ptr + (16 * k)));
+    __m128i q = _mm_loadu_si128((const __m128i*)(quant.ptr + (16 * k)));
+    __m128i m = _mm_srai_epi16(q, 15);
+    q = _mm_or_si128(_mm_andnot_si128(m, q), _mm_and_si128(m, k7FFF));
+    __m128i pl = _mm_mullo_epi16(c, q);
+    __m128i ph = _mm_mulhi_epi16(c, q);
+    v[k] = _mm_packs_epi32(_mm_unpacklo_epi16(pl, ph),
+                           _mm_unpackhi_epi16(pl, ph));
+    v[k] = _mm_max_epi16(_mm_min_epi16(v[k], hi), lo);
+  }
+  wuffs_base__private_idct_1d__sse2(v, 11);
+  for (k = 0; k < 8; k++) {
+    v[k] = _mm_max_epi16(_mm_min_epi16(v[k], hi), lo);
+  }
+  wuffs_base__private_transpose_8x8_epi16(v);
+  wuffs_base__private_idct_1d__sse2(v, 18);
+  wuffs_base__private_transpose_8x8_epi16(v);
+  const __m128i k128 = _mm_set1_epi16(128);
+  for (k = 0; k < 8; k++) {
+    __m128i s = _mm_adds_epi16(v[k], k128);
+    _mm_storel_epi64((__m128i*)(dst.ptr + (k * stride)),
+                     _mm_packus_epi16(s, s));
+  }
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8(wuffs_base__slice_u8 dst,
+                               uint64_t stride,
+                               wuffs_base__slice_u8 coeffs,
+                               wuffs_base__slice_u8 quant) {
+  if ((coeffs.len < 128) || (quant.len < 128) || (dst.len < 8) ||
+      (stride > ((dst.len - 8) / 7))) {
+    return;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  wuffs_base__slice_u8__idct_8x8__sse2(dst, stride, coeffs, quant);
+#else
+  wuffs_base__slice_u8__idct_8x8__fallback(dst, stride, coeffs, quant);
+#endif
+}
+
+// wuffs_base__slice_u8__idct_8x8_downscaled is like
+// wuffs_base__slice_u8__idct_8x8 but, for a shift of 1, 2 or 3, it writes a
+// 4×4, 2×2 or 1×1 block of samples: the 8×8 block downscaled by (1 << shift)
+// in each dimension. It only computes those samples, and only looks at the
+// coefficients that contribute to them. A shift of 0 is the same as
+// wuffs_base__slice_u8__idct_8x8.
+//
+// The arithmetic is that of libjpeg's jpeg_idct_4x4, jpeg_idct_2x2 and
+// jpeg_idct_1x1 (in jidctred.c), which libjpeg uses when decoding with a
+// scale_denom of 2, 4 or 8, so that the output matches libjpeg's exactly. As
+// for the full size IDCT, the dequantized coefficients and the first pass's
+// outputs saturate to [-0x4000, +0x3FFF], so that no intermediate value can
+// overflow.
+
+static inline uint8_t  //
+wuffs_base__private_idct_clamp(int32_t v, uint32_t shift) {
+  int32_t s = ((v + (((int32_t)1) << (shift - 1))) >> shift) + 128;
+  return (s < 0) ? 0 : (s > 255) ? 255 : ((uint8_t)s);
+}
+
+static inline void  //
+wuffs_base__private_idct_4x4(uint8_t* dst,
+                             uint64_t stride,
+                             uint8_t* coeffs,
+                             uint8_t* quant) {
+  int32_t ws[32];
+  int32_t v[8];
+  int x;
+  int y;
+  int k;
+
+  // Pass 1: process columns, other than column 4, which the second pass
+  // ignores. Rows 0 .. 3 of the ws work space hold the 4 outputs.
+  for (x = 0; x < 8; x++) {
+    if (x == 4) {
+      continue;
+    }
+    for (k = 0; k < 8; k++) {
+      v[k] = wuffs_base__private_idct_dequantize(coeffs + (2 * ((8 * k) + x)),
+                                                 quant + (2 * ((8 * k) + x)));
+    }
+    int32_t tmp0 = (int32_t)((uint32_t)(v[0]) << 14);
+    int32_t tmp2 = (v[2] * 15137) + (v[6] * -6270);
+    int32_t tmp10 = tmp0 + tmp2;
+    int32_t tmp12 = tmp0 - tmp2;
+    tmp0 = (v[7] * -1730) + (v[5] * 11893) + (v[3] * -17799) + (v[1] * 8697);
+    tmp2 = (v[7] * -4176) + (v[5] * -4926) + (v[3] * 7373) + (v[1] * 20995);
+    ws[(8 * 0) + x] =
+        wuffs_base__private_idct_saturate((tmp10 + tmp2 + (1 << 11)) >> 12);
+    ws[(8 * 3) + x] =
+        wuffs_base__private_idct_saturate((tmp10 - tmp2 + (1 << 11)) >> 12);
+    ws[(8 * 1) + x] =
+        wuffs_base__private_idct_saturate((tmp12 + tmp0 + (1 << 11)) >> 12);
+    ws[(8 * 2) + x] =
+        wuffs_base__private_idct_saturate((tmp12 - tmp0 + (1 << 11)) >> 12);
+  }
+
+  // Pass 2: process rows, from the work space to dst.
+  for (y = 0; y < 4; y++) {
+    int32_t* w = ws + (8 * y);
+    int32_t tmp0 = (int32_t)((uint32_t)(w[0]) << 14);
+    int32_t tmp2 = (w[2] * 15137) + (w[6] * -6270);
+    int32_t tmp10 = tmp0 + tmp2;
+    int32_t tmp12 = tmp0 - tmp2;
+    tmp0 = (w[7] * -1730) + (w[5] * 11893) + (w[3] * -17799) + (w[1] * 8697);
+    tmp2 = (w[7] * -4176) + (w[5] * -4926) + (w[3] * 7373) + (w[1] * 20995);
+    uint8_t* d = dst + (y * stride);
+    d[0] = wuffs_base__private_idct_clamp(tmp10 + tmp2, 19);
+    d[3] = wuffs_base__private_idct_clamp(tmp10 - tmp2, 19);
+    d[1] = wuffs_base__private_idct_clamp(tmp12 + tmp0, 19);
+    d[2] = wuffs_base__private_idct_clamp(tmp12 - tmp0, 19);
+  }
+}
+
+static inline void  //
+wuffs_base__private_idct_2x2(uint8_t* dst,
+                             uint64_t stride,
+                             uint8_t* coeffs,
+                             uint8_t* quant) {
+  int32_t ws[16];
+  int32_t v[8];
+  int x;
+  int y;
+  int k;
+
+  // Pass 1: process columns 0, 1, 3, 5 and 7, the only ones that the second
+  // pass uses. Rows 0 and 1 of the ws work space hold the 2 outputs.
+  for (x = 0; x < 8; x++) {
+    if ((x == 2) || (x == 4) || (x == 6)) {
+      continue;
+    }
+    for (k = 0; k < 8; k++) {
+      v[k] = wuffs_base__private_idct_dequantize(coeffs + (2 * ((8 * k) + x)),
+                                                 quant + (2 * ((8 * k) + x)));
+    }
+    int32_t tmp10 = (int32_t)((uint32_t)(v[0]) << 15);
+    int32_t tmp0 =
+        (v[7] * -5906) + (v[5] * 6967) + (v[3] * -10426) + (v[1] * 29692);
+    ws[(8 * 0) + x] =
+        wuffs_base__private_idct_saturate((tmp10 + tmp0 + (1 << 12)) >> 13);
+    ws[(8 * 1) + x] =
+        wuffs_base__private_idct_saturate((tmp10 - tmp0 + (1 << 12)) >> 13);
+  }
+
+  // Pass 2: process rows, from the work space to dst.
+  for (y = 0; y < 2; y++) {
+    int32_t* w = ws + (8 * y);
+    int32_t tmp10 = (int32_t)((uint32_t)(w[0]) << 15);
+    int32_t tmp0 =
+        (w[7] * -5906) + (w[5] * 6967) + (w[3] * -10426) + (w[1] * 29692);
+    uint8_t* d = dst + (y * stride);
+    d[0] = wuffs_base__private_idct_clamp(tmp10 + tmp0, 20);
+    d[1] = wuffs_base__private_idct_clamp(tmp10 - tmp0, 20);
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8_downscaled(wuffs_base__slice_u8 dst,
+                                          uint64_t stride,
+                                          wuffs_base__slice_u8 coeffs,
+                                          wuffs_base__slice_u8 quant,
+                                          uint32_t shift) {
+  if (shift == 0) {
+    wuffs_base__slice_u8__idct_8x8(dst, stride, coeffs, quant);
+    return;
+  }
+  uint64_t n = ((uint64_t)8) >> (shift & 3);
+  if ((shift > 3) || (coeffs.len < 128) || (quant.len < 128) ||
+      (dst.len < n) || ((n > 1) && (stride > ((dst.len - n) / (n - 1))))) {
+    return;
+  }
+  if (shift == 1) {
+    wuffs_base__private_idct_4x4(dst.ptr, stride, coeffs.ptr, quant.ptr);
+  } else if (shift == 2) {
+    wuffs_base__private_idct_2x2(dst.ptr, stride, coeffs.ptr, quant.ptr);
+  } else {
+    dst.ptr[0] = wuffs_base__private_idct_clamp(
+        wuffs_base__private_idct_dequantize(coeffs.ptr, quant.ptr), 3);
+  }
+}
+
+// wuffs_base__slice_u8__convert_ycc converts a row of JPEG's YCbCr samples to
+// pixfmt, one of WUFFS_BASE__PIXEL_FORMAT__BGR, BGRA_NONPREMUL, BGRX, RGB,
+// RGBA_NONPREMUL or RGBX. Empty cb and cr mean a gray (Y only) row. Otherwise,
+// the chroma rows are upsampled per the upsample argument, using the same
+// triangle filters as libjpeg's "fancy upsampling":
+//  - 0 means none: cb and cr are as wide as y.
+//  - 1 means 2× horizontally ("h2v1").
+//  - 2 and 3 mean 2× vertically ("h1v2"), where cb_far and cr_far are the
+//    chroma rows above (2) or below (3) the nearest ones, cb and cr.
+//  - 4 means 2× in both directions ("h2v2"), with cb_far and cr_far as per 2
+//    and 3, whichever is further away from this row.
+// Horizontal upsampling needs at least 2 chroma samples per row. The number of
+// pixels converted is bounded by y.len, by dst.len and by the chroma lengths.
+//
+// The color conversion is libjpeg's: 16 bit fixed point, with rounding. When
+// WUFFS_BASE__HAVE_SSE2 is defined, 4 byte per pixel formats are converted 8
+// pixels at a time, with the multiplications by 1.402 and 1.772 split into
+// exact (integer) and fractional parts so that they fit in 16 bit lanes.
+
+static inline void  //
+wuffs_base__private_upsample_ycc(uint8_t* out,
+                                 wuffs_base__slice_u8 near,
+                                 wuffs_base__slice_u8 far,
+                                 uint32_t upsample,
+                                 size_t x0,
+                                 size_t n) {
+  size_t cw = near.len;
+  size_t i;
+  switch (upsample) {
+    case 0:
+      memcpy(out, near.ptr + x0, n);
+      break;
+
+    case 1:
+      for (i = 0; i < n; i++) {
+        size_t xo = x0 + i;
+        size_t c = xo >> 1;
+        uint32_t v = 3 * (uint32_t)(near.ptr[c]);
+        if ((xo & 1) == 0) {
+          out[i] = (c == 0) ? near.ptr[0]
+                            : (uint8_t)((v + near.ptr[c - 1] + 1) >> 2);
+        } else {
+          out[i] = (c + 1 >= cw) ? near.ptr[c]
+                                 : (uint8_t)((v + near.ptr[c + 1] + 2) >> 2);
+        }
+      }
+      break;
+
+    case 2:
+    case 3: {
+      uint32_t bias = upsample - 1;
+      for (i = 0; i < n; i++) {
+        out[i] = (uint8_t)((3 * (uint32_t)(near.ptr[x0 + i]) +
+                            (uint32_t)(far.ptr[x0 + i]) + bias) >>
+                           2);
+      }
+      break;
+    }
+
+    case 4:
+      for (i = 0; i < n; i++) {
+        size_t xo = x0 + i;
+        size_t c = xo >> 1;
+        uint32_t v = 3 * (uint32_t)(near.ptr[c]) + (uint32_t)(far.ptr[c]);
+        if ((xo & 1) == 0) {
+          if (c == 0) {
+            out[i] = (uint8_t)(((4 * v) + 8) >> 4);
+          } else {
+            uint32_t w = 3 * (uint32_t)(near.ptr[c - 1]) +
+                         (uint32_t)(far.ptr[c - 1]);
+            out[i] = (uint8_t)(((3 * v) + w + 8) >> 4);
+          }
+        } else {
+          if (c + 1 >= cw) {
+            out[i] = (uint8_t)(((4 * v) + 7) >> 4);
+          } else {
+            uint32_t w = 3 * (uint32_t)(near.ptr[c + 1]) +
+                         (uint32_t)(far.ptr[c + 1]);
+            out[i] = (uint8_t)(((3 * v) + w + 7) >> 4);
+          }
+        }
+      }
+      break;
+  }
+}
+
+static inline void  //
+wuffs_base__private_convert_ycc__fallback(uint8_t* d,
+                                          size_t bpp,
+                                          bool rgb,
+                                          uint8_t* y,
+                                          uint8_t* cb,
+                                          uint8_t* cr,
+                                          size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    int32_t yy = y[i];
+    int32_t u = ((int32_t)(cb[i])) - 128;
+    int32_t v = ((int32_t)(cr[i])) - 128;
+    int32_t r = yy + (((91881 * v) + 32768) >> 16);
+    int32_t g = yy + (((-22554 * u) - (46802 * v) + 32768) >> 16);
+    int32_t b = yy + (((116130 * u) + 32768) >> 16);
+    r = (r < 0) ? 0 : (r > 255) ? 255 : r;
+    g = (g < 0) ? 0 : (g > 255) ? 255 : g;
+    b = (b < 0) ? 0 : (b > 255) ? 255 : b;
+    d[0] = (uint8_t)(rgb ? r : b);
+    d[1] = (uint8_t)(g);
+    d[2] = (uint8_t)(rgb ? b : r);
+    if (bpp == 4) {
+      d[3] = 0xFF;
+    }
+    d += bpp;
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__private_convert_ycc__sse2(uint8_t* d,
+                                      bool rgb,
+                                      uint8_t* y,
+                                      uint8_t* cb,
+                                      uint8_t* cr,
+                                      size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i k128 = _mm_set1_epi16(128);
+  const __m128i k_r = _mm_set_epi16(-32768, 26345, -32768, 26345,  //
+                                    -32768, 26345, -32768, 26345);
+  const __m128i k_b = _mm_set_epi16(-32768, -14942, -32768, -14942,  //
+                                    -32768, -14942, -32768, -14942);
+  const __m128i k_g = _mm_set_epi16(18734, -22554, 18734, -22554,  //
+                                    18734, -22554, 18734, -22554);
+  const __m128i half = _mm_set1_epi32(32768);
+  const __m128i neg1 = _mm_set1_epi16(-1);
+  const __m128i alpha = _mm_set1_epi8(-1);
+
+  for (; n >= 8; n -= 8) {
+    __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)y), zero);
+    __m128i u = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cb), zero), k128);
+    __m128i v = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cr), zero), k128);
+
+    // 91881 = 65536 + 26345 and 116130 = 131072 - 14942. Pairing each
+    // chroma sample with -1, times -32768, adds the 32768 rounding bias.
+    __m128i vl = _mm_unpacklo_epi16(v, neg1);
+    __m128i vh = _mm_unpackhi_epi16(v, neg1);
+    __m128i ul = _mm_unpacklo_epi16(u, neg1);
+    __m128i uh = _mm_unpackhi_epi16(u, neg1);
+    __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(vl, k_r), 16),
+                                _mm_srai_epi32(_mm_madd_epi16(vh, k_r), 16));
+    __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(ul, k_b), 16),
+                                _mm_srai_epi32(_mm_madd_epi16(uh, k_b), 16));
+    r = _mm_add_epi16(_mm_add_epi16(r, v), yy);
+    b = _mm_add_epi16(_mm_add_epi16(b, _mm_add_epi16(u, u)), yy);
+
+    // -46802 = -65536 + 18734.
+    __m128i uvl = _mm_unpacklo_epi16(u, v);
+    __m128i uvh = _mm_unpackhi_epi16(u, v);
+    __m128i g = _mm_packs_epi32(
+        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvl, k_g), half), 16),
+        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvh, k_g), half), 16));
+    g = _mm_add_epi16(_mm_sub_epi16(g, v), yy);
+
+    __m128i c0 = _mm_packus_epi16(rgb ? r : b, rgb ? r : b);
+    __m128i c2 = _mm_packus_epi16(rgb ? b : r, rgb ? b : r);
+    __m128i c1 = _mm_packus_epi16(g, g);
+    __m128i c01 = _mm_unpacklo_epi8(c0, c1);
+    __m128i c23 = _mm_unpacklo_epi8(c2, alpha);
+    _mm_storeu_si128((__m128i*)(d + 0), _mm_unpacklo_epi16(c01, c23));
+    _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(c01, c23));
+
+    d += 32;
+    y += 8;
+    cb += 8;
+    cr += 8;
+  }
+  wuffs_base__private_convert_ycc__fallback(d, 4, rgb, y, cb, cr, n);
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__slice_u8__convert_ycc(wuffs_base__slice_u8 dst,
+                                  wuffs_base__slice_u8 y,
+                                  wuffs_base__slice_u8 cb,
+                                  wuffs_base__slice_u8 cr,
+                                  wuffs_base__slice_u8 cb_far,
+                                  wuffs_base__slice_u8 cr_far,
+                                  uint32_t pixfmt,
+                                  uint32_t upsample) {
+  size_t bpp = 4;
+  bool rgb = false;
+  switch (pixfmt) {
+    case WUFFS_BASE__PIXEL_FORMAT__BGR:
+      bpp = 3;
+      break;
+    case WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__BGRX:
+      break;
+    case WUFFS_BASE__PIXEL_FORMAT__RGB:
+      bpp = 3;
+      rgb = true;
+      break;
+    case WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__RGBX:
+      rgb = true;
+      break;
+    default:
+      return;
+  }
+
+  size_t n = y.len < (dst.len / bpp) ? y.len : (dst.len / bpp);
+  uint8_t* d = dst.ptr;
+  size_t i;
+
+  if ((cb.len == 0) || (cr.len == 0)) {
+    for (i = 0; i < n; i++) {
+      d[0] = y.ptr[i];
+      d[1] = y.ptr[i];
+      d[2] = y.ptr[i];
+      if (bpp == 4) {
+        d[3] = 0xFF;
+      }
+      d += bpp;
+    }
+    return;
+  }
+
+  if (upsample > 4) {
+    return;
+  }
+  if (cr.len < cb.len) {
+    cb.len = cr.len;
+  } else {
+    cr.len = cb.len;
+  }
+  if (upsample >= 2) {
+    if ((cb_far.len < cb.len) || (cr_far.len < cb.len)) {
+      return;
+    }
+  }
+  size_t max_n = cb.len;
+  if ((upsample == 1) || (upsample == 4)) {
+    if (cb.len < 2) {
+      return;
+    }
+    max_n *= 2;
+  }
+  if (n > max_n) {
+    n = max_n;
+  }
+
+  // Upsample and convert in chunks, so that the upsampled chroma fits in
+  // fixed size buffers on the stack.
+  uint8_t ubuf[64];
+  uint8_t vbuf[64];
+  size_t x0;
+  for (x0 = 0; x0 < n; x0 += 64) {
+    size_t m = (n - x0) < 64 ? (n - x0) : 64;
+    uint8_t* u = cb.ptr + x0;
+    uint8_t* v = cr.ptr + x0;
+    if (upsample != 0) {
+      wuffs_base__private_upsample_ycc(ubuf, cb, cb_far, upsample, x0, m);
+      wuffs_base__private_upsample_ycc(vbuf, cr, cr_far, upsample, x0, m);
+      u = ubuf;
+      v = vbuf;
+    }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+    if (bpp == 4) {
+      wuffs_base__private_convert_ycc__sse2(d, rgb, y.ptr + x0, u, v, m);
+      d += 4 * m;
+      continue;
+    }
+#endif
+    wuffs_base__private_convert_ycc__fallback(d, bpp, rgb, y.ptr + x0, u, v,
+                                              m);
+    d += bpp * m;
+  }
+}
+
 // ---------------- Utility
 
 static inline wuffs_base__range_ii_u32  //
@@ -498,9 +1772,9 @@ wuffs_base__io_buffer__is_valid(wuffs_base__io_buffer buf) {
          (buf.data.len >= buf.meta.wi) && (buf.meta.wi >= buf.meta.ri);
 }
 
-// TODO: wuffs_base__io_reader__is_eof is no longer used by Wuffs per se, but
-// it might be handy to programs that use Wuffs. Either delete it, or promote
-// it to the public API.
+// wuffs_base__io_reader__is_eof implements the Wuffs io_reader.is_eof method,
+// used by encoders (and by decoders of formats without an end marker, such as
+// PackBits) to distinguish "no more input yet" from "no more input".
 //
 // If making this function public (i.e. moving it to base-header.h), it also
 // needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.
@@ -664,6 +1938,28 @@ wuffs_base__io_writer__copy_n_from_slice(uint8_t** ptr_ioptr_w,
   return n;
 }
 
+static inline wuffs_base__empty_struct  //
+wuffs_base__io_reader__set(wuffs_base__io_reader* o,
+                           wuffs_base__io_buffer* b,
+                           uint8_t** ioptr1_ptr,
+                           uint8_t** ioptr2_ptr,
+                           wuffs_base__slice_u8 s,
+                           bool closed) {
+  b->data.ptr = s.ptr;
+  b->data.len = s.len;
+  b->meta.wi = s.len;
+  b->meta.ri = 0;
+  b->meta.pos = 0;
+  b->meta.closed = closed;
+
+  o->private_impl.buf = b;
+  o->private_impl.mark = s.ptr;
+  o->private_impl.limit = s.ptr + s.len;
+  *ioptr1_ptr = s.ptr;
+  *ioptr2_ptr = s.ptr + s.len;
+  return ((wuffs_base__empty_struct){});
+}
+
 static inline wuffs_base__empty_struct  //
 wuffs_base__io_reader__set_limit(wuffs_base__io_reader* o,
                                  uint8_t* ioptr_r,
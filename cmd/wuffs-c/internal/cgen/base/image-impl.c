@@ -0,0 +1,755 @@
+// After editing this file, run "go generate" in the parent directory.
+
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// ---------------- Resampler
+
+// The filter weights are fixed point, with 14 fractional bits, so that a
+// weight times an 8 bit sample, summed over a pair of taps, fits in the 32 bit
+// lanes of SSE2's pmaddwd.
+#define WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT 14
+#define WUFFS_BASE__PRIVATE_RESAMPLER_ONE (1 << 14)
+#define WUFFS_BASE__PRIVATE_RESAMPLER_HALF (1 << 13)
+
+#define WUFFS_BASE__PRIVATE_RESAMPLER_PI 3.14159265358979323846
+
+// wuffs_base__private_resampler_sin approximates sin(x), for |x| up to a few
+// multiples of pi, closely enough for 14 bit weights, without needing libm.
+static inline double  //
+wuffs_base__private_resampler_sin(double x) {
+  const double pi = WUFFS_BASE__PRIVATE_RESAMPLER_PI;
+  while (x > pi) {
+    x -= 2 * pi;
+  }
+  while (x < -pi) {
+    x += 2 * pi;
+  }
+  if (x > (pi / 2)) {
+    x = pi - x;
+  } else if (x < -(pi / 2)) {
+    x = -pi - x;
+  }
+  double x2 = x * x;
+  return x * (1 - (x2 / 6) *
+                      (1 - (x2 / 20) *
+                               (1 - (x2 / 42) *
+                                        (1 - (x2 / 72) * (1 - (x2 / 110))))));
+}
+
+static inline double  //
+wuffs_base__private_resampler_filter_support(
+    wuffs_base__resampler_filter filter) {
+  switch (filter) {
+    case WUFFS_BASE__RESAMPLER_FILTER__BOX:
+      return 0.5;
+    case WUFFS_BASE__RESAMPLER_FILTER__BILINEAR:
+      return 1;
+    case WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3:
+      return 3;
+  }
+  return 0;
+}
+
+static inline double  //
+wuffs_base__private_resampler_filter_eval(wuffs_base__resampler_filter filter,
+                                          double x) {
+  switch (filter) {
+    case WUFFS_BASE__RESAMPLER_FILTER__BOX:
+      return ((-0.5 <= x) && (x < 0.5)) ? 1 : 0;
+    case WUFFS_BASE__RESAMPLER_FILTER__BILINEAR:
+      x = (x < 0) ? -x : x;
+      return (x < 1) ? (1 - x) : 0;
+    case WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3:
+      if ((x <= -3) || (3 <= x)) {
+        return 0;
+      } else if ((-1e-8 < x) && (x < 1e-8)) {
+        return 1;
+      } else {
+        const double pi = WUFFS_BASE__PRIVATE_RESAMPLER_PI;
+        return (3 * wuffs_base__private_resampler_sin(pi * x) *
+                wuffs_base__private_resampler_sin(pi * x / 3)) /
+               (pi * pi * x * x);
+      }
+  }
+  return 0;
+}
+
+// wuffs_base__private_resampler_floor and wuffs_base__private_resampler_round
+// are floor and round-half-away-from-zero, without needing libm.
+static inline int64_t  //
+wuffs_base__private_resampler_floor(double x) {
+  int64_t i = (int64_t)(x);
+  return (((double)(i)) > x) ? (i - 1) : i;
+}
+
+static inline int32_t  //
+wuffs_base__private_resampler_round(double x) {
+  return (x < 0) ? -(int32_t)(0.5 - x) : (int32_t)(x + 0.5);
+}
+
+// wuffs_base__private_resampler_taps returns the maximum number of source
+// pixels that contribute to a destination pixel, along one axis, rounded up
+// to a multiple of 4 so that the SIMD loops can process 4 taps at a time.
+// Weights past a pixel's tap count are zero.
+static inline uint32_t  //
+wuffs_base__private_resampler_taps(wuffs_base__resampler_filter filter,
+                                   uint32_t src_len,
+                                   uint32_t dst_len) {
+  double support = wuffs_base__private_resampler_filter_support(filter);
+  if (src_len > dst_len) {
+    support = (support * src_len) / dst_len;
+  }
+  uint64_t n = ((uint64_t)(2 * support)) + 3;
+  if (n > src_len) {
+    n = src_len;
+  }
+  return (uint32_t)((n + 3) & ~((uint64_t)3));
+}
+
+// wuffs_base__private_resampler_weights computes, for each of the dst_len
+// destination pixels along one axis, the span (the first source pixel and
+// the number of them) and the weights of the source pixels that contribute
+// to it. Source pixels beyond the edges are clamped to the edges.
+static void  //
+wuffs_base__private_resampler_weights(uint32_t* spans,
+                                      int16_t* weights,
+                                      uint32_t taps,
+                                      wuffs_base__resampler_filter filter,
+                                      uint32_t src_len,
+                                      uint32_t dst_len) {
+  double scale = ((double)(dst_len)) / src_len;
+  double filter_scale = (scale < 1) ? scale : 1;
+  double support =
+      wuffs_base__private_resampler_filter_support(filter) / filter_scale;
+
+  uint32_t i;
+  for (i = 0; i < dst_len; i++) {
+    int16_t* w = weights + ((size_t)(i)*taps);
+    memset(w, 0, taps * sizeof(int16_t));
+
+    double center = ((i + 0.5) / scale) - 0.5;
+    int64_t lo = wuffs_base__private_resampler_floor(center - support);
+    int64_t hi = wuffs_base__private_resampler_floor(center + support) + 1;
+    int64_t first = (lo < 0) ? 0 : lo;
+    if (first > (int64_t)(src_len - 1)) {
+      first = src_len - 1;
+    }
+
+    double sum = 0;
+    int64_t j;
+    for (j = lo; j <= hi; j++) {
+      sum += wuffs_base__private_resampler_filter_eval(
+          filter, (j - center) * filter_scale);
+    }
+    if (sum == 0) {
+      // Fall back to the nearest source pixel.
+      lo = wuffs_base__private_resampler_floor(center + 0.5);
+      first = (lo < 0) ? 0 : lo;
+      if (first > (int64_t)(src_len - 1)) {
+        first = src_len - 1;
+      }
+      spans[(2 * i) + 0] = (uint32_t)(first);
+      spans[(2 * i) + 1] = 1;
+      w[0] = WUFFS_BASE__PRIVATE_RESAMPLER_ONE;
+      continue;
+    }
+
+    // Accumulate the weights, merging those beyond the edges into the edges.
+    int64_t last = first;
+    for (j = lo; j <= hi; j++) {
+      double f = wuffs_base__private_resampler_filter_eval(
+          filter, (j - center) * filter_scale);
+      if (f == 0) {
+        continue;
+      }
+      int64_t k = (j < 0) ? 0 : j;
+      if (k > (int64_t)(src_len - 1)) {
+        k = src_len - 1;
+      }
+      if ((k - first) >= taps) {
+        continue;
+      }
+      last = (last > k) ? last : k;
+      int32_t v =
+          w[k - first] + wuffs_base__private_resampler_round(
+                             (f / sum) * WUFFS_BASE__PRIVATE_RESAMPLER_ONE);
+      w[k - first] =
+          (int16_t)((v < -0x7FFF) ? -0x7FFF : ((v > 0x7FFF) ? 0x7FFF : v));
+    }
+
+    // Trim zero weights from both ends.
+    uint32_t n = (uint32_t)(last - first + 1);
+    uint32_t skip = 0;
+    while (((skip + 1) < n) && (w[skip] == 0)) {
+      skip++;
+    }
+    if (skip > 0) {
+      memmove(w, w + skip, (n - skip) * sizeof(int16_t));
+      memset(w + (n - skip), 0, skip * sizeof(int16_t));
+      first += skip;
+      n -= skip;
+    }
+    while ((n > 1) && (w[n - 1] == 0)) {
+      n--;
+    }
+
+    // Make the weights sum to exactly one, adjusting the largest weight.
+    int32_t total = 0;
+    uint32_t biggest = 0;
+    uint32_t k;
+    for (k = 0; k < n; k++) {
+      total += w[k];
+      if (w[k] > w[biggest]) {
+        biggest = k;
+      }
+    }
+    w[biggest] =
+        (int16_t)(w[biggest] + WUFFS_BASE__PRIVATE_RESAMPLER_ONE - total);
+
+    spans[(2 * i) + 0] = (uint32_t)(first);
+    spans[(2 * i) + 1] = n;
+  }
+}
+
+// wuffs_base__private_resampler_clamp converts a fixed point sum back to an
+// 8 bit sample, rounding to nearest and saturating.
+static inline uint8_t  //
+wuffs_base__private_resampler_clamp(int32_t v) {
+  v += WUFFS_BASE__PRIVATE_RESAMPLER_HALF;
+  if (v < 0) {
+    return 0;
+  }
+  v >>= WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT;
+  return (uint8_t)((v > 0xFF) ? 0xFF : v);
+}
+
+// wuffs_base__private_resample_vertical__fallback sets each of dst's len bytes
+// to the weighted sum of the same byte in the count rows.
+static inline void  //
+wuffs_base__private_resample_vertical__fallback(uint8_t* dst,
+                                                size_t len,
+                                                uint8_t** rows,
+                                                const int16_t* weights,
+                                                uint32_t count,
+                                                size_t i) {
+  for (; i < len; i++) {
+    int32_t sum = 0;
+    uint32_t k;
+    for (k = 0; k < count; k++) {
+      sum += weights[k] * (int32_t)(rows[k][i]);
+    }
+    dst[i] = wuffs_base__private_resampler_clamp(sum);
+  }
+}
+
+// wuffs_base__private_resample_horizontal__fallback sets each of dst's
+// dst_width 4 byte pixels to the weighted sum of its span of src's pixels.
+static inline void  //
+wuffs_base__private_resample_horizontal__fallback(uint8_t* dst,
+                                                  uint32_t dst_width,
+                                                  const uint8_t* src,
+                                                  const uint32_t* spans,
+                                                  const int16_t* weights,
+                                                  uint32_t taps) {
+  uint32_t x;
+  for (x = 0; x < dst_width; x++) {
+    const uint8_t* s = src + (4 * (size_t)(spans[(2 * x) + 0]));
+    uint32_t count = spans[(2 * x) + 1];
+    const int16_t* w = weights + ((size_t)(x)*taps);
+    int32_t sum0 = 0;
+    int32_t sum1 = 0;
+    int32_t sum2 = 0;
+    int32_t sum3 = 0;
+    uint32_t k;
+    for (k = 0; k < count; k++) {
+      sum0 += w[k] * (int32_t)(s[(4 * k) + 0]);
+      sum1 += w[k] * (int32_t)(s[(4 * k) + 1]);
+      sum2 += w[k] * (int32_t)(s[(4 * k) + 2]);
+      sum3 += w[k] * (int32_t)(s[(4 * k) + 3]);
+    }
+    dst[(4 * x) + 0] = wuffs_base__private_resampler_clamp(sum0);
+    dst[(4 * x) + 1] = wuffs_base__private_resampler_clamp(sum1);
+    dst[(4 * x) + 2] = wuffs_base__private_resampler_clamp(sum2);
+    dst[(4 * x) + 3] = wuffs_base__private_resampler_clamp(sum3);
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_resampler_pack rounds and narrows four vectors of 32 bit
+// fixed point sums to 16 saturated 8 bit samples.
+static inline __m128i  //
+wuffs_base__private_resampler_pack(__m128i s0,
+                                   __m128i s1,
+                                   __m128i s2,
+                                   __m128i s3) {
+  const __m128i half = _mm_set1_epi32(WUFFS_BASE__PRIVATE_RESAMPLER_HALF);
+  s0 = _mm_srai_epi32(_mm_add_epi32(s0, half),
+                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);
+  s1 = _mm_srai_epi32(_mm_add_epi32(s1, half),
+                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);
+  s2 = _mm_srai_epi32(_mm_add_epi32(s2, half),
+                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);
+  s3 = _mm_srai_epi32(_mm_add_epi32(s3, half),
+                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);
+  return _mm_packus_epi16(_mm_packs_epi32(s0, s1), _mm_packs_epi32(s2, s3));
+}
+
+// wuffs_base__private_resampler_weight_pair broadcasts two adjacent weights,
+// as the (low, high) 16 bit halves of every 32 bit lane, for pmaddwd.
+static inline __m128i  //
+wuffs_base__private_resampler_weight_pair(const int16_t* w) {
+  return _mm_set1_epi32((int)((uint32_t)((uint16_t)(w[0])) |
+                              (((uint32_t)((uint16_t)(w[1]))) << 16)));
+}
+
+// The vertical pass interleaves, 16 bits per sample, the same byte of two
+// rows, so that one pmaddwd multiplies both by their weights and adds them.
+// Each iteration consumes two rows: count is rounded up to even, and the
+// padding row has a zero weight.
+static inline void  //
+wuffs_base__private_resample_vertical__sse2(uint8_t* dst,
+                                            size_t len,
+                                            uint8_t** rows,
+                                            const int16_t* weights,
+                                            uint32_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; (i + 16) <= len; i += 16) {
+    __m128i s0 = zero;
+    __m128i s1 = zero;
+    __m128i s2 = zero;
+    __m128i s3 = zero;
+    uint32_t k;
+    for (k = 0; k < count; k += 2) {
+      __m128i w = wuffs_base__private_resampler_weight_pair(weights + k);
+      __m128i a = _mm_loadu_si128((const __m128i*)(rows[k + 0] + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(rows[k + 1] + i));
+      __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+      __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+      __m128i b_lo = _mm_unpacklo_epi8(b, zero);
+      __m128i b_hi = _mm_unpackhi_epi8(b, zero);
+      s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), w));
+      s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), w));
+      s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), w));
+      s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), w));
+    }
+    _mm_storeu_si128((__m128i*)(dst + i),
+                     wuffs_base__private_resampler_pack(s0, s1, s2, s3));
+  }
+  wuffs_base__private_resample_vertical__fallback(dst, len, rows, weights,
+                                                  count, i);
+}
+
+// The horizontal pass loads 4 adjacent source pixels and interleaves pixels 0
+// and 1, and pixels 2 and 3, channel by channel, so that pmaddwd sums two
+// taps per 32 bit (per channel) lane. It produces 4 destination pixels per
+// 16 byte store. Reading up to 3 pixels past a span is safe, as the source
+// row is padded and the padding taps have zero weights.
+static inline void  //
+wuffs_base__private_resample_horizontal__sse2(uint8_t* dst,
+                                              uint32_t dst_width,
+                                              const uint8_t* src,
+                                              const uint32_t* spans,
+                                              const int16_t* weights,
+                                              uint32_t taps) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sums[4];
+  uint32_t x = 0;
+  for (; (x + 4) <= dst_width; x += 4) {
+    uint32_t j;
+    for (j = 0; j < 4; j++) {
+      const uint8_t* s = src + (4 * (size_t)(spans[(2 * (x + j)) + 0]));
+      uint32_t count = spans[(2 * (x + j)) + 1];
+      const int16_t* w = weights + ((size_t)(x + j) * taps);
+      __m128i sum = zero;
+      uint32_t k;
+      for (k = 0; k < count; k += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + (4 * k)));
+        __m128i u = _mm_srli_si128(v, 4);
+        __m128i p01 = _mm_unpacklo_epi8(_mm_unpacklo_epi8(v, u), zero);
+        __m128i p23 = _mm_unpacklo_epi8(_mm_unpackhi_epi8(v, u), zero);
+        sum = _mm_add_epi32(
+            sum, _mm_madd_epi16(p01, wuffs_base__private_resampler_weight_pair(
+                                         w + k + 0)));
+        sum = _mm_add_epi32(
+            sum, _mm_madd_epi16(p23, wuffs_base__private_resampler_weight_pair(
+                                         w + k + 2)));
+      }
+      sums[j] = sum;
+    }
+    _mm_storeu_si128(
+        (__m128i*)(dst + (4 * (size_t)(x))),
+        wuffs_base__private_resampler_pack(sums[0], sums[1], sums[2], sums[3]));
+  }
+  wuffs_base__private_resample_horizontal__fallback(
+      dst + (4 * (size_t)(x)), dst_width - x, src, spans + (2 * x),
+      weights + ((size_t)(x)*taps), taps);
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline uint64_t  //
+wuffs_base__private_resampler_align16(uint64_t n) {
+  return (n + 15) & ~((uint64_t)15);
+}
+
+WUFFS_BASE__MAYBE_STATIC uint64_t  //
+wuffs_base__resampler__workbuf_len(wuffs_base__resampler_filter filter,
+                                   uint32_t src_width,
+                                   uint32_t src_height,
+                                   uint32_t dst_width,
+                                   uint32_t dst_height) {
+  if ((wuffs_base__private_resampler_filter_support(filter) == 0) ||
+      (src_width == 0) || (src_width > 0xFFFFFF) || (src_height == 0) ||
+      (src_height > 0xFFFFFF) || (dst_width == 0) || (dst_width > 0xFFFFFF) ||
+      (dst_height == 0) || (dst_height > 0xFFFFFF)) {
+    return 0;
+  }
+  uint64_t x_taps =
+      wuffs_base__private_resampler_taps(filter, src_width, dst_width);
+  uint64_t y_taps =
+      wuffs_base__private_resampler_taps(filter, src_height, dst_height);
+  uint64_t row_len =
+      wuffs_base__private_resampler_align16((4 * (uint64_t)(src_width)) + 16);
+  // The leading 15 bytes of slack let initialize align the work buffer's
+  // regions to 16 bytes, wherever the caller's work buffer starts.
+  return 15 +
+         wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_width)) +
+         wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_height)) +
+         wuffs_base__private_resampler_align16(2 * x_taps * dst_width) +
+         wuffs_base__private_resampler_align16(2 * y_taps * dst_height) +
+         wuffs_base__private_resampler_align16(sizeof(uint8_t*) * y_taps) +
+         row_len + (row_len * y_taps);
+}
+
+static inline bool  //
+wuffs_base__private_resampler_supports(wuffs_base__pixel_format pixfmt) {
+  switch (pixfmt) {
+    case WUFFS_BASE__PIXEL_FORMAT__BGRX:
+    case WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__RGBX:
+    case WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL:
+      return true;
+  }
+  return false;
+}
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__initialize(wuffs_base__resampler* r,
+                                  wuffs_base__resampler_filter filter,
+                                  uint32_t src_width,
+                                  uint32_t src_height,
+                                  wuffs_base__pixel_buffer* dst,
+                                  wuffs_base__slice_u8 workbuf) {
+  if (!r) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (!dst) {
+    return wuffs_base__error__bad_argument;
+  }
+  wuffs_base__pixel_format pixfmt = dst->pixcfg.private_impl.pixfmt;
+  if (!wuffs_base__private_resampler_supports(pixfmt)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  uint32_t dst_width = dst->pixcfg.private_impl.width;
+  uint32_t dst_height = dst->pixcfg.private_impl.height;
+  uint64_t n = wuffs_base__resampler__workbuf_len(filter, src_width, src_height,
+                                                  dst_width, dst_height);
+  if (n == 0) {
+    return wuffs_base__error__bad_argument;
+  } else if (n > workbuf.len) {
+    return wuffs_base__error__bad_workbuf_length;
+  }
+
+  r->private_impl.pixfmt = pixfmt;
+  r->private_impl.dst = dst->private_impl.planes[0];
+  r->private_impl.num_src_rows = 0;
+  r->private_impl.num_dst_rows = 0;
+
+  // Re-use the weights if they were computed for the same sizes and filter,
+  // in the same work buffer. This relies on the caller not modifying the work
+  // buffer's contents in between, as documented in image-public.h.
+  if ((r->private_impl.magic == WUFFS_BASE__MAGIC) &&
+      (r->private_impl.filter == filter) &&
+      (r->private_impl.src_width == src_width) &&
+      (r->private_impl.src_height == src_height) &&
+      (r->private_impl.dst_width == dst_width) &&
+      (r->private_impl.dst_height == dst_height) &&
+      (r->private_impl.workbuf.ptr == workbuf.ptr) &&
+      (r->private_impl.workbuf.len == workbuf.len)) {
+    return NULL;
+  }
+
+  r->private_impl.magic = 0;
+  r->private_impl.filter = filter;
+  r->private_impl.src_width = src_width;
+  r->private_impl.src_height = src_height;
+  r->private_impl.dst_width = dst_width;
+  r->private_impl.dst_height = dst_height;
+  r->private_impl.workbuf = workbuf;
+
+  uint32_t x_taps =
+      wuffs_base__private_resampler_taps(filter, src_width, dst_width);
+  uint32_t y_taps =
+      wuffs_base__private_resampler_taps(filter, src_height, dst_height);
+  r->private_impl.x_taps = x_taps;
+  r->private_impl.y_taps = y_taps;
+
+  // Round p up to a 16 byte boundary, so that the casts below produce aligned
+  // pointers, and so that each row starts on a SIMD register boundary.
+  uint8_t* p = workbuf.ptr + (15 & (0 - (uintptr_t)(workbuf.ptr)));
+  r->private_impl.x_spans = (uint32_t*)(p);
+  p += wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_width));
+  r->private_impl.y_spans = (uint32_t*)(p);
+  p += wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_height));
+  r->private_impl.x_weights = (int16_t*)(p);
+  p += wuffs_base__private_resampler_align16(2 * (uint64_t)(x_taps)*dst_width);
+  r->private_impl.y_weights = (int16_t*)(p);
+  p += wuffs_base__private_resampler_align16(2 * (uint64_t)(y_taps)*dst_height);
+  r->private_impl.y_rows = (uint8_t**)(p);
+  p += wuffs_base__private_resampler_align16(sizeof(uint8_t*) * y_taps);
+  size_t row_len = (size_t)(wuffs_base__private_resampler_align16(
+      (4 * (uint64_t)(src_width)) + 16));
+  r->private_impl.vrow = p;
+  memset(p, 0, row_len);
+  p += row_len;
+  r->private_impl.ring = p;
+  r->private_impl.ring_stride = row_len;
+  memset(p, 0, row_len * y_taps);
+
+  wuffs_base__private_resampler_weights(r->private_impl.x_spans,
+                                        r->private_impl.x_weights, x_taps,
+                                        filter, src_width, dst_width);
+  wuffs_base__private_resampler_weights(r->private_impl.y_spans,
+                                        r->private_impl.y_weights, y_taps,
+                                        filter, src_height, dst_height);
+  r->private_impl.magic = WUFFS_BASE__MAGIC;
+  return NULL;
+}
+
+// wuffs_base__private_resampler_premultiply__fallback copies n
+// non-premultiplied pixels from src to dst, premultiplying them.
+static inline void  //
+wuffs_base__private_resampler_premultiply__fallback(uint8_t* dst,
+                                                    const uint8_t* src,
+                                                    size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    uint32_t a = src[3];
+    dst[0] = (uint8_t)(((src[0] * a) + 127) / 255);
+    dst[1] = (uint8_t)(((src[1] * a) + 127) / 255);
+    dst[2] = (uint8_t)(((src[2] * a) + 127) / 255);
+    dst[3] = (uint8_t)(a);
+    dst += 4;
+    src += 4;
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_resampler_premultiply__sse2 premultiplies 4 pixels at a
+// time. Each 16 bit product c×a is divided by 255, rounding to nearest, as
+// ((t + (t >> 8)) >> 8) where t is (c×a + 128), which matches the fallback's
+// ((c×a + 127) / 255) exactly for every 8 bit c and a.
+static inline void  //
+wuffs_base__private_resampler_premultiply__sse2(uint8_t* dst,
+                                                const uint8_t* src,
+                                                size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i bias = _mm_set1_epi16(128);
+  const __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000u);
+  size_t i = 0;
+  for (; (i + 4) <= n; i += 4) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(src + (4 * i)));
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+    __m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+    __m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+    __m128i t_lo = _mm_add_epi16(_mm_mullo_epi16(lo, a_lo), bias);
+    __m128i t_hi = _mm_add_epi16(_mm_mullo_epi16(hi, a_hi), bias);
+    t_lo = _mm_srli_epi16(_mm_add_epi16(t_lo, _mm_srli_epi16(t_lo, 8)), 8);
+    t_hi = _mm_srli_epi16(_mm_add_epi16(t_hi, _mm_srli_epi16(t_hi, 8)), 8);
+    __m128i c = _mm_packus_epi16(t_lo, t_hi);
+    _mm_storeu_si128((__m128i*)(dst + (4 * i)),
+                     _mm_or_si128(_mm_andnot_si128(alpha_mask, c),
+                                  _mm_and_si128(alpha_mask, v)));
+  }
+  wuffs_base__private_resampler_premultiply__fallback(dst + (4 * i),
+                                                      src + (4 * i), n - i);
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_resampler_finish_row fixes up, in place, a filtered row
+// of n premultiplied pixels: its colors are clamped to its alpha, as negative
+// filter lobes can overshoot, and then un-premultiplied if the pixel format
+// is not premultiplied.
+static inline void  //
+wuffs_base__private_resampler_finish_row(uint8_t* d,
+                                         size_t n,
+                                         wuffs_base__pixel_format pixfmt) {
+  if ((pixfmt == WUFFS_BASE__PIXEL_FORMAT__BGRX) ||
+      (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBX)) {
+    return;
+  }
+  bool premul = (pixfmt == WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL) ||
+                (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL);
+  size_t i;
+  for (i = 0; i < n; i++) {
+    uint32_t a = d[3];
+    uint32_t c0 = (d[0] < a) ? d[0] : a;
+    uint32_t c1 = (d[1] < a) ? d[1] : a;
+    uint32_t c2 = (d[2] < a) ? d[2] : a;
+    if (premul) {
+      d[0] = (uint8_t)(c0);
+      d[1] = (uint8_t)(c1);
+      d[2] = (uint8_t)(c2);
+    } else if (a == 0) {
+      d[0] = 0;
+      d[1] = 0;
+      d[2] = 0;
+    } else if (a < 0xFF) {
+      d[0] = (uint8_t)(((c0 * 0xFF) + (a / 2)) / a);
+      d[1] = (uint8_t)(((c1 * 0xFF) + (a / 2)) / a);
+      d[2] = (uint8_t)(((c2 * 0xFF) + (a / 2)) / a);
+    }
+    d += 4;
+  }
+}
+
+// wuffs_base__private_resampler_write_row filters the ring's rows vertically
+// into vrow and then vrow horizontally into the next destination row.
+static void  //
+wuffs_base__private_resampler_write_row(wuffs_base__resampler* r) {
+  uint32_t y = r->private_impl.num_dst_rows;
+  uint32_t first = r->private_impl.y_spans[(2 * y) + 0];
+  uint32_t count = r->private_impl.y_spans[(2 * y) + 1];
+  const int16_t* w =
+      r->private_impl.y_weights + ((size_t)(y)*r->private_impl.y_taps);
+  uint8_t** rows = r->private_impl.y_rows;
+  uint32_t k;
+  for (k = 0; k < count; k++) {
+    rows[k] = r->private_impl.ring + (((first + k) % r->private_impl.y_taps) *
+                                      r->private_impl.ring_stride);
+  }
+  size_t len = 4 * (size_t)(r->private_impl.src_width);
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  // Pad the rows to an even count. The padding row's weight is zero.
+  if (count & 1) {
+    rows[count] = rows[0];
+  }
+  wuffs_base__private_resample_vertical__sse2(r->private_impl.vrow, len, rows,
+                                              w, count);
+#else
+  wuffs_base__private_resample_vertical__fallback(r->private_impl.vrow, len,
+                                                  rows, w, count, 0);
+#endif
+
+  wuffs_base__slice_u8 d = wuffs_base__table_u8__row(r->private_impl.dst, y);
+  uint32_t dst_width = r->private_impl.dst_width;
+  if (d.len < (4 * (size_t)(dst_width))) {
+    return;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  wuffs_base__private_resample_horizontal__sse2(
+      d.ptr, dst_width, r->private_impl.vrow, r->private_impl.x_spans,
+      r->private_impl.x_weights, r->private_impl.x_taps);
+#else
+  wuffs_base__private_resample_horizontal__fallback(
+      d.ptr, dst_width, r->private_impl.vrow, r->private_impl.x_spans,
+      r->private_impl.x_weights, r->private_impl.x_taps);
+#endif
+  wuffs_base__private_resampler_finish_row(d.ptr, dst_width,
+                                           r->private_impl.pixfmt);
+}
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__consume_row(wuffs_base__resampler* r,
+                                   wuffs_base__slice_u8 src_row) {
+  if (!r) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (r->private_impl.magic != WUFFS_BASE__MAGIC) {
+    return wuffs_base__error__check_wuffs_version_missing;
+  }
+  uint32_t s = r->private_impl.num_src_rows;
+  if (s >= r->private_impl.src_height) {
+    return wuffs_base__error__bad_call_sequence;
+  }
+  size_t len = 4 * (size_t)(r->private_impl.src_width);
+  if (src_row.len < len) {
+    return wuffs_base__error__bad_argument_length_too_short;
+  }
+
+  uint8_t* ring_row = r->private_impl.ring + ((s % r->private_impl.y_taps) *
+                                              r->private_impl.ring_stride);
+  wuffs_base__pixel_format pixfmt = r->private_impl.pixfmt;
+  if ((pixfmt == WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) ||
+      (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL)) {
+#if defined(WUFFS_BASE__HAVE_SSE2)
+    wuffs_base__private_resampler_premultiply__sse2(ring_row, src_row.ptr,
+                                                    r->private_impl.src_width);
+#else
+    wuffs_base__private_resampler_premultiply__fallback(
+        ring_row, src_row.ptr, r->private_impl.src_width);
+#endif
+  } else {
+    memcpy(ring_row, src_row.ptr, len);
+  }
+  r->private_impl.num_src_rows = ++s;
+
+  // Write every destination row whose span of source rows is complete.
+  while (r->private_impl.num_dst_rows < r->private_impl.dst_height) {
+    uint32_t y = r->private_impl.num_dst_rows;
+    uint32_t end = r->private_impl.y_spans[(2 * y) + 0] +
+                   r->private_impl.y_spans[(2 * y) + 1];
+    if (end > s) {
+      break;
+    }
+    wuffs_base__private_resampler_write_row(r);
+    r->private_impl.num_dst_rows++;
+  }
+  return NULL;
+}
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__resample(wuffs_base__resampler* r,
+                                wuffs_base__pixel_buffer* src) {
+  if (!r) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (!src) {
+    return wuffs_base__error__bad_argument;
+  }
+  if ((src->pixcfg.private_impl.pixfmt != r->private_impl.pixfmt) ||
+      (src->pixcfg.private_impl.width != r->private_impl.src_width) ||
+      (src->pixcfg.private_impl.height != r->private_impl.src_height)) {
+    return wuffs_base__error__bad_argument;
+  }
+  wuffs_base__table_u8 tab = src->private_impl.planes[0];
+  uint32_t y;
+  for (y = r->private_impl.num_src_rows; y < r->private_impl.src_height; y++) {
+    wuffs_base__status z = wuffs_base__resampler__consume_row(
+        r, wuffs_base__table_u8__row(tab, y));
+    if (z) {
+      return z;
+    }
+  }
+  return NULL;
+}
@@ -192,6 +192,39 @@ wuffs_base__pixel_format__num_planes(wuffs_base__pixel_format f) {
   return f ? (((f >> 16) & 0x03) + 1) : 0;
 }
 
+// wuffs_base__pixel_format__bits_per_pixel returns the number of bits per
+// pixel of a packed (single plane) pixel format, including indexed formats. It
+// returns zero for planar or invalid formats.
+static inline uint32_t  //
+wuffs_base__pixel_format__bits_per_pixel(wuffs_base__pixel_format f) {
+  static const uint8_t depths[16] = {
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 16, 24, 32, 48, 64,
+  };
+  if ((f == 0) || (((f >> 16) & 0x03) != 0)) {
+    return 0;
+  }
+  return depths[0x0F & (f >> 0)] + depths[0x0F & (f >> 4)] +
+         depths[0x0F & (f >> 8)] + depths[0x0F & (f >> 12)];
+}
+
+// wuffs_base__pixel_format__is_planar_8_bit returns whether f is a planar
+// (multiple plane) pixel format with 8 bits per sample in every plane, such as
+// WUFFS_BASE__PIXEL_FORMAT__YUV.
+static inline bool  //
+wuffs_base__pixel_format__is_planar_8_bit(wuffs_base__pixel_format f) {
+  uint32_t n = (f >> 16) & 0x03;
+  if ((n == 0) || ((f >> 18) & 0x01)) {
+    return false;
+  }
+  uint32_t p;
+  for (p = 0; p <= n; p++) {
+    if (((f >> (4 * p)) & 0x0F) != 8) {
+      return false;
+    }
+  }
+  return true;
+}
+
 #define WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX 4
 
 #define WUFFS_BASE__PIXEL_FORMAT__INDEXED__INDEX_PLANE 0
@@ -277,6 +310,34 @@ wuffs_base__pixel_subsampling__shift_y(wuffs_base__pixel_subsampling s,
   return (s >> shift) & 0x03;
 }
 
+// wuffs_base__pixel_subsampling__plane_width returns the number of samples in
+// each row of the p'th plane, for an image that is width pixels wide.
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__plane_width(wuffs_base__pixel_subsampling s,
+                                           uint32_t plane,
+                                           uint32_t width) {
+  if (width == 0) {
+    return 0;
+  }
+  return ((width - 1 + wuffs_base__pixel_subsampling__bias_x(s, plane)) >>
+          wuffs_base__pixel_subsampling__shift_x(s, plane)) +
+         1;
+}
+
+// wuffs_base__pixel_subsampling__plane_height returns the number of rows in
+// the p'th plane, for an image that is height pixels high.
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__plane_height(wuffs_base__pixel_subsampling s,
+                                            uint32_t plane,
+                                            uint32_t height) {
+  if (height == 0) {
+    return 0;
+  }
+  return ((height - 1 + wuffs_base__pixel_subsampling__bias_y(s, plane)) >>
+          wuffs_base__pixel_subsampling__shift_y(s, plane)) +
+         1;
+}
+
 // --------
 
 typedef struct {
@@ -318,8 +379,16 @@ wuffs_base__pixel_config__initialize(wuffs_base__pixel_config* c,
   }
   if (pixfmt) {
     uint64_t wh = ((uint64_t)width) * ((uint64_t)height);
-    // TODO: handle things other than 1 byte per pixel.
-    if (wh <= ((uint64_t)SIZE_MAX)) {
+    // TODO: handle fractional bytes per pixel.
+    uint64_t bytes_per_pixel =
+        wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8;
+    if (wuffs_base__pixel_format__is_planar_8_bit(pixfmt)) {
+      // Subsampled planes are no larger than the first plane.
+      bytes_per_pixel = wuffs_base__pixel_format__num_planes(pixfmt);
+    } else if (bytes_per_pixel == 0) {
+      bytes_per_pixel = 1;
+    }
+    if (wh <= (((uint64_t)SIZE_MAX) / bytes_per_pixel)) {
       c->private_impl.pixfmt = pixfmt;
       c->private_impl.pixsub = pixsub;
       c->private_impl.width = width;
@@ -373,16 +442,34 @@ wuffs_base__pixel_config__height(wuffs_base__pixel_config* c) {
   return c ? c->private_impl.height : 0;
 }
 
-// TODO: this is the right API for planar (not packed) pixbufs? Should it allow
-// decoding into a color model different from the format's intrinsic one? For
-// example, decoding a JPEG image straight to RGBA instead of to YCbCr?
+// wuffs_base__pixel_config__pixbuf_len returns the number of bytes needed by
+// wuffs_base__pixel_buffer__set_from_slice. For planar formats, such as
+// WUFFS_BASE__PIXEL_FORMAT__YUV, that is the sum of each (possibly
+// subsampled) plane's width times height.
 static inline uint64_t  //
 wuffs_base__pixel_config__pixbuf_len(wuffs_base__pixel_config* c) {
-  if (c) {
+  if (c && wuffs_base__pixel_format__is_planar_8_bit(c->private_impl.pixfmt)) {
+    uint64_t n = 0;
+    uint32_t num_planes =
+        wuffs_base__pixel_format__num_planes(c->private_impl.pixfmt);
+    uint32_t p;
+    for (p = 0; p < num_planes; p++) {
+      n += ((uint64_t)wuffs_base__pixel_subsampling__plane_width(
+               c->private_impl.pixsub, p, c->private_impl.width)) *
+           ((uint64_t)wuffs_base__pixel_subsampling__plane_height(
+               c->private_impl.pixsub, p, c->private_impl.height));
+    }
+    return n;
+  } else if (c) {
     uint64_t n =
         ((uint64_t)c->private_impl.width) * ((uint64_t)c->private_impl.height);
-    // TODO: handle things other than 1 byte per pixel. When doing so, consider
+    // TODO: handle planar formats and fractional bytes per pixel. Consider
     // that the +1024 below could overflow.
+    uint64_t bytes_per_pixel =
+        wuffs_base__pixel_format__bits_per_pixel(c->private_impl.pixfmt) / 8;
+    if (bytes_per_pixel > 1) {
+      n *= bytes_per_pixel;
+    }
     if (wuffs_base__pixel_format__is_indexed(c->private_impl.pixfmt)) {
       n += 1024;
     }
@@ -799,6 +886,10 @@ typedef struct {
 #ifdef __cplusplus
   inline wuffs_base__status set_from_slice(wuffs_base__pixel_config* pixcfg,
                                            wuffs_base__slice_u8 pixbuf_memory);
+  inline wuffs_base__status set_from_table(wuffs_base__pixel_config* pixcfg,
+                                           wuffs_base__table_u8 primary_memory,
+                                           wuffs_base__slice_u8 palette_memory);
+  inline wuffs_base__pixel_format pixel_format();
   inline wuffs_base__slice_u8 palette();
   inline wuffs_base__table_u8 plane(uint32_t p);
 #endif  // __cplusplus
@@ -837,21 +928,125 @@ wuffs_base__pixel_buffer__set_from_slice(wuffs_base__pixel_buffer* b,
     len -= 1024;
   }
 
-  // TODO: don't assume 1 byte per pixel. Don't assume packed.
-  uint64_t wh = ((uint64_t)pixcfg->private_impl.width) *
-                ((uint64_t)pixcfg->private_impl.height);
-  if (wh > len) {
+  // The rows are packed: the stride equals the width in bytes. For padded
+  // strides, use wuffs_base__pixel_buffer__set_from_table instead. Planar
+  // formats' planes are consecutive, in plane order.
+  if (wuffs_base__pixel_format__is_planar_8_bit(pixcfg->private_impl.pixfmt)) {
+    if (len < wuffs_base__pixel_config__pixbuf_len(pixcfg)) {
+      return wuffs_base__error__bad_argument_length_too_short;
+    }
+    b->pixcfg = *pixcfg;
+    uint32_t num_planes =
+        wuffs_base__pixel_format__num_planes(pixcfg->private_impl.pixfmt);
+    uint32_t p;
+    for (p = 0; p < num_planes; p++) {
+      uint32_t w = wuffs_base__pixel_subsampling__plane_width(
+          pixcfg->private_impl.pixsub, p, pixcfg->private_impl.width);
+      uint32_t h = wuffs_base__pixel_subsampling__plane_height(
+          pixcfg->private_impl.pixsub, p, pixcfg->private_impl.height);
+      wuffs_base__table_u8* tab = &b->private_impl.planes[p];
+      tab->ptr = ptr;
+      tab->width = w;
+      tab->height = h;
+      tab->stride = w;
+      ptr += ((uint64_t)w) * ((uint64_t)h);
+    }
+    return NULL;
+  }
+
+  // TODO: handle fractional bytes per pixel.
+  uint32_t bits_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(pixcfg->private_impl.pixfmt);
+  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  uint64_t width_in_bytes =
+      ((uint64_t)pixcfg->private_impl.width) * (bits_per_pixel / 8);
+  if ((width_in_bytes > 0) &&
+      ((len / width_in_bytes) < ((uint64_t)pixcfg->private_impl.height))) {
     return wuffs_base__error__bad_argument_length_too_short;
   }
   b->pixcfg = *pixcfg;
   wuffs_base__table_u8* tab = &b->private_impl.planes[0];
   tab->ptr = ptr;
-  tab->width = pixcfg->private_impl.width;
+  tab->width = width_in_bytes;
   tab->height = pixcfg->private_impl.height;
-  tab->stride = pixcfg->private_impl.width;
+  tab->stride = width_in_bytes;
   return NULL;
 }
 
+// wuffs_base__pixel_buffer__set_from_table is like
+// wuffs_base__pixel_buffer__set_from_slice, but the caller provides the
+// primary plane's memory as a table, whose stride can be larger than its width
+// in bytes. For example, a GPU upload staging buffer or a shared framebuffer
+// might pad each row to a 64 byte alignment.
+//
+// The table's width, in bytes, and height must be at least the pixcfg's width
+// (multiplied by bytes per pixel) and height. Any excess is ignored.
+//
+// For indexed pixel formats, palette_memory must have length at least 1024,
+// and only its first 1024 bytes are used. For other pixel formats, it is
+// ignored and may be empty.
+//
+// TODO: support multi-plane pixel formats, such as YCbCr, taking one table per
+// plane.
+static inline wuffs_base__status  //
+wuffs_base__pixel_buffer__set_from_table(wuffs_base__pixel_buffer* b,
+                                         wuffs_base__pixel_config* pixcfg,
+                                         wuffs_base__table_u8 primary_memory,
+                                         wuffs_base__slice_u8 palette_memory) {
+  if (!b) {
+    return wuffs_base__error__bad_receiver;
+  }
+  *b = ((wuffs_base__pixel_buffer){});
+  if (!pixcfg) {
+    return wuffs_base__error__bad_argument;
+  }
+
+  if (wuffs_base__pixel_format__is_indexed(pixcfg->private_impl.pixfmt)) {
+    if (palette_memory.len < 1024) {
+      return wuffs_base__error__bad_argument_length_too_short;
+    }
+    wuffs_base__table_u8* tab =
+        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];
+    tab->ptr = palette_memory.ptr;
+    tab->width = 1024;
+    tab->height = 1;
+    tab->stride = 1024;
+  }
+
+  uint32_t bits_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(pixcfg->private_impl.pixfmt);
+  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {
+    *b = ((wuffs_base__pixel_buffer){});
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  uint64_t width_in_bytes =
+      ((uint64_t)pixcfg->private_impl.width) * (bits_per_pixel / 8);
+  uint32_t height = pixcfg->private_impl.height;
+  if ((width_in_bytes > primary_memory.width) ||
+      (height > primary_memory.height)) {
+    *b = ((wuffs_base__pixel_buffer){});
+    return wuffs_base__error__bad_argument_length_too_short;
+  }
+  if ((height > 1) && (width_in_bytes > primary_memory.stride)) {
+    *b = ((wuffs_base__pixel_buffer){});
+    return wuffs_base__error__bad_argument;
+  }
+  b->pixcfg = *pixcfg;
+  wuffs_base__table_u8* tab = &b->private_impl.planes[0];
+  tab->ptr = primary_memory.ptr;
+  tab->width = width_in_bytes;
+  tab->height = height;
+  tab->stride = primary_memory.stride;
+  return NULL;
+}
+
+static inline wuffs_base__pixel_format  //
+wuffs_base__pixel_buffer__pixel_format(wuffs_base__pixel_buffer* b) {
+  return b ? b->pixcfg.private_impl.pixfmt : 0;
+}
+
 // wuffs_base__pixel_buffer__palette returns the palette color data. If
 // non-empty, it will have length 1024.
 static inline wuffs_base__slice_u8  //
@@ -885,6 +1080,19 @@ wuffs_base__pixel_buffer::set_from_slice(wuffs_base__pixel_config* pixcfg,
   return wuffs_base__pixel_buffer__set_from_slice(this, pixcfg, pixbuf_memory);
 }
 
+inline wuffs_base__status  //
+wuffs_base__pixel_buffer::set_from_table(wuffs_base__pixel_config* pixcfg,
+                                         wuffs_base__table_u8 primary_memory,
+                                         wuffs_base__slice_u8 palette_memory) {
+  return wuffs_base__pixel_buffer__set_from_table(this, pixcfg, primary_memory,
+                                                  palette_memory);
+}
+
+inline wuffs_base__pixel_format  //
+wuffs_base__pixel_buffer::pixel_format() {
+  return wuffs_base__pixel_buffer__pixel_format(this);
+}
+
 inline wuffs_base__slice_u8  //
 wuffs_base__pixel_buffer::palette() {
   return wuffs_base__pixel_buffer__palette(this);
@@ -899,20 +1107,987 @@ wuffs_base__pixel_buffer::plane(uint32_t p) {
 
 // --------
 
+// The wuffs_base__pixel_swizzle__indexed_to_etc functions convert rows of
+// palette-indexed pixels (1 byte per pixel) in src to direct color pixels in
+// dst, looking up each index in a 1024 byte palette of BGRA colors, such as
+// the one returned by wuffs_base__pixel_buffer__palette.
+//
+// The dst and src tables' widths are in bytes, not pixels, and their strides
+// are explicit, so that either table can be a sub-rectangle of a larger pixel
+// buffer. The number of rows converted is the minimum of the two heights. The
+// number of pixels per row is the minimum of dst's width in pixels and src's
+// width. The return value is the total number of pixels converted, which is
+// zero if the palette's length is not 1024.
+//
+// The dst pixel formats are, using Wuffs' memory order naming, BGRA (4 bytes
+// per pixel, copying the palette entry as is), RGB (3 bytes per pixel) and BGR
+// 565 (2 bytes per pixel, little-endian, what other libraries often call
+// RGB565). For the latter two, the palette's alpha channel is ignored.
+//
+// The __transparent variants skip, leaving dst's pixel unchanged, any src
+// pixel whose palette entry has zero alpha. For palettes whose entries are
+// either fully opaque or fully transparent, such as those given by the GIF
+// decoder, where the transparent index's entry is transparent black, this is
+// alpha-over (src-over-dst) composition.
+//
+// The inner loops are unrolled 4 times.
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__private_indexed_to_bgra(wuffs_base__table_u8 dst,
+                                                   wuffs_base__table_u8 src,
+                                                   wuffs_base__slice_u8 palette,
+                                                   bool transparent) {
+  if (palette.len != 1024) {
+    return 0;
+  }
+  size_t w = dst.width / 4;
+  w = (w < src.width) ? w : src.width;
+  size_t h = (dst.height < src.height) ? dst.height : src.height;
+  uint8_t* p = palette.ptr;
+
+  size_t y;
+  for (y = 0; y < h; y++) {
+    uint8_t* d = dst.ptr + (y * dst.stride);
+    uint8_t* s = src.ptr + (y * src.stride);
+    size_t n = w;
+    for (; n >= 4; n -= 4) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      uint8_t* c1 = p + (4 * (size_t)s[1]);
+      uint8_t* c2 = p + (4 * (size_t)s[2]);
+      uint8_t* c3 = p + (4 * (size_t)s[3]);
+      if (!transparent || c0[3]) {
+        memcpy(d + 0, c0, 4);
+      }
+      if (!transparent || c1[3]) {
+        memcpy(d + 4, c1, 4);
+      }
+      if (!transparent || c2[3]) {
+        memcpy(d + 8, c2, 4);
+      }
+      if (!transparent || c3[3]) {
+        memcpy(d + 12, c3, 4);
+      }
+      d += 16;
+      s += 4;
+    }
+    for (; n > 0; n--) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      if (!transparent || c0[3]) {
+        memcpy(d + 0, c0, 4);
+      }
+      d += 4;
+      s += 1;
+    }
+  }
+  return ((uint64_t)w) * ((uint64_t)h);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__private_indexed_to_rgb(wuffs_base__table_u8 dst,
+                                                  wuffs_base__table_u8 src,
+                                                  wuffs_base__slice_u8 palette,
+                                                  bool transparent) {
+  if (palette.len != 1024) {
+    return 0;
+  }
+  size_t w = dst.width / 3;
+  w = (w < src.width) ? w : src.width;
+  size_t h = (dst.height < src.height) ? dst.height : src.height;
+  uint8_t* p = palette.ptr;
+
+  size_t y;
+  for (y = 0; y < h; y++) {
+    uint8_t* d = dst.ptr + (y * dst.stride);
+    uint8_t* s = src.ptr + (y * src.stride);
+    size_t n = w;
+    for (; n >= 4; n -= 4) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      uint8_t* c1 = p + (4 * (size_t)s[1]);
+      uint8_t* c2 = p + (4 * (size_t)s[2]);
+      uint8_t* c3 = p + (4 * (size_t)s[3]);
+      if (!transparent || c0[3]) {
+        d[0] = c0[2];
+        d[1] = c0[1];
+        d[2] = c0[0];
+      }
+      if (!transparent || c1[3]) {
+        d[3] = c1[2];
+        d[4] = c1[1];
+        d[5] = c1[0];
+      }
+      if (!transparent || c2[3]) {
+        d[6] = c2[2];
+        d[7] = c2[1];
+        d[8] = c2[0];
+      }
+      if (!transparent || c3[3]) {
+        d[9] = c3[2];
+        d[10] = c3[1];
+        d[11] = c3[0];
+      }
+      d += 12;
+      s += 4;
+    }
+    for (; n > 0; n--) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      if (!transparent || c0[3]) {
+        d[0] = c0[2];
+        d[1] = c0[1];
+        d[2] = c0[0];
+      }
+      d += 3;
+      s += 1;
+    }
+  }
+  return ((uint64_t)w) * ((uint64_t)h);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette,
+    bool transparent) {
+  if (palette.len != 1024) {
+    return 0;
+  }
+  size_t w = dst.width / 2;
+  w = (w < src.width) ? w : src.width;
+  size_t h = (dst.height < src.height) ? dst.height : src.height;
+
+  // Convert the palette once, up front, instead of once per pixel. Each entry
+  // is 2 bytes of BGR 565 and 1 byte for whether the color is transparent.
+  uint8_t p[3 * 256];
+  size_t i;
+  for (i = 0; i < 256; i++) {
+    uint8_t* c = palette.ptr + (4 * i);
+    uint32_t b5 = c[0] >> 3;
+    uint32_t g6 = c[1] >> 2;
+    uint32_t r5 = c[2] >> 3;
+    uint32_t v = (r5 << 11) | (g6 << 5) | (b5 << 0);
+    p[(3 * i) + 0] = (uint8_t)(v >> 0);
+    p[(3 * i) + 1] = (uint8_t)(v >> 8);
+    p[(3 * i) + 2] = c[3];
+  }
+
+  size_t y;
+  for (y = 0; y < h; y++) {
+    uint8_t* d = dst.ptr + (y * dst.stride);
+    uint8_t* s = src.ptr + (y * src.stride);
+    size_t n = w;
+    for (; n >= 4; n -= 4) {
+      uint8_t* c0 = p + (3 * (size_t)s[0]);
+      uint8_t* c1 = p + (3 * (size_t)s[1]);
+      uint8_t* c2 = p + (3 * (size_t)s[2]);
+      uint8_t* c3 = p + (3 * (size_t)s[3]);
+      if (!transparent || c0[2]) {
+        memcpy(d + 0, c0, 2);
+      }
+      if (!transparent || c1[2]) {
+        memcpy(d + 2, c1, 2);
+      }
+      if (!transparent || c2[2]) {
+        memcpy(d + 4, c2, 2);
+      }
+      if (!transparent || c3[2]) {
+        memcpy(d + 6, c3, 2);
+      }
+      d += 8;
+      s += 4;
+    }
+    for (; n > 0; n--) {
+      uint8_t* c0 = p + (3 * (size_t)s[0]);
+      if (!transparent || c0[2]) {
+        memcpy(d + 0, c0, 2);
+      }
+      d += 2;
+      s += 1;
+    }
+  }
+  return ((uint64_t)w) * ((uint64_t)h);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgra(wuffs_base__table_u8 dst,
+                                           wuffs_base__table_u8 src,
+                                           wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgra(dst, src, palette,
+                                                            false);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgra__transparent(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgra(dst, src, palette,
+                                                            true);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_rgb(wuffs_base__table_u8 dst,
+                                          wuffs_base__table_u8 src,
+                                          wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_rgb(dst, src, palette,
+                                                           false);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_rgb__transparent(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_rgb(dst, src, palette,
+                                                           true);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgr_565(wuffs_base__table_u8 dst,
+                                              wuffs_base__table_u8 src,
+                                              wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(dst, src,
+                                                               palette, false);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgr_565__transparent(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(dst, src,
+                                                               palette, true);
+}
+
+// --------
+
+// wuffs_base__animation_compositor composites an animated image's frames onto
+// a canvas: a BGRA pixel buffer that holds what to display. It applies each
+// frame's blend and, before drawing the next frame, each frame's disposal.
+//
+// Each frame is given as a palette-indexed pixel buffer, such as the one
+// passed to the GIF decoder's decode_frame method. Only the pixels within the
+// frame's bounds are read.
+//
+// Only a frame's bounds, not the whole canvas, are saved, cleared or restored.
+// Restoring the background means clearing to transparent black, as web
+// browsers do. For RESTORE_PREVIOUS frames, the snapshot memory needs to hold
+// 4 bytes per pixel of the frame's bounds. The canvas' width × height × 4
+// bytes is always enough, and zero bytes is enough if no frame uses
+// RESTORE_PREVIOUS.
+//
+// Compositing a frame reports a dirty rectangle, the union of the previous
+// frame's bounds (if disposing of it changed the canvas) and this frame's
+// bounds. Pixels outside of it are unchanged, so renderers need only repaint
+// that rectangle.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    wuffs_base__table_u8 canvas;
+    wuffs_base__slice_u8 snapshot;
+    wuffs_base__rect_ie_u32 pending_bounds;
+    wuffs_base__animation_disposal pending_disposal;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status initialize(wuffs_base__pixel_buffer* canvas,
+                                       wuffs_base__slice_u8 snapshot_memory);
+  inline wuffs_base__status composite(wuffs_base__rect_ie_u32* dirty_rect,
+                                      wuffs_base__frame_config* fc,
+                                      wuffs_base__pixel_buffer* src);
+#endif  // __cplusplus
+
+} wuffs_base__animation_compositor;
+
+// wuffs_base__animation_compositor__initialize sets the canvas, which must be
+// BGRA (premultiplied or not), and clears it to transparent black. Call it
+// again to restart an animation from its first frame.
+static inline wuffs_base__status  //
+wuffs_base__animation_compositor__initialize(
+    wuffs_base__animation_compositor* c,
+    wuffs_base__pixel_buffer* canvas,
+    wuffs_base__slice_u8 snapshot_memory) {
+  if (!c) {
+    return wuffs_base__error__bad_receiver;
+  }
+  *c = ((wuffs_base__animation_compositor){});
+  if (!canvas) {
+    return wuffs_base__error__bad_argument;
+  }
+  wuffs_base__pixel_format pixfmt = canvas->pixcfg.private_impl.pixfmt;
+  if ((pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) &&
+      (pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+
+  wuffs_base__table_u8 tab = canvas->private_impl.planes[0];
+  size_t y;
+  for (y = 0; y < tab.height; y++) {
+    memset(tab.ptr + (y * tab.stride), 0, tab.width);
+  }
+  c->private_impl.canvas = tab;
+  c->private_impl.snapshot = snapshot_memory;
+  return NULL;
+}
+
+// wuffs_base__animation_compositor__composite disposes of the previous frame
+// and then draws the next one, src, whose frame config is fc. If dirty_rect
+// is non-NULL, it is set to the canvas rectangle that has changed.
+static inline wuffs_base__status  //
+wuffs_base__animation_compositor__composite(wuffs_base__animation_compositor* c,
+                                            wuffs_base__rect_ie_u32* dirty_rect,
+                                            wuffs_base__frame_config* fc,
+                                            wuffs_base__pixel_buffer* src) {
+  if (!c) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (!fc || !src) {
+    return wuffs_base__error__bad_argument;
+  }
+  if (!wuffs_base__pixel_format__is_indexed(src->pixcfg.private_impl.pixfmt)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(src);
+  wuffs_base__table_u8 src_tab = src->private_impl.planes[0];
+  wuffs_base__table_u8 dst_tab = c->private_impl.canvas;
+
+  // Clip the frame's bounds to the canvas and to src.
+  wuffs_base__rect_ie_u32 r = ((wuffs_base__rect_ie_u32){
+      .min_incl_x = 0,
+      .min_incl_y = 0,
+      .max_excl_x =
+          (uint32_t)(wuffs_base__u64__min(dst_tab.width / 4, src_tab.width)),
+      .max_excl_y =
+          (uint32_t)(wuffs_base__u64__min(dst_tab.height, src_tab.height)),
+  });
+  r = wuffs_base__rect_ie_u32__intersect(&r, fc->private_impl.bounds);
+  // A frame wholly outside of the canvas, or of src, leaves r empty but with
+  // possibly min > max. Normalize it to the zero rectangle, so that neither the
+  // pointers below, the pending_bounds nor the dirty_rect refer to pixels
+  // beyond the canvas.
+  if (wuffs_base__rect_ie_u32__is_empty(&r)) {
+    r = ((wuffs_base__rect_ie_u32){});
+  }
+  size_t w = wuffs_base__rect_ie_u32__width(&r);
+  size_t h = wuffs_base__rect_ie_u32__height(&r);
+
+  wuffs_base__animation_disposal disposal = fc->private_impl.disposal;
+  if ((disposal == WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) &&
+      (c->private_impl.snapshot.len < (w * h * 4))) {
+    return wuffs_base__error__bad_argument_length_too_short;
+  }
+
+  // Dispose of the previous frame.
+  wuffs_base__rect_ie_u32 dirty = c->private_impl.pending_bounds;
+  size_t pw = wuffs_base__rect_ie_u32__width(&dirty);
+  size_t ph = wuffs_base__rect_ie_u32__height(&dirty);
+  uint8_t* d = dst_tab.ptr + (dirty.min_incl_y * dst_tab.stride) +
+               (dirty.min_incl_x * 4);
+  uint8_t* s = c->private_impl.snapshot.ptr;
+  size_t y;
+  switch (c->private_impl.pending_disposal) {
+    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_BACKGROUND:
+      for (y = 0; y < ph; y++) {
+        memset(d, 0, pw * 4);
+        d += dst_tab.stride;
+      }
+      break;
+    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS:
+      for (y = 0; y < ph; y++) {
+        memcpy(d, s, pw * 4);
+        d += dst_tab.stride;
+        s += pw * 4;
+      }
+      break;
+    default:
+      dirty = ((wuffs_base__rect_ie_u32){});
+      break;
+  }
+
+  // Save what this frame will draw over, if it needs restoring later.
+  d = dst_tab.ptr + (r.min_incl_y * dst_tab.stride) + (r.min_incl_x * 4);
+  if (disposal == WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) {
+    s = c->private_impl.snapshot.ptr;
+    for (y = 0; y < h; y++) {
+      memcpy(s, d + (y * dst_tab.stride), w * 4);
+      s += w * 4;
+    }
+  }
+
+  // Draw this frame.
+  dst_tab.ptr = d;
+  dst_tab.width = w * 4;
+  dst_tab.height = h;
+  src_tab.ptr += (r.min_incl_y * src_tab.stride) + r.min_incl_x;
+  src_tab.width = w;
+  src_tab.height = h;
+  if (fc->private_impl.blend == WUFFS_BASE__ANIMATION_BLEND__SRC_OVER_DST) {
+    wuffs_base__pixel_swizzle__indexed_to_bgra__transparent(dst_tab, src_tab,
+                                                            palette);
+  } else {
+    wuffs_base__pixel_swizzle__indexed_to_bgra(dst_tab, src_tab, palette);
+  }
+
+  c->private_impl.pending_bounds = r;
+  c->private_impl.pending_disposal = disposal;
+  if (dirty_rect) {
+    *dirty_rect = wuffs_base__rect_ie_u32__unite(&dirty, r);
+  }
+  return NULL;
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__animation_compositor::initialize(
+    wuffs_base__pixel_buffer* canvas,
+    wuffs_base__slice_u8 snapshot_memory) {
+  return wuffs_base__animation_compositor__initialize(this, canvas,
+                                                      snapshot_memory);
+}
+
+inline wuffs_base__status  //
+wuffs_base__animation_compositor::composite(wuffs_base__rect_ie_u32* dirty_rect,
+                                            wuffs_base__frame_config* fc,
+                                            wuffs_base__pixel_buffer* src) {
+  return wuffs_base__animation_compositor__composite(this, dirty_rect, fc, src);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__decode_frame_options holds optional settings for decoding a
+// frame. A zero-valued struct, or a NULL pointer, means the default settings.
+//
+// A downscale shift, k, of 1, 2 or 3 decodes a frame at 1/2, 1/4 or 1/8 scale
+// respectively, such as for a thumbnail. The frame's pixel at (x, y) is
+// written to the destination pixel buffer at (x >> k, y >> k), and every
+// other pixel is dropped. A destination pixel buffer that is ((width + (1 <<
+// k) - 1) >> k) pixels wide and ((height + (1 << k) - 1) >> k) pixels high
+// holds the whole downscaled image, where width and height are the image
+// config's.
+//
+// Reporting interlace passes means that, for interlaced frames, decoding a
+// frame suspends at the end of every interlace pass but the last, so that the
+// caller can show a coarse preview. Which rows are complete so far depends on
+// the decoder. For example, see the GIF decoder's interlace_row_stride method.
+// The caller resumes decoding by calling the same method with the same
+// arguments, as for any other suspension.
+//
+// Reporting rows means that decoding a frame suspends after every row but the
+// last, so that the caller can consume each row as soon as it is complete.
+// Decoders that support this, such as the PNG decoder, write row y to the
+// destination pixel buffer's row (y % h), where h is that pixel buffer's
+// height, so that a pixel buffer only one row high suffices. The decoder's
+// num_decoded_rows method says how many rows are complete so far. Decoders
+// that do not support this ignore it.
 typedef struct {
   // Do not access the private_impl's fields directly. There is no API/ABI
   // compatibility or safety guarantee if you do so.
   struct {
-    uint8_t TODO;
+    uint32_t downscale_shift;
+    bool report_interlace_passes;
+    bool report_rows;
   } private_impl;
 
 #ifdef __cplusplus
+  inline void initialize(uint32_t downscale_shift,
+                         bool report_interlace_passes,
+                         bool report_rows);
+  inline uint32_t downscale_shift();
+  inline bool report_interlace_passes();
+  inline bool report_rows();
 #endif  // __cplusplus
 
 } wuffs_base__decode_frame_options;
 
+// wuffs_base__decode_frame_options__initialize sets the options. The downscale
+// shift is clamped to be at most 3.
+static inline void  //
+wuffs_base__decode_frame_options__initialize(
+    wuffs_base__decode_frame_options* o,
+    uint32_t downscale_shift,
+    bool report_interlace_passes,
+    bool report_rows) {
+  if (!o) {
+    return;
+  }
+  o->private_impl.downscale_shift = wuffs_base__u32__min(downscale_shift, 3);
+  o->private_impl.report_interlace_passes = report_interlace_passes;
+  o->private_impl.report_rows = report_rows;
+}
+
+static inline uint32_t  //
+wuffs_base__decode_frame_options__downscale_shift(
+    wuffs_base__decode_frame_options* o) {
+  return o ? wuffs_base__u32__min(o->private_impl.downscale_shift, 3) : 0;
+}
+
+static inline bool  //
+wuffs_base__decode_frame_options__report_interlace_passes(
+    wuffs_base__decode_frame_options* o) {
+  return o ? o->private_impl.report_interlace_passes : false;
+}
+
+static inline bool  //
+wuffs_base__decode_frame_options__report_rows(
+    wuffs_base__decode_frame_options* o) {
+  return o ? o->private_impl.report_rows : false;
+}
+
+// wuffs_base__pixel_buffer__replicate_interlaced_rows fills in the rows that
+// an interlaced frame has not decoded yet, for displaying a coarse preview.
+// Within the bounds, each row whose y minus bounds.min_incl_y is a multiple of
+// row_stride is copied over the (row_stride - 1) rows below it.
+//
+// This overwrites those rows' pixels in place. Later interlace passes will
+// overwrite them again, except where a frame's transparent pixels are skipped
+// when decoding to a direct color (not palette-indexed) pixel buffer. For such
+// pixel buffers, replicate the rows of a copy instead.
+static inline void  //
+wuffs_base__pixel_buffer__replicate_interlaced_rows(
+    wuffs_base__pixel_buffer* b,
+    wuffs_base__rect_ie_u32 bounds,
+    uint32_t row_stride) {
+  if (!b || (row_stride <= 1)) {
+    return;
+  }
+  uint32_t bits_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(b->pixcfg.private_impl.pixfmt);
+  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {
+    return;
+  }
+  wuffs_base__table_u8 tab = b->private_impl.planes[0];
+  wuffs_base__rect_ie_u32 r = ((wuffs_base__rect_ie_u32){
+      .min_incl_x = 0,
+      .min_incl_y = 0,
+      .max_excl_x = (uint32_t)(tab.width / (bits_per_pixel / 8)),
+      .max_excl_y = (uint32_t)(tab.height),
+  });
+  r = wuffs_base__rect_ie_u32__intersect(&r, bounds);
+  if (wuffs_base__rect_ie_u32__is_empty(&r)) {
+    return;
+  }
+  size_t n =
+      ((size_t)wuffs_base__rect_ie_u32__width(&r)) * (bits_per_pixel / 8);
+  uint8_t* p = tab.ptr + (((size_t)r.min_incl_x) * (bits_per_pixel / 8));
+  uint32_t y;
+  for (y = r.min_incl_y; y < r.max_excl_y; y++) {
+    uint32_t offset = (y - bounds.min_incl_y) % row_stride;
+    if (offset) {
+      memcpy(p + (y * tab.stride), p + ((y - offset) * tab.stride), n);
+    }
+  }
+}
+
 #ifdef __cplusplus
 
+inline void  //
+wuffs_base__decode_frame_options::initialize(uint32_t downscale_shift,
+                                             bool report_interlace_passes,
+                                             bool report_rows) {
+  wuffs_base__decode_frame_options__initialize(
+      this, downscale_shift, report_interlace_passes, report_rows);
+}
+
+inline uint32_t  //
+wuffs_base__decode_frame_options::downscale_shift() {
+  return wuffs_base__decode_frame_options__downscale_shift(this);
+}
+
+inline bool  //
+wuffs_base__decode_frame_options::report_interlace_passes() {
+  return wuffs_base__decode_frame_options__report_interlace_passes(this);
+}
+
+inline bool  //
+wuffs_base__decode_frame_options::report_rows() {
+  return wuffs_base__decode_frame_options__report_rows(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__image_format identifies an image file format, as four ASCII
+// bytes in big-endian order. For example, "PNG " is 0x504E4720. Zero means an
+// unknown format.
+typedef uint32_t wuffs_base__image_format;
+
+#define WUFFS_BASE__IMAGE_FORMAT__BMP 0x424D5020
+#define WUFFS_BASE__IMAGE_FORMAT__GIF 0x47494620
+#define WUFFS_BASE__IMAGE_FORMAT__JPEG 0x4A504547
+#define WUFFS_BASE__IMAGE_FORMAT__PNG 0x504E4720
+#define WUFFS_BASE__IMAGE_FORMAT__TIFF 0x54494646
+#define WUFFS_BASE__IMAGE_FORMAT__WEBP 0x57454250
+
+// WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN is the most number of bytes that
+// wuffs_base__image_format__sniff looks at.
+#define WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN 16
+
+// wuffs_base__image_format__sniff identifies an image file format from the
+// first bytes of its file. It looks at no more than
+// WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN bytes, and does not need that many to
+// recognize every format, but a prefix shorter than a format's magic number
+// cannot match that format. It returns zero if the prefix matches no format.
+static inline wuffs_base__image_format  //
+wuffs_base__image_format__sniff(wuffs_base__slice_u8 prefix) {
+  const uint8_t* p = prefix.ptr;
+  size_t n = prefix.len;
+  if (!p) {
+    return 0;
+  }
+  if ((n >= 8) && (p[0] == 0x89) && (p[1] == 'P') && (p[2] == 'N') &&
+      (p[3] == 'G') && (p[4] == 0x0D) && (p[5] == 0x0A) && (p[6] == 0x1A) &&
+      (p[7] == 0x0A)) {
+    return WUFFS_BASE__IMAGE_FORMAT__PNG;
+  }
+  if ((n >= 6) && (p[0] == 'G') && (p[1] == 'I') && (p[2] == 'F') &&
+      (p[3] == '8') && ((p[4] == '7') || (p[4] == '9')) && (p[5] == 'a')) {
+    return WUFFS_BASE__IMAGE_FORMAT__GIF;
+  }
+  if ((n >= 3) && (p[0] == 0xFF) && (p[1] == 0xD8) && (p[2] == 0xFF)) {
+    return WUFFS_BASE__IMAGE_FORMAT__JPEG;
+  }
+  if ((n >= 12) && (p[0] == 'R') && (p[1] == 'I') && (p[2] == 'F') &&
+      (p[3] == 'F') && (p[8] == 'W') && (p[9] == 'E') && (p[10] == 'B') &&
+      (p[11] == 'P')) {
+    return WUFFS_BASE__IMAGE_FORMAT__WEBP;
+  }
+  if ((n >= 4) &&
+      (((p[0] == 'I') && (p[1] == 'I') && (p[2] == 0x2A) && (p[3] == 0x00)) ||
+       ((p[0] == 'M') && (p[1] == 'M') && (p[2] == 0x00) && (p[3] == 0x2A)))) {
+    return WUFFS_BASE__IMAGE_FORMAT__TIFF;
+  }
+  if ((n >= 2) && (p[0] == 'B') && (p[1] == 'M')) {
+    return WUFFS_BASE__IMAGE_FORMAT__BMP;
+  }
+  return 0;
+}
+
+// --------
+
+// wuffs_base__image_decoder__vtable holds an image decoder type's methods,
+// each taking a type-erased self pointer. Packages generate one such vtable
+// for each decoder type that has decode_image_config, decode_frame_config,
+// decode_frame and workbuf_len methods with the usual signatures.
+typedef struct {
+  size_t sizeof_star_self;
+  wuffs_base__status (*check_wuffs_version)(void* self,
+                                            size_t sizeof_star_self,
+                                            uint64_t wuffs_version);
+  wuffs_base__status (*decode_image_config)(void* self,
+                                            wuffs_base__image_config* dst,
+                                            wuffs_base__io_reader src);
+  wuffs_base__status (*decode_frame_config)(void* self,
+                                            wuffs_base__frame_config* dst,
+                                            wuffs_base__io_reader src);
+  wuffs_base__status (*decode_frame)(void* self,
+                                     wuffs_base__pixel_buffer* dst,
+                                     wuffs_base__io_reader src,
+                                     wuffs_base__slice_u8 workbuf,
+                                     wuffs_base__decode_frame_options* opts);
+  wuffs_base__range_ii_u64 (*workbuf_len)(void* self);
+} wuffs_base__image_decoder__vtable;
+
+// wuffs_base__image_decoder is a format-agnostic image decoder: a decoder
+// (such as a wuffs_gif__decoder or a wuffs_png__decoder) and its vtable. Make
+// one by calling a package's upcast function, such as
+// wuffs_gif__decoder__upcast_as__wuffs_base__image_decoder, after sniffing
+// the format with wuffs_base__image_format__sniff.
+//
+// Upcasting does not allocate. The decoder memory is the caller's, and one
+// block of memory that is large enough for every decoder type that a program
+// uses (for example, a union of those types) can be re-used to decode images
+// of different formats, calling wuffs_base__image_decoder__initialize before
+// each new image.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    const wuffs_base__image_decoder__vtable* vtable;
+    void* self;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status initialize();
+  inline size_t sizeof_star_self();
+  inline wuffs_base__status decode_image_config(wuffs_base__image_config* dst,
+                                                wuffs_base__io_reader src);
+  inline wuffs_base__status decode_frame_config(wuffs_base__frame_config* dst,
+                                                wuffs_base__io_reader src);
+  inline wuffs_base__status decode_frame(
+      wuffs_base__pixel_buffer* dst,
+      wuffs_base__io_reader src,
+      wuffs_base__slice_u8 workbuf,
+      wuffs_base__decode_frame_options* opts);
+  inline wuffs_base__range_ii_u64 workbuf_len();
+#endif  // __cplusplus
+
+} wuffs_base__image_decoder;
+
+// wuffs_base__image_decoder__initialize zeroes the decoder's memory and then
+// calls its check_wuffs_version initializer, so that the memory can be re-used
+// for a new image, possibly of a different format than it last held.
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__initialize(wuffs_base__image_decoder* d) {
+  if (!d || !d->private_impl.vtable || !d->private_impl.self) {
+    return wuffs_base__error__bad_receiver;
+  }
+  const wuffs_base__image_decoder__vtable* v = d->private_impl.vtable;
+  memset(d->private_impl.self, 0, v->sizeof_star_self);
+  return (*v->check_wuffs_version)(d->private_impl.self, v->sizeof_star_self,
+                                   WUFFS_VERSION);
+}
+
+// wuffs_base__image_decoder__sizeof_star_self returns the size of the
+// underlying decoder, or zero if there is none.
+static inline size_t  //
+wuffs_base__image_decoder__sizeof_star_self(wuffs_base__image_decoder* d) {
+  return (d && d->private_impl.vtable)
+             ? d->private_impl.vtable->sizeof_star_self
+             : 0;
+}
+
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__decode_image_config(wuffs_base__image_decoder* d,
+                                               wuffs_base__image_config* dst,
+                                               wuffs_base__io_reader src) {
+  if (!d || !d->private_impl.vtable) {
+    return wuffs_base__error__bad_receiver;
+  }
+  return (*d->private_impl.vtable->decode_image_config)(d->private_impl.self,
+                                                        dst, src);
+}
+
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__decode_frame_config(wuffs_base__image_decoder* d,
+                                               wuffs_base__frame_config* dst,
+                                               wuffs_base__io_reader src) {
+  if (!d || !d->private_impl.vtable) {
+    return wuffs_base__error__bad_receiver;
+  }
+  return (*d->private_impl.vtable->decode_frame_config)(d->private_impl.self,
+                                                        dst, src);
+}
+
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__decode_frame(
+    wuffs_base__image_decoder* d,
+    wuffs_base__pixel_buffer* dst,
+    wuffs_base__io_reader src,
+    wuffs_base__slice_u8 workbuf,
+    wuffs_base__decode_frame_options* opts) {
+  if (!d || !d->private_impl.vtable) {
+    return wuffs_base__error__bad_receiver;
+  }
+  return (*d->private_impl.vtable->decode_frame)(d->private_impl.self, dst, src,
+                                                 workbuf, opts);
+}
+
+static inline wuffs_base__range_ii_u64  //
+wuffs_base__image_decoder__workbuf_len(wuffs_base__image_decoder* d) {
+  if (!d || !d->private_impl.vtable) {
+    return ((wuffs_base__range_ii_u64){});
+  }
+  return (*d->private_impl.vtable->workbuf_len)(d->private_impl.self);
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::initialize() {
+  return wuffs_base__image_decoder__initialize(this);
+}
+
+inline size_t  //
+wuffs_base__image_decoder::sizeof_star_self() {
+  return wuffs_base__image_decoder__sizeof_star_self(this);
+}
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::decode_image_config(wuffs_base__image_config* dst,
+                                               wuffs_base__io_reader src) {
+  return wuffs_base__image_decoder__decode_image_config(this, dst, src);
+}
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::decode_frame_config(wuffs_base__frame_config* dst,
+                                               wuffs_base__io_reader src) {
+  return wuffs_base__image_decoder__decode_frame_config(this, dst, src);
+}
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::decode_frame(
+    wuffs_base__pixel_buffer* dst,
+    wuffs_base__io_reader src,
+    wuffs_base__slice_u8 workbuf,
+    wuffs_base__decode_frame_options* opts) {
+  return wuffs_base__image_decoder__decode_frame(this, dst, src, workbuf, opts);
+}
+
+inline wuffs_base__range_ii_u64  //
+wuffs_base__image_decoder::workbuf_len() {
+  return wuffs_base__image_decoder__workbuf_len(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__resampler_filter is the filter that a wuffs_base__resampler
+// scales with:
+//  - Box averages the source pixels that each destination pixel covers. It is
+//    the fastest filter, and is nearest neighbor when scaling up.
+//  - Bilinear is a triangle (tent) filter.
+//  - Lanczos3 is a windowed sinc filter with 3 lobes. It is the sharpest
+//    filter, but its negative lobes can cause ringing near hard edges.
+//
+// When scaling down, each filter is widened by the scale factor, so that
+// every source pixel contributes to the result.
+typedef uint8_t wuffs_base__resampler_filter;
+
+#define WUFFS_BASE__RESAMPLER_FILTER__BOX ((wuffs_base__resampler_filter)1)
+#define WUFFS_BASE__RESAMPLER_FILTER__BILINEAR ((wuffs_base__resampler_filter)2)
+#define WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3 ((wuffs_base__resampler_filter)3)
+
+// wuffs_base__resampler scales an image to a destination pixel buffer, a
+// source row at a time, so that it can consume rows as a decoder produces
+// them, without a full size intermediate image. For example, the PNG
+// decoder's report_rows option decodes into a pixel buffer only one row high.
+//
+// The source and destination pixel format must be the same: BGRA or RGBA
+// (premultiplied or not), or BGRX or RGBX. Non-premultiplied pixels are
+// premultiplied before filtering, and un-premultiplied afterwards, so that
+// the color of transparent pixels does not bleed into their neighbors.
+//
+// Scaling is separable. Each destination row is a vertical pass, over a ring
+// of the most recent source rows, followed by a horizontal pass. The ring and
+// the per-row and per-column filter weights, 14 bit fixed point, live in a
+// caller-supplied work buffer, so that a resampler never allocates memory.
+// The weights depend only on the filter and the source and destination
+// sizes, so re-initializing with the same sizes and work buffer (for example,
+// for thumbnailing many same-sized images) re-uses them instead of
+// re-computing them. Callers that re-use a work buffer like this must not
+// modify its contents in between.
+//
+// When WUFFS_BASE__HAVE_SSE2 is defined, both passes process 4 pixels (16
+// bytes) at a time in SIMD registers.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    uint32_t magic;
+    wuffs_base__resampler_filter filter;
+    wuffs_base__pixel_format pixfmt;
+    uint32_t src_width;
+    uint32_t src_height;
+    uint32_t dst_width;
+    uint32_t dst_height;
+    wuffs_base__table_u8 dst;
+    wuffs_base__slice_u8 workbuf;
+
+    uint32_t x_taps;
+    uint32_t y_taps;
+    uint32_t* x_spans;
+    uint32_t* y_spans;
+    int16_t* x_weights;
+    int16_t* y_weights;
+    uint8_t** y_rows;
+    uint8_t* vrow;
+    uint8_t* ring;
+    size_t ring_stride;
+
+    uint32_t num_src_rows;
+    uint32_t num_dst_rows;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status initialize(wuffs_base__resampler_filter filter,
+                                       uint32_t src_width,
+                                       uint32_t src_height,
+                                       wuffs_base__pixel_buffer* dst,
+                                       wuffs_base__slice_u8 workbuf);
+  inline wuffs_base__status consume_row(wuffs_base__slice_u8 src_row);
+  inline wuffs_base__status resample(wuffs_base__pixel_buffer* src);
+  inline uint32_t num_dst_rows();
+#endif  // __cplusplus
+
+} wuffs_base__resampler;
+
+// wuffs_base__resampler__workbuf_len returns the work buffer length needed to
+// scale a src_width × src_height image to dst_width × dst_height, or zero if
+// the filter is invalid or a dimension is zero or more than 0xFFFFFF.
+WUFFS_BASE__MAYBE_STATIC uint64_t  //
+wuffs_base__resampler__workbuf_len(wuffs_base__resampler_filter filter,
+                                   uint32_t src_width,
+                                   uint32_t src_height,
+                                   uint32_t dst_width,
+                                   uint32_t dst_height);
+
+// wuffs_base__resampler__initialize prepares to scale a src_width ×
+// src_height image, in dst's pixel format, to fill dst. The resampler should
+// be zeroed before it is first initialized. Call it again to start another
+// image. The workbuf needs no particular alignment, but its length must be at
+// least wuffs_base__resampler__workbuf_len, and its contents must be left
+// alone while the resampler uses it.
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__initialize(wuffs_base__resampler* r,
+                                  wuffs_base__resampler_filter filter,
+                                  uint32_t src_width,
+                                  uint32_t src_height,
+                                  wuffs_base__pixel_buffer* dst,
+                                  wuffs_base__slice_u8 workbuf);
+
+// wuffs_base__resampler__consume_row takes the next source row, whose first
+// (src_width × 4) bytes are its pixels, and writes every destination row that
+// it completes. The source row's memory can be re-used as soon as this
+// returns.
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__consume_row(wuffs_base__resampler* r,
+                                   wuffs_base__slice_u8 src_row);
+
+// wuffs_base__resampler__resample consumes every row of src, which must have
+// the source width, height and pixel format, at once.
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__resample(wuffs_base__resampler* r,
+                                wuffs_base__pixel_buffer* src);
+
+// wuffs_base__resampler__num_dst_rows returns the number of destination rows
+// written so far. They are the rows at the top of the destination.
+static inline uint32_t  //
+wuffs_base__resampler__num_dst_rows(wuffs_base__resampler* r) {
+  return r ? r->private_impl.num_dst_rows : 0;
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__resampler::initialize(wuffs_base__resampler_filter filter,
+                                  uint32_t src_width,
+                                  uint32_t src_height,
+                                  wuffs_base__pixel_buffer* dst,
+                                  wuffs_base__slice_u8 workbuf) {
+  return wuffs_base__resampler__initialize(this, filter, src_width, src_height,
+                                           dst, workbuf);
+}
+
+inline wuffs_base__status  //
+wuffs_base__resampler::consume_row(wuffs_base__slice_u8 src_row) {
+  return wuffs_base__resampler__consume_row(this, src_row);
+}
+
+inline wuffs_base__status  //
+wuffs_base__resampler::resample(wuffs_base__pixel_buffer* src) {
+  return wuffs_base__resampler__resample(this, src);
+}
+
+inline uint32_t  //
+wuffs_base__resampler::num_dst_rows() {
+  return wuffs_base__resampler__num_dst_rows(this);
+}
+
 #endif  // __cplusplus
 
 #ifdef __cplusplus
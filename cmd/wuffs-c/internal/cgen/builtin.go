@@ -79,19 +79,7 @@ func (g *gen) writeBuiltinCall(b *buffer, n *a.Expr, rp replacementPolicy, depth
 func (g *gen) writeBuiltinIO(b *buffer, recv *a.Expr, method t.ID, args []*a.Node, rp replacementPolicy, depth uint32) error {
 	switch method {
 	case t.IDAvailable:
-		p0, p1 := "", ""
-		// TODO: don't hard-code these.
-		switch recv.Str(g.tm) {
-		case "args.dst":
-			p0 = "io1_a_dst"
-			p1 = "iop_a_dst"
-		case "args.src":
-			p0 = "io1_a_src"
-			p1 = "iop_a_src"
-		case "w":
-			p0 = "io1_v_w"
-			p1 = "iop_v_w"
-		}
+		p0, p1 := g.ioRecvPointers(recv)
 		if p0 == "" {
 			return fmt.Errorf(`TODO: cgen a "foo.available" expression`)
 		}
@@ -103,14 +91,36 @@ func (g *gen) writeBuiltinIO(b *buffer, recv *a.Expr, method t.ID, args []*a.Nod
 		if len(args) == 1 {
 			typ = "writer"
 		}
-		// TODO: don't hard-code v_w and u_w.
-		b.printf("wuffs_base__io_%s__set(&v_w, &u_w, &iop_v_w, &io1_v_w,", typ)
+		if recv.Operator() != 0 {
+			return fmt.Errorf(`TODO: cgen a "foo.set" expression`)
+		}
+		name := recv.Ident().Str(g.tm)
+		b.printf("wuffs_base__io_%s__set(&%s%s, &%s%s, &%s%s%s, &%s%s%s,", typ,
+			vPrefix, name, uPrefix, name, iopPrefix, vPrefix, name, io1Prefix, vPrefix, name)
 		return g.writeArgs(b, args, rp, depth)
 
 	}
 	return errNoSuchBuiltin
 }
 
+// ioRecvPointers returns the C names of the io1 (limit) and iop (pointer)
+// variables for an io_reader or io_writer receiver, or empty strings if the
+// receiver is neither args.dst, args.src nor a local variable.
+func (g *gen) ioRecvPointers(recv *a.Expr) (p0 string, p1 string) {
+	// TODO: don't hard-code these.
+	switch recv.Str(g.tm) {
+	case "args.dst":
+		return "io1_a_dst", "iop_a_dst"
+	case "args.src":
+		return "io1_a_src", "iop_a_src"
+	}
+	if recv.Operator() == 0 {
+		name := recv.Ident().Str(g.tm)
+		return io1Prefix + vPrefix + name, iopPrefix + vPrefix + name
+	}
+	return "", ""
+}
+
 func (g *gen) writeBuiltinIOReader(b *buffer, recv *a.Expr, method t.ID, args []*a.Node, rp replacementPolicy, depth uint32) error {
 	// TODO: don't hard-code the recv being a_src.
 	switch method {
@@ -122,6 +132,10 @@ func (g *gen) writeBuiltinIOReader(b *buffer, recv *a.Expr, method t.ID, args []
 		b.writes("(iop_a_src > io0_a_src)")
 		return nil
 
+	case t.IDIsEOF:
+		b.printf("wuffs_base__io_reader__is_eof(%ssrc)", aPrefix)
+		return nil
+
 	case t.IDPosition:
 		b.printf("(a_src.private_impl.buf ? wuffs_base__u64__sat_add(" +
 			"a_src.private_impl.buf->meta.pos, iop_a_src - a_src.private_impl.buf->data.ptr) : 0)")
@@ -149,7 +163,7 @@ func (g *gen) writeBuiltinIOReader(b *buffer, recv *a.Expr, method t.ID, args []
 		// call (to a static inline function) instead of a struct literal, to
 		// avoid a "expression result unused" compiler error.
 		b.writes("(iop_a_src += ")
-		if err := g.writeExpr(b, args[1].AsArg().Value(), rp, depth); err != nil {
+		if err := g.writeExpr(b, args[0].AsArg().Value(), rp, depth); err != nil {
 			return err
 		}
 		b.writes(", wuffs_base__return_empty_struct())")
@@ -189,7 +203,11 @@ func (g *gen) writeBuiltinIOWriter(b *buffer, recv *a.Expr, method t.ID, args []
 		return nil
 
 	case t.IDCopyNFromReader:
-		b.printf("wuffs_base__io_writer__copy_n_from_reader(&iop_a_dst, io1_a_dst,")
+		p0, p1 := g.ioRecvPointers(recv)
+		if p0 == "" {
+			return fmt.Errorf(`TODO: cgen a "foo.copy_n_from_reader" expression`)
+		}
+		b.printf("wuffs_base__io_writer__copy_n_from_reader(&%s, %s,", p1, p0)
 		if err := g.writeExpr(b, args[0].AsArg().Value(), rp, depth); err != nil {
 			return err
 		}
@@ -339,6 +357,15 @@ func (g *gen) writeBuiltinSlice(b *buffer, recv *a.Expr, method t.ID, args []*a.
 		b.writes(".len))")
 		return nil
 
+	case t.IDPrefix:
+		// TODO: don't assume that the slice is a slice of base.u8.
+		b.writes("wuffs_base__slice_u8__prefix(")
+		if err := g.writeExpr(b, recv, rp, depth); err != nil {
+			return err
+		}
+		b.writeb(',')
+		return g.writeArgs(b, args, rp, depth)
+
 	case t.IDSuffix:
 		// TODO: don't assume that the slice is a slice of base.u8.
 		b.writes("wuffs_base__slice_u8__suffix(")
@@ -347,6 +374,17 @@ func (g *gen) writeBuiltinSlice(b *buffer, recv *a.Expr, method t.ID, args []*a.
 		}
 		b.writeb(',')
 		return g.writeArgs(b, args, rp, depth)
+
+	case t.IDUnfilterAverage, t.IDUnfilterPaeth, t.IDUnfilterSub, t.IDUnfilterUp,
+		t.IDConvertYCC, t.IDIDCT8x8, t.IDIDCT8x8Downscaled,
+		t.IDFilterAverage, t.IDFilterNone, t.IDFilterPaeth, t.IDFilterSub, t.IDFilterUp:
+		// TODO: don't assume that the slice is a slice of base.u8.
+		b.printf("wuffs_base__slice_u8__%s(", method.Str(g.tm))
+		if err := g.writeExpr(b, recv, rp, depth); err != nil {
+			return err
+		}
+		b.writeb(',')
+		return g.writeArgs(b, args, rp, depth)
 	}
 	return errNoSuchBuiltin
 }
@@ -71,13 +71,14 @@ const (
 // At the start of a function, these pointers are initialized from an
 // io_buffer's fields (ptr, ri, wi, len), or possibly a limit field. For an
 // io_reader:
-//  - io0_etc = ptr + ri
-//  - iop_etc = ptr + ri
-//  - io1_etc = ptr + wi   or  limit
+//   - io0_etc = ptr + ri
+//   - iop_etc = ptr + ri
+//   - io1_etc = ptr + wi   or  limit
+//
 // and for an io_writer:
-//  - io0_etc = ptr + wi
-//  - iop_etc = ptr + wi
-//  - io1_etc = ptr + len  or  limit
+//   - io0_etc = ptr + wi
+//   - iop_etc = ptr + wi
+//   - io1_etc = ptr + len  or  limit
 //
 // TODO: discuss marks and limits, and how (if at all) auxilliary pointers can
 // change over a function's lifetime.
@@ -111,6 +112,10 @@ func Do(args []string) error {
 			if err := expandBangBangInsert(&buf, baseBaseImplC, map[string]func(*buffer) error{
 				"// !! INSERT base-private.h.\n": insertBasePrivateH,
 				"// !! INSERT base-public.h.\n":  insertBasePublicH,
+				"// !! INSERT image-impl.c.\n": func(b *buffer) error {
+					b.writes(baseImageImplC)
+					return nil
+				},
 				"// !! INSERT wuffs_base__status strings.\n": func(b *buffer) error {
 					for _, z := range builtin.StatusList {
 						if z == "" {
@@ -394,6 +399,11 @@ func (g *gen) genHeader(b *buffer) error {
 		return err
 	}
 
+	b.writes("// ---------------- Public Upcast Prototypes\n\n")
+	if err := g.writeUpcastPrototypes(b); err != nil {
+		return err
+	}
+
 	b.writes("// ---------------- C++ Convenience Methods \n\n")
 	if err := g.writeCppImpls(b); err != nil {
 		return err
@@ -452,6 +462,11 @@ func (g *gen) genImpl(b *buffer) error {
 		return err
 	}
 
+	b.writes("// ---------------- Upcast Implementations\n\n")
+	if err := g.writeUpcastImpls(b); err != nil {
+		return err
+	}
+
 	b.printf("#endif  // %s\n\n", module)
 	return nil
 }
@@ -717,6 +732,12 @@ func (g *gen) writeCppPrototypes(b *buffer, n *a.Struct) error {
 		}
 	}
 
+	if ok, err := g.isImageDecoder(n); err != nil {
+		return err
+	} else if ok {
+		b.writes("inline wuffs_base__image_decoder upcast_as__wuffs_base__image_decoder();\n")
+	}
+
 	b.writes("#endif  // __cplusplus\n\n")
 	return nil
 }
@@ -744,6 +765,15 @@ func (g *gen) writeCppImpls(b *buffer) error {
 				g.pkgPrefix, structName)
 			b.printf("}\n\n")
 
+			if ok, err := g.isImageDecoder(n); err != nil {
+				return err
+			} else if ok {
+				b.writes("inline wuffs_base__image_decoder //\n")
+				b.printf("%s%s::upcast_as__wuffs_base__image_decoder() {\n", g.pkgPrefix, structName)
+				b.printf("return %s%s__upcast_as__wuffs_base__image_decoder(this);\n", g.pkgPrefix, structName)
+				b.printf("}\n\n")
+			}
+
 			publicStructs[structID] = true
 		}
 	}
@@ -78,10 +78,11 @@ const baseBasePublicH = "" +
 	""
 
 const baseBasePrivateH = "" +
-	"#ifndef WUFFS_INCLUDE_GUARD__BASE_PRIVATE\n#define WUFFS_INCLUDE_GUARD__BASE_PRIVATE\n\n// Copyright 2017 The Wuffs Authors.\n//\n// Licensed under the Apache License, Version 2.0 (the \"License\");\n// you may not use this file except in compliance with the License.\n// You may obtain a copy of the License at\n//\n//    https://www.apache.org/licenses/LICENSE-2.0\n//\n// Unless required by applicable law or agreed to in writing, software\n// distributed under the License is distributed on an \"AS IS\" BASIS,\n// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n// See the License for the specific language governing permissions and\n// limitations under the License.\n\n#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n#define WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(x) (void)(x)\n\nstatic inline void wuffs_base__ignore_check_wuffs_version_status(\n    wuffs_base__status z) {}\n\n// WUFFS_BASE__MAGIC is a magic number to check that initializers are called.\n// It's not foolproof, given C doesn't automatically zero me" +
-	"mory before use,\n// but it should catch 99.99% of cases.\n//\n// Its (non-zero) value is arbitrary, based on md5sum(\"wuffs\").\n#define WUFFS_BASE__MAGIC ((uint32_t)0x3CCB6C71)\n\n// WUFFS_BASE__DISABLED is a magic number to indicate that a non-recoverable\n// error was previously encountered.\n//\n// Its (non-zero) value is arbitrary, based on md5sum(\"disabled\").\n#define WUFFS_BASE__DISABLED ((uint32_t)0x075AE3D2)\n\n// Denote intentional fallthroughs for -Wimplicit-fallthrough.\n//\n// The order matters here. Clang also defines \"__GNUC__\".\n#if defined(__clang__) && __cplusplus >= 201103L\n#define WUFFS_BASE__FALLTHROUGH [[clang::fallthrough]]\n#elif !defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 7)\n#define WUFFS_BASE__FALLTHROUGH __attribute__((fallthrough))\n#else\n#define WUFFS_BASE__FALLTHROUGH\n#endif\n\n// Use switch cases for coroutine suspension points, similar to the technique\n// in https://www.chiark.greenend.org.uk/~sgtatham/coroutines.html\n//\n// We use trivial macros instead of an explicit assignment and c" +
-	"ase statement\n// so that clang-format doesn't get confused by the unusual \"case\"s.\n#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0 case 0:;\n#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT(n) \\\n  coro_susp_point = n;                            \\\n  WUFFS_BASE__FALLTHROUGH;                        \\\n  case n:;\n\n#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(n) \\\n  if (!status) {                                                \\\n    goto ok;                                                    \\\n  } else if (*status != '$') {                                  \\\n    goto exit;                                                  \\\n  }                                                             \\\n  coro_susp_point = n;                                          \\\n  goto suspend;                                                 \\\n  case n:;\n\n// Clang also defines \"__GNUC__\".\n#if defined(__GNUC__)\n#define WUFFS_BASE__LIKELY(expr) (__builtin_expect(!!(expr), 1))\n#define WUFFS_BASE__UNLIKELY(expr) (__builtin_expect(!" +
-	"!(expr), 0))\n#else\n#define WUFFS_BASE__LIKELY(expr) (expr)\n#define WUFFS_BASE__UNLIKELY(expr) (expr)\n#endif\n\n// The helpers below are functions, instead of macros, because their arguments\n// can be an expression that we shouldn't evaluate more than once.\n//\n// They are static, so that linking multiple wuffs .o files won't complain about\n// duplicate function definitions.\n//\n// They are explicitly marked inline, even if modern compilers don't use the\n// inline attribute to guide optimizations such as inlining, to avoid the\n// -Wunused-function warning, and we like to compile with -Wall -Werror.\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__return_empty_struct() {\n  return ((wuffs_base__empty_struct){});\n}\n\n" +
+	"#ifndef WUFFS_INCLUDE_GUARD__BASE_PRIVATE\n#define WUFFS_INCLUDE_GUARD__BASE_PRIVATE\n\n// Copyright 2017 The Wuffs Authors.\n//\n// Licensed under the Apache License, Version 2.0 (the \"License\");\n// you may not use this file except in compliance with the License.\n// You may obtain a copy of the License at\n//\n//    https://www.apache.org/licenses/LICENSE-2.0\n//\n// Unless required by applicable law or agreed to in writing, software\n// distributed under the License is distributed on an \"AS IS\" BASIS,\n// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n// See the License for the specific language governing permissions and\n// limitations under the License.\n\n// WUFFS_BASE__HAVE_SSE2 and WUFFS_BASE__HAVE_SSSE3 are defined when the\n// compiler targets those x86 instruction set extensions, such as SSE2 for any\n// x86_64 CPU, or SSSE3 with \"-mssse3\", unless WUFFS_CONFIG__NO_SIMD is\n// defined. Wuffs does not detect CPU features at run time.\n#if !defined(WUFFS_CONFIG__NO_SIMD) && defined(__SSE2__)\n#d" +
+	"efine WUFFS_BASE__HAVE_SSE2\n#include <emmintrin.h>\n#if defined(__SSSE3__)\n#define WUFFS_BASE__HAVE_SSSE3\n#include <tmmintrin.h>\n#endif\n#endif\n\n#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n#define WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(x) (void)(x)\n\nstatic inline void wuffs_base__ignore_check_wuffs_version_status(\n    wuffs_base__status z) {}\n\n// WUFFS_BASE__MAGIC is a magic number to check that initializers are called.\n// It's not foolproof, given C doesn't automatically zero memory before use,\n// but it should catch 99.99% of cases.\n//\n// Its (non-zero) value is arbitrary, based on md5sum(\"wuffs\").\n#define WUFFS_BASE__MAGIC ((uint32_t)0x3CCB6C71)\n\n// WUFFS_BASE__DISABLED is a magic number to indicate that a non-recoverable\n// error was previously encountered.\n//\n// Its (non-zero) value is arbitrary, based on md5sum(\"disabled\").\n#define WUFFS_BASE__DISABLED ((uint32_t)0x075AE3D2)\n\n// Denote intentional fallthroughs for -Wimplicit-fallthrough.\n//\n// The order matters here. Clang also defines \"__GNUC__\".\n#if" +
+	" defined(__clang__) && __cplusplus >= 201103L\n#define WUFFS_BASE__FALLTHROUGH [[clang::fallthrough]]\n#elif !defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 7)\n#define WUFFS_BASE__FALLTHROUGH __attribute__((fallthrough))\n#else\n#define WUFFS_BASE__FALLTHROUGH\n#endif\n\n// Use switch cases for coroutine suspension points, similar to the technique\n// in https://www.chiark.greenend.org.uk/~sgtatham/coroutines.html\n//\n// We use trivial macros instead of an explicit assignment and case statement\n// so that clang-format doesn't get confused by the unusual \"case\"s.\n#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0 case 0:;\n#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT(n) \\\n  coro_susp_point = n;                            \\\n  WUFFS_BASE__FALLTHROUGH;                        \\\n  case n:;\n\n#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(n) \\\n  if (!status) {                                                \\\n    goto ok;                                                    \\\n  } else if (*status != '$') { " +
+	"                                 \\\n    goto exit;                                                  \\\n  }                                                             \\\n  coro_susp_point = n;                                          \\\n  goto suspend;                                                 \\\n  case n:;\n\n// Clang also defines \"__GNUC__\".\n#if defined(__GNUC__)\n#define WUFFS_BASE__LIKELY(expr) (__builtin_expect(!!(expr), 1))\n#define WUFFS_BASE__UNLIKELY(expr) (__builtin_expect(!!(expr), 0))\n#else\n#define WUFFS_BASE__LIKELY(expr) (expr)\n#define WUFFS_BASE__UNLIKELY(expr) (expr)\n#endif\n\n// The helpers below are functions, instead of macros, because their arguments\n// can be an expression that we shouldn't evaluate more than once.\n//\n// They are static, so that linking multiple wuffs .o files won't complain about\n// duplicate function definitions.\n//\n// They are explicitly marked inline, even if modern compilers don't use the\n// inline attribute to guide optimizations such as inlining, to avoid the\n// -Wunuse" +
+	"d-function warning, and we like to compile with -Wall -Werror.\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__return_empty_struct() {\n  return ((wuffs_base__empty_struct){});\n}\n\n" +
 	"" +
 	"// ---------------- Numeric Types\n\nstatic inline uint8_t  //\nwuffs_base__load_u8be(uint8_t* p) {\n  return p[0];\n}\n\nstatic inline uint16_t  //\nwuffs_base__load_u16be(uint8_t* p) {\n  return ((uint16_t)(p[0]) << 8) | ((uint16_t)(p[1]) << 0);\n}\n\nstatic inline uint16_t  //\nwuffs_base__load_u16le(uint8_t* p) {\n  return ((uint16_t)(p[0]) << 0) | ((uint16_t)(p[1]) << 8);\n}\n\nstatic inline uint32_t  //\nwuffs_base__load_u24be(uint8_t* p) {\n  return ((uint32_t)(p[0]) << 16) | ((uint32_t)(p[1]) << 8) |\n         ((uint32_t)(p[2]) << 0);\n}\n\nstatic inline uint32_t  //\nwuffs_base__load_u24le(uint8_t* p) {\n  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |\n         ((uint32_t)(p[2]) << 16);\n}\n\nstatic inline uint32_t  //\nwuffs_base__load_u32be(uint8_t* p) {\n  return ((uint32_t)(p[0]) << 24) | ((uint32_t)(p[1]) << 16) |\n         ((uint32_t)(p[2]) << 8) | ((uint32_t)(p[3]) << 0);\n}\n\nstatic inline uint32_t  //\nwuffs_base__load_u32le(uint8_t* p) {\n  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |\n         ((uin" +
 	"t32_t)(p[2]) << 16) | ((uint32_t)(p[3]) << 24);\n}\n\nstatic inline uint64_t  //\nwuffs_base__load_u40be(uint8_t* p) {\n  return ((uint64_t)(p[0]) << 32) | ((uint64_t)(p[1]) << 24) |\n         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 8) |\n         ((uint64_t)(p[4]) << 0);\n}\n\nstatic inline uint64_t  //\nwuffs_base__load_u40le(uint8_t* p) {\n  return ((uint64_t)(p[0]) << 0) | ((uint64_t)(p[1]) << 8) |\n         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 24) |\n         ((uint64_t)(p[4]) << 32);\n}\n\nstatic inline uint64_t  //\nwuffs_base__load_u48be(uint8_t* p) {\n  return ((uint64_t)(p[0]) << 40) | ((uint64_t)(p[1]) << 32) |\n         ((uint64_t)(p[2]) << 24) | ((uint64_t)(p[3]) << 16) |\n         ((uint64_t)(p[4]) << 8) | ((uint64_t)(p[5]) << 0);\n}\n\nstatic inline uint64_t  //\nwuffs_base__load_u48le(uint8_t* p) {\n  return ((uint64_t)(p[0]) << 0) | ((uint64_t)(p[1]) << 8) |\n         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 24) |\n         ((uint64_t)(p[4]) << 32) | ((uint64_t)(p[5]) << 40);\n}\n\nstatic inline u" +
@@ -99,22 +100,108 @@ const baseBasePrivateH = "" +
 	"" +
 	"// --------\n\nstatic inline wuffs_base__slice_u8  //\nwuffs_base__table_u8__row(wuffs_base__table_u8 t, uint32_t y) {\n  if (y < t.height) {\n    return ((wuffs_base__slice_u8){\n        .ptr = t.ptr + (t.stride * y),\n        .len = t.width,\n    });\n  }\n  return ((wuffs_base__slice_u8){});\n}\n\n" +
 	"" +
+	"// ---------------- Unfilters\n\n// The wuffs_base__slice_u8__unfilter_etc functions undo, in place, the PNG\n// image format's per-row filters (Sub, Up, Average and Paeth), which predict\n// each byte from the byte distance bytes to its left (or zero, if there is\n// none) and from the byte above it in prev. An empty prev means that the row\n// above is all zeroes, as it is for an image's first row. Otherwise, only the\n// first min(curr.len, prev.len) bytes of curr are unfiltered. The distance is\n// the number of bytes per (whole) pixel, from 1 to 8, and zero is a no-op.\n//\n// When WUFFS_BASE__HAVE_SSE2 is defined, Average and Paeth with distances of 3\n// and 4 (RGB and RGBA) process a pixel at a time in SIMD registers. The\n// __fallback variants are portable C, used for other distances and for CPUs\n// without SSE2. Sub and Up always use them: compilers already vectorize Up,\n// and Sub's byte loop, with distance independent dependency chains, measured\n// faster than a pixel at a time SSE2 loop.\n\nstatic inline void" +
+	"  //\nwuffs_base__slice_u8__unfilter_sub__fallback(wuffs_base__slice_u8 curr,\n                                             uint32_t distance) {\n  if ((distance == 0) || (distance > curr.len)) {\n    return;\n  }\n  uint8_t* c = curr.ptr + distance;\n  uint8_t* end = curr.ptr + curr.len;\n  for (; c < end; c++) {\n    c[0] += *(c - distance);\n  }\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_up__fallback(wuffs_base__slice_u8 curr,\n                                            wuffs_base__slice_u8 prev) {\n  size_t n = curr.len < prev.len ? curr.len : prev.len;\n  size_t i;\n  for (i = 0; i < n; i++) {\n    curr.ptr[i] += prev.ptr[i];\n  }\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_average__fallback(wuffs_base__slice_u8 curr,\n                                                 wuffs_base__slice_u8 prev,\n                                                 uint32_t distance) {\n  if ((distance == 0) || (distance > curr.len)) {\n    return;\n  }\n  size_t i;\n  if (prev.len == 0) {\n    for (i = distance; i < curr." +
+	"len; i++) {\n      curr.ptr[i] += curr.ptr[i - distance] / 2;\n    }\n    return;\n  }\n  size_t n = curr.len < prev.len ? curr.len : prev.len;\n  for (i = 0; (i < distance) && (i < n); i++) {\n    curr.ptr[i] += prev.ptr[i] / 2;\n  }\n  for (; i < n; i++) {\n    curr.ptr[i] += (uint8_t)(\n        ((uint32_t)(curr.ptr[i - distance]) + (uint32_t)(prev.ptr[i])) / 2);\n  }\n}\n\n// wuffs_base__private_paeth returns whichever of a (left), b (above) and c\n// (above-left) is closest to (a + b - c), breaking ties in that order.\nstatic inline uint8_t  //\nwuffs_base__private_paeth(uint8_t a, uint8_t b, uint8_t c) {\n  int32_t pa = (int32_t)(b) - (int32_t)(c);\n  int32_t pb = (int32_t)(a) - (int32_t)(c);\n  int32_t pc = pa + pb;\n  pa = pa < 0 ? -pa : pa;\n  pb = pb < 0 ? -pb : pb;\n  pc = pc < 0 ? -pc : pc;\n  if ((pa <= pb) && (pa <= pc)) {\n    return a;\n  } else if (pb <= pc) {\n    return b;\n  }\n  return c;\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_paeth__fallback(wuffs_base__slice_u8 curr,\n                                " +
+	"               wuffs_base__slice_u8 prev,\n                                               uint32_t distance) {\n  if (prev.len == 0) {\n    // With a row of zeroes above, the Paeth predictor is the left byte.\n    wuffs_base__slice_u8__unfilter_sub__fallback(curr, distance);\n    return;\n  }\n  if ((distance == 0) || (distance > curr.len)) {\n    return;\n  }\n  size_t n = curr.len < prev.len ? curr.len : prev.len;\n  size_t i;\n  for (i = 0; (i < distance) && (i < n); i++) {\n    curr.ptr[i] += prev.ptr[i];\n  }\n  for (; i < n; i++) {\n    curr.ptr[i] += wuffs_base__private_paeth(\n        curr.ptr[i - distance], prev.ptr[i], prev.ptr[i - distance]);\n  }\n}\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n\n// wuffs_base__private_load_pixel and wuffs_base__private_store_pixel move a 3\n// or 4 byte pixel between memory and the low bytes of a SIMD register,\n// without touching any memory beyond that pixel. A 3 byte pixel is assembled\n// in a general purpose register, not via memcpy to and from the stack, as\n// mixing narrow stores with a w" +
+	"ide load stalls store-to-load forwarding.\nstatic inline __m128i  //\nwuffs_base__private_load_pixel(uint8_t* p, uint32_t distance) {\n  uint32_t x = (distance == 3) ? wuffs_base__load_u24le(p)\n                               : wuffs_base__load_u32le(p);\n  return _mm_cvtsi32_si128((int)(x));\n}\n\nstatic inline void  //\nwuffs_base__private_store_pixel(uint8_t* p, __m128i v, uint32_t distance) {\n  uint32_t x = (uint32_t)(_mm_cvtsi128_si32(v));\n  if (distance == 3) {\n    wuffs_base__store_u24le(p, x);\n  } else {\n    wuffs_base__store_u32le(p, x);\n  }\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_average__sse2(wuffs_base__slice_u8 curr,\n                                             wuffs_base__slice_u8 prev,\n                                             uint32_t distance) {\n  __m128i one = _mm_set1_epi8(1);\n  __m128i a = _mm_setzero_si128();\n  size_t n = curr.len < prev.len ? curr.len : prev.len;\n  uint8_t* c = curr.ptr;\n  uint8_t* p = prev.ptr;\n  for (; n >= distance; n -= distance, c += distance, p += distan" +
+	"ce) {\n    // _mm_avg_epu8 rounds up, but the Average filter rounds down.\n    __m128i b = wuffs_base__private_load_pixel(p, distance);\n    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),\n                               _mm_and_si128(_mm_xor_si128(a, b), one));\n    a = _mm_add_epi8(avg, wuffs_base__private_load_pixel(c, distance));\n    wuffs_base__private_store_pixel(c, a, distance);\n  }\n  for (; n > 0; n--, c++, p++) {\n    c[0] += (uint8_t)(((uint32_t)(*(c - distance)) + p[0]) / 2);\n  }\n}\n\nstatic inline __m128i  //\nwuffs_base__private_abs_epi16(__m128i x) {\n#if defined(WUFFS_BASE__HAVE_SSSE3)\n  return _mm_abs_epi16(x);\n#else\n  return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));\n#endif\n}\n\n// wuffs_base__slice_u8__unfilter_paeth__sse2 widens each pixel's bytes to 16\n// bit lanes, so that the Paeth distances can be computed without overflow.\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_paeth__sse2(wuffs_base__slice_u8 curr,\n                                           wuffs_base__slice_u8 prev,\n " +
+	"                                          uint32_t distance) {\n  __m128i zero = _mm_setzero_si128();\n  __m128i a = zero;\n  __m128i c = zero;\n  size_t n = curr.len < prev.len ? curr.len : prev.len;\n  uint8_t* q = curr.ptr;\n  uint8_t* p = prev.ptr;\n  for (; n >= distance; n -= distance, q += distance, p += distance) {\n    __m128i b = _mm_unpacklo_epi8(wuffs_base__private_load_pixel(p, distance),\n                                  zero);\n    __m128i x = _mm_unpacklo_epi8(wuffs_base__private_load_pixel(q, distance),\n                                  zero);\n    __m128i pa = _mm_sub_epi16(b, c);\n    __m128i pb = _mm_sub_epi16(a, c);\n    __m128i pc = wuffs_base__private_abs_epi16(_mm_add_epi16(pa, pb));\n    pa = wuffs_base__private_abs_epi16(pa);\n    pb = wuffs_base__private_abs_epi16(pb);\n    // Select a, else b, else c, breaking ties in that order.\n    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));\n    __m128i use_a = _mm_cmpeq_epi16(smallest, pa);\n    __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq" +
+	"_epi16(smallest, pb));\n    __m128i use_c = _mm_andnot_si128(_mm_or_si128(use_a, use_b),\n                                     _mm_set1_epi16(-1));\n    __m128i predictor = _mm_or_si128(\n        _mm_or_si128(_mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),\n        _mm_and_si128(use_c, c));\n    // The high byte of each 16 bit lane is zero in both x and predictor, so\n    // a byte-wise add wraps modulo 256 and keeps those high bytes zero.\n    a = _mm_add_epi8(x, predictor);\n    c = b;\n    wuffs_base__private_store_pixel(q, _mm_packus_epi16(a, a), distance);\n  }\n  for (; n > 0; n--, q++, p++) {\n    q[0] += wuffs_base__private_paeth(*(q - distance), p[0],\n                                      *(p - distance));\n  }\n}\n\n#endif  // defined(WUFFS_BASE__HAVE_SSE2)\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_sub(wuffs_base__slice_u8 curr,\n                                   uint32_t distance) {\n  wuffs_base__slice_u8__unfilter_sub__fallback(curr, distance);\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilt" +
+	"er_up(wuffs_base__slice_u8 curr,\n                                  wuffs_base__slice_u8 prev) {\n  wuffs_base__slice_u8__unfilter_up__fallback(curr, prev);\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_average(wuffs_base__slice_u8 curr,\n                                       wuffs_base__slice_u8 prev,\n                                       uint32_t distance) {\n#if defined(WUFFS_BASE__HAVE_SSE2)\n  if (((distance == 3) || (distance == 4)) && (distance <= curr.len) &&\n      (distance <= prev.len)) {\n    wuffs_base__slice_u8__unfilter_average__sse2(curr, prev, distance);\n    return;\n  }\n#endif\n  wuffs_base__slice_u8__unfilter_average__fallback(curr, prev, distance);\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__unfilter_paeth(wuffs_base__slice_u8 curr,\n                                     wuffs_base__slice_u8 prev,\n                                     uint32_t distance) {\n  if (prev.len == 0) {\n    // With a row of zeroes above, the Paeth predictor is the left byte.\n    wuffs_base__slice_u8__unfilter_" +
+	"sub(curr, distance);\n    return;\n  }\n#if defined(WUFFS_BASE__HAVE_SSE2)\n  if (((distance == 3) || (distance == 4)) && (distance <= curr.len) &&\n      (distance <= prev.len)) {\n    wuffs_base__slice_u8__unfilter_paeth__sse2(curr, prev, distance);\n    return;\n  }\n#endif\n  wuffs_base__slice_u8__unfilter_paeth__fallback(curr, prev, distance);\n}\n\n" +
+	"" +
+	"// ---------------- Filters\n\n// The wuffs_base__slice_u8__filter_etc functions apply the PNG image format's\n// per-row filters (None, Sub, Up, Average and Paeth) to curr, writing the\n// filtered bytes to dst. They are the inverse of the unfilter_etc functions,\n// with the same prev and distance conventions, except that curr is not\n// modified, dst must not overlap curr or prev, and a zero distance (for every\n// filter but None and Up) means that nothing is written. Only the first\n// min(dst.len, curr.len) bytes are filtered, or fewer if prev is non-empty\n// but shorter than that.\n//\n// They return the sum, over the filtered bytes, of each byte's absolute value\n// when read as a signed byte. Picking the filter with the smallest sum is the\n// \"minimum sum of absolute differences\" heuristic that the PNG specification\n// recommends, and that libpng uses by default.\n//\n// When WUFFS_BASE__HAVE_SSE2 is defined, every filter processes 16 bytes at a\n// time, for any distance. Unlike unfiltering, every filtered byte d" +
+	"epends only\n// on the unfiltered curr and prev bytes, so there are no dependency chains.\n\n// wuffs_base__private_sum_abs_i8 returns the sum of the absolute values of\n// the n bytes at p, as signed bytes.\nstatic inline uint64_t  //\nwuffs_base__private_sum_abs_i8(uint8_t* p, size_t n) {\n  uint64_t sum = 0;\n  for (; n > 0; n--, p++) {\n    sum += (p[0] < 0x80) ? p[0] : (0x100 - (uint32_t)(p[0]));\n  }\n  return sum;\n}\n\nstatic inline uint64_t  //\nwuffs_base__slice_u8__filter_none(wuffs_base__slice_u8 dst,\n                                  wuffs_base__slice_u8 curr) {\n  size_t n = dst.len < curr.len ? dst.len : curr.len;\n  if (n > 0) {\n    memmove(dst.ptr, curr.ptr, n);\n  }\n  return wuffs_base__private_sum_abs_i8(dst.ptr, n);\n}\n\n// wuffs_base__private_filter_len returns how many bytes the filter_etc\n// functions filter.\nstatic inline size_t  //\nwuffs_base__private_filter_len(wuffs_base__slice_u8 dst,\n                               wuffs_base__slice_u8 curr,\n                               wuffs_base__slice_u8 prev) {\n" +
+	"  size_t n = dst.len < curr.len ? dst.len : curr.len;\n  if ((prev.len > 0) && (n > prev.len)) {\n    n = prev.len;\n  }\n  return n;\n}\n\n// wuffs_base__private_filter_etc_1 filters the i'th byte, for one of the\n// Sub, Up, Average and Paeth filters (numbered 1 to 4, as per the PNG\n// specification), when prev is not empty and i >= distance.\nstatic inline uint8_t  //\nwuffs_base__private_filter_etc_1(uint8_t* c,\n                                 uint8_t* p,\n                                 size_t i,\n                                 uint32_t distance,\n                                 uint32_t filter) {\n  switch (filter) {\n    case 1:\n      return c[i] - c[i - distance];\n    case 2:\n      return c[i] - p[i];\n    case 3:\n      return c[i] -\n             (uint8_t)(((uint32_t)(c[i - distance]) + (uint32_t)(p[i])) / 2);\n  }\n  return c[i] -\n         wuffs_base__private_paeth(c[i - distance], p[i], p[i - distance]);\n}\n\n// wuffs_base__private_filter_etc__fallback filters curr, for one of the Sub,\n// Up, Average and Paeth fil" +
+	"ters, starting at the i'th byte.\nstatic inline uint64_t  //\nwuffs_base__private_filter_etc__fallback(wuffs_base__slice_u8 dst,\n                                         wuffs_base__slice_u8 curr,\n                                         wuffs_base__slice_u8 prev,\n                                         uint32_t distance,\n                                         uint32_t filter,\n                                         size_t i) {\n  size_t n = wuffs_base__private_filter_len(dst, curr, prev);\n  size_t i0 = i;\n  uint8_t* d = dst.ptr;\n  uint8_t* c = curr.ptr;\n  uint8_t* p = prev.ptr;\n\n  // The first distance bytes have no left neighbor, which the filters treat\n  // as zero. So does an empty prev.\n  if (prev.len == 0) {\n    for (; i < n; i++) {\n      uint8_t a = (i >= distance) ? c[i - distance] : 0;\n      switch (filter) {\n        case 1:\n        case 4:\n          d[i] = c[i] - a;\n          break;\n        case 2:\n          d[i] = c[i];\n          break;\n        default:\n          d[i] = c[i] - (a / 2);\n          b" +
+	"reak;\n      }\n    }\n    return wuffs_base__private_sum_abs_i8(d + i0, n - i0);\n  }\n  for (; (i < distance) && (i < n); i++) {\n    switch (filter) {\n      case 1:\n        d[i] = c[i];\n        break;\n      case 3:\n        d[i] = c[i] - (p[i] / 2);\n        break;\n      default:\n        d[i] = c[i] - p[i];\n        break;\n    }\n  }\n  for (; i < n; i++) {\n    d[i] = wuffs_base__private_filter_etc_1(c, p, i, distance, filter);\n  }\n  return wuffs_base__private_sum_abs_i8(d + i0, n - i0);\n}\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n\n// wuffs_base__private_sum_abs_i8__sse2 adds, to the two 64 bit lanes of acc,\n// the sum of the absolute values of v's 16 signed bytes.\nstatic inline __m128i  //\nwuffs_base__private_sum_abs_i8__sse2(__m128i acc, __m128i v) {\n  __m128i zero = _mm_setzero_si128();\n  __m128i abs = _mm_min_epu8(v, _mm_sub_epi8(zero, v));\n  return _mm_add_epi64(acc, _mm_sad_epu8(abs, zero));\n}\n\n// wuffs_base__private_paeth_epi16 returns the Paeth predictor for 8 lanes of\n// 16 bit values, each of which holds a byte.\n" +
+	"static inline __m128i  //\nwuffs_base__private_paeth_epi16(__m128i a, __m128i b, __m128i c) {\n  __m128i pa = _mm_sub_epi16(b, c);\n  __m128i pb = _mm_sub_epi16(a, c);\n  __m128i pc = wuffs_base__private_abs_epi16(_mm_add_epi16(pa, pb));\n  pa = wuffs_base__private_abs_epi16(pa);\n  pb = wuffs_base__private_abs_epi16(pb);\n  // Select a, else b, else c, breaking ties in that order.\n  __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));\n  __m128i use_a = _mm_cmpeq_epi16(smallest, pa);\n  __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));\n  __m128i use_c =\n      _mm_andnot_si128(_mm_or_si128(use_a, use_b), _mm_set1_epi16(-1));\n  return _mm_or_si128(\n      _mm_or_si128(_mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),\n      _mm_and_si128(use_c, c));\n}\n\n// wuffs_base__private_filter_etc__sse2 is like the __fallback version, but\n// filters 16 bytes at a time. It requires a non-empty prev and, for every\n// filter other than Up, a non-zero distance.\nstatic inline uint64_t  //\nwuffs_base__privat" +
+	"e_filter_etc__sse2(wuffs_base__slice_u8 dst,\n                                     wuffs_base__slice_u8 curr,\n                                     wuffs_base__slice_u8 prev,\n                                     uint32_t distance,\n                                     uint32_t filter) {\n  size_t n = wuffs_base__private_filter_len(dst, curr, prev);\n  uint8_t* d = dst.ptr;\n  uint8_t* c = curr.ptr;\n  uint8_t* p = prev.ptr;\n  uint64_t sum = 0;\n  size_t i = 0;\n  if (filter != 2) {\n    // Filter the first distance bytes, which have no left neighbor.\n    wuffs_base__slice_u8 d0 = dst;\n    d0.len = n < distance ? n : distance;\n    sum = wuffs_base__private_filter_etc__fallback(d0, curr, prev, distance,\n                                                   filter, 0);\n    i = d0.len;\n  }\n\n  __m128i zero = _mm_setzero_si128();\n  __m128i one = _mm_set1_epi8(1);\n  __m128i acc = zero;\n  for (; (n - i) >= 16; i += 16) {\n    __m128i x = _mm_loadu_si128((const __m128i*)(c + i));\n    __m128i b = _mm_loadu_si128((const __m128i*)(p +" +
+	" i));\n    __m128i v;\n    if (filter == 2) {\n      v = _mm_sub_epi8(x, b);\n    } else {\n      __m128i a = _mm_loadu_si128((const __m128i*)(c + i - distance));\n      if (filter == 1) {\n        v = _mm_sub_epi8(x, a);\n      } else if (filter == 3) {\n        // _mm_avg_epu8 rounds up, but the Average filter rounds down.\n        __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),\n                                   _mm_and_si128(_mm_xor_si128(a, b), one));\n        v = _mm_sub_epi8(x, avg);\n      } else {\n        __m128i q = _mm_loadu_si128((const __m128i*)(p + i - distance));\n        __m128i lo = wuffs_base__private_paeth_epi16(\n            _mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero),\n            _mm_unpacklo_epi8(q, zero));\n        __m128i hi = wuffs_base__private_paeth_epi16(\n            _mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero),\n            _mm_unpackhi_epi8(q, zero));\n        v = _mm_sub_epi8(x, _mm_packus_epi16(lo, hi));\n      }\n    }\n    _mm_storeu_si128((__m128i*)(d + i), v);\n    acc = wuf" +
+	"fs_base__private_sum_abs_i8__sse2(acc, v);\n  }\n  uint64_t lanes[2];\n  _mm_storeu_si128((__m128i*)(lanes), acc);\n  sum += lanes[0] + lanes[1];\n\n  for (; i < n; i++) {\n    d[i] = wuffs_base__private_filter_etc_1(c, p, i, distance, filter);\n    sum += (d[i] < 0x80) ? d[i] : (0x100 - (uint32_t)(d[i]));\n  }\n  return sum;\n}\n\n#endif  // defined(WUFFS_BASE__HAVE_SSE2)\n\n// wuffs_base__private_filter_etc dispatches to the __sse2 or __fallback\n// implementation.\nstatic inline uint64_t  //\nwuffs_base__private_filter_etc(wuffs_base__slice_u8 dst,\n                               wuffs_base__slice_u8 curr,\n                               wuffs_base__slice_u8 prev,\n                               uint32_t distance,\n                               uint32_t filter) {\n  if ((distance == 0) && (filter != 2)) {\n    return 0;\n  }\n#if defined(WUFFS_BASE__HAVE_SSE2)\n  if (prev.len > 0) {\n    return wuffs_base__private_filter_etc__sse2(dst, curr, prev, distance,\n                                                filter);\n  }\n#endif\n  return" +
+	" wuffs_base__private_filter_etc__fallback(dst, curr, prev, distance,\n                                                  filter, 0);\n}\n\nstatic inline uint64_t  //\nwuffs_base__slice_u8__filter_sub(wuffs_base__slice_u8 dst,\n                                 wuffs_base__slice_u8 curr,\n                                 uint32_t distance) {\n  // Sub does not look at prev, but the SIMD code path requires a non-empty\n  // prev. Passing curr as prev is harmless.\n  return wuffs_base__private_filter_etc(dst, curr, curr, distance, 1);\n}\n\nstatic inline uint64_t  //\nwuffs_base__slice_u8__filter_up(wuffs_base__slice_u8 dst,\n                                wuffs_base__slice_u8 curr,\n                                wuffs_base__slice_u8 prev) {\n  return wuffs_base__private_filter_etc(dst, curr, prev, 0, 2);\n}\n\nstatic inline uint64_t  //\nwuffs_base__slice_u8__filter_average(wuffs_base__slice_u8 dst,\n                                     wuffs_base__slice_u8 curr,\n                                     wuffs_base__slice_u8 prev,\n     " +
+	"                                uint32_t distance) {\n  return wuffs_base__private_filter_etc(dst, curr, prev, distance, 3);\n}\n\nstatic inline uint64_t  //\nwuffs_base__slice_u8__filter_paeth(wuffs_base__slice_u8 dst,\n                                   wuffs_base__slice_u8 curr,\n                                   wuffs_base__slice_u8 prev,\n                                   uint32_t distance) {\n  return wuffs_base__private_filter_etc(dst, curr, prev, distance, 4);\n}\n\n" +
+	"" +
+	"// ---------------- JPEG\n\n// wuffs_base__slice_u8__idct_8x8 undoes the JPEG image format's 8×8 forward\n// DCT (Discrete Cosine Transform). coeffs holds the 64 coefficients (as signed\n// 16 bit little-endian integers) and quant the 64 quantization factors (as\n// unsigned 16 bit little-endian integers) to multiply them by, both in natural\n// (row major), not zig-zag, order. The 8×8 block of samples, level shifted by\n// +128 and clamped to the range [0, 255], is written to dst, whose rows are\n// stride bytes apart. It is a no-op if any of the slices are too short.\n//\n// The arithmetic is libjpeg's \"islow\" (accurate integer) algorithm, with 13\n// bits of fixed point precision and 2 extra bits between the two passes, so\n// that the output matches libjpeg's, and libjpeg-turbo's, exactly. When\n// WUFFS_BASE__HAVE_SSE2 is defined, each pass transforms all 8 columns (or\n// rows) at once, in 16 bit lanes that are widened to 32 bits for the\n// multiplications.\n//\n// Hostile input can hold arbitrary coefficients and 16" +
+	" bit quantization\n// factors. Both the dequantized coefficients and the first pass's outputs\n// therefore saturate to [-0x4000, +0x3FFF], far beyond what a conforming JPEG\n// encoder produces. Within that range, no 32 bit (or, for SSE2's additions, 16\n// bit) arithmetic can overflow, so the SSE2 and fallback implementations give\n// identical output for every input.\n\n// wuffs_base__private_idct_saturate clamps v to [-0x4000, +0x3FFF].\nstatic inline int32_t  //\nwuffs_base__private_idct_saturate(int32_t v) {\n  return (v < -0x4000) ? -0x4000 : (v > 0x3FFF) ? 0x3FFF : v;\n}\n\n// wuffs_base__private_idct_dequantize multiplies the i16le coefficient at c by\n// the u16le quantization factor at q. The product cannot overflow an int32_t,\n// as 0x8000 * 0xFFFF < 0x80000000.\nstatic inline int32_t  //\nwuffs_base__private_idct_dequantize(uint8_t* c, uint8_t* q) {\n  return wuffs_base__private_idct_saturate(\n      ((int32_t)((int16_t)(wuffs_base__load_u16le(c)))) *\n      ((int32_t)(wuffs_base__load_u16le(q))));\n}\n\nstatic inline" +
+	" void  //\nwuffs_base__private_idct_1d(int32_t* v, uint32_t shift) {\n  // Even part.\n  int32_t z1 = (v[2] + v[6]) * 4433;          // FIX(0.541196100)\n  int32_t tmp2 = z1 + (v[6] * -15137);        // FIX(1.847759065)\n  int32_t tmp3 = z1 + (v[2] * 6270);          // FIX(0.765366865)\n  int32_t tmp0 = (int32_t)((uint32_t)(v[0] + v[4]) << 13);\n  int32_t tmp1 = (int32_t)((uint32_t)(v[0] - v[4]) << 13);\n  int32_t tmp10 = tmp0 + tmp3;\n  int32_t tmp13 = tmp0 - tmp3;\n  int32_t tmp11 = tmp1 + tmp2;\n  int32_t tmp12 = tmp1 - tmp2;\n\n  // Odd part.\n  tmp0 = v[7];\n  tmp1 = v[5];\n  tmp2 = v[3];\n  tmp3 = v[1];\n  z1 = tmp0 + tmp3;\n  int32_t z2 = tmp1 + tmp2;\n  int32_t z3 = tmp0 + tmp2;\n  int32_t z4 = tmp1 + tmp3;\n  int32_t z5 = (z3 + z4) * 9633;  // FIX(1.175875602)\n  tmp0 *= 2446;                   // FIX(0.298631336)\n  tmp1 *= 16819;                  // FIX(2.053119869)\n  tmp2 *= 25172;                  // FIX(3.072711026)\n  tmp3 *= 12299;                  // FIX(1.501321110)\n  z1 *= -7373;                    // FIX(0.8999762" +
+	"23)\n  z2 *= -20995;                   // FIX(2.562915447)\n  z3 *= -16069;                   // FIX(1.961570560)\n  z4 *= -3196;                    // FIX(0.390180644)\n  z3 += z5;\n  z4 += z5;\n  tmp0 += z1 + z3;\n  tmp1 += z2 + z4;\n  tmp2 += z2 + z3;\n  tmp3 += z1 + z4;\n\n  int32_t bias = ((int32_t)1) << (shift - 1);\n  v[0] = (tmp10 + tmp3 + bias) >> shift;\n  v[7] = (tmp10 - tmp3 + bias) >> shift;\n  v[1] = (tmp11 + tmp2 + bias) >> shift;\n  v[6] = (tmp11 - tmp2 + bias) >> shift;\n  v[2] = (tmp12 + tmp1 + bias) >> shift;\n  v[5] = (tmp12 - tmp1 + bias) >> shift;\n  v[3] = (tmp13 + tmp0 + bias) >> shift;\n  v[4] = (tmp13 - tmp0 + bias) >> shift;\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__idct_8x8__fallback(wuffs_base__slice_u8 dst,\n                                         uint64_t stride,\n                                         wuffs_base__slice_u8 coeffs,\n                                         wuffs_base__slice_u8 quant) {\n  int32_t ws[64];\n  int32_t v[8];\n  int x;\n  int y;\n  int k;\n\n  // Pass 1: process columns," +
+	" dequantizing the input and storing the\n  // (saturated) result, scaled up by 2 bits, in the ws work space.\n  for (x = 0; x < 8; x++) {\n    for (k = 0; k < 8; k++) {\n      v[k] = wuffs_base__private_idct_dequantize(\n          coeffs.ptr + (2 * ((8 * k) + x)), quant.ptr + (2 * ((8 * k) + x)));\n    }\n    wuffs_base__private_idct_1d(v, 11);\n    for (k = 0; k < 8; k++) {\n      ws[(8 * k) + x] = wuffs_base__private_idct_saturate(v[k]);\n    }\n  }\n\n  // Pass 2: process rows, from the work space to dst.\n  for (y = 0; y < 8; y++) {\n    for (k = 0; k < 8; k++) {\n      v[k] = ws[(8 * y) + k];\n    }\n    wuffs_base__private_idct_1d(v, 18);\n    uint8_t* d = dst.ptr + (y * stride);\n    for (k = 0; k < 8; k++) {\n      int32_t s = v[k] + 128;\n      d[k] = (s < 0) ? 0 : (s > 255) ? 255 : ((uint8_t)s);\n    }\n  }\n}\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n\nstatic inline void  //\nwuffs_base__private_transpose_8x8_epi16(__m128i* r) {\n  __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);\n  __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);\n  __m128i" +
+	" a2 = _mm_unpacklo_epi16(r[2], r[3]);\n  __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);\n  __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);\n  __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);\n  __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);\n  __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);\n  __m128i b0 = _mm_unpacklo_epi32(a0, a2);\n  __m128i b1 = _mm_unpackhi_epi32(a0, a2);\n  __m128i b2 = _mm_unpacklo_epi32(a1, a3);\n  __m128i b3 = _mm_unpackhi_epi32(a1, a3);\n  __m128i b4 = _mm_unpacklo_epi32(a4, a6);\n  __m128i b5 = _mm_unpackhi_epi32(a4, a6);\n  __m128i b6 = _mm_unpacklo_epi32(a5, a7);\n  __m128i b7 = _mm_unpackhi_epi32(a5, a7);\n  r[0] = _mm_unpacklo_epi64(b0, b4);\n  r[1] = _mm_unpackhi_epi64(b0, b4);\n  r[2] = _mm_unpacklo_epi64(b1, b5);\n  r[3] = _mm_unpackhi_epi64(b1, b5);\n  r[4] = _mm_unpacklo_epi64(b2, b6);\n  r[5] = _mm_unpackhi_epi64(b2, b6);\n  r[6] = _mm_unpacklo_epi64(b3, b7);\n  r[7] = _mm_unpackhi_epi64(b3, b7);\n}\n\n// wuffs_base__private_idct_1d__sse2 is wuffs_base__private_idct_1d for 8\n// independent lanes: v[k] holds e" +
+	"very lane's k'th input (and output). The\n// multiplications are paired up, as _mm_madd_epi16 computes (a*b + c*d), by\n// folding the shared z1 .. z5 terms into per-input constants.\nstatic inline void  //\nwuffs_base__private_idct_1d__sse2(__m128i* v, int shift) {\n  const __m128i k_tmp3 = _mm_set_epi16(4433, 10703, 4433, 10703,  //\n                                       4433, 10703, 4433, 10703);\n  const __m128i k_tmp2 = _mm_set_epi16(-10704, 4433, -10704, 4433,  //\n                                       -10704, 4433, -10704, 4433);\n  const __m128i k_z3 = _mm_set_epi16(9633, -6436, 9633, -6436,  //\n                                     9633, -6436, 9633, -6436);\n  const __m128i k_z4 = _mm_set_epi16(6437, 9633, 6437, 9633,  //\n                                     6437, 9633, 6437, 9633);\n  const __m128i k_tmp0 = _mm_set_epi16(-7373, -4927, -7373, -4927,  //\n                                       -7373, -4927, -7373, -4927);\n  const __m128i k_tmp3o = _mm_set_epi16(4926, -7373, 4926, -7373,  //\n                    " +
+	"                    4926, -7373, 4926, -7373);\n  const __m128i k_tmp1 = _mm_set_epi16(-20995, -4176, -20995, -4176,  //\n                                       -20995, -4176, -20995, -4176);\n  const __m128i k_tmp2o = _mm_set_epi16(4177, -20995, 4177, -20995,  //\n                                        4177, -20995, 4177, -20995);\n  const __m128i bias = _mm_set1_epi32(1 << (shift - 1));\n  const __m128i zero = _mm_setzero_si128();\n\n  // Even part.\n  __m128i p26l = _mm_unpacklo_epi16(v[2], v[6]);\n  __m128i p26h = _mm_unpackhi_epi16(v[2], v[6]);\n  __m128i tmp3l = _mm_madd_epi16(p26l, k_tmp3);\n  __m128i tmp3h = _mm_madd_epi16(p26h, k_tmp3);\n  __m128i tmp2l = _mm_madd_epi16(p26l, k_tmp2);\n  __m128i tmp2h = _mm_madd_epi16(p26h, k_tmp2);\n\n  // Shifting the 16 bit (v[0] ± v[4]) into the top of a 32 bit lane and then\n  // arithmetic shifting right by 3 is a sign-extending shift left by 13.\n  __m128i s04 = _mm_add_epi16(v[0], v[4]);\n  __m128i d04 = _mm_sub_epi16(v[0], v[4]);\n  __m128i tmp0l = _mm_srai_epi32(_mm_unpacklo" +
+	"_epi16(zero, s04), 3);\n  __m128i tmp0h = _mm_srai_epi32(_mm_unpackhi_epi16(zero, s04), 3);\n  __m128i tmp1l = _mm_srai_epi32(_mm_unpacklo_epi16(zero, d04), 3);\n  __m128i tmp1h = _mm_srai_epi32(_mm_unpackhi_epi16(zero, d04), 3);\n\n  __m128i tmp10l = _mm_add_epi32(tmp0l, tmp3l);\n  __m128i tmp10h = _mm_add_epi32(tmp0h, tmp3h);\n  __m128i tmp13l = _mm_sub_epi32(tmp0l, tmp3l);\n  __m128i tmp13h = _mm_sub_epi32(tmp0h, tmp3h);\n  __m128i tmp11l = _mm_add_epi32(tmp1l, tmp2l);\n  __m128i tmp11h = _mm_add_epi32(tmp1h, tmp2h);\n  __m128i tmp12l = _mm_sub_epi32(tmp1l, tmp2l);\n  __m128i tmp12h = _mm_sub_epi32(tmp1h, tmp2h);\n\n  // Odd part.\n  __m128i z3 = _mm_add_epi16(v[7], v[3]);\n  __m128i z4 = _mm_add_epi16(v[5], v[1]);\n  __m128i p34l = _mm_unpacklo_epi16(z3, z4);\n  __m128i p34h = _mm_unpackhi_epi16(z3, z4);\n  __m128i z3l = _mm_madd_epi16(p34l, k_z3);\n  __m128i z3h = _mm_madd_epi16(p34h, k_z3);\n  __m128i z4l = _mm_madd_epi16(p34l, k_z4);\n  __m128i z4h = _mm_madd_epi16(p34h, k_z4);\n\n  __m128i p71l = _mm_unpacklo_epi16(v[7], v[1" +
+	"]);\n  __m128i p71h = _mm_unpackhi_epi16(v[7], v[1]);\n  __m128i p53l = _mm_unpacklo_epi16(v[5], v[3]);\n  __m128i p53h = _mm_unpackhi_epi16(v[5], v[3]);\n  __m128i o0l = _mm_add_epi32(_mm_madd_epi16(p71l, k_tmp0), z3l);\n  __m128i o0h = _mm_add_epi32(_mm_madd_epi16(p71h, k_tmp0), z3h);\n  __m128i o3l = _mm_add_epi32(_mm_madd_epi16(p71l, k_tmp3o), z4l);\n  __m128i o3h = _mm_add_epi32(_mm_madd_epi16(p71h, k_tmp3o), z4h);\n  __m128i o1l = _mm_add_epi32(_mm_madd_epi16(p53l, k_tmp1), z4l);\n  __m128i o1h = _mm_add_epi32(_mm_madd_epi16(p53h, k_tmp1), z4h);\n  __m128i o2l = _mm_add_epi32(_mm_madd_epi16(p53l, k_tmp2o), z3l);\n  __m128i o2h = _mm_add_epi32(_mm_madd_epi16(p53h, k_tmp2o), z3h);\n\n#define WUFFS_BASE__PRIVATE_IDCT_OUT(i, j, a, b)                             \\\n  v[i] = _mm_packs_epi32(                                                    \\\n      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(a##l, b##l), bias), shift), \\\n      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(a##h, b##h), bias), shift)); \\\n  v[j] = _mm_packs_epi3" +
+	"2(                                                    \\\n      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(a##l, b##l), bias), shift), \\\n      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(a##h, b##h), bias), shift))\n\n  WUFFS_BASE__PRIVATE_IDCT_OUT(0, 7, tmp10, o3);\n  WUFFS_BASE__PRIVATE_IDCT_OUT(1, 6, tmp11, o2);\n  WUFFS_BASE__PRIVATE_IDCT_OUT(2, 5, tmp12, o1);\n  WUFFS_BASE__PRIVATE_IDCT_OUT(3, 4, tmp13, o0);\n\n#undef WUFFS_BASE__PRIVATE_IDCT_OUT\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__idct_8x8__sse2(wuffs_base__slice_u8 dst,\n                                     uint64_t stride,\n                                     wuffs_base__slice_u8 coeffs,\n                                     wuffs_base__slice_u8 quant) {\n  const __m128i k7FFF = _mm_set1_epi16(0x7FFF);\n  const __m128i lo = _mm_set1_epi16(-0x4000);\n  const __m128i hi = _mm_set1_epi16(+0x3FFF);\n  __m128i v[8];\n  int k;\n  for (k = 0; k < 8; k++) {\n    // Dequantize to 32 bits and saturate, as the fallback implementation\n    // does. _mm_mulhi_epi16 is a s" +
+	"igned multiply, so quantization factors of\n    // 0x8000 or more are first replaced by 0x7FFF. As every non-zero\n    // coefficient's product saturates either way, this does not change the\n    // result.\n    __m128i c = _mm_loadu_si128((const __m128i*)(coeffs.ptr + (16 * k)));\n    __m128i q = _mm_loadu_si128((const __m128i*)(quant.ptr + (16 * k)));\n    __m128i m = _mm_srai_epi16(q, 15);\n    q = _mm_or_si128(_mm_andnot_si128(m, q), _mm_and_si128(m, k7FFF));\n    __m128i pl = _mm_mullo_epi16(c, q);\n    __m128i ph = _mm_mulhi_epi16(c, q);\n    v[k] = _mm_packs_epi32(_mm_unpacklo_epi16(pl, ph),\n                           _mm_unpackhi_epi16(pl, ph));\n    v[k] = _mm_max_epi16(_mm_min_epi16(v[k], hi), lo);\n  }\n  wuffs_base__private_idct_1d__sse2(v, 11);\n  for (k = 0; k < 8; k++) {\n    v[k] = _mm_max_epi16(_mm_min_epi16(v[k], hi), lo);\n  }\n  wuffs_base__private_transpose_8x8_epi16(v);\n  wuffs_base__private_idct_1d__sse2(v, 18);\n  wuffs_base__private_transpose_8x8_epi16(v);\n  const __m128i k128 = _mm_set1_epi16(128);\n  " +
+	"for (k = 0; k < 8; k++) {\n    __m128i s = _mm_adds_epi16(v[k], k128);\n    _mm_storel_epi64((__m128i*)(dst.ptr + (k * stride)),\n                     _mm_packus_epi16(s, s));\n  }\n}\n\n#endif  // defined(WUFFS_BASE__HAVE_SSE2)\n\nstatic inline void  //\nwuffs_base__slice_u8__idct_8x8(wuffs_base__slice_u8 dst,\n                               uint64_t stride,\n                               wuffs_base__slice_u8 coeffs,\n                               wuffs_base__slice_u8 quant) {\n  if ((coeffs.len < 128) || (quant.len < 128) || (dst.len < 8) ||\n      (stride > ((dst.len - 8) / 7))) {\n    return;\n  }\n#if defined(WUFFS_BASE__HAVE_SSE2)\n  wuffs_base__slice_u8__idct_8x8__sse2(dst, stride, coeffs, quant);\n#else\n  wuffs_base__slice_u8__idct_8x8__fallback(dst, stride, coeffs, quant);\n#endif\n}\n\n// wuffs_base__slice_u8__idct_8x8_downscaled is like\n// wuffs_base__slice_u8__idct_8x8 but, for a shift of 1, 2 or 3, it writes a\n// 4×4, 2×2 or 1×1 block of samples: the 8×8 block downscaled by (1 << shift)\n// in each dimension. It on" +
+	"ly computes those samples, and only looks at the\n// coefficients that contribute to them. A shift of 0 is the same as\n// wuffs_base__slice_u8__idct_8x8.\n//\n// The arithmetic is that of libjpeg's jpeg_idct_4x4, jpeg_idct_2x2 and\n// jpeg_idct_1x1 (in jidctred.c), which libjpeg uses when decoding with a\n// scale_denom of 2, 4 or 8, so that the output matches libjpeg's exactly. As\n// for the full size IDCT, the dequantized coefficients and the first pass's\n// outputs saturate to [-0x4000, +0x3FFF], so that no intermediate value can\n// overflow.\n\nstatic inline uint8_t  //\nwuffs_base__private_idct_clamp(int32_t v, uint32_t shift) {\n  int32_t s = ((v + (((int32_t)1) << (shift - 1))) >> shift) + 128;\n  return (s < 0) ? 0 : (s > 255) ? 255 : ((uint8_t)s);\n}\n\nstatic inline void  //\nwuffs_base__private_idct_4x4(uint8_t* dst,\n                             uint64_t stride,\n                             uint8_t* coeffs,\n                             uint8_t* quant) {\n  int32_t ws[32];\n  int32_t v[8];\n  int x;\n  int y;\n  int k" +
+	";\n\n  // Pass 1: process columns, other than column 4, which the second pass\n  // ignores. Rows 0 .. 3 of the ws work space hold the 4 outputs.\n  for (x = 0; x < 8; x++) {\n    if (x == 4) {\n      continue;\n    }\n    for (k = 0; k < 8; k++) {\n      v[k] = wuffs_base__private_idct_dequantize(coeffs + (2 * ((8 * k) + x)),\n                                                 quant + (2 * ((8 * k) + x)));\n    }\n    int32_t tmp0 = (int32_t)((uint32_t)(v[0]) << 14);\n    int32_t tmp2 = (v[2] * 15137) + (v[6] * -6270);\n    int32_t tmp10 = tmp0 + tmp2;\n    int32_t tmp12 = tmp0 - tmp2;\n    tmp0 = (v[7] * -1730) + (v[5] * 11893) + (v[3] * -17799) + (v[1] * 8697);\n    tmp2 = (v[7] * -4176) + (v[5] * -4926) + (v[3] * 7373) + (v[1] * 20995);\n    ws[(8 * 0) + x] =\n        wuffs_base__private_idct_saturate((tmp10 + tmp2 + (1 << 11)) >> 12);\n    ws[(8 * 3) + x] =\n        wuffs_base__private_idct_saturate((tmp10 - tmp2 + (1 << 11)) >> 12);\n    ws[(8 * 1) + x] =\n        wuffs_base__private_idct_saturate((tmp12 + tmp0 + (1 << 11)) >> " +
+	"12);\n    ws[(8 * 2) + x] =\n        wuffs_base__private_idct_saturate((tmp12 - tmp0 + (1 << 11)) >> 12);\n  }\n\n  // Pass 2: process rows, from the work space to dst.\n  for (y = 0; y < 4; y++) {\n    int32_t* w = ws + (8 * y);\n    int32_t tmp0 = (int32_t)((uint32_t)(w[0]) << 14);\n    int32_t tmp2 = (w[2] * 15137) + (w[6] * -6270);\n    int32_t tmp10 = tmp0 + tmp2;\n    int32_t tmp12 = tmp0 - tmp2;\n    tmp0 = (w[7] * -1730) + (w[5] * 11893) + (w[3] * -17799) + (w[1] * 8697);\n    tmp2 = (w[7] * -4176) + (w[5] * -4926) + (w[3] * 7373) + (w[1] * 20995);\n    uint8_t* d = dst + (y * stride);\n    d[0] = wuffs_base__private_idct_clamp(tmp10 + tmp2, 19);\n    d[3] = wuffs_base__private_idct_clamp(tmp10 - tmp2, 19);\n    d[1] = wuffs_base__private_idct_clamp(tmp12 + tmp0, 19);\n    d[2] = wuffs_base__private_idct_clamp(tmp12 - tmp0, 19);\n  }\n}\n\nstatic inline void  //\nwuffs_base__private_idct_2x2(uint8_t* dst,\n                             uint64_t stride,\n                             uint8_t* coeffs,\n                            " +
+	" uint8_t* quant) {\n  int32_t ws[16];\n  int32_t v[8];\n  int x;\n  int y;\n  int k;\n\n  // Pass 1: process columns 0, 1, 3, 5 and 7, the only ones that the second\n  // pass uses. Rows 0 and 1 of the ws work space hold the 2 outputs.\n  for (x = 0; x < 8; x++) {\n    if ((x == 2) || (x == 4) || (x == 6)) {\n      continue;\n    }\n    for (k = 0; k < 8; k++) {\n      v[k] = wuffs_base__private_idct_dequantize(coeffs + (2 * ((8 * k) + x)),\n                                                 quant + (2 * ((8 * k) + x)));\n    }\n    int32_t tmp10 = (int32_t)((uint32_t)(v[0]) << 15);\n    int32_t tmp0 =\n        (v[7] * -5906) + (v[5] * 6967) + (v[3] * -10426) + (v[1] * 29692);\n    ws[(8 * 0) + x] =\n        wuffs_base__private_idct_saturate((tmp10 + tmp0 + (1 << 12)) >> 13);\n    ws[(8 * 1) + x] =\n        wuffs_base__private_idct_saturate((tmp10 - tmp0 + (1 << 12)) >> 13);\n  }\n\n  // Pass 2: process rows, from the work space to dst.\n  for (y = 0; y < 2; y++) {\n    int32_t* w = ws + (8 * y);\n    int32_t tmp10 = (int32_t)((uint32_t)(w" +
+	"[0]) << 15);\n    int32_t tmp0 =\n        (w[7] * -5906) + (w[5] * 6967) + (w[3] * -10426) + (w[1] * 29692);\n    uint8_t* d = dst + (y * stride);\n    d[0] = wuffs_base__private_idct_clamp(tmp10 + tmp0, 20);\n    d[1] = wuffs_base__private_idct_clamp(tmp10 - tmp0, 20);\n  }\n}\n\nstatic inline void  //\nwuffs_base__slice_u8__idct_8x8_downscaled(wuffs_base__slice_u8 dst,\n                                          uint64_t stride,\n                                          wuffs_base__slice_u8 coeffs,\n                                          wuffs_base__slice_u8 quant,\n                                          uint32_t shift) {\n  if (shift == 0) {\n    wuffs_base__slice_u8__idct_8x8(dst, stride, coeffs, quant);\n    return;\n  }\n  uint64_t n = ((uint64_t)8) >> (shift & 3);\n  if ((shift > 3) || (coeffs.len < 128) || (quant.len < 128) ||\n      (dst.len < n) || ((n > 1) && (stride > ((dst.len - n) / (n - 1))))) {\n    return;\n  }\n  if (shift == 1) {\n    wuffs_base__private_idct_4x4(dst.ptr, stride, coeffs.ptr, quant.ptr);\n  } e" +
+	"lse if (shift == 2) {\n    wuffs_base__private_idct_2x2(dst.ptr, stride, coeffs.ptr, quant.ptr);\n  } else {\n    dst.ptr[0] = wuffs_base__private_idct_clamp(\n        wuffs_base__private_idct_dequantize(coeffs.ptr, quant.ptr), 3);\n  }\n}\n\n// wuffs_base__slice_u8__convert_ycc converts a row of JPEG's YCbCr samples to\n// pixfmt, one of WUFFS_BASE__PIXEL_FORMAT__BGR, BGRA_NONPREMUL, BGRX, RGB,\n// RGBA_NONPREMUL or RGBX. Empty cb and cr mean a gray (Y only) row. Otherwise,\n// the chroma rows are upsampled per the upsample argument, using the same\n// triangle filters as libjpeg's \"fancy upsampling\":\n//  - 0 means none: cb and cr are as wide as y.\n//  - 1 means 2× horizontally (\"h2v1\").\n//  - 2 and 3 mean 2× vertically (\"h1v2\"), where cb_far and cr_far are the\n//    chroma rows above (2) or below (3) the nearest ones, cb and cr.\n//  - 4 means 2× in both directions (\"h2v2\"), with cb_far and cr_far as per 2\n//    and 3, whichever is further away from this row.\n// Horizontal upsampling needs at least 2 chroma samples p" +
+	"er row. The number of\n// pixels converted is bounded by y.len, by dst.len and by the chroma lengths.\n//\n// The color conversion is libjpeg's: 16 bit fixed point, with rounding. When\n// WUFFS_BASE__HAVE_SSE2 is defined, 4 byte per pixel formats are converted 8\n// pixels at a time, with the multiplications by 1.402 and 1.772 split into\n// exact (integer) and fractional parts so that they fit in 16 bit lanes.\n\nstatic inline void  //\nwuffs_base__private_upsample_ycc(uint8_t* out,\n                                 wuffs_base__slice_u8 near,\n                                 wuffs_base__slice_u8 far,\n                                 uint32_t upsample,\n                                 size_t x0,\n                                 size_t n) {\n  size_t cw = near.len;\n  size_t i;\n  switch (upsample) {\n    case 0:\n      memcpy(out, near.ptr + x0, n);\n      break;\n\n    case 1:\n      for (i = 0; i < n; i++) {\n        size_t xo = x0 + i;\n        size_t c = xo >> 1;\n        uint32_t v = 3 * (uint32_t)(near.ptr[c]);\n        if (" +
+	"(xo & 1) == 0) {\n          out[i] = (c == 0) ? near.ptr[0]\n                            : (uint8_t)((v + near.ptr[c - 1] + 1) >> 2);\n        } else {\n          out[i] = (c + 1 >= cw) ? near.ptr[c]\n                                 : (uint8_t)((v + near.ptr[c + 1] + 2) >> 2);\n        }\n      }\n      break;\n\n    case 2:\n    case 3: {\n      uint32_t bias = upsample - 1;\n      for (i = 0; i < n; i++) {\n        out[i] = (uint8_t)((3 * (uint32_t)(near.ptr[x0 + i]) +\n                            (uint32_t)(far.ptr[x0 + i]) + bias) >>\n                           2);\n      }\n      break;\n    }\n\n    case 4:\n      for (i = 0; i < n; i++) {\n        size_t xo = x0 + i;\n        size_t c = xo >> 1;\n        uint32_t v = 3 * (uint32_t)(near.ptr[c]) + (uint32_t)(far.ptr[c]);\n        if ((xo & 1) == 0) {\n          if (c == 0) {\n            out[i] = (uint8_t)(((4 * v) + 8) >> 4);\n          } else {\n            uint32_t w = 3 * (uint32_t)(near.ptr[c - 1]) +\n                         (uint32_t)(far.ptr[c - 1]);\n            out[i] = (ui" +
+	"nt8_t)(((3 * v) + w + 8) >> 4);\n          }\n        } else {\n          if (c + 1 >= cw) {\n            out[i] = (uint8_t)(((4 * v) + 7) >> 4);\n          } else {\n            uint32_t w = 3 * (uint32_t)(near.ptr[c + 1]) +\n                         (uint32_t)(far.ptr[c + 1]);\n            out[i] = (uint8_t)(((3 * v) + w + 7) >> 4);\n          }\n        }\n      }\n      break;\n  }\n}\n\nstatic inline void  //\nwuffs_base__private_convert_ycc__fallback(uint8_t* d,\n                                          size_t bpp,\n                                          bool rgb,\n                                          uint8_t* y,\n                                          uint8_t* cb,\n                                          uint8_t* cr,\n                                          size_t n) {\n  size_t i;\n  for (i = 0; i < n; i++) {\n    int32_t yy = y[i];\n    int32_t u = ((int32_t)(cb[i])) - 128;\n    int32_t v = ((int32_t)(cr[i])) - 128;\n    int32_t r = yy + (((91881 * v) + 32768) >> 16);\n    int32_t g = yy + (((-22554 * u) - (46802 " +
+	"* v) + 32768) >> 16);\n    int32_t b = yy + (((116130 * u) + 32768) >> 16);\n    r = (r < 0) ? 0 : (r > 255) ? 255 : r;\n    g = (g < 0) ? 0 : (g > 255) ? 255 : g;\n    b = (b < 0) ? 0 : (b > 255) ? 255 : b;\n    d[0] = (uint8_t)(rgb ? r : b);\n    d[1] = (uint8_t)(g);\n    d[2] = (uint8_t)(rgb ? b : r);\n    if (bpp == 4) {\n      d[3] = 0xFF;\n    }\n    d += bpp;\n  }\n}\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n\nstatic inline void  //\nwuffs_base__private_convert_ycc__sse2(uint8_t* d,\n                                      bool rgb,\n                                      uint8_t* y,\n                                      uint8_t* cb,\n                                      uint8_t* cr,\n                                      size_t n) {\n  const __m128i zero = _mm_setzero_si128();\n  const __m128i k128 = _mm_set1_epi16(128);\n  const __m128i k_r = _mm_set_epi16(-32768, 26345, -32768, 26345,  //\n                                    -32768, 26345, -32768, 26345);\n  const __m128i k_b = _mm_set_epi16(-32768, -14942, -32768, -14942,  //\n   " +
+	"                                 -32768, -14942, -32768, -14942);\n  const __m128i k_g = _mm_set_epi16(18734, -22554, 18734, -22554,  //\n                                    18734, -22554, 18734, -22554);\n  const __m128i half = _mm_set1_epi32(32768);\n  const __m128i neg1 = _mm_set1_epi16(-1);\n  const __m128i alpha = _mm_set1_epi8(-1);\n\n  for (; n >= 8; n -= 8) {\n    __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)y), zero);\n    __m128i u = _mm_sub_epi16(\n        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cb), zero), k128);\n    __m128i v = _mm_sub_epi16(\n        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cr), zero), k128);\n\n    // 91881 = 65536 + 26345 and 116130 = 131072 - 14942. Pairing each\n    // chroma sample with -1, times -32768, adds the 32768 rounding bias.\n    __m128i vl = _mm_unpacklo_epi16(v, neg1);\n    __m128i vh = _mm_unpackhi_epi16(v, neg1);\n    __m128i ul = _mm_unpacklo_epi16(u, neg1);\n    __m128i uh = _mm_unpackhi_epi16(u, neg1);\n    __m128i r = _mm_packs_epi32(_mm_s" +
+	"rai_epi32(_mm_madd_epi16(vl, k_r), 16),\n                                _mm_srai_epi32(_mm_madd_epi16(vh, k_r), 16));\n    __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(ul, k_b), 16),\n                                _mm_srai_epi32(_mm_madd_epi16(uh, k_b), 16));\n    r = _mm_add_epi16(_mm_add_epi16(r, v), yy);\n    b = _mm_add_epi16(_mm_add_epi16(b, _mm_add_epi16(u, u)), yy);\n\n    // -46802 = -65536 + 18734.\n    __m128i uvl = _mm_unpacklo_epi16(u, v);\n    __m128i uvh = _mm_unpackhi_epi16(u, v);\n    __m128i g = _mm_packs_epi32(\n        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvl, k_g), half), 16),\n        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvh, k_g), half), 16));\n    g = _mm_add_epi16(_mm_sub_epi16(g, v), yy);\n\n    __m128i c0 = _mm_packus_epi16(rgb ? r : b, rgb ? r : b);\n    __m128i c2 = _mm_packus_epi16(rgb ? b : r, rgb ? b : r);\n    __m128i c1 = _mm_packus_epi16(g, g);\n    __m128i c01 = _mm_unpacklo_epi8(c0, c1);\n    __m128i c23 = _mm_unpacklo_epi8(c2, alpha);\n    _mm_storeu_si128((__m12" +
+	"8i*)(d + 0), _mm_unpacklo_epi16(c01, c23));\n    _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(c01, c23));\n\n    d += 32;\n    y += 8;\n    cb += 8;\n    cr += 8;\n  }\n  wuffs_base__private_convert_ycc__fallback(d, 4, rgb, y, cb, cr, n);\n}\n\n#endif  // defined(WUFFS_BASE__HAVE_SSE2)\n\nstatic inline void  //\nwuffs_base__slice_u8__convert_ycc(wuffs_base__slice_u8 dst,\n                                  wuffs_base__slice_u8 y,\n                                  wuffs_base__slice_u8 cb,\n                                  wuffs_base__slice_u8 cr,\n                                  wuffs_base__slice_u8 cb_far,\n                                  wuffs_base__slice_u8 cr_far,\n                                  uint32_t pixfmt,\n                                  uint32_t upsample) {\n  size_t bpp = 4;\n  bool rgb = false;\n  switch (pixfmt) {\n    case WUFFS_BASE__PIXEL_FORMAT__BGR:\n      bpp = 3;\n      break;\n    case WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL:\n    case WUFFS_BASE__PIXEL_FORMAT__BGRX:\n      break;\n    case WUFFS" +
+	"_BASE__PIXEL_FORMAT__RGB:\n      bpp = 3;\n      rgb = true;\n      break;\n    case WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL:\n    case WUFFS_BASE__PIXEL_FORMAT__RGBX:\n      rgb = true;\n      break;\n    default:\n      return;\n  }\n\n  size_t n = y.len < (dst.len / bpp) ? y.len : (dst.len / bpp);\n  uint8_t* d = dst.ptr;\n  size_t i;\n\n  if ((cb.len == 0) || (cr.len == 0)) {\n    for (i = 0; i < n; i++) {\n      d[0] = y.ptr[i];\n      d[1] = y.ptr[i];\n      d[2] = y.ptr[i];\n      if (bpp == 4) {\n        d[3] = 0xFF;\n      }\n      d += bpp;\n    }\n    return;\n  }\n\n  if (upsample > 4) {\n    return;\n  }\n  if (cr.len < cb.len) {\n    cb.len = cr.len;\n  } else {\n    cr.len = cb.len;\n  }\n  if (upsample >= 2) {\n    if ((cb_far.len < cb.len) || (cr_far.len < cb.len)) {\n      return;\n    }\n  }\n  size_t max_n = cb.len;\n  if ((upsample == 1) || (upsample == 4)) {\n    if (cb.len < 2) {\n      return;\n    }\n    max_n *= 2;\n  }\n  if (n > max_n) {\n    n = max_n;\n  }\n\n  // Upsample and convert in chunks, so that the upsampled chroma fits i" +
+	"n\n  // fixed size buffers on the stack.\n  uint8_t ubuf[64];\n  uint8_t vbuf[64];\n  size_t x0;\n  for (x0 = 0; x0 < n; x0 += 64) {\n    size_t m = (n - x0) < 64 ? (n - x0) : 64;\n    uint8_t* u = cb.ptr + x0;\n    uint8_t* v = cr.ptr + x0;\n    if (upsample != 0) {\n      wuffs_base__private_upsample_ycc(ubuf, cb, cb_far, upsample, x0, m);\n      wuffs_base__private_upsample_ycc(vbuf, cr, cr_far, upsample, x0, m);\n      u = ubuf;\n      v = vbuf;\n    }\n#if defined(WUFFS_BASE__HAVE_SSE2)\n    if (bpp == 4) {\n      wuffs_base__private_convert_ycc__sse2(d, rgb, y.ptr + x0, u, v, m);\n      d += 4 * m;\n      continue;\n    }\n#endif\n    wuffs_base__private_convert_ycc__fallback(d, bpp, rgb, y.ptr + x0, u, v,\n                                              m);\n    d += bpp * m;\n  }\n}\n\n" +
+	"" +
 	"// ---------------- Utility\n\nstatic inline wuffs_base__range_ii_u32  //\nwuffs_base__utility__make_range_ii_u32(wuffs_base__utility* ignored,\n                                       uint32_t min_incl,\n                                       uint32_t max_incl) {\n  return ((wuffs_base__range_ii_u32){\n      .min_incl = min_incl,\n      .max_incl = max_incl,\n  });\n}\n\nstatic inline wuffs_base__range_ie_u32  //\nwuffs_base__utility__make_range_ie_u32(wuffs_base__utility* ignored,\n                                       uint32_t min_incl,\n                                       uint32_t max_excl) {\n  return ((wuffs_base__range_ie_u32){\n      .min_incl = min_incl,\n      .max_excl = max_excl,\n  });\n}\n\nstatic inline wuffs_base__range_ii_u64  //\nwuffs_base__utility__make_range_ii_u64(wuffs_base__utility* ignored,\n                                       uint64_t min_incl,\n                                       uint64_t max_incl) {\n  return ((wuffs_base__range_ii_u64){\n      .min_incl = min_incl,\n      .max_incl = max_incl,\n  });" +
 	"\n}\n\nstatic inline wuffs_base__range_ie_u64  //\nwuffs_base__utility__make_range_ie_u64(wuffs_base__utility* ignored,\n                                       uint64_t min_incl,\n                                       uint64_t max_excl) {\n  return ((wuffs_base__range_ie_u64){\n      .min_incl = min_incl,\n      .max_excl = max_excl,\n  });\n}\n\nstatic inline wuffs_base__rect_ii_u32  //\nwuffs_base__utility__make_rect_ii_u32(wuffs_base__utility* ignored,\n                                      uint32_t min_incl_x,\n                                      uint32_t min_incl_y,\n                                      uint32_t max_incl_x,\n                                      uint32_t max_incl_y) {\n  return ((wuffs_base__rect_ii_u32){\n      .min_incl_x = min_incl_x,\n      .min_incl_y = min_incl_y,\n      .max_incl_x = max_incl_x,\n      .max_incl_y = max_incl_y,\n  });\n}\n\nstatic inline wuffs_base__rect_ie_u32  //\nwuffs_base__utility__make_rect_ie_u32(wuffs_base__utility* ignored,\n                                      uint32_t min_incl" +
 	"_x,\n                                      uint32_t min_incl_y,\n                                      uint32_t max_excl_x,\n                                      uint32_t max_excl_y) {\n  return ((wuffs_base__rect_ie_u32){\n      .min_incl_x = min_incl_x,\n      .min_incl_y = min_incl_y,\n      .max_excl_x = max_excl_x,\n      .max_excl_y = max_excl_y,\n  });\n}\n\n" +
 	"" +
-	"// ---------------- I/O\n\nstatic inline bool  //\nwuffs_base__io_buffer__is_valid(wuffs_base__io_buffer buf) {\n  return (buf.data.ptr || (buf.data.len == 0)) &&\n         (buf.data.len >= buf.meta.wi) && (buf.meta.wi >= buf.meta.ri);\n}\n\n// TODO: wuffs_base__io_reader__is_eof is no longer used by Wuffs per se, but\n// it might be handy to programs that use Wuffs. Either delete it, or promote\n// it to the public API.\n//\n// If making this function public (i.e. moving it to base-header.h), it also\n// needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.\n\nstatic inline bool  //\nwuffs_base__io_reader__is_eof(wuffs_base__io_reader o) {\n  wuffs_base__io_buffer* buf = o.private_impl.buf;\n  return buf && buf->meta.closed &&\n         (buf->data.ptr + buf->meta.wi == o.private_impl.limit);\n}\n\nstatic inline bool  //\nwuffs_base__io_reader__is_valid(wuffs_base__io_reader o) {\n  wuffs_base__io_buffer* buf = o.private_impl.buf;\n  // Note: if making this function public (i.e. moving it to base-header.h), it\n  // also " +
-	"needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.\n  return buf ? ((buf->data.ptr <= o.private_impl.mark) &&\n                (o.private_impl.mark <= o.private_impl.limit) &&\n                (o.private_impl.limit <= buf->data.ptr + buf->data.len))\n             : ((o.private_impl.mark == NULL) &&\n                (o.private_impl.limit == NULL));\n}\n\nstatic inline bool  //\nwuffs_base__io_writer__is_valid(wuffs_base__io_writer o) {\n  wuffs_base__io_buffer* buf = o.private_impl.buf;\n  // Note: if making this function public (i.e. moving it to base-header.h), it\n  // also needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.\n  return buf ? ((buf->data.ptr <= o.private_impl.mark) &&\n                (o.private_impl.mark <= o.private_impl.limit) &&\n                (o.private_impl.limit <= buf->data.ptr + buf->data.len))\n             : ((o.private_impl.mark == NULL) &&\n                (o.private_impl.limit == NULL));\n}\n\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_history(uin" +
-	"t8_t** ptr_ptr,\n                                           uint8_t* start,\n                                           uint8_t* end,\n                                           uint32_t length,\n                                           uint32_t distance) {\n  if (!distance) {\n    return 0;\n  }\n  uint8_t* ptr = *ptr_ptr;\n  if ((size_t)(ptr - start) < (size_t)(distance)) {\n    return 0;\n  }\n  start = ptr - distance;\n  size_t n = end - ptr;\n  if ((size_t)(length) > n) {\n    length = n;\n  } else {\n    n = length;\n  }\n  // TODO: unrolling by 3 seems best for the std/deflate benchmarks, but that\n  // is mostly because 3 is the minimum length for the deflate format. This\n  // function implementation shouldn't overfit to that one format. Perhaps the\n  // copy_n_from_history Wuffs method should also take an unroll hint argument,\n  // and the cgen can look if that argument is the constant expression '3'.\n  //\n  // See also wuffs_base__io_writer__copy_n_from_history_fast below.\n  //\n  // Alternatively, or additionally, ha" +
-	"ve a sloppy_copy_n_from_history method\n  // that copies 8 bytes at a time, possibly writing more than length bytes?\n  for (; n >= 3; n -= 3) {\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n  }\n  for (; n; n--) {\n    *ptr++ = *start++;\n  }\n  *ptr_ptr = ptr;\n  return length;\n}\n\n// wuffs_base__io_writer__copy_n_from_history_fast is like the\n// wuffs_base__io_writer__copy_n_from_history function above, but has stronger\n// pre-conditions. The caller needs to prove that:\n//  - distance >  0\n//  - distance <= (*ptr_ptr - start)\n//  - length   <= (end      - *ptr_ptr)\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_history_fast(uint8_t** ptr_ptr,\n                                                uint8_t* start,\n                                                uint8_t* end,\n                                                uint32_t length,\n                                                uint32_t distance) {\n  uint8_t* ptr = *ptr_ptr;\n  start = ptr - distance;\n  uint32_t n = length;\n  fo" +
-	"r (; n >= 3; n -= 3) {\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n  }\n  for (; n; n--) {\n    *ptr++ = *start++;\n  }\n  *ptr_ptr = ptr;\n  return length;\n}\n\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_reader(uint8_t** ptr_ioptr_w,\n                                          uint8_t* iobounds1_w,\n                                          uint32_t length,\n                                          uint8_t** ptr_ioptr_r,\n                                          uint8_t* iobounds1_r) {\n  uint8_t* ioptr_w = *ptr_ioptr_w;\n  size_t n = length;\n  if (n > ((size_t)(iobounds1_w - ioptr_w))) {\n    n = iobounds1_w - ioptr_w;\n  }\n  uint8_t* ioptr_r = *ptr_ioptr_r;\n  if (n > ((size_t)(iobounds1_r - ioptr_r))) {\n    n = iobounds1_r - ioptr_r;\n  }\n  if (n > 0) {\n    memmove(ioptr_w, ioptr_r, n);\n    *ptr_ioptr_w += n;\n    *ptr_ioptr_r += n;\n  }\n  return n;\n}\n\nstatic inline uint64_t  //\nwuffs_base__io_writer__copy_from_slice(uint8_t** ptr_ioptr_w,\n                                       u" +
-	"int8_t* iobounds1_w,\n                                       wuffs_base__slice_u8 src) {\n  uint8_t* ioptr_w = *ptr_ioptr_w;\n  size_t n = src.len;\n  if (n > ((size_t)(iobounds1_w - ioptr_w))) {\n    n = iobounds1_w - ioptr_w;\n  }\n  if (n > 0) {\n    memmove(ioptr_w, src.ptr, n);\n    *ptr_ioptr_w += n;\n  }\n  return n;\n}\n\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_slice(uint8_t** ptr_ioptr_w,\n                                         uint8_t* iobounds1_w,\n                                         uint32_t length,\n                                         wuffs_base__slice_u8 src) {\n  uint8_t* ioptr_w = *ptr_ioptr_w;\n  size_t n = src.len;\n  if (n > length) {\n    n = length;\n  }\n  if (n > ((size_t)(iobounds1_w - ioptr_w))) {\n    n = iobounds1_w - ioptr_w;\n  }\n  if (n > 0) {\n    memmove(ioptr_w, src.ptr, n);\n    *ptr_ioptr_w += n;\n  }\n  return n;\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_reader__set_limit(wuffs_base__io_reader* o,\n                                 uint8_t* ioptr_r,\n  " +
-	"                               uint64_t limit) {\n  if (o && (((size_t)(o->private_impl.limit - ioptr_r)) > limit)) {\n    o->private_impl.limit = ioptr_r + limit;\n  }\n  return ((wuffs_base__empty_struct){});\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_reader__set_mark(wuffs_base__io_reader* o, uint8_t* mark) {\n  o->private_impl.mark = mark;\n  return ((wuffs_base__empty_struct){});\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_writer__set(wuffs_base__io_writer* o,\n                           wuffs_base__io_buffer* b,\n                           uint8_t** ioptr1_ptr,\n                           uint8_t** ioptr2_ptr,\n                           wuffs_base__slice_u8 s) {\n  b->data.ptr = s.ptr;\n  b->data.len = s.len;\n  b->meta.wi = 0;\n  b->meta.ri = 0;\n  b->meta.pos = 0;\n  b->meta.closed = false;\n\n  o->private_impl.buf = b;\n  o->private_impl.mark = s.ptr;\n  o->private_impl.limit = s.ptr + s.len;\n  *ioptr1_ptr = s.ptr;\n  *ioptr2_ptr = s.ptr + s.len;\n  return ((wuffs_base__empty_struct){})" +
-	";\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_writer__set_mark(wuffs_base__io_writer* o, uint8_t* mark) {\n  o->private_impl.mark = mark;\n  return ((wuffs_base__empty_struct){});\n}\n\n#ifdef __cplusplus\n}  // extern \"C\"\n#endif\n\n#endif  // WUFFS_INCLUDE_GUARD__BASE_PRIVATE\n" +
+	"// ---------------- I/O\n\nstatic inline bool  //\nwuffs_base__io_buffer__is_valid(wuffs_base__io_buffer buf) {\n  return (buf.data.ptr || (buf.data.len == 0)) &&\n         (buf.data.len >= buf.meta.wi) && (buf.meta.wi >= buf.meta.ri);\n}\n\n// wuffs_base__io_reader__is_eof implements the Wuffs io_reader.is_eof method,\n// used by encoders (and by decoders of formats without an end marker, such as\n// PackBits) to distinguish \"no more input yet\" from \"no more input\".\n//\n// If making this function public (i.e. moving it to base-header.h), it also\n// needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.\n\nstatic inline bool  //\nwuffs_base__io_reader__is_eof(wuffs_base__io_reader o) {\n  wuffs_base__io_buffer* buf = o.private_impl.buf;\n  return buf && buf->meta.closed &&\n         (buf->data.ptr + buf->meta.wi == o.private_impl.limit);\n}\n\nstatic inline bool  //\nwuffs_base__io_reader__is_valid(wuffs_base__io_reader o) {\n  wuffs_base__io_buffer* buf = o.private_impl.buf;\n  // Note: if making this function public (" +
+	"i.e. moving it to base-header.h), it\n  // also needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.\n  return buf ? ((buf->data.ptr <= o.private_impl.mark) &&\n                (o.private_impl.mark <= o.private_impl.limit) &&\n                (o.private_impl.limit <= buf->data.ptr + buf->data.len))\n             : ((o.private_impl.mark == NULL) &&\n                (o.private_impl.limit == NULL));\n}\n\nstatic inline bool  //\nwuffs_base__io_writer__is_valid(wuffs_base__io_writer o) {\n  wuffs_base__io_buffer* buf = o.private_impl.buf;\n  // Note: if making this function public (i.e. moving it to base-header.h), it\n  // also needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.\n  return buf ? ((buf->data.ptr <= o.private_impl.mark) &&\n                (o.private_impl.mark <= o.private_impl.limit) &&\n                (o.private_impl.limit <= buf->data.ptr + buf->data.len))\n             : ((o.private_impl.mark == NULL) &&\n                (o.private_impl.limit == NULL));\n}\n\nstatic inline uint32_t  //" +
+	"\nwuffs_base__io_writer__copy_n_from_history(uint8_t** ptr_ptr,\n                                           uint8_t* start,\n                                           uint8_t* end,\n                                           uint32_t length,\n                                           uint32_t distance) {\n  if (!distance) {\n    return 0;\n  }\n  uint8_t* ptr = *ptr_ptr;\n  if ((size_t)(ptr - start) < (size_t)(distance)) {\n    return 0;\n  }\n  start = ptr - distance;\n  size_t n = end - ptr;\n  if ((size_t)(length) > n) {\n    length = n;\n  } else {\n    n = length;\n  }\n  // TODO: unrolling by 3 seems best for the std/deflate benchmarks, but that\n  // is mostly because 3 is the minimum length for the deflate format. This\n  // function implementation shouldn't overfit to that one format. Perhaps the\n  // copy_n_from_history Wuffs method should also take an unroll hint argument,\n  // and the cgen can look if that argument is the constant expression '3'.\n  //\n  // See also wuffs_base__io_writer__copy_n_from_history_fast belo" +
+	"w.\n  //\n  // Alternatively, or additionally, have a sloppy_copy_n_from_history method\n  // that copies 8 bytes at a time, possibly writing more than length bytes?\n  for (; n >= 3; n -= 3) {\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n  }\n  for (; n; n--) {\n    *ptr++ = *start++;\n  }\n  *ptr_ptr = ptr;\n  return length;\n}\n\n// wuffs_base__io_writer__copy_n_from_history_fast is like the\n// wuffs_base__io_writer__copy_n_from_history function above, but has stronger\n// pre-conditions. The caller needs to prove that:\n//  - distance >  0\n//  - distance <= (*ptr_ptr - start)\n//  - length   <= (end      - *ptr_ptr)\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_history_fast(uint8_t** ptr_ptr,\n                                                uint8_t* start,\n                                                uint8_t* end,\n                                                uint32_t length,\n                                                uint32_t distance) {\n  uint8_t* ptr = *ptr_ptr;\n  star" +
+	"t = ptr - distance;\n  uint32_t n = length;\n  for (; n >= 3; n -= 3) {\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n    *ptr++ = *start++;\n  }\n  for (; n; n--) {\n    *ptr++ = *start++;\n  }\n  *ptr_ptr = ptr;\n  return length;\n}\n\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_reader(uint8_t** ptr_ioptr_w,\n                                          uint8_t* iobounds1_w,\n                                          uint32_t length,\n                                          uint8_t** ptr_ioptr_r,\n                                          uint8_t* iobounds1_r) {\n  uint8_t* ioptr_w = *ptr_ioptr_w;\n  size_t n = length;\n  if (n > ((size_t)(iobounds1_w - ioptr_w))) {\n    n = iobounds1_w - ioptr_w;\n  }\n  uint8_t* ioptr_r = *ptr_ioptr_r;\n  if (n > ((size_t)(iobounds1_r - ioptr_r))) {\n    n = iobounds1_r - ioptr_r;\n  }\n  if (n > 0) {\n    memmove(ioptr_w, ioptr_r, n);\n    *ptr_ioptr_w += n;\n    *ptr_ioptr_r += n;\n  }\n  return n;\n}\n\nstatic inline uint64_t  //\nwuffs_base__io_writer__copy_from_slice(uint8_t** ptr_io" +
+	"ptr_w,\n                                       uint8_t* iobounds1_w,\n                                       wuffs_base__slice_u8 src) {\n  uint8_t* ioptr_w = *ptr_ioptr_w;\n  size_t n = src.len;\n  if (n > ((size_t)(iobounds1_w - ioptr_w))) {\n    n = iobounds1_w - ioptr_w;\n  }\n  if (n > 0) {\n    memmove(ioptr_w, src.ptr, n);\n    *ptr_ioptr_w += n;\n  }\n  return n;\n}\n\nstatic inline uint32_t  //\nwuffs_base__io_writer__copy_n_from_slice(uint8_t** ptr_ioptr_w,\n                                         uint8_t* iobounds1_w,\n                                         uint32_t length,\n                                         wuffs_base__slice_u8 src) {\n  uint8_t* ioptr_w = *ptr_ioptr_w;\n  size_t n = src.len;\n  if (n > length) {\n    n = length;\n  }\n  if (n > ((size_t)(iobounds1_w - ioptr_w))) {\n    n = iobounds1_w - ioptr_w;\n  }\n  if (n > 0) {\n    memmove(ioptr_w, src.ptr, n);\n    *ptr_ioptr_w += n;\n  }\n  return n;\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_reader__set(wuffs_base__io_reader* o,\n            " +
+	"               wuffs_base__io_buffer* b,\n                           uint8_t** ioptr1_ptr,\n                           uint8_t** ioptr2_ptr,\n                           wuffs_base__slice_u8 s,\n                           bool closed) {\n  b->data.ptr = s.ptr;\n  b->data.len = s.len;\n  b->meta.wi = s.len;\n  b->meta.ri = 0;\n  b->meta.pos = 0;\n  b->meta.closed = closed;\n\n  o->private_impl.buf = b;\n  o->private_impl.mark = s.ptr;\n  o->private_impl.limit = s.ptr + s.len;\n  *ioptr1_ptr = s.ptr;\n  *ioptr2_ptr = s.ptr + s.len;\n  return ((wuffs_base__empty_struct){});\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_reader__set_limit(wuffs_base__io_reader* o,\n                                 uint8_t* ioptr_r,\n                                 uint64_t limit) {\n  if (o && (((size_t)(o->private_impl.limit - ioptr_r)) > limit)) {\n    o->private_impl.limit = ioptr_r + limit;\n  }\n  return ((wuffs_base__empty_struct){});\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_reader__set_mark(wuffs_base__io_reader" +
+	"* o, uint8_t* mark) {\n  o->private_impl.mark = mark;\n  return ((wuffs_base__empty_struct){});\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_writer__set(wuffs_base__io_writer* o,\n                           wuffs_base__io_buffer* b,\n                           uint8_t** ioptr1_ptr,\n                           uint8_t** ioptr2_ptr,\n                           wuffs_base__slice_u8 s) {\n  b->data.ptr = s.ptr;\n  b->data.len = s.len;\n  b->meta.wi = 0;\n  b->meta.ri = 0;\n  b->meta.pos = 0;\n  b->meta.closed = false;\n\n  o->private_impl.buf = b;\n  o->private_impl.mark = s.ptr;\n  o->private_impl.limit = s.ptr + s.len;\n  *ioptr1_ptr = s.ptr;\n  *ioptr2_ptr = s.ptr + s.len;\n  return ((wuffs_base__empty_struct){});\n}\n\nstatic inline wuffs_base__empty_struct  //\nwuffs_base__io_writer__set_mark(wuffs_base__io_writer* o, uint8_t* mark) {\n  o->private_impl.mark = mark;\n  return ((wuffs_base__empty_struct){});\n}\n\n#ifdef __cplusplus\n}  // extern \"C\"\n#endif\n\n#endif  // WUFFS_INCLUDE_GUARD__BASE_PRIVATE\n" +
 	""
 
 const baseBaseImplC = "" +
-	"// Copyright 2018 The Wuffs Authors.\n//\n// Licensed under the Apache License, Version 2.0 (the \"License\");\n// you may not use this file except in compliance with the License.\n// You may obtain a copy of the License at\n//\n//    https://www.apache.org/licenses/LICENSE-2.0\n//\n// Unless required by applicable law or agreed to in writing, software\n// distributed under the License is distributed on an \"AS IS\" BASIS,\n// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n// See the License for the specific language governing permissions and\n// limitations under the License.\n\n// !! INSERT base-public.h.\n\n#ifdef WUFFS_IMPLEMENTATION\n\n// !! INSERT base-private.h.\n\n#if !defined(WUFFS_CONFIG__MODULES) || defined(WUFFS_CONFIG__MODULE__BASE)\n\n// !! INSERT wuffs_base__status strings.\n\n#endif  // !defined(WUFFS_CONFIG__MODULES) ||\n        // defined(WUFFS_CONFIG__MODULE__BASE)\n\n#endif  // WUFFS_IMPLEMENTATION\n" +
+	"// Copyright 2018 The Wuffs Authors.\n//\n// Licensed under the Apache License, Version 2.0 (the \"License\");\n// you may not use this file except in compliance with the License.\n// You may obtain a copy of the License at\n//\n//    https://www.apache.org/licenses/LICENSE-2.0\n//\n// Unless required by applicable law or agreed to in writing, software\n// distributed under the License is distributed on an \"AS IS\" BASIS,\n// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n// See the License for the specific language governing permissions and\n// limitations under the License.\n\n// !! INSERT base-public.h.\n\n#ifdef WUFFS_IMPLEMENTATION\n\n// !! INSERT base-private.h.\n\n#if !defined(WUFFS_CONFIG__MODULES) || defined(WUFFS_CONFIG__MODULE__BASE)\n\n// !! INSERT wuffs_base__status strings.\n\n// !! INSERT image-impl.c.\n\n#endif  // !defined(WUFFS_CONFIG__MODULES) ||\n        // defined(WUFFS_CONFIG__MODULE__BASE)\n\n#endif  // WUFFS_IMPLEMENTATION\n" +
+	""
+
+const baseImageImplC = "" +
+	"// Copyright 2018 The Wuffs Authors.\n//\n// Licensed under the Apache License, Version 2.0 (the \"License\");\n// you may not use this file except in compliance with the License.\n// You may obtain a copy of the License at\n//\n//    https://www.apache.org/licenses/LICENSE-2.0\n//\n// Unless required by applicable law or agreed to in writing, software\n// distributed under the License is distributed on an \"AS IS\" BASIS,\n// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n// See the License for the specific language governing permissions and\n// limitations under the License.\n\n" +
+	"" +
+	"// ---------------- Resampler\n\n// The filter weights are fixed point, with 14 fractional bits, so that a\n// weight times an 8 bit sample, summed over a pair of taps, fits in the 32 bit\n// lanes of SSE2's pmaddwd.\n#define WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT 14\n#define WUFFS_BASE__PRIVATE_RESAMPLER_ONE (1 << 14)\n#define WUFFS_BASE__PRIVATE_RESAMPLER_HALF (1 << 13)\n\n#define WUFFS_BASE__PRIVATE_RESAMPLER_PI 3.14159265358979323846\n\n// wuffs_base__private_resampler_sin approximates sin(x), for |x| up to a few\n// multiples of pi, closely enough for 14 bit weights, without needing libm.\nstatic inline double  //\nwuffs_base__private_resampler_sin(double x) {\n  const double pi = WUFFS_BASE__PRIVATE_RESAMPLER_PI;\n  while (x > pi) {\n    x -= 2 * pi;\n  }\n  while (x < -pi) {\n    x += 2 * pi;\n  }\n  if (x > (pi / 2)) {\n    x = pi - x;\n  } else if (x < -(pi / 2)) {\n    x = -pi - x;\n  }\n  double x2 = x * x;\n  return x * (1 - (x2 / 6) *\n                      (1 - (x2 / 20) *\n                               (1 - (x2 / 42) *\n      " +
+	"                                  (1 - (x2 / 72) * (1 - (x2 / 110))))));\n}\n\nstatic inline double  //\nwuffs_base__private_resampler_filter_support(\n    wuffs_base__resampler_filter filter) {\n  switch (filter) {\n    case WUFFS_BASE__RESAMPLER_FILTER__BOX:\n      return 0.5;\n    case WUFFS_BASE__RESAMPLER_FILTER__BILINEAR:\n      return 1;\n    case WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3:\n      return 3;\n  }\n  return 0;\n}\n\nstatic inline double  //\nwuffs_base__private_resampler_filter_eval(wuffs_base__resampler_filter filter,\n                                          double x) {\n  switch (filter) {\n    case WUFFS_BASE__RESAMPLER_FILTER__BOX:\n      return ((-0.5 <= x) && (x < 0.5)) ? 1 : 0;\n    case WUFFS_BASE__RESAMPLER_FILTER__BILINEAR:\n      x = (x < 0) ? -x : x;\n      return (x < 1) ? (1 - x) : 0;\n    case WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3:\n      if ((x <= -3) || (3 <= x)) {\n        return 0;\n      } else if ((-1e-8 < x) && (x < 1e-8)) {\n        return 1;\n      } else {\n        const double pi = WUFFS_BASE__" +
+	"PRIVATE_RESAMPLER_PI;\n        return (3 * wuffs_base__private_resampler_sin(pi * x) *\n                wuffs_base__private_resampler_sin(pi * x / 3)) /\n               (pi * pi * x * x);\n      }\n  }\n  return 0;\n}\n\n// wuffs_base__private_resampler_floor and wuffs_base__private_resampler_round\n// are floor and round-half-away-from-zero, without needing libm.\nstatic inline int64_t  //\nwuffs_base__private_resampler_floor(double x) {\n  int64_t i = (int64_t)(x);\n  return (((double)(i)) > x) ? (i - 1) : i;\n}\n\nstatic inline int32_t  //\nwuffs_base__private_resampler_round(double x) {\n  return (x < 0) ? -(int32_t)(0.5 - x) : (int32_t)(x + 0.5);\n}\n\n// wuffs_base__private_resampler_taps returns the maximum number of source\n// pixels that contribute to a destination pixel, along one axis, rounded up\n// to a multiple of 4 so that the SIMD loops can process 4 taps at a time.\n// Weights past a pixel's tap count are zero.\nstatic inline uint32_t  //\nwuffs_base__private_resampler_taps(wuffs_base__resampler_filter filter,\n        " +
+	"                           uint32_t src_len,\n                                   uint32_t dst_len) {\n  double support = wuffs_base__private_resampler_filter_support(filter);\n  if (src_len > dst_len) {\n    support = (support * src_len) / dst_len;\n  }\n  uint64_t n = ((uint64_t)(2 * support)) + 3;\n  if (n > src_len) {\n    n = src_len;\n  }\n  return (uint32_t)((n + 3) & ~((uint64_t)3));\n}\n\n// wuffs_base__private_resampler_weights computes, for each of the dst_len\n// destination pixels along one axis, the span (the first source pixel and\n// the number of them) and the weights of the source pixels that contribute\n// to it. Source pixels beyond the edges are clamped to the edges.\nstatic void  //\nwuffs_base__private_resampler_weights(uint32_t* spans,\n                                      int16_t* weights,\n                                      uint32_t taps,\n                                      wuffs_base__resampler_filter filter,\n                                      uint32_t src_len,\n                                 " +
+	"     uint32_t dst_len) {\n  double scale = ((double)(dst_len)) / src_len;\n  double filter_scale = (scale < 1) ? scale : 1;\n  double support =\n      wuffs_base__private_resampler_filter_support(filter) / filter_scale;\n\n  uint32_t i;\n  for (i = 0; i < dst_len; i++) {\n    int16_t* w = weights + ((size_t)(i)*taps);\n    memset(w, 0, taps * sizeof(int16_t));\n\n    double center = ((i + 0.5) / scale) - 0.5;\n    int64_t lo = wuffs_base__private_resampler_floor(center - support);\n    int64_t hi = wuffs_base__private_resampler_floor(center + support) + 1;\n    int64_t first = (lo < 0) ? 0 : lo;\n    if (first > (int64_t)(src_len - 1)) {\n      first = src_len - 1;\n    }\n\n    double sum = 0;\n    int64_t j;\n    for (j = lo; j <= hi; j++) {\n      sum += wuffs_base__private_resampler_filter_eval(\n          filter, (j - center) * filter_scale);\n    }\n    if (sum == 0) {\n      // Fall back to the nearest source pixel.\n      lo = wuffs_base__private_resampler_floor(center + 0.5);\n      first = (lo < 0) ? 0 : lo;\n      if (first > " +
+	"(int64_t)(src_len - 1)) {\n        first = src_len - 1;\n      }\n      spans[(2 * i) + 0] = (uint32_t)(first);\n      spans[(2 * i) + 1] = 1;\n      w[0] = WUFFS_BASE__PRIVATE_RESAMPLER_ONE;\n      continue;\n    }\n\n    // Accumulate the weights, merging those beyond the edges into the edges.\n    int64_t last = first;\n    for (j = lo; j <= hi; j++) {\n      double f = wuffs_base__private_resampler_filter_eval(\n          filter, (j - center) * filter_scale);\n      if (f == 0) {\n        continue;\n      }\n      int64_t k = (j < 0) ? 0 : j;\n      if (k > (int64_t)(src_len - 1)) {\n        k = src_len - 1;\n      }\n      if ((k - first) >= taps) {\n        continue;\n      }\n      last = (last > k) ? last : k;\n      int32_t v =\n          w[k - first] + wuffs_base__private_resampler_round(\n                             (f / sum) * WUFFS_BASE__PRIVATE_RESAMPLER_ONE);\n      w[k - first] =\n          (int16_t)((v < -0x7FFF) ? -0x7FFF : ((v > 0x7FFF) ? 0x7FFF : v));\n    }\n\n    // Trim zero weights from both ends.\n    uint32_t n = (" +
+	"uint32_t)(last - first + 1);\n    uint32_t skip = 0;\n    while (((skip + 1) < n) && (w[skip] == 0)) {\n      skip++;\n    }\n    if (skip > 0) {\n      memmove(w, w + skip, (n - skip) * sizeof(int16_t));\n      memset(w + (n - skip), 0, skip * sizeof(int16_t));\n      first += skip;\n      n -= skip;\n    }\n    while ((n > 1) && (w[n - 1] == 0)) {\n      n--;\n    }\n\n    // Make the weights sum to exactly one, adjusting the largest weight.\n    int32_t total = 0;\n    uint32_t biggest = 0;\n    uint32_t k;\n    for (k = 0; k < n; k++) {\n      total += w[k];\n      if (w[k] > w[biggest]) {\n        biggest = k;\n      }\n    }\n    w[biggest] =\n        (int16_t)(w[biggest] + WUFFS_BASE__PRIVATE_RESAMPLER_ONE - total);\n\n    spans[(2 * i) + 0] = (uint32_t)(first);\n    spans[(2 * i) + 1] = n;\n  }\n}\n\n// wuffs_base__private_resampler_clamp converts a fixed point sum back to an\n// 8 bit sample, rounding to nearest and saturating.\nstatic inline uint8_t  //\nwuffs_base__private_resampler_clamp(int32_t v) {\n  v += WUFFS_BASE__PRIVATE_RESAM" +
+	"PLER_HALF;\n  if (v < 0) {\n    return 0;\n  }\n  v >>= WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT;\n  return (uint8_t)((v > 0xFF) ? 0xFF : v);\n}\n\n// wuffs_base__private_resample_vertical__fallback sets each of dst's len bytes\n// to the weighted sum of the same byte in the count rows.\nstatic inline void  //\nwuffs_base__private_resample_vertical__fallback(uint8_t* dst,\n                                                size_t len,\n                                                uint8_t** rows,\n                                                const int16_t* weights,\n                                                uint32_t count,\n                                                size_t i) {\n  for (; i < len; i++) {\n    int32_t sum = 0;\n    uint32_t k;\n    for (k = 0; k < count; k++) {\n      sum += weights[k] * (int32_t)(rows[k][i]);\n    }\n    dst[i] = wuffs_base__private_resampler_clamp(sum);\n  }\n}\n\n// wuffs_base__private_resample_horizontal__fallback sets each of dst's\n// dst_width 4 byte pixels to the weighted sum of its span o" +
+	"f src's pixels.\nstatic inline void  //\nwuffs_base__private_resample_horizontal__fallback(uint8_t* dst,\n                                                  uint32_t dst_width,\n                                                  const uint8_t* src,\n                                                  const uint32_t* spans,\n                                                  const int16_t* weights,\n                                                  uint32_t taps) {\n  uint32_t x;\n  for (x = 0; x < dst_width; x++) {\n    const uint8_t* s = src + (4 * (size_t)(spans[(2 * x) + 0]));\n    uint32_t count = spans[(2 * x) + 1];\n    const int16_t* w = weights + ((size_t)(x)*taps);\n    int32_t sum0 = 0;\n    int32_t sum1 = 0;\n    int32_t sum2 = 0;\n    int32_t sum3 = 0;\n    uint32_t k;\n    for (k = 0; k < count; k++) {\n      sum0 += w[k] * (int32_t)(s[(4 * k) + 0]);\n      sum1 += w[k] * (int32_t)(s[(4 * k) + 1]);\n      sum2 += w[k] * (int32_t)(s[(4 * k) + 2]);\n      sum3 += w[k] * (int32_t)(s[(4 * k) + 3]);\n    }\n    dst[(4 * x) + 0] =" +
+	" wuffs_base__private_resampler_clamp(sum0);\n    dst[(4 * x) + 1] = wuffs_base__private_resampler_clamp(sum1);\n    dst[(4 * x) + 2] = wuffs_base__private_resampler_clamp(sum2);\n    dst[(4 * x) + 3] = wuffs_base__private_resampler_clamp(sum3);\n  }\n}\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n\n// wuffs_base__private_resampler_pack rounds and narrows four vectors of 32 bit\n// fixed point sums to 16 saturated 8 bit samples.\nstatic inline __m128i  //\nwuffs_base__private_resampler_pack(__m128i s0,\n                                   __m128i s1,\n                                   __m128i s2,\n                                   __m128i s3) {\n  const __m128i half = _mm_set1_epi32(WUFFS_BASE__PRIVATE_RESAMPLER_HALF);\n  s0 = _mm_srai_epi32(_mm_add_epi32(s0, half),\n                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);\n  s1 = _mm_srai_epi32(_mm_add_epi32(s1, half),\n                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);\n  s2 = _mm_srai_epi32(_mm_add_epi32(s2, half),\n                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIF" +
+	"T);\n  s3 = _mm_srai_epi32(_mm_add_epi32(s3, half),\n                      WUFFS_BASE__PRIVATE_RESAMPLER_SHIFT);\n  return _mm_packus_epi16(_mm_packs_epi32(s0, s1), _mm_packs_epi32(s2, s3));\n}\n\n// wuffs_base__private_resampler_weight_pair broadcasts two adjacent weights,\n// as the (low, high) 16 bit halves of every 32 bit lane, for pmaddwd.\nstatic inline __m128i  //\nwuffs_base__private_resampler_weight_pair(const int16_t* w) {\n  return _mm_set1_epi32((int)((uint32_t)((uint16_t)(w[0])) |\n                              (((uint32_t)((uint16_t)(w[1]))) << 16)));\n}\n\n// The vertical pass interleaves, 16 bits per sample, the same byte of two\n// rows, so that one pmaddwd multiplies both by their weights and adds them.\n// Each iteration consumes two rows: count is rounded up to even, and the\n// padding row has a zero weight.\nstatic inline void  //\nwuffs_base__private_resample_vertical__sse2(uint8_t* dst,\n                                            size_t len,\n                                            uint8_t** rows,\n   " +
+	"                                         const int16_t* weights,\n                                            uint32_t count) {\n  const __m128i zero = _mm_setzero_si128();\n  size_t i = 0;\n  for (; (i + 16) <= len; i += 16) {\n    __m128i s0 = zero;\n    __m128i s1 = zero;\n    __m128i s2 = zero;\n    __m128i s3 = zero;\n    uint32_t k;\n    for (k = 0; k < count; k += 2) {\n      __m128i w = wuffs_base__private_resampler_weight_pair(weights + k);\n      __m128i a = _mm_loadu_si128((const __m128i*)(rows[k + 0] + i));\n      __m128i b = _mm_loadu_si128((const __m128i*)(rows[k + 1] + i));\n      __m128i a_lo = _mm_unpacklo_epi8(a, zero);\n      __m128i a_hi = _mm_unpackhi_epi8(a, zero);\n      __m128i b_lo = _mm_unpacklo_epi8(b, zero);\n      __m128i b_hi = _mm_unpackhi_epi8(b, zero);\n      s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), w));\n      s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), w));\n      s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), w));\n  " +
+	"    s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), w));\n    }\n    _mm_storeu_si128((__m128i*)(dst + i),\n                     wuffs_base__private_resampler_pack(s0, s1, s2, s3));\n  }\n  wuffs_base__private_resample_vertical__fallback(dst, len, rows, weights,\n                                                  count, i);\n}\n\n// The horizontal pass loads 4 adjacent source pixels and interleaves pixels 0\n// and 1, and pixels 2 and 3, channel by channel, so that pmaddwd sums two\n// taps per 32 bit (per channel) lane. It produces 4 destination pixels per\n// 16 byte store. Reading up to 3 pixels past a span is safe, as the source\n// row is padded and the padding taps have zero weights.\nstatic inline void  //\nwuffs_base__private_resample_horizontal__sse2(uint8_t* dst,\n                                              uint32_t dst_width,\n                                              const uint8_t* src,\n                                              const uint32_t* spans,\n                                 " +
+	"             const int16_t* weights,\n                                              uint32_t taps) {\n  const __m128i zero = _mm_setzero_si128();\n  __m128i sums[4];\n  uint32_t x = 0;\n  for (; (x + 4) <= dst_width; x += 4) {\n    uint32_t j;\n    for (j = 0; j < 4; j++) {\n      const uint8_t* s = src + (4 * (size_t)(spans[(2 * (x + j)) + 0]));\n      uint32_t count = spans[(2 * (x + j)) + 1];\n      const int16_t* w = weights + ((size_t)(x + j) * taps);\n      __m128i sum = zero;\n      uint32_t k;\n      for (k = 0; k < count; k += 4) {\n        __m128i v = _mm_loadu_si128((const __m128i*)(s + (4 * k)));\n        __m128i u = _mm_srli_si128(v, 4);\n        __m128i p01 = _mm_unpacklo_epi8(_mm_unpacklo_epi8(v, u), zero);\n        __m128i p23 = _mm_unpacklo_epi8(_mm_unpackhi_epi8(v, u), zero);\n        sum = _mm_add_epi32(\n            sum, _mm_madd_epi16(p01, wuffs_base__private_resampler_weight_pair(\n                                         w + k + 0)));\n        sum = _mm_add_epi32(\n            sum, _mm_madd_epi16(p23, wuffs_" +
+	"base__private_resampler_weight_pair(\n                                         w + k + 2)));\n      }\n      sums[j] = sum;\n    }\n    _mm_storeu_si128(\n        (__m128i*)(dst + (4 * (size_t)(x))),\n        wuffs_base__private_resampler_pack(sums[0], sums[1], sums[2], sums[3]));\n  }\n  wuffs_base__private_resample_horizontal__fallback(\n      dst + (4 * (size_t)(x)), dst_width - x, src, spans + (2 * x),\n      weights + ((size_t)(x)*taps), taps);\n}\n\n#endif  // defined(WUFFS_BASE__HAVE_SSE2)\n\nstatic inline uint64_t  //\nwuffs_base__private_resampler_align16(uint64_t n) {\n  return (n + 15) & ~((uint64_t)15);\n}\n\nWUFFS_BASE__MAYBE_STATIC uint64_t  //\nwuffs_base__resampler__workbuf_len(wuffs_base__resampler_filter filter,\n                                   uint32_t src_width,\n                                   uint32_t src_height,\n                                   uint32_t dst_width,\n                                   uint32_t dst_height) {\n  if ((wuffs_base__private_resampler_filter_support(filter) == 0) ||\n      (src_wi" +
+	"dth == 0) || (src_width > 0xFFFFFF) || (src_height == 0) ||\n      (src_height > 0xFFFFFF) || (dst_width == 0) || (dst_width > 0xFFFFFF) ||\n      (dst_height == 0) || (dst_height > 0xFFFFFF)) {\n    return 0;\n  }\n  uint64_t x_taps =\n      wuffs_base__private_resampler_taps(filter, src_width, dst_width);\n  uint64_t y_taps =\n      wuffs_base__private_resampler_taps(filter, src_height, dst_height);\n  uint64_t row_len =\n      wuffs_base__private_resampler_align16((4 * (uint64_t)(src_width)) + 16);\n  // The leading 15 bytes of slack let initialize align the work buffer's\n  // regions to 16 bytes, wherever the caller's work buffer starts.\n  return 15 +\n         wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_width)) +\n         wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_height)) +\n         wuffs_base__private_resampler_align16(2 * x_taps * dst_width) +\n         wuffs_base__private_resampler_align16(2 * y_taps * dst_height) +\n         wuffs_base__private_resampler_align16(sizeof(uint8_t*) * y_tap" +
+	"s) +\n         row_len + (row_len * y_taps);\n}\n\nstatic inline bool  //\nwuffs_base__private_resampler_supports(wuffs_base__pixel_format pixfmt) {\n  switch (pixfmt) {\n    case WUFFS_BASE__PIXEL_FORMAT__BGRX:\n    case WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL:\n    case WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL:\n    case WUFFS_BASE__PIXEL_FORMAT__RGBX:\n    case WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL:\n    case WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL:\n      return true;\n  }\n  return false;\n}\n\nWUFFS_BASE__MAYBE_STATIC wuffs_base__status  //\nwuffs_base__resampler__initialize(wuffs_base__resampler* r,\n                                  wuffs_base__resampler_filter filter,\n                                  uint32_t src_width,\n                                  uint32_t src_height,\n                                  wuffs_base__pixel_buffer* dst,\n                                  wuffs_base__slice_u8 workbuf) {\n  if (!r) {\n    return wuffs_base__error__bad_receiver;\n  }\n  if (!dst) {\n    return wuffs_base__error__bad_argument;\n " +
+	" }\n  wuffs_base__pixel_format pixfmt = dst->pixcfg.private_impl.pixfmt;\n  if (!wuffs_base__private_resampler_supports(pixfmt)) {\n    return wuffs_base__error__unsupported_pixel_format;\n  }\n  uint32_t dst_width = dst->pixcfg.private_impl.width;\n  uint32_t dst_height = dst->pixcfg.private_impl.height;\n  uint64_t n = wuffs_base__resampler__workbuf_len(filter, src_width, src_height,\n                                                  dst_width, dst_height);\n  if (n == 0) {\n    return wuffs_base__error__bad_argument;\n  } else if (n > workbuf.len) {\n    return wuffs_base__error__bad_workbuf_length;\n  }\n\n  r->private_impl.pixfmt = pixfmt;\n  r->private_impl.dst = dst->private_impl.planes[0];\n  r->private_impl.num_src_rows = 0;\n  r->private_impl.num_dst_rows = 0;\n\n  // Re-use the weights if they were computed for the same sizes and filter,\n  // in the same work buffer. This relies on the caller not modifying the work\n  // buffer's contents in between, as documented in image-public.h.\n  if ((r->private_impl.magic == WUFF" +
+	"S_BASE__MAGIC) &&\n      (r->private_impl.filter == filter) &&\n      (r->private_impl.src_width == src_width) &&\n      (r->private_impl.src_height == src_height) &&\n      (r->private_impl.dst_width == dst_width) &&\n      (r->private_impl.dst_height == dst_height) &&\n      (r->private_impl.workbuf.ptr == workbuf.ptr) &&\n      (r->private_impl.workbuf.len == workbuf.len)) {\n    return NULL;\n  }\n\n  r->private_impl.magic = 0;\n  r->private_impl.filter = filter;\n  r->private_impl.src_width = src_width;\n  r->private_impl.src_height = src_height;\n  r->private_impl.dst_width = dst_width;\n  r->private_impl.dst_height = dst_height;\n  r->private_impl.workbuf = workbuf;\n\n  uint32_t x_taps =\n      wuffs_base__private_resampler_taps(filter, src_width, dst_width);\n  uint32_t y_taps =\n      wuffs_base__private_resampler_taps(filter, src_height, dst_height);\n  r->private_impl.x_taps = x_taps;\n  r->private_impl.y_taps = y_taps;\n\n  // Round p up to a 16 byte boundary, so that the casts below produce aligned\n  // pointers, and so " +
+	"that each row starts on a SIMD register boundary.\n  uint8_t* p = workbuf.ptr + (15 & (0 - (uintptr_t)(workbuf.ptr)));\n  r->private_impl.x_spans = (uint32_t*)(p);\n  p += wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_width));\n  r->private_impl.y_spans = (uint32_t*)(p);\n  p += wuffs_base__private_resampler_align16(8 * (uint64_t)(dst_height));\n  r->private_impl.x_weights = (int16_t*)(p);\n  p += wuffs_base__private_resampler_align16(2 * (uint64_t)(x_taps)*dst_width);\n  r->private_impl.y_weights = (int16_t*)(p);\n  p += wuffs_base__private_resampler_align16(2 * (uint64_t)(y_taps)*dst_height);\n  r->private_impl.y_rows = (uint8_t**)(p);\n  p += wuffs_base__private_resampler_align16(sizeof(uint8_t*) * y_taps);\n  size_t row_len = (size_t)(wuffs_base__private_resampler_align16(\n      (4 * (uint64_t)(src_width)) + 16));\n  r->private_impl.vrow = p;\n  memset(p, 0, row_len);\n  p += row_len;\n  r->private_impl.ring = p;\n  r->private_impl.ring_stride = row_len;\n  memset(p, 0, row_len * y_taps);\n\n  wuffs_base__private_" +
+	"resampler_weights(r->private_impl.x_spans,\n                                        r->private_impl.x_weights, x_taps,\n                                        filter, src_width, dst_width);\n  wuffs_base__private_resampler_weights(r->private_impl.y_spans,\n                                        r->private_impl.y_weights, y_taps,\n                                        filter, src_height, dst_height);\n  r->private_impl.magic = WUFFS_BASE__MAGIC;\n  return NULL;\n}\n\n// wuffs_base__private_resampler_premultiply__fallback copies n\n// non-premultiplied pixels from src to dst, premultiplying them.\nstatic inline void  //\nwuffs_base__private_resampler_premultiply__fallback(uint8_t* dst,\n                                                    const uint8_t* src,\n                                                    size_t n) {\n  size_t i;\n  for (i = 0; i < n; i++) {\n    uint32_t a = src[3];\n    dst[0] = (uint8_t)(((src[0] * a) + 127) / 255);\n    dst[1] = (uint8_t)(((src[1] * a) + 127) / 255);\n    dst[2] = (uint8_t)(((src[2] * a" +
+	") + 127) / 255);\n    dst[3] = (uint8_t)(a);\n    dst += 4;\n    src += 4;\n  }\n}\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n\n// wuffs_base__private_resampler_premultiply__sse2 premultiplies 4 pixels at a\n// time. Each 16 bit product c×a is divided by 255, rounding to nearest, as\n// ((t + (t >> 8)) >> 8) where t is (c×a + 128), which matches the fallback's\n// ((c×a + 127) / 255) exactly for every 8 bit c and a.\nstatic inline void  //\nwuffs_base__private_resampler_premultiply__sse2(uint8_t* dst,\n                                                const uint8_t* src,\n                                                size_t n) {\n  const __m128i zero = _mm_setzero_si128();\n  const __m128i bias = _mm_set1_epi16(128);\n  const __m128i alpha_mask = _mm_set1_epi32((int)0xFF000000u);\n  size_t i = 0;\n  for (; (i + 4) <= n; i += 4) {\n    __m128i v = _mm_loadu_si128((const __m128i*)(src + (4 * i)));\n    __m128i lo = _mm_unpacklo_epi8(v, zero);\n    __m128i hi = _mm_unpackhi_epi8(v, zero);\n    __m128i a_lo = _mm_shufflehi_epi16(_mm_shuff" +
+	"lelo_epi16(lo, 0xFF), 0xFF);\n    __m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);\n    __m128i t_lo = _mm_add_epi16(_mm_mullo_epi16(lo, a_lo), bias);\n    __m128i t_hi = _mm_add_epi16(_mm_mullo_epi16(hi, a_hi), bias);\n    t_lo = _mm_srli_epi16(_mm_add_epi16(t_lo, _mm_srli_epi16(t_lo, 8)), 8);\n    t_hi = _mm_srli_epi16(_mm_add_epi16(t_hi, _mm_srli_epi16(t_hi, 8)), 8);\n    __m128i c = _mm_packus_epi16(t_lo, t_hi);\n    _mm_storeu_si128((__m128i*)(dst + (4 * i)),\n                     _mm_or_si128(_mm_andnot_si128(alpha_mask, c),\n                                  _mm_and_si128(alpha_mask, v)));\n  }\n  wuffs_base__private_resampler_premultiply__fallback(dst + (4 * i),\n                                                      src + (4 * i), n - i);\n}\n\n#endif  // defined(WUFFS_BASE__HAVE_SSE2)\n\n// wuffs_base__private_resampler_finish_row fixes up, in place, a filtered row\n// of n premultiplied pixels: its colors are clamped to its alpha, as negative\n// filter lobes can overshoot, and then un-premulti" +
+	"plied if the pixel format\n// is not premultiplied.\nstatic inline void  //\nwuffs_base__private_resampler_finish_row(uint8_t* d,\n                                         size_t n,\n                                         wuffs_base__pixel_format pixfmt) {\n  if ((pixfmt == WUFFS_BASE__PIXEL_FORMAT__BGRX) ||\n      (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBX)) {\n    return;\n  }\n  bool premul = (pixfmt == WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL) ||\n                (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL);\n  size_t i;\n  for (i = 0; i < n; i++) {\n    uint32_t a = d[3];\n    uint32_t c0 = (d[0] < a) ? d[0] : a;\n    uint32_t c1 = (d[1] < a) ? d[1] : a;\n    uint32_t c2 = (d[2] < a) ? d[2] : a;\n    if (premul) {\n      d[0] = (uint8_t)(c0);\n      d[1] = (uint8_t)(c1);\n      d[2] = (uint8_t)(c2);\n    } else if (a == 0) {\n      d[0] = 0;\n      d[1] = 0;\n      d[2] = 0;\n    } else if (a < 0xFF) {\n      d[0] = (uint8_t)(((c0 * 0xFF) + (a / 2)) / a);\n      d[1] = (uint8_t)(((c1 * 0xFF) + (a / 2)) / a);\n      d[2] = (uint8_" +
+	"t)(((c2 * 0xFF) + (a / 2)) / a);\n    }\n    d += 4;\n  }\n}\n\n// wuffs_base__private_resampler_write_row filters the ring's rows vertically\n// into vrow and then vrow horizontally into the next destination row.\nstatic void  //\nwuffs_base__private_resampler_write_row(wuffs_base__resampler* r) {\n  uint32_t y = r->private_impl.num_dst_rows;\n  uint32_t first = r->private_impl.y_spans[(2 * y) + 0];\n  uint32_t count = r->private_impl.y_spans[(2 * y) + 1];\n  const int16_t* w =\n      r->private_impl.y_weights + ((size_t)(y)*r->private_impl.y_taps);\n  uint8_t** rows = r->private_impl.y_rows;\n  uint32_t k;\n  for (k = 0; k < count; k++) {\n    rows[k] = r->private_impl.ring + (((first + k) % r->private_impl.y_taps) *\n                                      r->private_impl.ring_stride);\n  }\n  size_t len = 4 * (size_t)(r->private_impl.src_width);\n\n#if defined(WUFFS_BASE__HAVE_SSE2)\n  // Pad the rows to an even count. The padding row's weight is zero.\n  if (count & 1) {\n    rows[count] = rows[0];\n  }\n  wuffs_base__private_resampl" +
+	"e_vertical__sse2(r->private_impl.vrow, len, rows,\n                                              w, count);\n#else\n  wuffs_base__private_resample_vertical__fallback(r->private_impl.vrow, len,\n                                                  rows, w, count, 0);\n#endif\n\n  wuffs_base__slice_u8 d = wuffs_base__table_u8__row(r->private_impl.dst, y);\n  uint32_t dst_width = r->private_impl.dst_width;\n  if (d.len < (4 * (size_t)(dst_width))) {\n    return;\n  }\n#if defined(WUFFS_BASE__HAVE_SSE2)\n  wuffs_base__private_resample_horizontal__sse2(\n      d.ptr, dst_width, r->private_impl.vrow, r->private_impl.x_spans,\n      r->private_impl.x_weights, r->private_impl.x_taps);\n#else\n  wuffs_base__private_resample_horizontal__fallback(\n      d.ptr, dst_width, r->private_impl.vrow, r->private_impl.x_spans,\n      r->private_impl.x_weights, r->private_impl.x_taps);\n#endif\n  wuffs_base__private_resampler_finish_row(d.ptr, dst_width,\n                                           r->private_impl.pixfmt);\n}\n\nWUFFS_BASE__MAYBE_STATIC wuff" +
+	"s_base__status  //\nwuffs_base__resampler__consume_row(wuffs_base__resampler* r,\n                                   wuffs_base__slice_u8 src_row) {\n  if (!r) {\n    return wuffs_base__error__bad_receiver;\n  }\n  if (r->private_impl.magic != WUFFS_BASE__MAGIC) {\n    return wuffs_base__error__check_wuffs_version_missing;\n  }\n  uint32_t s = r->private_impl.num_src_rows;\n  if (s >= r->private_impl.src_height) {\n    return wuffs_base__error__bad_call_sequence;\n  }\n  size_t len = 4 * (size_t)(r->private_impl.src_width);\n  if (src_row.len < len) {\n    return wuffs_base__error__bad_argument_length_too_short;\n  }\n\n  uint8_t* ring_row = r->private_impl.ring + ((s % r->private_impl.y_taps) *\n                                              r->private_impl.ring_stride);\n  wuffs_base__pixel_format pixfmt = r->private_impl.pixfmt;\n  if ((pixfmt == WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) ||\n      (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL)) {\n#if defined(WUFFS_BASE__HAVE_SSE2)\n    wuffs_base__private_resampler_premulti" +
+	"ply__sse2(ring_row, src_row.ptr,\n                                                    r->private_impl.src_width);\n#else\n    wuffs_base__private_resampler_premultiply__fallback(\n        ring_row, src_row.ptr, r->private_impl.src_width);\n#endif\n  } else {\n    memcpy(ring_row, src_row.ptr, len);\n  }\n  r->private_impl.num_src_rows = ++s;\n\n  // Write every destination row whose span of source rows is complete.\n  while (r->private_impl.num_dst_rows < r->private_impl.dst_height) {\n    uint32_t y = r->private_impl.num_dst_rows;\n    uint32_t end = r->private_impl.y_spans[(2 * y) + 0] +\n                   r->private_impl.y_spans[(2 * y) + 1];\n    if (end > s) {\n      break;\n    }\n    wuffs_base__private_resampler_write_row(r);\n    r->private_impl.num_dst_rows++;\n  }\n  return NULL;\n}\n\nWUFFS_BASE__MAYBE_STATIC wuffs_base__status  //\nwuffs_base__resampler__resample(wuffs_base__resampler* r,\n                                wuffs_base__pixel_buffer* src) {\n  if (!r) {\n    return wuffs_base__error__bad_receiver;\n  }\n  if (!sr" +
+	"c) {\n    return wuffs_base__error__bad_argument;\n  }\n  if ((src->pixcfg.private_impl.pixfmt != r->private_impl.pixfmt) ||\n      (src->pixcfg.private_impl.width != r->private_impl.src_width) ||\n      (src->pixcfg.private_impl.height != r->private_impl.src_height)) {\n    return wuffs_base__error__bad_argument;\n  }\n  wuffs_base__table_u8 tab = src->private_impl.planes[0];\n  uint32_t y;\n  for (y = r->private_impl.num_src_rows; y < r->private_impl.src_height; y++) {\n    wuffs_base__status z = wuffs_base__resampler__consume_row(\n        r, wuffs_base__table_u8__row(tab, y));\n    if (z) {\n      return z;\n    }\n  }\n  return NULL;\n}\n" +
 	""
 
 const baseImagePublicH = "" +
@@ -129,19 +216,22 @@ const baseImagePublicH = "" +
 	"se__pixel_format 0x3210BBBB is a natural format for\n// decoding a PNG image - network byte order (also known as big-endian),\n// packed, non-premultiplied alpha - that happens to be 16-bit-depth truecolor\n// with alpha (RGBA). In memory order:\n//\n//  ptr+0  ptr+1  ptr+2  ptr+3  ptr+4  ptr+5  ptr+6  ptr+7\n//  Rhi    Rlo    Ghi    Glo    Bhi    Blo    Ahi    Alo\n//\n// For example, the value wuffs_base__pixel_format 0x20000565 means BGR with no\n// alpha or padding, 5/6/5 bits for blue/green/red, packed 2 bytes per pixel,\n// laid out LSB-first in memory order:\n//\n//  ptr+0...........  ptr+1...........\n//  MSB          LSB  MSB          LSB\n//  G₂G₁G₀B₄B₃B₂B₁B₀  R₄R₃R₂R₁R₀G₅G₄G₃\n//\n// On little-endian systems (but not big-endian), this Wuffs pixel format value\n// (0x20000565) corresponds to the Cairo library's CAIRO_FORMAT_RGB16_565, the\n// SDL2 (Simple DirectMedia Layer 2) library's SDL_PIXELFORMAT_RGB565 and the\n// Skia library's kRGB_565_SkColorType. Note BGR in Wuffs versus RGB i" +
 	"n the\n// other libraries.\n//\n// Regardless of endianness, this Wuffs pixel format value (0x20000565)\n// corresponds to the V4L2 (Video For Linux 2) library's V4L2_PIX_FMT_RGB565\n// and the Wayland-DRM library's WL_DRM_FORMAT_RGB565.\n//\n// Different software libraries name their pixel formats (and especially their\n// channel order) either according to memory layout or as bits of a native\n// integer type like uint32_t. The two conventions differ because of a system's\n// endianness. As mentioned earlier, Wuffs pixel formats are always in memory\n// order. More detail of other software libraries' naming conventions is in the\n// Pixel Format Guide at https://afrantzis.github.io/pixel-format-guide/\n//\n// Do not manipulate these bits directly; they are private implementation\n// details. Use methods such as wuffs_base__pixel_format__num_planes instead.\ntypedef uint32_t wuffs_base__pixel_format;\n\n// Common 8-bit-depth pixel formats. This list is not exhaustive; not all valid\n// wuffs_base__pixel_format values are prese" +
 	"nt.\n\n#define WUFFS_BASE__PIXEL_FORMAT__INVALID ((wuffs_base__pixel_format)0x00000000)\n\n#define WUFFS_BASE__PIXEL_FORMAT__A ((wuffs_base__pixel_format)0x02000008)\n\n#define WUFFS_BASE__PIXEL_FORMAT__Y ((wuffs_base__pixel_format)0x10000008)\n#define WUFFS_BASE__PIXEL_FORMAT__YA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x12000008)\n#define WUFFS_BASE__PIXEL_FORMAT__YA_PREMUL \\\n  ((wuffs_base__pixel_format)0x13000008)\n\n#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x22040008)\n\n#define WUFFS_BASE__PIXEL_FORMAT__BGR ((wuffs_base__pixel_format)0x20000888)\n#define WUFFS_BASE__PIXEL_FORMAT__BGRX ((wuffs_base__pixel_format)0x21008888)\n#define WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x22008888)\n#define WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL \\\n  ((wuffs_base__pixel_format)0x23008888)\n\n#define WUFFS_BASE__PIXEL_FORMAT__RGB ((wuffs_base__pixel_format)0x30000888)\n#define WUFFS_BASE__PIXEL_FORMAT__RGBX ((wuffs_base__pixel_format)0x31008888)\n#define WUFFS_" +
-	"BASE__PIXEL_FORMAT__RGBA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x32008888)\n#define WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL \\\n  ((wuffs_base__pixel_format)0x33008888)\n\n#define WUFFS_BASE__PIXEL_FORMAT__YUV ((wuffs_base__pixel_format)0x40020888)\n#define WUFFS_BASE__PIXEL_FORMAT__YUVK ((wuffs_base__pixel_format)0x41038888)\n#define WUFFS_BASE__PIXEL_FORMAT__YUVA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x42038888)\n\n#define WUFFS_BASE__PIXEL_FORMAT__CMY ((wuffs_base__pixel_format)0x50020888)\n#define WUFFS_BASE__PIXEL_FORMAT__CMYK ((wuffs_base__pixel_format)0x51038888)\n\nstatic inline bool  //\nwuffs_base__pixel_format__is_valid(wuffs_base__pixel_format f) {\n  return f != 0;\n}\n\nstatic inline bool  //\nwuffs_base__pixel_format__is_indexed(wuffs_base__pixel_format f) {\n  return (f >> 18) & 0x01;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_format__num_planes(wuffs_base__pixel_format f) {\n  return f ? (((f >> 16) & 0x03) + 1) : 0;\n}\n\n#define WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX 4\n\n#define WUFFS_BASE__PIXEL_FORMAT" +
-	"__INDEXED__INDEX_PLANE 0\n#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE 3\n\n" +
+	"BASE__PIXEL_FORMAT__RGBA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x32008888)\n#define WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL \\\n  ((wuffs_base__pixel_format)0x33008888)\n\n#define WUFFS_BASE__PIXEL_FORMAT__YUV ((wuffs_base__pixel_format)0x40020888)\n#define WUFFS_BASE__PIXEL_FORMAT__YUVK ((wuffs_base__pixel_format)0x41038888)\n#define WUFFS_BASE__PIXEL_FORMAT__YUVA_NONPREMUL \\\n  ((wuffs_base__pixel_format)0x42038888)\n\n#define WUFFS_BASE__PIXEL_FORMAT__CMY ((wuffs_base__pixel_format)0x50020888)\n#define WUFFS_BASE__PIXEL_FORMAT__CMYK ((wuffs_base__pixel_format)0x51038888)\n\nstatic inline bool  //\nwuffs_base__pixel_format__is_valid(wuffs_base__pixel_format f) {\n  return f != 0;\n}\n\nstatic inline bool  //\nwuffs_base__pixel_format__is_indexed(wuffs_base__pixel_format f) {\n  return (f >> 18) & 0x01;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_format__num_planes(wuffs_base__pixel_format f) {\n  return f ? (((f >> 16) & 0x03) + 1) : 0;\n}\n\n// wuffs_base__pixel_format__bits_per_pixel returns the number of bits per\n// pixel " +
+	"of a packed (single plane) pixel format, including indexed formats. It\n// returns zero for planar or invalid formats.\nstatic inline uint32_t  //\nwuffs_base__pixel_format__bits_per_pixel(wuffs_base__pixel_format f) {\n  static const uint8_t depths[16] = {\n      0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 16, 24, 32, 48, 64,\n  };\n  if ((f == 0) || (((f >> 16) & 0x03) != 0)) {\n    return 0;\n  }\n  return depths[0x0F & (f >> 0)] + depths[0x0F & (f >> 4)] +\n         depths[0x0F & (f >> 8)] + depths[0x0F & (f >> 12)];\n}\n\n// wuffs_base__pixel_format__is_planar_8_bit returns whether f is a planar\n// (multiple plane) pixel format with 8 bits per sample in every plane, such as\n// WUFFS_BASE__PIXEL_FORMAT__YUV.\nstatic inline bool  //\nwuffs_base__pixel_format__is_planar_8_bit(wuffs_base__pixel_format f) {\n  uint32_t n = (f >> 16) & 0x03;\n  if ((n == 0) || ((f >> 18) & 0x01)) {\n    return false;\n  }\n  uint32_t p;\n  for (p = 0; p <= n; p++) {\n    if (((f >> (4 * p)) & 0x0F) != 8) {\n      return false;\n    }\n  }\n  return true;\n}\n\n#def" +
+	"ine WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX 4\n\n#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__INDEX_PLANE 0\n#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE 3\n\n" +
 	"" +
 	"// --------\n\n// wuffs_base__pixel_subsampling encodes the mapping of pixel space coordinates\n// (x, y) to pixel buffer indices (i, j). That mapping can differ for each\n// plane p. For a depth of 8 bits (1 byte), the p'th plane's sample starts at\n// (planes[p].ptr + (j * planes[p].stride) + i).\n//\n// For packed pixel formats, the mapping is trivial: i = x and j = y. For\n// planar pixel formats, the mapping can differ due to chroma subsampling. For\n// example, consider a three plane YUV pixel format with 4:2:2 subsampling. For\n// the luma (Y) channel, there is one sample for every pixel, but for the\n// chroma (U, V) channels, there is one sample for every two pixels: pairs of\n// horizontally adjacent pixels form one macropixel, i = x / 2 and j == y. In\n// general, for a given p:\n//  - i = (x + bias_x) >> shift_x.\n//  - j = (y + bias_y) >> shift_y.\n// where biases and shifts are in the range 0..3 and 0..2 respectively.\n//\n// In general, the biases will be zero after decoding an image. However, making\n// a sub-im" +
 	"age may change the bias, since the (x, y) coordinates are relative\n// to the sub-image's top-left origin, but the backing pixel buffers were\n// created relative to the original image's origin.\n//\n// For each plane p, each of those four numbers (biases and shifts) are encoded\n// in two bits, which combine to form an 8 bit unsigned integer:\n//\n//  e_p = (bias_x << 6) | (shift_x << 4) | (bias_y << 2) | (shift_y << 0)\n//\n// Those e_p values (e_0 for the first plane, e_1 for the second plane, etc)\n// combine to form a wuffs_base__pixel_subsampling value:\n//\n//  pixsub = (e_3 << 24) | (e_2 << 16) | (e_1 << 8) | (e_0 << 0)\n//\n// Do not manipulate these bits directly; they are private implementation\n// details. Use methods such as wuffs_base__pixel_subsampling__bias_x instead.\ntypedef uint32_t wuffs_base__pixel_subsampling;\n\n#define WUFFS_BASE__PIXEL_SUBSAMPLING__NONE ((wuffs_base__pixel_subsampling)0)\n\n#define WUFFS_BASE__PIXEL_SUBSAMPLING__444 \\\n  ((wuffs_base__pixel_subsampling)0x000000)\n#define WUFFS_BASE__PIXEL_" +
 	"SUBSAMPLING__440 \\\n  ((wuffs_base__pixel_subsampling)0x010100)\n#define WUFFS_BASE__PIXEL_SUBSAMPLING__422 \\\n  ((wuffs_base__pixel_subsampling)0x101000)\n#define WUFFS_BASE__PIXEL_SUBSAMPLING__420 \\\n  ((wuffs_base__pixel_subsampling)0x111100)\n#define WUFFS_BASE__PIXEL_SUBSAMPLING__411 \\\n  ((wuffs_base__pixel_subsampling)0x202000)\n#define WUFFS_BASE__PIXEL_SUBSAMPLING__410 \\\n  ((wuffs_base__pixel_subsampling)0x212100)\n\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__bias_x(wuffs_base__pixel_subsampling s,\n                                      uint32_t plane) {\n  uint32_t shift = ((plane & 0x03) * 8) + 6;\n  return (s >> shift) & 0x03;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__shift_x(wuffs_base__pixel_subsampling s,\n                                       uint32_t plane) {\n  uint32_t shift = ((plane & 0x03) * 8) + 4;\n  return (s >> shift) & 0x03;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__bias_y(wuffs_base__pixel_subsampling s,\n                                      ui" +
-	"nt32_t plane) {\n  uint32_t shift = ((plane & 0x03) * 8) + 2;\n  return (s >> shift) & 0x03;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__shift_y(wuffs_base__pixel_subsampling s,\n                                       uint32_t plane) {\n  uint32_t shift = ((plane & 0x03) * 8) + 0;\n  return (s >> shift) & 0x03;\n}\n\n" +
+	"nt32_t plane) {\n  uint32_t shift = ((plane & 0x03) * 8) + 2;\n  return (s >> shift) & 0x03;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__shift_y(wuffs_base__pixel_subsampling s,\n                                       uint32_t plane) {\n  uint32_t shift = ((plane & 0x03) * 8) + 0;\n  return (s >> shift) & 0x03;\n}\n\n// wuffs_base__pixel_subsampling__plane_width returns the number of samples in\n// each row of the p'th plane, for an image that is width pixels wide.\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__plane_width(wuffs_base__pixel_subsampling s,\n                                           uint32_t plane,\n                                           uint32_t width) {\n  if (width == 0) {\n    return 0;\n  }\n  return ((width - 1 + wuffs_base__pixel_subsampling__bias_x(s, plane)) >>\n          wuffs_base__pixel_subsampling__shift_x(s, plane)) +\n         1;\n}\n\n// wuffs_base__pixel_subsampling__plane_height returns the number of rows in\n// the p'th plane, for an image that is height pixels hi" +
+	"gh.\nstatic inline uint32_t  //\nwuffs_base__pixel_subsampling__plane_height(wuffs_base__pixel_subsampling s,\n                                            uint32_t plane,\n                                            uint32_t height) {\n  if (height == 0) {\n    return 0;\n  }\n  return ((height - 1 + wuffs_base__pixel_subsampling__bias_y(s, plane)) >>\n          wuffs_base__pixel_subsampling__shift_y(s, plane)) +\n         1;\n}\n\n" +
 	"" +
 	"// --------\n\ntypedef struct {\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    wuffs_base__pixel_format pixfmt;\n    wuffs_base__pixel_subsampling pixsub;\n    uint32_t width;\n    uint32_t height;\n  } private_impl;\n\n#ifdef __cplusplus\n  inline void initialize(wuffs_base__pixel_format pixfmt,\n                         wuffs_base__pixel_subsampling pixsub,\n                         uint32_t width,\n                         uint32_t height);\n  inline void invalidate();\n  inline bool is_valid();\n  inline wuffs_base__pixel_format pixel_format();\n  inline wuffs_base__pixel_subsampling pixel_subsampling();\n  inline wuffs_base__rect_ie_u32 bounds();\n  inline uint32_t width();\n  inline uint32_t height();\n  inline uint64_t pixbuf_len();\n#endif  // __cplusplus\n\n} wuffs_base__pixel_config;\n\n// TODO: Should this function return bool? An error type?\nstatic inline void  //\nwuffs_base__pixel_config__initialize(wuffs_base__pixel_config* c" +
-	",\n                                     wuffs_base__pixel_format pixfmt,\n                                     wuffs_base__pixel_subsampling pixsub,\n                                     uint32_t width,\n                                     uint32_t height) {\n  if (!c) {\n    return;\n  }\n  if (pixfmt) {\n    uint64_t wh = ((uint64_t)width) * ((uint64_t)height);\n    // TODO: handle things other than 1 byte per pixel.\n    if (wh <= ((uint64_t)SIZE_MAX)) {\n      c->private_impl.pixfmt = pixfmt;\n      c->private_impl.pixsub = pixsub;\n      c->private_impl.width = width;\n      c->private_impl.height = height;\n      return;\n    }\n  }\n  *c = ((wuffs_base__pixel_config){});\n}\n\nstatic inline void  //\nwuffs_base__pixel_config__invalidate(wuffs_base__pixel_config* c) {\n  if (c) {\n    *c = ((wuffs_base__pixel_config){});\n  }\n}\n\nstatic inline bool  //\nwuffs_base__pixel_config__is_valid(wuffs_base__pixel_config* c) {\n  return c && c->private_impl.pixfmt;\n}\n\nstatic inline wuffs_base__pixel_format  //\nwuffs_base__pixel_config__pix" +
-	"el_format(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.pixfmt : 0;\n}\n\nstatic inline wuffs_base__pixel_subsampling  //\nwuffs_base__pixel_config__pixel_subsampling(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.pixsub : 0;\n}\n\nstatic inline wuffs_base__rect_ie_u32  //\nwuffs_base__pixel_config__bounds(wuffs_base__pixel_config* c) {\n  return c ? ((wuffs_base__rect_ie_u32){\n                 .min_incl_x = 0,\n                 .min_incl_y = 0,\n                 .max_excl_x = c->private_impl.width,\n                 .max_excl_y = c->private_impl.height,\n             })\n           : ((wuffs_base__rect_ie_u32){});\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_config__width(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.width : 0;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_config__height(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.height : 0;\n}\n\n// TODO: this is the right API for planar (not packed) pixbufs? Should it allow\n// decoding into a color model differ" +
-	"ent from the format's intrinsic one? For\n// example, decoding a JPEG image straight to RGBA instead of to YCbCr?\nstatic inline uint64_t  //\nwuffs_base__pixel_config__pixbuf_len(wuffs_base__pixel_config* c) {\n  if (c) {\n    uint64_t n =\n        ((uint64_t)c->private_impl.width) * ((uint64_t)c->private_impl.height);\n    // TODO: handle things other than 1 byte per pixel. When doing so, consider\n    // that the +1024 below could overflow.\n    if (wuffs_base__pixel_format__is_indexed(c->private_impl.pixfmt)) {\n      n += 1024;\n    }\n    return n;\n  }\n  return 0;\n}\n\n#ifdef __cplusplus\n\ninline void  //\nwuffs_base__pixel_config::initialize(wuffs_base__pixel_format pixfmt,\n                                     wuffs_base__pixel_subsampling pixsub,\n                                     uint32_t width,\n                                     uint32_t height) {\n  wuffs_base__pixel_config__initialize(this, pixfmt, pixsub, width, height);\n}\n\ninline void  //\nwuffs_base__pixel_config::invalidate() {\n  wuffs_base__pixel_config__i" +
-	"nvalidate(this);\n}\n\ninline bool  //\nwuffs_base__pixel_config::is_valid() {\n  return wuffs_base__pixel_config__is_valid(this);\n}\n\ninline wuffs_base__pixel_format  //\nwuffs_base__pixel_config::pixel_format() {\n  return wuffs_base__pixel_config__pixel_format(this);\n}\n\ninline wuffs_base__pixel_subsampling  //\nwuffs_base__pixel_config::pixel_subsampling() {\n  return wuffs_base__pixel_config__pixel_subsampling(this);\n}\n\ninline wuffs_base__rect_ie_u32  //\nwuffs_base__pixel_config::bounds() {\n  return wuffs_base__pixel_config__bounds(this);\n}\n\ninline uint32_t  //\nwuffs_base__pixel_config::width() {\n  return wuffs_base__pixel_config__width(this);\n}\n\ninline uint32_t  //\nwuffs_base__pixel_config::height() {\n  return wuffs_base__pixel_config__height(this);\n}\n\ninline uint64_t  //\nwuffs_base__pixel_config::pixbuf_len() {\n  return wuffs_base__pixel_config__pixbuf_len(this);\n}\n\n#endif  // __cplusplus\n\n" +
+	",\n                                     wuffs_base__pixel_format pixfmt,\n                                     wuffs_base__pixel_subsampling pixsub,\n                                     uint32_t width,\n                                     uint32_t height) {\n  if (!c) {\n    return;\n  }\n  if (pixfmt) {\n    uint64_t wh = ((uint64_t)width) * ((uint64_t)height);\n    // TODO: handle fractional bytes per pixel.\n    uint64_t bytes_per_pixel =\n        wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8;\n    if (wuffs_base__pixel_format__is_planar_8_bit(pixfmt)) {\n      // Subsampled planes are no larger than the first plane.\n      bytes_per_pixel = wuffs_base__pixel_format__num_planes(pixfmt);\n    } else if (bytes_per_pixel == 0) {\n      bytes_per_pixel = 1;\n    }\n    if (wh <= (((uint64_t)SIZE_MAX) / bytes_per_pixel)) {\n      c->private_impl.pixfmt = pixfmt;\n      c->private_impl.pixsub = pixsub;\n      c->private_impl.width = width;\n      c->private_impl.height = height;\n      return;\n    }\n  }\n  *c = ((wuffs_base__pi" +
+	"xel_config){});\n}\n\nstatic inline void  //\nwuffs_base__pixel_config__invalidate(wuffs_base__pixel_config* c) {\n  if (c) {\n    *c = ((wuffs_base__pixel_config){});\n  }\n}\n\nstatic inline bool  //\nwuffs_base__pixel_config__is_valid(wuffs_base__pixel_config* c) {\n  return c && c->private_impl.pixfmt;\n}\n\nstatic inline wuffs_base__pixel_format  //\nwuffs_base__pixel_config__pixel_format(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.pixfmt : 0;\n}\n\nstatic inline wuffs_base__pixel_subsampling  //\nwuffs_base__pixel_config__pixel_subsampling(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.pixsub : 0;\n}\n\nstatic inline wuffs_base__rect_ie_u32  //\nwuffs_base__pixel_config__bounds(wuffs_base__pixel_config* c) {\n  return c ? ((wuffs_base__rect_ie_u32){\n                 .min_incl_x = 0,\n                 .min_incl_y = 0,\n                 .max_excl_x = c->private_impl.width,\n                 .max_excl_y = c->private_impl.height,\n             })\n           : ((wuffs_base__rect_ie_u32){});\n}\n\nstatic inline " +
+	"uint32_t  //\nwuffs_base__pixel_config__width(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.width : 0;\n}\n\nstatic inline uint32_t  //\nwuffs_base__pixel_config__height(wuffs_base__pixel_config* c) {\n  return c ? c->private_impl.height : 0;\n}\n\n// wuffs_base__pixel_config__pixbuf_len returns the number of bytes needed by\n// wuffs_base__pixel_buffer__set_from_slice. For planar formats, such as\n// WUFFS_BASE__PIXEL_FORMAT__YUV, that is the sum of each (possibly\n// subsampled) plane's width times height.\nstatic inline uint64_t  //\nwuffs_base__pixel_config__pixbuf_len(wuffs_base__pixel_config* c) {\n  if (c && wuffs_base__pixel_format__is_planar_8_bit(c->private_impl.pixfmt)) {\n    uint64_t n = 0;\n    uint32_t num_planes =\n        wuffs_base__pixel_format__num_planes(c->private_impl.pixfmt);\n    uint32_t p;\n    for (p = 0; p < num_planes; p++) {\n      n += ((uint64_t)wuffs_base__pixel_subsampling__plane_width(\n               c->private_impl.pixsub, p, c->private_impl.width)) *\n           ((uint64_t)wuffs_" +
+	"base__pixel_subsampling__plane_height(\n               c->private_impl.pixsub, p, c->private_impl.height));\n    }\n    return n;\n  } else if (c) {\n    uint64_t n =\n        ((uint64_t)c->private_impl.width) * ((uint64_t)c->private_impl.height);\n    // TODO: handle planar formats and fractional bytes per pixel. Consider\n    // that the +1024 below could overflow.\n    uint64_t bytes_per_pixel =\n        wuffs_base__pixel_format__bits_per_pixel(c->private_impl.pixfmt) / 8;\n    if (bytes_per_pixel > 1) {\n      n *= bytes_per_pixel;\n    }\n    if (wuffs_base__pixel_format__is_indexed(c->private_impl.pixfmt)) {\n      n += 1024;\n    }\n    return n;\n  }\n  return 0;\n}\n\n#ifdef __cplusplus\n\ninline void  //\nwuffs_base__pixel_config::initialize(wuffs_base__pixel_format pixfmt,\n                                     wuffs_base__pixel_subsampling pixsub,\n                                     uint32_t width,\n                                     uint32_t height) {\n  wuffs_base__pixel_config__initialize(this, pixfmt, pixsub, width, he" +
+	"ight);\n}\n\ninline void  //\nwuffs_base__pixel_config::invalidate() {\n  wuffs_base__pixel_config__invalidate(this);\n}\n\ninline bool  //\nwuffs_base__pixel_config::is_valid() {\n  return wuffs_base__pixel_config__is_valid(this);\n}\n\ninline wuffs_base__pixel_format  //\nwuffs_base__pixel_config::pixel_format() {\n  return wuffs_base__pixel_config__pixel_format(this);\n}\n\ninline wuffs_base__pixel_subsampling  //\nwuffs_base__pixel_config::pixel_subsampling() {\n  return wuffs_base__pixel_config__pixel_subsampling(this);\n}\n\ninline wuffs_base__rect_ie_u32  //\nwuffs_base__pixel_config::bounds() {\n  return wuffs_base__pixel_config__bounds(this);\n}\n\ninline uint32_t  //\nwuffs_base__pixel_config::width() {\n  return wuffs_base__pixel_config__width(this);\n}\n\ninline uint32_t  //\nwuffs_base__pixel_config::height() {\n  return wuffs_base__pixel_config__height(this);\n}\n\ninline uint64_t  //\nwuffs_base__pixel_config::pixbuf_len() {\n  return wuffs_base__pixel_config__pixbuf_len(this);\n}\n\n#endif  // __cplusplus\n\n" +
 	"" +
 	"// --------\n\ntypedef struct {\n  wuffs_base__pixel_config pixcfg;\n\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    wuffs_base__range_ii_u64 workbuf_len;\n    uint64_t first_frame_io_position;\n    uint32_t num_loops;\n    bool first_frame_is_opaque;\n  } private_impl;\n\n#ifdef __cplusplus\n  inline void initialize(wuffs_base__pixel_format pixfmt,\n                         wuffs_base__pixel_subsampling pixsub,\n                         uint32_t width,\n                         uint32_t height,\n                         uint64_t workbuf_len0,\n                         uint64_t workbuf_len1,\n                         uint32_t num_loops,\n                         uint64_t first_frame_io_position,\n                         bool first_frame_is_opaque);\n  inline void invalidate();\n  inline bool is_valid();\n  inline wuffs_base__range_ii_u64 workbuf_len();\n  inline uint32_t num_loops();\n  inline uint64_t first_frame_io_position();\n  inline" +
 	" bool first_frame_is_opaque();\n#endif  // __cplusplus\n\n} wuffs_base__image_config;\n\n// TODO: Should this function return bool? An error type?\nstatic inline void  //\nwuffs_base__image_config__initialize(wuffs_base__image_config* c,\n                                     wuffs_base__pixel_format pixfmt,\n                                     wuffs_base__pixel_subsampling pixsub,\n                                     uint32_t width,\n                                     uint32_t height,\n                                     uint64_t workbuf_len0,\n                                     uint64_t workbuf_len1,\n                                     uint32_t num_loops,\n                                     uint64_t first_frame_io_position,\n                                     bool first_frame_is_opaque) {\n  if (!c) {\n    return;\n  }\n  if (wuffs_base__pixel_format__is_valid(pixfmt)) {\n    c->pixcfg.private_impl.pixfmt = pixfmt;\n    c->pixcfg.private_impl.pixsub = pixsub;\n    c->pixcfg.private_impl.width = width;\n    c->pixcfg.pr" +
@@ -160,10 +250,59 @@ const baseImagePublicH = "" +
 	"posal disposal) {\n  wuffs_base__frame_config__update(this, bounds, duration, index, io_position,\n                                   blend, disposal);\n}\n\ninline wuffs_base__rect_ie_u32  //\nwuffs_base__frame_config::bounds() {\n  return wuffs_base__frame_config__bounds(this);\n}\n\ninline uint32_t  //\nwuffs_base__frame_config::width() {\n  return wuffs_base__frame_config__width(this);\n}\n\ninline uint32_t  //\nwuffs_base__frame_config::height() {\n  return wuffs_base__frame_config__height(this);\n}\n\ninline wuffs_base__flicks  //\nwuffs_base__frame_config::duration() {\n  return wuffs_base__frame_config__duration(this);\n}\n\ninline uint64_t  //\nwuffs_base__frame_config::index() {\n  return wuffs_base__frame_config__index(this);\n}\n\ninline uint64_t  //\nwuffs_base__frame_config::io_position() {\n  return wuffs_base__frame_config__io_position(this);\n}\n\ninline wuffs_base__animation_blend  //\nwuffs_base__frame_config::blend() {\n  return wuffs_base__frame_config__blend(this);\n}\n\ninline wuffs_base__animation_disposal  //\nwuffs_base__fr" +
 	"ame_config::disposal() {\n  return wuffs_base__frame_config__disposal(this);\n}\n\n#endif  // __cplusplus\n\n" +
 	"" +
-	"// --------\n\ntypedef struct {\n  wuffs_base__pixel_config pixcfg;\n\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    wuffs_base__table_u8 planes[WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX];\n    // TODO: color spaces.\n  } private_impl;\n\n#ifdef __cplusplus\n  inline wuffs_base__status set_from_slice(wuffs_base__pixel_config* pixcfg,\n                                           wuffs_base__slice_u8 pixbuf_memory);\n  inline wuffs_base__slice_u8 palette();\n  inline wuffs_base__table_u8 plane(uint32_t p);\n#endif  // __cplusplus\n\n} wuffs_base__pixel_buffer;\n\nstatic inline wuffs_base__status  //\nwuffs_base__pixel_buffer__set_from_slice(wuffs_base__pixel_buffer* b,\n                                         wuffs_base__pixel_config* pixcfg,\n                                         wuffs_base__slice_u8 pixbuf_memory) {\n  if (!b) {\n    return wuffs_base__error__bad_receiver;\n  }\n  *b = ((wuffs_base__pixel_buffer){});\n  if (!pixcfg) {\n  " +
-	"  return wuffs_base__error__bad_argument;\n  }\n\n  uint8_t* ptr = pixbuf_memory.ptr;\n  uint64_t len = pixbuf_memory.len;\n  if (wuffs_base__pixel_format__is_indexed(pixcfg->private_impl.pixfmt)) {\n    // Split a 1024 byte chunk (256 palette entries × 4 bytes per entry) from\n    // the start of pixbuf_memory. We split from the start, not the end, so\n    // that the both chunks' pointers have the same alignment as the original\n    // pointer, up to an alignment of 1024.\n    if (len < 1024) {\n      return wuffs_base__error__bad_argument_length_too_short;\n    }\n    wuffs_base__table_u8* tab =\n        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];\n    tab->ptr = ptr;\n    tab->width = 1024;\n    tab->height = 1;\n    tab->stride = 1024;\n    ptr += 1024;\n    len -= 1024;\n  }\n\n  // TODO: don't assume 1 byte per pixel. Don't assume packed.\n  uint64_t wh = ((uint64_t)pixcfg->private_impl.width) *\n                ((uint64_t)pixcfg->private_impl.height);\n  if (wh > len) {\n    return wuffs_base__erro" +
-	"r__bad_argument_length_too_short;\n  }\n  b->pixcfg = *pixcfg;\n  wuffs_base__table_u8* tab = &b->private_impl.planes[0];\n  tab->ptr = ptr;\n  tab->width = pixcfg->private_impl.width;\n  tab->height = pixcfg->private_impl.height;\n  tab->stride = pixcfg->private_impl.width;\n  return NULL;\n}\n\n// wuffs_base__pixel_buffer__palette returns the palette color data. If\n// non-empty, it will have length 1024.\nstatic inline wuffs_base__slice_u8  //\nwuffs_base__pixel_buffer__palette(wuffs_base__pixel_buffer* b) {\n  if (b &&\n      wuffs_base__pixel_format__is_indexed(b->pixcfg.private_impl.pixfmt)) {\n    wuffs_base__table_u8* tab =\n        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];\n    if ((tab->width == 1024) && (tab->height == 1)) {\n      return ((wuffs_base__slice_u8){\n          .ptr = tab->ptr,\n          .len = 1024,\n      });\n    }\n  }\n  return ((wuffs_base__slice_u8){});\n}\n\nstatic inline wuffs_base__table_u8  //\nwuffs_base__pixel_buffer__plane(wuffs_base__pixel_buffer* b, uint32_t p) {\n  re" +
-	"turn (b && (p < WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX))\n             ? b->private_impl.planes[p]\n             : ((wuffs_base__table_u8){});\n}\n\n#ifdef __cplusplus\n\ninline wuffs_base__status  //\nwuffs_base__pixel_buffer::set_from_slice(wuffs_base__pixel_config* pixcfg,\n                                         wuffs_base__slice_u8 pixbuf_memory) {\n  return wuffs_base__pixel_buffer__set_from_slice(this, pixcfg, pixbuf_memory);\n}\n\ninline wuffs_base__slice_u8  //\nwuffs_base__pixel_buffer::palette() {\n  return wuffs_base__pixel_buffer__palette(this);\n}\n\ninline wuffs_base__table_u8  //\nwuffs_base__pixel_buffer::plane(uint32_t p) {\n  return wuffs_base__pixel_buffer__plane(this, p);\n}\n\n#endif  // __cplusplus\n\n" +
+	"// --------\n\ntypedef struct {\n  wuffs_base__pixel_config pixcfg;\n\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    wuffs_base__table_u8 planes[WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX];\n    // TODO: color spaces.\n  } private_impl;\n\n#ifdef __cplusplus\n  inline wuffs_base__status set_from_slice(wuffs_base__pixel_config* pixcfg,\n                                           wuffs_base__slice_u8 pixbuf_memory);\n  inline wuffs_base__status set_from_table(wuffs_base__pixel_config* pixcfg,\n                                           wuffs_base__table_u8 primary_memory,\n                                           wuffs_base__slice_u8 palette_memory);\n  inline wuffs_base__pixel_format pixel_format();\n  inline wuffs_base__slice_u8 palette();\n  inline wuffs_base__table_u8 plane(uint32_t p);\n#endif  // __cplusplus\n\n} wuffs_base__pixel_buffer;\n\nstatic inline wuffs_base__status  //\nwuffs_base__pixel_buffer__set_from_slice(wuffs_base__p" +
+	"ixel_buffer* b,\n                                         wuffs_base__pixel_config* pixcfg,\n                                         wuffs_base__slice_u8 pixbuf_memory) {\n  if (!b) {\n    return wuffs_base__error__bad_receiver;\n  }\n  *b = ((wuffs_base__pixel_buffer){});\n  if (!pixcfg) {\n    return wuffs_base__error__bad_argument;\n  }\n\n  uint8_t* ptr = pixbuf_memory.ptr;\n  uint64_t len = pixbuf_memory.len;\n  if (wuffs_base__pixel_format__is_indexed(pixcfg->private_impl.pixfmt)) {\n    // Split a 1024 byte chunk (256 palette entries × 4 bytes per entry) from\n    // the start of pixbuf_memory. We split from the start, not the end, so\n    // that the both chunks' pointers have the same alignment as the original\n    // pointer, up to an alignment of 1024.\n    if (len < 1024) {\n      return wuffs_base__error__bad_argument_length_too_short;\n    }\n    wuffs_base__table_u8* tab =\n        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];\n    tab->ptr = ptr;\n    tab->width = 1024;\n    tab->height = " +
+	"1;\n    tab->stride = 1024;\n    ptr += 1024;\n    len -= 1024;\n  }\n\n  // The rows are packed: the stride equals the width in bytes. For padded\n  // strides, use wuffs_base__pixel_buffer__set_from_table instead. Planar\n  // formats' planes are consecutive, in plane order.\n  if (wuffs_base__pixel_format__is_planar_8_bit(pixcfg->private_impl.pixfmt)) {\n    if (len < wuffs_base__pixel_config__pixbuf_len(pixcfg)) {\n      return wuffs_base__error__bad_argument_length_too_short;\n    }\n    b->pixcfg = *pixcfg;\n    uint32_t num_planes =\n        wuffs_base__pixel_format__num_planes(pixcfg->private_impl.pixfmt);\n    uint32_t p;\n    for (p = 0; p < num_planes; p++) {\n      uint32_t w = wuffs_base__pixel_subsampling__plane_width(\n          pixcfg->private_impl.pixsub, p, pixcfg->private_impl.width);\n      uint32_t h = wuffs_base__pixel_subsampling__plane_height(\n          pixcfg->private_impl.pixsub, p, pixcfg->private_impl.height);\n      wuffs_base__table_u8* tab = &b->private_impl.planes[p];\n      tab->ptr = ptr;\n      ta" +
+	"b->width = w;\n      tab->height = h;\n      tab->stride = w;\n      ptr += ((uint64_t)w) * ((uint64_t)h);\n    }\n    return NULL;\n  }\n\n  // TODO: handle fractional bytes per pixel.\n  uint32_t bits_per_pixel =\n      wuffs_base__pixel_format__bits_per_pixel(pixcfg->private_impl.pixfmt);\n  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {\n    return wuffs_base__error__unsupported_pixel_format;\n  }\n  uint64_t width_in_bytes =\n      ((uint64_t)pixcfg->private_impl.width) * (bits_per_pixel / 8);\n  if ((width_in_bytes > 0) &&\n      ((len / width_in_bytes) < ((uint64_t)pixcfg->private_impl.height))) {\n    return wuffs_base__error__bad_argument_length_too_short;\n  }\n  b->pixcfg = *pixcfg;\n  wuffs_base__table_u8* tab = &b->private_impl.planes[0];\n  tab->ptr = ptr;\n  tab->width = width_in_bytes;\n  tab->height = pixcfg->private_impl.height;\n  tab->stride = width_in_bytes;\n  return NULL;\n}\n\n// wuffs_base__pixel_buffer__set_from_table is like\n// wuffs_base__pixel_buffer__set_from_slice, but the caller provides the\n/" +
+	"/ primary plane's memory as a table, whose stride can be larger than its width\n// in bytes. For example, a GPU upload staging buffer or a shared framebuffer\n// might pad each row to a 64 byte alignment.\n//\n// The table's width, in bytes, and height must be at least the pixcfg's width\n// (multiplied by bytes per pixel) and height. Any excess is ignored.\n//\n// For indexed pixel formats, palette_memory must have length at least 1024,\n// and only its first 1024 bytes are used. For other pixel formats, it is\n// ignored and may be empty.\n//\n// TODO: support multi-plane pixel formats, such as YCbCr, taking one table per\n// plane.\nstatic inline wuffs_base__status  //\nwuffs_base__pixel_buffer__set_from_table(wuffs_base__pixel_buffer* b,\n                                         wuffs_base__pixel_config* pixcfg,\n                                         wuffs_base__table_u8 primary_memory,\n                                         wuffs_base__slice_u8 palette_memory) {\n  if (!b) {\n    return wuffs_base__error__bad_receive" +
+	"r;\n  }\n  *b = ((wuffs_base__pixel_buffer){});\n  if (!pixcfg) {\n    return wuffs_base__error__bad_argument;\n  }\n\n  if (wuffs_base__pixel_format__is_indexed(pixcfg->private_impl.pixfmt)) {\n    if (palette_memory.len < 1024) {\n      return wuffs_base__error__bad_argument_length_too_short;\n    }\n    wuffs_base__table_u8* tab =\n        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];\n    tab->ptr = palette_memory.ptr;\n    tab->width = 1024;\n    tab->height = 1;\n    tab->stride = 1024;\n  }\n\n  uint32_t bits_per_pixel =\n      wuffs_base__pixel_format__bits_per_pixel(pixcfg->private_impl.pixfmt);\n  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {\n    *b = ((wuffs_base__pixel_buffer){});\n    return wuffs_base__error__unsupported_pixel_format;\n  }\n  uint64_t width_in_bytes =\n      ((uint64_t)pixcfg->private_impl.width) * (bits_per_pixel / 8);\n  uint32_t height = pixcfg->private_impl.height;\n  if ((width_in_bytes > primary_memory.width) ||\n      (height > primary_memory.height)) {\n    *" +
+	"b = ((wuffs_base__pixel_buffer){});\n    return wuffs_base__error__bad_argument_length_too_short;\n  }\n  if ((height > 1) && (width_in_bytes > primary_memory.stride)) {\n    *b = ((wuffs_base__pixel_buffer){});\n    return wuffs_base__error__bad_argument;\n  }\n  b->pixcfg = *pixcfg;\n  wuffs_base__table_u8* tab = &b->private_impl.planes[0];\n  tab->ptr = primary_memory.ptr;\n  tab->width = width_in_bytes;\n  tab->height = height;\n  tab->stride = primary_memory.stride;\n  return NULL;\n}\n\nstatic inline wuffs_base__pixel_format  //\nwuffs_base__pixel_buffer__pixel_format(wuffs_base__pixel_buffer* b) {\n  return b ? b->pixcfg.private_impl.pixfmt : 0;\n}\n\n// wuffs_base__pixel_buffer__palette returns the palette color data. If\n// non-empty, it will have length 1024.\nstatic inline wuffs_base__slice_u8  //\nwuffs_base__pixel_buffer__palette(wuffs_base__pixel_buffer* b) {\n  if (b &&\n      wuffs_base__pixel_format__is_indexed(b->pixcfg.private_impl.pixfmt)) {\n    wuffs_base__table_u8* tab =\n        &b->private_impl.planes[WUFFS_BASE" +
+	"__PIXEL_FORMAT__INDEXED__COLOR_PLANE];\n    if ((tab->width == 1024) && (tab->height == 1)) {\n      return ((wuffs_base__slice_u8){\n          .ptr = tab->ptr,\n          .len = 1024,\n      });\n    }\n  }\n  return ((wuffs_base__slice_u8){});\n}\n\nstatic inline wuffs_base__table_u8  //\nwuffs_base__pixel_buffer__plane(wuffs_base__pixel_buffer* b, uint32_t p) {\n  return (b && (p < WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX))\n             ? b->private_impl.planes[p]\n             : ((wuffs_base__table_u8){});\n}\n\n#ifdef __cplusplus\n\ninline wuffs_base__status  //\nwuffs_base__pixel_buffer::set_from_slice(wuffs_base__pixel_config* pixcfg,\n                                         wuffs_base__slice_u8 pixbuf_memory) {\n  return wuffs_base__pixel_buffer__set_from_slice(this, pixcfg, pixbuf_memory);\n}\n\ninline wuffs_base__status  //\nwuffs_base__pixel_buffer::set_from_table(wuffs_base__pixel_config* pixcfg,\n                                         wuffs_base__table_u8 primary_memory,\n                                         wuffs_ba" +
+	"se__slice_u8 palette_memory) {\n  return wuffs_base__pixel_buffer__set_from_table(this, pixcfg, primary_memory,\n                                                  palette_memory);\n}\n\ninline wuffs_base__pixel_format  //\nwuffs_base__pixel_buffer::pixel_format() {\n  return wuffs_base__pixel_buffer__pixel_format(this);\n}\n\ninline wuffs_base__slice_u8  //\nwuffs_base__pixel_buffer::palette() {\n  return wuffs_base__pixel_buffer__palette(this);\n}\n\ninline wuffs_base__table_u8  //\nwuffs_base__pixel_buffer::plane(uint32_t p) {\n  return wuffs_base__pixel_buffer__plane(this, p);\n}\n\n#endif  // __cplusplus\n\n" +
+	"" +
+	"// --------\n\n// The wuffs_base__pixel_swizzle__indexed_to_etc functions convert rows of\n// palette-indexed pixels (1 byte per pixel) in src to direct color pixels in\n// dst, looking up each index in a 1024 byte palette of BGRA colors, such as\n// the one returned by wuffs_base__pixel_buffer__palette.\n//\n// The dst and src tables' widths are in bytes, not pixels, and their strides\n// are explicit, so that either table can be a sub-rectangle of a larger pixel\n// buffer. The number of rows converted is the minimum of the two heights. The\n// number of pixels per row is the minimum of dst's width in pixels and src's\n// width. The return value is the total number of pixels converted, which is\n// zero if the palette's length is not 1024.\n//\n// The dst pixel formats are, using Wuffs' memory order naming, BGRA (4 bytes\n// per pixel, copying the palette entry as is), RGB (3 bytes per pixel) and BGR\n// 565 (2 bytes per pixel, little-endian, what other libraries often call\n// RGB565). For the latter two, the palette's alp" +
+	"ha channel is ignored.\n//\n// The __transparent variants skip, leaving dst's pixel unchanged, any src\n// pixel whose palette entry has zero alpha. For palettes whose entries are\n// either fully opaque or fully transparent, such as those given by the GIF\n// decoder, where the transparent index's entry is transparent black, this is\n// alpha-over (src-over-dst) composition.\n//\n// The inner loops are unrolled 4 times.\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__private_indexed_to_bgra(wuffs_base__table_u8 dst,\n                                                   wuffs_base__table_u8 src,\n                                                   wuffs_base__slice_u8 palette,\n                                                   bool transparent) {\n  if (palette.len != 1024) {\n    return 0;\n  }\n  size_t w = dst.width / 4;\n  w = (w < src.width) ? w : src.width;\n  size_t h = (dst.height < src.height) ? dst.height : src.height;\n  uint8_t* p = palette.ptr;\n\n  size_t y;\n  for (y = 0; y < h; y++) {\n    uint8_t* d = dst.ptr" +
+	" + (y * dst.stride);\n    uint8_t* s = src.ptr + (y * src.stride);\n    size_t n = w;\n    for (; n >= 4; n -= 4) {\n      uint8_t* c0 = p + (4 * (size_t)s[0]);\n      uint8_t* c1 = p + (4 * (size_t)s[1]);\n      uint8_t* c2 = p + (4 * (size_t)s[2]);\n      uint8_t* c3 = p + (4 * (size_t)s[3]);\n      if (!transparent || c0[3]) {\n        memcpy(d + 0, c0, 4);\n      }\n      if (!transparent || c1[3]) {\n        memcpy(d + 4, c1, 4);\n      }\n      if (!transparent || c2[3]) {\n        memcpy(d + 8, c2, 4);\n      }\n      if (!transparent || c3[3]) {\n        memcpy(d + 12, c3, 4);\n      }\n      d += 16;\n      s += 4;\n    }\n    for (; n > 0; n--) {\n      uint8_t* c0 = p + (4 * (size_t)s[0]);\n      if (!transparent || c0[3]) {\n        memcpy(d + 0, c0, 4);\n      }\n      d += 4;\n      s += 1;\n    }\n  }\n  return ((uint64_t)w) * ((uint64_t)h);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__private_indexed_to_rgb(wuffs_base__table_u8 dst,\n                                                  wuffs_base__table_u8 src,\n     " +
+	"                                             wuffs_base__slice_u8 palette,\n                                                  bool transparent) {\n  if (palette.len != 1024) {\n    return 0;\n  }\n  size_t w = dst.width / 3;\n  w = (w < src.width) ? w : src.width;\n  size_t h = (dst.height < src.height) ? dst.height : src.height;\n  uint8_t* p = palette.ptr;\n\n  size_t y;\n  for (y = 0; y < h; y++) {\n    uint8_t* d = dst.ptr + (y * dst.stride);\n    uint8_t* s = src.ptr + (y * src.stride);\n    size_t n = w;\n    for (; n >= 4; n -= 4) {\n      uint8_t* c0 = p + (4 * (size_t)s[0]);\n      uint8_t* c1 = p + (4 * (size_t)s[1]);\n      uint8_t* c2 = p + (4 * (size_t)s[2]);\n      uint8_t* c3 = p + (4 * (size_t)s[3]);\n      if (!transparent || c0[3]) {\n        d[0] = c0[2];\n        d[1] = c0[1];\n        d[2] = c0[0];\n      }\n      if (!transparent || c1[3]) {\n        d[3] = c1[2];\n        d[4] = c1[1];\n        d[5] = c1[0];\n      }\n      if (!transparent || c2[3]) {\n        d[6] = c2[2];\n        d[7] = c2[1];\n        d[8] = c2[0]" +
+	";\n      }\n      if (!transparent || c3[3]) {\n        d[9] = c3[2];\n        d[10] = c3[1];\n        d[11] = c3[0];\n      }\n      d += 12;\n      s += 4;\n    }\n    for (; n > 0; n--) {\n      uint8_t* c0 = p + (4 * (size_t)s[0]);\n      if (!transparent || c0[3]) {\n        d[0] = c0[2];\n        d[1] = c0[1];\n        d[2] = c0[0];\n      }\n      d += 3;\n      s += 1;\n    }\n  }\n  return ((uint64_t)w) * ((uint64_t)h);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__private_indexed_to_bgr_565(\n    wuffs_base__table_u8 dst,\n    wuffs_base__table_u8 src,\n    wuffs_base__slice_u8 palette,\n    bool transparent) {\n  if (palette.len != 1024) {\n    return 0;\n  }\n  size_t w = dst.width / 2;\n  w = (w < src.width) ? w : src.width;\n  size_t h = (dst.height < src.height) ? dst.height : src.height;\n\n  // Convert the palette once, up front, instead of once per pixel. Each entry\n  // is 2 bytes of BGR 565 and 1 byte for whether the color is transparent.\n  uint8_t p[3 * 256];\n  size_t i;\n  for (i = 0; i < 256; i++) {\n    uint8" +
+	"_t* c = palette.ptr + (4 * i);\n    uint32_t b5 = c[0] >> 3;\n    uint32_t g6 = c[1] >> 2;\n    uint32_t r5 = c[2] >> 3;\n    uint32_t v = (r5 << 11) | (g6 << 5) | (b5 << 0);\n    p[(3 * i) + 0] = (uint8_t)(v >> 0);\n    p[(3 * i) + 1] = (uint8_t)(v >> 8);\n    p[(3 * i) + 2] = c[3];\n  }\n\n  size_t y;\n  for (y = 0; y < h; y++) {\n    uint8_t* d = dst.ptr + (y * dst.stride);\n    uint8_t* s = src.ptr + (y * src.stride);\n    size_t n = w;\n    for (; n >= 4; n -= 4) {\n      uint8_t* c0 = p + (3 * (size_t)s[0]);\n      uint8_t* c1 = p + (3 * (size_t)s[1]);\n      uint8_t* c2 = p + (3 * (size_t)s[2]);\n      uint8_t* c3 = p + (3 * (size_t)s[3]);\n      if (!transparent || c0[2]) {\n        memcpy(d + 0, c0, 2);\n      }\n      if (!transparent || c1[2]) {\n        memcpy(d + 2, c1, 2);\n      }\n      if (!transparent || c2[2]) {\n        memcpy(d + 4, c2, 2);\n      }\n      if (!transparent || c3[2]) {\n        memcpy(d + 6, c3, 2);\n      }\n      d += 8;\n      s += 4;\n    }\n    for (; n > 0; n--) {\n      uint8_t* c0 = p + (3 * (size_t)" +
+	"s[0]);\n      if (!transparent || c0[2]) {\n        memcpy(d + 0, c0, 2);\n      }\n      d += 2;\n      s += 1;\n    }\n  }\n  return ((uint64_t)w) * ((uint64_t)h);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__indexed_to_bgra(wuffs_base__table_u8 dst,\n                                           wuffs_base__table_u8 src,\n                                           wuffs_base__slice_u8 palette) {\n  return wuffs_base__pixel_swizzle__private_indexed_to_bgra(dst, src, palette,\n                                                            false);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__indexed_to_bgra__transparent(\n    wuffs_base__table_u8 dst,\n    wuffs_base__table_u8 src,\n    wuffs_base__slice_u8 palette) {\n  return wuffs_base__pixel_swizzle__private_indexed_to_bgra(dst, src, palette,\n                                                            true);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__indexed_to_rgb(wuffs_base__table_u8 dst,\n                                          wuffs_b" +
+	"ase__table_u8 src,\n                                          wuffs_base__slice_u8 palette) {\n  return wuffs_base__pixel_swizzle__private_indexed_to_rgb(dst, src, palette,\n                                                           false);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__indexed_to_rgb__transparent(\n    wuffs_base__table_u8 dst,\n    wuffs_base__table_u8 src,\n    wuffs_base__slice_u8 palette) {\n  return wuffs_base__pixel_swizzle__private_indexed_to_rgb(dst, src, palette,\n                                                           true);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle__indexed_to_bgr_565(wuffs_base__table_u8 dst,\n                                              wuffs_base__table_u8 src,\n                                              wuffs_base__slice_u8 palette) {\n  return wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(dst, src,\n                                                               palette, false);\n}\n\nstatic inline uint64_t  //\nwuffs_base__pixel_swizzle" +
+	"__indexed_to_bgr_565__transparent(\n    wuffs_base__table_u8 dst,\n    wuffs_base__table_u8 src,\n    wuffs_base__slice_u8 palette) {\n  return wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(dst, src,\n                                                               palette, true);\n}\n\n" +
+	"" +
+	"// --------\n\n// wuffs_base__animation_compositor composites an animated image's frames onto\n// a canvas: a BGRA pixel buffer that holds what to display. It applies each\n// frame's blend and, before drawing the next frame, each frame's disposal.\n//\n// Each frame is given as a palette-indexed pixel buffer, such as the one\n// passed to the GIF decoder's decode_frame method. Only the pixels within the\n// frame's bounds are read.\n//\n// Only a frame's bounds, not the whole canvas, are saved, cleared or restored.\n// Restoring the background means clearing to transparent black, as web\n// browsers do. For RESTORE_PREVIOUS frames, the snapshot memory needs to hold\n// 4 bytes per pixel of the frame's bounds. The canvas' width × height × 4\n// bytes is always enough, and zero bytes is enough if no frame uses\n// RESTORE_PREVIOUS.\n//\n// Compositing a frame reports a dirty rectangle, the union of the previous\n// frame's bounds (if disposing of it changed the canvas) and this frame's\n// bounds. Pixels outside of it are unch" +
+	"anged, so renderers need only repaint\n// that rectangle.\ntypedef struct {\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    wuffs_base__table_u8 canvas;\n    wuffs_base__slice_u8 snapshot;\n    wuffs_base__rect_ie_u32 pending_bounds;\n    wuffs_base__animation_disposal pending_disposal;\n  } private_impl;\n\n#ifdef __cplusplus\n  inline wuffs_base__status initialize(wuffs_base__pixel_buffer* canvas,\n                                       wuffs_base__slice_u8 snapshot_memory);\n  inline wuffs_base__status composite(wuffs_base__rect_ie_u32* dirty_rect,\n                                      wuffs_base__frame_config* fc,\n                                      wuffs_base__pixel_buffer* src);\n#endif  // __cplusplus\n\n} wuffs_base__animation_compositor;\n\n// wuffs_base__animation_compositor__initialize sets the canvas, which must be\n// BGRA (premultiplied or not), and clears it to transparent black. Call it\n// again to restart an anima" +
+	"tion from its first frame.\nstatic inline wuffs_base__status  //\nwuffs_base__animation_compositor__initialize(\n    wuffs_base__animation_compositor* c,\n    wuffs_base__pixel_buffer* canvas,\n    wuffs_base__slice_u8 snapshot_memory) {\n  if (!c) {\n    return wuffs_base__error__bad_receiver;\n  }\n  *c = ((wuffs_base__animation_compositor){});\n  if (!canvas) {\n    return wuffs_base__error__bad_argument;\n  }\n  wuffs_base__pixel_format pixfmt = canvas->pixcfg.private_impl.pixfmt;\n  if ((pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) &&\n      (pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL)) {\n    return wuffs_base__error__unsupported_pixel_format;\n  }\n\n  wuffs_base__table_u8 tab = canvas->private_impl.planes[0];\n  size_t y;\n  for (y = 0; y < tab.height; y++) {\n    memset(tab.ptr + (y * tab.stride), 0, tab.width);\n  }\n  c->private_impl.canvas = tab;\n  c->private_impl.snapshot = snapshot_memory;\n  return NULL;\n}\n\n// wuffs_base__animation_compositor__composite disposes of the previous frame\n// and then draws the n" +
+	"ext one, src, whose frame config is fc. If dirty_rect\n// is non-NULL, it is set to the canvas rectangle that has changed.\nstatic inline wuffs_base__status  //\nwuffs_base__animation_compositor__composite(wuffs_base__animation_compositor* c,\n                                            wuffs_base__rect_ie_u32* dirty_rect,\n                                            wuffs_base__frame_config* fc,\n                                            wuffs_base__pixel_buffer* src) {\n  if (!c) {\n    return wuffs_base__error__bad_receiver;\n  }\n  if (!fc || !src) {\n    return wuffs_base__error__bad_argument;\n  }\n  if (!wuffs_base__pixel_format__is_indexed(src->pixcfg.private_impl.pixfmt)) {\n    return wuffs_base__error__unsupported_pixel_format;\n  }\n  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(src);\n  wuffs_base__table_u8 src_tab = src->private_impl.planes[0];\n  wuffs_base__table_u8 dst_tab = c->private_impl.canvas;\n\n  // Clip the frame's bounds to the canvas and to src.\n  wuffs_base__rect_ie_u32 r = ((wuf" +
+	"fs_base__rect_ie_u32){\n      .min_incl_x = 0,\n      .min_incl_y = 0,\n      .max_excl_x =\n          (uint32_t)(wuffs_base__u64__min(dst_tab.width / 4, src_tab.width)),\n      .max_excl_y =\n          (uint32_t)(wuffs_base__u64__min(dst_tab.height, src_tab.height)),\n  });\n  r = wuffs_base__rect_ie_u32__intersect(&r, fc->private_impl.bounds);\n  // A frame wholly outside of the canvas, or of src, leaves r empty but with\n  // possibly min > max. Normalize it to the zero rectangle, so that neither the\n  // pointers below, the pending_bounds nor the dirty_rect refer to pixels\n  // beyond the canvas.\n  if (wuffs_base__rect_ie_u32__is_empty(&r)) {\n    r = ((wuffs_base__rect_ie_u32){});\n  }\n  size_t w = wuffs_base__rect_ie_u32__width(&r);\n  size_t h = wuffs_base__rect_ie_u32__height(&r);\n\n  wuffs_base__animation_disposal disposal = fc->private_impl.disposal;\n  if ((disposal == WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) &&\n      (c->private_impl.snapshot.len < (w * h * 4))) {\n    return wuffs_base__error__bad_argum" +
+	"ent_length_too_short;\n  }\n\n  // Dispose of the previous frame.\n  wuffs_base__rect_ie_u32 dirty = c->private_impl.pending_bounds;\n  size_t pw = wuffs_base__rect_ie_u32__width(&dirty);\n  size_t ph = wuffs_base__rect_ie_u32__height(&dirty);\n  uint8_t* d = dst_tab.ptr + (dirty.min_incl_y * dst_tab.stride) +\n               (dirty.min_incl_x * 4);\n  uint8_t* s = c->private_impl.snapshot.ptr;\n  size_t y;\n  switch (c->private_impl.pending_disposal) {\n    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_BACKGROUND:\n      for (y = 0; y < ph; y++) {\n        memset(d, 0, pw * 4);\n        d += dst_tab.stride;\n      }\n      break;\n    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS:\n      for (y = 0; y < ph; y++) {\n        memcpy(d, s, pw * 4);\n        d += dst_tab.stride;\n        s += pw * 4;\n      }\n      break;\n    default:\n      dirty = ((wuffs_base__rect_ie_u32){});\n      break;\n  }\n\n  // Save what this frame will draw over, if it needs restoring later.\n  d = dst_tab.ptr + (r.min_incl_y * dst_tab.stride) + (r.min_in" +
+	"cl_x * 4);\n  if (disposal == WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) {\n    s = c->private_impl.snapshot.ptr;\n    for (y = 0; y < h; y++) {\n      memcpy(s, d + (y * dst_tab.stride), w * 4);\n      s += w * 4;\n    }\n  }\n\n  // Draw this frame.\n  dst_tab.ptr = d;\n  dst_tab.width = w * 4;\n  dst_tab.height = h;\n  src_tab.ptr += (r.min_incl_y * src_tab.stride) + r.min_incl_x;\n  src_tab.width = w;\n  src_tab.height = h;\n  if (fc->private_impl.blend == WUFFS_BASE__ANIMATION_BLEND__SRC_OVER_DST) {\n    wuffs_base__pixel_swizzle__indexed_to_bgra__transparent(dst_tab, src_tab,\n                                                            palette);\n  } else {\n    wuffs_base__pixel_swizzle__indexed_to_bgra(dst_tab, src_tab, palette);\n  }\n\n  c->private_impl.pending_bounds = r;\n  c->private_impl.pending_disposal = disposal;\n  if (dirty_rect) {\n    *dirty_rect = wuffs_base__rect_ie_u32__unite(&dirty, r);\n  }\n  return NULL;\n}\n\n#ifdef __cplusplus\n\ninline wuffs_base__status  //\nwuffs_base__animation_compositor::initialize(\n" +
+	"    wuffs_base__pixel_buffer* canvas,\n    wuffs_base__slice_u8 snapshot_memory) {\n  return wuffs_base__animation_compositor__initialize(this, canvas,\n                                                      snapshot_memory);\n}\n\ninline wuffs_base__status  //\nwuffs_base__animation_compositor::composite(wuffs_base__rect_ie_u32* dirty_rect,\n                                            wuffs_base__frame_config* fc,\n                                            wuffs_base__pixel_buffer* src) {\n  return wuffs_base__animation_compositor__composite(this, dirty_rect, fc, src);\n}\n\n#endif  // __cplusplus\n\n" +
+	"" +
+	"// --------\n\n// wuffs_base__decode_frame_options holds optional settings for decoding a\n// frame. A zero-valued struct, or a NULL pointer, means the default settings.\n//\n// A downscale shift, k, of 1, 2 or 3 decodes a frame at 1/2, 1/4 or 1/8 scale\n// respectively, such as for a thumbnail. The frame's pixel at (x, y) is\n// written to the destination pixel buffer at (x >> k, y >> k), and every\n// other pixel is dropped. A destination pixel buffer that is ((width + (1 <<\n// k) - 1) >> k) pixels wide and ((height + (1 << k) - 1) >> k) pixels high\n// holds the whole downscaled image, where width and height are the image\n// config's.\n//\n// Reporting interlace passes means that, for interlaced frames, decoding a\n// frame suspends at the end of every interlace pass but the last, so that the\n// caller can show a coarse preview. Which rows are complete so far depends on\n// the decoder. For example, see the GIF decoder's interlace_row_stride method.\n// The caller resumes decoding by calling the same method with the sam" +
+	"e\n// arguments, as for any other suspension.\n//\n// Reporting rows means that decoding a frame suspends after every row but the\n// last, so that the caller can consume each row as soon as it is complete.\n// Decoders that support this, such as the PNG decoder, write row y to the\n// destination pixel buffer's row (y % h), where h is that pixel buffer's\n// height, so that a pixel buffer only one row high suffices. The decoder's\n// num_decoded_rows method says how many rows are complete so far. Decoders\n// that do not support this ignore it.\ntypedef struct {\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    uint32_t downscale_shift;\n    bool report_interlace_passes;\n    bool report_rows;\n  } private_impl;\n\n#ifdef __cplusplus\n  inline void initialize(uint32_t downscale_shift,\n                         bool report_interlace_passes,\n                         bool report_rows);\n  inline uint32_t downscale_shift();\n  inline bool " +
+	"report_interlace_passes();\n  inline bool report_rows();\n#endif  // __cplusplus\n\n} wuffs_base__decode_frame_options;\n\n// wuffs_base__decode_frame_options__initialize sets the options. The downscale\n// shift is clamped to be at most 3.\nstatic inline void  //\nwuffs_base__decode_frame_options__initialize(\n    wuffs_base__decode_frame_options* o,\n    uint32_t downscale_shift,\n    bool report_interlace_passes,\n    bool report_rows) {\n  if (!o) {\n    return;\n  }\n  o->private_impl.downscale_shift = wuffs_base__u32__min(downscale_shift, 3);\n  o->private_impl.report_interlace_passes = report_interlace_passes;\n  o->private_impl.report_rows = report_rows;\n}\n\nstatic inline uint32_t  //\nwuffs_base__decode_frame_options__downscale_shift(\n    wuffs_base__decode_frame_options* o) {\n  return o ? wuffs_base__u32__min(o->private_impl.downscale_shift, 3) : 0;\n}\n\nstatic inline bool  //\nwuffs_base__decode_frame_options__report_interlace_passes(\n    wuffs_base__decode_frame_options* o) {\n  return o ? o->private_impl.report_interlace" +
+	"_passes : false;\n}\n\nstatic inline bool  //\nwuffs_base__decode_frame_options__report_rows(\n    wuffs_base__decode_frame_options* o) {\n  return o ? o->private_impl.report_rows : false;\n}\n\n// wuffs_base__pixel_buffer__replicate_interlaced_rows fills in the rows that\n// an interlaced frame has not decoded yet, for displaying a coarse preview.\n// Within the bounds, each row whose y minus bounds.min_incl_y is a multiple of\n// row_stride is copied over the (row_stride - 1) rows below it.\n//\n// This overwrites those rows' pixels in place. Later interlace passes will\n// overwrite them again, except where a frame's transparent pixels are skipped\n// when decoding to a direct color (not palette-indexed) pixel buffer. For such\n// pixel buffers, replicate the rows of a copy instead.\nstatic inline void  //\nwuffs_base__pixel_buffer__replicate_interlaced_rows(\n    wuffs_base__pixel_buffer* b,\n    wuffs_base__rect_ie_u32 bounds,\n    uint32_t row_stride) {\n  if (!b || (row_stride <= 1)) {\n    return;\n  }\n  uint32_t bits_per_pix" +
+	"el =\n      wuffs_base__pixel_format__bits_per_pixel(b->pixcfg.private_impl.pixfmt);\n  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {\n    return;\n  }\n  wuffs_base__table_u8 tab = b->private_impl.planes[0];\n  wuffs_base__rect_ie_u32 r = ((wuffs_base__rect_ie_u32){\n      .min_incl_x = 0,\n      .min_incl_y = 0,\n      .max_excl_x = (uint32_t)(tab.width / (bits_per_pixel / 8)),\n      .max_excl_y = (uint32_t)(tab.height),\n  });\n  r = wuffs_base__rect_ie_u32__intersect(&r, bounds);\n  if (wuffs_base__rect_ie_u32__is_empty(&r)) {\n    return;\n  }\n  size_t n =\n      ((size_t)wuffs_base__rect_ie_u32__width(&r)) * (bits_per_pixel / 8);\n  uint8_t* p = tab.ptr + (((size_t)r.min_incl_x) * (bits_per_pixel / 8));\n  uint32_t y;\n  for (y = r.min_incl_y; y < r.max_excl_y; y++) {\n    uint32_t offset = (y - bounds.min_incl_y) % row_stride;\n    if (offset) {\n      memcpy(p + (y * tab.stride), p + ((y - offset) * tab.stride), n);\n    }\n  }\n}\n\n#ifdef __cplusplus\n\ninline void  //\nwuffs_base__decode_frame_options::initialize" +
+	"(uint32_t downscale_shift,\n                                             bool report_interlace_passes,\n                                             bool report_rows) {\n  wuffs_base__decode_frame_options__initialize(\n      this, downscale_shift, report_interlace_passes, report_rows);\n}\n\ninline uint32_t  //\nwuffs_base__decode_frame_options::downscale_shift() {\n  return wuffs_base__decode_frame_options__downscale_shift(this);\n}\n\ninline bool  //\nwuffs_base__decode_frame_options::report_interlace_passes() {\n  return wuffs_base__decode_frame_options__report_interlace_passes(this);\n}\n\ninline bool  //\nwuffs_base__decode_frame_options::report_rows() {\n  return wuffs_base__decode_frame_options__report_rows(this);\n}\n\n#endif  // __cplusplus\n\n" +
+	"" +
+	"// --------\n\n// wuffs_base__image_format identifies an image file format, as four ASCII\n// bytes in big-endian order. For example, \"PNG \" is 0x504E4720. Zero means an\n// unknown format.\ntypedef uint32_t wuffs_base__image_format;\n\n#define WUFFS_BASE__IMAGE_FORMAT__BMP 0x424D5020\n#define WUFFS_BASE__IMAGE_FORMAT__GIF 0x47494620\n#define WUFFS_BASE__IMAGE_FORMAT__JPEG 0x4A504547\n#define WUFFS_BASE__IMAGE_FORMAT__PNG 0x504E4720\n#define WUFFS_BASE__IMAGE_FORMAT__TIFF 0x54494646\n#define WUFFS_BASE__IMAGE_FORMAT__WEBP 0x57454250\n\n// WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN is the most number of bytes that\n// wuffs_base__image_format__sniff looks at.\n#define WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN 16\n\n// wuffs_base__image_format__sniff identifies an image file format from the\n// first bytes of its file. It looks at no more than\n// WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN bytes, and does not need that many to\n// recognize every format, but a prefix shorter than a format's magic number\n// cannot match that format. It returns zero if " +
+	"the prefix matches no format.\nstatic inline wuffs_base__image_format  //\nwuffs_base__image_format__sniff(wuffs_base__slice_u8 prefix) {\n  const uint8_t* p = prefix.ptr;\n  size_t n = prefix.len;\n  if (!p) {\n    return 0;\n  }\n  if ((n >= 8) && (p[0] == 0x89) && (p[1] == 'P') && (p[2] == 'N') &&\n      (p[3] == 'G') && (p[4] == 0x0D) && (p[5] == 0x0A) && (p[6] == 0x1A) &&\n      (p[7] == 0x0A)) {\n    return WUFFS_BASE__IMAGE_FORMAT__PNG;\n  }\n  if ((n >= 6) && (p[0] == 'G') && (p[1] == 'I') && (p[2] == 'F') &&\n      (p[3] == '8') && ((p[4] == '7') || (p[4] == '9')) && (p[5] == 'a')) {\n    return WUFFS_BASE__IMAGE_FORMAT__GIF;\n  }\n  if ((n >= 3) && (p[0] == 0xFF) && (p[1] == 0xD8) && (p[2] == 0xFF)) {\n    return WUFFS_BASE__IMAGE_FORMAT__JPEG;\n  }\n  if ((n >= 12) && (p[0] == 'R') && (p[1] == 'I') && (p[2] == 'F') &&\n      (p[3] == 'F') && (p[8] == 'W') && (p[9] == 'E') && (p[10] == 'B') &&\n      (p[11] == 'P')) {\n    return WUFFS_BASE__IMAGE_FORMAT__WEBP;\n  }\n  if ((n >= 4) &&\n      (((p[0] == 'I') && (p[1] == 'I') " +
+	"&& (p[2] == 0x2A) && (p[3] == 0x00)) ||\n       ((p[0] == 'M') && (p[1] == 'M') && (p[2] == 0x00) && (p[3] == 0x2A)))) {\n    return WUFFS_BASE__IMAGE_FORMAT__TIFF;\n  }\n  if ((n >= 2) && (p[0] == 'B') && (p[1] == 'M')) {\n    return WUFFS_BASE__IMAGE_FORMAT__BMP;\n  }\n  return 0;\n}\n\n" +
+	"" +
+	"// --------\n\n// wuffs_base__image_decoder__vtable holds an image decoder type's methods,\n// each taking a type-erased self pointer. Packages generate one such vtable\n// for each decoder type that has decode_image_config, decode_frame_config,\n// decode_frame and workbuf_len methods with the usual signatures.\ntypedef struct {\n  size_t sizeof_star_self;\n  wuffs_base__status (*check_wuffs_version)(void* self,\n                                            size_t sizeof_star_self,\n                                            uint64_t wuffs_version);\n  wuffs_base__status (*decode_image_config)(void* self,\n                                            wuffs_base__image_config* dst,\n                                            wuffs_base__io_reader src);\n  wuffs_base__status (*decode_frame_config)(void* self,\n                                            wuffs_base__frame_config* dst,\n                                            wuffs_base__io_reader src);\n  wuffs_base__status (*decode_frame)(void* self,\n                      " +
+	"               wuffs_base__pixel_buffer* dst,\n                                     wuffs_base__io_reader src,\n                                     wuffs_base__slice_u8 workbuf,\n                                     wuffs_base__decode_frame_options* opts);\n  wuffs_base__range_ii_u64 (*workbuf_len)(void* self);\n} wuffs_base__image_decoder__vtable;\n\n// wuffs_base__image_decoder is a format-agnostic image decoder: a decoder\n// (such as a wuffs_gif__decoder or a wuffs_png__decoder) and its vtable. Make\n// one by calling a package's upcast function, such as\n// wuffs_gif__decoder__upcast_as__wuffs_base__image_decoder, after sniffing\n// the format with wuffs_base__image_format__sniff.\n//\n// Upcasting does not allocate. The decoder memory is the caller's, and one\n// block of memory that is large enough for every decoder type that a program\n// uses (for example, a union of those types) can be re-used to decode images\n// of different formats, calling wuffs_base__image_decoder__initialize before\n// each new image.\ntypedef" +
+	" struct {\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    const wuffs_base__image_decoder__vtable* vtable;\n    void* self;\n  } private_impl;\n\n#ifdef __cplusplus\n  inline wuffs_base__status initialize();\n  inline size_t sizeof_star_self();\n  inline wuffs_base__status decode_image_config(wuffs_base__image_config* dst,\n                                                wuffs_base__io_reader src);\n  inline wuffs_base__status decode_frame_config(wuffs_base__frame_config* dst,\n                                                wuffs_base__io_reader src);\n  inline wuffs_base__status decode_frame(\n      wuffs_base__pixel_buffer* dst,\n      wuffs_base__io_reader src,\n      wuffs_base__slice_u8 workbuf,\n      wuffs_base__decode_frame_options* opts);\n  inline wuffs_base__range_ii_u64 workbuf_len();\n#endif  // __cplusplus\n\n} wuffs_base__image_decoder;\n\n// wuffs_base__image_decoder__initialize zeroes the decoder's memory and then\n// c" +
+	"alls its check_wuffs_version initializer, so that the memory can be re-used\n// for a new image, possibly of a different format than it last held.\nstatic inline wuffs_base__status  //\nwuffs_base__image_decoder__initialize(wuffs_base__image_decoder* d) {\n  if (!d || !d->private_impl.vtable || !d->private_impl.self) {\n    return wuffs_base__error__bad_receiver;\n  }\n  const wuffs_base__image_decoder__vtable* v = d->private_impl.vtable;\n  memset(d->private_impl.self, 0, v->sizeof_star_self);\n  return (*v->check_wuffs_version)(d->private_impl.self, v->sizeof_star_self,\n                                   WUFFS_VERSION);\n}\n\n// wuffs_base__image_decoder__sizeof_star_self returns the size of the\n// underlying decoder, or zero if there is none.\nstatic inline size_t  //\nwuffs_base__image_decoder__sizeof_star_self(wuffs_base__image_decoder* d) {\n  return (d && d->private_impl.vtable)\n             ? d->private_impl.vtable->sizeof_star_self\n             : 0;\n}\n\nstatic inline wuffs_base__status  //\nwuffs_base__image_decoder_" +
+	"_decode_image_config(wuffs_base__image_decoder* d,\n                                               wuffs_base__image_config* dst,\n                                               wuffs_base__io_reader src) {\n  if (!d || !d->private_impl.vtable) {\n    return wuffs_base__error__bad_receiver;\n  }\n  return (*d->private_impl.vtable->decode_image_config)(d->private_impl.self,\n                                                        dst, src);\n}\n\nstatic inline wuffs_base__status  //\nwuffs_base__image_decoder__decode_frame_config(wuffs_base__image_decoder* d,\n                                               wuffs_base__frame_config* dst,\n                                               wuffs_base__io_reader src) {\n  if (!d || !d->private_impl.vtable) {\n    return wuffs_base__error__bad_receiver;\n  }\n  return (*d->private_impl.vtable->decode_frame_config)(d->private_impl.self,\n                                                        dst, src);\n}\n\nstatic inline wuffs_base__status  //\nwuffs_base__image_decoder__decode_frame(\n   " +
+	" wuffs_base__image_decoder* d,\n    wuffs_base__pixel_buffer* dst,\n    wuffs_base__io_reader src,\n    wuffs_base__slice_u8 workbuf,\n    wuffs_base__decode_frame_options* opts) {\n  if (!d || !d->private_impl.vtable) {\n    return wuffs_base__error__bad_receiver;\n  }\n  return (*d->private_impl.vtable->decode_frame)(d->private_impl.self, dst, src,\n                                                 workbuf, opts);\n}\n\nstatic inline wuffs_base__range_ii_u64  //\nwuffs_base__image_decoder__workbuf_len(wuffs_base__image_decoder* d) {\n  if (!d || !d->private_impl.vtable) {\n    return ((wuffs_base__range_ii_u64){});\n  }\n  return (*d->private_impl.vtable->workbuf_len)(d->private_impl.self);\n}\n\n#ifdef __cplusplus\n\ninline wuffs_base__status  //\nwuffs_base__image_decoder::initialize() {\n  return wuffs_base__image_decoder__initialize(this);\n}\n\ninline size_t  //\nwuffs_base__image_decoder::sizeof_star_self() {\n  return wuffs_base__image_decoder__sizeof_star_self(this);\n}\n\ninline wuffs_base__status  //\nwuffs_base__image_decoder::de" +
+	"code_image_config(wuffs_base__image_config* dst,\n                                               wuffs_base__io_reader src) {\n  return wuffs_base__image_decoder__decode_image_config(this, dst, src);\n}\n\ninline wuffs_base__status  //\nwuffs_base__image_decoder::decode_frame_config(wuffs_base__frame_config* dst,\n                                               wuffs_base__io_reader src) {\n  return wuffs_base__image_decoder__decode_frame_config(this, dst, src);\n}\n\ninline wuffs_base__status  //\nwuffs_base__image_decoder::decode_frame(\n    wuffs_base__pixel_buffer* dst,\n    wuffs_base__io_reader src,\n    wuffs_base__slice_u8 workbuf,\n    wuffs_base__decode_frame_options* opts) {\n  return wuffs_base__image_decoder__decode_frame(this, dst, src, workbuf, opts);\n}\n\ninline wuffs_base__range_ii_u64  //\nwuffs_base__image_decoder::workbuf_len() {\n  return wuffs_base__image_decoder__workbuf_len(this);\n}\n\n#endif  // __cplusplus\n\n" +
 	"" +
-	"// --------\n\ntypedef struct {\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    uint8_t TODO;\n  } private_impl;\n\n#ifdef __cplusplus\n#endif  // __cplusplus\n\n} wuffs_base__decode_frame_options;\n\n#ifdef __cplusplus\n\n#endif  // __cplusplus\n\n#ifdef __cplusplus\n}  // extern \"C\"\n#endif\n" +
+	"// --------\n\n// wuffs_base__resampler_filter is the filter that a wuffs_base__resampler\n// scales with:\n//  - Box averages the source pixels that each destination pixel covers. It is\n//    the fastest filter, and is nearest neighbor when scaling up.\n//  - Bilinear is a triangle (tent) filter.\n//  - Lanczos3 is a windowed sinc filter with 3 lobes. It is the sharpest\n//    filter, but its negative lobes can cause ringing near hard edges.\n//\n// When scaling down, each filter is widened by the scale factor, so that\n// every source pixel contributes to the result.\ntypedef uint8_t wuffs_base__resampler_filter;\n\n#define WUFFS_BASE__RESAMPLER_FILTER__BOX ((wuffs_base__resampler_filter)1)\n#define WUFFS_BASE__RESAMPLER_FILTER__BILINEAR ((wuffs_base__resampler_filter)2)\n#define WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3 ((wuffs_base__resampler_filter)3)\n\n// wuffs_base__resampler scales an image to a destination pixel buffer, a\n// source row at a time, so that it can consume rows as a decoder produces\n// them, without a full" +
+	" size intermediate image. For example, the PNG\n// decoder's report_rows option decodes into a pixel buffer only one row high.\n//\n// The source and destination pixel format must be the same: BGRA or RGBA\n// (premultiplied or not), or BGRX or RGBX. Non-premultiplied pixels are\n// premultiplied before filtering, and un-premultiplied afterwards, so that\n// the color of transparent pixels does not bleed into their neighbors.\n//\n// Scaling is separable. Each destination row is a vertical pass, over a ring\n// of the most recent source rows, followed by a horizontal pass. The ring and\n// the per-row and per-column filter weights, 14 bit fixed point, live in a\n// caller-supplied work buffer, so that a resampler never allocates memory.\n// The weights depend only on the filter and the source and destination\n// sizes, so re-initializing with the same sizes and work buffer (for example,\n// for thumbnailing many same-sized images) re-uses them instead of\n// re-computing them. Callers that re-use a work buffer like this mus" +
+	"t not\n// modify its contents in between.\n//\n// When WUFFS_BASE__HAVE_SSE2 is defined, both passes process 4 pixels (16\n// bytes) at a time in SIMD registers.\ntypedef struct {\n  // Do not access the private_impl's fields directly. There is no API/ABI\n  // compatibility or safety guarantee if you do so.\n  struct {\n    uint32_t magic;\n    wuffs_base__resampler_filter filter;\n    wuffs_base__pixel_format pixfmt;\n    uint32_t src_width;\n    uint32_t src_height;\n    uint32_t dst_width;\n    uint32_t dst_height;\n    wuffs_base__table_u8 dst;\n    wuffs_base__slice_u8 workbuf;\n\n    uint32_t x_taps;\n    uint32_t y_taps;\n    uint32_t* x_spans;\n    uint32_t* y_spans;\n    int16_t* x_weights;\n    int16_t* y_weights;\n    uint8_t** y_rows;\n    uint8_t* vrow;\n    uint8_t* ring;\n    size_t ring_stride;\n\n    uint32_t num_src_rows;\n    uint32_t num_dst_rows;\n  } private_impl;\n\n#ifdef __cplusplus\n  inline wuffs_base__status initialize(wuffs_base__resampler_filter filter,\n                                       uint32_t src_width,\n " +
+	"                                      uint32_t src_height,\n                                       wuffs_base__pixel_buffer* dst,\n                                       wuffs_base__slice_u8 workbuf);\n  inline wuffs_base__status consume_row(wuffs_base__slice_u8 src_row);\n  inline wuffs_base__status resample(wuffs_base__pixel_buffer* src);\n  inline uint32_t num_dst_rows();\n#endif  // __cplusplus\n\n} wuffs_base__resampler;\n\n// wuffs_base__resampler__workbuf_len returns the work buffer length needed to\n// scale a src_width × src_height image to dst_width × dst_height, or zero if\n// the filter is invalid or a dimension is zero or more than 0xFFFFFF.\nWUFFS_BASE__MAYBE_STATIC uint64_t  //\nwuffs_base__resampler__workbuf_len(wuffs_base__resampler_filter filter,\n                                   uint32_t src_width,\n                                   uint32_t src_height,\n                                   uint32_t dst_width,\n                                   uint32_t dst_height);\n\n// wuffs_base__resampler__initialize " +
+	"prepares to scale a src_width ×\n// src_height image, in dst's pixel format, to fill dst. The resampler should\n// be zeroed before it is first initialized. Call it again to start another\n// image. The workbuf needs no particular alignment, but its length must be at\n// least wuffs_base__resampler__workbuf_len, and its contents must be left\n// alone while the resampler uses it.\nWUFFS_BASE__MAYBE_STATIC wuffs_base__status  //\nwuffs_base__resampler__initialize(wuffs_base__resampler* r,\n                                  wuffs_base__resampler_filter filter,\n                                  uint32_t src_width,\n                                  uint32_t src_height,\n                                  wuffs_base__pixel_buffer* dst,\n                                  wuffs_base__slice_u8 workbuf);\n\n// wuffs_base__resampler__consume_row takes the next source row, whose first\n// (src_width × 4) bytes are its pixels, and writes every destination row that\n// it completes. The source row's memory can be re-used as soon as th" +
+	"is\n// returns.\nWUFFS_BASE__MAYBE_STATIC wuffs_base__status  //\nwuffs_base__resampler__consume_row(wuffs_base__resampler* r,\n                                   wuffs_base__slice_u8 src_row);\n\n// wuffs_base__resampler__resample consumes every row of src, which must have\n// the source width, height and pixel format, at once.\nWUFFS_BASE__MAYBE_STATIC wuffs_base__status  //\nwuffs_base__resampler__resample(wuffs_base__resampler* r,\n                                wuffs_base__pixel_buffer* src);\n\n// wuffs_base__resampler__num_dst_rows returns the number of destination rows\n// written so far. They are the rows at the top of the destination.\nstatic inline uint32_t  //\nwuffs_base__resampler__num_dst_rows(wuffs_base__resampler* r) {\n  return r ? r->private_impl.num_dst_rows : 0;\n}\n\n#ifdef __cplusplus\n\ninline wuffs_base__status  //\nwuffs_base__resampler::initialize(wuffs_base__resampler_filter filter,\n                                  uint32_t src_width,\n                                  uint32_t src_height,\n            " +
+	"                      wuffs_base__pixel_buffer* dst,\n                                  wuffs_base__slice_u8 workbuf) {\n  return wuffs_base__resampler__initialize(this, filter, src_width, src_height,\n                                           dst, workbuf);\n}\n\ninline wuffs_base__status  //\nwuffs_base__resampler::consume_row(wuffs_base__slice_u8 src_row) {\n  return wuffs_base__resampler__consume_row(this, src_row);\n}\n\ninline wuffs_base__status  //\nwuffs_base__resampler::resample(wuffs_base__pixel_buffer* src) {\n  return wuffs_base__resampler__resample(this, src);\n}\n\ninline uint32_t  //\nwuffs_base__resampler::num_dst_rows() {\n  return wuffs_base__resampler__num_dst_rows(this);\n}\n\n#endif  // __cplusplus\n\n#ifdef __cplusplus\n}  // extern \"C\"\n#endif\n" +
 	""
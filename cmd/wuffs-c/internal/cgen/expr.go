@@ -46,6 +46,12 @@ func (g *gen) writeExpr(b *buffer, n *a.Expr, rp replacementPolicy, depth uint32
 	if cv := n.ConstValue(); cv != nil {
 		if typ := n.MType(); typ.IsNumTypeOrIdeal() {
 			b.writes(cv.String())
+			// A decimal literal that does not fit in an int64_t needs a
+			// suffix, otherwise C compilers warn that it is so large that it
+			// is unsigned.
+			if cv.BitLen() > 63 {
+				b.writes("u")
+			}
 		} else if typ.IsNullptr() {
 			b.writes("NULL")
 		} else if cv.Cmp(zero) == 0 {
@@ -206,6 +206,8 @@ func (g *gen) writeOutParamZeroValue(b *buffer, typ *a.TypeExpr) error {
 		// TODO: "return ((wuffs_base__empty_struct){})".
 	} else if typ.IsNumType() {
 		b.writes("0")
+	} else if typ.IsBool() {
+		b.writes("false")
 	} else {
 		b.writes("((")
 		if err := g.writeCTypeName(b, typ, "", ""); err != nil {
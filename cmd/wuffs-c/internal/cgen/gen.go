@@ -76,6 +76,7 @@ func genBase(out *bytes.Buffer) error {
 		{"base/base-public.h", "baseBasePublicH"},
 		{"base/base-private.h", "baseBasePrivateH"},
 		{"base/base-impl.c", "baseBaseImplC"},
+		{"base/image-impl.c", "baseImageImplC"},
 		{"base/image-public.h", "baseImagePublicH"},
 	}
 
@@ -0,0 +1,142 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package cgen
+
+import (
+	a "github.com/google/wuffs/lang/ast"
+)
+
+// imageDecoderMethods are the methods, and their C++ signatures (as written by
+// writeFuncSignature with cppInsideStruct), of the wuffs_base__image_decoder
+// interface. A struct with all of these public methods is upcastable to that
+// interface. The order matches wuffs_base__image_decoder__vtable's fields.
+var imageDecoderMethods = []struct {
+	name      string
+	signature string
+}{{
+	"decode_image_config",
+	"inline wuffs_base__status decode_image_config(" +
+		"wuffs_base__image_config* a_dst,wuffs_base__io_reader a_src)",
+}, {
+	"decode_frame_config",
+	"inline wuffs_base__status decode_frame_config(" +
+		"wuffs_base__frame_config* a_dst,wuffs_base__io_reader a_src)",
+}, {
+	"decode_frame",
+	"inline wuffs_base__status decode_frame(" +
+		"wuffs_base__pixel_buffer* a_dst,wuffs_base__io_reader a_src," +
+		"wuffs_base__slice_u8 a_workbuf,wuffs_base__decode_frame_options* a_opts)",
+}, {
+	"workbuf_len",
+	"inline wuffs_base__range_ii_u64 workbuf_len()",
+}}
+
+// isImageDecoder returns whether n is a public struct whose public methods
+// implement the wuffs_base__image_decoder interface.
+func (g *gen) isImageDecoder(n *a.Struct) (bool, error) {
+	if !n.Public() || !n.Classy() {
+		return false, nil
+	}
+	structID := n.QID()[1]
+	found := 0
+	for _, m := range imageDecoderMethods {
+		for _, file := range g.files {
+			for _, tld := range file.TopLevelDecls() {
+				if (tld.Kind() != a.KFunc) || (tld.AsRaw().Flags()&a.FlagsPublic == 0) {
+					continue
+				}
+				f := tld.AsFunc()
+				if (f.QQID()[1] != structID) || (f.FuncName().Str(g.tm) != m.name) {
+					continue
+				}
+				sig := buffer(nil)
+				if err := g.writeFuncSignature(&sig, f, cppInsideStruct); err != nil {
+					return false, err
+				}
+				if string(sig) != m.signature {
+					return false, nil
+				}
+				found++
+			}
+		}
+	}
+	return found == len(imageDecoderMethods), nil
+}
+
+func (g *gen) writeUpcastPrototypes(b *buffer) error {
+	for _, n := range g.structList {
+		if ok, err := g.isImageDecoder(n); err != nil {
+			return err
+		} else if !ok {
+			continue
+		}
+		structName := g.pkgPrefix + n.QID().Str(g.tm)
+		b.printf("// %s__upcast_as__wuffs_base__image_decoder returns a\n", structName)
+		b.printf("// wuffs_base__image_decoder whose methods call self's methods.\n")
+		b.printf("WUFFS_BASE__MAYBE_STATIC wuffs_base__image_decoder //\n"+
+			"%s__upcast_as__wuffs_base__image_decoder(%s *self);\n\n", structName, structName)
+	}
+	return nil
+}
+
+func (g *gen) writeUpcastImpls(b *buffer) error {
+	for _, n := range g.structList {
+		if ok, err := g.isImageDecoder(n); err != nil {
+			return err
+		} else if !ok {
+			continue
+		}
+		structName := g.pkgPrefix + n.QID().Str(g.tm)
+		prefix := structName + "__image_decoder__"
+
+		b.printf("static wuffs_base__status //\n"+
+			"%scheck_wuffs_version(void *self, size_t sizeof_star_self, uint64_t wuffs_version) {\n"+
+			"return %s__check_wuffs_version((%s*)(self), sizeof_star_self, wuffs_version);\n}\n\n",
+			prefix, structName, structName)
+		b.printf("static wuffs_base__status //\n"+
+			"%sdecode_image_config(void *self, wuffs_base__image_config* a_dst, wuffs_base__io_reader a_src) {\n"+
+			"return %s__decode_image_config((%s*)(self), a_dst, a_src);\n}\n\n",
+			prefix, structName, structName)
+		b.printf("static wuffs_base__status //\n"+
+			"%sdecode_frame_config(void *self, wuffs_base__frame_config* a_dst, wuffs_base__io_reader a_src) {\n"+
+			"return %s__decode_frame_config((%s*)(self), a_dst, a_src);\n}\n\n",
+			prefix, structName, structName)
+		b.printf("static wuffs_base__status //\n"+
+			"%sdecode_frame(void *self, wuffs_base__pixel_buffer* a_dst, wuffs_base__io_reader a_src, "+
+			"wuffs_base__slice_u8 a_workbuf, wuffs_base__decode_frame_options* a_opts) {\n"+
+			"return %s__decode_frame((%s*)(self), a_dst, a_src, a_workbuf, a_opts);\n}\n\n",
+			prefix, structName, structName)
+		b.printf("static wuffs_base__range_ii_u64 //\n"+
+			"%sworkbuf_len(void *self) {\n"+
+			"return %s__workbuf_len((%s*)(self));\n}\n\n",
+			prefix, structName, structName)
+
+		b.printf("static const wuffs_base__image_decoder__vtable %svtable = {\n", prefix)
+		b.printf(".sizeof_star_self = sizeof(%s),\n", structName)
+		b.printf(".check_wuffs_version = &%scheck_wuffs_version,\n", prefix)
+		for _, m := range imageDecoderMethods {
+			b.printf(".%s = &%s%s,\n", m.name, prefix, m.name)
+		}
+		b.writes("};\n\n")
+
+		b.printf("WUFFS_BASE__MAYBE_STATIC wuffs_base__image_decoder //\n"+
+			"%s__upcast_as__wuffs_base__image_decoder(%s *self) {\n", structName, structName)
+		b.writes("wuffs_base__image_decoder ret;\n")
+		b.printf("ret.private_impl.vtable = self ? &%svtable : NULL;\n", prefix)
+		b.writes("ret.private_impl.self = self;\n")
+		b.writes("return ret;\n}\n\n")
+	}
+	return nil
+}
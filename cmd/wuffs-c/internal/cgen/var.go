@@ -85,9 +85,15 @@ func (g *gen) writeLoadDerivedVar(b *buffer, hack string, prefix string, name t.
 	if name.Str(g.tm) == "dummy" {
 		name = g.tm.ByName("src")
 	}
-	// TODO: also remove this hack.
-	if hack == "w" {
-		b.printf("%s%sw = %sw.data.ptr + %sw.meta.wi;\n", iopPrefix, vPrefix, uPrefix, uPrefix)
+	// TODO: also remove this hack. A non-empty hack is the name of a local
+	// I/O variable, whose io_buffer is the u_etc variable.
+	if hack != "" {
+		i := "ri"
+		if typ.QID()[1] == t.IDIOWriter {
+			i = "wi"
+		}
+		b.printf("%s%s%s = %s%s.data.ptr + %s%s.meta.%s;\n",
+			iopPrefix, vPrefix, hack, uPrefix, hack, uPrefix, hack, i)
 		return nil
 	}
 
@@ -147,9 +153,14 @@ func (g *gen) writeSaveDerivedVar(b *buffer, hack string, prefix string, name t.
 	if name.Str(g.tm) == "dummy" {
 		name = g.tm.ByName("src")
 	}
-	// TODO: also remove this hack.
-	if hack == "w" {
-		b.printf("%sw.meta.wi = %s%sw - %sw.data.ptr;\n", uPrefix, iopPrefix, vPrefix, uPrefix)
+	// TODO: also remove this hack. See writeLoadDerivedVar.
+	if hack != "" {
+		i := "ri"
+		if typ.QID()[1] == t.IDIOWriter {
+			i = "wi"
+		}
+		b.printf("%s%s.meta.%s = %s%s%s - %s%s.data.ptr;\n",
+			uPrefix, hack, i, iopPrefix, vPrefix, hack, uPrefix, hack)
 		return nil
 	}
 
@@ -177,9 +188,8 @@ func (g *gen) writeSaveDerivedVar(b *buffer, hack string, prefix string, name t.
 }
 
 func (g *gen) writeLoadExprDerivedVars(b *buffer, n *a.Expr) error {
-	if g.currFunk.derivedVars == nil {
-		return nil
-	}
+	// Local I/O variables (the "hack" below) are synced even when there are
+	// no derived args.dst or args.src variables.
 	if k := n.Operator(); k != t.IDOpenParen && k != t.IDTry {
 		return nil
 	}
@@ -188,11 +198,11 @@ func (g *gen) writeLoadExprDerivedVars(b *buffer, n *a.Expr) error {
 		prefix := aPrefix
 		// TODO: don't hard-code these.
 		hack := ""
-		if s := o.Value().Str(g.tm); s != "args.dst" && s != "args.src" && s != "w" {
-			continue
-		} else if s == "w" {
+		if v := o.Value(); (v.Operator() == 0) && v.MType().IsIOType() {
 			prefix = vPrefix
-			hack = "w"
+			hack = v.Ident().Str(g.tm)
+		} else if s := v.Str(g.tm); s != "args.dst" && s != "args.src" {
+			continue
 		}
 		if err := g.writeLoadDerivedVar(b, hack, prefix, o.Name(), o.Value().MType(), false); err != nil {
 			return err
@@ -202,9 +212,8 @@ func (g *gen) writeLoadExprDerivedVars(b *buffer, n *a.Expr) error {
 }
 
 func (g *gen) writeSaveExprDerivedVars(b *buffer, n *a.Expr) error {
-	if g.currFunk.derivedVars == nil {
-		return nil
-	}
+	// Local I/O variables (the "hack" below) are synced even when there are
+	// no derived args.dst or args.src variables.
 	if k := n.Operator(); k != t.IDOpenParen && k != t.IDTry {
 		return nil
 	}
@@ -213,11 +222,11 @@ func (g *gen) writeSaveExprDerivedVars(b *buffer, n *a.Expr) error {
 		prefix := aPrefix
 		// TODO: don't hard-code these.
 		hack := ""
-		if s := o.Value().Str(g.tm); s != "args.dst" && s != "args.src" && s != "w" {
-			continue
-		} else if s == "w" {
+		if v := o.Value(); (v.Operator() == 0) && v.MType().IsIOType() {
 			prefix = vPrefix
-			hack = "w"
+			hack = v.Ident().Str(g.tm)
+		} else if s := v.Str(g.tm); s != "args.dst" && s != "args.src" {
+			continue
 		}
 		if err := g.writeSaveDerivedVar(b, hack, prefix, o.Name(), o.Value().MType()); err != nil {
 			return err
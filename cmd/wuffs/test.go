@@ -157,7 +157,9 @@ type testHelper struct {
 
 func (h *testHelper) benchTest(dirname string, recursive bool) (failed bool, err error) {
 	if dirname == "base" {
-		return false, nil
+		// The base package has no .wuffs files, but it has its own tests, in
+		// test/c/base.c, of its hand-written C code.
+		return h.benchTestDir(dirname)
 	}
 	qualFilenames, dirnames, err := listDir(
 		filepath.Join(h.wuffsRoot, filepath.FromSlash(dirname)), ".wuffs", recursive)
@@ -0,0 +1,523 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+gifparallel decodes the animated GIF image read from stdin twice, once with a
+single decoder and once with multiple threads, and prints how long each took.
+To decode the galloping horse animation with 8 threads, run:
+
+$CC -O3 -pthread gifparallel.c && ./a.out -threads=8 < \
+    ../../test/data/gifplayer-muybridge.gif; rm -f a.out
+
+for a C compiler $CC, such as clang or gcc.
+
+Each GIF frame's LZW-compressed data is self-contained, so once a first pass
+has scanned every frame's config (including its I/O position), frames can be
+decompressed concurrently, by separate decoders that are restarted at those
+positions. Compositing each frame onto the canvas depends on the previous
+frames, so it remains a single, sequential pass, run on the main thread while
+the worker threads decompress the next batch of frames.
+
+Both passes composite every frame, and print a checksum of every frame's
+canvas, which should match.
+*/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../release/c/wuffs-unsupported-snapshot.h"
+
+// Limit the input GIF image to (64 MiB - 1 byte) compressed and 4096 × 4096
+// pixels uncompressed. This is a limitation of this example program (which
+// uses the Wuffs standard library), not a limitation of Wuffs per se.
+#define SRC_BUFFER_SIZE (64 * 1024 * 1024)
+#define MAX_DIMENSION (4096)
+
+#define MAX_THREADS 64
+
+// FRAMES_PER_THREAD is how many frames each thread decodes per batch. Each
+// batch's frames need their own canvas-sized pixel buffers, and there are two
+// batches in flight: one being decoded and one being composited.
+#define FRAMES_PER_THREAD 4
+
+uint8_t src_buffer[SRC_BUFFER_SIZE] = {0};
+size_t src_len = 0;
+
+int num_threads = 8;
+
+wuffs_base__image_config ic = ((wuffs_base__image_config){});
+wuffs_base__frame_config* frame_configs = NULL;
+size_t num_frames = 0;
+
+wuffs_base__slice_u8 canvas_buffer = ((wuffs_base__slice_u8){});
+wuffs_base__slice_u8 snapshot_buffer = ((wuffs_base__slice_u8){});
+wuffs_base__pixel_buffer canvas = ((wuffs_base__pixel_buffer){});
+
+// ignore_return_value suppresses errors from -Wall -Werror.
+static void ignore_return_value(int ignored) {}
+
+static inline uint32_t load_u32le(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 16) | ((uint32_t)(p[3]) << 24);
+}
+
+const char* read_stdin() {
+  while (src_len < SRC_BUFFER_SIZE) {
+    const int stdin_fd = 0;
+    ssize_t n = read(stdin_fd, src_buffer + src_len, SRC_BUFFER_SIZE - src_len);
+    if (n > 0) {
+      src_len += n;
+    } else if (n == 0) {
+      return NULL;
+    } else if (errno == EINTR) {
+      // No-op.
+    } else {
+      return strerror(errno);
+    }
+  }
+  return "input is too large";
+}
+
+uint64_t micros_now() {
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return ((uint64_t)(now.tv_sec) * 1000000) + (now.tv_nsec / 1000);
+}
+
+wuffs_base__io_buffer make_src() {
+  return ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = src_buffer,
+          .len = src_len,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = src_len,
+          .ri = 0,
+          .pos = 0,
+          .closed = true,
+      }),
+  });
+}
+
+// new_decoder returns a decoder that has decoded the image config, ready for
+// decoding frame configs or for restarting at a frame.
+const char* new_decoder(wuffs_gif__decoder** dec,
+                        wuffs_base__io_buffer* src,
+                        wuffs_base__image_config* ic) {
+  *dec = calloc(1, sizeof(wuffs_gif__decoder));
+  if (!*dec) {
+    return "could not allocate decoder";
+  }
+  wuffs_base__status z = wuffs_gif__decoder__check_wuffs_version(
+      *dec, sizeof(wuffs_gif__decoder), WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  return wuffs_gif__decoder__decode_image_config(
+      *dec, ic, wuffs_base__io_buffer__reader(src));
+}
+
+// ----
+
+// checksum_canvas folds the canvas' dirty rectangle, 4 bytes (one pixel) at a
+// time, into a running FNV-1a style checksum. It stands in for what a
+// transcoder would do with each composited frame, such as encoding the changed
+// pixels in another file format.
+uint32_t checksum_canvas(uint32_t checksum, wuffs_base__rect_ie_u32 r) {
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(&canvas, 0);
+  size_t y;
+  for (y = r.min_incl_y; y < r.max_excl_y; y++) {
+    uint8_t* p = tab.ptr + (y * tab.stride) + (4 * r.min_incl_x);
+    size_t x;
+    for (x = r.min_incl_x; x < r.max_excl_x; x++) {
+      checksum = (checksum ^ load_u32le(p)) * 16777619;
+      p += 4;
+    }
+  }
+  return checksum;
+}
+
+// A frame_slot holds one frame's palette-indexed pixels, decoded by a worker
+// thread and then composited by the main thread.
+typedef struct {
+  wuffs_base__slice_u8 pixbuf;
+  wuffs_base__pixel_buffer pb;
+} frame_slot;
+
+// A worker decodes every num_threads'th frame of a batch into the batch's
+// frame slots, starting at the batch's first_frame plus the worker's id.
+typedef struct {
+  int id;
+  pthread_t thread;
+  wuffs_gif__decoder* dec;
+  wuffs_base__io_buffer src;
+  wuffs_base__slice_u8 workbuf;
+
+  frame_slot* slots;
+  size_t first_frame;
+  size_t num_batch_frames;
+  const char* msg;
+} worker;
+
+worker workers[MAX_THREADS] = {0};
+frame_slot* slots = NULL;
+size_t num_slots = 0;
+
+void* work(void* arg) {
+  worker* w = (worker*)arg;
+  w->msg = NULL;
+  size_t i;
+  for (i = w->id; i < w->num_batch_frames; i += num_threads) {
+    wuffs_base__frame_config* fc = &frame_configs[w->first_frame + i];
+    uint64_t io_position = wuffs_base__frame_config__io_position(fc);
+    wuffs_base__status z = wuffs_gif__decoder__restart_frame(
+        w->dec, wuffs_base__frame_config__index(fc), io_position);
+    if (z) {
+      w->msg = z;
+      break;
+    }
+    w->src.meta.ri = io_position;
+    z = wuffs_gif__decoder__decode_frame(w->dec, &w->slots[i].pb,
+                                         wuffs_base__io_buffer__reader(&w->src),
+                                         w->workbuf, NULL);
+    if (z) {
+      w->msg = z;
+      break;
+    }
+  }
+  return NULL;
+}
+
+const char* start_batch(frame_slot* batch_slots, size_t first_frame) {
+  size_t n = num_frames - first_frame;
+  if (n > (num_slots / 2)) {
+    n = num_slots / 2;
+  }
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    workers[t].slots = batch_slots;
+    workers[t].first_frame = first_frame;
+    workers[t].num_batch_frames = n;
+    if (pthread_create(&workers[t].thread, NULL, work, &workers[t])) {
+      return "could not create thread";
+    }
+  }
+  return NULL;
+}
+
+const char* finish_batch() {
+  const char* msg = NULL;
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    if (pthread_join(workers[t].thread, NULL)) {
+      msg = "could not join thread";
+    } else if (workers[t].msg && !msg) {
+      msg = workers[t].msg;
+    }
+  }
+  return msg;
+}
+
+// ----
+
+const char* scan() {
+  wuffs_base__io_buffer src = make_src();
+  wuffs_gif__decoder* dec = NULL;
+  const char* msg = new_decoder(&dec, &src, &ic);
+  if (msg) {
+    free(dec);
+    return msg;
+  }
+  if (!wuffs_base__image_config__is_valid(&ic)) {
+    free(dec);
+    return "invalid image configuration";
+  }
+
+  size_t cap = 0;
+  while (true) {
+    if (num_frames == cap) {
+      cap = cap ? (2 * cap) : 64;
+      wuffs_base__frame_config* p =
+          realloc(frame_configs, cap * sizeof(wuffs_base__frame_config));
+      if (!p) {
+        msg = "could not allocate frame configs";
+        break;
+      }
+      frame_configs = p;
+    }
+    wuffs_base__frame_config* fc = &frame_configs[num_frames];
+    *fc = ((wuffs_base__frame_config){});
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+    wuffs_base__status z =
+        wuffs_gif__decoder__decode_frame_config(dec, fc, src_reader);
+    if (z) {
+      if (z != wuffs_base__warning__end_of_data) {
+        msg = z;
+      }
+      break;
+    }
+    z = wuffs_gif__decoder__skip_frame(dec, src_reader);
+    if (z) {
+      msg = z;
+      break;
+    }
+    num_frames++;
+  }
+  free(dec);
+  return msg;
+}
+
+const char* allocate() {
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  if ((width > MAX_DIMENSION) || (height > MAX_DIMENSION)) {
+    return "image dimensions are too large";
+  }
+  uint64_t num_pixels = ((uint64_t)width) * ((uint64_t)height);
+
+  wuffs_base__pixel_config canvas_pixcfg = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&canvas_pixcfg,
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, width, height);
+  canvas_buffer = wuffs_base__malloc_slice_u8(malloc, 4 * num_pixels);
+  snapshot_buffer = wuffs_base__malloc_slice_u8(malloc, 4 * num_pixels);
+  if (!canvas_buffer.ptr || !snapshot_buffer.ptr) {
+    return "could not allocate canvas";
+  }
+  wuffs_base__status z = wuffs_base__pixel_buffer__set_from_slice(
+      &canvas, &canvas_pixcfg, canvas_buffer);
+  if (z) {
+    return z;
+  }
+
+  num_slots = 2 * FRAMES_PER_THREAD * num_threads;
+  slots = calloc(num_slots, sizeof(frame_slot));
+  if (!slots) {
+    return "could not allocate frame slots";
+  }
+  size_t i;
+  for (i = 0; i < num_slots; i++) {
+    slots[i].pixbuf = wuffs_base__malloc_slice_u8(
+        malloc, wuffs_base__pixel_config__pixbuf_len(&ic.pixcfg));
+    if (!slots[i].pixbuf.ptr) {
+      return "could not allocate frame slot";
+    }
+    z = wuffs_base__pixel_buffer__set_from_slice(&slots[i].pb, &ic.pixcfg,
+                                                 slots[i].pixbuf);
+    if (z) {
+      return z;
+    }
+  }
+
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    worker* w = &workers[t];
+    w->id = t;
+    w->src = make_src();
+    wuffs_base__image_config worker_ic = ((wuffs_base__image_config){});
+    const char* msg = new_decoder(&w->dec, &w->src, &worker_ic);
+    if (msg) {
+      return msg;
+    }
+    w->workbuf = wuffs_base__malloc_slice_u8(
+        malloc, wuffs_base__image_config__workbuf_len(&ic).max_incl);
+    if (!w->workbuf.ptr) {
+      return "could not allocate work buffer";
+    }
+  }
+  return NULL;
+}
+
+// ----
+
+const char* decode_serially(uint32_t* checksum) {
+  wuffs_base__animation_compositor compositor =
+      ((wuffs_base__animation_compositor){});
+  wuffs_base__rect_ie_u32 dirty_rect = ((wuffs_base__rect_ie_u32){});
+  wuffs_base__status z = wuffs_base__animation_compositor__initialize(
+      &compositor, &canvas, snapshot_buffer);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__io_buffer src = make_src();
+  wuffs_gif__decoder* dec = NULL;
+  wuffs_base__image_config unused_ic = ((wuffs_base__image_config){});
+  const char* msg = new_decoder(&dec, &src, &unused_ic);
+  while (!msg) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+    z = wuffs_gif__decoder__decode_frame_config(dec, &fc, src_reader);
+    if (z) {
+      if (z != wuffs_base__warning__end_of_data) {
+        msg = z;
+      }
+      break;
+    }
+    z = wuffs_gif__decoder__decode_frame(dec, &slots[0].pb, src_reader,
+                                         workers[0].workbuf, NULL);
+    if (!z) {
+      z = wuffs_base__animation_compositor__composite(&compositor, &dirty_rect,
+                                                      &fc, &slots[0].pb);
+    }
+    if (z) {
+      msg = z;
+      break;
+    }
+    *checksum = checksum_canvas(*checksum, dirty_rect);
+  }
+  free(dec);
+  return msg;
+}
+
+const char* decode_in_parallel(uint32_t* checksum) {
+  wuffs_base__animation_compositor compositor =
+      ((wuffs_base__animation_compositor){});
+  wuffs_base__rect_ie_u32 dirty_rect = ((wuffs_base__rect_ie_u32){});
+  wuffs_base__status z = wuffs_base__animation_compositor__initialize(
+      &compositor, &canvas, snapshot_buffer);
+  if (z) {
+    return z;
+  }
+
+  size_t batch_len = num_slots / 2;
+  size_t first_frame = 0;
+  frame_slot* batch_slots = slots;
+  const char* msg = NULL;
+  if (num_frames > 0) {
+    msg = start_batch(batch_slots, 0);
+  }
+  while (!msg && (first_frame < num_frames)) {
+    msg = finish_batch();
+    if (msg) {
+      break;
+    }
+
+    // Start decoding the next batch into the other half of the slots before
+    // compositing this batch.
+    size_t next_frame = first_frame + batch_len;
+    frame_slot* next_slots =
+        (batch_slots == slots) ? (slots + batch_len) : slots;
+    bool started = false;
+    if (next_frame < num_frames) {
+      msg = start_batch(next_slots, next_frame);
+      if (msg) {
+        break;
+      }
+      started = true;
+    }
+
+    size_t i;
+    for (i = first_frame; (i < next_frame) && (i < num_frames); i++) {
+      z = wuffs_base__animation_compositor__composite(
+          &compositor, &dirty_rect, &frame_configs[i],
+          &batch_slots[i - first_frame].pb);
+      if (z) {
+        msg = z;
+        break;
+      }
+      *checksum = checksum_canvas(*checksum, dirty_rect);
+    }
+
+    if (msg && started) {
+      finish_batch();
+    }
+    first_frame = next_frame;
+    batch_slots = next_slots;
+  }
+  return msg;
+}
+
+// ----
+
+int fail(const char* msg) {
+  const int stderr_fd = 2;
+  ignore_return_value(write(stderr_fd, msg, strnlen(msg, 4095)));
+  ignore_return_value(write(stderr_fd, "\n", 1));
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  int i;
+  for (i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-threads=", 9)) {
+      num_threads = atoi(argv[i] + 9);
+      if ((num_threads < 1) || (MAX_THREADS < num_threads)) {
+        return fail("the -threads flag value is out of range");
+      }
+    }
+  }
+
+  const char* msg = read_stdin();
+  if (msg) {
+    return fail(msg);
+  }
+  msg = scan();
+  if (msg) {
+    return fail(msg);
+  }
+  msg = allocate();
+  if (msg) {
+    return fail(msg);
+  }
+
+  uint32_t serial_checksum = 2166136261;
+  uint64_t start = micros_now();
+  msg = decode_serially(&serial_checksum);
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t serial_micros = micros_now() - start;
+
+  uint32_t parallel_checksum = 2166136261;
+  start = micros_now();
+  msg = decode_in_parallel(&parallel_checksum);
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t parallel_micros = micros_now() - start;
+
+  printf("%zu frames, %" PRIu32 " × %" PRIu32 " pixels\n", num_frames,
+         wuffs_base__pixel_config__width(&ic.pixcfg),
+         wuffs_base__pixel_config__height(&ic.pixcfg));
+  printf("serial:              %8" PRIu64 " micros, checksum 0x%08" PRIX32 "\n",
+         serial_micros, serial_checksum);
+  printf("parallel (%2d threads): %8" PRIu64 " micros, checksum 0x%08" PRIX32
+         "\n",
+         num_threads, parallel_micros, parallel_checksum);
+  if (serial_checksum != parallel_checksum) {
+    return fail("checksums differ");
+  }
+  return 0;
+}
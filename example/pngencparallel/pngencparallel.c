@@ -0,0 +1,647 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+pngencparallel decodes the PNG image read from stdin and then encodes it
+twice, once with a single encoder and once with multiple threads, and prints
+how long each encode took. To encode with 8 threads at compression level 1,
+run:
+
+$CC -O3 -pthread pngencparallel.c && ./a.out -threads=8 -level=1 < \
+    ../../test/data/harvesters.png; rm -f a.out
+
+for a C compiler $CC, such as clang or gcc. Pass -output=serial or
+-output=parallel to also write that encoding to stdout.
+
+A PNG image's pixel data is a single zlib stream, so compressing it is
+inherently serial. However, the image can be split into groups of rows, each
+group filtered and compressed independently, if:
+  - each group's first row is not filtered relative to the row above it (in
+    the previous group): its filter type is None or Sub,
+  - each group's DEFLATE data (other than the last group's) ends with a full
+    flush: an empty, byte-aligned stored block, after which nothing refers back
+    to earlier data, so that the groups' DEFLATE data can be concatenated,
+  - the groups' Adler-32 checksums are combined into the zlib stream's.
+The png encoder's filter_row_group method does the first and the deflate
+encoder's set_full_flush method does the second. The groups cost a little
+compression, as each group starts with an empty history.
+
+Such a PNG image can also be decoded in parallel, as per example/pngparallel.
+
+Both encodings are decoded again and their pixels' checksums, which should
+match the original image's, are printed.
+*/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../release/c/wuffs-unsupported-snapshot.h"
+
+// Limit the input PNG image to (64 MiB - 1 byte) compressed and 16384 × 16384
+// pixels uncompressed. This is a limitation of this example program (which
+// uses the Wuffs standard library), not a limitation of Wuffs per se.
+#define SRC_BUFFER_SIZE (64 * 1024 * 1024)
+#define MAX_DIMENSION (16384)
+
+#define MAX_THREADS 64
+
+// GROUPS_PER_THREAD is how many row groups each thread encodes, so that a
+// thread that finishes early can pick up another group.
+#define GROUPS_PER_THREAD 4
+
+// MAX_IDAT_LENGTH is the maximum length of the parallel encoding's IDAT
+// chunks' payloads.
+#define MAX_IDAT_LENGTH (1024 * 1024)
+
+uint8_t src_buffer[SRC_BUFFER_SIZE] = {0};
+size_t src_len = 0;
+
+int num_threads = 8;
+int level = 6;
+
+uint32_t width = 0;
+uint32_t height = 0;
+size_t row_length = 0;
+
+wuffs_base__slice_u8 pixbuf = ((wuffs_base__slice_u8){});
+wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+
+// dst holds an encoded PNG image. Its worst case length (for level 0, with
+// every row in its own stored block) is a little more than the filtered rows.
+wuffs_base__io_buffer dst = ((wuffs_base__io_buffer){});
+
+// ignore_return_value suppresses errors from -Wall -Werror.
+static void ignore_return_value(int ignored) {}
+
+static inline uint32_t load_u32le(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 16) | ((uint32_t)(p[3]) << 24);
+}
+
+static inline void store_u32be(uint8_t* p, uint32_t x) {
+  p[0] = (uint8_t)(x >> 24);
+  p[1] = (uint8_t)(x >> 16);
+  p[2] = (uint8_t)(x >> 8);
+  p[3] = (uint8_t)(x >> 0);
+}
+
+const char* read_stdin() {
+  while (src_len < SRC_BUFFER_SIZE) {
+    const int stdin_fd = 0;
+    ssize_t n = read(stdin_fd, src_buffer + src_len, SRC_BUFFER_SIZE - src_len);
+    if (n > 0) {
+      src_len += n;
+    } else if (n == 0) {
+      return NULL;
+    } else if (errno == EINTR) {
+      // No-op.
+    } else {
+      return strerror(errno);
+    }
+  }
+  return "input is too large";
+}
+
+uint64_t micros_now() {
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return ((uint64_t)(now.tv_sec) * 1000000) + (now.tv_nsec / 1000);
+}
+
+// decode decodes the PNG image in src to p, which must be a BGRA_NONPREMUL
+// pixel buffer of the right size, or, if p is NULL, allocates pixbuf and sets
+// pb, width, height and row_length.
+const char* decode(wuffs_base__io_buffer* src, wuffs_base__pixel_buffer* p) {
+  wuffs_png__decoder* dec = calloc(1, sizeof(wuffs_png__decoder));
+  if (!dec) {
+    return "could not allocate decoder";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){});
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  const char* msg = wuffs_png__decoder__check_wuffs_version(
+      dec, sizeof(wuffs_png__decoder), WUFFS_VERSION);
+  if (msg) {
+    goto cleanup;
+  }
+  msg = wuffs_png__decoder__decode_image_config(
+      dec, &ic, wuffs_base__io_buffer__reader(src));
+  if (msg) {
+    goto cleanup;
+  }
+
+  if (!p) {
+    width = wuffs_base__pixel_config__width(&ic.pixcfg);
+    height = wuffs_base__pixel_config__height(&ic.pixcfg);
+    if ((width > MAX_DIMENSION) || (height > MAX_DIMENSION)) {
+      msg = "image dimensions are too large";
+      goto cleanup;
+    }
+    row_length = 4 * (size_t)width;
+    wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+    wuffs_base__pixel_config__initialize(
+        &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+    pixbuf = wuffs_base__malloc_slice_u8(malloc, row_length * height);
+    if (!pixbuf.ptr) {
+      msg = "could not allocate pixel buffer";
+      goto cleanup;
+    }
+    msg = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, pixbuf);
+    if (msg) {
+      goto cleanup;
+    }
+    p = &pb;
+  }
+
+  workbuf = wuffs_base__malloc_slice_u8(
+      malloc, wuffs_base__image_config__workbuf_len(&ic).max_incl);
+  if (!workbuf.ptr) {
+    msg = "could not allocate work buffer";
+    goto cleanup;
+  }
+  msg = wuffs_png__decoder__decode_frame(
+      dec, p, wuffs_base__io_buffer__reader(src), workbuf, NULL);
+
+cleanup:
+  free(workbuf.ptr);
+  free(dec);
+  return msg;
+}
+
+// checksum_pixels folds the pixel buffer, 4 bytes (one pixel) at a time, into
+// an FNV-1a style checksum.
+uint32_t checksum_pixels(wuffs_base__pixel_buffer* p) {
+  uint32_t checksum = 2166136261;
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(p, 0);
+  size_t y;
+  for (y = 0; y < tab.height; y++) {
+    uint8_t* q = tab.ptr + (y * tab.stride);
+    size_t x;
+    for (x = 0; x < tab.width; x += 4) {
+      checksum = (checksum ^ load_u32le(q + x)) * 16777619;
+    }
+  }
+  return checksum;
+}
+
+// checksum_encoding decodes dst to a new pixel buffer and returns its pixels'
+// checksum.
+const char* checksum_encoding(uint32_t* checksum) {
+  wuffs_base__slice_u8 s = wuffs_base__malloc_slice_u8(malloc, pixbuf.len);
+  if (!s.ptr) {
+    return "could not allocate pixel buffer";
+  }
+  wuffs_base__pixel_buffer p = ((wuffs_base__pixel_buffer){});
+  const char* msg = wuffs_base__pixel_buffer__set_from_slice(&p, &pb.pixcfg, s);
+  if (!msg) {
+    wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+        .data = dst.data,
+        .meta = ((wuffs_base__io_buffer_meta){
+            .wi = dst.meta.wi,
+            .closed = true,
+        }),
+    });
+    msg = decode(&src, &p);
+  }
+  if (!msg) {
+    *checksum = checksum_pixels(&p);
+  }
+  free(s.ptr);
+  return msg;
+}
+
+// ----
+
+const char* encode_serially() {
+  dst.meta = ((wuffs_base__io_buffer_meta){});
+  wuffs_png__encoder* enc = calloc(1, sizeof(wuffs_png__encoder));
+  if (!enc) {
+    return "could not allocate encoder";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){});
+  const char* msg = wuffs_png__encoder__check_wuffs_version(
+      enc, sizeof(wuffs_png__encoder), WUFFS_VERSION);
+  if (msg) {
+    goto cleanup;
+  }
+  wuffs_png__encoder__set_level(enc, level);
+  workbuf = wuffs_base__malloc_slice_u8(
+      malloc, wuffs_png__encoder__workbuf_len(enc, width).max_incl);
+  if (!workbuf.ptr) {
+    msg = "could not allocate work buffer";
+    goto cleanup;
+  }
+  msg = wuffs_png__encoder__encode_image(
+      enc, wuffs_base__io_buffer__writer(&dst), &pb, workbuf);
+
+cleanup:
+  free(workbuf.ptr);
+  free(enc);
+  return msg;
+}
+
+// ----
+
+// A row_group is the rows from first_y (inclusive) to end_y (exclusive), the
+// DEFLATE data that they compress to and the Adler-32 checksum of their
+// filtered bytes.
+typedef struct {
+  uint32_t first_y;
+  uint32_t end_y;
+  wuffs_base__slice_u8 compressed;
+  size_t compressed_len;
+  uint32_t checksum;
+} row_group;
+
+row_group* groups = NULL;
+size_t num_groups = 0;
+
+// A worker filters and compresses every num_threads'th row group, starting at
+// the worker's id.
+typedef struct {
+  int id;
+  pthread_t thread;
+  wuffs_png__encoder* png_enc;
+  wuffs_deflate__encoder* deflate_enc;
+  wuffs_adler32__hasher* hasher;
+  wuffs_base__slice_u8 workbuf;
+  wuffs_base__slice_u8 filtered;
+  const char* msg;
+} worker;
+
+worker workers[MAX_THREADS] = {0};
+
+const char* encode_group(worker* w, size_t g) {
+  row_group* rg = &groups[g];
+  bool last = (g + 1) == num_groups;
+  size_t filtered_len = (rg->end_y - rg->first_y) * (1 + row_length);
+
+  wuffs_base__status z = wuffs_png__encoder__filter_row_group(
+      w->png_enc,
+      ((wuffs_base__slice_u8){.ptr = w->filtered.ptr, .len = filtered_len}),
+      &pb, rg->first_y, w->workbuf);
+  if (z) {
+    return z;
+  }
+
+  memset(w->hasher, 0, sizeof(wuffs_adler32__hasher));
+  z = wuffs_adler32__hasher__check_wuffs_version(
+      w->hasher, sizeof(wuffs_adler32__hasher), WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  rg->checksum = wuffs_adler32__hasher__update(
+      w->hasher,
+      ((wuffs_base__slice_u8){.ptr = w->filtered.ptr, .len = filtered_len}));
+
+  memset(w->deflate_enc, 0, sizeof(wuffs_deflate__encoder));
+  z = wuffs_deflate__encoder__check_wuffs_version(
+      w->deflate_enc, sizeof(wuffs_deflate__encoder), WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_deflate__encoder__set_level(w->deflate_enc, level);
+  wuffs_deflate__encoder__set_full_flush(w->deflate_enc, !last);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = w->filtered.ptr,
+          .len = filtered_len,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = filtered_len,
+          .closed = true,
+      }),
+  });
+  wuffs_base__io_buffer out = ((wuffs_base__io_buffer){
+      .data = rg->compressed,
+  });
+  while (true) {
+    z = wuffs_deflate__encoder__encode(w->deflate_enc,
+                                       wuffs_base__io_buffer__writer(&out),
+                                       wuffs_base__io_buffer__reader(&src));
+    if (z != wuffs_base__suspension__short_write) {
+      break;
+    }
+    // The deflate encoder keeps its own copy of the pending output, so the
+    // out buffer can move between calls.
+    size_t n = out.data.len ? (2 * out.data.len) : 65536;
+    uint8_t* p = realloc(out.data.ptr, n);
+    if (!p) {
+      rg->compressed = out.data;
+      return "could not allocate row group";
+    }
+    out.data = ((wuffs_base__slice_u8){.ptr = p, .len = n});
+  }
+  rg->compressed = out.data;
+  rg->compressed_len = out.meta.wi;
+  return z;
+}
+
+void* work_encode(void* arg) {
+  worker* w = (worker*)arg;
+  w->msg = NULL;
+  size_t g;
+  for (g = w->id; g < num_groups; g += num_threads) {
+    w->msg = encode_group(w, g);
+    if (w->msg) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+// run_workers runs f on every worker, each on its own thread, and waits for
+// them all to finish.
+const char* run_workers(void* (*f)(void*)) {
+  const char* msg = NULL;
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    if (pthread_create(&workers[t].thread, NULL, f, &workers[t])) {
+      msg = "could not create thread";
+      break;
+    }
+  }
+  int num_started = t;
+  for (t = 0; t < num_started; t++) {
+    if (pthread_join(workers[t].thread, NULL)) {
+      msg = "could not join thread";
+    } else if (workers[t].msg && !msg) {
+      msg = workers[t].msg;
+    }
+  }
+  return msg;
+}
+
+// ----
+
+wuffs_crc32__ieee_hasher crc32 = ((wuffs_crc32__ieee_hasher){});
+
+// write_chunk appends a PNG chunk to dst. The caller has already checked that
+// dst has room for it.
+void write_chunk(const char* chunk_type, uint8_t* data, size_t n) {
+  uint8_t* p = dst.data.ptr + dst.meta.wi;
+  store_u32be(p + 0, n);
+  memcpy(p + 4, chunk_type, 4);
+  if (n > 0) {
+    memmove(p + 8, data, n);
+  }
+  memset(&crc32, 0, sizeof crc32);
+  ignore_return_value(wuffs_crc32__ieee_hasher__check_wuffs_version(
+                          &crc32, sizeof crc32, WUFFS_VERSION) != NULL);
+  uint32_t checksum = wuffs_crc32__ieee_hasher__update(
+      &crc32, ((wuffs_base__slice_u8){.ptr = p + 4, .len = 4 + n}));
+  store_u32be(p + 8 + n, checksum);
+  dst.meta.wi += 12 + n;
+}
+
+// assemble writes the PNG file: the signature, the IHDR chunk, the IDAT
+// chunks holding the zlib stream (the zlib header, the groups' concatenated
+// DEFLATE data and the combined Adler-32 checksum) and the IEND chunk.
+const char* assemble() {
+  // The zlib stream is staged in a separate buffer, so that it can be split
+  // into IDAT chunks.
+  size_t zlib_len = 6;
+  size_t g;
+  for (g = 0; g < num_groups; g++) {
+    zlib_len += groups[g].compressed_len;
+  }
+  size_t num_idats = (zlib_len + MAX_IDAT_LENGTH - 1) / MAX_IDAT_LENGTH;
+  if ((8 + 25 + (12 * num_idats) + zlib_len + 12) > dst.data.len) {
+    return "dst buffer is too small";
+  }
+  uint8_t* zlib_stream = malloc(zlib_len);
+  if (!zlib_stream) {
+    return "could not allocate zlib stream";
+  }
+
+  static const uint8_t flgs[10] = {0x01, 0x01, 0x5E, 0x5E, 0x5E,
+                                   0x5E, 0x9C, 0xDA, 0xDA, 0xDA};
+  zlib_stream[0] = 0x78;
+  zlib_stream[1] = flgs[level];
+  size_t j = 2;
+  wuffs_adler32__hasher hasher = ((wuffs_adler32__hasher){});
+  ignore_return_value(wuffs_adler32__hasher__check_wuffs_version(
+                          &hasher, sizeof hasher, WUFFS_VERSION) != NULL);
+  uint32_t checksum = 1;
+  for (g = 0; g < num_groups; g++) {
+    row_group* rg = &groups[g];
+    memcpy(zlib_stream + j, rg->compressed.ptr, rg->compressed_len);
+    j += rg->compressed_len;
+    checksum = wuffs_adler32__hasher__combine(
+        &hasher, rg->checksum,
+        ((uint64_t)(rg->end_y - rg->first_y)) * (1 + row_length));
+  }
+  store_u32be(zlib_stream + j, checksum);
+
+  dst.meta = ((wuffs_base__io_buffer_meta){});
+  memcpy(dst.data.ptr, "\x89PNG\r\n\x1A\n", 8);
+  dst.meta.wi = 8;
+  uint8_t ihdr[13] = {0};
+  store_u32be(ihdr + 0, width);
+  store_u32be(ihdr + 4, height);
+  ihdr[8] = 8;  // Bit depth.
+  ihdr[9] = 6;  // Color type: RGBA.
+  write_chunk("IHDR", ihdr, 13);
+  size_t i;
+  for (i = 0; i < zlib_len; i += MAX_IDAT_LENGTH) {
+    size_t n = zlib_len - i;
+    write_chunk("IDAT", zlib_stream + i,
+                (n < MAX_IDAT_LENGTH) ? n : MAX_IDAT_LENGTH);
+  }
+  write_chunk("IEND", NULL, 0);
+  free(zlib_stream);
+  return NULL;
+}
+
+const char* encode_in_parallel() {
+  num_groups = num_threads * GROUPS_PER_THREAD;
+  if (num_groups > height) {
+    num_groups = height;
+  }
+  size_t g;
+  for (g = 0; g < num_groups; g++) {
+    groups[g].first_y = (uint32_t)((g * height) / num_groups);
+    groups[g].end_y = (uint32_t)(((g + 1) * height) / num_groups);
+    groups[g].compressed_len = 0;
+  }
+  const char* msg = run_workers(work_encode);
+  if (msg) {
+    return msg;
+  }
+  return assemble();
+}
+
+// ----
+
+const char* allocate() {
+  size_t max_group_height = 1 + (height / (num_threads * GROUPS_PER_THREAD));
+  size_t num_filtered_bytes = (1 + row_length) * height;
+  dst.data = wuffs_base__malloc_slice_u8(
+      malloc, 4096 + num_filtered_bytes + (num_filtered_bytes / 64));
+  groups = calloc(num_threads * GROUPS_PER_THREAD, sizeof(row_group));
+  if (!dst.data.ptr || !groups) {
+    return "could not allocate buffers";
+  }
+
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    worker* w = &workers[t];
+    w->id = t;
+    w->png_enc = calloc(1, sizeof(wuffs_png__encoder));
+    w->deflate_enc = calloc(1, sizeof(wuffs_deflate__encoder));
+    w->hasher = calloc(1, sizeof(wuffs_adler32__hasher));
+    if (!w->png_enc || !w->deflate_enc || !w->hasher) {
+      return "could not allocate encoder";
+    }
+    const char* msg = wuffs_png__encoder__check_wuffs_version(
+        w->png_enc, sizeof(wuffs_png__encoder), WUFFS_VERSION);
+    if (msg) {
+      return msg;
+    }
+    w->workbuf = wuffs_base__malloc_slice_u8(
+        malloc, wuffs_png__encoder__workbuf_len(w->png_enc, width).max_incl);
+    w->filtered = wuffs_base__malloc_slice_u8(
+        malloc, max_group_height * (1 + row_length));
+    if (!w->workbuf.ptr || !w->filtered.ptr) {
+      return "could not allocate buffers";
+    }
+  }
+  return NULL;
+}
+
+// ----
+
+int fail(const char* msg) {
+  const int stderr_fd = 2;
+  ignore_return_value(write(stderr_fd, msg, strnlen(msg, 4095)));
+  ignore_return_value(write(stderr_fd, "\n", 1));
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  const char* output = "";
+  int i;
+  for (i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-threads=", 9)) {
+      num_threads = atoi(argv[i] + 9);
+      if ((num_threads < 1) || (MAX_THREADS < num_threads)) {
+        return fail("the -threads flag value is out of range");
+      }
+    } else if (!strncmp(argv[i], "-level=", 7)) {
+      level = atoi(argv[i] + 7);
+      if ((level < 0) || (9 < level)) {
+        return fail("the -level flag value is out of range");
+      }
+    } else if (!strncmp(argv[i], "-output=", 8)) {
+      output = argv[i] + 8;
+    }
+  }
+
+  const char* msg = read_stdin();
+  if (msg) {
+    return fail(msg);
+  }
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = src_buffer,
+          .len = src_len,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = src_len,
+          .closed = true,
+      }),
+  });
+  msg = decode(&src, NULL);
+  if (msg) {
+    return fail(msg);
+  }
+  uint32_t original_checksum = checksum_pixels(&pb);
+  msg = allocate();
+  if (msg) {
+    return fail(msg);
+  }
+
+  uint64_t start = micros_now();
+  msg = encode_serially();
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t serial_micros = micros_now() - start;
+  size_t serial_len = dst.meta.wi;
+  uint32_t serial_checksum = 0;
+  msg = checksum_encoding(&serial_checksum);
+  if (msg) {
+    return fail(msg);
+  }
+  if (!strcmp(output, "serial")) {
+    ignore_return_value(write(1, dst.data.ptr, dst.meta.wi));
+  }
+
+  start = micros_now();
+  msg = encode_in_parallel();
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t parallel_micros = micros_now() - start;
+  size_t parallel_len = dst.meta.wi;
+  uint32_t parallel_checksum = 0;
+  msg = checksum_encoding(&parallel_checksum);
+  if (msg) {
+    return fail(msg);
+  }
+  if (!strcmp(output, "parallel")) {
+    ignore_return_value(write(1, dst.data.ptr, dst.meta.wi));
+  }
+
+  // Print to stderr, as stdout may hold the encoded image.
+  fprintf(stderr,
+          "%" PRIu32 " × %" PRIu32
+          " pixels, level %d, %zu row groups, checksum 0x%08" PRIX32 "\n",
+          width, height, level, num_groups, original_checksum);
+  fprintf(stderr,
+          "serial:               %8" PRIu64
+          " micros, %9zu bytes, checksum "
+          "0x%08" PRIX32 "\n",
+          serial_micros, serial_len, serial_checksum);
+  fprintf(stderr,
+          "parallel (%2d threads): %8" PRIu64
+          " micros, %9zu bytes, checksum "
+          "0x%08" PRIX32 "\n",
+          num_threads, parallel_micros, parallel_len, parallel_checksum);
+  if ((serial_checksum != original_checksum) ||
+      (parallel_checksum != original_checksum)) {
+    return fail("checksums differ");
+  }
+  return 0;
+}
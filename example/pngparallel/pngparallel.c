@@ -0,0 +1,594 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+pngparallel decodes the PNG image read from stdin twice, once with a single
+decoder and once with multiple threads, and prints how long each took. To
+decode a large tile with 8 threads, run:
+
+go run ../../script/make-png-with-full-flushes.go -width=4096 -height=4096 \
+    ../../test/data/harvesters.png > /tmp/tile.png
+$CC -O3 -pthread pngparallel.c && ./a.out -threads=8 < \
+    /tmp/tile.png; rm -f a.out
+
+for a C compiler $CC, such as clang or gcc.
+
+A PNG image's pixel data is a single zlib stream, split over IDAT chunks, and
+each row is usually filtered relative to the row above it, so decoding is
+inherently serial. However, some encoders fully flush the zlib stream every so
+many rows: they end each group of rows with an empty, byte-aligned stored
+block, whose last four bytes are 00 00 FF FF, after which nothing refers back
+to earlier data. If each group's first row is also not filtered relative to the
+row above it (its filter type is None or Sub), then the groups can be
+decompressed and unfiltered concurrently, by separate decoders.
+
+Finding those flush points does not need decompression: this program scans the
+zlib stream for the 00 00 FF FF pattern. That pattern can also occur by chance,
+so each candidate flush point is only confirmed by the first pass:
+  - each group decompresses, starting with an empty history, without error and
+    consuming exactly its part of the zlib stream,
+  - each group decompresses to a whole number of rows,
+  - the whole stream's Adler-32 checksum matches,
+and by the second pass:
+  - each group (other than the first) starts with a None or Sub filtered row.
+If any check fails, the program falls back to decoding serially. Images without
+any flush points, which are most PNG images, are always decoded serially.
+
+Both decodes print a checksum of the decoded pixels, which should match.
+*/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../release/c/wuffs-unsupported-snapshot.h"
+
+// Limit the input PNG image to (64 MiB - 1 byte) compressed and 16384 × 16384
+// pixels uncompressed. This is a limitation of this example program (which
+// uses the Wuffs standard library), not a limitation of Wuffs per se.
+#define SRC_BUFFER_SIZE (64 * 1024 * 1024)
+#define MAX_DIMENSION (16384)
+
+#define MAX_THREADS 64
+
+// GROUPS_PER_THREAD is roughly how many row groups each thread decodes.
+// Adjacent flush points are merged into larger groups, so that there are not
+// many more groups than that, as each group has a fixed cost.
+#define GROUPS_PER_THREAD 4
+
+uint8_t src_buffer[SRC_BUFFER_SIZE] = {0};
+size_t src_len = 0;
+
+int num_threads = 8;
+
+wuffs_base__image_config ic = ((wuffs_base__image_config){});
+
+wuffs_base__slice_u8 pixbuf = ((wuffs_base__slice_u8){});
+wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){});
+wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+
+// zlib_stream holds the concatenation of the IDAT chunks' payloads.
+wuffs_base__slice_u8 zlib_stream = ((wuffs_base__slice_u8){});
+
+// ignore_return_value suppresses errors from -Wall -Werror.
+static void ignore_return_value(int ignored) {}
+
+static inline uint32_t load_u32be(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 24) | ((uint32_t)(p[1]) << 16) |
+         ((uint32_t)(p[2]) << 8) | ((uint32_t)(p[3]) << 0);
+}
+
+static inline uint32_t load_u32le(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 16) | ((uint32_t)(p[3]) << 24);
+}
+
+const char* read_stdin() {
+  while (src_len < SRC_BUFFER_SIZE) {
+    const int stdin_fd = 0;
+    ssize_t n = read(stdin_fd, src_buffer + src_len, SRC_BUFFER_SIZE - src_len);
+    if (n > 0) {
+      src_len += n;
+    } else if (n == 0) {
+      return NULL;
+    } else if (errno == EINTR) {
+      // No-op.
+    } else {
+      return strerror(errno);
+    }
+  }
+  return "input is too large";
+}
+
+uint64_t micros_now() {
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return ((uint64_t)(now.tv_sec) * 1000000) + (now.tv_nsec / 1000);
+}
+
+wuffs_base__io_buffer make_src() {
+  return ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = src_buffer,
+          .len = src_len,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = src_len,
+          .ri = 0,
+          .pos = 0,
+          .closed = true,
+      }),
+  });
+}
+
+// new_decoder returns a decoder that has decoded the image config, ready for
+// decoding the frame or for decoding row groups.
+const char* new_decoder(wuffs_png__decoder** dec,
+                        wuffs_base__io_buffer* src,
+                        wuffs_base__image_config* ic) {
+  *dec = calloc(1, sizeof(wuffs_png__decoder));
+  if (!*dec) {
+    return "could not allocate decoder";
+  }
+  wuffs_base__status z = wuffs_png__decoder__check_wuffs_version(
+      *dec, sizeof(wuffs_png__decoder), WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  return wuffs_png__decoder__decode_image_config(
+      *dec, ic, wuffs_base__io_buffer__reader(src));
+}
+
+// checksum_pixels folds the pixel buffer, 4 bytes (one pixel) at a time, into
+// an FNV-1a style checksum.
+uint32_t checksum_pixels() {
+  uint32_t checksum = 2166136261;
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(&pb, 0);
+  size_t y;
+  for (y = 0; y < tab.height; y++) {
+    uint8_t* p = tab.ptr + (y * tab.stride);
+    size_t x;
+    for (x = 0; x < tab.width; x += 4) {
+      checksum = (checksum ^ load_u32le(p + x)) * 16777619;
+    }
+  }
+  return checksum;
+}
+
+// ----
+
+// A row_group is the part of the zlib stream between two flush points, and
+// the filtered rows that it decompresses to, which start at row first_y.
+typedef struct {
+  size_t src_begin;
+  size_t src_end;
+  wuffs_base__slice_u8 dst;
+  size_t dst_len;
+  uint32_t first_y;
+} row_group;
+
+row_group* groups = NULL;
+size_t num_groups = 0;
+
+// A worker decompresses, and later unfilters, every num_threads'th row group,
+// starting at the worker's id.
+typedef struct {
+  int id;
+  pthread_t thread;
+  wuffs_deflate__decoder* deflate_dec;
+  wuffs_png__decoder* png_dec;
+  const char* msg;
+} worker;
+
+worker workers[MAX_THREADS] = {0};
+
+// inflate_group decompresses a row group. Every group but the last should end
+// at a flush point, so the deflate decoder should run out of input exactly at
+// its end, without an error.
+const char* inflate_group(wuffs_deflate__decoder* dec, size_t g) {
+  row_group* rg = &groups[g];
+  bool last = (g + 1) == num_groups;
+  memset(dec, 0, sizeof(wuffs_deflate__decoder));
+  wuffs_base__status z = wuffs_deflate__decoder__check_wuffs_version(
+      dec, sizeof(wuffs_deflate__decoder), WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = zlib_stream.ptr + rg->src_begin,
+          .len = rg->src_end - rg->src_begin,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = rg->src_end - rg->src_begin,
+          .closed = last,
+      }),
+  });
+  wuffs_base__io_buffer dst = ((wuffs_base__io_buffer){
+      .data = rg->dst,
+  });
+  while (true) {
+    z = wuffs_deflate__decoder__decode(dec, wuffs_base__io_buffer__writer(&dst),
+                                       wuffs_base__io_buffer__reader(&src));
+    if (z != wuffs_base__suspension__short_write) {
+      break;
+    }
+    // The deflate decoder keeps its own copy of the history, so the dst
+    // buffer can move between calls.
+    size_t n = dst.data.len ? (2 * dst.data.len) : 65536;
+    uint8_t* p = realloc(dst.data.ptr, n);
+    if (!p) {
+      rg->dst = dst.data;
+      return "could not allocate row group";
+    }
+    dst.data = ((wuffs_base__slice_u8){.ptr = p, .len = n});
+  }
+  rg->dst = dst.data;
+  rg->dst_len = dst.meta.wi;
+  if (last ? (z != NULL)
+           : ((z != wuffs_base__suspension__short_read) ||
+              (src.meta.ri != src.meta.wi))) {
+    return "not a flush point";
+  }
+  return NULL;
+}
+
+void* work_inflate(void* arg) {
+  worker* w = (worker*)arg;
+  w->msg = NULL;
+  size_t g;
+  for (g = w->id; g < num_groups; g += num_threads) {
+    w->msg = inflate_group(w->deflate_dec, g);
+    if (w->msg) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+void* work_unfilter(void* arg) {
+  worker* w = (worker*)arg;
+  w->msg = NULL;
+  size_t g;
+  for (g = w->id; g < num_groups; g += num_threads) {
+    row_group* rg = &groups[g];
+    w->msg = wuffs_png__decoder__decode_row_group(
+        w->png_dec, &pb,
+        ((wuffs_base__slice_u8){.ptr = rg->dst.ptr, .len = rg->dst_len}),
+        rg->first_y);
+    if (w->msg) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+// run_workers runs f on every worker, each on its own thread, and waits for
+// them all to finish.
+const char* run_workers(void* (*f)(void*)) {
+  const char* msg = NULL;
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    if (pthread_create(&workers[t].thread, NULL, f, &workers[t])) {
+      msg = "could not create thread";
+      break;
+    }
+  }
+  int num_started = t;
+  for (t = 0; t < num_started; t++) {
+    if (pthread_join(workers[t].thread, NULL)) {
+      msg = "could not join thread";
+    } else if (workers[t].msg && !msg) {
+      msg = workers[t].msg;
+    }
+  }
+  return msg;
+}
+
+// ----
+
+// gather_idats copies the IDAT chunks' payloads, the zlib stream, to
+// zlib_stream. Each worker's decoder has already checked the PNG file
+// structure up to the first IDAT chunk.
+const char* gather_idats() {
+  uint8_t* p = src_buffer;
+  size_t n = src_len;
+  size_t i = 8;
+  size_t j = 0;
+  while ((i < n) && (12 <= (n - i))) {
+    uint32_t len = load_u32be(p + i);
+    if (len > (n - i - 12)) {
+      return "bad chunk length";
+    }
+    if (!memcmp(p + i + 4, "IDAT", 4)) {
+      memcpy(zlib_stream.ptr + j, p + i + 8, len);
+      j += len;
+    } else if (j > 0) {
+      break;
+    }
+    i += 12 + len;
+  }
+  zlib_stream.len = j;
+  return NULL;
+}
+
+// find_groups splits the DEFLATE data, within the zlib stream, at candidate
+// flush points, merging adjacent groups that are shorter than min_group_len.
+const char* find_groups() {
+  num_groups = 0;
+  if (zlib_stream.len < 6) {
+    return NULL;
+  }
+  uint8_t* p = zlib_stream.ptr;
+  // The 2 byte zlib header must say DEFLATE compression, no preset
+  // dictionary, and have a valid check value.
+  if (((p[0] & 0x0F) != 8) || ((p[1] & 0x20) != 0) ||
+      ((((p[0] << 8) | p[1]) % 31) != 0)) {
+    return NULL;
+  }
+  size_t begin = 2;
+  size_t end = zlib_stream.len - 4;
+  size_t min_group_len = (end - begin) / (num_threads * GROUPS_PER_THREAD);
+  size_t cap = (2 * num_threads * GROUPS_PER_THREAD) + 1;
+  groups = calloc(cap, sizeof(row_group));
+  if (!groups) {
+    return "could not allocate row groups";
+  }
+
+  size_t i;
+  for (i = begin; (i + 4) < end; i++) {
+    if ((p[i + 0] != 0x00) || (p[i + 1] != 0x00) || (p[i + 2] != 0xFF) ||
+        (p[i + 3] != 0xFF)) {
+      continue;
+    }
+    size_t flush_point = i + 4;
+    if (((flush_point - begin) < min_group_len) ||
+        ((end - flush_point) < min_group_len) || ((num_groups + 2) > cap)) {
+      continue;
+    }
+    groups[num_groups].src_begin = begin;
+    groups[num_groups].src_end = flush_point;
+    num_groups++;
+    begin = flush_point;
+  }
+  groups[num_groups].src_begin = begin;
+  groups[num_groups].src_end = end;
+  num_groups++;
+  return NULL;
+}
+
+// check_groups calculates each row group's first row, and checks that the row
+// groups add up to the whole image and match the zlib stream's checksum.
+const char* check_groups() {
+  // For a non-interlaced image, the PNG decoder's minimum workbuf length is
+  // two filtered rows, and its maximum is every filtered row.
+  wuffs_base__range_ii_u64 workbuf_len =
+      wuffs_base__image_config__workbuf_len(&ic);
+  if (workbuf_len.min_incl >= workbuf_len.max_incl) {
+    return "not a non-interlaced image";
+  }
+  uint64_t row_length = workbuf_len.min_incl / 2;
+  uint64_t n = workbuf_len.max_incl;
+
+  wuffs_adler32__hasher hasher = ((wuffs_adler32__hasher){});
+  wuffs_base__status z = wuffs_adler32__hasher__check_wuffs_version(
+      &hasher, sizeof hasher, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  uint32_t checksum = 0;
+  uint64_t offset = 0;
+  size_t g;
+  for (g = 0; g < num_groups; g++) {
+    row_group* rg = &groups[g];
+    if ((offset % row_length) != 0) {
+      return "row group does not start at a row boundary";
+    }
+    rg->first_y = offset / row_length;
+    offset += rg->dst_len;
+    checksum = wuffs_adler32__hasher__update(
+        &hasher,
+        ((wuffs_base__slice_u8){.ptr = rg->dst.ptr, .len = rg->dst_len}));
+  }
+  if (offset != n) {
+    return "row groups do not add up to the image";
+  }
+  if (checksum != load_u32be(zlib_stream.ptr + zlib_stream.len - 4)) {
+    return "checksum mismatch";
+  }
+  return NULL;
+}
+
+void free_groups() {
+  size_t g;
+  for (g = 0; g < num_groups; g++) {
+    free(groups[g].dst.ptr);
+  }
+  free(groups);
+  groups = NULL;
+  num_groups = 0;
+}
+
+// ----
+
+const char* allocate() {
+  wuffs_base__io_buffer src = make_src();
+  wuffs_png__decoder* dec = NULL;
+  const char* msg = new_decoder(&dec, &src, &ic);
+  free(dec);
+  if (msg) {
+    return msg;
+  }
+  if (!wuffs_base__image_config__is_valid(&ic)) {
+    return "invalid image configuration";
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  if ((width > MAX_DIMENSION) || (height > MAX_DIMENSION)) {
+    return "image dimensions are too large";
+  }
+  uint64_t num_pixels = ((uint64_t)width) * ((uint64_t)height);
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+  pixbuf = wuffs_base__malloc_slice_u8(malloc, 4 * num_pixels);
+  workbuf = wuffs_base__malloc_slice_u8(
+      malloc, wuffs_base__image_config__workbuf_len(&ic).max_incl);
+  zlib_stream = wuffs_base__malloc_slice_u8(malloc, src_len);
+  if (!pixbuf.ptr || !workbuf.ptr || !zlib_stream.ptr) {
+    return "could not allocate buffers";
+  }
+  wuffs_base__status z =
+      wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, pixbuf);
+  if (z) {
+    return z;
+  }
+
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    worker* w = &workers[t];
+    w->id = t;
+    w->deflate_dec = calloc(1, sizeof(wuffs_deflate__decoder));
+    if (!w->deflate_dec) {
+      return "could not allocate decoder";
+    }
+    wuffs_base__io_buffer worker_src = make_src();
+    wuffs_base__image_config worker_ic = ((wuffs_base__image_config){});
+    msg = new_decoder(&w->png_dec, &worker_src, &worker_ic);
+    if (msg) {
+      return msg;
+    }
+  }
+  return NULL;
+}
+
+// ----
+
+const char* decode_serially() {
+  wuffs_base__io_buffer src = make_src();
+  wuffs_png__decoder* dec = NULL;
+  wuffs_base__image_config unused_ic = ((wuffs_base__image_config){});
+  const char* msg = new_decoder(&dec, &src, &unused_ic);
+  if (!msg) {
+    msg = wuffs_png__decoder__decode_frame(
+        dec, &pb, wuffs_base__io_buffer__reader(&src), workbuf, NULL);
+  }
+  free(dec);
+  return msg;
+}
+
+// decode_in_parallel decodes the row groups concurrently, if it can, or else
+// falls back to decode_serially. It sets *num_decoded_groups to the number of
+// row groups that were decoded concurrently, or to 0 for falling back.
+const char* decode_in_parallel(size_t* num_decoded_groups) {
+  *num_decoded_groups = 0;
+  const char* msg = gather_idats();
+  if (!msg) {
+    msg = find_groups();
+  }
+  if (!msg && (num_groups > 1)) {
+    if (!run_workers(work_inflate) && !check_groups() &&
+        !run_workers(work_unfilter)) {
+      *num_decoded_groups = num_groups;
+    }
+  }
+  free_groups();
+  if (msg) {
+    return msg;
+  }
+  return *num_decoded_groups ? NULL : decode_serially();
+}
+
+// ----
+
+int fail(const char* msg) {
+  const int stderr_fd = 2;
+  ignore_return_value(write(stderr_fd, msg, strnlen(msg, 4095)));
+  ignore_return_value(write(stderr_fd, "\n", 1));
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  int i;
+  for (i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-threads=", 9)) {
+      num_threads = atoi(argv[i] + 9);
+      if ((num_threads < 1) || (MAX_THREADS < num_threads)) {
+        return fail("the -threads flag value is out of range");
+      }
+    }
+  }
+
+  const char* msg = read_stdin();
+  if (msg) {
+    return fail(msg);
+  }
+  msg = allocate();
+  if (msg) {
+    return fail(msg);
+  }
+
+  uint64_t start = micros_now();
+  msg = decode_serially();
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t serial_micros = micros_now() - start;
+  uint32_t serial_checksum = checksum_pixels();
+
+  memset(pixbuf.ptr, 0, pixbuf.len);
+  size_t num_decoded_groups = 0;
+  start = micros_now();
+  msg = decode_in_parallel(&num_decoded_groups);
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t parallel_micros = micros_now() - start;
+  uint32_t parallel_checksum = checksum_pixels();
+
+  printf("%" PRIu32 " × %" PRIu32 " pixels, %zu row groups%s\n",
+         wuffs_base__pixel_config__width(&ic.pixcfg),
+         wuffs_base__pixel_config__height(&ic.pixcfg), num_decoded_groups,
+         num_decoded_groups ? "" : " (fell back to decoding serially)");
+  printf("serial:              %8" PRIu64 " micros, checksum 0x%08" PRIX32 "\n",
+         serial_micros, serial_checksum);
+  printf("parallel (%2d threads): %8" PRIu64 " micros, checksum 0x%08" PRIX32
+         "\n",
+         num_threads, parallel_micros, parallel_checksum);
+  if (serial_checksum != parallel_checksum) {
+    return fail("checksums differ");
+  }
+  return 0;
+}
@@ -0,0 +1,407 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+tiffparallel decodes the TIFF image read from stdin twice, once with a single
+decoder and once with multiple threads, and prints how long each took. To
+decode a large image with 8 threads, run:
+
+go run ../../script/make-tiff.go -width=4096 -height=4096 -compression=lzw \
+    -rows-per-strip=64 ../../test/data/harvesters.png > /tmp/big.tiff
+$CC -O3 -pthread tiffparallel.c && ./a.out -threads=8 < \
+    /tmp/big.tiff; rm -f a.out
+
+for a C compiler $CC, such as clang or gcc.
+
+A TIFF image's pixel data is split into strips (or tiles), which we call
+chunks, and each chunk is compressed independently of the others. The decoder's
+decode_chunk_table method lists each chunk's position and length, and its
+decode_chunk method decompresses and converts one chunk, so that chunks can be
+decoded concurrently by separate decoders, each with its own work buffer.
+
+Both decodes print a checksum of the decoded pixels, which should match.
+*/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../release/c/wuffs-unsupported-snapshot.h"
+
+// Limit the input TIFF image to (64 MiB - 1 byte) compressed and 16384 × 16384
+// pixels uncompressed. This is a limitation of this example program (which
+// uses the Wuffs standard library), not a limitation of Wuffs per se.
+#define SRC_BUFFER_SIZE (64 * 1024 * 1024)
+#define MAX_DIMENSION (16384)
+
+#define MAX_THREADS 64
+
+uint8_t src_buffer[SRC_BUFFER_SIZE] = {0};
+size_t src_len = 0;
+
+int num_threads = 8;
+
+wuffs_base__image_config ic = ((wuffs_base__image_config){});
+
+wuffs_base__slice_u8 pixbuf = ((wuffs_base__slice_u8){});
+wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){});
+wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+
+// chunk_table holds each chunk's offset and length, as u32le values.
+wuffs_base__slice_u8 chunk_table = ((wuffs_base__slice_u8){});
+uint32_t num_chunks = 0;
+
+// ignore_return_value suppresses errors from -Wall -Werror.
+static void ignore_return_value(int ignored) {}
+
+static inline uint32_t load_u32le(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 16) | ((uint32_t)(p[3]) << 24);
+}
+
+const char* read_stdin() {
+  while (src_len < SRC_BUFFER_SIZE) {
+    const int stdin_fd = 0;
+    ssize_t n = read(stdin_fd, src_buffer + src_len, SRC_BUFFER_SIZE - src_len);
+    if (n > 0) {
+      src_len += n;
+    } else if (n == 0) {
+      return NULL;
+    } else if (errno == EINTR) {
+      // No-op.
+    } else {
+      return strerror(errno);
+    }
+  }
+  return "input is too large";
+}
+
+uint64_t micros_now() {
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now)) {
+    return 0;
+  }
+  return ((uint64_t)(now.tv_sec) * 1000000) + (now.tv_nsec / 1000);
+}
+
+wuffs_base__io_buffer make_src() {
+  return ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = src_buffer,
+          .len = src_len,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = src_len,
+          .ri = 0,
+          .pos = 0,
+          .closed = true,
+      }),
+  });
+}
+
+// reposition handles a "$mispositioned read" status. As src holds the entire
+// file, it only needs to move src's read index.
+const char* reposition(wuffs_tiff__decoder* dec, wuffs_base__io_buffer* src) {
+  uint64_t pos = wuffs_tiff__decoder__seek_position(dec);
+  if (pos > src->meta.wi) {
+    return "seek position is out of bounds";
+  }
+  src->meta.ri = pos;
+  return NULL;
+}
+
+// new_decoder returns a decoder that has decoded the image config, ready for
+// decoding the frame or for decoding chunks.
+const char* new_decoder(wuffs_tiff__decoder** dec,
+                        wuffs_base__io_buffer* src,
+                        wuffs_base__image_config* ic) {
+  *dec = calloc(1, sizeof(wuffs_tiff__decoder));
+  if (!*dec) {
+    return "could not allocate decoder";
+  }
+  wuffs_base__status z = wuffs_tiff__decoder__check_wuffs_version(
+      *dec, sizeof(wuffs_tiff__decoder), WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  while (true) {
+    z = wuffs_tiff__decoder__decode_image_config(
+        *dec, ic, wuffs_base__io_buffer__reader(src));
+    if (z != wuffs_tiff__suspension__mispositioned_read) {
+      return z;
+    }
+    const char* msg = reposition(*dec, src);
+    if (msg) {
+      return msg;
+    }
+  }
+}
+
+// checksum_pixels folds the pixel buffer, 4 bytes (one pixel) at a time, into
+// an FNV-1a style checksum.
+uint32_t checksum_pixels() {
+  uint32_t checksum = 2166136261;
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(&pb, 0);
+  size_t y;
+  for (y = 0; y < tab.height; y++) {
+    uint8_t* p = tab.ptr + (y * tab.stride);
+    size_t x;
+    for (x = 0; x < tab.width; x += 4) {
+      checksum = (checksum ^ load_u32le(p + x)) * 16777619;
+    }
+  }
+  return checksum;
+}
+
+// ----
+
+// A worker decodes every num_threads'th chunk, starting at the worker's id,
+// into its own work buffer.
+typedef struct {
+  int id;
+  pthread_t thread;
+  wuffs_tiff__decoder* dec;
+  wuffs_base__slice_u8 workbuf;
+  const char* msg;
+} worker;
+
+worker workers[MAX_THREADS] = {0};
+
+const char* decode_chunk(worker* w, uint32_t i) {
+  wuffs_base__io_buffer src = make_src();
+  uint8_t* entry = chunk_table.ptr + (8 * (size_t)i);
+  while (true) {
+    wuffs_base__status z = wuffs_tiff__decoder__decode_chunk(
+        w->dec, &pb, wuffs_base__io_buffer__reader(&src), w->workbuf, i,
+        load_u32le(entry + 0), load_u32le(entry + 4));
+    if (z != wuffs_tiff__suspension__mispositioned_read) {
+      return z;
+    }
+    const char* msg = reposition(w->dec, &src);
+    if (msg) {
+      return msg;
+    }
+  }
+}
+
+void* work(void* arg) {
+  worker* w = (worker*)arg;
+  w->msg = NULL;
+  uint32_t i;
+  for (i = w->id; i < num_chunks; i += num_threads) {
+    w->msg = decode_chunk(w, i);
+    if (w->msg) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+// run_workers runs work on every worker, each on its own thread, and waits for
+// them all to finish.
+const char* run_workers() {
+  const char* msg = NULL;
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    if (pthread_create(&workers[t].thread, NULL, work, &workers[t])) {
+      msg = "could not create thread";
+      break;
+    }
+  }
+  int num_started = t;
+  for (t = 0; t < num_started; t++) {
+    if (pthread_join(workers[t].thread, NULL)) {
+      msg = "could not join thread";
+    } else if (workers[t].msg && !msg) {
+      msg = workers[t].msg;
+    }
+  }
+  return msg;
+}
+
+// ----
+
+const char* allocate() {
+  wuffs_base__io_buffer src = make_src();
+  wuffs_tiff__decoder* dec = NULL;
+  const char* msg = new_decoder(&dec, &src, &ic);
+  if (!msg && !wuffs_base__image_config__is_valid(&ic)) {
+    msg = "invalid image configuration";
+  }
+  if (msg) {
+    free(dec);
+    return msg;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  if ((width > MAX_DIMENSION) || (height > MAX_DIMENSION)) {
+    free(dec);
+    return "image dimensions are too large";
+  }
+  uint64_t num_pixels = ((uint64_t)width) * ((uint64_t)height);
+  num_chunks = wuffs_tiff__decoder__num_chunks(dec);
+  uint64_t chunk_workbuf_len = wuffs_tiff__decoder__chunk_workbuf_len(dec);
+  free(dec);
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+  pixbuf = wuffs_base__malloc_slice_u8(malloc, 4 * num_pixels);
+  workbuf = wuffs_base__malloc_slice_u8(
+      malloc, wuffs_base__image_config__workbuf_len(&ic).max_incl);
+  chunk_table = wuffs_base__malloc_slice_u8(malloc, 8 * (size_t)num_chunks);
+  if (!pixbuf.ptr || !workbuf.ptr || !chunk_table.ptr) {
+    return "could not allocate buffers";
+  }
+  wuffs_base__status z =
+      wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, pixbuf);
+  if (z) {
+    return z;
+  }
+
+  int t;
+  for (t = 0; t < num_threads; t++) {
+    worker* w = &workers[t];
+    w->id = t;
+    w->workbuf = wuffs_base__malloc_slice_u8(malloc, chunk_workbuf_len);
+    if (!w->workbuf.ptr && chunk_workbuf_len) {
+      return "could not allocate buffers";
+    }
+    wuffs_base__io_buffer worker_src = make_src();
+    wuffs_base__image_config worker_ic = ((wuffs_base__image_config){});
+    msg = new_decoder(&w->dec, &worker_src, &worker_ic);
+    if (msg) {
+      return msg;
+    }
+  }
+  return NULL;
+}
+
+// ----
+
+const char* decode_serially() {
+  wuffs_base__io_buffer src = make_src();
+  wuffs_tiff__decoder* dec = NULL;
+  wuffs_base__image_config unused_ic = ((wuffs_base__image_config){});
+  const char* msg = new_decoder(&dec, &src, &unused_ic);
+  while (!msg) {
+    msg = wuffs_tiff__decoder__decode_frame(
+        dec, &pb, wuffs_base__io_buffer__reader(&src), workbuf, NULL);
+    if (msg != wuffs_tiff__suspension__mispositioned_read) {
+      break;
+    }
+    msg = reposition(dec, &src);
+  }
+  free(dec);
+  return msg;
+}
+
+// decode_in_parallel decodes the chunk table, serially, and then the chunks,
+// concurrently.
+const char* decode_in_parallel() {
+  wuffs_base__io_buffer src = make_src();
+  wuffs_tiff__decoder* dec = workers[0].dec;
+  while (true) {
+    wuffs_base__status z = wuffs_tiff__decoder__decode_chunk_table(
+        dec, chunk_table, wuffs_base__io_buffer__reader(&src));
+    if (z != wuffs_tiff__suspension__mispositioned_read) {
+      if (z) {
+        return z;
+      }
+      break;
+    }
+    const char* msg = reposition(dec, &src);
+    if (msg) {
+      return msg;
+    }
+  }
+  return run_workers();
+}
+
+// ----
+
+int fail(const char* msg) {
+  const int stderr_fd = 2;
+  ignore_return_value(write(stderr_fd, msg, strnlen(msg, 4095)));
+  ignore_return_value(write(stderr_fd, "\n", 1));
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  int i;
+  for (i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "-threads=", 9)) {
+      num_threads = atoi(argv[i] + 9);
+      if ((num_threads < 1) || (MAX_THREADS < num_threads)) {
+        return fail("the -threads flag value is out of range");
+      }
+    }
+  }
+
+  const char* msg = read_stdin();
+  if (msg) {
+    return fail(msg);
+  }
+  msg = allocate();
+  if (msg) {
+    return fail(msg);
+  }
+
+  uint64_t start = micros_now();
+  msg = decode_serially();
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t serial_micros = micros_now() - start;
+  uint32_t serial_checksum = checksum_pixels();
+
+  memset(pixbuf.ptr, 0, pixbuf.len);
+  start = micros_now();
+  msg = decode_in_parallel();
+  if (msg) {
+    return fail(msg);
+  }
+  uint64_t parallel_micros = micros_now() - start;
+  uint32_t parallel_checksum = checksum_pixels();
+
+  printf("%" PRIu32 " × %" PRIu32 " pixels, %" PRIu32 " chunks\n",
+         wuffs_base__pixel_config__width(&ic.pixcfg),
+         wuffs_base__pixel_config__height(&ic.pixcfg), num_chunks);
+  printf("serial:              %8" PRIu64 " micros, checksum 0x%08" PRIX32 "\n",
+         serial_micros, serial_checksum);
+  printf("parallel (%2d threads): %8" PRIu64 " micros, checksum 0x%08" PRIX32
+         "\n",
+         num_threads, parallel_micros, parallel_checksum);
+  if (serial_checksum != parallel_checksum) {
+    return fail("checksums differ");
+  }
+  return 0;
+}
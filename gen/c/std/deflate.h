@@ -0,0 +1,9205 @@
+#ifndef WUFFS_INCLUDE_GUARD__DEFLATE
+#define WUFFS_INCLUDE_GUARD__DEFLATE
+
+// Code generated by wuffs-c. DO NOT EDIT.
+
+#ifndef WUFFS_INCLUDE_GUARD__BASE_PUBLIC
+#define WUFFS_INCLUDE_GUARD__BASE_PUBLIC
+
+// Copyright 2017 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wuffs assumes that:
+//  - converting a uint32_t to a size_t will never overflow.
+//  - converting a size_t to a uint64_t will never overflow.
+#ifdef __WORDSIZE
+#if (__WORDSIZE != 32) && (__WORDSIZE != 64)
+#error "Wuffs requires a word size of either 32 or 64 bits"
+#endif
+#endif
+
+// WUFFS_VERSION is the major.minor.patch version, as per https://semver.org/,
+// as a uint64_t. The major number is the high 32 bits. The minor number is the
+// middle 16 bits. The patch number is the low 16 bits. The version extension
+// (such as "", "beta" or "rc.1") is part of the string representation (such as
+// "1.2.3-beta") but not the uint64_t representation.
+//
+// All three of major, minor and patch being zero means that this is a
+// work-in-progress version, not a release version, and has no backwards or
+// forwards compatibility guarantees.
+//
+// !! Some code generation programs can override WUFFS_VERSION.
+#define WUFFS_VERSION ((uint64_t)0)
+#define WUFFS_VERSION_MAJOR ((uint64_t)0)
+#define WUFFS_VERSION_MINOR ((uint64_t)0)
+#define WUFFS_VERSION_PATCH ((uint64_t)0)
+#define WUFFS_VERSION_EXTENSION ""
+#define WUFFS_VERSION_STRING "0.0.0"
+
+// Define WUFFS_CONFIG__STATIC_FUNCTIONS to make all of Wuffs' functions have
+// static storage. The motivation is discussed in the "ALLOW STATIC
+// IMPLEMENTATION" section of
+// https://raw.githubusercontent.com/nothings/stb/master/docs/stb_howto.txt
+#ifdef WUFFS_CONFIG__STATIC_FUNCTIONS
+#define WUFFS_BASE__MAYBE_STATIC static
+#else
+#define WUFFS_BASE__MAYBE_STATIC
+#endif
+
+// Clang also defines "__GNUC__".
+#if defined(__GNUC__)
+#define WUFFS_BASE__WARN_UNUSED_RESULT __attribute__((warn_unused_result))
+#else
+#define WUFFS_BASE__WARN_UNUSED_RESULT
+#endif
+
+// wuffs_base__empty_struct is used when a Wuffs function returns an empty
+// struct. In C, if a function f returns void, you can't say "x = f()", but in
+// Wuffs, if a function g returns empty, you can say "y = g()".
+typedef struct {
+  // private_impl is a placeholder field. It isn't explicitly used, except that
+  // without it, the sizeof a struct with no fields can differ across C/C++
+  // compilers, and it is undefined behavior in C99. For example, gcc says that
+  // the sizeof an empty struct is 0, and g++ says that it is 1. This leads to
+  // ABI incompatibility if a Wuffs .c file is processed by one compiler and
+  // its .h file with another compiler.
+  //
+  // Instead, we explicitly insert an otherwise unused field, so that the
+  // sizeof this struct is always 1.
+  uint8_t private_impl;
+} wuffs_base__empty_struct;
+
+// wuffs_base__utility is a placeholder receiver type. It enables what Java
+// calls static methods, as opposed to regular methods.
+typedef struct {
+  // private_impl is a placeholder field. It isn't explicitly used, except that
+  // without it, the sizeof a struct with no fields can differ across C/C++
+  // compilers, and it is undefined behavior in C99. For example, gcc says that
+  // the sizeof an empty struct is 0, and g++ says that it is 1. This leads to
+  // ABI incompatibility if a Wuffs .c file is processed by one compiler and
+  // its .h file with another compiler.
+  //
+  // Instead, we explicitly insert an otherwise unused field, so that the
+  // sizeof this struct is always 1.
+  uint8_t private_impl;
+} wuffs_base__utility;
+
+// --------
+
+// A status is either NULL (meaning OK) or a string message. That message is
+// human-readable, for programmers, but it is not for end users. It is not
+// localized, and does not contain additional contextual information such as a
+// source filename.
+//
+// Status strings are statically allocated and should never be free'd. They can
+// be compared by the == operator and not just by strcmp.
+//
+// Statuses come in four categories:
+//  - OK:          the request was completed, successfully.
+//  - Warnings:    the request was completed, unsuccessfully.
+//  - Suspensions: the request was not completed, but can be re-tried.
+//  - Errors:      the request was not completed, permanently.
+//
+// When a function returns an incomplete status, a suspension means that that
+// function should be called again within a new context, such as after flushing
+// or re-filling an I/O buffer. An error means that an irrecoverable failure
+// state was reached.
+typedef const char* wuffs_base__status;
+
+extern const char* wuffs_base__warning__end_of_data;
+extern const char* wuffs_base__suspension__short_read;
+extern const char* wuffs_base__suspension__short_write;
+extern const char* wuffs_base__error__bad_argument_length_too_short;
+extern const char* wuffs_base__error__bad_argument;
+extern const char* wuffs_base__error__bad_call_sequence;
+extern const char* wuffs_base__error__bad_receiver;
+extern const char* wuffs_base__error__bad_restart;
+extern const char* wuffs_base__error__bad_sizeof_receiver;
+extern const char* wuffs_base__error__bad_workbuf_length;
+extern const char* wuffs_base__error__bad_wuffs_version;
+extern const char* wuffs_base__error__cannot_return_a_suspension;
+extern const char* wuffs_base__error__check_wuffs_version_not_applicable;
+extern const char* wuffs_base__error__check_wuffs_version_missing;
+extern const char* wuffs_base__error__disabled_by_previous_error;
+extern const char* wuffs_base__error__unsupported_pixel_format;
+
+static inline bool  //
+wuffs_base__status__is_complete(wuffs_base__status z) {
+  return (z == NULL) || ((*z != '$') && (*z != '?'));
+}
+
+static inline bool  //
+wuffs_base__status__is_error(wuffs_base__status z) {
+  return z && (*z == '?');
+}
+
+static inline bool  //
+wuffs_base__status__is_ok(wuffs_base__status z) {
+  return z == NULL;
+}
+
+static inline bool  //
+wuffs_base__status__is_suspension(wuffs_base__status z) {
+  return z && (*z == '$');
+}
+
+static inline bool  //
+wuffs_base__status__is_warning(wuffs_base__status z) {
+  return z && (*z != '$') && (*z != '?');
+}
+
+// --------
+
+// Flicks are a unit of time. One flick (frame-tick) is 1 / 705_600_000 of a
+// second. See https://github.com/OculusVR/Flicks
+typedef int64_t wuffs_base__flicks;
+
+#define WUFFS_BASE__FLICKS_PER_SECOND ((uint64_t)705600000)
+#define WUFFS_BASE__FLICKS_PER_MILLISECOND ((uint64_t)705600)
+
+// ---------------- Numeric Types
+
+static inline uint8_t  //
+wuffs_base__u8__min(uint8_t x, uint8_t y) {
+  return x < y ? x : y;
+}
+
+static inline uint8_t  //
+wuffs_base__u8__max(uint8_t x, uint8_t y) {
+  return x > y ? x : y;
+}
+
+static inline uint16_t  //
+wuffs_base__u16__min(uint16_t x, uint16_t y) {
+  return x < y ? x : y;
+}
+
+static inline uint16_t  //
+wuffs_base__u16__max(uint16_t x, uint16_t y) {
+  return x > y ? x : y;
+}
+
+static inline uint32_t  //
+wuffs_base__u32__min(uint32_t x, uint32_t y) {
+  return x < y ? x : y;
+}
+
+static inline uint32_t  //
+wuffs_base__u32__max(uint32_t x, uint32_t y) {
+  return x > y ? x : y;
+}
+
+static inline uint64_t  //
+wuffs_base__u64__min(uint64_t x, uint64_t y) {
+  return x < y ? x : y;
+}
+
+static inline uint64_t  //
+wuffs_base__u64__max(uint64_t x, uint64_t y) {
+  return x > y ? x : y;
+}
+
+// --------
+
+// Saturating arithmetic (sat_add, sat_sub) branchless bit-twiddling algorithms
+// are per https://locklessinc.com/articles/sat_arithmetic/
+//
+// It is important that the underlying types are unsigned integers, as signed
+// integer arithmetic overflow is undefined behavior in C.
+
+static inline uint8_t  //
+wuffs_base__u8__sat_add(uint8_t x, uint8_t y) {
+  uint8_t res = x + y;
+  res |= -(res < x);
+  return res;
+}
+
+static inline uint8_t  //
+wuffs_base__u8__sat_sub(uint8_t x, uint8_t y) {
+  uint8_t res = x - y;
+  res &= -(res <= x);
+  return res;
+}
+
+static inline uint16_t  //
+wuffs_base__u16__sat_add(uint16_t x, uint16_t y) {
+  uint16_t res = x + y;
+  res |= -(res < x);
+  return res;
+}
+
+static inline uint16_t  //
+wuffs_base__u16__sat_sub(uint16_t x, uint16_t y) {
+  uint16_t res = x - y;
+  res &= -(res <= x);
+  return res;
+}
+
+static inline uint32_t  //
+wuffs_base__u32__sat_add(uint32_t x, uint32_t y) {
+  uint32_t res = x + y;
+  res |= -(res < x);
+  return res;
+}
+
+static inline uint32_t  //
+wuffs_base__u32__sat_sub(uint32_t x, uint32_t y) {
+  uint32_t res = x - y;
+  res &= -(res <= x);
+  return res;
+}
+
+static inline uint64_t  //
+wuffs_base__u64__sat_add(uint64_t x, uint64_t y) {
+  uint64_t res = x + y;
+  res |= -(res < x);
+  return res;
+}
+
+static inline uint64_t  //
+wuffs_base__u64__sat_sub(uint64_t x, uint64_t y) {
+  uint64_t res = x - y;
+  res &= -(res <= x);
+  return res;
+}
+
+// --------
+
+// Clang also defines "__GNUC__".
+
+static inline uint16_t  //
+wuffs_base__u16__byte_swapped(uint16_t x) {
+#if defined(__GNUC__)
+  return __builtin_bswap16(x);
+#else
+  return (x >> 8) | (x << 8);
+#endif
+}
+
+static inline uint32_t  //
+wuffs_base__u32__byte_swapped(uint32_t x) {
+#if defined(__GNUC__)
+  return __builtin_bswap32(x);
+#else
+  static const uint32_t mask8 = 0x00FF00FF;
+  x = ((x >> 8) & mask8) | ((x & mask8) << 8);
+  return (x >> 16) | (x << 16);
+#endif
+}
+
+static inline uint64_t  //
+wuffs_base__u64__byte_swapped(uint64_t x) {
+#if defined(__GNUC__)
+  return __builtin_bswap64(x);
+#else
+  static const uint64_t mask8 = 0x00FF00FF00FF00FF;
+  static const uint64_t mask16 = 0x0000FFFF0000FFFF;
+  x = ((x >> 8) & mask8) | ((x & mask8) << 8);
+  x = ((x >> 16) & mask16) | ((x & mask16) << 16);
+  return (x >> 32) | (x << 32);
+#endif
+}
+
+// ---------------- Slices and Tables
+
+// WUFFS_BASE__SLICE is a 1-dimensional buffer.
+//
+// len measures a number of elements, not necessarily a size in bytes.
+//
+// A value with all fields NULL or zero is a valid, empty slice.
+#define WUFFS_BASE__SLICE(T) \
+  struct {                   \
+    T* ptr;                  \
+    size_t len;              \
+  }
+
+// WUFFS_BASE__TABLE is a 2-dimensional buffer.
+//
+// width height, and stride measure a number of elements, not necessarily a
+// size in bytes.
+//
+// A value with all fields NULL or zero is a valid, empty table.
+#define WUFFS_BASE__TABLE(T) \
+  struct {                   \
+    T* ptr;                  \
+    size_t width;            \
+    size_t height;           \
+    size_t stride;           \
+  }
+
+typedef WUFFS_BASE__SLICE(uint8_t) wuffs_base__slice_u8;
+typedef WUFFS_BASE__SLICE(uint16_t) wuffs_base__slice_u16;
+typedef WUFFS_BASE__SLICE(uint32_t) wuffs_base__slice_u32;
+typedef WUFFS_BASE__SLICE(uint64_t) wuffs_base__slice_u64;
+
+typedef WUFFS_BASE__TABLE(uint8_t) wuffs_base__table_u8;
+typedef WUFFS_BASE__TABLE(uint16_t) wuffs_base__table_u16;
+typedef WUFFS_BASE__TABLE(uint32_t) wuffs_base__table_u32;
+typedef WUFFS_BASE__TABLE(uint64_t) wuffs_base__table_u64;
+
+// wuffs_base__slice_u8__subslice_i returns s[i:].
+//
+// It returns an empty slice if i is out of bounds.
+static inline wuffs_base__slice_u8  //
+wuffs_base__slice_u8__subslice_i(wuffs_base__slice_u8 s, uint64_t i) {
+  if ((i <= SIZE_MAX) && (i <= s.len)) {
+    return ((wuffs_base__slice_u8){
+        .ptr = s.ptr + i,
+        .len = s.len - i,
+    });
+  }
+  return ((wuffs_base__slice_u8){});
+}
+
+// wuffs_base__slice_u8__subslice_j returns s[:j].
+//
+// It returns an empty slice if j is out of bounds.
+static inline wuffs_base__slice_u8  //
+wuffs_base__slice_u8__subslice_j(wuffs_base__slice_u8 s, uint64_t j) {
+  if ((j <= SIZE_MAX) && (j <= s.len)) {
+    return ((wuffs_base__slice_u8){
+        .ptr = s.ptr,
+        .len = j,
+    });
+  }
+  return ((wuffs_base__slice_u8){});
+}
+
+// wuffs_base__slice_u8__subslice_ij returns s[i:j].
+//
+// It returns an empty slice if i or j is out of bounds.
+static inline wuffs_base__slice_u8  //
+wuffs_base__slice_u8__subslice_ij(wuffs_base__slice_u8 s,
+                                  uint64_t i,
+                                  uint64_t j) {
+  if ((i <= j) && (j <= SIZE_MAX) && (j <= s.len)) {
+    return ((wuffs_base__slice_u8){
+        .ptr = s.ptr + i,
+        .len = j - i,
+    });
+  }
+  return ((wuffs_base__slice_u8){});
+}
+
+// ---------------- Ranges and Rects
+
+// Ranges are either inclusive ("range_ii") or exclusive ("range_ie") on the
+// high end. Both the "ii" and "ie" flavors are useful in practice.
+//
+// The "ei" and "ee" flavors also exist in theory, but aren't widely used. In
+// Wuffs, the low end is always inclusive.
+//
+// The "ii" (closed interval) flavor is useful when refining e.g. "the set of
+// all uint32_t values" to a contiguous subset: "uint32_t values in the closed
+// interval [M, N]", for uint32_t values M and N. An unrefined type (in other
+// words, the set of all uint32_t values) is not representable in the "ie"
+// flavor because if N equals ((1<<32) - 1) then (N + 1) will overflow.
+//
+// On the other hand, the "ie" (half-open interval) flavor is recommended by
+// Dijkstra's "Why numbering should start at zero" at
+// http://www.cs.utexas.edu/users/EWD/ewd08xx/EWD831.PDF and a further
+// discussion of motivating rationale is at
+// https://www.quora.com/Why-are-Python-ranges-half-open-exclusive-instead-of-closed-inclusive
+//
+// For example, with "ie", the number of elements in "uint32_t values in the
+// half-open interval [M, N)" is equal to max(0, N-M). Furthermore, that number
+// of elements (in one dimension, a length, in two dimensions, a width or
+// height) is itself representable as a uint32_t without overflow, again for
+// uint32_t values M and N. In the contrasting "ii" flavor, the length of the
+// closed interval [0, (1<<32) - 1] is 1<<32, which cannot be represented as a
+// uint32_t. In Wuffs, because of this potential overflow, the "ie" flavor has
+// length / width / height methods, but the "ii" flavor does not.
+//
+// It is valid for min > max (for range_ii) or for min >= max (for range_ie),
+// in which case the range is empty. There are multiple representations of an
+// empty range.
+
+typedef struct wuffs_base__range_ii_u32__struct {
+  uint32_t min_incl;
+  uint32_t max_incl;
+
+#ifdef __cplusplus
+  inline bool is_empty();
+  inline bool equals(wuffs_base__range_ii_u32__struct s);
+  inline bool contains(uint32_t x);
+  inline wuffs_base__range_ii_u32__struct intersect(
+      wuffs_base__range_ii_u32__struct s);
+  inline wuffs_base__range_ii_u32__struct unite(
+      wuffs_base__range_ii_u32__struct s);
+#endif  // __cplusplus
+
+} wuffs_base__range_ii_u32;
+
+static inline bool  //
+wuffs_base__range_ii_u32__is_empty(wuffs_base__range_ii_u32* r) {
+  return r->min_incl > r->max_incl;
+}
+
+static inline bool  //
+wuffs_base__range_ii_u32__equals(wuffs_base__range_ii_u32* r,
+                                 wuffs_base__range_ii_u32 s) {
+  return (r->min_incl == s.min_incl && r->max_incl == s.max_incl) ||
+         (wuffs_base__range_ii_u32__is_empty(r) &&
+          wuffs_base__range_ii_u32__is_empty(&s));
+}
+
+static inline bool  //
+wuffs_base__range_ii_u32__contains(wuffs_base__range_ii_u32* r, uint32_t x) {
+  return (r->min_incl <= x) && (x <= r->max_incl);
+}
+
+static inline  //
+    wuffs_base__range_ii_u32
+    wuffs_base__range_ii_u32__intersect(wuffs_base__range_ii_u32* r,
+                                        wuffs_base__range_ii_u32 s) {
+  wuffs_base__range_ii_u32 t;
+  t.min_incl = wuffs_base__u32__max(r->min_incl, s.min_incl);
+  t.max_incl = wuffs_base__u32__min(r->max_incl, s.max_incl);
+  return t;
+}
+
+static inline  //
+    wuffs_base__range_ii_u32
+    wuffs_base__range_ii_u32__unite(wuffs_base__range_ii_u32* r,
+                                    wuffs_base__range_ii_u32 s) {
+  if (wuffs_base__range_ii_u32__is_empty(r)) {
+    return s;
+  }
+  if (wuffs_base__range_ii_u32__is_empty(&s)) {
+    return *r;
+  }
+  wuffs_base__range_ii_u32 t;
+  t.min_incl = wuffs_base__u32__min(r->min_incl, s.min_incl);
+  t.max_incl = wuffs_base__u32__max(r->max_incl, s.max_incl);
+  return t;
+}
+
+#ifdef __cplusplus
+
+inline bool  //
+wuffs_base__range_ii_u32::is_empty() {
+  return wuffs_base__range_ii_u32__is_empty(this);
+}
+
+inline bool  //
+wuffs_base__range_ii_u32::equals(wuffs_base__range_ii_u32 s) {
+  return wuffs_base__range_ii_u32__equals(this, s);
+}
+
+inline bool  //
+wuffs_base__range_ii_u32::contains(uint32_t x) {
+  return wuffs_base__range_ii_u32__contains(this, x);
+}
+
+inline wuffs_base__range_ii_u32  //
+wuffs_base__range_ii_u32::intersect(wuffs_base__range_ii_u32 s) {
+  return wuffs_base__range_ii_u32__intersect(this, s);
+}
+
+inline wuffs_base__range_ii_u32  //
+wuffs_base__range_ii_u32::unite(wuffs_base__range_ii_u32 s) {
+  return wuffs_base__range_ii_u32__unite(this, s);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+typedef struct wuffs_base__range_ie_u32__struct {
+  uint32_t min_incl;
+  uint32_t max_excl;
+
+#ifdef __cplusplus
+  inline bool is_empty();
+  inline bool equals(wuffs_base__range_ie_u32__struct s);
+  inline bool contains(uint32_t x);
+  inline wuffs_base__range_ie_u32__struct intersect(
+      wuffs_base__range_ie_u32__struct s);
+  inline wuffs_base__range_ie_u32__struct unite(
+      wuffs_base__range_ie_u32__struct s);
+  inline uint32_t length();
+#endif  // __cplusplus
+
+} wuffs_base__range_ie_u32;
+
+static inline bool  //
+wuffs_base__range_ie_u32__is_empty(wuffs_base__range_ie_u32* r) {
+  return r->min_incl >= r->max_excl;
+}
+
+static inline bool  //
+wuffs_base__range_ie_u32__equals(wuffs_base__range_ie_u32* r,
+                                 wuffs_base__range_ie_u32 s) {
+  return (r->min_incl == s.min_incl && r->max_excl == s.max_excl) ||
+         (wuffs_base__range_ie_u32__is_empty(r) &&
+          wuffs_base__range_ie_u32__is_empty(&s));
+}
+
+static inline bool  //
+wuffs_base__range_ie_u32__contains(wuffs_base__range_ie_u32* r, uint32_t x) {
+  return (r->min_incl <= x) && (x < r->max_excl);
+}
+
+static inline wuffs_base__range_ie_u32  //
+wuffs_base__range_ie_u32__intersect(wuffs_base__range_ie_u32* r,
+                                    wuffs_base__range_ie_u32 s) {
+  wuffs_base__range_ie_u32 t;
+  t.min_incl = wuffs_base__u32__max(r->min_incl, s.min_incl);
+  t.max_excl = wuffs_base__u32__min(r->max_excl, s.max_excl);
+  return t;
+}
+
+static inline wuffs_base__range_ie_u32  //
+wuffs_base__range_ie_u32__unite(wuffs_base__range_ie_u32* r,
+                                wuffs_base__range_ie_u32 s) {
+  if (wuffs_base__range_ie_u32__is_empty(r)) {
+    return s;
+  }
+  if (wuffs_base__range_ie_u32__is_empty(&s)) {
+    return *r;
+  }
+  wuffs_base__range_ie_u32 t;
+  t.min_incl = wuffs_base__u32__min(r->min_incl, s.min_incl);
+  t.max_excl = wuffs_base__u32__max(r->max_excl, s.max_excl);
+  return t;
+}
+
+static inline uint32_t  //
+wuffs_base__range_ie_u32__length(wuffs_base__range_ie_u32* r) {
+  return wuffs_base__u32__sat_sub(r->max_excl, r->min_incl);
+}
+
+#ifdef __cplusplus
+
+inline bool  //
+wuffs_base__range_ie_u32::is_empty() {
+  return wuffs_base__range_ie_u32__is_empty(this);
+}
+
+inline bool  //
+wuffs_base__range_ie_u32::equals(wuffs_base__range_ie_u32 s) {
+  return wuffs_base__range_ie_u32__equals(this, s);
+}
+
+inline bool  //
+wuffs_base__range_ie_u32::contains(uint32_t x) {
+  return wuffs_base__range_ie_u32__contains(this, x);
+}
+
+inline wuffs_base__range_ie_u32  //
+wuffs_base__range_ie_u32::intersect(wuffs_base__range_ie_u32 s) {
+  return wuffs_base__range_ie_u32__intersect(this, s);
+}
+
+inline wuffs_base__range_ie_u32  //
+wuffs_base__range_ie_u32::unite(wuffs_base__range_ie_u32 s) {
+  return wuffs_base__range_ie_u32__unite(this, s);
+}
+
+inline uint32_t  //
+wuffs_base__range_ie_u32::length() {
+  return wuffs_base__range_ie_u32__length(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+typedef struct wuffs_base__range_ii_u64__struct {
+  uint64_t min_incl;
+  uint64_t max_incl;
+
+#ifdef __cplusplus
+  inline bool is_empty();
+  inline bool equals(wuffs_base__range_ii_u64__struct s);
+  inline bool contains(uint64_t x);
+  inline wuffs_base__range_ii_u64__struct intersect(
+      wuffs_base__range_ii_u64__struct s);
+  inline wuffs_base__range_ii_u64__struct unite(
+      wuffs_base__range_ii_u64__struct s);
+#endif  // __cplusplus
+
+} wuffs_base__range_ii_u64;
+
+static inline bool  //
+wuffs_base__range_ii_u64__is_empty(wuffs_base__range_ii_u64* r) {
+  return r->min_incl > r->max_incl;
+}
+
+static inline bool  //
+wuffs_base__range_ii_u64__equals(wuffs_base__range_ii_u64* r,
+                                 wuffs_base__range_ii_u64 s) {
+  return (r->min_incl == s.min_incl && r->max_incl == s.max_incl) ||
+         (wuffs_base__range_ii_u64__is_empty(r) &&
+          wuffs_base__range_ii_u64__is_empty(&s));
+}
+
+static inline bool  //
+wuffs_base__range_ii_u64__contains(wuffs_base__range_ii_u64* r, uint64_t x) {
+  return (r->min_incl <= x) && (x <= r->max_incl);
+}
+
+static inline wuffs_base__range_ii_u64  //
+wuffs_base__range_ii_u64__intersect(wuffs_base__range_ii_u64* r,
+                                    wuffs_base__range_ii_u64 s) {
+  wuffs_base__range_ii_u64 t;
+  t.min_incl = wuffs_base__u64__max(r->min_incl, s.min_incl);
+  t.max_incl = wuffs_base__u64__min(r->max_incl, s.max_incl);
+  return t;
+}
+
+static inline wuffs_base__range_ii_u64  //
+wuffs_base__range_ii_u64__unite(wuffs_base__range_ii_u64* r,
+                                wuffs_base__range_ii_u64 s) {
+  if (wuffs_base__range_ii_u64__is_empty(r)) {
+    return s;
+  }
+  if (wuffs_base__range_ii_u64__is_empty(&s)) {
+    return *r;
+  }
+  wuffs_base__range_ii_u64 t;
+  t.min_incl = wuffs_base__u64__min(r->min_incl, s.min_incl);
+  t.max_incl = wuffs_base__u64__max(r->max_incl, s.max_incl);
+  return t;
+}
+
+#ifdef __cplusplus
+
+inline bool  //
+wuffs_base__range_ii_u64::is_empty() {
+  return wuffs_base__range_ii_u64__is_empty(this);
+}
+
+inline bool  //
+wuffs_base__range_ii_u64::equals(wuffs_base__range_ii_u64 s) {
+  return wuffs_base__range_ii_u64__equals(this, s);
+}
+
+inline bool  //
+wuffs_base__range_ii_u64::contains(uint64_t x) {
+  return wuffs_base__range_ii_u64__contains(this, x);
+}
+
+inline wuffs_base__range_ii_u64  //
+wuffs_base__range_ii_u64::intersect(wuffs_base__range_ii_u64 s) {
+  return wuffs_base__range_ii_u64__intersect(this, s);
+}
+
+inline wuffs_base__range_ii_u64  //
+wuffs_base__range_ii_u64::unite(wuffs_base__range_ii_u64 s) {
+  return wuffs_base__range_ii_u64__unite(this, s);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+typedef struct wuffs_base__range_ie_u64__struct {
+  uint64_t min_incl;
+  uint64_t max_excl;
+
+#ifdef __cplusplus
+  inline bool is_empty();
+  inline bool equals(wuffs_base__range_ie_u64__struct s);
+  inline bool contains(uint64_t x);
+  inline wuffs_base__range_ie_u64__struct intersect(
+      wuffs_base__range_ie_u64__struct s);
+  inline wuffs_base__range_ie_u64__struct unite(
+      wuffs_base__range_ie_u64__struct s);
+  inline uint64_t length();
+#endif  // __cplusplus
+
+} wuffs_base__range_ie_u64;
+
+static inline bool  //
+wuffs_base__range_ie_u64__is_empty(wuffs_base__range_ie_u64* r) {
+  return r->min_incl >= r->max_excl;
+}
+
+static inline bool  //
+wuffs_base__range_ie_u64__equals(wuffs_base__range_ie_u64* r,
+                                 wuffs_base__range_ie_u64 s) {
+  return (r->min_incl == s.min_incl && r->max_excl == s.max_excl) ||
+         (wuffs_base__range_ie_u64__is_empty(r) &&
+          wuffs_base__range_ie_u64__is_empty(&s));
+}
+
+static inline bool  //
+wuffs_base__range_ie_u64__contains(wuffs_base__range_ie_u64* r, uint64_t x) {
+  return (r->min_incl <= x) && (x < r->max_excl);
+}
+
+static inline wuffs_base__range_ie_u64  //
+wuffs_base__range_ie_u64__intersect(wuffs_base__range_ie_u64* r,
+                                    wuffs_base__range_ie_u64 s) {
+  wuffs_base__range_ie_u64 t;
+  t.min_incl = wuffs_base__u64__max(r->min_incl, s.min_incl);
+  t.max_excl = wuffs_base__u64__min(r->max_excl, s.max_excl);
+  return t;
+}
+
+static inline wuffs_base__range_ie_u64  //
+wuffs_base__range_ie_u64__unite(wuffs_base__range_ie_u64* r,
+                                wuffs_base__range_ie_u64 s) {
+  if (wuffs_base__range_ie_u64__is_empty(r)) {
+    return s;
+  }
+  if (wuffs_base__range_ie_u64__is_empty(&s)) {
+    return *r;
+  }
+  wuffs_base__range_ie_u64 t;
+  t.min_incl = wuffs_base__u64__min(r->min_incl, s.min_incl);
+  t.max_excl = wuffs_base__u64__max(r->max_excl, s.max_excl);
+  return t;
+}
+
+static inline uint64_t  //
+wuffs_base__range_ie_u64__length(wuffs_base__range_ie_u64* r) {
+  return wuffs_base__u64__sat_sub(r->max_excl, r->min_incl);
+}
+
+#ifdef __cplusplus
+
+inline bool  //
+wuffs_base__range_ie_u64::is_empty() {
+  return wuffs_base__range_ie_u64__is_empty(this);
+}
+
+inline bool  //
+wuffs_base__range_ie_u64::equals(wuffs_base__range_ie_u64 s) {
+  return wuffs_base__range_ie_u64__equals(this, s);
+}
+
+inline bool  //
+wuffs_base__range_ie_u64::contains(uint64_t x) {
+  return wuffs_base__range_ie_u64__contains(this, x);
+}
+
+inline wuffs_base__range_ie_u64  //
+wuffs_base__range_ie_u64::intersect(wuffs_base__range_ie_u64 s) {
+  return wuffs_base__range_ie_u64__intersect(this, s);
+}
+
+inline wuffs_base__range_ie_u64  //
+wuffs_base__range_ie_u64::unite(wuffs_base__range_ie_u64 s) {
+  return wuffs_base__range_ie_u64__unite(this, s);
+}
+
+inline uint64_t  //
+wuffs_base__range_ie_u64::length() {
+  return wuffs_base__range_ie_u64__length(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__rect_ii_u32 is a rectangle (a 2-dimensional range) on the
+// integer grid. The "ii" means that the bounds are inclusive on the low end
+// and inclusive on the high end. It contains all points (x, y) such that
+// ((min_incl_x <= x) && (x <= max_incl_x)) and likewise for y.
+//
+// It is valid for min > max, in which case the rectangle is empty. There are
+// multiple representations of an empty rectangle.
+//
+// The X and Y axes increase right and down.
+typedef struct wuffs_base__rect_ii_u32__struct {
+  uint32_t min_incl_x;
+  uint32_t min_incl_y;
+  uint32_t max_incl_x;
+  uint32_t max_incl_y;
+
+#ifdef __cplusplus
+  inline bool is_empty();
+  inline bool equals(wuffs_base__rect_ii_u32__struct s);
+  inline bool contains(uint32_t x, uint32_t y);
+  inline wuffs_base__rect_ii_u32__struct intersect(
+      wuffs_base__rect_ii_u32__struct s);
+  inline wuffs_base__rect_ii_u32__struct unite(
+      wuffs_base__rect_ii_u32__struct s);
+#endif  // __cplusplus
+
+} wuffs_base__rect_ii_u32;
+
+static inline bool  //
+wuffs_base__rect_ii_u32__is_empty(wuffs_base__rect_ii_u32* r) {
+  return (r->min_incl_x > r->max_incl_x) || (r->min_incl_y > r->max_incl_y);
+}
+
+static inline bool  //
+wuffs_base__rect_ii_u32__equals(wuffs_base__rect_ii_u32* r,
+                                wuffs_base__rect_ii_u32 s) {
+  return (r->min_incl_x == s.min_incl_x && r->min_incl_y == s.min_incl_y &&
+          r->max_incl_x == s.max_incl_x && r->max_incl_y == s.max_incl_y) ||
+         (wuffs_base__rect_ii_u32__is_empty(r) &&
+          wuffs_base__rect_ii_u32__is_empty(&s));
+}
+
+static inline bool  //
+wuffs_base__rect_ii_u32__contains(wuffs_base__rect_ii_u32* r,
+                                  uint32_t x,
+                                  uint32_t y) {
+  return (r->min_incl_x <= x) && (x <= r->max_incl_x) && (r->min_incl_y <= y) &&
+         (y <= r->max_incl_y);
+}
+
+static inline wuffs_base__rect_ii_u32  //
+wuffs_base__rect_ii_u32__intersect(wuffs_base__rect_ii_u32* r,
+                                   wuffs_base__rect_ii_u32 s) {
+  wuffs_base__rect_ii_u32 t;
+  t.min_incl_x = wuffs_base__u32__max(r->min_incl_x, s.min_incl_x);
+  t.min_incl_y = wuffs_base__u32__max(r->min_incl_y, s.min_incl_y);
+  t.max_incl_x = wuffs_base__u32__min(r->max_incl_x, s.max_incl_x);
+  t.max_incl_y = wuffs_base__u32__min(r->max_incl_y, s.max_incl_y);
+  return t;
+}
+
+static inline wuffs_base__rect_ii_u32  //
+wuffs_base__rect_ii_u32__unite(wuffs_base__rect_ii_u32* r,
+                               wuffs_base__rect_ii_u32 s) {
+  if (wuffs_base__rect_ii_u32__is_empty(r)) {
+    return s;
+  }
+  if (wuffs_base__rect_ii_u32__is_empty(&s)) {
+    return *r;
+  }
+  wuffs_base__rect_ii_u32 t;
+  t.min_incl_x = wuffs_base__u32__min(r->min_incl_x, s.min_incl_x);
+  t.min_incl_y = wuffs_base__u32__min(r->min_incl_y, s.min_incl_y);
+  t.max_incl_x = wuffs_base__u32__max(r->max_incl_x, s.max_incl_x);
+  t.max_incl_y = wuffs_base__u32__max(r->max_incl_y, s.max_incl_y);
+  return t;
+}
+
+#ifdef __cplusplus
+
+inline bool  //
+wuffs_base__rect_ii_u32::is_empty() {
+  return wuffs_base__rect_ii_u32__is_empty(this);
+}
+
+inline bool  //
+wuffs_base__rect_ii_u32::equals(wuffs_base__rect_ii_u32 s) {
+  return wuffs_base__rect_ii_u32__equals(this, s);
+}
+
+inline bool  //
+wuffs_base__rect_ii_u32::contains(uint32_t x, uint32_t y) {
+  return wuffs_base__rect_ii_u32__contains(this, x, y);
+}
+
+inline wuffs_base__rect_ii_u32  //
+wuffs_base__rect_ii_u32::intersect(wuffs_base__rect_ii_u32 s) {
+  return wuffs_base__rect_ii_u32__intersect(this, s);
+}
+
+inline wuffs_base__rect_ii_u32  //
+wuffs_base__rect_ii_u32::unite(wuffs_base__rect_ii_u32 s) {
+  return wuffs_base__rect_ii_u32__unite(this, s);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__rect_ie_u32 is a rectangle (a 2-dimensional range) on the
+// integer grid. The "ie" means that the bounds are inclusive on the low end
+// and exclusive on the high end. It contains all points (x, y) such that
+// ((min_incl_x <= x) && (x < max_excl_x)) and likewise for y.
+//
+// It is valid for min >= max, in which case the rectangle is empty. There are
+// multiple representations of an empty rectangle, including a value with all
+// fields zero.
+//
+// The X and Y axes increase right and down.
+typedef struct wuffs_base__rect_ie_u32__struct {
+  uint32_t min_incl_x;
+  uint32_t min_incl_y;
+  uint32_t max_excl_x;
+  uint32_t max_excl_y;
+
+#ifdef __cplusplus
+  inline bool is_empty();
+  inline bool equals(wuffs_base__rect_ie_u32__struct s);
+  inline bool contains(uint32_t x, uint32_t y);
+  inline wuffs_base__rect_ie_u32__struct intersect(
+      wuffs_base__rect_ie_u32__struct s);
+  inline wuffs_base__rect_ie_u32__struct unite(
+      wuffs_base__rect_ie_u32__struct s);
+  inline uint32_t width();
+  inline uint32_t height();
+#endif  // __cplusplus
+
+} wuffs_base__rect_ie_u32;
+
+static inline bool  //
+wuffs_base__rect_ie_u32__is_empty(wuffs_base__rect_ie_u32* r) {
+  return (r->min_incl_x >= r->max_excl_x) || (r->min_incl_y >= r->max_excl_y);
+}
+
+static inline bool  //
+wuffs_base__rect_ie_u32__equals(wuffs_base__rect_ie_u32* r,
+                                wuffs_base__rect_ie_u32 s) {
+  return (r->min_incl_x == s.min_incl_x && r->min_incl_y == s.min_incl_y &&
+          r->max_excl_x == s.max_excl_x && r->max_excl_y == s.max_excl_y) ||
+         (wuffs_base__rect_ie_u32__is_empty(r) &&
+          wuffs_base__rect_ie_u32__is_empty(&s));
+}
+
+static inline bool  //
+wuffs_base__rect_ie_u32__contains(wuffs_base__rect_ie_u32* r,
+                                  uint32_t x,
+                                  uint32_t y) {
+  return (r->min_incl_x <= x) && (x < r->max_excl_x) && (r->min_incl_y <= y) &&
+         (y < r->max_excl_y);
+}
+
+static inline wuffs_base__rect_ie_u32  //
+wuffs_base__rect_ie_u32__intersect(wuffs_base__rect_ie_u32* r,
+                                   wuffs_base__rect_ie_u32 s) {
+  wuffs_base__rect_ie_u32 t;
+  t.min_incl_x = wuffs_base__u32__max(r->min_incl_x, s.min_incl_x);
+  t.min_incl_y = wuffs_base__u32__max(r->min_incl_y, s.min_incl_y);
+  t.max_excl_x = wuffs_base__u32__min(r->max_excl_x, s.max_excl_x);
+  t.max_excl_y = wuffs_base__u32__min(r->max_excl_y, s.max_excl_y);
+  return t;
+}
+
+static inline wuffs_base__rect_ie_u32  //
+wuffs_base__rect_ie_u32__unite(wuffs_base__rect_ie_u32* r,
+                               wuffs_base__rect_ie_u32 s) {
+  if (wuffs_base__rect_ie_u32__is_empty(r)) {
+    return s;
+  }
+  if (wuffs_base__rect_ie_u32__is_empty(&s)) {
+    return *r;
+  }
+  wuffs_base__rect_ie_u32 t;
+  t.min_incl_x = wuffs_base__u32__min(r->min_incl_x, s.min_incl_x);
+  t.min_incl_y = wuffs_base__u32__min(r->min_incl_y, s.min_incl_y);
+  t.max_excl_x = wuffs_base__u32__max(r->max_excl_x, s.max_excl_x);
+  t.max_excl_y = wuffs_base__u32__max(r->max_excl_y, s.max_excl_y);
+  return t;
+}
+
+static inline uint32_t  //
+wuffs_base__rect_ie_u32__width(wuffs_base__rect_ie_u32* r) {
+  return wuffs_base__u32__sat_sub(r->max_excl_x, r->min_incl_x);
+}
+
+static inline uint32_t  //
+wuffs_base__rect_ie_u32__height(wuffs_base__rect_ie_u32* r) {
+  return wuffs_base__u32__sat_sub(r->max_excl_y, r->min_incl_y);
+}
+
+#ifdef __cplusplus
+
+inline bool  //
+wuffs_base__rect_ie_u32::is_empty() {
+  return wuffs_base__rect_ie_u32__is_empty(this);
+}
+
+inline bool  //
+wuffs_base__rect_ie_u32::equals(wuffs_base__rect_ie_u32 s) {
+  return wuffs_base__rect_ie_u32__equals(this, s);
+}
+
+inline bool  //
+wuffs_base__rect_ie_u32::contains(uint32_t x, uint32_t y) {
+  return wuffs_base__rect_ie_u32__contains(this, x, y);
+}
+
+inline wuffs_base__rect_ie_u32  //
+wuffs_base__rect_ie_u32::intersect(wuffs_base__rect_ie_u32 s) {
+  return wuffs_base__rect_ie_u32__intersect(this, s);
+}
+
+inline wuffs_base__rect_ie_u32  //
+wuffs_base__rect_ie_u32::unite(wuffs_base__rect_ie_u32 s) {
+  return wuffs_base__rect_ie_u32__unite(this, s);
+}
+
+inline uint32_t  //
+wuffs_base__rect_ie_u32::width() {
+  return wuffs_base__rect_ie_u32__width(this);
+}
+
+inline uint32_t  //
+wuffs_base__rect_ie_u32::height() {
+  return wuffs_base__rect_ie_u32__height(this);
+}
+
+#endif  // __cplusplus
+
+// ---------------- I/O
+
+struct wuffs_base__io_buffer__struct;
+
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    struct wuffs_base__io_buffer__struct* buf;
+    // The bounds values are typically NULL, when created by the Wuffs public
+    // API. NULL means that the callee substitutes the implicit bounds derived
+    // from buf.
+    uint8_t* mark;
+    uint8_t* limit;
+  } private_impl;
+} wuffs_base__io_reader;
+
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    struct wuffs_base__io_buffer__struct* buf;
+    // The bounds values are typically NULL, when created by the Wuffs public
+    // API. NULL means that the callee substitutes the implicit bounds derived
+    // from buf.
+    uint8_t* mark;
+    uint8_t* limit;
+  } private_impl;
+} wuffs_base__io_writer;
+
+// wuffs_base__io_buffer_meta is the metadata for a wuffs_base__io_buffer's
+// data.
+typedef struct {
+  size_t wi;     // Write index. Invariant: wi <= len.
+  size_t ri;     // Read  index. Invariant: ri <= wi.
+  uint64_t pos;  // Position of the buffer start relative to the stream start.
+  bool closed;   // No further writes are expected.
+} wuffs_base__io_buffer_meta;
+
+// wuffs_base__io_buffer is a 1-dimensional buffer (a pointer and length) plus
+// additional metadata.
+//
+// A value with all fields zero is a valid, empty buffer.
+typedef struct wuffs_base__io_buffer__struct {
+  wuffs_base__slice_u8 data;
+  wuffs_base__io_buffer_meta meta;
+
+#ifdef __cplusplus
+  inline void compact();
+  inline wuffs_base__io_reader reader();
+  inline wuffs_base__io_writer writer();
+  inline uint64_t reader_io_position();
+  inline uint64_t writer_io_position();
+#endif  // __cplusplus
+
+} wuffs_base__io_buffer;
+
+// wuffs_base__io_buffer__compact moves any written but unread bytes to the
+// start of the buffer.
+static inline void  //
+wuffs_base__io_buffer__compact(wuffs_base__io_buffer* buf) {
+  if (!buf || (buf->meta.ri == 0)) {
+    return;
+  }
+  buf->meta.pos = wuffs_base__u64__sat_add(buf->meta.pos, buf->meta.ri);
+  size_t n = buf->meta.wi - buf->meta.ri;
+  if (n != 0) {
+    memmove(buf->data.ptr, buf->data.ptr + buf->meta.ri, n);
+  }
+  buf->meta.wi = n;
+  buf->meta.ri = 0;
+}
+
+static inline wuffs_base__io_reader  //
+wuffs_base__io_buffer__reader(wuffs_base__io_buffer* buf) {
+  wuffs_base__io_reader ret = ((wuffs_base__io_reader){});
+  ret.private_impl.buf = buf;
+  return ret;
+}
+
+static inline wuffs_base__io_writer  //
+wuffs_base__io_buffer__writer(wuffs_base__io_buffer* buf) {
+  wuffs_base__io_writer ret = ((wuffs_base__io_writer){});
+  ret.private_impl.buf = buf;
+  return ret;
+}
+
+static inline uint64_t  //
+wuffs_base__io_buffer__reader_io_position(wuffs_base__io_buffer* buf) {
+  return buf ? wuffs_base__u64__sat_add(buf->meta.pos, buf->meta.ri) : 0;
+}
+
+static inline uint64_t  //
+wuffs_base__io_buffer__writer_io_position(wuffs_base__io_buffer* buf) {
+  return buf ? wuffs_base__u64__sat_add(buf->meta.pos, buf->meta.wi) : 0;
+}
+
+#ifdef __cplusplus
+
+inline void  //
+wuffs_base__io_buffer__struct::compact() {
+  wuffs_base__io_buffer__compact(this);
+}
+
+inline wuffs_base__io_reader  //
+wuffs_base__io_buffer__struct::reader() {
+  return wuffs_base__io_buffer__reader(this);
+}
+
+inline wuffs_base__io_writer  //
+wuffs_base__io_buffer__struct::writer() {
+  return wuffs_base__io_buffer__writer(this);
+}
+
+inline uint64_t  //
+wuffs_base__io_buffer__struct::reader_io_position() {
+  return wuffs_base__io_buffer__reader_io_position(this);
+}
+
+inline uint64_t  //
+wuffs_base__io_buffer__struct::writer_io_position() {
+  return wuffs_base__io_buffer__writer_io_position(this);
+}
+
+#endif  // __cplusplus
+
+// ---------------- Memory Allocation
+
+// The memory allocation related functions in this section aren't used by Wuffs
+// per se, but they may be helpful to the code that uses Wuffs.
+
+// wuffs_base__malloc_slice_uxx wraps calling a malloc-like function, except
+// that it takes a uint64_t number of elements instead of a size_t size in
+// bytes, and it returns a slice (a pointer and a length) instead of just a
+// pointer.
+//
+// You can pass the C stdlib's malloc as the malloc_func.
+//
+// It returns an empty slice (containing a NULL ptr field) if (num_uxx *
+// sizeof(uintxx_t)) would overflow SIZE_MAX.
+
+static inline wuffs_base__slice_u8  //
+wuffs_base__malloc_slice_u8(void* (*malloc_func)(size_t), uint64_t num_u8) {
+  if (malloc_func && (num_u8 <= (SIZE_MAX / sizeof(uint8_t)))) {
+    void* p = (*malloc_func)(num_u8 * sizeof(uint8_t));
+    if (p) {
+      return ((wuffs_base__slice_u8){
+          .ptr = (uint8_t*)(p),
+          .len = num_u8,
+      });
+    }
+  }
+  return ((wuffs_base__slice_u8){});
+}
+
+static inline wuffs_base__slice_u16  //
+wuffs_base__malloc_slice_u16(void* (*malloc_func)(size_t), uint64_t num_u16) {
+  if (malloc_func && (num_u16 <= (SIZE_MAX / sizeof(uint16_t)))) {
+    void* p = (*malloc_func)(num_u16 * sizeof(uint16_t));
+    if (p) {
+      return ((wuffs_base__slice_u16){
+          .ptr = (uint16_t*)(p),
+          .len = num_u16,
+      });
+    }
+  }
+  return ((wuffs_base__slice_u16){});
+}
+
+static inline wuffs_base__slice_u32  //
+wuffs_base__malloc_slice_u32(void* (*malloc_func)(size_t), uint64_t num_u32) {
+  if (malloc_func && (num_u32 <= (SIZE_MAX / sizeof(uint32_t)))) {
+    void* p = (*malloc_func)(num_u32 * sizeof(uint32_t));
+    if (p) {
+      return ((wuffs_base__slice_u32){
+          .ptr = (uint32_t*)(p),
+          .len = num_u32,
+      });
+    }
+  }
+  return ((wuffs_base__slice_u32){});
+}
+
+static inline wuffs_base__slice_u64  //
+wuffs_base__malloc_slice_u64(void* (*malloc_func)(size_t), uint64_t num_u64) {
+  if (malloc_func && (num_u64 <= (SIZE_MAX / sizeof(uint64_t)))) {
+    void* p = (*malloc_func)(num_u64 * sizeof(uint64_t));
+    if (p) {
+      return ((wuffs_base__slice_u64){
+          .ptr = (uint64_t*)(p),
+          .len = num_u64,
+      });
+    }
+  }
+  return ((wuffs_base__slice_u64){});
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+// Copyright 2017 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---------------- Images
+
+// wuffs_base__color_u32argb is an 8 bit per channel Alpha, Red, Green, Blue
+// color, as a uint32_t value. It is in word order, not byte order: its value
+// is always 0xAARRGGBB, regardless of endianness. It uses premultiplied alpha.
+typedef uint32_t wuffs_base__color_u32argb;
+
+// --------
+
+// wuffs_base__pixel_format encodes the format of the bytes that constitute an
+// image frame's pixel data. Its bits:
+//  - bit        31  is reserved.
+//  - bits 30 .. 28 encodes color (and channel order, in terms of memory).
+//  - bits 27 .. 26 are reserved.
+//  - bits 25 .. 24 encodes transparency.
+//  - bits 23 .. 21 are reserved.
+//  - bit        20 indicates big-endian/MSB-first (as opposed to little/LSB).
+//  - bit        19 indicates floating point (as opposed to integer).
+//  - bit        18 indicates palette-indexed. The number-of-planes (the next
+//                  field) will be zero, as the format is considered packed,
+//                  but the 8-bit N-BGRA color data is stored in plane 3.
+//  - bits 17 .. 16 are the number of planes, minus 1. Zero means packed.
+//  - bits 15 .. 12 encodes the number of bits (depth) in the 3rd channel.
+//  - bits 11 ..  8 encodes the number of bits (depth) in the 2nd channel.
+//  - bits  7 ..  4 encodes the number of bits (depth) in the 1st channel.
+//  - bits  3 ..  0 encodes the number of bits (depth) in the 0th channel.
+//
+// The bit fields of a wuffs_base__pixel_format are not independent. For
+// example, the number of planes should not be greater than the number of
+// channels. Similarly, bits 15..4 are unused (and should be zero) if bits
+// 31..24 (color and transparency) together imply only 1 channel (gray, no
+// alpha) and floating point samples should mean a bit depth of 16, 32 or 64.
+//
+// Formats hold between 1 and 4 channels. For example: Y (1 channel: gray), YA
+// (2 channels: gray and alpha), BGR (3 channels: blue, green, red) or CMYK (4
+// channels: cyan, magenta, yellow, black).
+//
+// For direct formats with N > 1 channels, those channels can be laid out in
+// either 1 (packed) or N (planar) planes. For example, RGBA data is usually
+// packed, but YUV data is usually planar, due to chroma subsampling (for
+// details, see the wuffs_base__pixel_subsampling type).
+//
+// For indexed formats, the palette (always 256 × 4 bytes) holds 8 bits per
+// channel non-alpha-premultiplied BGRA color data. There is only 1 plane (for
+// the index), as the format is considered packed. Plane 0 holds the per-pixel
+// indices. Plane 3 is re-purposed to hold the per-index colors.
+//
+// The color field is encoded in 3 bits:
+//  - 0 means                 A (Alpha).
+//  - 1 means   Y       or   YA (Gray, Alpha).
+//  - 2 means BGR, BGRX or BGRA (Blue, Green, Red, X-padding or Alpha).
+//  - 3 means RGB, RGBX or RGBA (Red, Green, Blue, X-padding or Alpha).
+//  - 4 means YUV       or YUVA (Luma, Chroma-blue, Chroma-red, Alpha).
+//  - 5 means CMY       or CMYK (Cyan, Magenta, Yellow, Black).
+//  - all other values are reserved.
+//
+// In Wuffs, channels are given in memory order (also known as byte order),
+// regardless of endianness, since the C type for the pixel data is an array of
+// bytes, not an array of uint32_t. For example, packed BGRA with 8 bits per
+// channel means that the bytes in memory are always Blue, Green, Red then
+// Alpha. On big-endian systems, that is the uint32_t 0xBBGGRRAA. On
+// little-endian, 0xAARRGGBB.
+//
+// When the color field (3 bits) encodes multiple options, the transparency
+// field (2 bits) distinguishes them:
+//  - 0 means fully opaque, no extra channels
+//  - 1 means fully opaque, one extra channel (X or K, padding or black).
+//  - 2 means one extra alpha channel, other channels are non-premultiplied.
+//  - 3 means one extra alpha channel, other channels are     premultiplied.
+//
+// The zero wuffs_base__pixel_format value is an invalid pixel format, as it is
+// invalid to combine the zero color (alpha only) with the zero transparency.
+//
+// Bit depth is encoded in 4 bits:
+//  -  0 means the channel or index is unused.
+//  -  x means a bit depth of  x, for x in the range 1..8.
+//  -  9 means a bit depth of 10.
+//  - 10 means a bit depth of 12.
+//  - 11 means a bit depth of 16.
+//  - 12 means a bit depth of 24.
+//  - 13 means a bit depth of 32.
+//  - 14 means a bit depth of 48.
+//  - 15 means a bit depth of 64.
+//
+// For example, wuffs_base__pixel_format 0x3210BBBB is a natural format for
+// decoding a PNG image - network byte order (also known as big-endian),
+// packed, non-premultiplied alpha - that happens to be 16-bit-depth truecolor
+// with alpha (RGBA). In memory order:
+//
+//  ptr+0  ptr+1  ptr+2  ptr+3  ptr+4  ptr+5  ptr+6  ptr+7
+//  Rhi    Rlo    Ghi    Glo    Bhi    Blo    Ahi    Alo
+//
+// For example, the value wuffs_base__pixel_format 0x20000565 means BGR with no
+// alpha or padding, 5/6/5 bits for blue/green/red, packed 2 bytes per pixel,
+// laid out LSB-first in memory order:
+//
+//  ptr+0...........  ptr+1...........
+//  MSB          LSB  MSB          LSB
+//  G₂G₁G₀B₄B₃B₂B₁B₀  R₄R₃R₂R₁R₀G₅G₄G₃
+//
+// On little-endian systems (but not big-endian), this Wuffs pixel format value
+// (0x20000565) corresponds to the Cairo library's CAIRO_FORMAT_RGB16_565, the
+// SDL2 (Simple DirectMedia Layer 2) library's SDL_PIXELFORMAT_RGB565 and the
+// Skia library's kRGB_565_SkColorType. Note BGR in Wuffs versus RGB in the
+// other libraries.
+//
+// Regardless of endianness, this Wuffs pixel format value (0x20000565)
+// corresponds to the V4L2 (Video For Linux 2) library's V4L2_PIX_FMT_RGB565
+// and the Wayland-DRM library's WL_DRM_FORMAT_RGB565.
+//
+// Different software libraries name their pixel formats (and especially their
+// channel order) either according to memory layout or as bits of a native
+// integer type like uint32_t. The two conventions differ because of a system's
+// endianness. As mentioned earlier, Wuffs pixel formats are always in memory
+// order. More detail of other software libraries' naming conventions is in the
+// Pixel Format Guide at https://afrantzis.github.io/pixel-format-guide/
+//
+// Do not manipulate these bits directly; they are private implementation
+// details. Use methods such as wuffs_base__pixel_format__num_planes instead.
+typedef uint32_t wuffs_base__pixel_format;
+
+// Common 8-bit-depth pixel formats. This list is not exhaustive; not all valid
+// wuffs_base__pixel_format values are present.
+
+#define WUFFS_BASE__PIXEL_FORMAT__INVALID ((wuffs_base__pixel_format)0x00000000)
+
+#define WUFFS_BASE__PIXEL_FORMAT__A ((wuffs_base__pixel_format)0x02000008)
+
+#define WUFFS_BASE__PIXEL_FORMAT__Y ((wuffs_base__pixel_format)0x10000008)
+#define WUFFS_BASE__PIXEL_FORMAT__YA_NONPREMUL \
+  ((wuffs_base__pixel_format)0x12000008)
+#define WUFFS_BASE__PIXEL_FORMAT__YA_PREMUL \
+  ((wuffs_base__pixel_format)0x13000008)
+
+#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL \
+  ((wuffs_base__pixel_format)0x22040008)
+
+#define WUFFS_BASE__PIXEL_FORMAT__BGR ((wuffs_base__pixel_format)0x20000888)
+#define WUFFS_BASE__PIXEL_FORMAT__BGRX ((wuffs_base__pixel_format)0x21008888)
+#define WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL \
+  ((wuffs_base__pixel_format)0x22008888)
+#define WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL \
+  ((wuffs_base__pixel_format)0x23008888)
+
+#define WUFFS_BASE__PIXEL_FORMAT__RGB ((wuffs_base__pixel_format)0x30000888)
+#define WUFFS_BASE__PIXEL_FORMAT__RGBX ((wuffs_base__pixel_format)0x31008888)
+#define WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL \
+  ((wuffs_base__pixel_format)0x32008888)
+#define WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL \
+  ((wuffs_base__pixel_format)0x33008888)
+
+#define WUFFS_BASE__PIXEL_FORMAT__YUV ((wuffs_base__pixel_format)0x40020888)
+#define WUFFS_BASE__PIXEL_FORMAT__YUVK ((wuffs_base__pixel_format)0x41038888)
+#define WUFFS_BASE__PIXEL_FORMAT__YUVA_NONPREMUL \
+  ((wuffs_base__pixel_format)0x42038888)
+
+#define WUFFS_BASE__PIXEL_FORMAT__CMY ((wuffs_base__pixel_format)0x50020888)
+#define WUFFS_BASE__PIXEL_FORMAT__CMYK ((wuffs_base__pixel_format)0x51038888)
+
+static inline bool  //
+wuffs_base__pixel_format__is_valid(wuffs_base__pixel_format f) {
+  return f != 0;
+}
+
+static inline bool  //
+wuffs_base__pixel_format__is_indexed(wuffs_base__pixel_format f) {
+  return (f >> 18) & 0x01;
+}
+
+static inline uint32_t  //
+wuffs_base__pixel_format__num_planes(wuffs_base__pixel_format f) {
+  return f ? (((f >> 16) & 0x03) + 1) : 0;
+}
+
+// wuffs_base__pixel_format__bits_per_pixel returns the number of bits per
+// pixel of a packed (single plane) pixel format, including indexed formats. It
+// returns zero for planar or invalid formats.
+static inline uint32_t  //
+wuffs_base__pixel_format__bits_per_pixel(wuffs_base__pixel_format f) {
+  static const uint8_t depths[16] = {
+      0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 16, 24, 32, 48, 64,
+  };
+  if ((f == 0) || (((f >> 16) & 0x03) != 0)) {
+    return 0;
+  }
+  return depths[0x0F & (f >> 0)] + depths[0x0F & (f >> 4)] +
+         depths[0x0F & (f >> 8)] + depths[0x0F & (f >> 12)];
+}
+
+// wuffs_base__pixel_format__is_planar_8_bit returns whether f is a planar
+// (multiple plane) pixel format with 8 bits per sample in every plane, such as
+// WUFFS_BASE__PIXEL_FORMAT__YUV.
+static inline bool  //
+wuffs_base__pixel_format__is_planar_8_bit(wuffs_base__pixel_format f) {
+  uint32_t n = (f >> 16) & 0x03;
+  if ((n == 0) || ((f >> 18) & 0x01)) {
+    return false;
+  }
+  uint32_t p;
+  for (p = 0; p <= n; p++) {
+    if (((f >> (4 * p)) & 0x0F) != 8) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#define WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX 4
+
+#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__INDEX_PLANE 0
+#define WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE 3
+
+// --------
+
+// wuffs_base__pixel_subsampling encodes the mapping of pixel space coordinates
+// (x, y) to pixel buffer indices (i, j). That mapping can differ for each
+// plane p. For a depth of 8 bits (1 byte), the p'th plane's sample starts at
+// (planes[p].ptr + (j * planes[p].stride) + i).
+//
+// For packed pixel formats, the mapping is trivial: i = x and j = y. For
+// planar pixel formats, the mapping can differ due to chroma subsampling. For
+// example, consider a three plane YUV pixel format with 4:2:2 subsampling. For
+// the luma (Y) channel, there is one sample for every pixel, but for the
+// chroma (U, V) channels, there is one sample for every two pixels: pairs of
+// horizontally adjacent pixels form one macropixel, i = x / 2 and j == y. In
+// general, for a given p:
+//  - i = (x + bias_x) >> shift_x.
+//  - j = (y + bias_y) >> shift_y.
+// where biases and shifts are in the range 0..3 and 0..2 respectively.
+//
+// In general, the biases will be zero after decoding an image. However, making
+// a sub-image may change the bias, since the (x, y) coordinates are relative
+// to the sub-image's top-left origin, but the backing pixel buffers were
+// created relative to the original image's origin.
+//
+// For each plane p, each of those four numbers (biases and shifts) are encoded
+// in two bits, which combine to form an 8 bit unsigned integer:
+//
+//  e_p = (bias_x << 6) | (shift_x << 4) | (bias_y << 2) | (shift_y << 0)
+//
+// Those e_p values (e_0 for the first plane, e_1 for the second plane, etc)
+// combine to form a wuffs_base__pixel_subsampling value:
+//
+//  pixsub = (e_3 << 24) | (e_2 << 16) | (e_1 << 8) | (e_0 << 0)
+//
+// Do not manipulate these bits directly; they are private implementation
+// details. Use methods such as wuffs_base__pixel_subsampling__bias_x instead.
+typedef uint32_t wuffs_base__pixel_subsampling;
+
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__NONE ((wuffs_base__pixel_subsampling)0)
+
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__444 \
+  ((wuffs_base__pixel_subsampling)0x000000)
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__440 \
+  ((wuffs_base__pixel_subsampling)0x010100)
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__422 \
+  ((wuffs_base__pixel_subsampling)0x101000)
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__420 \
+  ((wuffs_base__pixel_subsampling)0x111100)
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__411 \
+  ((wuffs_base__pixel_subsampling)0x202000)
+#define WUFFS_BASE__PIXEL_SUBSAMPLING__410 \
+  ((wuffs_base__pixel_subsampling)0x212100)
+
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__bias_x(wuffs_base__pixel_subsampling s,
+                                      uint32_t plane) {
+  uint32_t shift = ((plane & 0x03) * 8) + 6;
+  return (s >> shift) & 0x03;
+}
+
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__shift_x(wuffs_base__pixel_subsampling s,
+                                       uint32_t plane) {
+  uint32_t shift = ((plane & 0x03) * 8) + 4;
+  return (s >> shift) & 0x03;
+}
+
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__bias_y(wuffs_base__pixel_subsampling s,
+                                      uint32_t plane) {
+  uint32_t shift = ((plane & 0x03) * 8) + 2;
+  return (s >> shift) & 0x03;
+}
+
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__shift_y(wuffs_base__pixel_subsampling s,
+                                       uint32_t plane) {
+  uint32_t shift = ((plane & 0x03) * 8) + 0;
+  return (s >> shift) & 0x03;
+}
+
+// wuffs_base__pixel_subsampling__plane_width returns the number of samples in
+// each row of the p'th plane, for an image that is width pixels wide.
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__plane_width(wuffs_base__pixel_subsampling s,
+                                           uint32_t plane,
+                                           uint32_t width) {
+  if (width == 0) {
+    return 0;
+  }
+  return ((width - 1 + wuffs_base__pixel_subsampling__bias_x(s, plane)) >>
+          wuffs_base__pixel_subsampling__shift_x(s, plane)) +
+         1;
+}
+
+// wuffs_base__pixel_subsampling__plane_height returns the number of rows in
+// the p'th plane, for an image that is height pixels high.
+static inline uint32_t  //
+wuffs_base__pixel_subsampling__plane_height(wuffs_base__pixel_subsampling s,
+                                            uint32_t plane,
+                                            uint32_t height) {
+  if (height == 0) {
+    return 0;
+  }
+  return ((height - 1 + wuffs_base__pixel_subsampling__bias_y(s, plane)) >>
+          wuffs_base__pixel_subsampling__shift_y(s, plane)) +
+         1;
+}
+
+// --------
+
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    wuffs_base__pixel_format pixfmt;
+    wuffs_base__pixel_subsampling pixsub;
+    uint32_t width;
+    uint32_t height;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline void initialize(wuffs_base__pixel_format pixfmt,
+                         wuffs_base__pixel_subsampling pixsub,
+                         uint32_t width,
+                         uint32_t height);
+  inline void invalidate();
+  inline bool is_valid();
+  inline wuffs_base__pixel_format pixel_format();
+  inline wuffs_base__pixel_subsampling pixel_subsampling();
+  inline wuffs_base__rect_ie_u32 bounds();
+  inline uint32_t width();
+  inline uint32_t height();
+  inline uint64_t pixbuf_len();
+#endif  // __cplusplus
+
+} wuffs_base__pixel_config;
+
+// TODO: Should this function return bool? An error type?
+static inline void  //
+wuffs_base__pixel_config__initialize(wuffs_base__pixel_config* c,
+                                     wuffs_base__pixel_format pixfmt,
+                                     wuffs_base__pixel_subsampling pixsub,
+                                     uint32_t width,
+                                     uint32_t height) {
+  if (!c) {
+    return;
+  }
+  if (pixfmt) {
+    uint64_t wh = ((uint64_t)width) * ((uint64_t)height);
+    // TODO: handle fractional bytes per pixel.
+    uint64_t bytes_per_pixel =
+        wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8;
+    if (wuffs_base__pixel_format__is_planar_8_bit(pixfmt)) {
+      // Subsampled planes are no larger than the first plane.
+      bytes_per_pixel = wuffs_base__pixel_format__num_planes(pixfmt);
+    } else if (bytes_per_pixel == 0) {
+      bytes_per_pixel = 1;
+    }
+    if (wh <= (((uint64_t)SIZE_MAX) / bytes_per_pixel)) {
+      c->private_impl.pixfmt = pixfmt;
+      c->private_impl.pixsub = pixsub;
+      c->private_impl.width = width;
+      c->private_impl.height = height;
+      return;
+    }
+  }
+  *c = ((wuffs_base__pixel_config){});
+}
+
+static inline void  //
+wuffs_base__pixel_config__invalidate(wuffs_base__pixel_config* c) {
+  if (c) {
+    *c = ((wuffs_base__pixel_config){});
+  }
+}
+
+static inline bool  //
+wuffs_base__pixel_config__is_valid(wuffs_base__pixel_config* c) {
+  return c && c->private_impl.pixfmt;
+}
+
+static inline wuffs_base__pixel_format  //
+wuffs_base__pixel_config__pixel_format(wuffs_base__pixel_config* c) {
+  return c ? c->private_impl.pixfmt : 0;
+}
+
+static inline wuffs_base__pixel_subsampling  //
+wuffs_base__pixel_config__pixel_subsampling(wuffs_base__pixel_config* c) {
+  return c ? c->private_impl.pixsub : 0;
+}
+
+static inline wuffs_base__rect_ie_u32  //
+wuffs_base__pixel_config__bounds(wuffs_base__pixel_config* c) {
+  return c ? ((wuffs_base__rect_ie_u32){
+                 .min_incl_x = 0,
+                 .min_incl_y = 0,
+                 .max_excl_x = c->private_impl.width,
+                 .max_excl_y = c->private_impl.height,
+             })
+           : ((wuffs_base__rect_ie_u32){});
+}
+
+static inline uint32_t  //
+wuffs_base__pixel_config__width(wuffs_base__pixel_config* c) {
+  return c ? c->private_impl.width : 0;
+}
+
+static inline uint32_t  //
+wuffs_base__pixel_config__height(wuffs_base__pixel_config* c) {
+  return c ? c->private_impl.height : 0;
+}
+
+// wuffs_base__pixel_config__pixbuf_len returns the number of bytes needed by
+// wuffs_base__pixel_buffer__set_from_slice. For planar formats, such as
+// WUFFS_BASE__PIXEL_FORMAT__YUV, that is the sum of each (possibly
+// subsampled) plane's width times height.
+static inline uint64_t  //
+wuffs_base__pixel_config__pixbuf_len(wuffs_base__pixel_config* c) {
+  if (c && wuffs_base__pixel_format__is_planar_8_bit(c->private_impl.pixfmt)) {
+    uint64_t n = 0;
+    uint32_t num_planes =
+        wuffs_base__pixel_format__num_planes(c->private_impl.pixfmt);
+    uint32_t p;
+    for (p = 0; p < num_planes; p++) {
+      n += ((uint64_t)wuffs_base__pixel_subsampling__plane_width(
+               c->private_impl.pixsub, p, c->private_impl.width)) *
+           ((uint64_t)wuffs_base__pixel_subsampling__plane_height(
+               c->private_impl.pixsub, p, c->private_impl.height));
+    }
+    return n;
+  } else if (c) {
+    uint64_t n =
+        ((uint64_t)c->private_impl.width) * ((uint64_t)c->private_impl.height);
+    // TODO: handle planar formats and fractional bytes per pixel. Consider
+    // that the +1024 below could overflow.
+    uint64_t bytes_per_pixel =
+        wuffs_base__pixel_format__bits_per_pixel(c->private_impl.pixfmt) / 8;
+    if (bytes_per_pixel > 1) {
+      n *= bytes_per_pixel;
+    }
+    if (wuffs_base__pixel_format__is_indexed(c->private_impl.pixfmt)) {
+      n += 1024;
+    }
+    return n;
+  }
+  return 0;
+}
+
+#ifdef __cplusplus
+
+inline void  //
+wuffs_base__pixel_config::initialize(wuffs_base__pixel_format pixfmt,
+                                     wuffs_base__pixel_subsampling pixsub,
+                                     uint32_t width,
+                                     uint32_t height) {
+  wuffs_base__pixel_config__initialize(this, pixfmt, pixsub, width, height);
+}
+
+inline void  //
+wuffs_base__pixel_config::invalidate() {
+  wuffs_base__pixel_config__invalidate(this);
+}
+
+inline bool  //
+wuffs_base__pixel_config::is_valid() {
+  return wuffs_base__pixel_config__is_valid(this);
+}
+
+inline wuffs_base__pixel_format  //
+wuffs_base__pixel_config::pixel_format() {
+  return wuffs_base__pixel_config__pixel_format(this);
+}
+
+inline wuffs_base__pixel_subsampling  //
+wuffs_base__pixel_config::pixel_subsampling() {
+  return wuffs_base__pixel_config__pixel_subsampling(this);
+}
+
+inline wuffs_base__rect_ie_u32  //
+wuffs_base__pixel_config::bounds() {
+  return wuffs_base__pixel_config__bounds(this);
+}
+
+inline uint32_t  //
+wuffs_base__pixel_config::width() {
+  return wuffs_base__pixel_config__width(this);
+}
+
+inline uint32_t  //
+wuffs_base__pixel_config::height() {
+  return wuffs_base__pixel_config__height(this);
+}
+
+inline uint64_t  //
+wuffs_base__pixel_config::pixbuf_len() {
+  return wuffs_base__pixel_config__pixbuf_len(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+typedef struct {
+  wuffs_base__pixel_config pixcfg;
+
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    wuffs_base__range_ii_u64 workbuf_len;
+    uint64_t first_frame_io_position;
+    uint32_t num_loops;
+    bool first_frame_is_opaque;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline void initialize(wuffs_base__pixel_format pixfmt,
+                         wuffs_base__pixel_subsampling pixsub,
+                         uint32_t width,
+                         uint32_t height,
+                         uint64_t workbuf_len0,
+                         uint64_t workbuf_len1,
+                         uint32_t num_loops,
+                         uint64_t first_frame_io_position,
+                         bool first_frame_is_opaque);
+  inline void invalidate();
+  inline bool is_valid();
+  inline wuffs_base__range_ii_u64 workbuf_len();
+  inline uint32_t num_loops();
+  inline uint64_t first_frame_io_position();
+  inline bool first_frame_is_opaque();
+#endif  // __cplusplus
+
+} wuffs_base__image_config;
+
+// TODO: Should this function return bool? An error type?
+static inline void  //
+wuffs_base__image_config__initialize(wuffs_base__image_config* c,
+                                     wuffs_base__pixel_format pixfmt,
+                                     wuffs_base__pixel_subsampling pixsub,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     uint64_t workbuf_len0,
+                                     uint64_t workbuf_len1,
+                                     uint32_t num_loops,
+                                     uint64_t first_frame_io_position,
+                                     bool first_frame_is_opaque) {
+  if (!c) {
+    return;
+  }
+  if (wuffs_base__pixel_format__is_valid(pixfmt)) {
+    c->pixcfg.private_impl.pixfmt = pixfmt;
+    c->pixcfg.private_impl.pixsub = pixsub;
+    c->pixcfg.private_impl.width = width;
+    c->pixcfg.private_impl.height = height;
+    c->private_impl.workbuf_len.min_incl = workbuf_len0;
+    c->private_impl.workbuf_len.max_incl = workbuf_len1;
+    c->private_impl.first_frame_io_position = first_frame_io_position;
+    c->private_impl.num_loops = num_loops;
+    c->private_impl.first_frame_is_opaque = first_frame_is_opaque;
+    return;
+  }
+  *c = ((wuffs_base__image_config){});
+}
+
+static inline void  //
+wuffs_base__image_config__invalidate(wuffs_base__image_config* c) {
+  if (c) {
+    *c = ((wuffs_base__image_config){});
+  }
+}
+
+static inline bool  //
+wuffs_base__image_config__is_valid(wuffs_base__image_config* c) {
+  return c && wuffs_base__pixel_config__is_valid(&(c->pixcfg));
+}
+
+static inline wuffs_base__range_ii_u64  //
+wuffs_base__image_config__workbuf_len(wuffs_base__image_config* c) {
+  return c ? c->private_impl.workbuf_len : ((wuffs_base__range_ii_u64){});
+}
+
+static inline uint32_t  //
+wuffs_base__image_config__num_loops(wuffs_base__image_config* c) {
+  return c ? c->private_impl.num_loops : 0;
+}
+
+static inline uint64_t  //
+wuffs_base__image_config__first_frame_io_position(wuffs_base__image_config* c) {
+  return c ? c->private_impl.first_frame_io_position : 0;
+}
+
+static inline bool  //
+wuffs_base__image_config__first_frame_is_opaque(wuffs_base__image_config* c) {
+  return c ? c->private_impl.first_frame_is_opaque : false;
+}
+
+#ifdef __cplusplus
+
+inline void  //
+wuffs_base__image_config::initialize(wuffs_base__pixel_format pixfmt,
+                                     wuffs_base__pixel_subsampling pixsub,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     uint64_t workbuf_len0,
+                                     uint64_t workbuf_len1,
+                                     uint32_t num_loops,
+                                     uint64_t first_frame_io_position,
+                                     bool first_frame_is_opaque) {
+  wuffs_base__image_config__initialize(
+      this, pixfmt, pixsub, width, height, workbuf_len0, workbuf_len1,
+      num_loops, first_frame_io_position, first_frame_is_opaque);
+}
+
+inline void  //
+wuffs_base__image_config::invalidate() {
+  wuffs_base__image_config__invalidate(this);
+}
+
+inline bool  //
+wuffs_base__image_config::is_valid() {
+  return wuffs_base__image_config__is_valid(this);
+}
+
+inline wuffs_base__range_ii_u64  //
+wuffs_base__image_config::workbuf_len() {
+  return wuffs_base__image_config__workbuf_len(this);
+}
+
+inline uint32_t  //
+wuffs_base__image_config::num_loops() {
+  return wuffs_base__image_config__num_loops(this);
+}
+
+inline uint64_t  //
+wuffs_base__image_config::first_frame_io_position() {
+  return wuffs_base__image_config__first_frame_io_position(this);
+}
+
+inline bool  //
+wuffs_base__image_config::first_frame_is_opaque() {
+  return wuffs_base__image_config__first_frame_is_opaque(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__animation_blend encodes, for an animated image, how to blend the
+// transparent pixels of this frame with the existing canvas. In Porter-Duff
+// compositing operator terminology:
+//  - 0 means the frame may be transparent, and should be blended "src over
+//    dst", also known as just "over".
+//  - 1 means the frame may be transparent, and should be blended "src".
+//  - 2 means the frame is completely opaque, so that "src over dst" and "src"
+//    are equivalent.
+//
+// These semantics are conservative. It is valid for a completely opaque frame
+// to have a blend value other than 2.
+typedef uint8_t wuffs_base__animation_blend;
+
+#define WUFFS_BASE__ANIMATION_BLEND__SRC_OVER_DST \
+  ((wuffs_base__animation_blend)0)
+#define WUFFS_BASE__ANIMATION_BLEND__SRC ((wuffs_base__animation_blend)1)
+#define WUFFS_BASE__ANIMATION_BLEND__OPAQUE ((wuffs_base__animation_blend)2)
+
+// --------
+
+// wuffs_base__animation_disposal encodes, for an animated image, how to
+// dispose of a frame after displaying it:
+//  - None means to draw the next frame on top of this one.
+//  - Restore Background means to clear the frame's dirty rectangle to "the
+//    background color" (in practice, this means transparent black) before
+//    drawing the next frame.
+//  - Restore Previous means to undo the current frame, so that the next frame
+//    is drawn on top of the previous one.
+typedef uint8_t wuffs_base__animation_disposal;
+
+#define WUFFS_BASE__ANIMATION_DISPOSAL__NONE ((wuffs_base__animation_disposal)0)
+#define WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_BACKGROUND \
+  ((wuffs_base__animation_disposal)1)
+#define WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS \
+  ((wuffs_base__animation_disposal)2)
+
+// --------
+
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    wuffs_base__rect_ie_u32 bounds;
+    wuffs_base__flicks duration;
+    uint64_t index;
+    uint64_t io_position;
+    wuffs_base__animation_blend blend;
+    wuffs_base__animation_disposal disposal;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline void update(wuffs_base__rect_ie_u32 bounds,
+                     wuffs_base__flicks duration,
+                     uint64_t index,
+                     uint64_t io_position,
+                     wuffs_base__animation_blend blend,
+                     wuffs_base__animation_disposal disposal);
+  inline wuffs_base__rect_ie_u32 bounds();
+  inline uint32_t width();
+  inline uint32_t height();
+  inline wuffs_base__flicks duration();
+  inline uint64_t index();
+  inline uint64_t io_position();
+  inline wuffs_base__animation_blend blend();
+  inline wuffs_base__animation_disposal disposal();
+#endif  // __cplusplus
+
+} wuffs_base__frame_config;
+
+static inline void  //
+wuffs_base__frame_config__update(wuffs_base__frame_config* c,
+                                 wuffs_base__rect_ie_u32 bounds,
+                                 wuffs_base__flicks duration,
+                                 uint64_t index,
+                                 uint64_t io_position,
+                                 wuffs_base__animation_blend blend,
+                                 wuffs_base__animation_disposal disposal) {
+  if (!c) {
+    return;
+  }
+
+  c->private_impl.bounds = bounds;
+  c->private_impl.duration = duration;
+  c->private_impl.index = index;
+  c->private_impl.io_position = io_position;
+  c->private_impl.blend = blend;
+  c->private_impl.disposal = disposal;
+}
+
+static inline wuffs_base__rect_ie_u32  //
+wuffs_base__frame_config__bounds(wuffs_base__frame_config* c) {
+  return c ? c->private_impl.bounds : ((wuffs_base__rect_ie_u32){});
+}
+
+static inline uint32_t  //
+wuffs_base__frame_config__width(wuffs_base__frame_config* c) {
+  return c ? wuffs_base__rect_ie_u32__width(&c->private_impl.bounds) : 0;
+}
+
+static inline uint32_t  //
+wuffs_base__frame_config__height(wuffs_base__frame_config* c) {
+  return c ? wuffs_base__rect_ie_u32__height(&c->private_impl.bounds) : 0;
+}
+
+// wuffs_base__frame_config__duration returns the amount of time to display
+// this frame. Zero means to display forever - a still (non-animated) image.
+static inline wuffs_base__flicks  //
+wuffs_base__frame_config__duration(wuffs_base__frame_config* c) {
+  return c ? c->private_impl.duration : 0;
+}
+
+// wuffs_base__frame_config__index returns the index of this frame. The first
+// frame in an image has index 0, the second frame has index 1, and so on.
+static inline uint64_t  //
+wuffs_base__frame_config__index(wuffs_base__frame_config* c) {
+  return c ? c->private_impl.index : 0;
+}
+
+// wuffs_base__frame_config__io_position returns the I/O stream position before
+// the frame config.
+static inline uint64_t  //
+wuffs_base__frame_config__io_position(wuffs_base__frame_config* c) {
+  return c ? c->private_impl.io_position : 0;
+}
+
+// wuffs_base__frame_config__blend returns, for an animated image, how to blend
+// the transparent pixels of this frame with the existing canvas.
+static inline wuffs_base__animation_blend  //
+wuffs_base__frame_config__blend(wuffs_base__frame_config* c) {
+  return c ? c->private_impl.blend : 0;
+}
+
+// wuffs_base__frame_config__disposal returns, for an animated image, how to
+// dispose of this frame after displaying it.
+static inline wuffs_base__animation_disposal  //
+wuffs_base__frame_config__disposal(wuffs_base__frame_config* c) {
+  return c ? c->private_impl.disposal : 0;
+}
+
+#ifdef __cplusplus
+
+inline void  //
+wuffs_base__frame_config::update(wuffs_base__rect_ie_u32 bounds,
+                                 wuffs_base__flicks duration,
+                                 uint64_t index,
+                                 uint64_t io_position,
+                                 wuffs_base__animation_blend blend,
+                                 wuffs_base__animation_disposal disposal) {
+  wuffs_base__frame_config__update(this, bounds, duration, index, io_position,
+                                   blend, disposal);
+}
+
+inline wuffs_base__rect_ie_u32  //
+wuffs_base__frame_config::bounds() {
+  return wuffs_base__frame_config__bounds(this);
+}
+
+inline uint32_t  //
+wuffs_base__frame_config::width() {
+  return wuffs_base__frame_config__width(this);
+}
+
+inline uint32_t  //
+wuffs_base__frame_config::height() {
+  return wuffs_base__frame_config__height(this);
+}
+
+inline wuffs_base__flicks  //
+wuffs_base__frame_config::duration() {
+  return wuffs_base__frame_config__duration(this);
+}
+
+inline uint64_t  //
+wuffs_base__frame_config::index() {
+  return wuffs_base__frame_config__index(this);
+}
+
+inline uint64_t  //
+wuffs_base__frame_config::io_position() {
+  return wuffs_base__frame_config__io_position(this);
+}
+
+inline wuffs_base__animation_blend  //
+wuffs_base__frame_config::blend() {
+  return wuffs_base__frame_config__blend(this);
+}
+
+inline wuffs_base__animation_disposal  //
+wuffs_base__frame_config::disposal() {
+  return wuffs_base__frame_config__disposal(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+typedef struct {
+  wuffs_base__pixel_config pixcfg;
+
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    wuffs_base__table_u8 planes[WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX];
+    // TODO: color spaces.
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status set_from_slice(wuffs_base__pixel_config* pixcfg,
+                                           wuffs_base__slice_u8 pixbuf_memory);
+  inline wuffs_base__status set_from_table(wuffs_base__pixel_config* pixcfg,
+                                           wuffs_base__table_u8 primary_memory,
+                                           wuffs_base__slice_u8 palette_memory);
+  inline wuffs_base__pixel_format pixel_format();
+  inline wuffs_base__slice_u8 palette();
+  inline wuffs_base__table_u8 plane(uint32_t p);
+#endif  // __cplusplus
+
+} wuffs_base__pixel_buffer;
+
+static inline wuffs_base__status  //
+wuffs_base__pixel_buffer__set_from_slice(wuffs_base__pixel_buffer* b,
+                                         wuffs_base__pixel_config* pixcfg,
+                                         wuffs_base__slice_u8 pixbuf_memory) {
+  if (!b) {
+    return wuffs_base__error__bad_receiver;
+  }
+  *b = ((wuffs_base__pixel_buffer){});
+  if (!pixcfg) {
+    return wuffs_base__error__bad_argument;
+  }
+
+  uint8_t* ptr = pixbuf_memory.ptr;
+  uint64_t len = pixbuf_memory.len;
+  if (wuffs_base__pixel_format__is_indexed(pixcfg->private_impl.pixfmt)) {
+    // Split a 1024 byte chunk (256 palette entries × 4 bytes per entry) from
+    // the start of pixbuf_memory. We split from the start, not the end, so
+    // that the both chunks' pointers have the same alignment as the original
+    // pointer, up to an alignment of 1024.
+    if (len < 1024) {
+      return wuffs_base__error__bad_argument_length_too_short;
+    }
+    wuffs_base__table_u8* tab =
+        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];
+    tab->ptr = ptr;
+    tab->width = 1024;
+    tab->height = 1;
+    tab->stride = 1024;
+    ptr += 1024;
+    len -= 1024;
+  }
+
+  // The rows are packed: the stride equals the width in bytes. For padded
+  // strides, use wuffs_base__pixel_buffer__set_from_table instead. Planar
+  // formats' planes are consecutive, in plane order.
+  if (wuffs_base__pixel_format__is_planar_8_bit(pixcfg->private_impl.pixfmt)) {
+    if (len < wuffs_base__pixel_config__pixbuf_len(pixcfg)) {
+      return wuffs_base__error__bad_argument_length_too_short;
+    }
+    b->pixcfg = *pixcfg;
+    uint32_t num_planes =
+        wuffs_base__pixel_format__num_planes(pixcfg->private_impl.pixfmt);
+    uint32_t p;
+    for (p = 0; p < num_planes; p++) {
+      uint32_t w = wuffs_base__pixel_subsampling__plane_width(
+          pixcfg->private_impl.pixsub, p, pixcfg->private_impl.width);
+      uint32_t h = wuffs_base__pixel_subsampling__plane_height(
+          pixcfg->private_impl.pixsub, p, pixcfg->private_impl.height);
+      wuffs_base__table_u8* tab = &b->private_impl.planes[p];
+      tab->ptr = ptr;
+      tab->width = w;
+      tab->height = h;
+      tab->stride = w;
+      ptr += ((uint64_t)w) * ((uint64_t)h);
+    }
+    return NULL;
+  }
+
+  // TODO: handle fractional bytes per pixel.
+  uint32_t bits_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(pixcfg->private_impl.pixfmt);
+  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  uint64_t width_in_bytes =
+      ((uint64_t)pixcfg->private_impl.width) * (bits_per_pixel / 8);
+  if ((width_in_bytes > 0) &&
+      ((len / width_in_bytes) < ((uint64_t)pixcfg->private_impl.height))) {
+    return wuffs_base__error__bad_argument_length_too_short;
+  }
+  b->pixcfg = *pixcfg;
+  wuffs_base__table_u8* tab = &b->private_impl.planes[0];
+  tab->ptr = ptr;
+  tab->width = width_in_bytes;
+  tab->height = pixcfg->private_impl.height;
+  tab->stride = width_in_bytes;
+  return NULL;
+}
+
+// wuffs_base__pixel_buffer__set_from_table is like
+// wuffs_base__pixel_buffer__set_from_slice, but the caller provides the
+// primary plane's memory as a table, whose stride can be larger than its width
+// in bytes. For example, a GPU upload staging buffer or a shared framebuffer
+// might pad each row to a 64 byte alignment.
+//
+// The table's width, in bytes, and height must be at least the pixcfg's width
+// (multiplied by bytes per pixel) and height. Any excess is ignored.
+//
+// For indexed pixel formats, palette_memory must have length at least 1024,
+// and only its first 1024 bytes are used. For other pixel formats, it is
+// ignored and may be empty.
+//
+// TODO: support multi-plane pixel formats, such as YCbCr, taking one table per
+// plane.
+static inline wuffs_base__status  //
+wuffs_base__pixel_buffer__set_from_table(wuffs_base__pixel_buffer* b,
+                                         wuffs_base__pixel_config* pixcfg,
+                                         wuffs_base__table_u8 primary_memory,
+                                         wuffs_base__slice_u8 palette_memory) {
+  if (!b) {
+    return wuffs_base__error__bad_receiver;
+  }
+  *b = ((wuffs_base__pixel_buffer){});
+  if (!pixcfg) {
+    return wuffs_base__error__bad_argument;
+  }
+
+  if (wuffs_base__pixel_format__is_indexed(pixcfg->private_impl.pixfmt)) {
+    if (palette_memory.len < 1024) {
+      return wuffs_base__error__bad_argument_length_too_short;
+    }
+    wuffs_base__table_u8* tab =
+        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];
+    tab->ptr = palette_memory.ptr;
+    tab->width = 1024;
+    tab->height = 1;
+    tab->stride = 1024;
+  }
+
+  uint32_t bits_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(pixcfg->private_impl.pixfmt);
+  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {
+    *b = ((wuffs_base__pixel_buffer){});
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  uint64_t width_in_bytes =
+      ((uint64_t)pixcfg->private_impl.width) * (bits_per_pixel / 8);
+  uint32_t height = pixcfg->private_impl.height;
+  if ((width_in_bytes > primary_memory.width) ||
+      (height > primary_memory.height)) {
+    *b = ((wuffs_base__pixel_buffer){});
+    return wuffs_base__error__bad_argument_length_too_short;
+  }
+  if ((height > 1) && (width_in_bytes > primary_memory.stride)) {
+    *b = ((wuffs_base__pixel_buffer){});
+    return wuffs_base__error__bad_argument;
+  }
+  b->pixcfg = *pixcfg;
+  wuffs_base__table_u8* tab = &b->private_impl.planes[0];
+  tab->ptr = primary_memory.ptr;
+  tab->width = width_in_bytes;
+  tab->height = height;
+  tab->stride = primary_memory.stride;
+  return NULL;
+}
+
+static inline wuffs_base__pixel_format  //
+wuffs_base__pixel_buffer__pixel_format(wuffs_base__pixel_buffer* b) {
+  return b ? b->pixcfg.private_impl.pixfmt : 0;
+}
+
+// wuffs_base__pixel_buffer__palette returns the palette color data. If
+// non-empty, it will have length 1024.
+static inline wuffs_base__slice_u8  //
+wuffs_base__pixel_buffer__palette(wuffs_base__pixel_buffer* b) {
+  if (b &&
+      wuffs_base__pixel_format__is_indexed(b->pixcfg.private_impl.pixfmt)) {
+    wuffs_base__table_u8* tab =
+        &b->private_impl.planes[WUFFS_BASE__PIXEL_FORMAT__INDEXED__COLOR_PLANE];
+    if ((tab->width == 1024) && (tab->height == 1)) {
+      return ((wuffs_base__slice_u8){
+          .ptr = tab->ptr,
+          .len = 1024,
+      });
+    }
+  }
+  return ((wuffs_base__slice_u8){});
+}
+
+static inline wuffs_base__table_u8  //
+wuffs_base__pixel_buffer__plane(wuffs_base__pixel_buffer* b, uint32_t p) {
+  return (b && (p < WUFFS_BASE__PIXEL_FORMAT__NUM_PLANES_MAX))
+             ? b->private_impl.planes[p]
+             : ((wuffs_base__table_u8){});
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__pixel_buffer::set_from_slice(wuffs_base__pixel_config* pixcfg,
+                                         wuffs_base__slice_u8 pixbuf_memory) {
+  return wuffs_base__pixel_buffer__set_from_slice(this, pixcfg, pixbuf_memory);
+}
+
+inline wuffs_base__status  //
+wuffs_base__pixel_buffer::set_from_table(wuffs_base__pixel_config* pixcfg,
+                                         wuffs_base__table_u8 primary_memory,
+                                         wuffs_base__slice_u8 palette_memory) {
+  return wuffs_base__pixel_buffer__set_from_table(this, pixcfg, primary_memory,
+                                                  palette_memory);
+}
+
+inline wuffs_base__pixel_format  //
+wuffs_base__pixel_buffer::pixel_format() {
+  return wuffs_base__pixel_buffer__pixel_format(this);
+}
+
+inline wuffs_base__slice_u8  //
+wuffs_base__pixel_buffer::palette() {
+  return wuffs_base__pixel_buffer__palette(this);
+}
+
+inline wuffs_base__table_u8  //
+wuffs_base__pixel_buffer::plane(uint32_t p) {
+  return wuffs_base__pixel_buffer__plane(this, p);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// The wuffs_base__pixel_swizzle__indexed_to_etc functions convert rows of
+// palette-indexed pixels (1 byte per pixel) in src to direct color pixels in
+// dst, looking up each index in a 1024 byte palette of BGRA colors, such as
+// the one returned by wuffs_base__pixel_buffer__palette.
+//
+// The dst and src tables' widths are in bytes, not pixels, and their strides
+// are explicit, so that either table can be a sub-rectangle of a larger pixel
+// buffer. The number of rows converted is the minimum of the two heights. The
+// number of pixels per row is the minimum of dst's width in pixels and src's
+// width. The return value is the total number of pixels converted, which is
+// zero if the palette's length is not 1024.
+//
+// The dst pixel formats are, using Wuffs' memory order naming, BGRA (4 bytes
+// per pixel, copying the palette entry as is), RGB (3 bytes per pixel) and BGR
+// 565 (2 bytes per pixel, little-endian, what other libraries often call
+// RGB565). For the latter two, the palette's alpha channel is ignored.
+//
+// The __transparent variants skip, leaving dst's pixel unchanged, any src
+// pixel whose palette entry has zero alpha. For palettes whose entries are
+// either fully opaque or fully transparent, such as those given by the GIF
+// decoder, where the transparent index's entry is transparent black, this is
+// alpha-over (src-over-dst) composition.
+//
+// The inner loops are unrolled 4 times.
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__private_indexed_to_bgra(wuffs_base__table_u8 dst,
+                                                   wuffs_base__table_u8 src,
+                                                   wuffs_base__slice_u8 palette,
+                                                   bool transparent) {
+  if (palette.len != 1024) {
+    return 0;
+  }
+  size_t w = dst.width / 4;
+  w = (w < src.width) ? w : src.width;
+  size_t h = (dst.height < src.height) ? dst.height : src.height;
+  uint8_t* p = palette.ptr;
+
+  size_t y;
+  for (y = 0; y < h; y++) {
+    uint8_t* d = dst.ptr + (y * dst.stride);
+    uint8_t* s = src.ptr + (y * src.stride);
+    size_t n = w;
+    for (; n >= 4; n -= 4) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      uint8_t* c1 = p + (4 * (size_t)s[1]);
+      uint8_t* c2 = p + (4 * (size_t)s[2]);
+      uint8_t* c3 = p + (4 * (size_t)s[3]);
+      if (!transparent || c0[3]) {
+        memcpy(d + 0, c0, 4);
+      }
+      if (!transparent || c1[3]) {
+        memcpy(d + 4, c1, 4);
+      }
+      if (!transparent || c2[3]) {
+        memcpy(d + 8, c2, 4);
+      }
+      if (!transparent || c3[3]) {
+        memcpy(d + 12, c3, 4);
+      }
+      d += 16;
+      s += 4;
+    }
+    for (; n > 0; n--) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      if (!transparent || c0[3]) {
+        memcpy(d + 0, c0, 4);
+      }
+      d += 4;
+      s += 1;
+    }
+  }
+  return ((uint64_t)w) * ((uint64_t)h);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__private_indexed_to_rgb(wuffs_base__table_u8 dst,
+                                                  wuffs_base__table_u8 src,
+                                                  wuffs_base__slice_u8 palette,
+                                                  bool transparent) {
+  if (palette.len != 1024) {
+    return 0;
+  }
+  size_t w = dst.width / 3;
+  w = (w < src.width) ? w : src.width;
+  size_t h = (dst.height < src.height) ? dst.height : src.height;
+  uint8_t* p = palette.ptr;
+
+  size_t y;
+  for (y = 0; y < h; y++) {
+    uint8_t* d = dst.ptr + (y * dst.stride);
+    uint8_t* s = src.ptr + (y * src.stride);
+    size_t n = w;
+    for (; n >= 4; n -= 4) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      uint8_t* c1 = p + (4 * (size_t)s[1]);
+      uint8_t* c2 = p + (4 * (size_t)s[2]);
+      uint8_t* c3 = p + (4 * (size_t)s[3]);
+      if (!transparent || c0[3]) {
+        d[0] = c0[2];
+        d[1] = c0[1];
+        d[2] = c0[0];
+      }
+      if (!transparent || c1[3]) {
+        d[3] = c1[2];
+        d[4] = c1[1];
+        d[5] = c1[0];
+      }
+      if (!transparent || c2[3]) {
+        d[6] = c2[2];
+        d[7] = c2[1];
+        d[8] = c2[0];
+      }
+      if (!transparent || c3[3]) {
+        d[9] = c3[2];
+        d[10] = c3[1];
+        d[11] = c3[0];
+      }
+      d += 12;
+      s += 4;
+    }
+    for (; n > 0; n--) {
+      uint8_t* c0 = p + (4 * (size_t)s[0]);
+      if (!transparent || c0[3]) {
+        d[0] = c0[2];
+        d[1] = c0[1];
+        d[2] = c0[0];
+      }
+      d += 3;
+      s += 1;
+    }
+  }
+  return ((uint64_t)w) * ((uint64_t)h);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette,
+    bool transparent) {
+  if (palette.len != 1024) {
+    return 0;
+  }
+  size_t w = dst.width / 2;
+  w = (w < src.width) ? w : src.width;
+  size_t h = (dst.height < src.height) ? dst.height : src.height;
+
+  // Convert the palette once, up front, instead of once per pixel. Each entry
+  // is 2 bytes of BGR 565 and 1 byte for whether the color is transparent.
+  uint8_t p[3 * 256];
+  size_t i;
+  for (i = 0; i < 256; i++) {
+    uint8_t* c = palette.ptr + (4 * i);
+    uint32_t b5 = c[0] >> 3;
+    uint32_t g6 = c[1] >> 2;
+    uint32_t r5 = c[2] >> 3;
+    uint32_t v = (r5 << 11) | (g6 << 5) | (b5 << 0);
+    p[(3 * i) + 0] = (uint8_t)(v >> 0);
+    p[(3 * i) + 1] = (uint8_t)(v >> 8);
+    p[(3 * i) + 2] = c[3];
+  }
+
+  size_t y;
+  for (y = 0; y < h; y++) {
+    uint8_t* d = dst.ptr + (y * dst.stride);
+    uint8_t* s = src.ptr + (y * src.stride);
+    size_t n = w;
+    for (; n >= 4; n -= 4) {
+      uint8_t* c0 = p + (3 * (size_t)s[0]);
+      uint8_t* c1 = p + (3 * (size_t)s[1]);
+      uint8_t* c2 = p + (3 * (size_t)s[2]);
+      uint8_t* c3 = p + (3 * (size_t)s[3]);
+      if (!transparent || c0[2]) {
+        memcpy(d + 0, c0, 2);
+      }
+      if (!transparent || c1[2]) {
+        memcpy(d + 2, c1, 2);
+      }
+      if (!transparent || c2[2]) {
+        memcpy(d + 4, c2, 2);
+      }
+      if (!transparent || c3[2]) {
+        memcpy(d + 6, c3, 2);
+      }
+      d += 8;
+      s += 4;
+    }
+    for (; n > 0; n--) {
+      uint8_t* c0 = p + (3 * (size_t)s[0]);
+      if (!transparent || c0[2]) {
+        memcpy(d + 0, c0, 2);
+      }
+      d += 2;
+      s += 1;
+    }
+  }
+  return ((uint64_t)w) * ((uint64_t)h);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgra(wuffs_base__table_u8 dst,
+                                           wuffs_base__table_u8 src,
+                                           wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgra(dst, src, palette,
+                                                            false);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgra__transparent(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgra(dst, src, palette,
+                                                            true);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_rgb(wuffs_base__table_u8 dst,
+                                          wuffs_base__table_u8 src,
+                                          wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_rgb(dst, src, palette,
+                                                           false);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_rgb__transparent(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_rgb(dst, src, palette,
+                                                           true);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgr_565(wuffs_base__table_u8 dst,
+                                              wuffs_base__table_u8 src,
+                                              wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(dst, src,
+                                                               palette, false);
+}
+
+static inline uint64_t  //
+wuffs_base__pixel_swizzle__indexed_to_bgr_565__transparent(
+    wuffs_base__table_u8 dst,
+    wuffs_base__table_u8 src,
+    wuffs_base__slice_u8 palette) {
+  return wuffs_base__pixel_swizzle__private_indexed_to_bgr_565(dst, src,
+                                                               palette, true);
+}
+
+// --------
+
+// wuffs_base__animation_compositor composites an animated image's frames onto
+// a canvas: a BGRA pixel buffer that holds what to display. It applies each
+// frame's blend and, before drawing the next frame, each frame's disposal.
+//
+// Each frame is given as a palette-indexed pixel buffer, such as the one
+// passed to the GIF decoder's decode_frame method. Only the pixels within the
+// frame's bounds are read.
+//
+// Only a frame's bounds, not the whole canvas, are saved, cleared or restored.
+// Restoring the background means clearing to transparent black, as web
+// browsers do. For RESTORE_PREVIOUS frames, the snapshot memory needs to hold
+// 4 bytes per pixel of the frame's bounds. The canvas' width × height × 4
+// bytes is always enough, and zero bytes is enough if no frame uses
+// RESTORE_PREVIOUS.
+//
+// Compositing a frame reports a dirty rectangle, the union of the previous
+// frame's bounds (if disposing of it changed the canvas) and this frame's
+// bounds. Pixels outside of it are unchanged, so renderers need only repaint
+// that rectangle.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    wuffs_base__table_u8 canvas;
+    wuffs_base__slice_u8 snapshot;
+    wuffs_base__rect_ie_u32 pending_bounds;
+    wuffs_base__animation_disposal pending_disposal;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status initialize(wuffs_base__pixel_buffer* canvas,
+                                       wuffs_base__slice_u8 snapshot_memory);
+  inline wuffs_base__status composite(wuffs_base__rect_ie_u32* dirty_rect,
+                                      wuffs_base__frame_config* fc,
+                                      wuffs_base__pixel_buffer* src);
+#endif  // __cplusplus
+
+} wuffs_base__animation_compositor;
+
+// wuffs_base__animation_compositor__initialize sets the canvas, which must be
+// BGRA (premultiplied or not), and clears it to transparent black. Call it
+// again to restart an animation from its first frame.
+static inline wuffs_base__status  //
+wuffs_base__animation_compositor__initialize(
+    wuffs_base__animation_compositor* c,
+    wuffs_base__pixel_buffer* canvas,
+    wuffs_base__slice_u8 snapshot_memory) {
+  if (!c) {
+    return wuffs_base__error__bad_receiver;
+  }
+  *c = ((wuffs_base__animation_compositor){});
+  if (!canvas) {
+    return wuffs_base__error__bad_argument;
+  }
+  wuffs_base__pixel_format pixfmt = canvas->pixcfg.private_impl.pixfmt;
+  if ((pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) &&
+      (pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+
+  wuffs_base__table_u8 tab = canvas->private_impl.planes[0];
+  size_t y;
+  for (y = 0; y < tab.height; y++) {
+    memset(tab.ptr + (y * tab.stride), 0, tab.width);
+  }
+  c->private_impl.canvas = tab;
+  c->private_impl.snapshot = snapshot_memory;
+  return NULL;
+}
+
+// wuffs_base__animation_compositor__composite disposes of the previous frame
+// and then draws the next one, src, whose frame config is fc. If dirty_rect
+// is non-NULL, it is set to the canvas rectangle that has changed.
+static inline wuffs_base__status  //
+wuffs_base__animation_compositor__composite(wuffs_base__animation_compositor* c,
+                                            wuffs_base__rect_ie_u32* dirty_rect,
+                                            wuffs_base__frame_config* fc,
+                                            wuffs_base__pixel_buffer* src) {
+  if (!c) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (!fc || !src) {
+    return wuffs_base__error__bad_argument;
+  }
+  if (!wuffs_base__pixel_format__is_indexed(src->pixcfg.private_impl.pixfmt)) {
+    return wuffs_base__error__unsupported_pixel_format;
+  }
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(src);
+  wuffs_base__table_u8 src_tab = src->private_impl.planes[0];
+  wuffs_base__table_u8 dst_tab = c->private_impl.canvas;
+
+  // Clip the frame's bounds to the canvas and to src.
+  wuffs_base__rect_ie_u32 r = ((wuffs_base__rect_ie_u32){
+      .min_incl_x = 0,
+      .min_incl_y = 0,
+      .max_excl_x =
+          (uint32_t)(wuffs_base__u64__min(dst_tab.width / 4, src_tab.width)),
+      .max_excl_y =
+          (uint32_t)(wuffs_base__u64__min(dst_tab.height, src_tab.height)),
+  });
+  r = wuffs_base__rect_ie_u32__intersect(&r, fc->private_impl.bounds);
+  // A frame wholly outside of the canvas, or of src, leaves r empty but with
+  // possibly min > max. Normalize it to the zero rectangle, so that neither the
+  // pointers below, the pending_bounds nor the dirty_rect refer to pixels
+  // beyond the canvas.
+  if (wuffs_base__rect_ie_u32__is_empty(&r)) {
+    r = ((wuffs_base__rect_ie_u32){});
+  }
+  size_t w = wuffs_base__rect_ie_u32__width(&r);
+  size_t h = wuffs_base__rect_ie_u32__height(&r);
+
+  wuffs_base__animation_disposal disposal = fc->private_impl.disposal;
+  if ((disposal == WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) &&
+      (c->private_impl.snapshot.len < (w * h * 4))) {
+    return wuffs_base__error__bad_argument_length_too_short;
+  }
+
+  // Dispose of the previous frame.
+  wuffs_base__rect_ie_u32 dirty = c->private_impl.pending_bounds;
+  size_t pw = wuffs_base__rect_ie_u32__width(&dirty);
+  size_t ph = wuffs_base__rect_ie_u32__height(&dirty);
+  uint8_t* d = dst_tab.ptr + (dirty.min_incl_y * dst_tab.stride) +
+               (dirty.min_incl_x * 4);
+  uint8_t* s = c->private_impl.snapshot.ptr;
+  size_t y;
+  switch (c->private_impl.pending_disposal) {
+    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_BACKGROUND:
+      for (y = 0; y < ph; y++) {
+        memset(d, 0, pw * 4);
+        d += dst_tab.stride;
+      }
+      break;
+    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS:
+      for (y = 0; y < ph; y++) {
+        memcpy(d, s, pw * 4);
+        d += dst_tab.stride;
+        s += pw * 4;
+      }
+      break;
+    default:
+      dirty = ((wuffs_base__rect_ie_u32){});
+      break;
+  }
+
+  // Save what this frame will draw over, if it needs restoring later.
+  d = dst_tab.ptr + (r.min_incl_y * dst_tab.stride) + (r.min_incl_x * 4);
+  if (disposal == WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) {
+    s = c->private_impl.snapshot.ptr;
+    for (y = 0; y < h; y++) {
+      memcpy(s, d + (y * dst_tab.stride), w * 4);
+      s += w * 4;
+    }
+  }
+
+  // Draw this frame.
+  dst_tab.ptr = d;
+  dst_tab.width = w * 4;
+  dst_tab.height = h;
+  src_tab.ptr += (r.min_incl_y * src_tab.stride) + r.min_incl_x;
+  src_tab.width = w;
+  src_tab.height = h;
+  if (fc->private_impl.blend == WUFFS_BASE__ANIMATION_BLEND__SRC_OVER_DST) {
+    wuffs_base__pixel_swizzle__indexed_to_bgra__transparent(dst_tab, src_tab,
+                                                            palette);
+  } else {
+    wuffs_base__pixel_swizzle__indexed_to_bgra(dst_tab, src_tab, palette);
+  }
+
+  c->private_impl.pending_bounds = r;
+  c->private_impl.pending_disposal = disposal;
+  if (dirty_rect) {
+    *dirty_rect = wuffs_base__rect_ie_u32__unite(&dirty, r);
+  }
+  return NULL;
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__animation_compositor::initialize(
+    wuffs_base__pixel_buffer* canvas,
+    wuffs_base__slice_u8 snapshot_memory) {
+  return wuffs_base__animation_compositor__initialize(this, canvas,
+                                                      snapshot_memory);
+}
+
+inline wuffs_base__status  //
+wuffs_base__animation_compositor::composite(wuffs_base__rect_ie_u32* dirty_rect,
+                                            wuffs_base__frame_config* fc,
+                                            wuffs_base__pixel_buffer* src) {
+  return wuffs_base__animation_compositor__composite(this, dirty_rect, fc, src);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__decode_frame_options holds optional settings for decoding a
+// frame. A zero-valued struct, or a NULL pointer, means the default settings.
+//
+// A downscale shift, k, of 1, 2 or 3 decodes a frame at 1/2, 1/4 or 1/8 scale
+// respectively, such as for a thumbnail. The frame's pixel at (x, y) is
+// written to the destination pixel buffer at (x >> k, y >> k), and every
+// other pixel is dropped. A destination pixel buffer that is ((width + (1 <<
+// k) - 1) >> k) pixels wide and ((height + (1 << k) - 1) >> k) pixels high
+// holds the whole downscaled image, where width and height are the image
+// config's.
+//
+// Reporting interlace passes means that, for interlaced frames, decoding a
+// frame suspends at the end of every interlace pass but the last, so that the
+// caller can show a coarse preview. Which rows are complete so far depends on
+// the decoder. For example, see the GIF decoder's interlace_row_stride method.
+// The caller resumes decoding by calling the same method with the same
+// arguments, as for any other suspension.
+//
+// Reporting rows means that decoding a frame suspends after every row but the
+// last, so that the caller can consume each row as soon as it is complete.
+// Decoders that support this, such as the PNG decoder, write row y to the
+// destination pixel buffer's row (y % h), where h is that pixel buffer's
+// height, so that a pixel buffer only one row high suffices. The decoder's
+// num_decoded_rows method says how many rows are complete so far. Decoders
+// that do not support this ignore it.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    uint32_t downscale_shift;
+    bool report_interlace_passes;
+    bool report_rows;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline void initialize(uint32_t downscale_shift,
+                         bool report_interlace_passes,
+                         bool report_rows);
+  inline uint32_t downscale_shift();
+  inline bool report_interlace_passes();
+  inline bool report_rows();
+#endif  // __cplusplus
+
+} wuffs_base__decode_frame_options;
+
+// wuffs_base__decode_frame_options__initialize sets the options. The downscale
+// shift is clamped to be at most 3.
+static inline void  //
+wuffs_base__decode_frame_options__initialize(
+    wuffs_base__decode_frame_options* o,
+    uint32_t downscale_shift,
+    bool report_interlace_passes,
+    bool report_rows) {
+  if (!o) {
+    return;
+  }
+  o->private_impl.downscale_shift = wuffs_base__u32__min(downscale_shift, 3);
+  o->private_impl.report_interlace_passes = report_interlace_passes;
+  o->private_impl.report_rows = report_rows;
+}
+
+static inline uint32_t  //
+wuffs_base__decode_frame_options__downscale_shift(
+    wuffs_base__decode_frame_options* o) {
+  return o ? wuffs_base__u32__min(o->private_impl.downscale_shift, 3) : 0;
+}
+
+static inline bool  //
+wuffs_base__decode_frame_options__report_interlace_passes(
+    wuffs_base__decode_frame_options* o) {
+  return o ? o->private_impl.report_interlace_passes : false;
+}
+
+static inline bool  //
+wuffs_base__decode_frame_options__report_rows(
+    wuffs_base__decode_frame_options* o) {
+  return o ? o->private_impl.report_rows : false;
+}
+
+// wuffs_base__pixel_buffer__replicate_interlaced_rows fills in the rows that
+// an interlaced frame has not decoded yet, for displaying a coarse preview.
+// Within the bounds, each row whose y minus bounds.min_incl_y is a multiple of
+// row_stride is copied over the (row_stride - 1) rows below it.
+//
+// This overwrites those rows' pixels in place. Later interlace passes will
+// overwrite them again, except where a frame's transparent pixels are skipped
+// when decoding to a direct color (not palette-indexed) pixel buffer. For such
+// pixel buffers, replicate the rows of a copy instead.
+static inline void  //
+wuffs_base__pixel_buffer__replicate_interlaced_rows(
+    wuffs_base__pixel_buffer* b,
+    wuffs_base__rect_ie_u32 bounds,
+    uint32_t row_stride) {
+  if (!b || (row_stride <= 1)) {
+    return;
+  }
+  uint32_t bits_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(b->pixcfg.private_impl.pixfmt);
+  if ((bits_per_pixel == 0) || ((bits_per_pixel % 8) != 0)) {
+    return;
+  }
+  wuffs_base__table_u8 tab = b->private_impl.planes[0];
+  wuffs_base__rect_ie_u32 r = ((wuffs_base__rect_ie_u32){
+      .min_incl_x = 0,
+      .min_incl_y = 0,
+      .max_excl_x = (uint32_t)(tab.width / (bits_per_pixel / 8)),
+      .max_excl_y = (uint32_t)(tab.height),
+  });
+  r = wuffs_base__rect_ie_u32__intersect(&r, bounds);
+  if (wuffs_base__rect_ie_u32__is_empty(&r)) {
+    return;
+  }
+  size_t n =
+      ((size_t)wuffs_base__rect_ie_u32__width(&r)) * (bits_per_pixel / 8);
+  uint8_t* p = tab.ptr + (((size_t)r.min_incl_x) * (bits_per_pixel / 8));
+  uint32_t y;
+  for (y = r.min_incl_y; y < r.max_excl_y; y++) {
+    uint32_t offset = (y - bounds.min_incl_y) % row_stride;
+    if (offset) {
+      memcpy(p + (y * tab.stride), p + ((y - offset) * tab.stride), n);
+    }
+  }
+}
+
+#ifdef __cplusplus
+
+inline void  //
+wuffs_base__decode_frame_options::initialize(uint32_t downscale_shift,
+                                             bool report_interlace_passes,
+                                             bool report_rows) {
+  wuffs_base__decode_frame_options__initialize(
+      this, downscale_shift, report_interlace_passes, report_rows);
+}
+
+inline uint32_t  //
+wuffs_base__decode_frame_options::downscale_shift() {
+  return wuffs_base__decode_frame_options__downscale_shift(this);
+}
+
+inline bool  //
+wuffs_base__decode_frame_options::report_interlace_passes() {
+  return wuffs_base__decode_frame_options__report_interlace_passes(this);
+}
+
+inline bool  //
+wuffs_base__decode_frame_options::report_rows() {
+  return wuffs_base__decode_frame_options__report_rows(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__image_format identifies an image file format, as four ASCII
+// bytes in big-endian order. For example, "PNG " is 0x504E4720. Zero means an
+// unknown format.
+typedef uint32_t wuffs_base__image_format;
+
+#define WUFFS_BASE__IMAGE_FORMAT__BMP 0x424D5020
+#define WUFFS_BASE__IMAGE_FORMAT__GIF 0x47494620
+#define WUFFS_BASE__IMAGE_FORMAT__JPEG 0x4A504547
+#define WUFFS_BASE__IMAGE_FORMAT__PNG 0x504E4720
+#define WUFFS_BASE__IMAGE_FORMAT__TIFF 0x54494646
+#define WUFFS_BASE__IMAGE_FORMAT__WEBP 0x57454250
+
+// WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN is the most number of bytes that
+// wuffs_base__image_format__sniff looks at.
+#define WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN 16
+
+// wuffs_base__image_format__sniff identifies an image file format from the
+// first bytes of its file. It looks at no more than
+// WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN bytes, and does not need that many to
+// recognize every format, but a prefix shorter than a format's magic number
+// cannot match that format. It returns zero if the prefix matches no format.
+static inline wuffs_base__image_format  //
+wuffs_base__image_format__sniff(wuffs_base__slice_u8 prefix) {
+  const uint8_t* p = prefix.ptr;
+  size_t n = prefix.len;
+  if (!p) {
+    return 0;
+  }
+  if ((n >= 8) && (p[0] == 0x89) && (p[1] == 'P') && (p[2] == 'N') &&
+      (p[3] == 'G') && (p[4] == 0x0D) && (p[5] == 0x0A) && (p[6] == 0x1A) &&
+      (p[7] == 0x0A)) {
+    return WUFFS_BASE__IMAGE_FORMAT__PNG;
+  }
+  if ((n >= 6) && (p[0] == 'G') && (p[1] == 'I') && (p[2] == 'F') &&
+      (p[3] == '8') && ((p[4] == '7') || (p[4] == '9')) && (p[5] == 'a')) {
+    return WUFFS_BASE__IMAGE_FORMAT__GIF;
+  }
+  if ((n >= 3) && (p[0] == 0xFF) && (p[1] == 0xD8) && (p[2] == 0xFF)) {
+    return WUFFS_BASE__IMAGE_FORMAT__JPEG;
+  }
+  if ((n >= 12) && (p[0] == 'R') && (p[1] == 'I') && (p[2] == 'F') &&
+      (p[3] == 'F') && (p[8] == 'W') && (p[9] == 'E') && (p[10] == 'B') &&
+      (p[11] == 'P')) {
+    return WUFFS_BASE__IMAGE_FORMAT__WEBP;
+  }
+  if ((n >= 4) &&
+      (((p[0] == 'I') && (p[1] == 'I') && (p[2] == 0x2A) && (p[3] == 0x00)) ||
+       ((p[0] == 'M') && (p[1] == 'M') && (p[2] == 0x00) && (p[3] == 0x2A)))) {
+    return WUFFS_BASE__IMAGE_FORMAT__TIFF;
+  }
+  if ((n >= 2) && (p[0] == 'B') && (p[1] == 'M')) {
+    return WUFFS_BASE__IMAGE_FORMAT__BMP;
+  }
+  return 0;
+}
+
+// --------
+
+// wuffs_base__image_decoder__vtable holds an image decoder type's methods,
+// each taking a type-erased self pointer. Packages generate one such vtable
+// for each decoder type that has decode_image_config, decode_frame_config,
+// decode_frame and workbuf_len methods with the usual signatures.
+typedef struct {
+  size_t sizeof_star_self;
+  wuffs_base__status (*check_wuffs_version)(void* self,
+                                            size_t sizeof_star_self,
+                                            uint64_t wuffs_version);
+  wuffs_base__status (*decode_image_config)(void* self,
+                                            wuffs_base__image_config* dst,
+                                            wuffs_base__io_reader src);
+  wuffs_base__status (*decode_frame_config)(void* self,
+                                            wuffs_base__frame_config* dst,
+                                            wuffs_base__io_reader src);
+  wuffs_base__status (*decode_frame)(void* self,
+                                     wuffs_base__pixel_buffer* dst,
+                                     wuffs_base__io_reader src,
+                                     wuffs_base__slice_u8 workbuf,
+                                     wuffs_base__decode_frame_options* opts);
+  wuffs_base__range_ii_u64 (*workbuf_len)(void* self);
+} wuffs_base__image_decoder__vtable;
+
+// wuffs_base__image_decoder is a format-agnostic image decoder: a decoder
+// (such as a wuffs_gif__decoder or a wuffs_png__decoder) and its vtable. Make
+// one by calling a package's upcast function, such as
+// wuffs_gif__decoder__upcast_as__wuffs_base__image_decoder, after sniffing
+// the format with wuffs_base__image_format__sniff.
+//
+// Upcasting does not allocate. The decoder memory is the caller's, and one
+// block of memory that is large enough for every decoder type that a program
+// uses (for example, a union of those types) can be re-used to decode images
+// of different formats, calling wuffs_base__image_decoder__initialize before
+// each new image.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    const wuffs_base__image_decoder__vtable* vtable;
+    void* self;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status initialize();
+  inline size_t sizeof_star_self();
+  inline wuffs_base__status decode_image_config(wuffs_base__image_config* dst,
+                                                wuffs_base__io_reader src);
+  inline wuffs_base__status decode_frame_config(wuffs_base__frame_config* dst,
+                                                wuffs_base__io_reader src);
+  inline wuffs_base__status decode_frame(
+      wuffs_base__pixel_buffer* dst,
+      wuffs_base__io_reader src,
+      wuffs_base__slice_u8 workbuf,
+      wuffs_base__decode_frame_options* opts);
+  inline wuffs_base__range_ii_u64 workbuf_len();
+#endif  // __cplusplus
+
+} wuffs_base__image_decoder;
+
+// wuffs_base__image_decoder__initialize zeroes the decoder's memory and then
+// calls its check_wuffs_version initializer, so that the memory can be re-used
+// for a new image, possibly of a different format than it last held.
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__initialize(wuffs_base__image_decoder* d) {
+  if (!d || !d->private_impl.vtable || !d->private_impl.self) {
+    return wuffs_base__error__bad_receiver;
+  }
+  const wuffs_base__image_decoder__vtable* v = d->private_impl.vtable;
+  memset(d->private_impl.self, 0, v->sizeof_star_self);
+  return (*v->check_wuffs_version)(d->private_impl.self, v->sizeof_star_self,
+                                   WUFFS_VERSION);
+}
+
+// wuffs_base__image_decoder__sizeof_star_self returns the size of the
+// underlying decoder, or zero if there is none.
+static inline size_t  //
+wuffs_base__image_decoder__sizeof_star_self(wuffs_base__image_decoder* d) {
+  return (d && d->private_impl.vtable)
+             ? d->private_impl.vtable->sizeof_star_self
+             : 0;
+}
+
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__decode_image_config(wuffs_base__image_decoder* d,
+                                               wuffs_base__image_config* dst,
+                                               wuffs_base__io_reader src) {
+  if (!d || !d->private_impl.vtable) {
+    return wuffs_base__error__bad_receiver;
+  }
+  return (*d->private_impl.vtable->decode_image_config)(d->private_impl.self,
+                                                        dst, src);
+}
+
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__decode_frame_config(wuffs_base__image_decoder* d,
+                                               wuffs_base__frame_config* dst,
+                                               wuffs_base__io_reader src) {
+  if (!d || !d->private_impl.vtable) {
+    return wuffs_base__error__bad_receiver;
+  }
+  return (*d->private_impl.vtable->decode_frame_config)(d->private_impl.self,
+                                                        dst, src);
+}
+
+static inline wuffs_base__status  //
+wuffs_base__image_decoder__decode_frame(
+    wuffs_base__image_decoder* d,
+    wuffs_base__pixel_buffer* dst,
+    wuffs_base__io_reader src,
+    wuffs_base__slice_u8 workbuf,
+    wuffs_base__decode_frame_options* opts) {
+  if (!d || !d->private_impl.vtable) {
+    return wuffs_base__error__bad_receiver;
+  }
+  return (*d->private_impl.vtable->decode_frame)(d->private_impl.self, dst, src,
+                                                 workbuf, opts);
+}
+
+static inline wuffs_base__range_ii_u64  //
+wuffs_base__image_decoder__workbuf_len(wuffs_base__image_decoder* d) {
+  if (!d || !d->private_impl.vtable) {
+    return ((wuffs_base__range_ii_u64){});
+  }
+  return (*d->private_impl.vtable->workbuf_len)(d->private_impl.self);
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::initialize() {
+  return wuffs_base__image_decoder__initialize(this);
+}
+
+inline size_t  //
+wuffs_base__image_decoder::sizeof_star_self() {
+  return wuffs_base__image_decoder__sizeof_star_self(this);
+}
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::decode_image_config(wuffs_base__image_config* dst,
+                                               wuffs_base__io_reader src) {
+  return wuffs_base__image_decoder__decode_image_config(this, dst, src);
+}
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::decode_frame_config(wuffs_base__frame_config* dst,
+                                               wuffs_base__io_reader src) {
+  return wuffs_base__image_decoder__decode_frame_config(this, dst, src);
+}
+
+inline wuffs_base__status  //
+wuffs_base__image_decoder::decode_frame(
+    wuffs_base__pixel_buffer* dst,
+    wuffs_base__io_reader src,
+    wuffs_base__slice_u8 workbuf,
+    wuffs_base__decode_frame_options* opts) {
+  return wuffs_base__image_decoder__decode_frame(this, dst, src, workbuf, opts);
+}
+
+inline wuffs_base__range_ii_u64  //
+wuffs_base__image_decoder::workbuf_len() {
+  return wuffs_base__image_decoder__workbuf_len(this);
+}
+
+#endif  // __cplusplus
+
+// --------
+
+// wuffs_base__resampler_filter is the filter that a wuffs_base__resampler
+// scales with:
+//  - Box averages the source pixels that each destination pixel covers. It is
+//    the fastest filter, and is nearest neighbor when scaling up.
+//  - Bilinear is a triangle (tent) filter.
+//  - Lanczos3 is a windowed sinc filter with 3 lobes. It is the sharpest
+//    filter, but its negative lobes can cause ringing near hard edges.
+//
+// When scaling down, each filter is widened by the scale factor, so that
+// every source pixel contributes to the result.
+typedef uint8_t wuffs_base__resampler_filter;
+
+#define WUFFS_BASE__RESAMPLER_FILTER__BOX ((wuffs_base__resampler_filter)1)
+#define WUFFS_BASE__RESAMPLER_FILTER__BILINEAR ((wuffs_base__resampler_filter)2)
+#define WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3 ((wuffs_base__resampler_filter)3)
+
+// wuffs_base__resampler scales an image to a destination pixel buffer, a
+// source row at a time, so that it can consume rows as a decoder produces
+// them, without a full size intermediate image. For example, the PNG
+// decoder's report_rows option decodes into a pixel buffer only one row high.
+//
+// The source and destination pixel format must be the same: BGRA or RGBA
+// (premultiplied or not), or BGRX or RGBX. Non-premultiplied pixels are
+// premultiplied before filtering, and un-premultiplied afterwards, so that
+// the color of transparent pixels does not bleed into their neighbors.
+//
+// Scaling is separable. Each destination row is a vertical pass, over a ring
+// of the most recent source rows, followed by a horizontal pass. The ring and
+// the per-row and per-column filter weights, 14 bit fixed point, live in a
+// caller-supplied work buffer, so that a resampler never allocates memory.
+// The weights depend only on the filter and the source and destination
+// sizes, so re-initializing with the same sizes and work buffer (for example,
+// for thumbnailing many same-sized images) re-uses them instead of
+// re-computing them. Callers that re-use a work buffer like this must not
+// modify its contents in between.
+//
+// When WUFFS_BASE__HAVE_SSE2 is defined, both passes process 4 pixels (16
+// bytes) at a time in SIMD registers.
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so.
+  struct {
+    uint32_t magic;
+    wuffs_base__resampler_filter filter;
+    wuffs_base__pixel_format pixfmt;
+    uint32_t src_width;
+    uint32_t src_height;
+    uint32_t dst_width;
+    uint32_t dst_height;
+    wuffs_base__table_u8 dst;
+    wuffs_base__slice_u8 workbuf;
+
+    uint32_t x_taps;
+    uint32_t y_taps;
+    uint32_t* x_spans;
+    uint32_t* y_spans;
+    int16_t* x_weights;
+    int16_t* y_weights;
+    uint8_t** y_rows;
+    uint8_t* vrow;
+    uint8_t* ring;
+    size_t ring_stride;
+
+    uint32_t num_src_rows;
+    uint32_t num_dst_rows;
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status initialize(wuffs_base__resampler_filter filter,
+                                       uint32_t src_width,
+                                       uint32_t src_height,
+                                       wuffs_base__pixel_buffer* dst,
+                                       wuffs_base__slice_u8 workbuf);
+  inline wuffs_base__status consume_row(wuffs_base__slice_u8 src_row);
+  inline wuffs_base__status resample(wuffs_base__pixel_buffer* src);
+  inline uint32_t num_dst_rows();
+#endif  // __cplusplus
+
+} wuffs_base__resampler;
+
+// wuffs_base__resampler__workbuf_len returns the work buffer length needed to
+// scale a src_width × src_height image to dst_width × dst_height, or zero if
+// the filter is invalid or a dimension is zero or more than 0xFFFFFF.
+WUFFS_BASE__MAYBE_STATIC uint64_t  //
+wuffs_base__resampler__workbuf_len(wuffs_base__resampler_filter filter,
+                                   uint32_t src_width,
+                                   uint32_t src_height,
+                                   uint32_t dst_width,
+                                   uint32_t dst_height);
+
+// wuffs_base__resampler__initialize prepares to scale a src_width ×
+// src_height image, in dst's pixel format, to fill dst. The resampler should
+// be zeroed before it is first initialized. Call it again to start another
+// image. The workbuf needs no particular alignment, but its length must be at
+// least wuffs_base__resampler__workbuf_len, and its contents must be left
+// alone while the resampler uses it.
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__initialize(wuffs_base__resampler* r,
+                                  wuffs_base__resampler_filter filter,
+                                  uint32_t src_width,
+                                  uint32_t src_height,
+                                  wuffs_base__pixel_buffer* dst,
+                                  wuffs_base__slice_u8 workbuf);
+
+// wuffs_base__resampler__consume_row takes the next source row, whose first
+// (src_width × 4) bytes are its pixels, and writes every destination row that
+// it completes. The source row's memory can be re-used as soon as this
+// returns.
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__consume_row(wuffs_base__resampler* r,
+                                   wuffs_base__slice_u8 src_row);
+
+// wuffs_base__resampler__resample consumes every row of src, which must have
+// the source width, height and pixel format, at once.
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_base__resampler__resample(wuffs_base__resampler* r,
+                                wuffs_base__pixel_buffer* src);
+
+// wuffs_base__resampler__num_dst_rows returns the number of destination rows
+// written so far. They are the rows at the top of the destination.
+static inline uint32_t  //
+wuffs_base__resampler__num_dst_rows(wuffs_base__resampler* r) {
+  return r ? r->private_impl.num_dst_rows : 0;
+}
+
+#ifdef __cplusplus
+
+inline wuffs_base__status  //
+wuffs_base__resampler::initialize(wuffs_base__resampler_filter filter,
+                                  uint32_t src_width,
+                                  uint32_t src_height,
+                                  wuffs_base__pixel_buffer* dst,
+                                  wuffs_base__slice_u8 workbuf) {
+  return wuffs_base__resampler__initialize(this, filter, src_width, src_height,
+                                           dst, workbuf);
+}
+
+inline wuffs_base__status  //
+wuffs_base__resampler::consume_row(wuffs_base__slice_u8 src_row) {
+  return wuffs_base__resampler__consume_row(this, src_row);
+}
+
+inline wuffs_base__status  //
+wuffs_base__resampler::resample(wuffs_base__pixel_buffer* src) {
+  return wuffs_base__resampler__resample(this, src);
+}
+
+inline uint32_t  //
+wuffs_base__resampler::num_dst_rows() {
+  return wuffs_base__resampler__num_dst_rows(this);
+}
+
+#endif  // __cplusplus
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // WUFFS_INCLUDE_GUARD__BASE_PUBLIC
+
+// ---------------- Use Declarations
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---------------- Status Codes
+
+extern const char* wuffs_deflate__error__bad_huffman_code_over_subscribed;
+extern const char* wuffs_deflate__error__bad_huffman_code_under_subscribed;
+extern const char* wuffs_deflate__error__bad_huffman_code_length_count;
+extern const char* wuffs_deflate__error__bad_huffman_code_length_repetition;
+extern const char* wuffs_deflate__error__bad_huffman_code;
+extern const char* wuffs_deflate__error__bad_huffman_minimum_code_length;
+extern const char* wuffs_deflate__error__bad_block;
+extern const char* wuffs_deflate__error__bad_distance;
+extern const char* wuffs_deflate__error__bad_distance_code_count;
+extern const char* wuffs_deflate__error__bad_literal_length_code_count;
+extern const char* wuffs_deflate__error__inconsistent_stored_block_length;
+extern const char* wuffs_deflate__error__missing_end_of_block_code;
+extern const char* wuffs_deflate__error__no_huffman_codes;
+
+// ---------------- Public Consts
+
+// ---------------- Structs
+
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so. Instead, use the
+  // wuffs_deflate__decoder__etc functions.
+  //
+  // In C++, these fields would be "private", but C does not support that.
+  //
+  // It is a struct, not a struct*, so that it can be stack allocated.
+  struct {
+    uint32_t magic;
+
+    uint32_t f_bits;
+    uint32_t f_n_bits;
+    uint32_t f_huffs[2][1234];
+    uint32_t f_n_huffs_bits[2];
+    uint8_t f_history[32768];
+    uint32_t f_history_index;
+    uint8_t f_code_lengths[320];
+    bool f_end_of_block;
+
+    struct {
+      uint32_t coro_susp_point;
+      wuffs_base__status v_z;
+      uint64_t v_n_copied;
+      uint32_t v_already_full;
+    } c_decode[1];
+    struct {
+      uint32_t coro_susp_point;
+      uint32_t v_final;
+      uint32_t v_type;
+    } c_decode_blocks[1];
+    struct {
+      uint32_t coro_susp_point;
+      uint32_t v_length;
+      uint32_t v_n_copied;
+      uint64_t scratch;
+    } c_decode_uncompressed[1];
+    struct {
+      uint32_t coro_susp_point;
+      uint32_t v_i;
+    } c_init_fixed_huffman[1];
+    struct {
+      uint32_t coro_susp_point;
+      uint32_t v_bits;
+      uint32_t v_n_bits;
+      uint32_t v_n_lit;
+      uint32_t v_n_dist;
+      uint32_t v_n_clen;
+      uint32_t v_i;
+      uint32_t v_mask;
+      uint32_t v_table_entry;
+      uint32_t v_table_entry_n_bits;
+      uint32_t v_n_extra_bits;
+      uint8_t v_rep_symbol;
+      uint32_t v_rep_count;
+    } c_init_dynamic_huffman[1];
+    struct {
+      uint32_t coro_susp_point;
+      uint32_t v_bits;
+      uint32_t v_n_bits;
+      uint32_t v_table_entry;
+      uint32_t v_table_entry_n_bits;
+      uint32_t v_lmask;
+      uint32_t v_dmask;
+      uint32_t v_redir_top;
+      uint32_t v_redir_mask;
+      uint32_t v_length;
+      uint32_t v_dist_minus_1;
+      uint32_t v_n_copied;
+      uint32_t v_hlen;
+      uint32_t v_hdist;
+    } c_decode_huffman_slow[1];
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+  check_wuffs_version(size_t sizeof_star_self, uint64_t wuffs_version);
+  inline wuffs_base__status decode(wuffs_base__io_writer a_dst,
+                                   wuffs_base__io_reader a_src);
+#endif  // __cplusplus
+
+} wuffs_deflate__decoder;
+
+typedef struct {
+  // Do not access the private_impl's fields directly. There is no API/ABI
+  // compatibility or safety guarantee if you do so. Instead, use the
+  // wuffs_deflate__encoder__etc functions.
+  //
+  // In C++, these fields would be "private", but C does not support that.
+  //
+  // It is a struct, not a struct*, so that it can be stack allocated.
+  struct {
+    uint32_t magic;
+
+    uint32_t f_level;
+    bool f_seen_level;
+    bool f_full_flush;
+    uint32_t f_window_pos;
+    uint32_t f_window_wi;
+    uint32_t f_block_start;
+    uint32_t f_n_symbols;
+    uint64_t f_bits;
+    uint32_t f_n_bits;
+    uint32_t f_out_ri;
+    uint32_t f_out_wi;
+    bool f_out_overflow;
+    uint32_t f_lcode_counts[288];
+    uint32_t f_dcode_counts[32];
+    uint32_t f_clcode_counts[19];
+    uint8_t f_lcode_lengths[288];
+    uint8_t f_dcode_lengths[32];
+    uint8_t f_clcode_lengths[19];
+    uint16_t f_lcode_codes[288];
+    uint16_t f_dcode_codes[32];
+    uint16_t f_clcode_codes[19];
+    uint32_t f_hlit;
+    uint32_t f_hdist;
+    uint32_t f_hclen;
+    uint32_t f_n_cl_symbols;
+    uint8_t f_cl_symbols[320];
+    uint8_t f_cl_extras[320];
+    uint32_t f_huff_counts[512];
+    uint32_t f_huff_keys[512];
+    uint32_t f_huff_syms[512];
+    uint32_t f_huff_keys2[512];
+    uint32_t f_huff_syms2[512];
+    uint8_t f_huff_lengths[512];
+    uint16_t f_huff_codes[512];
+    uint32_t f_huff_hist[256];
+    uint32_t f_huff_num_codes[64];
+    uint32_t f_symbols[16384];
+    uint32_t f_hash_heads[32768];
+    uint32_t f_hash_prevs[32768];
+    uint8_t f_window[65536];
+    uint8_t f_out[66560];
+
+    struct {
+      uint32_t coro_susp_point;
+      uint32_t v_level;
+      uint32_t v_n;
+      uint64_t v_m;
+      bool v_eof;
+      bool v_done;
+    } c_encode[1];
+  } private_impl;
+
+#ifdef __cplusplus
+  inline wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+  check_wuffs_version(size_t sizeof_star_self, uint64_t wuffs_version);
+  inline void set_level(uint32_t a_level);
+  inline void set_full_flush(bool a_full_flush);
+  inline wuffs_base__status encode(wuffs_base__io_writer a_dst,
+                                   wuffs_base__io_reader a_src);
+#endif  // __cplusplus
+
+} wuffs_deflate__encoder;
+
+// ---------------- Public Initializer Prototypes
+
+// wuffs_deflate__decoder__check_wuffs_version is an initializer function.
+//
+// It should be called before any other wuffs_deflate__decoder__* function.
+//
+// Pass sizeof(*self) and WUFFS_VERSION for sizeof_star_self and wuffs_version.
+wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+wuffs_deflate__decoder__check_wuffs_version(wuffs_deflate__decoder* self,
+                                            size_t sizeof_star_self,
+                                            uint64_t wuffs_version);
+
+// wuffs_deflate__encoder__check_wuffs_version is an initializer function.
+//
+// It should be called before any other wuffs_deflate__encoder__* function.
+//
+// Pass sizeof(*self) and WUFFS_VERSION for sizeof_star_self and wuffs_version.
+wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+wuffs_deflate__encoder__check_wuffs_version(wuffs_deflate__encoder* self,
+                                            size_t sizeof_star_self,
+                                            uint64_t wuffs_version);
+
+// ---------------- Public Function Prototypes
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_deflate__decoder__decode(wuffs_deflate__decoder* self,
+                               wuffs_base__io_writer a_dst,
+                               wuffs_base__io_reader a_src);
+
+WUFFS_BASE__MAYBE_STATIC void  //
+wuffs_deflate__encoder__set_level(wuffs_deflate__encoder* self,
+                                  uint32_t a_level);
+
+WUFFS_BASE__MAYBE_STATIC void  //
+wuffs_deflate__encoder__set_full_flush(wuffs_deflate__encoder* self,
+                                       bool a_full_flush);
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_deflate__encoder__encode(wuffs_deflate__encoder* self,
+                               wuffs_base__io_writer a_dst,
+                               wuffs_base__io_reader a_src);
+
+// ---------------- Public Upcast Prototypes
+
+// ---------------- C++ Convenience Methods
+
+#ifdef __cplusplus
+
+inline wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+wuffs_deflate__decoder::check_wuffs_version(size_t sizeof_star_self,
+                                            uint64_t wuffs_version) {
+  return wuffs_deflate__decoder__check_wuffs_version(this, sizeof_star_self,
+                                                     wuffs_version);
+}
+
+inline wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+wuffs_deflate__encoder::check_wuffs_version(size_t sizeof_star_self,
+                                            uint64_t wuffs_version) {
+  return wuffs_deflate__encoder__check_wuffs_version(this, sizeof_star_self,
+                                                     wuffs_version);
+}
+
+inline wuffs_base__status  //
+wuffs_deflate__decoder::decode(wuffs_base__io_writer a_dst,
+                               wuffs_base__io_reader a_src) {
+  return wuffs_deflate__decoder__decode(this, a_dst, a_src);
+}
+
+inline void  //
+wuffs_deflate__encoder::set_level(uint32_t a_level) {
+  return wuffs_deflate__encoder__set_level(this, a_level);
+}
+
+inline void  //
+wuffs_deflate__encoder::set_full_flush(bool a_full_flush) {
+  return wuffs_deflate__encoder__set_full_flush(this, a_full_flush);
+}
+
+inline wuffs_base__status  //
+wuffs_deflate__encoder::encode(wuffs_base__io_writer a_dst,
+                               wuffs_base__io_reader a_src) {
+  return wuffs_deflate__encoder__encode(this, a_dst, a_src);
+}
+
+#endif  // __cplusplus
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#ifdef WUFFS_IMPLEMENTATION
+
+#ifndef WUFFS_INCLUDE_GUARD__BASE_PRIVATE
+#define WUFFS_INCLUDE_GUARD__BASE_PRIVATE
+
+// Copyright 2017 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// WUFFS_BASE__HAVE_SSE2 and WUFFS_BASE__HAVE_SSSE3 are defined when the
+// compiler targets those x86 instruction set extensions, such as SSE2 for any
+// x86_64 CPU, or SSSE3 with "-mssse3", unless WUFFS_CONFIG__NO_SIMD is
+// defined. Wuffs does not detect CPU features at run time.
+#if !defined(WUFFS_CONFIG__NO_SIMD) && defined(__SSE2__)
+#define WUFFS_BASE__HAVE_SSE2
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#define WUFFS_BASE__HAVE_SSSE3
+#include <tmmintrin.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(x) (void)(x)
+
+static inline void wuffs_base__ignore_check_wuffs_version_status(
+    wuffs_base__status z) {}
+
+// WUFFS_BASE__MAGIC is a magic number to check that initializers are called.
+// It's not foolproof, given C doesn't automatically zero memory before use,
+// but it should catch 99.99% of cases.
+//
+// Its (non-zero) value is arbitrary, based on md5sum("wuffs").
+#define WUFFS_BASE__MAGIC ((uint32_t)0x3CCB6C71)
+
+// WUFFS_BASE__DISABLED is a magic number to indicate that a non-recoverable
+// error was previously encountered.
+//
+// Its (non-zero) value is arbitrary, based on md5sum("disabled").
+#define WUFFS_BASE__DISABLED ((uint32_t)0x075AE3D2)
+
+// Denote intentional fallthroughs for -Wimplicit-fallthrough.
+//
+// The order matters here. Clang also defines "__GNUC__".
+#if defined(__clang__) && __cplusplus >= 201103L
+#define WUFFS_BASE__FALLTHROUGH [[clang::fallthrough]]
+#elif !defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 7)
+#define WUFFS_BASE__FALLTHROUGH __attribute__((fallthrough))
+#else
+#define WUFFS_BASE__FALLTHROUGH
+#endif
+
+// Use switch cases for coroutine suspension points, similar to the technique
+// in https://www.chiark.greenend.org.uk/~sgtatham/coroutines.html
+//
+// We use trivial macros instead of an explicit assignment and case statement
+// so that clang-format doesn't get confused by the unusual "case"s.
+#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0 case 0:;
+#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT(n) \
+  coro_susp_point = n;                            \
+  WUFFS_BASE__FALLTHROUGH;                        \
+  case n:;
+
+#define WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(n) \
+  if (!status) {                                                \
+    goto ok;                                                    \
+  } else if (*status != '$') {                                  \
+    goto exit;                                                  \
+  }                                                             \
+  coro_susp_point = n;                                          \
+  goto suspend;                                                 \
+  case n:;
+
+// Clang also defines "__GNUC__".
+#if defined(__GNUC__)
+#define WUFFS_BASE__LIKELY(expr) (__builtin_expect(!!(expr), 1))
+#define WUFFS_BASE__UNLIKELY(expr) (__builtin_expect(!!(expr), 0))
+#else
+#define WUFFS_BASE__LIKELY(expr) (expr)
+#define WUFFS_BASE__UNLIKELY(expr) (expr)
+#endif
+
+// The helpers below are functions, instead of macros, because their arguments
+// can be an expression that we shouldn't evaluate more than once.
+//
+// They are static, so that linking multiple wuffs .o files won't complain about
+// duplicate function definitions.
+//
+// They are explicitly marked inline, even if modern compilers don't use the
+// inline attribute to guide optimizations such as inlining, to avoid the
+// -Wunused-function warning, and we like to compile with -Wall -Werror.
+
+static inline wuffs_base__empty_struct  //
+wuffs_base__return_empty_struct() {
+  return ((wuffs_base__empty_struct){});
+}
+
+// ---------------- Numeric Types
+
+static inline uint8_t  //
+wuffs_base__load_u8be(uint8_t* p) {
+  return p[0];
+}
+
+static inline uint16_t  //
+wuffs_base__load_u16be(uint8_t* p) {
+  return ((uint16_t)(p[0]) << 8) | ((uint16_t)(p[1]) << 0);
+}
+
+static inline uint16_t  //
+wuffs_base__load_u16le(uint8_t* p) {
+  return ((uint16_t)(p[0]) << 0) | ((uint16_t)(p[1]) << 8);
+}
+
+static inline uint32_t  //
+wuffs_base__load_u24be(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 16) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 0);
+}
+
+static inline uint32_t  //
+wuffs_base__load_u24le(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 16);
+}
+
+static inline uint32_t  //
+wuffs_base__load_u32be(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 24) | ((uint32_t)(p[1]) << 16) |
+         ((uint32_t)(p[2]) << 8) | ((uint32_t)(p[3]) << 0);
+}
+
+static inline uint32_t  //
+wuffs_base__load_u32le(uint8_t* p) {
+  return ((uint32_t)(p[0]) << 0) | ((uint32_t)(p[1]) << 8) |
+         ((uint32_t)(p[2]) << 16) | ((uint32_t)(p[3]) << 24);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u40be(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 32) | ((uint64_t)(p[1]) << 24) |
+         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 8) |
+         ((uint64_t)(p[4]) << 0);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u40le(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 0) | ((uint64_t)(p[1]) << 8) |
+         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 24) |
+         ((uint64_t)(p[4]) << 32);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u48be(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 40) | ((uint64_t)(p[1]) << 32) |
+         ((uint64_t)(p[2]) << 24) | ((uint64_t)(p[3]) << 16) |
+         ((uint64_t)(p[4]) << 8) | ((uint64_t)(p[5]) << 0);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u48le(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 0) | ((uint64_t)(p[1]) << 8) |
+         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 24) |
+         ((uint64_t)(p[4]) << 32) | ((uint64_t)(p[5]) << 40);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u56be(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 48) | ((uint64_t)(p[1]) << 40) |
+         ((uint64_t)(p[2]) << 32) | ((uint64_t)(p[3]) << 24) |
+         ((uint64_t)(p[4]) << 16) | ((uint64_t)(p[5]) << 8) |
+         ((uint64_t)(p[6]) << 0);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u56le(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 0) | ((uint64_t)(p[1]) << 8) |
+         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 24) |
+         ((uint64_t)(p[4]) << 32) | ((uint64_t)(p[5]) << 40) |
+         ((uint64_t)(p[6]) << 48);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u64be(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 56) | ((uint64_t)(p[1]) << 48) |
+         ((uint64_t)(p[2]) << 40) | ((uint64_t)(p[3]) << 32) |
+         ((uint64_t)(p[4]) << 24) | ((uint64_t)(p[5]) << 16) |
+         ((uint64_t)(p[6]) << 8) | ((uint64_t)(p[7]) << 0);
+}
+
+static inline uint64_t  //
+wuffs_base__load_u64le(uint8_t* p) {
+  return ((uint64_t)(p[0]) << 0) | ((uint64_t)(p[1]) << 8) |
+         ((uint64_t)(p[2]) << 16) | ((uint64_t)(p[3]) << 24) |
+         ((uint64_t)(p[4]) << 32) | ((uint64_t)(p[5]) << 40) |
+         ((uint64_t)(p[6]) << 48) | ((uint64_t)(p[7]) << 56);
+}
+
+// --------
+
+static inline void  //
+wuffs_base__store_u8be(uint8_t* p, uint8_t x) {
+  p[0] = x;
+}
+
+static inline void  //
+wuffs_base__store_u16be(uint8_t* p, uint16_t x) {
+  p[0] = x >> 8;
+  p[1] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u16le(uint8_t* p, uint16_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+}
+
+static inline void  //
+wuffs_base__store_u24be(uint8_t* p, uint32_t x) {
+  p[0] = x >> 16;
+  p[1] = x >> 8;
+  p[2] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u24le(uint8_t* p, uint32_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+  p[2] = x >> 16;
+}
+
+static inline void  //
+wuffs_base__store_u32be(uint8_t* p, uint32_t x) {
+  p[0] = x >> 24;
+  p[1] = x >> 16;
+  p[2] = x >> 8;
+  p[3] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u32le(uint8_t* p, uint32_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+  p[2] = x >> 16;
+  p[3] = x >> 24;
+}
+
+static inline void  //
+wuffs_base__store_u40be(uint8_t* p, uint64_t x) {
+  p[0] = x >> 32;
+  p[1] = x >> 24;
+  p[2] = x >> 16;
+  p[3] = x >> 8;
+  p[4] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u40le(uint8_t* p, uint64_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+  p[2] = x >> 16;
+  p[3] = x >> 24;
+  p[4] = x >> 32;
+}
+
+static inline void  //
+wuffs_base__store_u48be(uint8_t* p, uint64_t x) {
+  p[0] = x >> 40;
+  p[1] = x >> 32;
+  p[2] = x >> 24;
+  p[3] = x >> 16;
+  p[4] = x >> 8;
+  p[5] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u48le(uint8_t* p, uint64_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+  p[2] = x >> 16;
+  p[3] = x >> 24;
+  p[4] = x >> 32;
+  p[5] = x >> 40;
+}
+
+static inline void  //
+wuffs_base__store_u56be(uint8_t* p, uint64_t x) {
+  p[0] = x >> 48;
+  p[1] = x >> 40;
+  p[2] = x >> 32;
+  p[3] = x >> 24;
+  p[4] = x >> 16;
+  p[5] = x >> 8;
+  p[6] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u56le(uint8_t* p, uint64_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+  p[2] = x >> 16;
+  p[3] = x >> 24;
+  p[4] = x >> 32;
+  p[5] = x >> 40;
+  p[6] = x >> 48;
+}
+
+static inline void  //
+wuffs_base__store_u64be(uint8_t* p, uint64_t x) {
+  p[0] = x >> 56;
+  p[1] = x >> 48;
+  p[2] = x >> 40;
+  p[3] = x >> 32;
+  p[4] = x >> 24;
+  p[5] = x >> 16;
+  p[6] = x >> 8;
+  p[7] = x >> 0;
+}
+
+static inline void  //
+wuffs_base__store_u64le(uint8_t* p, uint64_t x) {
+  p[0] = x >> 0;
+  p[1] = x >> 8;
+  p[2] = x >> 16;
+  p[3] = x >> 24;
+  p[4] = x >> 32;
+  p[5] = x >> 40;
+  p[6] = x >> 48;
+  p[7] = x >> 56;
+}
+
+// --------
+
+static inline void  //
+wuffs_base__u8__sat_add_indirect(uint8_t* x, uint8_t y) {
+  *x = wuffs_base__u8__sat_add(*x, y);
+}
+
+static inline void  //
+wuffs_base__u8__sat_sub_indirect(uint8_t* x, uint8_t y) {
+  *x = wuffs_base__u8__sat_sub(*x, y);
+}
+
+static inline void  //
+wuffs_base__u16__sat_add_indirect(uint16_t* x, uint16_t y) {
+  *x = wuffs_base__u16__sat_add(*x, y);
+}
+
+static inline void  //
+wuffs_base__u16__sat_sub_indirect(uint16_t* x, uint16_t y) {
+  *x = wuffs_base__u16__sat_sub(*x, y);
+}
+
+static inline void  //
+wuffs_base__u32__sat_add_indirect(uint32_t* x, uint32_t y) {
+  *x = wuffs_base__u32__sat_add(*x, y);
+}
+
+static inline void  //
+wuffs_base__u32__sat_sub_indirect(uint32_t* x, uint32_t y) {
+  *x = wuffs_base__u32__sat_sub(*x, y);
+}
+
+static inline void  //
+wuffs_base__u64__sat_add_indirect(uint64_t* x, uint64_t y) {
+  *x = wuffs_base__u64__sat_add(*x, y);
+}
+
+static inline void  //
+wuffs_base__u64__sat_sub_indirect(uint64_t* x, uint64_t y) {
+  *x = wuffs_base__u64__sat_sub(*x, y);
+}
+
+// ---------------- Slices and Tables
+
+// wuffs_base__slice_u8__prefix returns up to the first up_to bytes of s.
+static inline wuffs_base__slice_u8  //
+wuffs_base__slice_u8__prefix(wuffs_base__slice_u8 s, uint64_t up_to) {
+  if ((uint64_t)(s.len) > up_to) {
+    s.len = up_to;
+  }
+  return s;
+}
+
+// wuffs_base__slice_u8__suffix returns up to the last up_to bytes of s.
+static inline wuffs_base__slice_u8  //
+wuffs_base__slice_u8__suffix(wuffs_base__slice_u8 s, uint64_t up_to) {
+  if ((uint64_t)(s.len) > up_to) {
+    s.ptr += (uint64_t)(s.len) - up_to;
+    s.len = up_to;
+  }
+  return s;
+}
+
+// wuffs_base__slice_u8__copy_from_slice calls memmove(dst.ptr, src.ptr,
+// length) where length is the minimum of dst.len and src.len.
+//
+// Passing a wuffs_base__slice_u8 with all fields NULL or zero (a valid, empty
+// slice) is valid and results in a no-op.
+static inline uint64_t  //
+wuffs_base__slice_u8__copy_from_slice(wuffs_base__slice_u8 dst,
+                                      wuffs_base__slice_u8 src) {
+  size_t length = dst.len < src.len ? dst.len : src.len;
+  if (length > 0) {
+    memmove(dst.ptr, src.ptr, length);
+  }
+  return length;
+}
+
+// --------
+
+static inline wuffs_base__slice_u8  //
+wuffs_base__table_u8__row(wuffs_base__table_u8 t, uint32_t y) {
+  if (y < t.height) {
+    return ((wuffs_base__slice_u8){
+        .ptr = t.ptr + (t.stride * y),
+        .len = t.width,
+    });
+  }
+  return ((wuffs_base__slice_u8){});
+}
+
+// ---------------- Unfilters
+
+// The wuffs_base__slice_u8__unfilter_etc functions undo, in place, the PNG
+// image format's per-row filters (Sub, Up, Average and Paeth), which predict
+// each byte from the byte distance bytes to its left (or zero, if there is
+// none) and from the byte above it in prev. An empty prev means that the row
+// above is all zeroes, as it is for an image's first row. Otherwise, only the
+// first min(curr.len, prev.len) bytes of curr are unfiltered. The distance is
+// the number of bytes per (whole) pixel, from 1 to 8, and zero is a no-op.
+//
+// When WUFFS_BASE__HAVE_SSE2 is defined, Average and Paeth with distances of 3
+// and 4 (RGB and RGBA) process a pixel at a time in SIMD registers. The
+// __fallback variants are portable C, used for other distances and for CPUs
+// without SSE2. Sub and Up always use them: compilers already vectorize Up,
+// and Sub's byte loop, with distance independent dependency chains, measured
+// faster than a pixel at a time SSE2 loop.
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_sub__fallback(wuffs_base__slice_u8 curr,
+                                             uint32_t distance) {
+  if ((distance == 0) || (distance > curr.len)) {
+    return;
+  }
+  uint8_t* c = curr.ptr + distance;
+  uint8_t* end = curr.ptr + curr.len;
+  for (; c < end; c++) {
+    c[0] += *(c - distance);
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_up__fallback(wuffs_base__slice_u8 curr,
+                                            wuffs_base__slice_u8 prev) {
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    curr.ptr[i] += prev.ptr[i];
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_average__fallback(wuffs_base__slice_u8 curr,
+                                                 wuffs_base__slice_u8 prev,
+                                                 uint32_t distance) {
+  if ((distance == 0) || (distance > curr.len)) {
+    return;
+  }
+  size_t i;
+  if (prev.len == 0) {
+    for (i = distance; i < curr.len; i++) {
+      curr.ptr[i] += curr.ptr[i - distance] / 2;
+    }
+    return;
+  }
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  for (i = 0; (i < distance) && (i < n); i++) {
+    curr.ptr[i] += prev.ptr[i] / 2;
+  }
+  for (; i < n; i++) {
+    curr.ptr[i] += (uint8_t)(((uint32_t)(curr.ptr[i - distance]) +
+                              (uint32_t)(prev.ptr[i])) /
+                             2);
+  }
+}
+
+// wuffs_base__private_paeth returns whichever of a (left), b (above) and c
+// (above-left) is closest to (a + b - c), breaking ties in that order.
+static inline uint8_t  //
+wuffs_base__private_paeth(uint8_t a, uint8_t b, uint8_t c) {
+  int32_t pa = (int32_t)(b) - (int32_t)(c);
+  int32_t pb = (int32_t)(a) - (int32_t)(c);
+  int32_t pc = pa + pb;
+  pa = pa < 0 ? -pa : pa;
+  pb = pb < 0 ? -pb : pb;
+  pc = pc < 0 ? -pc : pc;
+  if ((pa <= pb) && (pa <= pc)) {
+    return a;
+  } else if (pb <= pc) {
+    return b;
+  }
+  return c;
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_paeth__fallback(wuffs_base__slice_u8 curr,
+                                               wuffs_base__slice_u8 prev,
+                                               uint32_t distance) {
+  if (prev.len == 0) {
+    // With a row of zeroes above, the Paeth predictor is the left byte.
+    wuffs_base__slice_u8__unfilter_sub__fallback(curr, distance);
+    return;
+  }
+  if ((distance == 0) || (distance > curr.len)) {
+    return;
+  }
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  size_t i;
+  for (i = 0; (i < distance) && (i < n); i++) {
+    curr.ptr[i] += prev.ptr[i];
+  }
+  for (; i < n; i++) {
+    curr.ptr[i] += wuffs_base__private_paeth(
+        curr.ptr[i - distance], prev.ptr[i], prev.ptr[i - distance]);
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_load_pixel and wuffs_base__private_store_pixel move a 3
+// or 4 byte pixel between memory and the low bytes of a SIMD register,
+// without touching any memory beyond that pixel. A 3 byte pixel is assembled
+// in a general purpose register, not via memcpy to and from the stack, as
+// mixing narrow stores with a wide load stalls store-to-load forwarding.
+static inline __m128i  //
+wuffs_base__private_load_pixel(uint8_t* p, uint32_t distance) {
+  uint32_t x =
+      (distance == 3) ? wuffs_base__load_u24le(p) : wuffs_base__load_u32le(p);
+  return _mm_cvtsi32_si128((int)(x));
+}
+
+static inline void  //
+wuffs_base__private_store_pixel(uint8_t* p, __m128i v, uint32_t distance) {
+  uint32_t x = (uint32_t)(_mm_cvtsi128_si32(v));
+  if (distance == 3) {
+    wuffs_base__store_u24le(p, x);
+  } else {
+    wuffs_base__store_u32le(p, x);
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_average__sse2(wuffs_base__slice_u8 curr,
+                                             wuffs_base__slice_u8 prev,
+                                             uint32_t distance) {
+  __m128i one = _mm_set1_epi8(1);
+  __m128i a = _mm_setzero_si128();
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  uint8_t* c = curr.ptr;
+  uint8_t* p = prev.ptr;
+  for (; n >= distance; n -= distance, c += distance, p += distance) {
+    // _mm_avg_epu8 rounds up, but the Average filter rounds down.
+    __m128i b = wuffs_base__private_load_pixel(p, distance);
+    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                               _mm_and_si128(_mm_xor_si128(a, b), one));
+    a = _mm_add_epi8(avg, wuffs_base__private_load_pixel(c, distance));
+    wuffs_base__private_store_pixel(c, a, distance);
+  }
+  for (; n > 0; n--, c++, p++) {
+    c[0] += (uint8_t)(((uint32_t)(*(c - distance)) + p[0]) / 2);
+  }
+}
+
+static inline __m128i  //
+wuffs_base__private_abs_epi16(__m128i x) {
+#if defined(WUFFS_BASE__HAVE_SSSE3)
+  return _mm_abs_epi16(x);
+#else
+  return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+#endif
+}
+
+// wuffs_base__slice_u8__unfilter_paeth__sse2 widens each pixel's bytes to 16
+// bit lanes, so that the Paeth distances can be computed without overflow.
+static inline void  //
+wuffs_base__slice_u8__unfilter_paeth__sse2(wuffs_base__slice_u8 curr,
+                                           wuffs_base__slice_u8 prev,
+                                           uint32_t distance) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i a = zero;
+  __m128i c = zero;
+  size_t n = curr.len < prev.len ? curr.len : prev.len;
+  uint8_t* q = curr.ptr;
+  uint8_t* p = prev.ptr;
+  for (; n >= distance; n -= distance, q += distance, p += distance) {
+    __m128i b =
+        _mm_unpacklo_epi8(wuffs_base__private_load_pixel(p, distance), zero);
+    __m128i x =
+        _mm_unpacklo_epi8(wuffs_base__private_load_pixel(q, distance), zero);
+    __m128i pa = _mm_sub_epi16(b, c);
+    __m128i pb = _mm_sub_epi16(a, c);
+    __m128i pc = wuffs_base__private_abs_epi16(_mm_add_epi16(pa, pb));
+    pa = wuffs_base__private_abs_epi16(pa);
+    pb = wuffs_base__private_abs_epi16(pb);
+    // Select a, else b, else c, breaking ties in that order.
+    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+    __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+    __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+    __m128i use_c =
+        _mm_andnot_si128(_mm_or_si128(use_a, use_b), _mm_set1_epi16(-1));
+    __m128i predictor = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),
+        _mm_and_si128(use_c, c));
+    // The high byte of each 16 bit lane is zero in both x and predictor, so
+    // a byte-wise add wraps modulo 256 and keeps those high bytes zero.
+    a = _mm_add_epi8(x, predictor);
+    c = b;
+    wuffs_base__private_store_pixel(q, _mm_packus_epi16(a, a), distance);
+  }
+  for (; n > 0; n--, q++, p++) {
+    q[0] += wuffs_base__private_paeth(*(q - distance), p[0], *(p - distance));
+  }
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_sub(wuffs_base__slice_u8 curr,
+                                   uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_sub__fallback(curr, distance);
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_up(wuffs_base__slice_u8 curr,
+                                  wuffs_base__slice_u8 prev) {
+  wuffs_base__slice_u8__unfilter_up__fallback(curr, prev);
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_average(wuffs_base__slice_u8 curr,
+                                       wuffs_base__slice_u8 prev,
+                                       uint32_t distance) {
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  if (((distance == 3) || (distance == 4)) && (distance <= curr.len) &&
+      (distance <= prev.len)) {
+    wuffs_base__slice_u8__unfilter_average__sse2(curr, prev, distance);
+    return;
+  }
+#endif
+  wuffs_base__slice_u8__unfilter_average__fallback(curr, prev, distance);
+}
+
+static inline void  //
+wuffs_base__slice_u8__unfilter_paeth(wuffs_base__slice_u8 curr,
+                                     wuffs_base__slice_u8 prev,
+                                     uint32_t distance) {
+  if (prev.len == 0) {
+    // With a row of zeroes above, the Paeth predictor is the left byte.
+    wuffs_base__slice_u8__unfilter_sub(curr, distance);
+    return;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  if (((distance == 3) || (distance == 4)) && (distance <= curr.len) &&
+      (distance <= prev.len)) {
+    wuffs_base__slice_u8__unfilter_paeth__sse2(curr, prev, distance);
+    return;
+  }
+#endif
+  wuffs_base__slice_u8__unfilter_paeth__fallback(curr, prev, distance);
+}
+
+// ---------------- Filters
+
+// The wuffs_base__slice_u8__filter_etc functions apply the PNG image format's
+// per-row filters (None, Sub, Up, Average and Paeth) to curr, writing the
+// filtered bytes to dst. They are the inverse of the unfilter_etc functions,
+// with the same prev and distance conventions, except that curr is not
+// modified, dst must not overlap curr or prev, and a zero distance (for every
+// filter but None and Up) means that nothing is written. Only the first
+// min(dst.len, curr.len) bytes are filtered, or fewer if prev is non-empty
+// but shorter than that.
+//
+// They return the sum, over the filtered bytes, of each byte's absolute value
+// when read as a signed byte. Picking the filter with the smallest sum is the
+// "minimum sum of absolute differences" heuristic that the PNG specification
+// recommends, and that libpng uses by default.
+//
+// When WUFFS_BASE__HAVE_SSE2 is defined, every filter processes 16 bytes at a
+// time, for any distance. Unlike unfiltering, every filtered byte depends only
+// on the unfiltered curr and prev bytes, so there are no dependency chains.
+
+// wuffs_base__private_sum_abs_i8 returns the sum of the absolute values of
+// the n bytes at p, as signed bytes.
+static inline uint64_t  //
+wuffs_base__private_sum_abs_i8(uint8_t* p, size_t n) {
+  uint64_t sum = 0;
+  for (; n > 0; n--, p++) {
+    sum += (p[0] < 0x80) ? p[0] : (0x100 - (uint32_t)(p[0]));
+  }
+  return sum;
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_none(wuffs_base__slice_u8 dst,
+                                  wuffs_base__slice_u8 curr) {
+  size_t n = dst.len < curr.len ? dst.len : curr.len;
+  if (n > 0) {
+    memmove(dst.ptr, curr.ptr, n);
+  }
+  return wuffs_base__private_sum_abs_i8(dst.ptr, n);
+}
+
+// wuffs_base__private_filter_len returns how many bytes the filter_etc
+// functions filter.
+static inline size_t  //
+wuffs_base__private_filter_len(wuffs_base__slice_u8 dst,
+                               wuffs_base__slice_u8 curr,
+                               wuffs_base__slice_u8 prev) {
+  size_t n = dst.len < curr.len ? dst.len : curr.len;
+  if ((prev.len > 0) && (n > prev.len)) {
+    n = prev.len;
+  }
+  return n;
+}
+
+// wuffs_base__private_filter_etc_1 filters the i'th byte, for one of the
+// Sub, Up, Average and Paeth filters (numbered 1 to 4, as per the PNG
+// specification), when prev is not empty and i >= distance.
+static inline uint8_t  //
+wuffs_base__private_filter_etc_1(uint8_t* c,
+                                 uint8_t* p,
+                                 size_t i,
+                                 uint32_t distance,
+                                 uint32_t filter) {
+  switch (filter) {
+    case 1:
+      return c[i] - c[i - distance];
+    case 2:
+      return c[i] - p[i];
+    case 3:
+      return c[i] -
+             (uint8_t)(((uint32_t)(c[i - distance]) + (uint32_t)(p[i])) / 2);
+  }
+  return c[i] -
+         wuffs_base__private_paeth(c[i - distance], p[i], p[i - distance]);
+}
+
+// wuffs_base__private_filter_etc__fallback filters curr, for one of the Sub,
+// Up, Average and Paeth filters, starting at the i'th byte.
+static inline uint64_t  //
+wuffs_base__private_filter_etc__fallback(wuffs_base__slice_u8 dst,
+                                         wuffs_base__slice_u8 curr,
+                                         wuffs_base__slice_u8 prev,
+                                         uint32_t distance,
+                                         uint32_t filter,
+                                         size_t i) {
+  size_t n = wuffs_base__private_filter_len(dst, curr, prev);
+  size_t i0 = i;
+  uint8_t* d = dst.ptr;
+  uint8_t* c = curr.ptr;
+  uint8_t* p = prev.ptr;
+
+  // The first distance bytes have no left neighbor, which the filters treat
+  // as zero. So does an empty prev.
+  if (prev.len == 0) {
+    for (; i < n; i++) {
+      uint8_t a = (i >= distance) ? c[i - distance] : 0;
+      switch (filter) {
+        case 1:
+        case 4:
+          d[i] = c[i] - a;
+          break;
+        case 2:
+          d[i] = c[i];
+          break;
+        default:
+          d[i] = c[i] - (a / 2);
+          break;
+      }
+    }
+    return wuffs_base__private_sum_abs_i8(d + i0, n - i0);
+  }
+  for (; (i < distance) && (i < n); i++) {
+    switch (filter) {
+      case 1:
+        d[i] = c[i];
+        break;
+      case 3:
+        d[i] = c[i] - (p[i] / 2);
+        break;
+      default:
+        d[i] = c[i] - p[i];
+        break;
+    }
+  }
+  for (; i < n; i++) {
+    d[i] = wuffs_base__private_filter_etc_1(c, p, i, distance, filter);
+  }
+  return wuffs_base__private_sum_abs_i8(d + i0, n - i0);
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_sum_abs_i8__sse2 adds, to the two 64 bit lanes of acc,
+// the sum of the absolute values of v's 16 signed bytes.
+static inline __m128i  //
+wuffs_base__private_sum_abs_i8__sse2(__m128i acc, __m128i v) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i abs = _mm_min_epu8(v, _mm_sub_epi8(zero, v));
+  return _mm_add_epi64(acc, _mm_sad_epu8(abs, zero));
+}
+
+// wuffs_base__private_paeth_epi16 returns the Paeth predictor for 8 lanes of
+// 16 bit values, each of which holds a byte.
+static inline __m128i  //
+wuffs_base__private_paeth_epi16(__m128i a, __m128i b, __m128i c) {
+  __m128i pa = _mm_sub_epi16(b, c);
+  __m128i pb = _mm_sub_epi16(a, c);
+  __m128i pc = wuffs_base__private_abs_epi16(_mm_add_epi16(pa, pb));
+  pa = wuffs_base__private_abs_epi16(pa);
+  pb = wuffs_base__private_abs_epi16(pb);
+  // Select a, else b, else c, breaking ties in that order.
+  __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+  __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+  __m128i use_b = _mm_andnot_si128(use_a, _mm_cmpeq_epi16(smallest, pb));
+  __m128i use_c =
+      _mm_andnot_si128(_mm_or_si128(use_a, use_b), _mm_set1_epi16(-1));
+  return _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(use_a, a), _mm_and_si128(use_b, b)),
+      _mm_and_si128(use_c, c));
+}
+
+// wuffs_base__private_filter_etc__sse2 is like the __fallback version, but
+// filters 16 bytes at a time. It requires a non-empty prev and, for every
+// filter other than Up, a non-zero distance.
+static inline uint64_t  //
+wuffs_base__private_filter_etc__sse2(wuffs_base__slice_u8 dst,
+                                     wuffs_base__slice_u8 curr,
+                                     wuffs_base__slice_u8 prev,
+                                     uint32_t distance,
+                                     uint32_t filter) {
+  size_t n = wuffs_base__private_filter_len(dst, curr, prev);
+  uint8_t* d = dst.ptr;
+  uint8_t* c = curr.ptr;
+  uint8_t* p = prev.ptr;
+  uint64_t sum = 0;
+  size_t i = 0;
+  if (filter != 2) {
+    // Filter the first distance bytes, which have no left neighbor.
+    wuffs_base__slice_u8 d0 = dst;
+    d0.len = n < distance ? n : distance;
+    sum = wuffs_base__private_filter_etc__fallback(d0, curr, prev, distance,
+                                                   filter, 0);
+    i = d0.len;
+  }
+
+  __m128i zero = _mm_setzero_si128();
+  __m128i one = _mm_set1_epi8(1);
+  __m128i acc = zero;
+  for (; (n - i) >= 16; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(c + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(p + i));
+    __m128i v;
+    if (filter == 2) {
+      v = _mm_sub_epi8(x, b);
+    } else {
+      __m128i a = _mm_loadu_si128((const __m128i*)(c + i - distance));
+      if (filter == 1) {
+        v = _mm_sub_epi8(x, a);
+      } else if (filter == 3) {
+        // _mm_avg_epu8 rounds up, but the Average filter rounds down.
+        __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                   _mm_and_si128(_mm_xor_si128(a, b), one));
+        v = _mm_sub_epi8(x, avg);
+      } else {
+        __m128i q = _mm_loadu_si128((const __m128i*)(p + i - distance));
+        __m128i lo = wuffs_base__private_paeth_epi16(
+            _mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero),
+            _mm_unpacklo_epi8(q, zero));
+        __m128i hi = wuffs_base__private_paeth_epi16(
+            _mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero),
+            _mm_unpackhi_epi8(q, zero));
+        v = _mm_sub_epi8(x, _mm_packus_epi16(lo, hi));
+      }
+    }
+    _mm_storeu_si128((__m128i*)(d + i), v);
+    acc = wuffs_base__private_sum_abs_i8__sse2(acc, v);
+  }
+  uint64_t lanes[2];
+  _mm_storeu_si128((__m128i*)(lanes), acc);
+  sum += lanes[0] + lanes[1];
+
+  for (; i < n; i++) {
+    d[i] = wuffs_base__private_filter_etc_1(c, p, i, distance, filter);
+    sum += (d[i] < 0x80) ? d[i] : (0x100 - (uint32_t)(d[i]));
+  }
+  return sum;
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+// wuffs_base__private_filter_etc dispatches to the __sse2 or __fallback
+// implementation.
+static inline uint64_t  //
+wuffs_base__private_filter_etc(wuffs_base__slice_u8 dst,
+                               wuffs_base__slice_u8 curr,
+                               wuffs_base__slice_u8 prev,
+                               uint32_t distance,
+                               uint32_t filter) {
+  if ((distance == 0) && (filter != 2)) {
+    return 0;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  if (prev.len > 0) {
+    return wuffs_base__private_filter_etc__sse2(dst, curr, prev, distance,
+                                                filter);
+  }
+#endif
+  return wuffs_base__private_filter_etc__fallback(dst, curr, prev, distance,
+                                                  filter, 0);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_sub(wuffs_base__slice_u8 dst,
+                                 wuffs_base__slice_u8 curr,
+                                 uint32_t distance) {
+  // Sub does not look at prev, but the SIMD code path requires a non-empty
+  // prev. Passing curr as prev is harmless.
+  return wuffs_base__private_filter_etc(dst, curr, curr, distance, 1);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_up(wuffs_base__slice_u8 dst,
+                                wuffs_base__slice_u8 curr,
+                                wuffs_base__slice_u8 prev) {
+  return wuffs_base__private_filter_etc(dst, curr, prev, 0, 2);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_average(wuffs_base__slice_u8 dst,
+                                     wuffs_base__slice_u8 curr,
+                                     wuffs_base__slice_u8 prev,
+                                     uint32_t distance) {
+  return wuffs_base__private_filter_etc(dst, curr, prev, distance, 3);
+}
+
+static inline uint64_t  //
+wuffs_base__slice_u8__filter_paeth(wuffs_base__slice_u8 dst,
+                                   wuffs_base__slice_u8 curr,
+                                   wuffs_base__slice_u8 prev,
+                                   uint32_t distance) {
+  return wuffs_base__private_filter_etc(dst, curr, prev, distance, 4);
+}
+
+// ---------------- JPEG
+
+// wuffs_base__slice_u8__idct_8x8 undoes the JPEG image format's 8×8 forward
+// DCT (Discrete Cosine Transform). coeffs holds the 64 coefficients (as signed
+// 16 bit little-endian integers) and quant the 64 quantization factors (as
+// unsigned 16 bit little-endian integers) to multiply them by, both in natural
+// (row major), not zig-zag, order. The 8×8 block of samples, level shifted by
+// +128 and clamped to the range [0, 255], is written to dst, whose rows are
+// stride bytes apart. It is a no-op if any of the slices are too short.
+//
+// The arithmetic is libjpeg's "islow" (accurate integer) algorithm, with 13
+// bits of fixed point precision and 2 extra bits between the two passes, so
+// that the output matches libjpeg's, and libjpeg-turbo's, exactly. When
+// WUFFS_BASE__HAVE_SSE2 is defined, each pass transforms all 8 columns (or
+// rows) at once, in 16 bit lanes that are widened to 32 bits for the
+// multiplications.
+//
+// Hostile input can hold arbitrary coefficients and 16 bit quantization
+// factors. Both the dequantized coefficients and the first pass's outputs
+// therefore saturate to [-0x4000, +0x3FFF], far beyond what a conforming JPEG
+// encoder produces. Within that range, no 32 bit (or, for SSE2's additions, 16
+// bit) arithmetic can overflow, so the SSE2 and fallback implementations give
+// identical output for every input.
+
+// wuffs_base__private_idct_saturate clamps v to [-0x4000, +0x3FFF].
+static inline int32_t  //
+wuffs_base__private_idct_saturate(int32_t v) {
+  return (v < -0x4000) ? -0x4000 : (v > 0x3FFF) ? 0x3FFF : v;
+}
+
+// wuffs_base__private_idct_dequantize multiplies the i16le coefficient at c by
+// the u16le quantization factor at q. The product cannot overflow an int32_t,
+// as 0x8000 * 0xFFFF < 0x80000000.
+static inline int32_t  //
+wuffs_base__private_idct_dequantize(uint8_t* c, uint8_t* q) {
+  return wuffs_base__private_idct_saturate(
+      ((int32_t)((int16_t)(wuffs_base__load_u16le(c)))) *
+      ((int32_t)(wuffs_base__load_u16le(q))));
+}
+
+static inline void  //
+wuffs_base__private_idct_1d(int32_t* v, uint32_t shift) {
+  // Even part.
+  int32_t z1 = (v[2] + v[6]) * 4433;    // FIX(0.541196100)
+  int32_t tmp2 = z1 + (v[6] * -15137);  // FIX(1.847759065)
+  int32_t tmp3 = z1 + (v[2] * 6270);    // FIX(0.765366865)
+  int32_t tmp0 = (int32_t)((uint32_t)(v[0] + v[4]) << 13);
+  int32_t tmp1 = (int32_t)((uint32_t)(v[0] - v[4]) << 13);
+  int32_t tmp10 = tmp0 + tmp3;
+  int32_t tmp13 = tmp0 - tmp3;
+  int32_t tmp11 = tmp1 + tmp2;
+  int32_t tmp12 = tmp1 - tmp2;
+
+  // Odd part.
+  tmp0 = v[7];
+  tmp1 = v[5];
+  tmp2 = v[3];
+  tmp3 = v[1];
+  z1 = tmp0 + tmp3;
+  int32_t z2 = tmp1 + tmp2;
+  int32_t z3 = tmp0 + tmp2;
+  int32_t z4 = tmp1 + tmp3;
+  int32_t z5 = (z3 + z4) * 9633;  // FIX(1.175875602)
+  tmp0 *= 2446;                   // FIX(0.298631336)
+  tmp1 *= 16819;                  // FIX(2.053119869)
+  tmp2 *= 25172;                  // FIX(3.072711026)
+  tmp3 *= 12299;                  // FIX(1.501321110)
+  z1 *= -7373;                    // FIX(0.899976223)
+  z2 *= -20995;                   // FIX(2.562915447)
+  z3 *= -16069;                   // FIX(1.961570560)
+  z4 *= -3196;                    // FIX(0.390180644)
+  z3 += z5;
+  z4 += z5;
+  tmp0 += z1 + z3;
+  tmp1 += z2 + z4;
+  tmp2 += z2 + z3;
+  tmp3 += z1 + z4;
+
+  int32_t bias = ((int32_t)1) << (shift - 1);
+  v[0] = (tmp10 + tmp3 + bias) >> shift;
+  v[7] = (tmp10 - tmp3 + bias) >> shift;
+  v[1] = (tmp11 + tmp2 + bias) >> shift;
+  v[6] = (tmp11 - tmp2 + bias) >> shift;
+  v[2] = (tmp12 + tmp1 + bias) >> shift;
+  v[5] = (tmp12 - tmp1 + bias) >> shift;
+  v[3] = (tmp13 + tmp0 + bias) >> shift;
+  v[4] = (tmp13 - tmp0 + bias) >> shift;
+}
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8__fallback(wuffs_base__slice_u8 dst,
+                                         uint64_t stride,
+                                         wuffs_base__slice_u8 coeffs,
+                                         wuffs_base__slice_u8 quant) {
+  int32_t ws[64];
+  int32_t v[8];
+  int x;
+  int y;
+  int k;
+
+  // Pass 1: process columns, dequantizing the input and storing the
+  // (saturated) result, scaled up by 2 bits, in the ws work space.
+  for (x = 0; x < 8; x++) {
+    for (k = 0; k < 8; k++) {
+      v[k] = wuffs_base__private_idct_dequantize(
+          coeffs.ptr + (2 * ((8 * k) + x)), quant.ptr + (2 * ((8 * k) + x)));
+    }
+    wuffs_base__private_idct_1d(v, 11);
+    for (k = 0; k < 8; k++) {
+      ws[(8 * k) + x] = wuffs_base__private_idct_saturate(v[k]);
+    }
+  }
+
+  // Pass 2: process rows, from the work space to dst.
+  for (y = 0; y < 8; y++) {
+    for (k = 0; k < 8; k++) {
+      v[k] = ws[(8 * y) + k];
+    }
+    wuffs_base__private_idct_1d(v, 18);
+    uint8_t* d = dst.ptr + (y * stride);
+    for (k = 0; k < 8; k++) {
+      int32_t s = v[k] + 128;
+      d[k] = (s < 0) ? 0 : (s > 255) ? 255 : ((uint8_t)s);
+    }
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__private_transpose_8x8_epi16(__m128i* r) {
+  __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+  __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+  __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+  __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+  __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+  __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+  __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+  __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+  __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+  __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+  __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+  __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+  __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+  __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+  __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+  __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+  r[0] = _mm_unpacklo_epi64(b0, b4);
+  r[1] = _mm_unpackhi_epi64(b0, b4);
+  r[2] = _mm_unpacklo_epi64(b1, b5);
+  r[3] = _mm_unpackhi_epi64(b1, b5);
+  r[4] = _mm_unpacklo_epi64(b2, b6);
+  r[5] = _mm_unpackhi_epi64(b2, b6);
+  r[6] = _mm_unpacklo_epi64(b3, b7);
+  r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// wuffs_base__private_idct_1d__sse2 is wuffs_base__private_idct_1d for 8
+// independent lanes: v[k] holds every lane's k'th input (and output). The
+// multiplications are paired up, as _mm_madd_epi16 computes (a*b + c*d), by
+// folding the shared z1 .. z5 terms into per-input constants.
+static inline void  //
+wuffs_base__private_idct_1d__sse2(__m128i* v, int shift) {
+  const __m128i k_tmp3 = _mm_set_epi16(4433, 10703, 4433, 10703,  //
+                                       4433, 10703, 4433, 10703);
+  const __m128i k_tmp2 = _mm_set_epi16(-10704, 4433, -10704, 4433,  //
+                                       -10704, 4433, -10704, 4433);
+  const __m128i k_z3 = _mm_set_epi16(9633, -6436, 9633, -6436,  //
+                                     9633, -6436, 9633, -6436);
+  const __m128i k_z4 = _mm_set_epi16(6437, 9633, 6437, 9633,  //
+                                     6437, 9633, 6437, 9633);
+  const __m128i k_tmp0 = _mm_set_epi16(-7373, -4927, -7373, -4927,  //
+                                       -7373, -4927, -7373, -4927);
+  const __m128i k_tmp3o = _mm_set_epi16(4926, -7373, 4926, -7373,  //
+                                        4926, -7373, 4926, -7373);
+  const __m128i k_tmp1 = _mm_set_epi16(-20995, -4176, -20995, -4176,  //
+                                       -20995, -4176, -20995, -4176);
+  const __m128i k_tmp2o = _mm_set_epi16(4177, -20995, 4177, -20995,  //
+                                        4177, -20995, 4177, -20995);
+  const __m128i bias = _mm_set1_epi32(1 << (shift - 1));
+  const __m128i zero = _mm_setzero_si128();
+
+  // Even part.
+  __m128i p26l = _mm_unpacklo_epi16(v[2], v[6]);
+  __m128i p26h = _mm_unpackhi_epi16(v[2], v[6]);
+  __m128i tmp3l = _mm_madd_epi16(p26l, k_tmp3);
+  __m128i tmp3h = _mm_madd_epi16(p26h, k_tmp3);
+  __m128i tmp2l = _mm_madd_epi16(p26l, k_tmp2);
+  __m128i tmp2h = _mm_madd_epi16(p26h, k_tmp2);
+
+  // Shifting the 16 bit (v[0] ± v[4]) into the top of a 32 bit lane and then
+  // arithmetic shifting right by 3 is a sign-extending shift left by 13.
+  __m128i s04 = _mm_add_epi16(v[0], v[4]);
+  __m128i d04 = _mm_sub_epi16(v[0], v[4]);
+  __m128i tmp0l = _mm_srai_epi32(_mm_unpacklo_epi16(zero, s04), 3);
+  __m128i tmp0h = _mm_srai_epi32(_mm_unpackhi_epi16(zero, s04), 3);
+  __m128i tmp1l = _mm_srai_epi32(_mm_unpacklo_epi16(zero, d04), 3);
+  __m128i tmp1h = _mm_srai_epi32(_mm_unpackhi_epi16(zero, d04), 3);
+
+  __m128i tmp10l = _mm_add_epi32(tmp0l, tmp3l);
+  __m128i tmp10h = _mm_add_epi32(tmp0h, tmp3h);
+  __m128i tmp13l = _mm_sub_epi32(tmp0l, tmp3l);
+  __m128i tmp13h = _mm_sub_epi32(tmp0h, tmp3h);
+  __m128i tmp11l = _mm_add_epi32(tmp1l, tmp2l);
+  __m128i tmp11h = _mm_add_epi32(tmp1h, tmp2h);
+  __m128i tmp12l = _mm_sub_epi32(tmp1l, tmp2l);
+  __m128i tmp12h = _mm_sub_epi32(tmp1h, tmp2h);
+
+  // Odd part.
+  __m128i z3 = _mm_add_epi16(v[7], v[3]);
+  __m128i z4 = _mm_add_epi16(v[5], v[1]);
+  __m128i p34l = _mm_unpacklo_epi16(z3, z4);
+  __m128i p34h = _mm_unpackhi_epi16(z3, z4);
+  __m128i z3l = _mm_madd_epi16(p34l, k_z3);
+  __m128i z3h = _mm_madd_epi16(p34h, k_z3);
+  __m128i z4l = _mm_madd_epi16(p34l, k_z4);
+  __m128i z4h = _mm_madd_epi16(p34h, k_z4);
+
+  __m128i p71l = _mm_unpacklo_epi16(v[7], v[1]);
+  __m128i p71h = _mm_unpackhi_epi16(v[7], v[1]);
+  __m128i p53l = _mm_unpacklo_epi16(v[5], v[3]);
+  __m128i p53h = _mm_unpackhi_epi16(v[5], v[3]);
+  __m128i o0l = _mm_add_epi32(_mm_madd_epi16(p71l, k_tmp0), z3l);
+  __m128i o0h = _mm_add_epi32(_mm_madd_epi16(p71h, k_tmp0), z3h);
+  __m128i o3l = _mm_add_epi32(_mm_madd_epi16(p71l, k_tmp3o), z4l);
+  __m128i o3h = _mm_add_epi32(_mm_madd_epi16(p71h, k_tmp3o), z4h);
+  __m128i o1l = _mm_add_epi32(_mm_madd_epi16(p53l, k_tmp1), z4l);
+  __m128i o1h = _mm_add_epi32(_mm_madd_epi16(p53h, k_tmp1), z4h);
+  __m128i o2l = _mm_add_epi32(_mm_madd_epi16(p53l, k_tmp2o), z3l);
+  __m128i o2h = _mm_add_epi32(_mm_madd_epi16(p53h, k_tmp2o), z3h);
+
+#define WUFFS_BASE__PRIVATE_IDCT_OUT(i, j, a, b)                              \
+  v[i] = _mm_packs_epi32(                                                     \
+      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(a##l, b##l), bias), shift),  \
+      _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(a##h, b##h), bias), shift)); \
+  v[j] = _mm_packs_epi32(                                                     \
+      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(a##l, b##l), bias), shift),  \
+      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(a##h, b##h), bias), shift))
+
+  WUFFS_BASE__PRIVATE_IDCT_OUT(0, 7, tmp10, o3);
+  WUFFS_BASE__PRIVATE_IDCT_OUT(1, 6, tmp11, o2);
+  WUFFS_BASE__PRIVATE_IDCT_OUT(2, 5, tmp12, o1);
+  WUFFS_BASE__PRIVATE_IDCT_OUT(3, 4, tmp13, o0);
+
+#undef WUFFS_BASE__PRIVATE_IDCT_OUT
+}
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8__sse2(wuffs_base__slice_u8 dst,
+                                     uint64_t stride,
+                                     wuffs_base__slice_u8 coeffs,
+                                     wuffs_base__slice_u8 quant) {
+  const __m128i k7FFF = _mm_set1_epi16(0x7FFF);
+  const __m128i lo = _mm_set1_epi16(-0x4000);
+  const __m128i hi = _mm_set1_epi16(+0x3FFF);
+  __m128i v[8];
+  int k;
+  for (k = 0; k < 8; k++) {
+    // Dequantize to 32 bits and saturate, as the fallback implementation
+    // does. _mm_mulhi_epi16 is a signed multiply, so quantization factors of
+    // 0x8000 or more are first replaced by 0x7FFF. As every non-zero
+    // coefficient's product saturates either way, this does not change the
+    // result.
+    __m128i c = _mm_loadu_si128((const __m128i*)(coeffs.ptr + (16 * k)));
+    __m128i q = _mm_loadu_si128((const __m128i*)(quant.ptr + (16 * k)));
+    __m128i m = _mm_srai_epi16(q, 15);
+    q = _mm_or_si128(_mm_andnot_si128(m, q), _mm_and_si128(m, k7FFF));
+    __m128i pl = _mm_mullo_epi16(c, q);
+    __m128i ph = _mm_mulhi_epi16(c, q);
+    v[k] =
+        _mm_packs_epi32(_mm_unpacklo_epi16(pl, ph), _mm_unpackhi_epi16(pl, ph));
+    v[k] = _mm_max_epi16(_mm_min_epi16(v[k], hi), lo);
+  }
+  wuffs_base__private_idct_1d__sse2(v, 11);
+  for (k = 0; k < 8; k++) {
+    v[k] = _mm_max_epi16(_mm_min_epi16(v[k], hi), lo);
+  }
+  wuffs_base__private_transpose_8x8_epi16(v);
+  wuffs_base__private_idct_1d__sse2(v, 18);
+  wuffs_base__private_transpose_8x8_epi16(v);
+  const __m128i k128 = _mm_set1_epi16(128);
+  for (k = 0; k < 8; k++) {
+    __m128i s = _mm_adds_epi16(v[k], k128);
+    _mm_storel_epi64((__m128i*)(dst.ptr + (k * stride)),
+                     _mm_packus_epi16(s, s));
+  }
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8(wuffs_base__slice_u8 dst,
+                               uint64_t stride,
+                               wuffs_base__slice_u8 coeffs,
+                               wuffs_base__slice_u8 quant) {
+  if ((coeffs.len < 128) || (quant.len < 128) || (dst.len < 8) ||
+      (stride > ((dst.len - 8) / 7))) {
+    return;
+  }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+  wuffs_base__slice_u8__idct_8x8__sse2(dst, stride, coeffs, quant);
+#else
+  wuffs_base__slice_u8__idct_8x8__fallback(dst, stride, coeffs, quant);
+#endif
+}
+
+// wuffs_base__slice_u8__idct_8x8_downscaled is like
+// wuffs_base__slice_u8__idct_8x8 but, for a shift of 1, 2 or 3, it writes a
+// 4×4, 2×2 or 1×1 block of samples: the 8×8 block downscaled by (1 << shift)
+// in each dimension. It only computes those samples, and only looks at the
+// coefficients that contribute to them. A shift of 0 is the same as
+// wuffs_base__slice_u8__idct_8x8.
+//
+// The arithmetic is that of libjpeg's jpeg_idct_4x4, jpeg_idct_2x2 and
+// jpeg_idct_1x1 (in jidctred.c), which libjpeg uses when decoding with a
+// scale_denom of 2, 4 or 8, so that the output matches libjpeg's exactly. As
+// for the full size IDCT, the dequantized coefficients and the first pass's
+// outputs saturate to [-0x4000, +0x3FFF], so that no intermediate value can
+// overflow.
+
+static inline uint8_t  //
+wuffs_base__private_idct_clamp(int32_t v, uint32_t shift) {
+  int32_t s = ((v + (((int32_t)1) << (shift - 1))) >> shift) + 128;
+  return (s < 0) ? 0 : (s > 255) ? 255 : ((uint8_t)s);
+}
+
+static inline void  //
+wuffs_base__private_idct_4x4(uint8_t* dst,
+                             uint64_t stride,
+                             uint8_t* coeffs,
+                             uint8_t* quant) {
+  int32_t ws[32];
+  int32_t v[8];
+  int x;
+  int y;
+  int k;
+
+  // Pass 1: process columns, other than column 4, which the second pass
+  // ignores. Rows 0 .. 3 of the ws work space hold the 4 outputs.
+  for (x = 0; x < 8; x++) {
+    if (x == 4) {
+      continue;
+    }
+    for (k = 0; k < 8; k++) {
+      v[k] = wuffs_base__private_idct_dequantize(coeffs + (2 * ((8 * k) + x)),
+                                                 quant + (2 * ((8 * k) + x)));
+    }
+    int32_t tmp0 = (int32_t)((uint32_t)(v[0]) << 14);
+    int32_t tmp2 = (v[2] * 15137) + (v[6] * -6270);
+    int32_t tmp10 = tmp0 + tmp2;
+    int32_t tmp12 = tmp0 - tmp2;
+    tmp0 = (v[7] * -1730) + (v[5] * 11893) + (v[3] * -17799) + (v[1] * 8697);
+    tmp2 = (v[7] * -4176) + (v[5] * -4926) + (v[3] * 7373) + (v[1] * 20995);
+    ws[(8 * 0) + x] =
+        wuffs_base__private_idct_saturate((tmp10 + tmp2 + (1 << 11)) >> 12);
+    ws[(8 * 3) + x] =
+        wuffs_base__private_idct_saturate((tmp10 - tmp2 + (1 << 11)) >> 12);
+    ws[(8 * 1) + x] =
+        wuffs_base__private_idct_saturate((tmp12 + tmp0 + (1 << 11)) >> 12);
+    ws[(8 * 2) + x] =
+        wuffs_base__private_idct_saturate((tmp12 - tmp0 + (1 << 11)) >> 12);
+  }
+
+  // Pass 2: process rows, from the work space to dst.
+  for (y = 0; y < 4; y++) {
+    int32_t* w = ws + (8 * y);
+    int32_t tmp0 = (int32_t)((uint32_t)(w[0]) << 14);
+    int32_t tmp2 = (w[2] * 15137) + (w[6] * -6270);
+    int32_t tmp10 = tmp0 + tmp2;
+    int32_t tmp12 = tmp0 - tmp2;
+    tmp0 = (w[7] * -1730) + (w[5] * 11893) + (w[3] * -17799) + (w[1] * 8697);
+    tmp2 = (w[7] * -4176) + (w[5] * -4926) + (w[3] * 7373) + (w[1] * 20995);
+    uint8_t* d = dst + (y * stride);
+    d[0] = wuffs_base__private_idct_clamp(tmp10 + tmp2, 19);
+    d[3] = wuffs_base__private_idct_clamp(tmp10 - tmp2, 19);
+    d[1] = wuffs_base__private_idct_clamp(tmp12 + tmp0, 19);
+    d[2] = wuffs_base__private_idct_clamp(tmp12 - tmp0, 19);
+  }
+}
+
+static inline void  //
+wuffs_base__private_idct_2x2(uint8_t* dst,
+                             uint64_t stride,
+                             uint8_t* coeffs,
+                             uint8_t* quant) {
+  int32_t ws[16];
+  int32_t v[8];
+  int x;
+  int y;
+  int k;
+
+  // Pass 1: process columns 0, 1, 3, 5 and 7, the only ones that the second
+  // pass uses. Rows 0 and 1 of the ws work space hold the 2 outputs.
+  for (x = 0; x < 8; x++) {
+    if ((x == 2) || (x == 4) || (x == 6)) {
+      continue;
+    }
+    for (k = 0; k < 8; k++) {
+      v[k] = wuffs_base__private_idct_dequantize(coeffs + (2 * ((8 * k) + x)),
+                                                 quant + (2 * ((8 * k) + x)));
+    }
+    int32_t tmp10 = (int32_t)((uint32_t)(v[0]) << 15);
+    int32_t tmp0 =
+        (v[7] * -5906) + (v[5] * 6967) + (v[3] * -10426) + (v[1] * 29692);
+    ws[(8 * 0) + x] =
+        wuffs_base__private_idct_saturate((tmp10 + tmp0 + (1 << 12)) >> 13);
+    ws[(8 * 1) + x] =
+        wuffs_base__private_idct_saturate((tmp10 - tmp0 + (1 << 12)) >> 13);
+  }
+
+  // Pass 2: process rows, from the work space to dst.
+  for (y = 0; y < 2; y++) {
+    int32_t* w = ws + (8 * y);
+    int32_t tmp10 = (int32_t)((uint32_t)(w[0]) << 15);
+    int32_t tmp0 =
+        (w[7] * -5906) + (w[5] * 6967) + (w[3] * -10426) + (w[1] * 29692);
+    uint8_t* d = dst + (y * stride);
+    d[0] = wuffs_base__private_idct_clamp(tmp10 + tmp0, 20);
+    d[1] = wuffs_base__private_idct_clamp(tmp10 - tmp0, 20);
+  }
+}
+
+static inline void  //
+wuffs_base__slice_u8__idct_8x8_downscaled(wuffs_base__slice_u8 dst,
+                                          uint64_t stride,
+                                          wuffs_base__slice_u8 coeffs,
+                                          wuffs_base__slice_u8 quant,
+                                          uint32_t shift) {
+  if (shift == 0) {
+    wuffs_base__slice_u8__idct_8x8(dst, stride, coeffs, quant);
+    return;
+  }
+  uint64_t n = ((uint64_t)8) >> (shift & 3);
+  if ((shift > 3) || (coeffs.len < 128) || (quant.len < 128) || (dst.len < n) ||
+      ((n > 1) && (stride > ((dst.len - n) / (n - 1))))) {
+    return;
+  }
+  if (shift == 1) {
+    wuffs_base__private_idct_4x4(dst.ptr, stride, coeffs.ptr, quant.ptr);
+  } else if (shift == 2) {
+    wuffs_base__private_idct_2x2(dst.ptr, stride, coeffs.ptr, quant.ptr);
+  } else {
+    dst.ptr[0] = wuffs_base__private_idct_clamp(
+        wuffs_base__private_idct_dequantize(coeffs.ptr, quant.ptr), 3);
+  }
+}
+
+// wuffs_base__slice_u8__convert_ycc converts a row of JPEG's YCbCr samples to
+// pixfmt, one of WUFFS_BASE__PIXEL_FORMAT__BGR, BGRA_NONPREMUL, BGRX, RGB,
+// RGBA_NONPREMUL or RGBX. Empty cb and cr mean a gray (Y only) row. Otherwise,
+// the chroma rows are upsampled per the upsample argument, using the same
+// triangle filters as libjpeg's "fancy upsampling":
+//  - 0 means none: cb and cr are as wide as y.
+//  - 1 means 2× horizontally ("h2v1").
+//  - 2 and 3 mean 2× vertically ("h1v2"), where cb_far and cr_far are the
+//    chroma rows above (2) or below (3) the nearest ones, cb and cr.
+//  - 4 means 2× in both directions ("h2v2"), with cb_far and cr_far as per 2
+//    and 3, whichever is further away from this row.
+// Horizontal upsampling needs at least 2 chroma samples per row. The number of
+// pixels converted is bounded by y.len, by dst.len and by the chroma lengths.
+//
+// The color conversion is libjpeg's: 16 bit fixed point, with rounding. When
+// WUFFS_BASE__HAVE_SSE2 is defined, 4 byte per pixel formats are converted 8
+// pixels at a time, with the multiplications by 1.402 and 1.772 split into
+// exact (integer) and fractional parts so that they fit in 16 bit lanes.
+
+static inline void  //
+wuffs_base__private_upsample_ycc(uint8_t* out,
+                                 wuffs_base__slice_u8 near,
+                                 wuffs_base__slice_u8 far,
+                                 uint32_t upsample,
+                                 size_t x0,
+                                 size_t n) {
+  size_t cw = near.len;
+  size_t i;
+  switch (upsample) {
+    case 0:
+      memcpy(out, near.ptr + x0, n);
+      break;
+
+    case 1:
+      for (i = 0; i < n; i++) {
+        size_t xo = x0 + i;
+        size_t c = xo >> 1;
+        uint32_t v = 3 * (uint32_t)(near.ptr[c]);
+        if ((xo & 1) == 0) {
+          out[i] = (c == 0) ? near.ptr[0]
+                            : (uint8_t)((v + near.ptr[c - 1] + 1) >> 2);
+        } else {
+          out[i] = (c + 1 >= cw) ? near.ptr[c]
+                                 : (uint8_t)((v + near.ptr[c + 1] + 2) >> 2);
+        }
+      }
+      break;
+
+    case 2:
+    case 3: {
+      uint32_t bias = upsample - 1;
+      for (i = 0; i < n; i++) {
+        out[i] = (uint8_t)((3 * (uint32_t)(near.ptr[x0 + i]) +
+                            (uint32_t)(far.ptr[x0 + i]) + bias) >>
+                           2);
+      }
+      break;
+    }
+
+    case 4:
+      for (i = 0; i < n; i++) {
+        size_t xo = x0 + i;
+        size_t c = xo >> 1;
+        uint32_t v = 3 * (uint32_t)(near.ptr[c]) + (uint32_t)(far.ptr[c]);
+        if ((xo & 1) == 0) {
+          if (c == 0) {
+            out[i] = (uint8_t)(((4 * v) + 8) >> 4);
+          } else {
+            uint32_t w =
+                3 * (uint32_t)(near.ptr[c - 1]) + (uint32_t)(far.ptr[c - 1]);
+            out[i] = (uint8_t)(((3 * v) + w + 8) >> 4);
+          }
+        } else {
+          if (c + 1 >= cw) {
+            out[i] = (uint8_t)(((4 * v) + 7) >> 4);
+          } else {
+            uint32_t w =
+                3 * (uint32_t)(near.ptr[c + 1]) + (uint32_t)(far.ptr[c + 1]);
+            out[i] = (uint8_t)(((3 * v) + w + 7) >> 4);
+          }
+        }
+      }
+      break;
+  }
+}
+
+static inline void  //
+wuffs_base__private_convert_ycc__fallback(uint8_t* d,
+                                          size_t bpp,
+                                          bool rgb,
+                                          uint8_t* y,
+                                          uint8_t* cb,
+                                          uint8_t* cr,
+                                          size_t n) {
+  size_t i;
+  for (i = 0; i < n; i++) {
+    int32_t yy = y[i];
+    int32_t u = ((int32_t)(cb[i])) - 128;
+    int32_t v = ((int32_t)(cr[i])) - 128;
+    int32_t r = yy + (((91881 * v) + 32768) >> 16);
+    int32_t g = yy + (((-22554 * u) - (46802 * v) + 32768) >> 16);
+    int32_t b = yy + (((116130 * u) + 32768) >> 16);
+    r = (r < 0) ? 0 : (r > 255) ? 255 : r;
+    g = (g < 0) ? 0 : (g > 255) ? 255 : g;
+    b = (b < 0) ? 0 : (b > 255) ? 255 : b;
+    d[0] = (uint8_t)(rgb ? r : b);
+    d[1] = (uint8_t)(g);
+    d[2] = (uint8_t)(rgb ? b : r);
+    if (bpp == 4) {
+      d[3] = 0xFF;
+    }
+    d += bpp;
+  }
+}
+
+#if defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__private_convert_ycc__sse2(uint8_t* d,
+                                      bool rgb,
+                                      uint8_t* y,
+                                      uint8_t* cb,
+                                      uint8_t* cr,
+                                      size_t n) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i k128 = _mm_set1_epi16(128);
+  const __m128i k_r = _mm_set_epi16(-32768, 26345, -32768, 26345,  //
+                                    -32768, 26345, -32768, 26345);
+  const __m128i k_b = _mm_set_epi16(-32768, -14942, -32768, -14942,  //
+                                    -32768, -14942, -32768, -14942);
+  const __m128i k_g = _mm_set_epi16(18734, -22554, 18734, -22554,  //
+                                    18734, -22554, 18734, -22554);
+  const __m128i half = _mm_set1_epi32(32768);
+  const __m128i neg1 = _mm_set1_epi16(-1);
+  const __m128i alpha = _mm_set1_epi8(-1);
+
+  for (; n >= 8; n -= 8) {
+    __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)y), zero);
+    __m128i u = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cb), zero), k128);
+    __m128i v = _mm_sub_epi16(
+        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)cr), zero), k128);
+
+    // 91881 = 65536 + 26345 and 116130 = 131072 - 14942. Pairing each
+    // chroma sample with -1, times -32768, adds the 32768 rounding bias.
+    __m128i vl = _mm_unpacklo_epi16(v, neg1);
+    __m128i vh = _mm_unpackhi_epi16(v, neg1);
+    __m128i ul = _mm_unpacklo_epi16(u, neg1);
+    __m128i uh = _mm_unpackhi_epi16(u, neg1);
+    __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(vl, k_r), 16),
+                                _mm_srai_epi32(_mm_madd_epi16(vh, k_r), 16));
+    __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(ul, k_b), 16),
+                                _mm_srai_epi32(_mm_madd_epi16(uh, k_b), 16));
+    r = _mm_add_epi16(_mm_add_epi16(r, v), yy);
+    b = _mm_add_epi16(_mm_add_epi16(b, _mm_add_epi16(u, u)), yy);
+
+    // -46802 = -65536 + 18734.
+    __m128i uvl = _mm_unpacklo_epi16(u, v);
+    __m128i uvh = _mm_unpackhi_epi16(u, v);
+    __m128i g = _mm_packs_epi32(
+        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvl, k_g), half), 16),
+        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvh, k_g), half), 16));
+    g = _mm_add_epi16(_mm_sub_epi16(g, v), yy);
+
+    __m128i c0 = _mm_packus_epi16(rgb ? r : b, rgb ? r : b);
+    __m128i c2 = _mm_packus_epi16(rgb ? b : r, rgb ? b : r);
+    __m128i c1 = _mm_packus_epi16(g, g);
+    __m128i c01 = _mm_unpacklo_epi8(c0, c1);
+    __m128i c23 = _mm_unpacklo_epi8(c2, alpha);
+    _mm_storeu_si128((__m128i*)(d + 0), _mm_unpacklo_epi16(c01, c23));
+    _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(c01, c23));
+
+    d += 32;
+    y += 8;
+    cb += 8;
+    cr += 8;
+  }
+  wuffs_base__private_convert_ycc__fallback(d, 4, rgb, y, cb, cr, n);
+}
+
+#endif  // defined(WUFFS_BASE__HAVE_SSE2)
+
+static inline void  //
+wuffs_base__slice_u8__convert_ycc(wuffs_base__slice_u8 dst,
+                                  wuffs_base__slice_u8 y,
+                                  wuffs_base__slice_u8 cb,
+                                  wuffs_base__slice_u8 cr,
+                                  wuffs_base__slice_u8 cb_far,
+                                  wuffs_base__slice_u8 cr_far,
+                                  uint32_t pixfmt,
+                                  uint32_t upsample) {
+  size_t bpp = 4;
+  bool rgb = false;
+  switch (pixfmt) {
+    case WUFFS_BASE__PIXEL_FORMAT__BGR:
+      bpp = 3;
+      break;
+    case WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__BGRX:
+      break;
+    case WUFFS_BASE__PIXEL_FORMAT__RGB:
+      bpp = 3;
+      rgb = true;
+      break;
+    case WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL:
+    case WUFFS_BASE__PIXEL_FORMAT__RGBX:
+      rgb = true;
+      break;
+    default:
+      return;
+  }
+
+  size_t n = y.len < (dst.len / bpp) ? y.len : (dst.len / bpp);
+  uint8_t* d = dst.ptr;
+  size_t i;
+
+  if ((cb.len == 0) || (cr.len == 0)) {
+    for (i = 0; i < n; i++) {
+      d[0] = y.ptr[i];
+      d[1] = y.ptr[i];
+      d[2] = y.ptr[i];
+      if (bpp == 4) {
+        d[3] = 0xFF;
+      }
+      d += bpp;
+    }
+    return;
+  }
+
+  if (upsample > 4) {
+    return;
+  }
+  if (cr.len < cb.len) {
+    cb.len = cr.len;
+  } else {
+    cr.len = cb.len;
+  }
+  if (upsample >= 2) {
+    if ((cb_far.len < cb.len) || (cr_far.len < cb.len)) {
+      return;
+    }
+  }
+  size_t max_n = cb.len;
+  if ((upsample == 1) || (upsample == 4)) {
+    if (cb.len < 2) {
+      return;
+    }
+    max_n *= 2;
+  }
+  if (n > max_n) {
+    n = max_n;
+  }
+
+  // Upsample and convert in chunks, so that the upsampled chroma fits in
+  // fixed size buffers on the stack.
+  uint8_t ubuf[64];
+  uint8_t vbuf[64];
+  size_t x0;
+  for (x0 = 0; x0 < n; x0 += 64) {
+    size_t m = (n - x0) < 64 ? (n - x0) : 64;
+    uint8_t* u = cb.ptr + x0;
+    uint8_t* v = cr.ptr + x0;
+    if (upsample != 0) {
+      wuffs_base__private_upsample_ycc(ubuf, cb, cb_far, upsample, x0, m);
+      wuffs_base__private_upsample_ycc(vbuf, cr, cr_far, upsample, x0, m);
+      u = ubuf;
+      v = vbuf;
+    }
+#if defined(WUFFS_BASE__HAVE_SSE2)
+    if (bpp == 4) {
+      wuffs_base__private_convert_ycc__sse2(d, rgb, y.ptr + x0, u, v, m);
+      d += 4 * m;
+      continue;
+    }
+#endif
+    wuffs_base__private_convert_ycc__fallback(d, bpp, rgb, y.ptr + x0, u, v, m);
+    d += bpp * m;
+  }
+}
+
+// ---------------- Utility
+
+static inline wuffs_base__range_ii_u32  //
+wuffs_base__utility__make_range_ii_u32(wuffs_base__utility* ignored,
+                                       uint32_t min_incl,
+                                       uint32_t max_incl) {
+  return ((wuffs_base__range_ii_u32){
+      .min_incl = min_incl,
+      .max_incl = max_incl,
+  });
+}
+
+static inline wuffs_base__range_ie_u32  //
+wuffs_base__utility__make_range_ie_u32(wuffs_base__utility* ignored,
+                                       uint32_t min_incl,
+                                       uint32_t max_excl) {
+  return ((wuffs_base__range_ie_u32){
+      .min_incl = min_incl,
+      .max_excl = max_excl,
+  });
+}
+
+static inline wuffs_base__range_ii_u64  //
+wuffs_base__utility__make_range_ii_u64(wuffs_base__utility* ignored,
+                                       uint64_t min_incl,
+                                       uint64_t max_incl) {
+  return ((wuffs_base__range_ii_u64){
+      .min_incl = min_incl,
+      .max_incl = max_incl,
+  });
+}
+
+static inline wuffs_base__range_ie_u64  //
+wuffs_base__utility__make_range_ie_u64(wuffs_base__utility* ignored,
+                                       uint64_t min_incl,
+                                       uint64_t max_excl) {
+  return ((wuffs_base__range_ie_u64){
+      .min_incl = min_incl,
+      .max_excl = max_excl,
+  });
+}
+
+static inline wuffs_base__rect_ii_u32  //
+wuffs_base__utility__make_rect_ii_u32(wuffs_base__utility* ignored,
+                                      uint32_t min_incl_x,
+                                      uint32_t min_incl_y,
+                                      uint32_t max_incl_x,
+                                      uint32_t max_incl_y) {
+  return ((wuffs_base__rect_ii_u32){
+      .min_incl_x = min_incl_x,
+      .min_incl_y = min_incl_y,
+      .max_incl_x = max_incl_x,
+      .max_incl_y = max_incl_y,
+  });
+}
+
+static inline wuffs_base__rect_ie_u32  //
+wuffs_base__utility__make_rect_ie_u32(wuffs_base__utility* ignored,
+                                      uint32_t min_incl_x,
+                                      uint32_t min_incl_y,
+                                      uint32_t max_excl_x,
+                                      uint32_t max_excl_y) {
+  return ((wuffs_base__rect_ie_u32){
+      .min_incl_x = min_incl_x,
+      .min_incl_y = min_incl_y,
+      .max_excl_x = max_excl_x,
+      .max_excl_y = max_excl_y,
+  });
+}
+
+// ---------------- I/O
+
+static inline bool  //
+wuffs_base__io_buffer__is_valid(wuffs_base__io_buffer buf) {
+  return (buf.data.ptr || (buf.data.len == 0)) &&
+         (buf.data.len >= buf.meta.wi) && (buf.meta.wi >= buf.meta.ri);
+}
+
+// wuffs_base__io_reader__is_eof implements the Wuffs io_reader.is_eof method,
+// used by encoders (and by decoders of formats without an end marker, such as
+// PackBits) to distinguish "no more input yet" from "no more input".
+//
+// If making this function public (i.e. moving it to base-header.h), it also
+// needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.
+
+static inline bool  //
+wuffs_base__io_reader__is_eof(wuffs_base__io_reader o) {
+  wuffs_base__io_buffer* buf = o.private_impl.buf;
+  return buf && buf->meta.closed &&
+         (buf->data.ptr + buf->meta.wi == o.private_impl.limit);
+}
+
+static inline bool  //
+wuffs_base__io_reader__is_valid(wuffs_base__io_reader o) {
+  wuffs_base__io_buffer* buf = o.private_impl.buf;
+  // Note: if making this function public (i.e. moving it to base-header.h), it
+  // also needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.
+  return buf ? ((buf->data.ptr <= o.private_impl.mark) &&
+                (o.private_impl.mark <= o.private_impl.limit) &&
+                (o.private_impl.limit <= buf->data.ptr + buf->data.len))
+             : ((o.private_impl.mark == NULL) &&
+                (o.private_impl.limit == NULL));
+}
+
+static inline bool  //
+wuffs_base__io_writer__is_valid(wuffs_base__io_writer o) {
+  wuffs_base__io_buffer* buf = o.private_impl.buf;
+  // Note: if making this function public (i.e. moving it to base-header.h), it
+  // also needs to allow NULL (i.e. implicit, callee-calculated) mark/limit.
+  return buf ? ((buf->data.ptr <= o.private_impl.mark) &&
+                (o.private_impl.mark <= o.private_impl.limit) &&
+                (o.private_impl.limit <= buf->data.ptr + buf->data.len))
+             : ((o.private_impl.mark == NULL) &&
+                (o.private_impl.limit == NULL));
+}
+
+static inline uint32_t  //
+wuffs_base__io_writer__copy_n_from_history(uint8_t** ptr_ptr,
+                                           uint8_t* start,
+                                           uint8_t* end,
+                                           uint32_t length,
+                                           uint32_t distance) {
+  if (!distance) {
+    return 0;
+  }
+  uint8_t* ptr = *ptr_ptr;
+  if ((size_t)(ptr - start) < (size_t)(distance)) {
+    return 0;
+  }
+  start = ptr - distance;
+  size_t n = end - ptr;
+  if ((size_t)(length) > n) {
+    length = n;
+  } else {
+    n = length;
+  }
+  // TODO: unrolling by 3 seems best for the std/deflate benchmarks, but that
+  // is mostly because 3 is the minimum length for the deflate format. This
+  // function implementation shouldn't overfit to that one format. Perhaps the
+  // copy_n_from_history Wuffs method should also take an unroll hint argument,
+  // and the cgen can look if that argument is the constant expression '3'.
+  //
+  // See also wuffs_base__io_writer__copy_n_from_history_fast below.
+  //
+  // Alternatively, or additionally, have a sloppy_copy_n_from_history method
+  // that copies 8 bytes at a time, possibly writing more than length bytes?
+  for (; n >= 3; n -= 3) {
+    *ptr++ = *start++;
+    *ptr++ = *start++;
+    *ptr++ = *start++;
+  }
+  for (; n; n--) {
+    *ptr++ = *start++;
+  }
+  *ptr_ptr = ptr;
+  return length;
+}
+
+// wuffs_base__io_writer__copy_n_from_history_fast is like the
+// wuffs_base__io_writer__copy_n_from_history function above, but has stronger
+// pre-conditions. The caller needs to prove that:
+//  - distance >  0
+//  - distance <= (*ptr_ptr - start)
+//  - length   <= (end      - *ptr_ptr)
+static inline uint32_t  //
+wuffs_base__io_writer__copy_n_from_history_fast(uint8_t** ptr_ptr,
+                                                uint8_t* start,
+                                                uint8_t* end,
+                                                uint32_t length,
+                                                uint32_t distance) {
+  uint8_t* ptr = *ptr_ptr;
+  start = ptr - distance;
+  uint32_t n = length;
+  for (; n >= 3; n -= 3) {
+    *ptr++ = *start++;
+    *ptr++ = *start++;
+    *ptr++ = *start++;
+  }
+  for (; n; n--) {
+    *ptr++ = *start++;
+  }
+  *ptr_ptr = ptr;
+  return length;
+}
+
+static inline uint32_t  //
+wuffs_base__io_writer__copy_n_from_reader(uint8_t** ptr_ioptr_w,
+                                          uint8_t* iobounds1_w,
+                                          uint32_t length,
+                                          uint8_t** ptr_ioptr_r,
+                                          uint8_t* iobounds1_r) {
+  uint8_t* ioptr_w = *ptr_ioptr_w;
+  size_t n = length;
+  if (n > ((size_t)(iobounds1_w - ioptr_w))) {
+    n = iobounds1_w - ioptr_w;
+  }
+  uint8_t* ioptr_r = *ptr_ioptr_r;
+  if (n > ((size_t)(iobounds1_r - ioptr_r))) {
+    n = iobounds1_r - ioptr_r;
+  }
+  if (n > 0) {
+    memmove(ioptr_w, ioptr_r, n);
+    *ptr_ioptr_w += n;
+    *ptr_ioptr_r += n;
+  }
+  return n;
+}
+
+static inline uint64_t  //
+wuffs_base__io_writer__copy_from_slice(uint8_t** ptr_ioptr_w,
+                                       uint8_t* iobounds1_w,
+                                       wuffs_base__slice_u8 src) {
+  uint8_t* ioptr_w = *ptr_ioptr_w;
+  size_t n = src.len;
+  if (n > ((size_t)(iobounds1_w - ioptr_w))) {
+    n = iobounds1_w - ioptr_w;
+  }
+  if (n > 0) {
+    memmove(ioptr_w, src.ptr, n);
+    *ptr_ioptr_w += n;
+  }
+  return n;
+}
+
+static inline uint32_t  //
+wuffs_base__io_writer__copy_n_from_slice(uint8_t** ptr_ioptr_w,
+                                         uint8_t* iobounds1_w,
+                                         uint32_t length,
+                                         wuffs_base__slice_u8 src) {
+  uint8_t* ioptr_w = *ptr_ioptr_w;
+  size_t n = src.len;
+  if (n > length) {
+    n = length;
+  }
+  if (n > ((size_t)(iobounds1_w - ioptr_w))) {
+    n = iobounds1_w - ioptr_w;
+  }
+  if (n > 0) {
+    memmove(ioptr_w, src.ptr, n);
+    *ptr_ioptr_w += n;
+  }
+  return n;
+}
+
+static inline wuffs_base__empty_struct  //
+wuffs_base__io_reader__set(wuffs_base__io_reader* o,
+                           wuffs_base__io_buffer* b,
+                           uint8_t** ioptr1_ptr,
+                           uint8_t** ioptr2_ptr,
+                           wuffs_base__slice_u8 s,
+                           bool closed) {
+  b->data.ptr = s.ptr;
+  b->data.len = s.len;
+  b->meta.wi = s.len;
+  b->meta.ri = 0;
+  b->meta.pos = 0;
+  b->meta.closed = closed;
+
+  o->private_impl.buf = b;
+  o->private_impl.mark = s.ptr;
+  o->private_impl.limit = s.ptr + s.len;
+  *ioptr1_ptr = s.ptr;
+  *ioptr2_ptr = s.ptr + s.len;
+  return ((wuffs_base__empty_struct){});
+}
+
+static inline wuffs_base__empty_struct  //
+wuffs_base__io_reader__set_limit(wuffs_base__io_reader* o,
+                                 uint8_t* ioptr_r,
+                                 uint64_t limit) {
+  if (o && (((size_t)(o->private_impl.limit - ioptr_r)) > limit)) {
+    o->private_impl.limit = ioptr_r + limit;
+  }
+  return ((wuffs_base__empty_struct){});
+}
+
+static inline wuffs_base__empty_struct  //
+wuffs_base__io_reader__set_mark(wuffs_base__io_reader* o, uint8_t* mark) {
+  o->private_impl.mark = mark;
+  return ((wuffs_base__empty_struct){});
+}
+
+static inline wuffs_base__empty_struct  //
+wuffs_base__io_writer__set(wuffs_base__io_writer* o,
+                           wuffs_base__io_buffer* b,
+                           uint8_t** ioptr1_ptr,
+                           uint8_t** ioptr2_ptr,
+                           wuffs_base__slice_u8 s) {
+  b->data.ptr = s.ptr;
+  b->data.len = s.len;
+  b->meta.wi = 0;
+  b->meta.ri = 0;
+  b->meta.pos = 0;
+  b->meta.closed = false;
+
+  o->private_impl.buf = b;
+  o->private_impl.mark = s.ptr;
+  o->private_impl.limit = s.ptr + s.len;
+  *ioptr1_ptr = s.ptr;
+  *ioptr2_ptr = s.ptr + s.len;
+  return ((wuffs_base__empty_struct){});
+}
+
+static inline wuffs_base__empty_struct  //
+wuffs_base__io_writer__set_mark(wuffs_base__io_writer* o, uint8_t* mark) {
+  o->private_impl.mark = mark;
+  return ((wuffs_base__empty_struct){});
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // WUFFS_INCLUDE_GUARD__BASE_PRIVATE
+
+#if !defined(WUFFS_CONFIG__MODULES) || defined(WUFFS_CONFIG__MODULE__DEFLATE)
+
+// ---------------- Status Codes Implementations
+
+const char* wuffs_deflate__error__bad_huffman_code_over_subscribed =
+    "?deflate: bad Huffman code (over-subscribed)";
+const char* wuffs_deflate__error__bad_huffman_code_under_subscribed =
+    "?deflate: bad Huffman code (under-subscribed)";
+const char* wuffs_deflate__error__bad_huffman_code_length_count =
+    "?deflate: bad Huffman code length count";
+const char* wuffs_deflate__error__bad_huffman_code_length_repetition =
+    "?deflate: bad Huffman code length repetition";
+const char* wuffs_deflate__error__bad_huffman_code =
+    "?deflate: bad Huffman code";
+const char* wuffs_deflate__error__bad_huffman_minimum_code_length =
+    "?deflate: bad Huffman minimum code length";
+const char* wuffs_deflate__error__bad_block = "?deflate: bad block";
+const char* wuffs_deflate__error__bad_distance = "?deflate: bad distance";
+const char* wuffs_deflate__error__bad_distance_code_count =
+    "?deflate: bad distance code count";
+const char* wuffs_deflate__error__bad_literal_length_code_count =
+    "?deflate: bad literal/length code count";
+const char* wuffs_deflate__error__inconsistent_stored_block_length =
+    "?deflate: inconsistent stored block length";
+const char* wuffs_deflate__error__missing_end_of_block_code =
+    "?deflate: missing end-of-block code";
+const char* wuffs_deflate__error__no_huffman_codes =
+    "?deflate: no Huffman codes";
+const char*
+    wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state =
+        "?deflate: internal error: inconsistent Huffman decoder state";
+const char*
+    wuffs_deflate__error__internal_error_inconsistent_huffman_end_of_block =
+        "?deflate: internal error: inconsistent Huffman end_of_block";
+const char* wuffs_deflate__error__internal_error_inconsistent_i_o =
+    "?deflate: internal error: inconsistent I/O";
+const char* wuffs_deflate__error__internal_error_inconsistent_distance =
+    "?deflate: internal error: inconsistent distance";
+const char* wuffs_deflate__error__internal_error_inconsistent_n_bits =
+    "?deflate: internal error: inconsistent n_bits";
+const char*
+    wuffs_deflate__error__internal_error_inconsistent_encoder_output_length =
+        "?deflate: internal error: inconsistent encoder output length";
+
+// ---------------- Private Consts
+
+static const uint8_t wuffs_deflate__code_order[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+static const uint8_t wuffs_deflate__reverse8[256] = {
+    0,  128, 64, 192, 32, 160, 96,  224, 16, 144, 80, 208, 48, 176, 112, 240,
+    8,  136, 72, 200, 40, 168, 104, 232, 24, 152, 88, 216, 56, 184, 120, 248,
+    4,  132, 68, 196, 36, 164, 100, 228, 20, 148, 84, 212, 52, 180, 116, 244,
+    12, 140, 76, 204, 44, 172, 108, 236, 28, 156, 92, 220, 60, 188, 124, 252,
+    2,  130, 66, 194, 34, 162, 98,  226, 18, 146, 82, 210, 50, 178, 114, 242,
+    10, 138, 74, 202, 42, 170, 106, 234, 26, 154, 90, 218, 58, 186, 122, 250,
+    6,  134, 70, 198, 38, 166, 102, 230, 22, 150, 86, 214, 54, 182, 118, 246,
+    14, 142, 78, 206, 46, 174, 110, 238, 30, 158, 94, 222, 62, 190, 126, 254,
+    1,  129, 65, 193, 33, 161, 97,  225, 17, 145, 81, 209, 49, 177, 113, 241,
+    9,  137, 73, 201, 41, 169, 105, 233, 25, 153, 89, 217, 57, 185, 121, 249,
+    5,  133, 69, 197, 37, 165, 101, 229, 21, 149, 85, 213, 53, 181, 117, 245,
+    13, 141, 77, 205, 45, 173, 109, 237, 29, 157, 93, 221, 61, 189, 125, 253,
+    3,  131, 67, 195, 35, 163, 99,  227, 19, 147, 83, 211, 51, 179, 115, 243,
+    11, 139, 75, 203, 43, 171, 107, 235, 27, 155, 91, 219, 59, 187, 123, 251,
+    7,  135, 71, 199, 39, 167, 103, 231, 23, 151, 87, 215, 55, 183, 119, 247,
+    15, 143, 79, 207, 47, 175, 111, 239, 31, 159, 95, 223, 63, 191, 127, 255,
+};
+
+static const uint32_t wuffs_deflate__lcode_magic_numbers[32] = {
+    1073742592, 1073742848, 1073743104, 1073743360, 1073743616, 1073743872,
+    1073744128, 1073744384, 1073744656, 1073745168, 1073745680, 1073746192,
+    1073746720, 1073747744, 1073748768, 1073749792, 1073750832, 1073752880,
+    1073754928, 1073756976, 1073759040, 1073763136, 1073767232, 1073771328,
+    1073775440, 1073783632, 1073791824, 1073800016, 1073807872, 134217728,
+    134217728,  134217728,
+};
+
+static const uint32_t wuffs_deflate__dcode_magic_numbers[32] = {
+    1073741824, 1073742080, 1073742336, 1073742592, 1073742864, 1073743376,
+    1073743904, 1073744928, 1073745968, 1073748016, 1073750080, 1073754176,
+    1073758288, 1073766480, 1073774688, 1073791072, 1073807472, 1073840240,
+    1073873024, 1073938560, 1074004112, 1074135184, 1074266272, 1074528416,
+    1074790576, 1075314864, 1075839168, 1076887744, 1077936336, 1080033488,
+    134217728,  134217728,
+};
+
+static const uint8_t wuffs_deflate__length_codes[256] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  8,  9,  9,  10, 10, 11, 11, 12, 12, 12,
+    12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 16, 16,
+    16, 16, 17, 17, 17, 17, 17, 17, 17, 17, 18, 18, 18, 18, 18, 18, 18, 18, 19,
+    19, 19, 19, 19, 19, 19, 19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+    20, 20, 20, 20, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 23, 23,
+    23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26,
+    26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 27, 27, 27, 27,
+    27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+    27, 27, 27, 27, 27, 27, 27, 27, 28,
+};
+
+static const uint8_t wuffs_deflate__distance_codes[512] = {
+    0,  1,  2,  3,  4,  4,  5,  5,  6,  6,  6,  6,  7,  7,  7,  7,  8,  8,  8,
+    8,  8,  8,  8,  8,  9,  9,  9,  9,  9,  9,  9,  9,  10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
+    14, 14, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 0,  14, 16, 17, 18, 18, 19, 19, 20, 20,
+    20, 20, 21, 21, 21, 21, 22, 22, 22, 22, 22, 22, 22, 22, 23, 23, 23, 23, 23,
+    23, 23, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 26, 26, 26,
+    26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 26,
+    26, 26, 26, 26, 26, 26, 26, 26, 26, 26, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+    27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27, 27,
+    27, 27, 27, 27, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 29, 29, 29, 29, 29, 29, 29, 29,
+    29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29,
+    29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29,
+    29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29,
+};
+
+static const uint32_t wuffs_deflate__length_bases[29] = {
+    0,     256,   512,   768,   1024,  1280,  1536,  1792,  2049,  2561,
+    3073,  3585,  4098,  5122,  6146,  7170,  8195,  10243, 12291, 14339,
+    16388, 20484, 24580, 28676, 32773, 40965, 49157, 57349, 65280,
+};
+
+static const uint32_t wuffs_deflate__distance_bases[30] = {
+    0,       256,     512,     768,     1025,    1537,    2050,   3074,
+    4099,    6147,    8196,    12292,   16389,   24581,   32774,  49158,
+    65543,   98311,   131080,  196616,  262153,  393225,  524298, 786442,
+    1048587, 1572875, 2097164, 3145740, 4194317, 6291469,
+};
+
+static const uint32_t wuffs_deflate__level_chain_lengths[10] = {
+    0, 1, 2, 4, 8, 16, 32, 128, 256, 1024,
+};
+
+static const uint32_t wuffs_deflate__level_nice_lengths[10] = {
+    0, 8, 16, 32, 32, 64, 128, 258, 258, 258,
+};
+
+// ---------------- Private Initializer Prototypes
+
+// ---------------- Private Function Prototypes
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_blocks(wuffs_deflate__decoder* self,
+                                      wuffs_base__io_writer a_dst,
+                                      wuffs_base__io_reader a_src);
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_uncompressed(wuffs_deflate__decoder* self,
+                                            wuffs_base__io_writer a_dst,
+                                            wuffs_base__io_reader a_src);
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__init_fixed_huffman(wuffs_deflate__decoder* self);
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__init_dynamic_huffman(wuffs_deflate__decoder* self,
+                                             wuffs_base__io_reader a_src);
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__init_huff(wuffs_deflate__decoder* self,
+                                  uint32_t a_which,
+                                  uint32_t a_n_codes0,
+                                  uint32_t a_n_codes1,
+                                  uint32_t a_base_symbol);
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_huffman_fast(wuffs_deflate__decoder* self,
+                                            wuffs_base__io_writer a_dst,
+                                            wuffs_base__io_reader a_src);
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_huffman_slow(wuffs_deflate__decoder* self,
+                                            wuffs_base__io_writer a_dst,
+                                            wuffs_base__io_reader a_src);
+
+static void  //
+wuffs_deflate__encoder__clear_hash_chains(wuffs_deflate__encoder* self);
+
+static void  //
+wuffs_deflate__encoder__slide_window(wuffs_deflate__encoder* self);
+
+static void  //
+wuffs_deflate__encoder__find_literals(wuffs_deflate__encoder* self, bool a_eof);
+
+static void  //
+wuffs_deflate__encoder__find_matches(wuffs_deflate__encoder* self,
+                                     bool a_eof,
+                                     uint32_t a_level);
+
+static uint32_t  //
+wuffs_deflate__encoder__hash(wuffs_deflate__encoder* self, uint32_t a_x);
+
+static uint32_t  //
+wuffs_deflate__encoder__load_u32le(wuffs_deflate__encoder* self,
+                                   wuffs_base__slice_u8 a_s);
+
+static uint64_t  //
+wuffs_deflate__encoder__load_u64le(wuffs_deflate__encoder* self,
+                                   wuffs_base__slice_u8 a_s);
+
+static uint32_t  //
+wuffs_deflate__encoder__match_length(wuffs_deflate__encoder* self,
+                                     uint32_t a_a,
+                                     uint32_t a_b,
+                                     uint32_t a_max);
+
+static void  //
+wuffs_deflate__encoder__write_block(wuffs_deflate__encoder* self,
+                                    bool a_final,
+                                    bool a_stored_only);
+
+static uint64_t  //
+wuffs_deflate__encoder__fixed_cost(wuffs_deflate__encoder* self);
+
+static void  //
+wuffs_deflate__encoder__build_fixed_codes(wuffs_deflate__encoder* self);
+
+static uint64_t  //
+wuffs_deflate__encoder__build_dynamic_codes(wuffs_deflate__encoder* self);
+
+static void  //
+wuffs_deflate__encoder__run_length_encode(wuffs_deflate__encoder* self);
+
+static uint32_t  //
+wuffs_deflate__encoder__code_length_at(wuffs_deflate__encoder* self,
+                                       uint32_t a_i);
+
+static void  //
+wuffs_deflate__encoder__add_cl_symbol(wuffs_deflate__encoder* self,
+                                      uint32_t a_s,
+                                      uint32_t a_extra);
+
+static void  //
+wuffs_deflate__encoder__build_lengths(wuffs_deflate__encoder* self,
+                                      uint32_t a_n,
+                                      uint32_t a_limit);
+
+static void  //
+wuffs_deflate__encoder__assign_codes(wuffs_deflate__encoder* self,
+                                     uint32_t a_n);
+
+static void  //
+wuffs_deflate__encoder__write_dynamic_header(wuffs_deflate__encoder* self);
+
+static void  //
+wuffs_deflate__encoder__write_symbols(wuffs_deflate__encoder* self);
+
+static void  //
+wuffs_deflate__encoder__write_stored_blocks(wuffs_deflate__encoder* self,
+                                            bool a_final,
+                                            uint32_t a_raw);
+
+static void  //
+wuffs_deflate__encoder__write_stored_block_header(wuffs_deflate__encoder* self,
+                                                  bool a_final,
+                                                  uint32_t a_length);
+
+static void  //
+wuffs_deflate__encoder__write_bits(wuffs_deflate__encoder* self,
+                                   uint32_t a_x,
+                                   uint32_t a_n);
+
+static void  //
+wuffs_deflate__encoder__flush_bits(wuffs_deflate__encoder* self);
+
+// ---------------- Initializer Implementations
+
+wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+wuffs_deflate__decoder__check_wuffs_version(wuffs_deflate__decoder* self,
+                                            size_t sizeof_star_self,
+                                            uint64_t wuffs_version) {
+  if (!self) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (sizeof(*self) != sizeof_star_self) {
+    return wuffs_base__error__bad_sizeof_receiver;
+  }
+  if (((wuffs_version >> 32) != WUFFS_VERSION_MAJOR) ||
+      (((wuffs_version >> 16) & 0xFFFF) > WUFFS_VERSION_MINOR)) {
+    return wuffs_base__error__bad_wuffs_version;
+  }
+  if (self->private_impl.magic != 0) {
+    return wuffs_base__error__check_wuffs_version_not_applicable;
+  }
+  self->private_impl.magic = WUFFS_BASE__MAGIC;
+  return NULL;
+}
+
+wuffs_base__status WUFFS_BASE__WARN_UNUSED_RESULT  //
+wuffs_deflate__encoder__check_wuffs_version(wuffs_deflate__encoder* self,
+                                            size_t sizeof_star_self,
+                                            uint64_t wuffs_version) {
+  if (!self) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (sizeof(*self) != sizeof_star_self) {
+    return wuffs_base__error__bad_sizeof_receiver;
+  }
+  if (((wuffs_version >> 32) != WUFFS_VERSION_MAJOR) ||
+      (((wuffs_version >> 16) & 0xFFFF) > WUFFS_VERSION_MINOR)) {
+    return wuffs_base__error__bad_wuffs_version;
+  }
+  if (self->private_impl.magic != 0) {
+    return wuffs_base__error__check_wuffs_version_not_applicable;
+  }
+  self->private_impl.magic = WUFFS_BASE__MAGIC;
+  return NULL;
+}
+
+// ---------------- Function Implementations
+
+// -------- func deflate.decoder.decode
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_deflate__decoder__decode(wuffs_deflate__decoder* self,
+                               wuffs_base__io_writer a_dst,
+                               wuffs_base__io_reader a_src) {
+  if (!self) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (self->private_impl.magic != WUFFS_BASE__MAGIC) {
+    return (self->private_impl.magic == WUFFS_BASE__DISABLED)
+               ? wuffs_base__error__disabled_by_previous_error
+               : wuffs_base__error__check_wuffs_version_missing;
+  }
+  wuffs_base__status status = NULL;
+
+  wuffs_base__status v_z;
+  wuffs_base__slice_u8 v_written;
+  uint64_t v_n_copied;
+  uint32_t v_already_full;
+
+  uint8_t* iop_a_dst = NULL;
+  uint8_t* io0_a_dst = NULL;
+  uint8_t* io1_a_dst = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_dst);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_dst);
+  if (a_dst.private_impl.buf) {
+    iop_a_dst =
+        a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->meta.wi;
+    if (!a_dst.private_impl.mark) {
+      a_dst.private_impl.mark = iop_a_dst;
+      a_dst.private_impl.limit =
+          a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->data.len;
+    }
+    if (a_dst.private_impl.buf->meta.closed) {
+      a_dst.private_impl.limit = iop_a_dst;
+    }
+    io0_a_dst = a_dst.private_impl.mark;
+    io1_a_dst = a_dst.private_impl.limit;
+  }
+
+  uint32_t coro_susp_point = self->private_impl.c_decode[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_z = self->private_impl.c_decode[0].v_z;
+    v_written = ((wuffs_base__slice_u8){});
+    v_n_copied = self->private_impl.c_decode[0].v_n_copied;
+    v_already_full = self->private_impl.c_decode[0].v_already_full;
+  } else {
+    v_written = ((wuffs_base__slice_u8){});
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    while (true) {
+      wuffs_base__io_writer__set_mark(&a_dst, iop_a_dst);
+      {
+        if (a_dst.private_impl.buf) {
+          a_dst.private_impl.buf->meta.wi =
+              iop_a_dst - a_dst.private_impl.buf->data.ptr;
+        }
+        wuffs_base__status t_0 =
+            wuffs_deflate__decoder__decode_blocks(self, a_dst, a_src);
+        if (a_dst.private_impl.buf) {
+          iop_a_dst = a_dst.private_impl.buf->data.ptr +
+                      a_dst.private_impl.buf->meta.wi;
+        }
+        v_z = t_0;
+      }
+      if (!wuffs_base__status__is_suspension(v_z)) {
+        status = v_z;
+        if (wuffs_base__status__is_error(status)) {
+          goto exit;
+        } else if (wuffs_base__status__is_suspension(status)) {
+          status = wuffs_base__error__cannot_return_a_suspension;
+          goto exit;
+        }
+        goto ok;
+      }
+      v_written = ((wuffs_base__slice_u8){
+          .ptr = a_dst.private_impl.mark,
+          .len = (size_t)(iop_a_dst - a_dst.private_impl.mark),
+      });
+      if (((uint64_t)(v_written.len)) >= 32768) {
+        v_written = wuffs_base__slice_u8__suffix(v_written, 32768);
+        wuffs_base__slice_u8__copy_from_slice(
+            ((wuffs_base__slice_u8){
+                .ptr = self->private_impl.f_history,
+                .len = 32768,
+            }),
+            v_written);
+        self->private_impl.f_history_index = 32768;
+      } else {
+        v_n_copied = wuffs_base__slice_u8__copy_from_slice(
+            wuffs_base__slice_u8__subslice_i(
+                ((wuffs_base__slice_u8){
+                    .ptr = self->private_impl.f_history,
+                    .len = 32768,
+                }),
+                (self->private_impl.f_history_index & 32767)),
+            v_written);
+        if (v_n_copied < ((uint64_t)(v_written.len))) {
+          v_written = wuffs_base__slice_u8__subslice_i(v_written, v_n_copied);
+          v_n_copied = wuffs_base__slice_u8__copy_from_slice(
+              ((wuffs_base__slice_u8){
+                  .ptr = self->private_impl.f_history,
+                  .len = 32768,
+              }),
+              v_written);
+          self->private_impl.f_history_index =
+              (((uint32_t)((v_n_copied & 32767))) + 32768);
+        } else {
+          v_already_full = 0;
+          if (self->private_impl.f_history_index >= 32768) {
+            v_already_full = 32768;
+          }
+          self->private_impl.f_history_index =
+              ((self->private_impl.f_history_index & 32767) +
+               ((uint32_t)((v_n_copied & 32767))) + v_already_full);
+        }
+      }
+      status = v_z;
+      WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(1);
+    }
+
+    goto ok;
+  ok:
+    self->private_impl.c_decode[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_decode[0].coro_susp_point = coro_susp_point;
+  self->private_impl.c_decode[0].v_z = v_z;
+  self->private_impl.c_decode[0].v_n_copied = v_n_copied;
+  self->private_impl.c_decode[0].v_already_full = v_already_full;
+
+  goto exit;
+exit:
+  if (a_dst.private_impl.buf) {
+    a_dst.private_impl.buf->meta.wi =
+        iop_a_dst - a_dst.private_impl.buf->data.ptr;
+  }
+
+  if (wuffs_base__status__is_error(status)) {
+    self->private_impl.magic = WUFFS_BASE__DISABLED;
+  }
+  return status;
+}
+
+// -------- func deflate.decoder.decode_blocks
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_blocks(wuffs_deflate__decoder* self,
+                                      wuffs_base__io_writer a_dst,
+                                      wuffs_base__io_reader a_src) {
+  wuffs_base__status status = NULL;
+
+  uint32_t v_final;
+  uint32_t v_type;
+
+  uint8_t* iop_a_src = NULL;
+  uint8_t* io0_a_src = NULL;
+  uint8_t* io1_a_src = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_src);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_src);
+  if (a_src.private_impl.buf) {
+    iop_a_src =
+        a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+    if (!a_src.private_impl.mark) {
+      a_src.private_impl.mark = iop_a_src;
+      a_src.private_impl.limit =
+          a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.wi;
+    }
+    io0_a_src = a_src.private_impl.mark;
+    io1_a_src = a_src.private_impl.limit;
+  }
+
+  uint32_t coro_susp_point =
+      self->private_impl.c_decode_blocks[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_final = self->private_impl.c_decode_blocks[0].v_final;
+    v_type = self->private_impl.c_decode_blocks[0].v_type;
+  } else {
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    v_final = 0;
+  label_0_continue:;
+    while (v_final == 0) {
+      while (self->private_impl.f_n_bits < 3) {
+        {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(1);
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint8_t t_0 = *iop_a_src++;
+          self->private_impl.f_bits |=
+              (((uint32_t)(t_0)) << self->private_impl.f_n_bits);
+        }
+        self->private_impl.f_n_bits += 8;
+      }
+      v_final = (self->private_impl.f_bits & 1);
+      v_type = ((self->private_impl.f_bits >> 1) & 3);
+      self->private_impl.f_bits >>= 3;
+      self->private_impl.f_n_bits -= 3;
+      if (v_type == 0) {
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT(2);
+        if (a_src.private_impl.buf) {
+          a_src.private_impl.buf->meta.ri =
+              iop_a_src - a_src.private_impl.buf->data.ptr;
+        }
+        status =
+            wuffs_deflate__decoder__decode_uncompressed(self, a_dst, a_src);
+        if (a_src.private_impl.buf) {
+          iop_a_src = a_src.private_impl.buf->data.ptr +
+                      a_src.private_impl.buf->meta.ri;
+        }
+        if (status) {
+          goto suspend;
+        }
+        goto label_0_continue;
+      } else if (v_type == 1) {
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT(3);
+        status = wuffs_deflate__decoder__init_fixed_huffman(self);
+        if (status) {
+          goto suspend;
+        }
+      } else if (v_type == 2) {
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT(4);
+        if (a_src.private_impl.buf) {
+          a_src.private_impl.buf->meta.ri =
+              iop_a_src - a_src.private_impl.buf->data.ptr;
+        }
+        status = wuffs_deflate__decoder__init_dynamic_huffman(self, a_src);
+        if (a_src.private_impl.buf) {
+          iop_a_src = a_src.private_impl.buf->data.ptr +
+                      a_src.private_impl.buf->meta.ri;
+        }
+        if (status) {
+          goto suspend;
+        }
+      } else {
+        status = wuffs_deflate__error__bad_block;
+        goto exit;
+      }
+      self->private_impl.f_end_of_block = false;
+      WUFFS_BASE__COROUTINE_SUSPENSION_POINT(5);
+      if (a_src.private_impl.buf) {
+        a_src.private_impl.buf->meta.ri =
+            iop_a_src - a_src.private_impl.buf->data.ptr;
+      }
+      status = wuffs_deflate__decoder__decode_huffman_fast(self, a_dst, a_src);
+      if (a_src.private_impl.buf) {
+        iop_a_src =
+            a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+      }
+      if (status) {
+        goto suspend;
+      }
+      if (self->private_impl.f_end_of_block) {
+        goto label_0_continue;
+      }
+      WUFFS_BASE__COROUTINE_SUSPENSION_POINT(6);
+      if (a_src.private_impl.buf) {
+        a_src.private_impl.buf->meta.ri =
+            iop_a_src - a_src.private_impl.buf->data.ptr;
+      }
+      status = wuffs_deflate__decoder__decode_huffman_slow(self, a_dst, a_src);
+      if (a_src.private_impl.buf) {
+        iop_a_src =
+            a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+      }
+      if (status) {
+        goto suspend;
+      }
+      if (self->private_impl.f_end_of_block) {
+        goto label_0_continue;
+      }
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_end_of_block;
+      goto exit;
+    }
+
+    goto ok;
+  ok:
+    self->private_impl.c_decode_blocks[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_decode_blocks[0].coro_susp_point = coro_susp_point;
+  self->private_impl.c_decode_blocks[0].v_final = v_final;
+  self->private_impl.c_decode_blocks[0].v_type = v_type;
+
+  goto exit;
+exit:
+  if (a_src.private_impl.buf) {
+    a_src.private_impl.buf->meta.ri =
+        iop_a_src - a_src.private_impl.buf->data.ptr;
+  }
+
+  return status;
+}
+
+// -------- func deflate.decoder.decode_uncompressed
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_uncompressed(wuffs_deflate__decoder* self,
+                                            wuffs_base__io_writer a_dst,
+                                            wuffs_base__io_reader a_src) {
+  wuffs_base__status status = NULL;
+
+  uint32_t v_length;
+  uint32_t v_n_copied;
+
+  uint8_t* iop_a_dst = NULL;
+  uint8_t* io0_a_dst = NULL;
+  uint8_t* io1_a_dst = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_dst);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_dst);
+  if (a_dst.private_impl.buf) {
+    iop_a_dst =
+        a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->meta.wi;
+    if (!a_dst.private_impl.mark) {
+      a_dst.private_impl.mark = iop_a_dst;
+      a_dst.private_impl.limit =
+          a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->data.len;
+    }
+    if (a_dst.private_impl.buf->meta.closed) {
+      a_dst.private_impl.limit = iop_a_dst;
+    }
+    io0_a_dst = a_dst.private_impl.mark;
+    io1_a_dst = a_dst.private_impl.limit;
+  }
+  uint8_t* iop_a_src = NULL;
+  uint8_t* io0_a_src = NULL;
+  uint8_t* io1_a_src = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_src);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_src);
+  if (a_src.private_impl.buf) {
+    iop_a_src =
+        a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+    if (!a_src.private_impl.mark) {
+      a_src.private_impl.mark = iop_a_src;
+      a_src.private_impl.limit =
+          a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.wi;
+    }
+    io0_a_src = a_src.private_impl.mark;
+    io1_a_src = a_src.private_impl.limit;
+  }
+
+  uint32_t coro_susp_point =
+      self->private_impl.c_decode_uncompressed[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_length = self->private_impl.c_decode_uncompressed[0].v_length;
+    v_n_copied = self->private_impl.c_decode_uncompressed[0].v_n_copied;
+  } else {
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    if ((self->private_impl.f_n_bits >= 8) ||
+        ((self->private_impl.f_bits >> self->private_impl.f_n_bits) != 0)) {
+      status = wuffs_deflate__error__internal_error_inconsistent_n_bits;
+      goto exit;
+    }
+    self->private_impl.f_n_bits = 0;
+    self->private_impl.f_bits = 0;
+    {
+      WUFFS_BASE__COROUTINE_SUSPENSION_POINT(1);
+      uint32_t t_1;
+      if (WUFFS_BASE__LIKELY(io1_a_src - iop_a_src >= 4)) {
+        t_1 = wuffs_base__load_u32le(iop_a_src);
+        iop_a_src += 4;
+      } else {
+        self->private_impl.c_decode_uncompressed[0].scratch = 0;
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT(2);
+        while (true) {
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint64_t* scratch =
+              &self->private_impl.c_decode_uncompressed[0].scratch;
+          uint32_t t_0 = *scratch >> 56;
+          *scratch <<= 8;
+          *scratch >>= 8;
+          *scratch |= ((uint64_t)(*iop_a_src++)) << t_0;
+          if (t_0 == 24) {
+            t_1 = *scratch;
+            break;
+          }
+          t_0 += 8;
+          *scratch |= ((uint64_t)(t_0)) << 56;
+        }
+      }
+      v_length = t_1;
+    }
+    if ((((v_length) & ((1 << (16)) - 1)) + ((v_length) >> (32 - (16)))) !=
+        65535) {
+      status = wuffs_deflate__error__inconsistent_stored_block_length;
+      goto exit;
+    }
+    v_length = ((v_length) & ((1 << (16)) - 1));
+    while (true) {
+      v_n_copied = wuffs_base__io_writer__copy_n_from_reader(
+          &iop_a_dst, io1_a_dst, v_length, &iop_a_src, io1_a_src);
+      if (v_length <= v_n_copied) {
+        status = NULL;
+        goto ok;
+      }
+      v_length -= v_n_copied;
+      if (((uint64_t)(io1_a_dst - iop_a_dst)) == 0) {
+        status = wuffs_base__suspension__short_write;
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(3);
+      } else {
+        status = wuffs_base__suspension__short_read;
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(4);
+      }
+    }
+
+    goto ok;
+  ok:
+    self->private_impl.c_decode_uncompressed[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_decode_uncompressed[0].coro_susp_point = coro_susp_point;
+  self->private_impl.c_decode_uncompressed[0].v_length = v_length;
+  self->private_impl.c_decode_uncompressed[0].v_n_copied = v_n_copied;
+
+  goto exit;
+exit:
+  if (a_dst.private_impl.buf) {
+    a_dst.private_impl.buf->meta.wi =
+        iop_a_dst - a_dst.private_impl.buf->data.ptr;
+  }
+  if (a_src.private_impl.buf) {
+    a_src.private_impl.buf->meta.ri =
+        iop_a_src - a_src.private_impl.buf->data.ptr;
+  }
+
+  return status;
+}
+
+// -------- func deflate.decoder.init_fixed_huffman
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__init_fixed_huffman(wuffs_deflate__decoder* self) {
+  wuffs_base__status status = NULL;
+
+  uint32_t v_i;
+
+  uint32_t coro_susp_point =
+      self->private_impl.c_init_fixed_huffman[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_i = self->private_impl.c_init_fixed_huffman[0].v_i;
+  } else {
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    v_i = 0;
+    while (v_i < 144) {
+      self->private_impl.f_code_lengths[v_i] = 8;
+      v_i += 1;
+    }
+    while (v_i < 256) {
+      self->private_impl.f_code_lengths[v_i] = 9;
+      v_i += 1;
+    }
+    while (v_i < 280) {
+      self->private_impl.f_code_lengths[v_i] = 7;
+      v_i += 1;
+    }
+    while (v_i < 288) {
+      self->private_impl.f_code_lengths[v_i] = 8;
+      v_i += 1;
+    }
+    while (v_i < 320) {
+      self->private_impl.f_code_lengths[v_i] = 5;
+      v_i += 1;
+    }
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT(1);
+    status = wuffs_deflate__decoder__init_huff(self, 0, 0, 288, 257);
+    if (status) {
+      goto suspend;
+    }
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT(2);
+    status = wuffs_deflate__decoder__init_huff(self, 1, 288, 320, 0);
+    if (status) {
+      goto suspend;
+    }
+
+    goto ok;
+  ok:
+    self->private_impl.c_init_fixed_huffman[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_init_fixed_huffman[0].coro_susp_point = coro_susp_point;
+  self->private_impl.c_init_fixed_huffman[0].v_i = v_i;
+
+  goto exit;
+exit:
+  return status;
+}
+
+// -------- func deflate.decoder.init_dynamic_huffman
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__init_dynamic_huffman(wuffs_deflate__decoder* self,
+                                             wuffs_base__io_reader a_src) {
+  wuffs_base__status status = NULL;
+
+  uint32_t v_bits;
+  uint32_t v_n_bits;
+  uint32_t v_n_lit;
+  uint32_t v_n_dist;
+  uint32_t v_n_clen;
+  uint32_t v_i;
+  uint32_t v_mask;
+  uint32_t v_table_entry;
+  uint32_t v_table_entry_n_bits;
+  uint32_t v_n_extra_bits;
+  uint8_t v_rep_symbol;
+  uint32_t v_rep_count;
+
+  uint8_t* iop_a_src = NULL;
+  uint8_t* io0_a_src = NULL;
+  uint8_t* io1_a_src = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_src);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_src);
+  if (a_src.private_impl.buf) {
+    iop_a_src =
+        a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+    if (!a_src.private_impl.mark) {
+      a_src.private_impl.mark = iop_a_src;
+      a_src.private_impl.limit =
+          a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.wi;
+    }
+    io0_a_src = a_src.private_impl.mark;
+    io1_a_src = a_src.private_impl.limit;
+  }
+
+  uint32_t coro_susp_point =
+      self->private_impl.c_init_dynamic_huffman[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_bits = self->private_impl.c_init_dynamic_huffman[0].v_bits;
+    v_n_bits = self->private_impl.c_init_dynamic_huffman[0].v_n_bits;
+    v_n_lit = self->private_impl.c_init_dynamic_huffman[0].v_n_lit;
+    v_n_dist = self->private_impl.c_init_dynamic_huffman[0].v_n_dist;
+    v_n_clen = self->private_impl.c_init_dynamic_huffman[0].v_n_clen;
+    v_i = self->private_impl.c_init_dynamic_huffman[0].v_i;
+    v_mask = self->private_impl.c_init_dynamic_huffman[0].v_mask;
+    v_table_entry = self->private_impl.c_init_dynamic_huffman[0].v_table_entry;
+    v_table_entry_n_bits =
+        self->private_impl.c_init_dynamic_huffman[0].v_table_entry_n_bits;
+    v_n_extra_bits =
+        self->private_impl.c_init_dynamic_huffman[0].v_n_extra_bits;
+    v_rep_symbol = self->private_impl.c_init_dynamic_huffman[0].v_rep_symbol;
+    v_rep_count = self->private_impl.c_init_dynamic_huffman[0].v_rep_count;
+  } else {
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    v_bits = self->private_impl.f_bits;
+    v_n_bits = self->private_impl.f_n_bits;
+    while (v_n_bits < 14) {
+      {
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT(1);
+        if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+          status = wuffs_base__suspension__short_read;
+          goto suspend;
+        }
+        uint8_t t_0 = *iop_a_src++;
+        v_bits |= (((uint32_t)(t_0)) << v_n_bits);
+      }
+      v_n_bits += 8;
+    }
+    v_n_lit = (((v_bits) & ((1 << (5)) - 1)) + 257);
+    if (v_n_lit > 286) {
+      status = wuffs_deflate__error__bad_literal_length_code_count;
+      goto exit;
+    }
+    v_bits >>= 5;
+    v_n_dist = (((v_bits) & ((1 << (5)) - 1)) + 1);
+    if (v_n_dist > 30) {
+      status = wuffs_deflate__error__bad_distance_code_count;
+      goto exit;
+    }
+    v_bits >>= 5;
+    v_n_clen = (((v_bits) & ((1 << (4)) - 1)) + 4);
+    v_bits >>= 4;
+    v_n_bits -= 14;
+    v_i = 0;
+    while (v_i < v_n_clen) {
+      while (v_n_bits < 3) {
+        {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(2);
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint8_t t_1 = *iop_a_src++;
+          v_bits |= (((uint32_t)(t_1)) << v_n_bits);
+        }
+        v_n_bits += 8;
+      }
+      self->private_impl.f_code_lengths[wuffs_deflate__code_order[v_i]] =
+          ((uint8_t)((v_bits & 7)));
+      v_bits >>= 3;
+      v_n_bits -= 3;
+      v_i += 1;
+    }
+    while (v_i < 19) {
+      self->private_impl.f_code_lengths[wuffs_deflate__code_order[v_i]] = 0;
+      v_i += 1;
+    }
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT(3);
+    status = wuffs_deflate__decoder__init_huff(self, 0, 0, 19, 4095);
+    if (status) {
+      goto suspend;
+    }
+    v_mask = ((((uint32_t)(1)) << self->private_impl.f_n_huffs_bits[0]) - 1);
+    v_i = 0;
+  label_0_continue:;
+    while (v_i < (v_n_lit + v_n_dist)) {
+      v_table_entry = 0;
+      while (true) {
+        v_table_entry = self->private_impl.f_huffs[0][(v_bits & v_mask)];
+        v_table_entry_n_bits = (v_table_entry & 15);
+        if (v_n_bits >= v_table_entry_n_bits) {
+          v_bits >>= v_table_entry_n_bits;
+          v_n_bits -= v_table_entry_n_bits;
+          goto label_1_break;
+        }
+        {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(4);
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint8_t t_2 = *iop_a_src++;
+          v_bits |= (((uint32_t)(t_2)) << v_n_bits);
+        }
+        v_n_bits += 8;
+      }
+    label_1_break:;
+      if ((v_table_entry >> 24) != 128) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      v_table_entry = ((v_table_entry >> 8) & 255);
+      if (v_table_entry < 16) {
+        self->private_impl.f_code_lengths[v_i] = ((uint8_t)(v_table_entry));
+        v_i += 1;
+        goto label_0_continue;
+      }
+      v_n_extra_bits = 0;
+      v_rep_symbol = 0;
+      v_rep_count = 0;
+      if (v_table_entry == 16) {
+        v_n_extra_bits = 2;
+        if (v_i <= 0) {
+          status = wuffs_deflate__error__bad_huffman_code_length_repetition;
+          goto exit;
+        }
+        v_rep_symbol = self->private_impl.f_code_lengths[(v_i - 1)];
+        v_rep_count = 3;
+      } else if (v_table_entry == 17) {
+        v_n_extra_bits = 3;
+        v_rep_symbol = 0;
+        v_rep_count = 3;
+      } else if (v_table_entry == 18) {
+        v_n_extra_bits = 7;
+        v_rep_symbol = 0;
+        v_rep_count = 11;
+      } else {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      while (v_n_bits < v_n_extra_bits) {
+        {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(5);
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint8_t t_3 = *iop_a_src++;
+          v_bits |= (((uint32_t)(t_3)) << v_n_bits);
+        }
+        v_n_bits += 8;
+      }
+      v_rep_count += ((v_bits) & ((1 << (v_n_extra_bits)) - 1));
+      v_bits >>= v_n_extra_bits;
+      v_n_bits -= v_n_extra_bits;
+      while (v_rep_count > 0) {
+        if (v_i >= (v_n_lit + v_n_dist)) {
+          status = wuffs_deflate__error__bad_huffman_code_length_count;
+          goto exit;
+        }
+        self->private_impl.f_code_lengths[v_i] = v_rep_symbol;
+        v_i += 1;
+        v_rep_count -= 1;
+      }
+    }
+    if (v_i != (v_n_lit + v_n_dist)) {
+      status = wuffs_deflate__error__bad_huffman_code_length_count;
+      goto exit;
+    }
+    if (self->private_impl.f_code_lengths[256] == 0) {
+      status = wuffs_deflate__error__missing_end_of_block_code;
+      goto exit;
+    }
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT(6);
+    status = wuffs_deflate__decoder__init_huff(self, 0, 0, v_n_lit, 257);
+    if (status) {
+      goto suspend;
+    }
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT(7);
+    status = wuffs_deflate__decoder__init_huff(self, 1, v_n_lit,
+                                               (v_n_lit + v_n_dist), 0);
+    if (status) {
+      goto suspend;
+    }
+    self->private_impl.f_bits = v_bits;
+    self->private_impl.f_n_bits = v_n_bits;
+
+    goto ok;
+  ok:
+    self->private_impl.c_init_dynamic_huffman[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_init_dynamic_huffman[0].coro_susp_point =
+      coro_susp_point;
+  self->private_impl.c_init_dynamic_huffman[0].v_bits = v_bits;
+  self->private_impl.c_init_dynamic_huffman[0].v_n_bits = v_n_bits;
+  self->private_impl.c_init_dynamic_huffman[0].v_n_lit = v_n_lit;
+  self->private_impl.c_init_dynamic_huffman[0].v_n_dist = v_n_dist;
+  self->private_impl.c_init_dynamic_huffman[0].v_n_clen = v_n_clen;
+  self->private_impl.c_init_dynamic_huffman[0].v_i = v_i;
+  self->private_impl.c_init_dynamic_huffman[0].v_mask = v_mask;
+  self->private_impl.c_init_dynamic_huffman[0].v_table_entry = v_table_entry;
+  self->private_impl.c_init_dynamic_huffman[0].v_table_entry_n_bits =
+      v_table_entry_n_bits;
+  self->private_impl.c_init_dynamic_huffman[0].v_n_extra_bits = v_n_extra_bits;
+  self->private_impl.c_init_dynamic_huffman[0].v_rep_symbol = v_rep_symbol;
+  self->private_impl.c_init_dynamic_huffman[0].v_rep_count = v_rep_count;
+
+  goto exit;
+exit:
+  if (a_src.private_impl.buf) {
+    a_src.private_impl.buf->meta.ri =
+        iop_a_src - a_src.private_impl.buf->data.ptr;
+  }
+
+  return status;
+}
+
+// -------- func deflate.decoder.init_huff
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__init_huff(wuffs_deflate__decoder* self,
+                                  uint32_t a_which,
+                                  uint32_t a_n_codes0,
+                                  uint32_t a_n_codes1,
+                                  uint32_t a_base_symbol) {
+  wuffs_base__status status = NULL;
+
+  uint16_t v_counts[16];
+  uint32_t v_i;
+  uint32_t v_remaining;
+  uint16_t v_offsets[16];
+  uint32_t v_n_symbols;
+  uint32_t v_count;
+  uint16_t v_symbols[320];
+  uint32_t v_min_cl;
+  uint32_t v_max_cl;
+  uint32_t v_initial_high_bits;
+  uint32_t v_prev_cl;
+  uint32_t v_prev_redirect_key;
+  uint32_t v_top;
+  uint32_t v_next_top;
+  uint32_t v_code;
+  uint32_t v_key;
+  uint32_t v_value;
+  uint32_t v_cl;
+  uint32_t v_tmp;
+  uint32_t v_redirect_key;
+  uint32_t v_j;
+  uint32_t v_reversed_key;
+  uint32_t v_symbol;
+  uint32_t v_high_bits;
+  uint32_t v_delta;
+
+  memset(v_counts, 0, sizeof(v_counts));
+  v_i = a_n_codes0;
+  while (v_i < a_n_codes1) {
+    if (v_counts[self->private_impl.f_code_lengths[v_i]] >= 320) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_counts[self->private_impl.f_code_lengths[v_i]] += 1;
+    v_i += 1;
+  }
+  if ((((uint32_t)(v_counts[0])) + a_n_codes0) == a_n_codes1) {
+    status = wuffs_deflate__error__no_huffman_codes;
+    goto exit;
+  }
+  v_remaining = 1;
+  v_i = 1;
+  while (v_i <= 15) {
+    if (v_remaining > 1073741824) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_remaining <<= 1;
+    if (v_remaining < ((uint32_t)(v_counts[v_i]))) {
+      status = wuffs_deflate__error__bad_huffman_code_over_subscribed;
+      goto exit;
+    }
+    v_remaining -= ((uint32_t)(v_counts[v_i]));
+    v_i += 1;
+  }
+  if (v_remaining != 0) {
+    status = wuffs_deflate__error__bad_huffman_code_under_subscribed;
+    goto exit;
+  }
+  memset(v_offsets, 0, sizeof(v_offsets));
+  v_n_symbols = 0;
+  v_i = 1;
+  while (v_i <= 15) {
+    v_offsets[v_i] = ((uint16_t)(v_n_symbols));
+    v_count = ((uint32_t)(v_counts[v_i]));
+    if (v_n_symbols > (320 - v_count)) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_n_symbols = (v_n_symbols + v_count);
+    v_i += 1;
+  }
+  if (v_n_symbols > 288) {
+    status =
+        wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+    goto exit;
+  }
+  memset(v_symbols, 0, sizeof(v_symbols));
+  v_i = a_n_codes0;
+  while (v_i < a_n_codes1) {
+    if (v_i < a_n_codes0) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    if (self->private_impl.f_code_lengths[v_i] != 0) {
+      if (v_offsets[self->private_impl.f_code_lengths[v_i]] >= 320) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      v_symbols[v_offsets[self->private_impl.f_code_lengths[v_i]]] =
+          ((uint16_t)((v_i - a_n_codes0)));
+      v_offsets[self->private_impl.f_code_lengths[v_i]] += 1;
+    }
+    v_i += 1;
+  }
+  v_min_cl = 1;
+  while (true) {
+    if (v_counts[v_min_cl] != 0) {
+      goto label_0_break;
+    }
+    if (v_min_cl >= 9) {
+      status = wuffs_deflate__error__bad_huffman_minimum_code_length;
+      goto exit;
+    }
+    v_min_cl += 1;
+  }
+label_0_break:;
+  v_max_cl = 15;
+  while (true) {
+    if (v_counts[v_max_cl] != 0) {
+      goto label_1_break;
+    }
+    if (v_max_cl <= 1) {
+      status = wuffs_deflate__error__no_huffman_codes;
+      goto exit;
+    }
+    v_max_cl -= 1;
+  }
+label_1_break:;
+  if (v_max_cl <= 9) {
+    self->private_impl.f_n_huffs_bits[a_which] = v_max_cl;
+  } else {
+    self->private_impl.f_n_huffs_bits[a_which] = 9;
+  }
+  v_i = 0;
+  if ((v_n_symbols != ((uint32_t)(v_offsets[v_max_cl]))) ||
+      (v_n_symbols != ((uint32_t)(v_offsets[15])))) {
+    status =
+        wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+    goto exit;
+  }
+  if ((a_n_codes0 + ((uint32_t)(v_symbols[0]))) >= 320) {
+    status =
+        wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+    goto exit;
+  }
+  v_initial_high_bits = 512;
+  if (v_max_cl < 9) {
+    v_initial_high_bits = (((uint32_t)(1)) << v_max_cl);
+  }
+  v_prev_cl = ((uint32_t)(self->private_impl.f_code_lengths[(
+      a_n_codes0 + ((uint32_t)(v_symbols[0])))]));
+  v_prev_redirect_key = 4294967295;
+  v_top = 0;
+  v_next_top = 512;
+  v_code = 0;
+  v_key = 0;
+  v_value = 0;
+  while (true) {
+    if ((a_n_codes0 + ((uint32_t)(v_symbols[v_i]))) >= 320) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_cl = ((uint32_t)(self->private_impl.f_code_lengths[(
+        a_n_codes0 + ((uint32_t)(v_symbols[v_i])))]));
+    if (v_cl > v_prev_cl) {
+      v_code <<= (v_cl - v_prev_cl);
+      if (v_code >= 32768) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+    }
+    v_prev_cl = v_cl;
+    v_key = v_code;
+    if (v_cl > 9) {
+      v_tmp = (v_cl - 9);
+      v_cl = v_tmp;
+      v_redirect_key = ((v_key >> v_tmp) & 511);
+      v_key = ((v_key) & ((1 << (v_tmp)) - 1));
+      if (v_prev_redirect_key != v_redirect_key) {
+        v_prev_redirect_key = v_redirect_key;
+        v_remaining = (((uint32_t)(1)) << v_cl);
+        v_j = v_prev_cl;
+        while (v_j <= 15) {
+          if (v_remaining <= ((uint32_t)(v_counts[v_j]))) {
+            goto label_2_break;
+          }
+          v_remaining -= ((uint32_t)(v_counts[v_j]));
+          if (v_remaining > 1073741824) {
+            status =
+                wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+            goto exit;
+          }
+          v_remaining <<= 1;
+          v_j += 1;
+        }
+      label_2_break:;
+        if ((v_j <= 9) || (15 < v_j)) {
+          status =
+              wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+          goto exit;
+        }
+        v_tmp = (v_j - 9);
+        v_initial_high_bits = (((uint32_t)(1)) << v_tmp);
+        v_top = v_next_top;
+        if ((v_top + (((uint32_t)(1)) << v_tmp)) > 1234) {
+          status =
+              wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+          goto exit;
+        }
+        v_next_top = (v_top + (((uint32_t)(1)) << v_tmp));
+        v_redirect_key =
+            (((uint32_t)(wuffs_deflate__reverse8[(v_redirect_key >> 1)])) |
+             ((v_redirect_key & 1) << 8));
+        self->private_impl.f_huffs[a_which][v_redirect_key] =
+            (268435465 | (v_top << 8) | (v_tmp << 4));
+      }
+    }
+    if ((v_key >= 512) || (v_counts[v_prev_cl] <= 0)) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_counts[v_prev_cl] -= 1;
+    v_reversed_key = (((uint32_t)(wuffs_deflate__reverse8[(v_key >> 1)])) |
+                      ((v_key & 1) << 8));
+    v_reversed_key >>= (9 - v_cl);
+    v_symbol = ((uint32_t)(v_symbols[v_i]));
+    if (v_symbol == 256) {
+      v_value = (536870912 | v_cl);
+    } else if ((v_symbol < 256) && (a_which == 0)) {
+      v_value = (2147483648 | (v_symbol << 8) | v_cl);
+    } else if (v_symbol >= a_base_symbol) {
+      v_symbol -= a_base_symbol;
+      if (a_which == 0) {
+        v_value = (wuffs_deflate__lcode_magic_numbers[(v_symbol & 31)] | v_cl);
+      } else {
+        v_value = (wuffs_deflate__dcode_magic_numbers[(v_symbol & 31)] | v_cl);
+      }
+    } else {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_high_bits = v_initial_high_bits;
+    v_delta = (((uint32_t)(1)) << v_cl);
+    while (v_high_bits >= v_delta) {
+      v_high_bits -= v_delta;
+      if ((v_top + ((v_high_bits | v_reversed_key) & 511)) >= 1234) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      self->private_impl
+          .f_huffs[a_which][(v_top + ((v_high_bits | v_reversed_key) & 511))] =
+          v_value;
+    }
+    v_i += 1;
+    if (v_i >= v_n_symbols) {
+      goto label_3_break;
+    }
+    v_code += 1;
+    if (v_code >= 32768) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+  }
+label_3_break:;
+  goto exit;
+exit:
+  return status;
+}
+
+// -------- func deflate.decoder.decode_huffman_fast
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_huffman_fast(wuffs_deflate__decoder* self,
+                                            wuffs_base__io_writer a_dst,
+                                            wuffs_base__io_reader a_src) {
+  wuffs_base__status status = NULL;
+
+  uint32_t v_bits;
+  uint32_t v_n_bits;
+  uint32_t v_table_entry;
+  uint32_t v_table_entry_n_bits;
+  uint32_t v_lmask;
+  uint32_t v_dmask;
+  uint32_t v_redir_top;
+  uint32_t v_redir_mask;
+  uint32_t v_length;
+  uint32_t v_dist_minus_1;
+  uint32_t v_n_copied;
+  uint32_t v_hlen;
+  uint32_t v_hdist;
+
+  uint8_t* iop_a_dst = NULL;
+  uint8_t* io0_a_dst = NULL;
+  uint8_t* io1_a_dst = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_dst);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_dst);
+  if (a_dst.private_impl.buf) {
+    iop_a_dst =
+        a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->meta.wi;
+    if (!a_dst.private_impl.mark) {
+      a_dst.private_impl.mark = iop_a_dst;
+      a_dst.private_impl.limit =
+          a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->data.len;
+    }
+    if (a_dst.private_impl.buf->meta.closed) {
+      a_dst.private_impl.limit = iop_a_dst;
+    }
+    io0_a_dst = a_dst.private_impl.mark;
+    io1_a_dst = a_dst.private_impl.limit;
+  }
+  uint8_t* iop_a_src = NULL;
+  uint8_t* io0_a_src = NULL;
+  uint8_t* io1_a_src = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_src);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_src);
+  if (a_src.private_impl.buf) {
+    iop_a_src =
+        a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+    if (!a_src.private_impl.mark) {
+      a_src.private_impl.mark = iop_a_src;
+      a_src.private_impl.limit =
+          a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.wi;
+    }
+    io0_a_src = a_src.private_impl.mark;
+    io1_a_src = a_src.private_impl.limit;
+  }
+
+  if ((self->private_impl.f_n_bits >= 8) ||
+      ((self->private_impl.f_bits >> self->private_impl.f_n_bits) != 0)) {
+    status = wuffs_deflate__error__internal_error_inconsistent_n_bits;
+    goto exit;
+  }
+  v_bits = self->private_impl.f_bits;
+  v_n_bits = self->private_impl.f_n_bits;
+  v_table_entry = 0;
+  v_table_entry_n_bits = 0;
+  v_lmask = ((((uint32_t)(1)) << self->private_impl.f_n_huffs_bits[0]) - 1);
+  v_dmask = ((((uint32_t)(1)) << self->private_impl.f_n_huffs_bits[1]) - 1);
+label_0_continue:;
+  while ((((uint64_t)(io1_a_dst - iop_a_dst)) >= 258) &&
+         (((uint64_t)(io1_a_src - iop_a_src)) >= 12)) {
+    if (v_n_bits < 15) {
+      v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+      (iop_a_src += 1, wuffs_base__return_empty_struct());
+      v_n_bits += 8;
+      v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+      (iop_a_src += 1, wuffs_base__return_empty_struct());
+      v_n_bits += 8;
+    } else {
+    }
+    v_table_entry = self->private_impl.f_huffs[0][(v_bits & v_lmask)];
+    v_table_entry_n_bits = (v_table_entry & 15);
+    v_bits >>= v_table_entry_n_bits;
+    v_n_bits -= v_table_entry_n_bits;
+    if ((v_table_entry >> 31) != 0) {
+      (wuffs_base__store_u8be(iop_a_dst,
+                              ((uint8_t)(((v_table_entry >> 8) & 255)))),
+       iop_a_dst += 1, wuffs_base__return_empty_struct());
+      goto label_0_continue;
+    } else if ((v_table_entry >> 30) != 0) {
+    } else if ((v_table_entry >> 29) != 0) {
+      self->private_impl.f_end_of_block = true;
+      goto label_0_break;
+    } else if ((v_table_entry >> 28) != 0) {
+      if (v_n_bits < 15) {
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+      } else {
+      }
+      v_redir_top = ((v_table_entry >> 8) & 65535);
+      v_redir_mask = ((((uint32_t)(1)) << ((v_table_entry >> 4) & 15)) - 1);
+      if ((v_redir_top + (v_bits & v_redir_mask)) >= 1234) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      v_table_entry = self->private_impl
+                          .f_huffs[0][(v_redir_top + (v_bits & v_redir_mask))];
+      v_table_entry_n_bits = (v_table_entry & 15);
+      v_bits >>= v_table_entry_n_bits;
+      v_n_bits -= v_table_entry_n_bits;
+      if ((v_table_entry >> 31) != 0) {
+        (wuffs_base__store_u8be(iop_a_dst,
+                                ((uint8_t)(((v_table_entry >> 8) & 255)))),
+         iop_a_dst += 1, wuffs_base__return_empty_struct());
+        goto label_0_continue;
+      } else if ((v_table_entry >> 30) != 0) {
+      } else if ((v_table_entry >> 29) != 0) {
+        self->private_impl.f_end_of_block = true;
+        goto label_0_break;
+      } else if ((v_table_entry >> 28) != 0) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      } else if ((v_table_entry >> 27) != 0) {
+        status = wuffs_deflate__error__bad_huffman_code;
+        goto exit;
+      } else {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+    } else if ((v_table_entry >> 27) != 0) {
+      status = wuffs_deflate__error__bad_huffman_code;
+      goto exit;
+    } else {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_length = ((v_table_entry >> 8) & 32767);
+    v_table_entry_n_bits = ((v_table_entry >> 4) & 15);
+    if (v_table_entry_n_bits > 0) {
+      if (v_n_bits < 15) {
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+      } else {
+      }
+      v_length =
+          ((v_length + ((v_bits) & ((1 << (v_table_entry_n_bits)) - 1))) &
+           32767);
+      v_bits >>= v_table_entry_n_bits;
+      v_n_bits -= v_table_entry_n_bits;
+    } else {
+    }
+    if (v_length > 258) {
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    if (v_n_bits < 15) {
+      v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+      (iop_a_src += 1, wuffs_base__return_empty_struct());
+      v_n_bits += 8;
+      v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+      (iop_a_src += 1, wuffs_base__return_empty_struct());
+      v_n_bits += 8;
+    } else {
+    }
+    v_table_entry = self->private_impl.f_huffs[1][(v_bits & v_dmask)];
+    v_table_entry_n_bits = (v_table_entry & 15);
+    v_bits >>= v_table_entry_n_bits;
+    v_n_bits -= v_table_entry_n_bits;
+    if ((v_table_entry >> 28) == 1) {
+      if (v_n_bits < 15) {
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+      } else {
+      }
+      v_redir_top = ((v_table_entry >> 8) & 65535);
+      v_redir_mask = ((((uint32_t)(1)) << ((v_table_entry >> 4) & 15)) - 1);
+      if ((v_redir_top + (v_bits & v_redir_mask)) >= 1234) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      v_table_entry = self->private_impl
+                          .f_huffs[1][(v_redir_top + (v_bits & v_redir_mask))];
+      v_table_entry_n_bits = (v_table_entry & 15);
+      v_bits >>= v_table_entry_n_bits;
+      v_n_bits -= v_table_entry_n_bits;
+    } else {
+    }
+    if ((v_table_entry >> 24) != 64) {
+      if ((v_table_entry >> 24) == 8) {
+        status = wuffs_deflate__error__bad_huffman_code;
+        goto exit;
+      }
+      status =
+          wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+      goto exit;
+    }
+    v_dist_minus_1 = ((v_table_entry >> 8) & 32767);
+    v_table_entry_n_bits = ((v_table_entry >> 4) & 15);
+    if (v_table_entry_n_bits > 0) {
+      if (v_n_bits < 15) {
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+        v_bits |= (((uint32_t)(wuffs_base__load_u8be(iop_a_src))) << v_n_bits);
+        (iop_a_src += 1, wuffs_base__return_empty_struct());
+        v_n_bits += 8;
+      }
+      v_dist_minus_1 =
+          ((v_dist_minus_1 + ((v_bits) & ((1 << (v_table_entry_n_bits)) - 1))) &
+           32767);
+      v_bits >>= v_table_entry_n_bits;
+      v_n_bits -= v_table_entry_n_bits;
+    }
+    v_n_copied = 0;
+    while (true) {
+      if (((uint64_t)((v_dist_minus_1 + 1))) >
+          ((uint64_t)(((wuffs_base__slice_u8){
+                           .ptr = a_dst.private_impl.mark,
+                           .len = (size_t)(iop_a_dst - a_dst.private_impl.mark),
+                       })
+                          .len))) {
+        v_hlen = 0;
+        v_hdist = ((uint32_t)((
+            ((uint64_t)((v_dist_minus_1 + 1))) -
+            ((uint64_t)(((wuffs_base__slice_u8){
+                             .ptr = a_dst.private_impl.mark,
+                             .len =
+                                 (size_t)(iop_a_dst - a_dst.private_impl.mark),
+                         })
+                            .len)))));
+        if (v_length > v_hdist) {
+          v_length -= v_hdist;
+          v_hlen = v_hdist;
+          if (v_length > 258) {
+            status =
+                wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+            goto exit;
+          }
+        } else {
+          v_hlen = v_length;
+          v_length = 0;
+        }
+        if (self->private_impl.f_history_index < v_hdist) {
+          status = wuffs_deflate__error__bad_distance;
+          goto exit;
+        }
+        v_hdist = (self->private_impl.f_history_index - v_hdist);
+        while (true) {
+          v_n_copied = wuffs_base__io_writer__copy_n_from_slice(
+              &iop_a_dst, io1_a_dst, v_hlen,
+              wuffs_base__slice_u8__subslice_i(
+                  ((wuffs_base__slice_u8){
+                      .ptr = self->private_impl.f_history,
+                      .len = 32768,
+                  }),
+                  (v_hdist & 32767)));
+          if (v_hlen <= v_n_copied) {
+            goto label_1_break;
+          }
+          v_hlen -= v_n_copied;
+          wuffs_base__io_writer__copy_n_from_slice(
+              &iop_a_dst, io1_a_dst, v_hlen,
+              ((wuffs_base__slice_u8){
+                  .ptr = self->private_impl.f_history,
+                  .len = 32768,
+              }));
+          goto label_1_break;
+        }
+      label_1_break:;
+        if (v_length == 0) {
+          goto label_0_continue;
+        }
+        if (((uint64_t)((v_dist_minus_1 + 1))) >
+            ((uint64_t)(((wuffs_base__slice_u8){
+                             .ptr = a_dst.private_impl.mark,
+                             .len =
+                                 (size_t)(iop_a_dst - a_dst.private_impl.mark),
+                         })
+                            .len))) {
+          status = wuffs_deflate__error__internal_error_inconsistent_distance;
+          goto exit;
+        }
+      }
+      wuffs_base__io_writer__copy_n_from_history_fast(
+          &iop_a_dst, a_dst.private_impl.mark, io1_a_dst, v_length,
+          (v_dist_minus_1 + 1));
+      goto label_2_break;
+    }
+  label_2_break:;
+  }
+label_0_break:;
+  while (v_n_bits >= 8) {
+    v_n_bits -= 8;
+    if (iop_a_src > io0_a_src) {
+      (iop_a_src--, wuffs_base__return_empty_struct());
+    } else {
+      status = wuffs_deflate__error__internal_error_inconsistent_i_o;
+      goto exit;
+    }
+  }
+  self->private_impl.f_bits = (v_bits & ((((uint32_t)(1)) << v_n_bits) - 1));
+  self->private_impl.f_n_bits = v_n_bits;
+  if ((self->private_impl.f_n_bits >= 8) ||
+      ((self->private_impl.f_bits >> self->private_impl.f_n_bits) != 0)) {
+    status = wuffs_deflate__error__internal_error_inconsistent_n_bits;
+    goto exit;
+  }
+  goto exit;
+exit:
+  if (a_dst.private_impl.buf) {
+    a_dst.private_impl.buf->meta.wi =
+        iop_a_dst - a_dst.private_impl.buf->data.ptr;
+  }
+  if (a_src.private_impl.buf) {
+    a_src.private_impl.buf->meta.ri =
+        iop_a_src - a_src.private_impl.buf->data.ptr;
+  }
+
+  return status;
+}
+
+// -------- func deflate.decoder.decode_huffman_slow
+
+static wuffs_base__status  //
+wuffs_deflate__decoder__decode_huffman_slow(wuffs_deflate__decoder* self,
+                                            wuffs_base__io_writer a_dst,
+                                            wuffs_base__io_reader a_src) {
+  wuffs_base__status status = NULL;
+
+  uint32_t v_bits;
+  uint32_t v_n_bits;
+  uint32_t v_table_entry;
+  uint32_t v_table_entry_n_bits;
+  uint32_t v_lmask;
+  uint32_t v_dmask;
+  uint32_t v_redir_top;
+  uint32_t v_redir_mask;
+  uint32_t v_length;
+  uint32_t v_dist_minus_1;
+  uint32_t v_n_copied;
+  uint32_t v_hlen;
+  uint32_t v_hdist;
+
+  uint8_t* iop_a_dst = NULL;
+  uint8_t* io0_a_dst = NULL;
+  uint8_t* io1_a_dst = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_dst);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_dst);
+  if (a_dst.private_impl.buf) {
+    iop_a_dst =
+        a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->meta.wi;
+    if (!a_dst.private_impl.mark) {
+      a_dst.private_impl.mark = iop_a_dst;
+      a_dst.private_impl.limit =
+          a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->data.len;
+    }
+    if (a_dst.private_impl.buf->meta.closed) {
+      a_dst.private_impl.limit = iop_a_dst;
+    }
+    io0_a_dst = a_dst.private_impl.mark;
+    io1_a_dst = a_dst.private_impl.limit;
+  }
+  uint8_t* iop_a_src = NULL;
+  uint8_t* io0_a_src = NULL;
+  uint8_t* io1_a_src = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_src);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_src);
+  if (a_src.private_impl.buf) {
+    iop_a_src =
+        a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+    if (!a_src.private_impl.mark) {
+      a_src.private_impl.mark = iop_a_src;
+      a_src.private_impl.limit =
+          a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.wi;
+    }
+    io0_a_src = a_src.private_impl.mark;
+    io1_a_src = a_src.private_impl.limit;
+  }
+
+  uint32_t coro_susp_point =
+      self->private_impl.c_decode_huffman_slow[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_bits = self->private_impl.c_decode_huffman_slow[0].v_bits;
+    v_n_bits = self->private_impl.c_decode_huffman_slow[0].v_n_bits;
+    v_table_entry = self->private_impl.c_decode_huffman_slow[0].v_table_entry;
+    v_table_entry_n_bits =
+        self->private_impl.c_decode_huffman_slow[0].v_table_entry_n_bits;
+    v_lmask = self->private_impl.c_decode_huffman_slow[0].v_lmask;
+    v_dmask = self->private_impl.c_decode_huffman_slow[0].v_dmask;
+    v_redir_top = self->private_impl.c_decode_huffman_slow[0].v_redir_top;
+    v_redir_mask = self->private_impl.c_decode_huffman_slow[0].v_redir_mask;
+    v_length = self->private_impl.c_decode_huffman_slow[0].v_length;
+    v_dist_minus_1 = self->private_impl.c_decode_huffman_slow[0].v_dist_minus_1;
+    v_n_copied = self->private_impl.c_decode_huffman_slow[0].v_n_copied;
+    v_hlen = self->private_impl.c_decode_huffman_slow[0].v_hlen;
+    v_hdist = self->private_impl.c_decode_huffman_slow[0].v_hdist;
+  } else {
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    if ((self->private_impl.f_n_bits >= 8) ||
+        ((self->private_impl.f_bits >> self->private_impl.f_n_bits) != 0)) {
+      status = wuffs_deflate__error__internal_error_inconsistent_n_bits;
+      goto exit;
+    }
+    v_bits = self->private_impl.f_bits;
+    v_n_bits = self->private_impl.f_n_bits;
+    v_table_entry = 0;
+    v_table_entry_n_bits = 0;
+    v_lmask = ((((uint32_t)(1)) << self->private_impl.f_n_huffs_bits[0]) - 1);
+    v_dmask = ((((uint32_t)(1)) << self->private_impl.f_n_huffs_bits[1]) - 1);
+  label_0_continue:;
+    while (true) {
+      while (true) {
+        v_table_entry = self->private_impl.f_huffs[0][(v_bits & v_lmask)];
+        v_table_entry_n_bits = (v_table_entry & 15);
+        if (v_n_bits >= v_table_entry_n_bits) {
+          v_bits >>= v_table_entry_n_bits;
+          v_n_bits -= v_table_entry_n_bits;
+          goto label_1_break;
+        }
+        {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(1);
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint8_t t_0 = *iop_a_src++;
+          v_bits |= (((uint32_t)(t_0)) << v_n_bits);
+        }
+        v_n_bits += 8;
+      }
+    label_1_break:;
+      if ((v_table_entry >> 31) != 0) {
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT(2);
+        if (iop_a_dst == io1_a_dst) {
+          status = wuffs_base__suspension__short_write;
+          goto suspend;
+        }
+        *iop_a_dst++ = ((uint8_t)(((v_table_entry >> 8) & 255)));
+        goto label_0_continue;
+      } else if ((v_table_entry >> 30) != 0) {
+      } else if ((v_table_entry >> 29) != 0) {
+        self->private_impl.f_end_of_block = true;
+        goto label_0_break;
+      } else if ((v_table_entry >> 28) != 0) {
+        v_redir_top = ((v_table_entry >> 8) & 65535);
+        v_redir_mask = ((((uint32_t)(1)) << ((v_table_entry >> 4) & 15)) - 1);
+        while (true) {
+          if ((v_redir_top + (v_bits & v_redir_mask)) >= 1234) {
+            status =
+                wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+            goto exit;
+          }
+          v_table_entry =
+              self->private_impl
+                  .f_huffs[0][(v_redir_top + (v_bits & v_redir_mask))];
+          v_table_entry_n_bits = (v_table_entry & 15);
+          if (v_n_bits >= v_table_entry_n_bits) {
+            v_bits >>= v_table_entry_n_bits;
+            v_n_bits -= v_table_entry_n_bits;
+            goto label_2_break;
+          }
+          {
+            WUFFS_BASE__COROUTINE_SUSPENSION_POINT(3);
+            if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+              status = wuffs_base__suspension__short_read;
+              goto suspend;
+            }
+            uint8_t t_1 = *iop_a_src++;
+            v_bits |= (((uint32_t)(t_1)) << v_n_bits);
+          }
+          v_n_bits += 8;
+        }
+      label_2_break:;
+        if ((v_table_entry >> 31) != 0) {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(4);
+          if (iop_a_dst == io1_a_dst) {
+            status = wuffs_base__suspension__short_write;
+            goto suspend;
+          }
+          *iop_a_dst++ = ((uint8_t)(((v_table_entry >> 8) & 255)));
+          goto label_0_continue;
+        } else if ((v_table_entry >> 30) != 0) {
+        } else if ((v_table_entry >> 29) != 0) {
+          self->private_impl.f_end_of_block = true;
+          goto label_0_break;
+        } else if ((v_table_entry >> 28) != 0) {
+          status =
+              wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+          goto exit;
+        } else if ((v_table_entry >> 27) != 0) {
+          status = wuffs_deflate__error__bad_huffman_code;
+          goto exit;
+        } else {
+          status =
+              wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+          goto exit;
+        }
+      } else if ((v_table_entry >> 27) != 0) {
+        status = wuffs_deflate__error__bad_huffman_code;
+        goto exit;
+      } else {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      v_length = ((v_table_entry >> 8) & 32767);
+      v_table_entry_n_bits = ((v_table_entry >> 4) & 15);
+      if (v_table_entry_n_bits > 0) {
+        while (v_n_bits < v_table_entry_n_bits) {
+          {
+            WUFFS_BASE__COROUTINE_SUSPENSION_POINT(5);
+            if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+              status = wuffs_base__suspension__short_read;
+              goto suspend;
+            }
+            uint8_t t_2 = *iop_a_src++;
+            v_bits |= (((uint32_t)(t_2)) << v_n_bits);
+          }
+          v_n_bits += 8;
+        }
+        v_length =
+            ((v_length + ((v_bits) & ((1 << (v_table_entry_n_bits)) - 1))) &
+             32767);
+        v_bits >>= v_table_entry_n_bits;
+        v_n_bits -= v_table_entry_n_bits;
+      }
+      while (true) {
+        v_table_entry = self->private_impl.f_huffs[1][(v_bits & v_dmask)];
+        v_table_entry_n_bits = (v_table_entry & 15);
+        if (v_n_bits >= v_table_entry_n_bits) {
+          v_bits >>= v_table_entry_n_bits;
+          v_n_bits -= v_table_entry_n_bits;
+          goto label_3_break;
+        }
+        {
+          WUFFS_BASE__COROUTINE_SUSPENSION_POINT(6);
+          if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+            status = wuffs_base__suspension__short_read;
+            goto suspend;
+          }
+          uint8_t t_3 = *iop_a_src++;
+          v_bits |= (((uint32_t)(t_3)) << v_n_bits);
+        }
+        v_n_bits += 8;
+      }
+    label_3_break:;
+      if ((v_table_entry >> 28) == 1) {
+        v_redir_top = ((v_table_entry >> 8) & 65535);
+        v_redir_mask = ((((uint32_t)(1)) << ((v_table_entry >> 4) & 15)) - 1);
+        while (true) {
+          if ((v_redir_top + (v_bits & v_redir_mask)) >= 1234) {
+            status =
+                wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+            goto exit;
+          }
+          v_table_entry =
+              self->private_impl
+                  .f_huffs[1][(v_redir_top + (v_bits & v_redir_mask))];
+          v_table_entry_n_bits = (v_table_entry & 15);
+          if (v_n_bits >= v_table_entry_n_bits) {
+            v_bits >>= v_table_entry_n_bits;
+            v_n_bits -= v_table_entry_n_bits;
+            goto label_4_break;
+          }
+          {
+            WUFFS_BASE__COROUTINE_SUSPENSION_POINT(7);
+            if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+              status = wuffs_base__suspension__short_read;
+              goto suspend;
+            }
+            uint8_t t_4 = *iop_a_src++;
+            v_bits |= (((uint32_t)(t_4)) << v_n_bits);
+          }
+          v_n_bits += 8;
+        }
+      label_4_break:;
+      }
+      if ((v_table_entry >> 24) != 64) {
+        if ((v_table_entry >> 24) == 8) {
+          status = wuffs_deflate__error__bad_huffman_code;
+          goto exit;
+        }
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_huffman_decoder_state;
+        goto exit;
+      }
+      v_dist_minus_1 = ((v_table_entry >> 8) & 32767);
+      v_table_entry_n_bits = ((v_table_entry >> 4) & 15);
+      if (v_table_entry_n_bits > 0) {
+        while (v_n_bits < v_table_entry_n_bits) {
+          {
+            WUFFS_BASE__COROUTINE_SUSPENSION_POINT(8);
+            if (WUFFS_BASE__UNLIKELY(iop_a_src == io1_a_src)) {
+              status = wuffs_base__suspension__short_read;
+              goto suspend;
+            }
+            uint8_t t_5 = *iop_a_src++;
+            v_bits |= (((uint32_t)(t_5)) << v_n_bits);
+          }
+          v_n_bits += 8;
+        }
+        v_dist_minus_1 = ((v_dist_minus_1 +
+                           ((v_bits) & ((1 << (v_table_entry_n_bits)) - 1))) &
+                          32767);
+        v_bits >>= v_table_entry_n_bits;
+        v_n_bits -= v_table_entry_n_bits;
+      }
+      v_n_copied = 0;
+      while (true) {
+        if (((uint64_t)((v_dist_minus_1 + 1))) >
+            ((uint64_t)(((wuffs_base__slice_u8){
+                             .ptr = a_dst.private_impl.mark,
+                             .len =
+                                 (size_t)(iop_a_dst - a_dst.private_impl.mark),
+                         })
+                            .len))) {
+          v_hlen = 0;
+          v_hdist = ((uint32_t)((
+              ((uint64_t)((v_dist_minus_1 + 1))) -
+              ((uint64_t)(((wuffs_base__slice_u8){
+                               .ptr = a_dst.private_impl.mark,
+                               .len = (size_t)(iop_a_dst -
+                                               a_dst.private_impl.mark),
+                           })
+                              .len)))));
+          if (v_length > v_hdist) {
+            v_length -= v_hdist;
+            v_hlen = v_hdist;
+          } else {
+            v_hlen = v_length;
+            v_length = 0;
+          }
+          if (self->private_impl.f_history_index < v_hdist) {
+            status = wuffs_deflate__error__bad_distance;
+            goto exit;
+          }
+          v_hdist = (self->private_impl.f_history_index - v_hdist);
+          while (true) {
+            v_n_copied = wuffs_base__io_writer__copy_n_from_slice(
+                &iop_a_dst, io1_a_dst, v_hlen,
+                wuffs_base__slice_u8__subslice_i(
+                    ((wuffs_base__slice_u8){
+                        .ptr = self->private_impl.f_history,
+                        .len = 32768,
+                    }),
+                    (v_hdist & 32767)));
+            if (v_hlen <= v_n_copied) {
+              v_hlen = 0;
+              goto label_5_break;
+            }
+            if (v_n_copied > 0) {
+              v_hlen -= v_n_copied;
+              v_hdist = ((v_hdist + v_n_copied) & 32767);
+              if (v_hdist == 0) {
+                goto label_5_break;
+              }
+            }
+            status = wuffs_base__suspension__short_write;
+            WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(9);
+          }
+        label_5_break:;
+          if (v_hlen > 0) {
+            while (true) {
+              v_n_copied = wuffs_base__io_writer__copy_n_from_slice(
+                  &iop_a_dst, io1_a_dst, v_hlen,
+                  wuffs_base__slice_u8__subslice_i(
+                      ((wuffs_base__slice_u8){
+                          .ptr = self->private_impl.f_history,
+                          .len = 32768,
+                      }),
+                      (v_hdist & 32767)));
+              if (v_hlen <= v_n_copied) {
+                v_hlen = 0;
+                goto label_6_break;
+              }
+              v_hlen -= v_n_copied;
+              v_hdist += v_n_copied;
+              status = wuffs_base__suspension__short_write;
+              WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(10);
+            }
+          label_6_break:;
+          }
+          if (v_length == 0) {
+            goto label_0_continue;
+          }
+        }
+        v_n_copied = wuffs_base__io_writer__copy_n_from_history(
+            &iop_a_dst, a_dst.private_impl.mark, io1_a_dst, v_length,
+            (v_dist_minus_1 + 1));
+        if (v_length <= v_n_copied) {
+          v_length = 0;
+          goto label_7_break;
+        }
+        v_length -= v_n_copied;
+        status = wuffs_base__suspension__short_write;
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(11);
+      }
+    label_7_break:;
+    }
+  label_0_break:;
+    self->private_impl.f_bits = v_bits;
+    self->private_impl.f_n_bits = v_n_bits;
+    if ((self->private_impl.f_n_bits >= 8) ||
+        ((self->private_impl.f_bits >> self->private_impl.f_n_bits) != 0)) {
+      status = wuffs_deflate__error__internal_error_inconsistent_n_bits;
+      goto exit;
+    }
+
+    goto ok;
+  ok:
+    self->private_impl.c_decode_huffman_slow[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_decode_huffman_slow[0].coro_susp_point = coro_susp_point;
+  self->private_impl.c_decode_huffman_slow[0].v_bits = v_bits;
+  self->private_impl.c_decode_huffman_slow[0].v_n_bits = v_n_bits;
+  self->private_impl.c_decode_huffman_slow[0].v_table_entry = v_table_entry;
+  self->private_impl.c_decode_huffman_slow[0].v_table_entry_n_bits =
+      v_table_entry_n_bits;
+  self->private_impl.c_decode_huffman_slow[0].v_lmask = v_lmask;
+  self->private_impl.c_decode_huffman_slow[0].v_dmask = v_dmask;
+  self->private_impl.c_decode_huffman_slow[0].v_redir_top = v_redir_top;
+  self->private_impl.c_decode_huffman_slow[0].v_redir_mask = v_redir_mask;
+  self->private_impl.c_decode_huffman_slow[0].v_length = v_length;
+  self->private_impl.c_decode_huffman_slow[0].v_dist_minus_1 = v_dist_minus_1;
+  self->private_impl.c_decode_huffman_slow[0].v_n_copied = v_n_copied;
+  self->private_impl.c_decode_huffman_slow[0].v_hlen = v_hlen;
+  self->private_impl.c_decode_huffman_slow[0].v_hdist = v_hdist;
+
+  goto exit;
+exit:
+  if (a_dst.private_impl.buf) {
+    a_dst.private_impl.buf->meta.wi =
+        iop_a_dst - a_dst.private_impl.buf->data.ptr;
+  }
+  if (a_src.private_impl.buf) {
+    a_src.private_impl.buf->meta.ri =
+        iop_a_src - a_src.private_impl.buf->data.ptr;
+  }
+
+  return status;
+}
+
+// -------- func deflate.encoder.set_level
+
+WUFFS_BASE__MAYBE_STATIC void  //
+wuffs_deflate__encoder__set_level(wuffs_deflate__encoder* self,
+                                  uint32_t a_level) {
+  if (!self) {
+    return;
+  }
+  if (self->private_impl.magic != WUFFS_BASE__MAGIC) {
+    return;
+  }
+  if (a_level > 9) {
+    self->private_impl.magic = WUFFS_BASE__DISABLED;
+    return;
+  }
+
+  self->private_impl.f_level = a_level;
+  self->private_impl.f_seen_level = true;
+}
+
+// -------- func deflate.encoder.set_full_flush
+
+WUFFS_BASE__MAYBE_STATIC void  //
+wuffs_deflate__encoder__set_full_flush(wuffs_deflate__encoder* self,
+                                       bool a_full_flush) {
+  if (!self) {
+    return;
+  }
+  if (self->private_impl.magic != WUFFS_BASE__MAGIC) {
+    return;
+  }
+
+  self->private_impl.f_full_flush = a_full_flush;
+}
+
+// -------- func deflate.encoder.encode
+
+WUFFS_BASE__MAYBE_STATIC wuffs_base__status  //
+wuffs_deflate__encoder__encode(wuffs_deflate__encoder* self,
+                               wuffs_base__io_writer a_dst,
+                               wuffs_base__io_reader a_src) {
+  if (!self) {
+    return wuffs_base__error__bad_receiver;
+  }
+  if (self->private_impl.magic != WUFFS_BASE__MAGIC) {
+    return (self->private_impl.magic == WUFFS_BASE__DISABLED)
+               ? wuffs_base__error__disabled_by_previous_error
+               : wuffs_base__error__check_wuffs_version_missing;
+  }
+  wuffs_base__status status = NULL;
+
+  uint32_t v_level;
+  uint32_t v_n;
+  uint64_t v_m;
+  bool v_eof;
+  bool v_done;
+  wuffs_base__io_writer v_w;
+  wuffs_base__io_buffer u_w;
+  uint8_t* iop_v_w = NULL;
+  uint8_t* io1_v_w = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(u_w);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(iop_v_w);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_v_w);
+
+  uint8_t* iop_a_dst = NULL;
+  uint8_t* io0_a_dst = NULL;
+  uint8_t* io1_a_dst = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_dst);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_dst);
+  if (a_dst.private_impl.buf) {
+    iop_a_dst =
+        a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->meta.wi;
+    if (!a_dst.private_impl.mark) {
+      a_dst.private_impl.mark = iop_a_dst;
+      a_dst.private_impl.limit =
+          a_dst.private_impl.buf->data.ptr + a_dst.private_impl.buf->data.len;
+    }
+    if (a_dst.private_impl.buf->meta.closed) {
+      a_dst.private_impl.limit = iop_a_dst;
+    }
+    io0_a_dst = a_dst.private_impl.mark;
+    io1_a_dst = a_dst.private_impl.limit;
+  }
+  uint8_t* iop_a_src = NULL;
+  uint8_t* io0_a_src = NULL;
+  uint8_t* io1_a_src = NULL;
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io0_a_src);
+  WUFFS_BASE__IGNORE_POTENTIALLY_UNUSED_VARIABLE(io1_a_src);
+  if (a_src.private_impl.buf) {
+    iop_a_src =
+        a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.ri;
+    if (!a_src.private_impl.mark) {
+      a_src.private_impl.mark = iop_a_src;
+      a_src.private_impl.limit =
+          a_src.private_impl.buf->data.ptr + a_src.private_impl.buf->meta.wi;
+    }
+    io0_a_src = a_src.private_impl.mark;
+    io1_a_src = a_src.private_impl.limit;
+  }
+
+  uint32_t coro_susp_point = self->private_impl.c_encode[0].coro_susp_point;
+  if (coro_susp_point) {
+    v_level = self->private_impl.c_encode[0].v_level;
+    v_n = self->private_impl.c_encode[0].v_n;
+    v_m = self->private_impl.c_encode[0].v_m;
+    v_eof = self->private_impl.c_encode[0].v_eof;
+    v_done = self->private_impl.c_encode[0].v_done;
+    v_w = ((wuffs_base__io_writer){});
+  } else {
+    v_eof = false;
+    v_done = false;
+    v_w = ((wuffs_base__io_writer){});
+  }
+  switch (coro_susp_point) {
+    WUFFS_BASE__COROUTINE_SUSPENSION_POINT_0;
+
+    v_level = 6;
+    if (self->private_impl.f_seen_level) {
+      v_level = self->private_impl.f_level;
+    }
+    v_n = 0;
+    v_m = 0;
+    v_eof = 0;
+    v_done = 0;
+  label_0_continue:;
+    while (true) {
+      if (self->private_impl.f_window_wi < 65536) {
+        v_w = ((wuffs_base__io_writer){});
+        {
+          wuffs_base__io_writer o_0_v_w = v_w;
+          uint8_t* o_0_iop_v_w = iop_v_w;
+          uint8_t* o_0_io1_v_w = io1_v_w;
+          wuffs_base__io_writer__set(&v_w, &u_w, &iop_v_w, &io1_v_w,
+                                     wuffs_base__slice_u8__subslice_i(
+                                         ((wuffs_base__slice_u8){
+                                             .ptr = self->private_impl.f_window,
+                                             .len = 65536,
+                                         }),
+                                         self->private_impl.f_window_wi));
+          v_n = wuffs_base__io_writer__copy_n_from_reader(
+              &iop_v_w, io1_v_w, 4294967295, &iop_a_src, io1_a_src);
+          v_w = o_0_v_w;
+          iop_v_w = o_0_iop_v_w;
+          io1_v_w = o_0_io1_v_w;
+        }
+        v_m =
+            (((uint64_t)(self->private_impl.f_window_wi)) + ((uint64_t)(v_n)));
+        self->private_impl.f_window_wi =
+            ((uint32_t)(wuffs_base__u64__min(v_m, 65536)));
+      }
+      v_eof = (wuffs_base__io_reader__is_eof(a_src) &&
+               (((uint64_t)(io1_a_src - iop_a_src)) <= 0));
+      if (v_level > 0) {
+        wuffs_deflate__encoder__find_matches(self, v_eof, v_level);
+      } else {
+        wuffs_deflate__encoder__find_literals(self, v_eof);
+      }
+      v_done = (v_eof && (self->private_impl.f_window_pos >=
+                          self->private_impl.f_window_wi));
+      if (!v_done && (self->private_impl.f_n_symbols < 16384) &&
+          (self->private_impl.f_window_wi < 65536)) {
+        status = wuffs_base__suspension__short_read;
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(1);
+        goto label_0_continue;
+      }
+      wuffs_deflate__encoder__write_block(
+          self, (v_done && !self->private_impl.f_full_flush), (v_level == 0));
+      if (v_done) {
+        if (self->private_impl.f_full_flush) {
+          wuffs_deflate__encoder__write_stored_block_header(self, false, 0);
+        } else {
+          wuffs_deflate__encoder__flush_bits(self);
+        }
+      }
+      if (self->private_impl.f_out_overflow) {
+        status =
+            wuffs_deflate__error__internal_error_inconsistent_encoder_output_length;
+        goto exit;
+      }
+      while (self->private_impl.f_out_ri < self->private_impl.f_out_wi) {
+        v_m = wuffs_base__io_writer__copy_from_slice(
+            &iop_a_dst, io1_a_dst,
+            wuffs_base__slice_u8__subslice_ij(
+                ((wuffs_base__slice_u8){
+                    .ptr = self->private_impl.f_out,
+                    .len = 66560,
+                }),
+                self->private_impl.f_out_ri, self->private_impl.f_out_wi));
+        v_m = (wuffs_base__u64__min(v_m, 66560) +
+               ((uint64_t)(self->private_impl.f_out_ri)));
+        self->private_impl.f_out_ri = ((uint32_t)(wuffs_base__u64__min(
+            v_m, ((uint64_t)(self->private_impl.f_out_wi)))));
+        if (self->private_impl.f_out_ri >= self->private_impl.f_out_wi) {
+          goto label_1_break;
+        }
+        status = wuffs_base__suspension__short_write;
+        WUFFS_BASE__COROUTINE_SUSPENSION_POINT_MAYBE_SUSPEND(2);
+      }
+    label_1_break:;
+      self->private_impl.f_out_ri = 0;
+      self->private_impl.f_out_wi = 0;
+      if (v_done) {
+        goto label_0_break;
+      }
+      if (self->private_impl.f_window_pos >= 65274) {
+        wuffs_deflate__encoder__slide_window(self);
+      }
+    }
+  label_0_break:;
+    self->private_impl.f_window_pos = 0;
+    self->private_impl.f_window_wi = 0;
+    self->private_impl.f_block_start = 0;
+    wuffs_deflate__encoder__clear_hash_chains(self);
+
+    goto ok;
+  ok:
+    self->private_impl.c_encode[0].coro_susp_point = 0;
+    goto exit;
+  }
+
+  goto suspend;
+suspend:
+  self->private_impl.c_encode[0].coro_susp_point = coro_susp_point;
+  self->private_impl.c_encode[0].v_level = v_level;
+  self->private_impl.c_encode[0].v_n = v_n;
+  self->private_impl.c_encode[0].v_m = v_m;
+  self->private_impl.c_encode[0].v_eof = v_eof;
+  self->private_impl.c_encode[0].v_done = v_done;
+
+  goto exit;
+exit:
+  if (a_dst.private_impl.buf) {
+    a_dst.private_impl.buf->meta.wi =
+        iop_a_dst - a_dst.private_impl.buf->data.ptr;
+  }
+  if (a_src.private_impl.buf) {
+    a_src.private_impl.buf->meta.ri =
+        iop_a_src - a_src.private_impl.buf->data.ptr;
+  }
+
+  if (wuffs_base__status__is_error(status)) {
+    self->private_impl.magic = WUFFS_BASE__DISABLED;
+  }
+  return status;
+}
+
+// -------- func deflate.encoder.clear_hash_chains
+
+static void  //
+wuffs_deflate__encoder__clear_hash_chains(wuffs_deflate__encoder* self) {
+  uint32_t v_i;
+
+  v_i = 0;
+  while (v_i < 32768) {
+    self->private_impl.f_hash_heads[v_i] = 0;
+    self->private_impl.f_hash_prevs[v_i] = 0;
+    v_i += 1;
+  }
+}
+
+// -------- func deflate.encoder.slide_window
+
+static void  //
+wuffs_deflate__encoder__slide_window(wuffs_deflate__encoder* self) {
+  uint32_t v_i;
+
+  wuffs_base__slice_u8__copy_from_slice(
+      wuffs_base__slice_u8__subslice_j(((wuffs_base__slice_u8){
+                                           .ptr = self->private_impl.f_window,
+                                           .len = 65536,
+                                       }),
+                                       32768),
+      wuffs_base__slice_u8__subslice_i(((wuffs_base__slice_u8){
+                                           .ptr = self->private_impl.f_window,
+                                           .len = 65536,
+                                       }),
+                                       32768));
+  self->private_impl.f_window_pos =
+      wuffs_base__u32__sat_sub(self->private_impl.f_window_pos, 32768);
+  self->private_impl.f_window_wi =
+      wuffs_base__u32__sat_sub(self->private_impl.f_window_wi, 32768);
+  self->private_impl.f_block_start = self->private_impl.f_window_pos;
+  v_i = 0;
+  while (v_i < 32768) {
+    self->private_impl.f_hash_heads[v_i] =
+        wuffs_base__u32__sat_sub(self->private_impl.f_hash_heads[v_i], 32768);
+    self->private_impl.f_hash_prevs[v_i] =
+        wuffs_base__u32__sat_sub(self->private_impl.f_hash_prevs[v_i], 32768);
+    v_i += 1;
+  }
+}
+
+// -------- func deflate.encoder.find_literals
+
+static void  //
+wuffs_deflate__encoder__find_literals(wuffs_deflate__encoder* self,
+                                      bool a_eof) {
+  uint32_t v_limit;
+
+  v_limit = self->private_impl.f_window_wi;
+  if (!a_eof) {
+    v_limit = wuffs_base__u32__sat_sub(self->private_impl.f_window_wi, 262);
+  }
+  if (self->private_impl.f_window_pos < v_limit) {
+    self->private_impl.f_window_pos = v_limit;
+  }
+}
+
+// -------- func deflate.encoder.find_matches
+
+static void  //
+wuffs_deflate__encoder__find_matches(wuffs_deflate__encoder* self,
+                                     bool a_eof,
+                                     uint32_t a_level) {
+  uint32_t v_max_chain;
+  uint32_t v_nice;
+  bool v_insert_all;
+  uint32_t v_pos;
+  uint32_t v_end;
+  uint32_t v_limit;
+  uint32_t v_n_symbols;
+  uint32_t v_h;
+  uint32_t v_cand;
+  uint32_t v_c;
+  uint32_t v_chain;
+  uint32_t v_max_len;
+  uint32_t v_len;
+  uint32_t v_best_len;
+  uint32_t v_best_dist;
+  uint32_t v_p;
+  uint32_t v_avail;
+  uint32_t v_here;
+
+  v_max_chain = wuffs_deflate__level_chain_lengths[a_level];
+  v_nice = wuffs_deflate__level_nice_lengths[a_level];
+  v_insert_all = (a_level > 3);
+  v_pos = self->private_impl.f_window_pos;
+  v_end = self->private_impl.f_window_wi;
+  v_limit = v_end;
+  v_n_symbols = self->private_impl.f_n_symbols;
+  v_h = 0;
+  v_cand = 0;
+  v_c = 0;
+  v_chain = 0;
+  v_max_len = 0;
+  v_len = 0;
+  v_best_len = 0;
+  v_best_dist = 0;
+  v_p = 0;
+  v_avail = 0;
+  v_here = 0;
+  if (!a_eof) {
+    v_limit = wuffs_base__u32__sat_sub(v_end, 262);
+  }
+label_0_continue:;
+  while ((v_pos < v_limit) && (v_n_symbols < 16384)) {
+    v_here = v_pos;
+    v_avail = wuffs_base__u32__sat_sub(v_end, v_pos);
+    if (v_avail < 4) {
+      self->private_impl.f_symbols[v_n_symbols] =
+          ((uint32_t)(self->private_impl.f_window[v_pos]));
+      v_n_symbols += 1;
+      v_pos += 1;
+      goto label_0_continue;
+    }
+    v_h = wuffs_deflate__encoder__hash(
+        self, wuffs_deflate__encoder__load_u32le(
+                  self, wuffs_base__slice_u8__subslice_i(
+                            ((wuffs_base__slice_u8){
+                                .ptr = self->private_impl.f_window,
+                                .len = 65536,
+                            }),
+                            v_pos)));
+    v_cand = self->private_impl.f_hash_heads[v_h];
+    self->private_impl.f_hash_heads[v_h] = (v_pos + 1);
+    self->private_impl.f_hash_prevs[(v_pos & 32767)] = v_cand;
+    v_max_len = 258;
+    if (v_avail < 258) {
+      v_max_len = v_avail;
+    }
+    v_best_len = 0;
+    v_best_dist = 0;
+    v_chain = v_max_chain;
+    while ((v_cand > 0) && (v_chain > 0)) {
+      v_c = (v_cand - 1);
+      if ((v_c >= v_pos) || (wuffs_base__u32__sat_sub(v_pos, v_c) > 32768)) {
+        goto label_1_break;
+      }
+      v_len =
+          wuffs_deflate__encoder__match_length(self, v_c, v_here, v_max_len);
+      if (v_len > v_best_len) {
+        v_best_len = v_len;
+        v_best_dist = 32768;
+        if (wuffs_base__u32__sat_sub(v_pos, v_c) < 32768) {
+          v_best_dist = wuffs_base__u32__sat_sub(v_pos, v_c);
+        }
+        if (v_len >= v_nice) {
+          goto label_1_break;
+        }
+      }
+      v_cand = self->private_impl.f_hash_prevs[(v_c & 32767)];
+      v_chain -= 1;
+    }
+  label_1_break:;
+    if (v_best_len < 4) {
+      self->private_impl.f_symbols[v_n_symbols] =
+          ((uint32_t)(self->private_impl.f_window[v_pos]));
+      v_n_symbols += 1;
+      v_pos += 1;
+      goto label_0_continue;
+    }
+    self->private_impl.f_symbols[v_n_symbols] =
+        ((v_best_len << 16) | v_best_dist);
+    v_n_symbols += 1;
+    v_p = (v_pos + 1);
+    v_pos = wuffs_base__u32__sat_sub(
+        v_end, wuffs_base__u32__sat_sub(v_avail, v_best_len));
+    if (v_insert_all || (v_best_len <= v_nice)) {
+      while ((v_p < v_pos) && (wuffs_base__u32__sat_sub(v_end, v_p) >= 4)) {
+        v_h = wuffs_deflate__encoder__hash(
+            self, wuffs_deflate__encoder__load_u32le(
+                      self, wuffs_base__slice_u8__subslice_i(
+                                ((wuffs_base__slice_u8){
+                                    .ptr = self->private_impl.f_window,
+                                    .len = 65536,
+                                }),
+                                v_p)));
+        self->private_impl.f_hash_prevs[(v_p & 32767)] =
+            self->private_impl.f_hash_heads[v_h];
+        self->private_impl.f_hash_heads[v_h] = (v_p + 1);
+        v_p += 1;
+      }
+    }
+  }
+  self->private_impl.f_window_pos = v_pos;
+  self->private_impl.f_n_symbols = v_n_symbols;
+}
+
+// -------- func deflate.encoder.hash
+
+static uint32_t  //
+wuffs_deflate__encoder__hash(wuffs_deflate__encoder* self, uint32_t a_x) {
+  return ((uint32_t)((((((uint64_t)(a_x)) * 2654435761) & 4294967295) >> 17)));
+}
+
+// -------- func deflate.encoder.load_u32le
+
+static uint32_t  //
+wuffs_deflate__encoder__load_u32le(wuffs_deflate__encoder* self,
+                                   wuffs_base__slice_u8 a_s) {
+  if (((uint64_t)(a_s.len)) >= 4) {
+    return (((uint32_t)(a_s.ptr[0])) | (((uint32_t)(a_s.ptr[1])) << 8) |
+            (((uint32_t)(a_s.ptr[2])) << 16) |
+            (((uint32_t)(a_s.ptr[3])) << 24));
+  }
+  return 0;
+}
+
+// -------- func deflate.encoder.load_u64le
+
+static uint64_t  //
+wuffs_deflate__encoder__load_u64le(wuffs_deflate__encoder* self,
+                                   wuffs_base__slice_u8 a_s) {
+  if (((uint64_t)(a_s.len)) >= 8) {
+    return (
+        ((uint64_t)(a_s.ptr[0])) | (((uint64_t)(a_s.ptr[1])) << 8) |
+        (((uint64_t)(a_s.ptr[2])) << 16) | (((uint64_t)(a_s.ptr[3])) << 24) |
+        (((uint64_t)(a_s.ptr[4])) << 32) | (((uint64_t)(a_s.ptr[5])) << 40) |
+        (((uint64_t)(a_s.ptr[6])) << 48) | (((uint64_t)(a_s.ptr[7])) << 56));
+  }
+  return 0;
+}
+
+// -------- func deflate.encoder.match_length
+
+static uint32_t  //
+wuffs_deflate__encoder__match_length(wuffs_deflate__encoder* self,
+                                     uint32_t a_a,
+                                     uint32_t a_b,
+                                     uint32_t a_max) {
+  wuffs_base__slice_u8 v_x;
+  wuffs_base__slice_u8 v_y;
+  uint32_t v_n;
+
+  v_x = wuffs_base__slice_u8__subslice_i(((wuffs_base__slice_u8){
+                                             .ptr = self->private_impl.f_window,
+                                             .len = 65536,
+                                         }),
+                                         a_a);
+  v_y = wuffs_base__slice_u8__subslice_i(((wuffs_base__slice_u8){
+                                             .ptr = self->private_impl.f_window,
+                                             .len = 65536,
+                                         }),
+                                         a_b);
+  v_n = 0;
+  while (v_n < 250) {
+    if ((v_n + 8) > a_max) {
+      goto label_0_break;
+    }
+    if ((((uint64_t)(v_x.len)) < 8) || (((uint64_t)(v_y.len)) < 8) ||
+        (wuffs_deflate__encoder__load_u64le(self, v_x) !=
+         wuffs_deflate__encoder__load_u64le(self, v_y))) {
+      goto label_0_break;
+    }
+    v_x = wuffs_base__slice_u8__subslice_i(v_x, 8);
+    v_y = wuffs_base__slice_u8__subslice_i(v_y, 8);
+    v_n += 8;
+  }
+label_0_break:;
+  while (v_n < 258) {
+    if ((v_n >= a_max) || (((uint64_t)(v_x.len)) < 1) ||
+        (((uint64_t)(v_y.len)) < 1)) {
+      goto label_1_break;
+    }
+    if (v_x.ptr[0] != v_y.ptr[0]) {
+      goto label_1_break;
+    }
+    v_x = wuffs_base__slice_u8__subslice_i(v_x, 1);
+    v_y = wuffs_base__slice_u8__subslice_i(v_y, 1);
+    v_n += 1;
+  }
+label_1_break:;
+  if (v_n >= a_max) {
+    return a_max;
+  } else if (v_n < 258) {
+    return v_n;
+  }
+  return 258;
+}
+
+// -------- func deflate.encoder.write_block
+
+static void  //
+wuffs_deflate__encoder__write_block(wuffs_deflate__encoder* self,
+                                    bool a_final,
+                                    bool a_stored_only) {
+  uint32_t v_i;
+  uint32_t v_s;
+  uint32_t v_x;
+  uint32_t v_lc;
+  uint32_t v_dc;
+  uint64_t v_extra;
+  uint32_t v_raw;
+  uint64_t v_dynamic_cost;
+  uint64_t v_fixed_cost;
+  uint64_t v_stored_cost;
+  uint32_t v_final_bit;
+
+  v_i = 0;
+  v_s = 0;
+  v_x = 0;
+  v_lc = 0;
+  v_dc = 0;
+  v_extra = 0;
+  v_raw = wuffs_base__u32__sat_sub(self->private_impl.f_window_pos,
+                                   self->private_impl.f_block_start);
+  v_dynamic_cost = 0;
+  v_fixed_cost = 0;
+  v_stored_cost = 0;
+  v_final_bit = 0;
+  while (v_i < 288) {
+    self->private_impl.f_lcode_counts[v_i] = 0;
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < 32) {
+    self->private_impl.f_dcode_counts[v_i] = 0;
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < self->private_impl.f_n_symbols) {
+    v_s = self->private_impl.f_symbols[v_i];
+    if (v_s < 256) {
+      self->private_impl.f_lcode_counts[v_s] += 1;
+    } else {
+      v_lc =
+          ((uint32_t)(wuffs_deflate__length_codes[(((v_s >> 16) - 3) & 255)]));
+      self->private_impl.f_lcode_counts[(257 + v_lc)] += 1;
+      v_extra += ((uint64_t)((wuffs_deflate__length_bases[v_lc] & 255)));
+      v_x = ((v_s & 65535) - 1);
+      if (v_x < 256) {
+        v_dc = ((uint32_t)(wuffs_deflate__distance_codes[(v_x & 255)]));
+      } else {
+        v_dc = ((uint32_t)(wuffs_deflate__distance_codes[(
+            256 + ((v_x >> 7) & 255))]));
+      }
+      self->private_impl.f_dcode_counts[v_dc] += 1;
+      v_extra += ((uint64_t)((wuffs_deflate__distance_bases[v_dc] & 255)));
+    }
+    v_i += 1;
+  }
+  self->private_impl.f_lcode_counts[256] = 1;
+  v_stored_cost =
+      ((42 * (1 + (((uint64_t)(v_raw)) / 65535))) + (8 * ((uint64_t)(v_raw))));
+  v_fixed_cost =
+      wuffs_base__u64__sat_add(wuffs_base__u64__sat_add(3, v_extra),
+                               wuffs_deflate__encoder__fixed_cost(self));
+  v_dynamic_cost = 18446744073709551615u;
+  if (!a_stored_only) {
+    v_dynamic_cost = wuffs_base__u64__sat_add(
+        wuffs_deflate__encoder__build_dynamic_codes(self), v_extra);
+  }
+  if (a_stored_only ||
+      ((v_stored_cost < v_fixed_cost) && (v_stored_cost < v_dynamic_cost))) {
+    wuffs_deflate__encoder__write_stored_blocks(self, a_final, v_raw);
+  } else {
+    if (a_final) {
+      v_final_bit = 1;
+    }
+    if (v_fixed_cost <= v_dynamic_cost) {
+      wuffs_deflate__encoder__build_fixed_codes(self);
+      wuffs_deflate__encoder__write_bits(self, (2 | v_final_bit), 3);
+    } else {
+      wuffs_deflate__encoder__write_bits(self, (4 | v_final_bit), 3);
+      wuffs_deflate__encoder__write_dynamic_header(self);
+    }
+    wuffs_deflate__encoder__write_symbols(self);
+  }
+  self->private_impl.f_block_start = self->private_impl.f_window_pos;
+  self->private_impl.f_n_symbols = 0;
+}
+
+// -------- func deflate.encoder.fixed_cost
+
+static uint64_t  //
+wuffs_deflate__encoder__fixed_cost(wuffs_deflate__encoder* self) {
+  uint64_t v_cost;
+  uint32_t v_i;
+
+  v_cost = 0;
+  v_i = 0;
+  while (v_i < 288) {
+    if (v_i < 144) {
+      v_cost += (((uint64_t)(self->private_impl.f_lcode_counts[v_i])) * 8);
+    } else if (v_i < 256) {
+      v_cost += (((uint64_t)(self->private_impl.f_lcode_counts[v_i])) * 9);
+    } else if (v_i < 280) {
+      v_cost += (((uint64_t)(self->private_impl.f_lcode_counts[v_i])) * 7);
+    } else {
+      v_cost += (((uint64_t)(self->private_impl.f_lcode_counts[v_i])) * 8);
+    }
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < 32) {
+    v_cost += (((uint64_t)(self->private_impl.f_dcode_counts[v_i])) * 5);
+    v_i += 1;
+  }
+  return v_cost;
+}
+
+// -------- func deflate.encoder.build_fixed_codes
+
+static void  //
+wuffs_deflate__encoder__build_fixed_codes(wuffs_deflate__encoder* self) {
+  uint32_t v_i;
+
+  v_i = 0;
+  while (v_i < 288) {
+    if (v_i < 144) {
+      self->private_impl.f_huff_lengths[v_i] = 8;
+    } else if (v_i < 256) {
+      self->private_impl.f_huff_lengths[v_i] = 9;
+    } else if (v_i < 280) {
+      self->private_impl.f_huff_lengths[v_i] = 7;
+    } else {
+      self->private_impl.f_huff_lengths[v_i] = 8;
+    }
+    v_i += 1;
+  }
+  wuffs_deflate__encoder__assign_codes(self, 288);
+  v_i = 0;
+  while (v_i < 288) {
+    self->private_impl.f_lcode_lengths[v_i] =
+        self->private_impl.f_huff_lengths[v_i];
+    self->private_impl.f_lcode_codes[v_i] =
+        self->private_impl.f_huff_codes[v_i];
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < 32) {
+    self->private_impl.f_huff_lengths[v_i] = 5;
+    v_i += 1;
+  }
+  wuffs_deflate__encoder__assign_codes(self, 32);
+  v_i = 0;
+  while (v_i < 32) {
+    self->private_impl.f_dcode_lengths[v_i] =
+        self->private_impl.f_huff_lengths[v_i];
+    self->private_impl.f_dcode_codes[v_i] =
+        self->private_impl.f_huff_codes[v_i];
+    v_i += 1;
+  }
+}
+
+// -------- func deflate.encoder.build_dynamic_codes
+
+static uint64_t  //
+wuffs_deflate__encoder__build_dynamic_codes(wuffs_deflate__encoder* self) {
+  uint64_t v_cost;
+  uint32_t v_i;
+  uint32_t v_n;
+
+  v_cost = 17;
+  v_i = 0;
+  v_n = 0;
+  v_i = 0;
+  v_n = 0;
+  while (v_i < 512) {
+    self->private_impl.f_huff_counts[v_i] = 0;
+    if (v_i < 286) {
+      self->private_impl.f_huff_counts[v_i] =
+          self->private_impl.f_lcode_counts[v_i];
+      if (self->private_impl.f_lcode_counts[v_i] > 0) {
+        wuffs_base__u32__sat_add_indirect(&v_n, 1);
+      }
+    }
+    v_i += 1;
+  }
+  if (v_n < 2) {
+    self->private_impl.f_huff_counts[0] = 1;
+  }
+  wuffs_deflate__encoder__build_lengths(self, 286, 15);
+  wuffs_deflate__encoder__assign_codes(self, 286);
+  v_i = 0;
+  while (v_i < 288) {
+    self->private_impl.f_lcode_lengths[v_i] =
+        self->private_impl.f_huff_lengths[v_i];
+    self->private_impl.f_lcode_codes[v_i] =
+        self->private_impl.f_huff_codes[v_i];
+    v_cost += (((uint64_t)(self->private_impl.f_lcode_counts[v_i])) *
+               ((uint64_t)(self->private_impl.f_huff_lengths[v_i])));
+    v_i += 1;
+  }
+  self->private_impl.f_hlit = 286;
+  while ((self->private_impl.f_hlit > 257) &&
+         (self->private_impl.f_lcode_lengths[(self->private_impl.f_hlit - 1)] ==
+          0)) {
+    self->private_impl.f_hlit -= 1;
+  }
+  v_i = 0;
+  v_n = 0;
+  while (v_i < 512) {
+    self->private_impl.f_huff_counts[v_i] = 0;
+    if (v_i < 30) {
+      self->private_impl.f_huff_counts[v_i] =
+          self->private_impl.f_dcode_counts[v_i];
+      if (self->private_impl.f_dcode_counts[v_i] > 0) {
+        wuffs_base__u32__sat_add_indirect(&v_n, 1);
+      }
+    }
+    v_i += 1;
+  }
+  if (v_n < 2) {
+    self->private_impl.f_huff_counts[0] = 1;
+    self->private_impl.f_huff_counts[1] = 1;
+  }
+  wuffs_deflate__encoder__build_lengths(self, 30, 15);
+  wuffs_deflate__encoder__assign_codes(self, 30);
+  v_i = 0;
+  while (v_i < 32) {
+    self->private_impl.f_dcode_lengths[v_i] =
+        self->private_impl.f_huff_lengths[v_i];
+    self->private_impl.f_dcode_codes[v_i] =
+        self->private_impl.f_huff_codes[v_i];
+    v_cost += (((uint64_t)(self->private_impl.f_dcode_counts[v_i])) *
+               ((uint64_t)(self->private_impl.f_huff_lengths[v_i])));
+    v_i += 1;
+  }
+  self->private_impl.f_hdist = 30;
+  while (
+      (self->private_impl.f_hdist > 1) &&
+      (self->private_impl.f_dcode_lengths[(self->private_impl.f_hdist - 1)] ==
+       0)) {
+    self->private_impl.f_hdist -= 1;
+  }
+  wuffs_deflate__encoder__run_length_encode(self);
+  v_i = 0;
+  v_n = 0;
+  while (v_i < 512) {
+    self->private_impl.f_huff_counts[v_i] = 0;
+    if (v_i < 19) {
+      self->private_impl.f_huff_counts[v_i] =
+          self->private_impl.f_clcode_counts[v_i];
+      if (self->private_impl.f_clcode_counts[v_i] > 0) {
+        wuffs_base__u32__sat_add_indirect(&v_n, 1);
+      }
+    }
+    v_i += 1;
+  }
+  if (v_n < 2) {
+    self->private_impl.f_huff_counts[0] =
+        (self->private_impl.f_huff_counts[0] | 1);
+    self->private_impl.f_huff_counts[1] =
+        (self->private_impl.f_huff_counts[1] | 1);
+  }
+  wuffs_deflate__encoder__build_lengths(self, 19, 7);
+  wuffs_deflate__encoder__assign_codes(self, 19);
+  v_i = 0;
+  while (v_i < 19) {
+    self->private_impl.f_clcode_lengths[v_i] =
+        self->private_impl.f_huff_lengths[v_i];
+    self->private_impl.f_clcode_codes[v_i] =
+        self->private_impl.f_huff_codes[v_i];
+    v_cost += (((uint64_t)(self->private_impl.f_clcode_counts[v_i])) *
+               ((uint64_t)(self->private_impl.f_huff_lengths[v_i])));
+    v_i += 1;
+  }
+  v_cost += ((((uint64_t)(self->private_impl.f_clcode_counts[16])) * 2) +
+             (((uint64_t)(self->private_impl.f_clcode_counts[17])) * 3) +
+             (((uint64_t)(self->private_impl.f_clcode_counts[18])) * 7));
+  self->private_impl.f_hclen = 19;
+  while ((self->private_impl.f_hclen > 4) &&
+         (self->private_impl.f_clcode_lengths[wuffs_deflate__code_order[(
+              self->private_impl.f_hclen - 1)]] == 0)) {
+    self->private_impl.f_hclen -= 1;
+  }
+  v_cost += (3 * ((uint64_t)(self->private_impl.f_hclen)));
+  return v_cost;
+}
+
+// -------- func deflate.encoder.run_length_encode
+
+static void  //
+wuffs_deflate__encoder__run_length_encode(wuffs_deflate__encoder* self) {
+  uint32_t v_total;
+  uint32_t v_i;
+  uint32_t v_j;
+  uint32_t v_v;
+  uint32_t v_run;
+  uint32_t v_r;
+
+  v_total = (self->private_impl.f_hlit + self->private_impl.f_hdist);
+  v_i = 0;
+  v_j = 0;
+  v_v = 0;
+  v_run = 0;
+  v_r = 0;
+  while (v_i < 19) {
+    self->private_impl.f_clcode_counts[v_i] = 0;
+    v_i += 1;
+  }
+  v_i = 0;
+  self->private_impl.f_n_cl_symbols = 0;
+  while (v_i < v_total) {
+    v_v = wuffs_deflate__encoder__code_length_at(self, v_i);
+    v_j = (v_i + 1);
+    while (v_j < v_total) {
+      if (wuffs_deflate__encoder__code_length_at(self, v_j) != v_v) {
+        goto label_0_break;
+      }
+      v_j += 1;
+    }
+  label_0_break:;
+    v_run = wuffs_base__u32__sat_sub(v_j, v_i);
+    v_i = v_j;
+    if (v_v == 0) {
+      while (v_run >= 11) {
+        v_r = 138;
+        if (v_run < 138) {
+          v_r = v_run;
+        }
+        wuffs_deflate__encoder__add_cl_symbol(
+            self, 18, (wuffs_base__u32__sat_sub(v_r, 11) & 127));
+        wuffs_base__u32__sat_sub_indirect(&v_run, v_r);
+      }
+      if (v_run >= 3) {
+        wuffs_deflate__encoder__add_cl_symbol(
+            self, 17, (wuffs_base__u32__sat_sub(v_run, 3) & 7));
+        v_run = 0;
+      }
+    } else {
+      wuffs_deflate__encoder__add_cl_symbol(self, v_v, 0);
+      wuffs_base__u32__sat_sub_indirect(&v_run, 1);
+      while (v_run >= 3) {
+        v_r = 6;
+        if (v_run < 6) {
+          v_r = v_run;
+        }
+        wuffs_deflate__encoder__add_cl_symbol(
+            self, 16, (wuffs_base__u32__sat_sub(v_r, 3) & 3));
+        wuffs_base__u32__sat_sub_indirect(&v_run, v_r);
+      }
+    }
+    while (v_run > 0) {
+      wuffs_deflate__encoder__add_cl_symbol(self, v_v, 0);
+      v_run -= 1;
+    }
+  }
+}
+
+// -------- func deflate.encoder.code_length_at
+
+static uint32_t  //
+wuffs_deflate__encoder__code_length_at(wuffs_deflate__encoder* self,
+                                       uint32_t a_i) {
+  uint32_t v_x;
+
+  v_x = 0;
+  if (a_i < self->private_impl.f_hlit) {
+    v_x = ((uint32_t)(self->private_impl
+                          .f_lcode_lengths[wuffs_base__u32__min(a_i, 287)]));
+  } else {
+    v_x = ((uint32_t)(self->private_impl.f_dcode_lengths[(
+        wuffs_base__u32__sat_sub(a_i, self->private_impl.f_hlit) & 31)]));
+  }
+  return wuffs_base__u32__min(v_x, 15);
+}
+
+// -------- func deflate.encoder.add_cl_symbol
+
+static void  //
+wuffs_deflate__encoder__add_cl_symbol(wuffs_deflate__encoder* self,
+                                      uint32_t a_s,
+                                      uint32_t a_extra) {
+  if (self->private_impl.f_n_cl_symbols < 320) {
+    self->private_impl.f_cl_symbols[self->private_impl.f_n_cl_symbols] =
+        ((uint8_t)(a_s));
+    self->private_impl.f_cl_extras[self->private_impl.f_n_cl_symbols] =
+        ((uint8_t)(a_extra));
+    self->private_impl.f_n_cl_symbols += 1;
+    self->private_impl.f_clcode_counts[a_s] += 1;
+  }
+}
+
+// -------- func deflate.encoder.build_lengths
+
+static void  //
+wuffs_deflate__encoder__build_lengths(wuffs_deflate__encoder* self,
+                                      uint32_t a_n,
+                                      uint32_t a_limit) {
+  uint32_t v_i;
+  uint32_t v_k;
+  uint32_t v_bk;
+  uint32_t v_num_used;
+  uint32_t v_shift;
+  uint32_t v_root;
+  uint32_t v_leaf;
+  uint32_t v_next;
+  uint32_t v_avbl;
+  uint32_t v_used;
+  uint32_t v_dpth;
+  uint32_t v_total;
+
+  v_i = 0;
+  v_k = 0;
+  v_bk = 0;
+  v_num_used = 0;
+  v_shift = 0;
+  v_root = 0;
+  v_leaf = 0;
+  v_next = 0;
+  v_avbl = 0;
+  v_used = 0;
+  v_dpth = 0;
+  v_total = 0;
+  while (v_i < a_n) {
+    self->private_impl.f_huff_lengths[v_i] = 0;
+    if ((self->private_impl.f_huff_counts[v_i] > 0) && (v_num_used < 512)) {
+      self->private_impl.f_huff_keys[v_num_used] =
+          wuffs_base__u32__min(self->private_impl.f_huff_counts[v_i], 65535);
+      self->private_impl.f_huff_syms[v_num_used] = v_i;
+      v_num_used += 1;
+    }
+    v_i += 1;
+  }
+  if (v_num_used < 2) {
+    if (v_num_used == 1) {
+      self->private_impl
+          .f_huff_lengths[(self->private_impl.f_huff_syms[0] & 511)] = 1;
+    }
+    return;
+  }
+  while (true) {
+    v_i = 0;
+    while (v_i < 256) {
+      self->private_impl.f_huff_hist[v_i] = 0;
+      v_i += 1;
+    }
+    v_i = 0;
+    while (v_i < v_num_used) {
+      v_bk = ((self->private_impl.f_huff_keys[(v_i & 511)] >> v_shift) & 255);
+      self->private_impl.f_huff_hist[v_bk] += 1;
+      v_i += 1;
+    }
+    v_i = 0;
+    v_total = 0;
+    while (v_i < 256) {
+      v_k = self->private_impl.f_huff_hist[v_i];
+      self->private_impl.f_huff_hist[v_i] = v_total;
+      v_total += v_k;
+      v_i += 1;
+    }
+    v_i = 0;
+    while (v_i < v_num_used) {
+      v_bk = ((self->private_impl.f_huff_keys[(v_i & 511)] >> v_shift) & 255);
+      self->private_impl
+          .f_huff_keys2[(self->private_impl.f_huff_hist[v_bk] & 511)] =
+          self->private_impl.f_huff_keys[(v_i & 511)];
+      self->private_impl
+          .f_huff_syms2[(self->private_impl.f_huff_hist[v_bk] & 511)] =
+          self->private_impl.f_huff_syms[(v_i & 511)];
+      self->private_impl.f_huff_hist[v_bk] += 1;
+      v_i += 1;
+    }
+    v_i = 0;
+    while (v_i < v_num_used) {
+      self->private_impl.f_huff_keys[(v_i & 511)] =
+          self->private_impl.f_huff_keys2[(v_i & 511)];
+      self->private_impl.f_huff_syms[(v_i & 511)] =
+          self->private_impl.f_huff_syms2[(v_i & 511)];
+      v_i += 1;
+    }
+    if (v_shift > 0) {
+      goto label_0_break;
+    }
+    v_shift = 8;
+  }
+label_0_break:;
+  self->private_impl.f_huff_keys[0] += self->private_impl.f_huff_keys[1];
+  v_root = 0;
+  v_leaf = 2;
+  v_next = 1;
+  while (v_next < wuffs_base__u32__sat_sub(v_num_used, 1)) {
+    if ((v_leaf >= v_num_used) ||
+        (self->private_impl.f_huff_keys[(v_root & 511)] <
+         self->private_impl.f_huff_keys[(v_leaf & 511)])) {
+      self->private_impl.f_huff_keys[(v_next & 511)] =
+          self->private_impl.f_huff_keys[(v_root & 511)];
+      self->private_impl.f_huff_keys[(v_root & 511)] = v_next;
+      v_root += 1;
+    } else {
+      self->private_impl.f_huff_keys[(v_next & 511)] =
+          self->private_impl.f_huff_keys[(v_leaf & 511)];
+      v_leaf += 1;
+    }
+    if ((v_leaf >= v_num_used) ||
+        ((v_root < v_next) &&
+         (self->private_impl.f_huff_keys[(v_root & 511)] <
+          self->private_impl.f_huff_keys[(v_leaf & 511)]))) {
+      self->private_impl.f_huff_keys[(v_next & 511)] +=
+          self->private_impl.f_huff_keys[(v_root & 511)];
+      self->private_impl.f_huff_keys[(v_root & 511)] = v_next;
+      v_root += 1;
+    } else {
+      self->private_impl.f_huff_keys[(v_next & 511)] +=
+          self->private_impl.f_huff_keys[(v_leaf & 511)];
+      v_leaf += 1;
+    }
+    v_next += 1;
+  }
+  self->private_impl
+      .f_huff_keys[(wuffs_base__u32__sat_sub(v_num_used, 2) & 511)] = 0;
+  v_next = wuffs_base__u32__sat_sub(v_num_used, 2);
+  while (v_next > 0) {
+    v_next -= 1;
+    self->private_impl.f_huff_keys[(v_next & 511)] =
+        (self->private_impl.f_huff_keys[(
+             self->private_impl.f_huff_keys[(v_next & 511)] & 511)] +
+         1);
+  }
+  v_avbl = 1;
+  v_used = 0;
+  v_dpth = 0;
+  v_root = wuffs_base__u32__sat_sub(v_num_used, 1);
+  v_next = v_num_used;
+  while (v_avbl > 0) {
+    while ((v_root > 0) &&
+           (self->private_impl
+                .f_huff_keys[(wuffs_base__u32__sat_sub(v_root, 1) & 511)] ==
+            v_dpth)) {
+      v_used += 1;
+      v_root -= 1;
+    }
+    while ((v_avbl > v_used) && (v_next > 0)) {
+      self->private_impl
+          .f_huff_keys[(wuffs_base__u32__sat_sub(v_next, 1) & 511)] = v_dpth;
+      v_next -= 1;
+      wuffs_base__u32__sat_sub_indirect(&v_avbl, 1);
+    }
+    v_avbl = (v_used << 1);
+    v_dpth += 1;
+    v_used = 0;
+  }
+  v_i = 0;
+  while (v_i < 64) {
+    self->private_impl.f_huff_num_codes[v_i] = 0;
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < v_num_used) {
+    v_bk = 32;
+    if (self->private_impl.f_huff_keys[v_i] < 32) {
+      v_bk = self->private_impl.f_huff_keys[v_i];
+    }
+    self->private_impl.f_huff_num_codes[(v_bk & 63)] += 1;
+    v_i += 1;
+  }
+  v_i = (a_limit + 1);
+  while (v_i <= 32) {
+    self->private_impl.f_huff_num_codes[a_limit] +=
+        self->private_impl.f_huff_num_codes[v_i];
+    self->private_impl.f_huff_num_codes[v_i] = 0;
+    v_i += 1;
+  }
+  v_total = 0;
+  v_i = a_limit;
+  while (v_i > 0) {
+    v_total += (self->private_impl.f_huff_num_codes[(v_i & 63)]
+                << (wuffs_base__u32__sat_sub(a_limit, v_i) & 31));
+    v_i -= 1;
+  }
+  while (v_total > (((uint32_t)(1)) << a_limit)) {
+    self->private_impl.f_huff_num_codes[a_limit] -= 1;
+    v_i = wuffs_base__u32__sat_sub(a_limit, 1);
+    while (v_i > 0) {
+      if (self->private_impl.f_huff_num_codes[(v_i & 63)] != 0) {
+        self->private_impl.f_huff_num_codes[(v_i & 63)] -= 1;
+        self->private_impl.f_huff_num_codes[((v_i + 1) & 63)] += 2;
+        goto label_1_break;
+      }
+      v_i -= 1;
+    }
+  label_1_break:;
+    v_total -= 1;
+  }
+  v_i = 1;
+  v_k = v_num_used;
+  while (v_i <= a_limit) {
+    v_used = self->private_impl.f_huff_num_codes[v_i];
+    while ((v_used > 0) && (v_k > 0)) {
+      v_k -= 1;
+      self->private_impl
+          .f_huff_lengths[(self->private_impl.f_huff_syms[(v_k & 511)] & 511)] =
+          ((uint8_t)((v_i & 15)));
+      v_used -= 1;
+    }
+    v_i += 1;
+  }
+}
+
+// -------- func deflate.encoder.assign_codes
+
+static void  //
+wuffs_deflate__encoder__assign_codes(wuffs_deflate__encoder* self,
+                                     uint32_t a_n) {
+  uint32_t v_i;
+  uint32_t v_len;
+  uint32_t v_code;
+
+  v_i = 0;
+  v_len = 0;
+  v_code = 0;
+  v_i = 0;
+  while (v_i < 64) {
+    self->private_impl.f_huff_num_codes[v_i] = 0;
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < a_n) {
+    v_len = ((uint32_t)(self->private_impl.f_huff_lengths[v_i]));
+    self->private_impl.f_huff_num_codes[v_len] += 1;
+    v_i += 1;
+  }
+  self->private_impl.f_huff_num_codes[0] = 0;
+  v_i = 0;
+  while (v_i < 15) {
+    v_code = ((v_code + self->private_impl.f_huff_num_codes[v_i]) << 1);
+    self->private_impl.f_huff_num_codes[(17 + v_i)] = v_code;
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < a_n) {
+    v_len = ((uint32_t)(self->private_impl.f_huff_lengths[v_i]));
+    if (v_len > 0) {
+      v_code = self->private_impl.f_huff_num_codes[(16 + v_len)];
+      self->private_impl.f_huff_num_codes[(16 + v_len)] = (v_code + 1);
+      v_code = ((((uint32_t)(wuffs_deflate__reverse8[(v_code & 255)])) << 8) |
+                ((uint32_t)(wuffs_deflate__reverse8[((v_code >> 8) & 255)])));
+      self->private_impl.f_huff_codes[v_i] =
+          ((uint16_t)(((v_code >> (16 - v_len)) & 32767)));
+    } else {
+      self->private_impl.f_huff_codes[v_i] = 0;
+    }
+    v_i += 1;
+  }
+}
+
+// -------- func deflate.encoder.write_dynamic_header
+
+static void  //
+wuffs_deflate__encoder__write_dynamic_header(wuffs_deflate__encoder* self) {
+  uint32_t v_i;
+  uint32_t v_s;
+
+  v_i = 0;
+  v_s = 0;
+  wuffs_deflate__encoder__write_bits(
+      self, wuffs_base__u32__sat_sub(self->private_impl.f_hlit, 257), 5);
+  wuffs_deflate__encoder__write_bits(
+      self, wuffs_base__u32__sat_sub(self->private_impl.f_hdist, 1), 5);
+  wuffs_deflate__encoder__write_bits(
+      self, wuffs_base__u32__sat_sub(self->private_impl.f_hclen, 4), 4);
+  while (v_i < self->private_impl.f_hclen) {
+    wuffs_deflate__encoder__write_bits(
+        self,
+        (((uint32_t)(self->private_impl
+                         .f_clcode_lengths[wuffs_deflate__code_order[v_i]])) &
+         7),
+        3);
+    v_i += 1;
+  }
+  v_i = 0;
+  while (v_i < self->private_impl.f_n_cl_symbols) {
+    v_s = ((uint32_t)(self->private_impl.f_cl_symbols[v_i]));
+    wuffs_deflate__encoder__write_bits(
+        self, ((uint32_t)(self->private_impl.f_clcode_codes[v_s])),
+        ((uint32_t)(self->private_impl.f_clcode_lengths[v_s])));
+    if (v_s == 16) {
+      wuffs_deflate__encoder__write_bits(
+          self, (((uint32_t)(self->private_impl.f_cl_extras[v_i])) & 3), 2);
+    } else if (v_s == 17) {
+      wuffs_deflate__encoder__write_bits(
+          self, (((uint32_t)(self->private_impl.f_cl_extras[v_i])) & 7), 3);
+    } else if (v_s == 18) {
+      wuffs_deflate__encoder__write_bits(
+          self, (((uint32_t)(self->private_impl.f_cl_extras[v_i])) & 127), 7);
+    }
+    v_i += 1;
+  }
+}
+
+// -------- func deflate.encoder.write_symbols
+
+static void  //
+wuffs_deflate__encoder__write_symbols(wuffs_deflate__encoder* self) {
+  uint32_t v_i;
+  uint32_t v_s;
+  uint32_t v_x;
+  uint32_t v_lc;
+  uint32_t v_dc;
+  uint32_t v_b;
+  uint32_t v_len;
+
+  v_i = 0;
+  v_s = 0;
+  v_x = 0;
+  v_lc = 0;
+  v_dc = 0;
+  v_b = 0;
+  v_len = 0;
+  while (v_i < self->private_impl.f_n_symbols) {
+    v_s = self->private_impl.f_symbols[v_i];
+    if (v_s < 256) {
+      wuffs_deflate__encoder__write_bits(
+          self, ((uint32_t)(self->private_impl.f_lcode_codes[v_s])),
+          ((uint32_t)(self->private_impl.f_lcode_lengths[v_s])));
+    } else {
+      v_x = ((v_s >> 16) - 3);
+      v_lc = ((uint32_t)(wuffs_deflate__length_codes[(v_x & 255)]));
+      v_b = wuffs_deflate__length_bases[v_lc];
+      v_len = ((uint32_t)(self->private_impl.f_lcode_lengths[(257 + v_lc)]));
+      wuffs_deflate__encoder__write_bits(
+          self,
+          (((uint32_t)(self->private_impl.f_lcode_codes[(257 + v_lc)])) |
+           (((v_x - (v_b >> 8)) & 31) << v_len)),
+          (v_len + (v_b & 7)));
+      v_x = ((v_s & 65535) - 1);
+      if (v_x < 256) {
+        v_dc = ((uint32_t)(wuffs_deflate__distance_codes[(v_x & 255)]));
+      } else {
+        v_dc = ((uint32_t)(wuffs_deflate__distance_codes[(
+            256 + ((v_x >> 7) & 255))]));
+      }
+      v_b = wuffs_deflate__distance_bases[v_dc];
+      v_len = ((uint32_t)(self->private_impl.f_dcode_lengths[v_dc]));
+      wuffs_deflate__encoder__write_bits(
+          self,
+          (((uint32_t)(self->private_impl.f_dcode_codes[v_dc])) |
+           (((v_x - (v_b >> 8)) & 8191) << v_len)),
+          (v_len + (v_b & 15)));
+    }
+    v_i += 1;
+  }
+  wuffs_deflate__encoder__write_bits(
+      self, ((uint32_t)(self->private_impl.f_lcode_codes[256])),
+      ((uint32_t)(self->private_impl.f_lcode_lengths[256])));
+}
+
+// -------- func deflate.encoder.write_stored_blocks
+
+static void  //
+wuffs_deflate__encoder__write_stored_blocks(wuffs_deflate__encoder* self,
+                                            bool a_final,
+                                            uint32_t a_raw) {
+  uint32_t v_start;
+  uint32_t v_remaining;
+  uint32_t v_n;
+  uint64_t v_copied;
+  uint32_t v_t;
+
+  v_start = self->private_impl.f_block_start;
+  v_remaining = a_raw;
+  v_n = 0;
+  v_copied = 0;
+  v_t = 0;
+  while (true) {
+    v_n = 65535;
+    if (v_remaining < 65535) {
+      v_n = v_remaining;
+    }
+    wuffs_base__u32__sat_sub_indirect(&v_remaining, v_n);
+    wuffs_deflate__encoder__write_stored_block_header(
+        self, (a_final && (v_remaining == 0)), v_n);
+    v_copied = wuffs_base__slice_u8__copy_from_slice(
+        wuffs_base__slice_u8__subslice_i(((wuffs_base__slice_u8){
+                                             .ptr = self->private_impl.f_out,
+                                             .len = 66560,
+                                         }),
+                                         self->private_impl.f_out_wi),
+        wuffs_base__slice_u8__prefix(wuffs_base__slice_u8__subslice_i(
+                                         ((wuffs_base__slice_u8){
+                                             .ptr = self->private_impl.f_window,
+                                             .len = 65536,
+                                         }),
+                                         v_start),
+                                     ((uint64_t)(v_n))));
+    if ((v_copied != ((uint64_t)(v_n))) ||
+        ((((uint64_t)(self->private_impl.f_out_wi)) + ((uint64_t)(v_n))) >
+         66560) ||
+        ((((uint64_t)(v_start)) + ((uint64_t)(v_n))) > 65536)) {
+      self->private_impl.f_out_overflow = true;
+      return;
+    }
+    v_t = (self->private_impl.f_out_wi + v_n);
+    self->private_impl.f_out_wi = wuffs_base__u32__min(v_t, 66560);
+    v_t = (v_start + v_n);
+    v_start = wuffs_base__u32__min(v_t, 65536);
+    if (v_remaining <= 0) {
+      goto label_0_break;
+    }
+  }
+label_0_break:;
+}
+
+// -------- func deflate.encoder.write_stored_block_header
+
+static void  //
+wuffs_deflate__encoder__write_stored_block_header(wuffs_deflate__encoder* self,
+                                                  bool a_final,
+                                                  uint32_t a_length) {
+  if (a_final) {
+    wuffs_deflate__encoder__write_bits(self, 1, 3);
+  } else {
+    wuffs_deflate__encoder__write_bits(self, 0, 3);
+  }
+  wuffs_deflate__encoder__flush_bits(self);
+  wuffs_deflate__encoder__write_bits(
+      self, (a_length | ((65535 ^ a_length) << 16)), 32);
+}
+
+// -------- func deflate.encoder.write_bits
+
+static void  //
+wuffs_deflate__encoder__write_bits(wuffs_deflate__encoder* self,
+                                   uint32_t a_x,
+                                   uint32_t a_n) {
+  uint64_t v_b;
+  uint32_t v_nb;
+
+  v_b = (self->private_impl.f_bits |
+         (((uint64_t)(a_x)) << self->private_impl.f_n_bits));
+  v_nb = (self->private_impl.f_n_bits + a_n);
+  if (v_nb >= 32) {
+    if (self->private_impl.f_out_wi <= 66556) {
+      self->private_impl.f_out[(self->private_impl.f_out_wi + 0)] =
+          ((uint8_t)((v_b & 255)));
+      self->private_impl.f_out[(self->private_impl.f_out_wi + 1)] =
+          ((uint8_t)(((v_b >> 8) & 255)));
+      self->private_impl.f_out[(self->private_impl.f_out_wi + 2)] =
+          ((uint8_t)(((v_b >> 16) & 255)));
+      self->private_impl.f_out[(self->private_impl.f_out_wi + 3)] =
+          ((uint8_t)(((v_b >> 24) & 255)));
+      self->private_impl.f_out_wi += 4;
+    } else {
+      self->private_impl.f_out_overflow = true;
+    }
+    v_b >>= 32;
+    v_nb -= 32;
+  }
+  self->private_impl.f_bits = v_b;
+  self->private_impl.f_n_bits = (v_nb & 31);
+}
+
+// -------- func deflate.encoder.flush_bits
+
+static void  //
+wuffs_deflate__encoder__flush_bits(wuffs_deflate__encoder* self) {
+  while (self->private_impl.f_n_bits > 0) {
+    if (self->private_impl.f_out_wi < 66560) {
+      self->private_impl.f_out[self->private_impl.f_out_wi] =
+          ((uint8_t)((self->private_impl.f_bits & 255)));
+      self->private_impl.f_out_wi += 1;
+    } else {
+      self->private_impl.f_out_overflow = true;
+    }
+    self->private_impl.f_bits >>= 8;
+    self->private_impl.f_n_bits =
+        wuffs_base__u32__sat_sub(self->private_impl.f_n_bits, 8);
+  }
+  self->private_impl.f_bits = 0;
+}
+
+// ---------------- Upcast Implementations
+
+#endif  // !defined(WUFFS_CONFIG__MODULES) ||
+        // defined(WUFFS_CONFIG__MODULE__DEFLATE)
+
+#endif  // WUFFS_IMPLEMENTATION
+
+#endif  // WUFFS_INCLUDE_GUARD__DEFLATE
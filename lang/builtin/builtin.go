@@ -40,6 +40,7 @@ var StatusList = [...]string{
 	"?check_wuffs_version not applicable",
 	"?check_wuffs_version missing",
 	"?disabled by previous error",
+	"?unsupported pixel format",
 }
 
 var StatusMap = map[string]bool{}
@@ -157,6 +158,7 @@ var Funcs = []string{
 	"io_reader.peek_u64le() u64",
 
 	"io_reader.available() u64",
+	"io_reader.is_eof() bool",
 	"io_reader.position() u64",
 	"io_reader.set!(s slice u8, closed bool)",
 	"io_reader.set_limit!(l u64)",
@@ -236,6 +238,12 @@ var Funcs = []string{
 	"status.is_suspension() bool",
 	"status.is_warning() bool",
 
+	// ---- decode_frame_options
+
+	"decode_frame_options.downscale_shift() u32[..3]",
+	"decode_frame_options.report_interlace_passes() bool",
+	"decode_frame_options.report_rows() bool",
+
 	// ---- frame_config
 	// Duration's upper bound is the maximum possible i64 value.
 
@@ -257,6 +265,7 @@ var Funcs = []string{
 	// ---- pixel_buffer
 
 	"pixel_buffer.palette() slice u8",
+	"pixel_buffer.pixel_format() u32",
 	"pixel_buffer.plane(p u32[..3]) table u8",
 }
 
@@ -277,6 +286,41 @@ var SliceFuncs = []string{
 	"T1.length() u64",
 	"T1.prefix(up_to u64) T1",
 	"T1.suffix(up_to u64) T1",
+
+	// The unfilter_etc methods undo, in place, the PNG image format's
+	// per-row filters. The receiver is the current row and prev is the row
+	// above, with an empty prev meaning a row of zeroes. The distance is the
+	// number of bytes per (whole) pixel, from 1 to 8, and zero is a no-op.
+	// For now, these are only implemented for a "slice base.u8" receiver.
+	"T1.unfilter_average!(prev T1, distance u32[..8])",
+	"T1.unfilter_paeth!(prev T1, distance u32[..8])",
+	"T1.unfilter_sub!(distance u32[..8])",
+	"T1.unfilter_up!(prev T1)",
+
+	// The filter_etc methods are the inverse of unfilter_etc. They write the
+	// filtered curr row to the receiver, leaving curr unchanged, and return
+	// the sum of the filtered bytes' absolute values (as signed bytes), for
+	// picking a filter per row. For now, these are only implemented for a
+	// "slice base.u8" receiver.
+	"T1.filter_average!(curr T1, prev T1, distance u32[..8]) u64",
+	"T1.filter_none!(curr T1) u64",
+	"T1.filter_paeth!(curr T1, prev T1, distance u32[..8]) u64",
+	"T1.filter_sub!(curr T1, distance u32[..8]) u64",
+	"T1.filter_up!(curr T1, prev T1) u64",
+
+	// The JPEG image format's methods. idct_8x8 writes the 8×8 block of
+	// samples for the 64 i16le coeffs and u16le quant factors, in natural
+	// order, to the receiver, whose rows are stride bytes apart. convert_ycc
+	// writes a row of YCbCr (or, if cb and cr are empty, gray) samples to the
+	// receiver in the pixfmt pixel format, upsampling the chroma per the
+	// libjpeg "fancy upsampling" mode: 0 means none, 1 means h2v1, 2 and 3
+	// mean h1v2 with cb_far and cr_far being the rows above and below, and 4
+	// means h2v2. idct_8x8_downscaled is like idct_8x8 but writes only a
+	// (8 >> shift) × (8 >> shift) block, as per libjpeg's reduced size IDCTs.
+	// For now, these are only implemented for a "slice base.u8" receiver.
+	"T1.idct_8x8!(stride u64, coeffs T1, quant T1)",
+	"T1.idct_8x8_downscaled!(stride u64, coeffs T1, quant T1, shift u32[..3])",
+	"T1.convert_ycc!(y T1, cb T1, cr T1, cb_far T1, cr_far T1, pixfmt u32, upsample u32[..4])",
 }
 
 var TableFuncs = []string{
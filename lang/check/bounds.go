@@ -1306,8 +1306,8 @@ func (q *checker) bcheckExprBinaryOp1(op t.ID, lhs *a.Expr, lb a.Bounds, rhs *a.
 		}
 		if op == t.IDXBinarySlash {
 			return a.Bounds{
-				big.NewInt(0).Mul(lb[0], rb[1]),
-				big.NewInt(0).Mul(lb[1], rb[0]),
+				big.NewInt(0).Quo(lb[0], rb[1]),
+				big.NewInt(0).Quo(lb[1], rb[0]),
 			}, nil
 		}
 		return a.Bounds{
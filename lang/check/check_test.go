@@ -259,6 +259,47 @@ func TestConstValues(tt *testing.T) {
 	}
 }
 
+func TestDivisionBounds(tt *testing.T) {
+	const filename = "test.wuffs"
+	// args.x is in [40..100], so args.x / 4 is in [10..25] and args.x /
+	// args.y, for args.y in [2..5], is in [8..50]. Each subtraction must not
+	// underflow a base.u32.
+	testCases := map[string]bool{
+		"var v base.u32 = (args.x / 4) - 10":      true,
+		"var v base.u32 = (args.x / 4) - 11":      false,
+		"var v base.u32 = (args.x / 4) - 100":     false,
+		"var v base.u32 = (args.x / args.y) - 8":  true,
+		"var v base.u32 = (args.x / args.y) - 9":  false,
+		"var v base.u32 = (args.x / args.y) - 80": false,
+		"var v base.u32 = 50 - (args.x / args.y)": true,
+		"var v base.u32 = 49 - (args.x / args.y)": false,
+	}
+
+	for s, wantOK := range testCases {
+		tm := &t.Map{}
+		src := "pri func foo(x base.u32[40..100], y base.u32[2..5]) {\n\t" +
+			s + "\n}\n"
+
+		tokens, _, err := t.Tokenize(tm, filename, []byte(src))
+		if err != nil {
+			tt.Errorf("%q: Tokenize: %v", s, err)
+			continue
+		}
+
+		file, err := parse.Parse(tm, filename, tokens, nil)
+		if err != nil {
+			tt.Errorf("%q: Parse: %v", s, err)
+			continue
+		}
+
+		_, err = Check(tm, []*a.File{file}, nil)
+		if gotOK := err == nil; gotOK != wantOK {
+			tt.Errorf("%q: Check: got ok=%t (err=%v), want ok=%t", s, gotOK, err, wantOK)
+			continue
+		}
+	}
+}
+
 func TestBitMask(tt *testing.T) {
 	testCases := [][2]uint64{
 		{0, 0},
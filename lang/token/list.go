@@ -521,6 +521,21 @@ const (
 	IDCopyNFromReader      = ID(0x193)
 	IDCopyNFromSlice       = ID(0x194)
 
+	IDUnfilterAverage = ID(0x1A0)
+	IDUnfilterPaeth   = ID(0x1A1)
+	IDUnfilterSub     = ID(0x1A2)
+	IDUnfilterUp      = ID(0x1A3)
+
+	IDConvertYCC        = ID(0x1A8)
+	IDIDCT8x8           = ID(0x1A9)
+	IDIDCT8x8Downscaled = ID(0x1AA)
+
+	IDFilterAverage = ID(0x1B0)
+	IDFilterNone    = ID(0x1B1)
+	IDFilterPaeth   = ID(0x1B2)
+	IDFilterSub     = ID(0x1B3)
+	IDFilterUp      = ID(0x1B4)
+
 	IDFrameConfig = ID(0x1C0)
 	IDImageConfig = ID(0x1C1)
 	IDPixelBuffer = ID(0x1C2)
@@ -541,9 +556,10 @@ const (
 	IDMax      = ID(0x222)
 	IDMin      = ID(0x223)
 
-	IDIsError      = ID(0x230)
-	IDIsOK         = ID(0x231)
-	IDIsSuspension = ID(0x232)
+	IDIsEOF        = ID(0x230)
+	IDIsError      = ID(0x231)
+	IDIsOK         = ID(0x232)
+	IDIsSuspension = ID(0x233)
 
 	IDAvailable = ID(0x240)
 	IDHeight    = ID(0x241)
@@ -807,6 +823,21 @@ var builtInsByID = [nBuiltInIDs]string{
 	IDCopyNFromReader:      "copy_n_from_reader",
 	IDCopyNFromSlice:       "copy_n_from_slice",
 
+	IDUnfilterAverage: "unfilter_average",
+	IDUnfilterPaeth:   "unfilter_paeth",
+	IDUnfilterSub:     "unfilter_sub",
+	IDUnfilterUp:      "unfilter_up",
+
+	IDConvertYCC:        "convert_ycc",
+	IDIDCT8x8:           "idct_8x8",
+	IDIDCT8x8Downscaled: "idct_8x8_downscaled",
+
+	IDFilterAverage: "filter_average",
+	IDFilterNone:    "filter_none",
+	IDFilterPaeth:   "filter_paeth",
+	IDFilterSub:     "filter_sub",
+	IDFilterUp:      "filter_up",
+
 	IDFrameConfig: "frame_config",
 	IDImageConfig: "image_config",
 	IDPixelBuffer: "pixel_buffer",
@@ -825,6 +856,7 @@ var builtInsByID = [nBuiltInIDs]string{
 	IDMax:      "max",
 	IDMin:      "min",
 
+	IDIsEOF:        "is_eof",
 	IDIsError:      "is_error",
 	IDIsOK:         "is_ok",
 	IDIsSuspension: "is_suspension",
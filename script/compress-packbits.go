@@ -0,0 +1,74 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// +build ignore
+
+package main
+
+// compress-packbits.go applies PackBits compression, as per TIFF (compression
+// type 32773) and Apple's Technical Note TN1023. Runs of 3 or more identical
+// bytes become repeated runs, and everything else becomes literal runs. The
+// output has no header or end marker.
+//
+// Usage: go run compress-packbits.go < pi.txt > pi.txt.packbits
+
+import (
+	"io/ioutil"
+	"os"
+)
+
+func main() {
+	if err := main1(); err != nil {
+		os.Stderr.WriteString(err.Error() + "\n")
+		os.Exit(1)
+	}
+}
+
+func main1() error {
+	src, err := ioutil.ReadAll(os.Stdin)
+	if err != nil {
+		return err
+	}
+	_, err = os.Stdout.Write(packBits(nil, src))
+	return err
+}
+
+func packBits(dst []byte, src []byte) []byte {
+	for len(src) > 0 {
+		// Look for a run of identical bytes.
+		n := 1
+		for (n < len(src)) && (n < 128) && (src[n] == src[0]) {
+			n++
+		}
+		if n >= 3 {
+			dst = append(dst, uint8(257-n), src[0])
+			src = src[n:]
+			continue
+		}
+
+		// Otherwise, emit a literal run, up to the next run of 3 or more
+		// identical bytes.
+		n = 0
+		for (n < len(src)) && (n < 128) {
+			if (n+2 < len(src)) && (src[n] == src[n+1]) && (src[n] == src[n+2]) {
+				break
+			}
+			n++
+		}
+		dst = append(dst, uint8(n-1))
+		dst = append(dst, src[:n]...)
+		src = src[n:]
+	}
+	return dst
+}
@@ -0,0 +1,127 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// +build ignore
+
+package main
+
+// compress-tifflzw.go applies TIFF's LZW-compression: MSB first codes, a
+// literal width of 8 and the "early change" code width increase. Unlike
+// compress-giflzw.go, there is no initial literal width byte.
+//
+// The standard library's compress/lzw package does not implement early change,
+// so this program implements its own encoder. Passing -earlychange=false gives
+// output that compress/lzw's MSB decoder can decode, as per PDF's EarlyChange
+// 0. Such output is conventionally named *.msblzw instead of *.tifflzw.
+//
+// Usage: go run compress-tifflzw.go < pi.txt > pi.txt.tifflzw
+
+import (
+	"bufio"
+	"flag"
+	"io/ioutil"
+	"os"
+)
+
+var earlyChange = flag.Bool("earlychange", true, "whether to increase the code width one code early")
+
+func main() {
+	if err := main1(); err != nil {
+		os.Stderr.WriteString(err.Error() + "\n")
+		os.Exit(1)
+	}
+}
+
+const (
+	clearCode = 256
+	endCode   = 257
+)
+
+type encoder struct {
+	w     *bufio.Writer
+	bits  uint32
+	nBits uint32
+	width uint32
+}
+
+func (e *encoder) emit(code uint32) {
+	e.bits |= code << (32 - e.width - e.nBits)
+	e.nBits += e.width
+	for e.nBits >= 8 {
+		e.w.WriteByte(uint8(e.bits >> 24))
+		e.bits <<= 8
+		e.nBits -= 8
+	}
+}
+
+func main1() error {
+	flag.Parse()
+	src, err := ioutil.ReadAll(os.Stdin)
+	if err != nil {
+		return err
+	}
+	early := uint32(0)
+	if *earlyChange {
+		early = 1
+	}
+
+	e := &encoder{w: bufio.NewWriter(os.Stdout), width: 9}
+	table := map[uint32]uint32{}
+	// saveCode mirrors the std/lzw decoder's save_code variable.
+	saveCode := uint32(endCode)
+
+	e.emit(clearCode)
+	prefix, hasPrefix := uint32(0), false
+	for _, x := range src {
+		c := uint32(x)
+		if !hasPrefix {
+			prefix, hasPrefix = c, true
+			continue
+		}
+		if code, ok := table[prefix<<8|c]; ok {
+			prefix = code
+			continue
+		}
+
+		e.emit(prefix)
+		saveCode++
+		table[prefix<<8|c] = saveCode
+		if (saveCode == (1<<e.width)-early) && (e.width < 12) {
+			e.width++
+		}
+		prefix = c
+
+		// Some TIFF decoders (e.g. libtiff's) do not accept codes 4094 and
+		// 4095 when using early change, so clear the table before then.
+		if saveCode >= 4093 {
+			e.emit(clearCode)
+			e.width = 9
+			table = map[uint32]uint32{}
+			saveCode = endCode
+		}
+	}
+
+	if hasPrefix {
+		e.emit(prefix)
+		saveCode++
+		if (saveCode == (1<<e.width)-early) && (e.width < 12) {
+			e.width++
+		}
+	}
+	e.emit(endCode)
+	if e.nBits > 0 {
+		e.w.WriteByte(uint8(e.bits >> 24))
+	}
+	return e.w.Flush()
+}
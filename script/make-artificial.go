@@ -502,7 +502,8 @@ var gifGlobals struct {
 
 func stateGif(line string) (stateFunc, error) {
 	const (
-		cmdL = "lzw "
+		cmdGC = "graphicControl "
+		cmdL  = "lzw "
 	)
 outer:
 	switch {
@@ -510,6 +511,33 @@ outer:
 		out = append(out, 0x2C)
 		return stateGifFrame, nil
 
+	case strings.HasPrefix(line, cmdGC):
+		// The syntax is "graphicControl disposal [transparentIndex]", where
+		// disposal is one of none, restoreBackground or restorePrevious.
+		s := line[len(cmdGC):]
+		flags := uint8(0)
+		switch {
+		case strings.HasPrefix(s, "none"):
+			flags, s = 0x04, s[len("none"):]
+		case strings.HasPrefix(s, "restoreBackground"):
+			flags, s = 0x08, s[len("restoreBackground"):]
+		case strings.HasPrefix(s, "restorePrevious"):
+			flags, s = 0x0C, s[len("restorePrevious"):]
+		default:
+			break outer
+		}
+		transparentIndex := uint32(0)
+		if s = strings.TrimSpace(s); s != "" {
+			ok := false
+			transparentIndex, _, ok = parseNum(s)
+			if !ok || transparentIndex > 0xFF {
+				break outer
+			}
+			flags |= 0x01
+		}
+		out = append(out, 0x21, 0xF9, 0x04, flags, 0x00, 0x00, uint8(transparentIndex), 0x00)
+		return stateGif, nil
+
 	case line == "header":
 		out = append(out, "GIF89a"...)
 		return stateGif, nil
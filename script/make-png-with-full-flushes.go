@@ -0,0 +1,204 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// +build ignore
+
+package main
+
+// make-png-with-full-flushes.go re-encodes an image as a non-interlaced, 8 bit
+// RGB PNG whose zlib stream is fully flushed after every group of rows: no
+// back-reference crosses a group boundary, and each boundary is marked by an
+// empty, byte-aligned stored block. The first row of each group uses the Sub
+// filter and the other rows use the Paeth filter, so that each group can be
+// decompressed and unfiltered independently of the others, as by
+// example/pngparallel. Any alpha channel is dropped.
+//
+// Usage: go run make-png-with-full-flushes.go -rows=16 foo.png > bar.png
+//
+// The -width and -height flags, if non-zero, tile the source image to make a
+// larger one.
+
+import (
+	"bytes"
+	"compress/flate"
+	"encoding/binary"
+	"flag"
+	"fmt"
+	"hash/adler32"
+	"hash/crc32"
+	"image"
+	_ "image/gif"
+	_ "image/png"
+	"os"
+)
+
+var (
+	rowsFlag   = flag.Int("rows", 16, "number of rows per group")
+	widthFlag  = flag.Int("width", 0, "width of the tiled image, or 0")
+	heightFlag = flag.Int("height", 0, "height of the tiled image, or 0")
+)
+
+func main() {
+	if err := main1(); err != nil {
+		os.Stderr.WriteString(err.Error() + "\n")
+		os.Exit(1)
+	}
+}
+
+func main1() error {
+	flag.Parse()
+	if flag.NArg() != 1 {
+		return fmt.Errorf("usage: make-png-with-full-flushes.go foo.png")
+	}
+	if *rowsFlag < 1 {
+		return fmt.Errorf("the -rows flag value is out of range")
+	}
+
+	f, err := os.Open(flag.Arg(0))
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+	src, _, err := image.Decode(f)
+	if err != nil {
+		return err
+	}
+	b := src.Bounds()
+	width, height := b.Dx(), b.Dy()
+	if *widthFlag > 0 {
+		width = *widthFlag
+	}
+	if *heightFlag > 0 {
+		height = *heightFlag
+	}
+
+	// Each filtered row is a filter type byte followed by 3 bytes per pixel.
+	stride := 1 + 3*width
+	prev := make([]byte, stride)
+	curr := make([]byte, stride)
+	rows := make([]byte, 0, stride*height)
+	for y := 0; y < height; y++ {
+		for x := 0; x < width; x++ {
+			c := src.At(b.Min.X+(x%b.Dx()), b.Min.Y+(y%b.Dy()))
+			cr, cg, cb, _ := c.RGBA()
+			curr[1+3*x+0] = uint8(cr >> 8)
+			curr[1+3*x+1] = uint8(cg >> 8)
+			curr[1+3*x+2] = uint8(cb >> 8)
+		}
+		rows = append(rows, filter(curr, prev, y%*rowsFlag == 0)...)
+		prev, curr = curr, prev
+	}
+
+	// A fresh flate.Writer per group means that no back-reference crosses a
+	// group boundary. Flush (a "sync flush") ends every group but the last with
+	// an empty stored block, so that the concatenation is one valid DEFLATE
+	// stream, equivalent to zlib's Z_FULL_FLUSH.
+	z := &bytes.Buffer{}
+	z.Write([]byte{0x78, 0x9C})
+	groupLen := stride * *rowsFlag
+	for i := 0; i < len(rows); i += groupLen {
+		j := i + groupLen
+		if j > len(rows) {
+			j = len(rows)
+		}
+		w, err := flate.NewWriter(z, flate.DefaultCompression)
+		if err != nil {
+			return err
+		}
+		w.Write(rows[i:j])
+		if j < len(rows) {
+			err = w.Flush()
+		} else {
+			err = w.Close()
+		}
+		if err != nil {
+			return err
+		}
+	}
+	binary.Write(z, binary.BigEndian, adler32.Checksum(rows))
+
+	out := &bytes.Buffer{}
+	out.WriteString("\x89PNG\r\n\x1a\n")
+	ihdr := make([]byte, 13)
+	binary.BigEndian.PutUint32(ihdr[0:], uint32(width))
+	binary.BigEndian.PutUint32(ihdr[4:], uint32(height))
+	ihdr[8] = 8  // Bit depth.
+	ihdr[9] = 2  // Color type: RGB.
+	writeChunk(out, "IHDR", ihdr)
+	// Split the zlib stream into 64 KiB IDAT chunks, as many encoders do, so
+	// that the flush points are not aligned with the chunk boundaries.
+	for zb := z.Bytes(); len(zb) > 0; {
+		n := len(zb)
+		if n > 65536 {
+			n = 65536
+		}
+		writeChunk(out, "IDAT", zb[:n])
+		zb = zb[n:]
+	}
+	writeChunk(out, "IEND", nil)
+	_, err = os.Stdout.Write(out.Bytes())
+	return err
+}
+
+// filter returns curr filtered by the Sub filter (if sub is true) or else by
+// the Paeth filter, against the previous row, prev. The first byte of curr and
+// prev is the filter type byte, and the pixels are 3 bytes each.
+func filter(curr []byte, prev []byte, sub bool) []byte {
+	dst := make([]byte, len(curr))
+	if sub {
+		dst[0] = 1
+	} else {
+		dst[0] = 4
+	}
+	for i := 1; i < len(curr); i++ {
+		a, b, c := uint8(0), prev[i], uint8(0)
+		if i > 3 {
+			a, c = curr[i-3], prev[i-3]
+		}
+		if sub {
+			dst[i] = curr[i] - a
+		} else {
+			dst[i] = curr[i] - paeth(a, b, c)
+		}
+	}
+	return dst
+}
+
+func paeth(a uint8, b uint8, c uint8) uint8 {
+	p := int(a) + int(b) - int(c)
+	pa, pb, pc := abs(p-int(a)), abs(p-int(b)), abs(p-int(c))
+	if (pa <= pb) && (pa <= pc) {
+		return a
+	} else if pb <= pc {
+		return b
+	}
+	return c
+}
+
+func abs(x int) int {
+	if x < 0 {
+		return -x
+	}
+	return x
+}
+
+func writeChunk(out *bytes.Buffer, chunkType string, data []byte) {
+	binary.Write(out, binary.BigEndian, uint32(len(data)))
+	out.WriteString(chunkType)
+	out.Write(data)
+	h := crc32.NewIEEE()
+	h.Write([]byte(chunkType))
+	h.Write(data)
+	binary.Write(out, binary.BigEndian, h.Sum32())
+}
@@ -0,0 +1,397 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// +build ignore
+
+package main
+
+// make-tiff.go re-encodes a GIF or PNG image as a TIFF image whose pixel data
+// is split into strips (or tiles), each compressed independently. Paletted
+// source images stay paletted, gray ones stay gray and everything else
+// becomes 8 bit RGB, or RGBA (with unassociated alpha) if not opaque.
+//
+// Usage: go run make-tiff.go -compression=lzw -rows-per-strip=16 foo.png > bar.tiff
+//
+// The -compression flag value can be none, lzw, deflate or packbits. Passing
+// non-zero -tile-width and -tile-height flags gives tiles instead of strips.
+// The -width and -height flags, if non-zero, tile the source image to make a
+// larger one, as for make-png-with-full-flushes.go.
+
+import (
+	"bytes"
+	"compress/zlib"
+	"encoding/binary"
+	"flag"
+	"fmt"
+	"image"
+	"image/color"
+	_ "image/gif"
+	_ "image/png"
+	"os"
+	"sort"
+)
+
+var (
+	bigEndianFlag    = flag.Bool("big-endian", false, "whether to write \"MM\" (instead of \"II\") byte order")
+	compressionFlag  = flag.String("compression", "lzw", "none, lzw, deflate or packbits")
+	predictorFlag    = flag.Int("predictor", 1, "1 (none) or 2 (horizontal differencing)")
+	rowsPerStripFlag = flag.Int("rows-per-strip", 16, "number of rows per strip")
+	tileWidthFlag    = flag.Int("tile-width", 0, "tile width, or 0 for strips")
+	tileHeightFlag   = flag.Int("tile-height", 0, "tile height, or 0 for strips")
+	widthFlag        = flag.Int("width", 0, "width of the tiled image, or 0")
+	heightFlag       = flag.Int("height", 0, "height of the tiled image, or 0")
+)
+
+var compressionTypes = map[string]uint32{
+	"none":     1,
+	"lzw":      5,
+	"deflate":  8,
+	"packbits": 32773,
+}
+
+func main() {
+	if err := main1(); err != nil {
+		os.Stderr.WriteString(err.Error() + "\n")
+		os.Exit(1)
+	}
+}
+
+func main1() error {
+	flag.Parse()
+	if flag.NArg() != 1 {
+		return fmt.Errorf("usage: make-tiff.go foo.png")
+	}
+	compression, ok := compressionTypes[*compressionFlag]
+	if !ok {
+		return fmt.Errorf("unknown -compression flag value %q", *compressionFlag)
+	}
+	if (*predictorFlag != 1) && (*predictorFlag != 2) {
+		return fmt.Errorf("the -predictor flag value is out of range")
+	}
+	tiled := (*tileWidthFlag > 0) || (*tileHeightFlag > 0)
+	if tiled && ((*tileWidthFlag <= 0) || (*tileHeightFlag <= 0)) {
+		return fmt.Errorf("the -tile-width and -tile-height flags must both be set")
+	}
+	if !tiled && (*rowsPerStripFlag < 1) {
+		return fmt.Errorf("the -rows-per-strip flag value is out of range")
+	}
+
+	f, err := os.Open(flag.Arg(0))
+	if err != nil {
+		return err
+	}
+	defer f.Close()
+	src, _, err := image.Decode(f)
+	if err != nil {
+		return err
+	}
+	b := src.Bounds()
+	width, height := b.Dx(), b.Dy()
+	if *widthFlag > 0 {
+		width = *widthFlag
+	}
+	if *heightFlag > 0 {
+		height = *heightFlag
+	}
+
+	// Convert the source image to rows of samples, 1, 3 or 4 bytes per pixel.
+	photometric, spp := uint32(2), 3
+	var palette color.Palette
+	switch s := src.(type) {
+	case *image.Paletted:
+		photometric, spp, palette = 3, 1, s.Palette
+	case *image.Gray:
+		photometric, spp = 1, 1
+	default:
+		if !isOpaque(src) {
+			spp = 4
+		}
+	}
+	sample := func(x int, y int) []byte {
+		x, y = b.Min.X+(x%b.Dx()), b.Min.Y+(y%b.Dy())
+		switch s := src.(type) {
+		case *image.Paletted:
+			return []byte{s.ColorIndexAt(x, y)}
+		case *image.Gray:
+			return []byte{s.GrayAt(x, y).Y}
+		}
+		c := color.NRGBAModel.Convert(src.At(x, y)).(color.NRGBA)
+		return []byte{c.R, c.G, c.B, c.A}[:spp]
+	}
+
+	// Split the image into chunks (strips or tiles), in row-major order.
+	chunkWidth, chunkHeight := width, *rowsPerStripFlag
+	if tiled {
+		chunkWidth, chunkHeight = *tileWidthFlag, *tileHeightFlag
+	} else if chunkHeight > height {
+		chunkHeight = height
+	}
+	across := (width + chunkWidth - 1) / chunkWidth
+	down := (height + chunkHeight - 1) / chunkHeight
+
+	out := &bytes.Buffer{}
+	var order binary.ByteOrder = binary.LittleEndian
+	if *bigEndianFlag {
+		order = binary.BigEndian
+		out.WriteString("MM\x00\x2A\x00\x00\x00\x00")
+	} else {
+		out.WriteString("II\x2A\x00\x00\x00\x00\x00")
+	}
+
+	offsets := []uint32(nil)
+	byteCounts := []uint32(nil)
+	for cy := 0; cy < down; cy++ {
+		for cx := 0; cx < across; cx++ {
+			// Strips can be shorter at the bottom of the image. Tiles are
+			// always whole, padded with zeroes.
+			h := chunkHeight
+			if !tiled && ((cy+1)*chunkHeight > height) {
+				h = height - (cy * chunkHeight)
+			}
+			raw := make([]byte, 0, chunkWidth*h*spp)
+			for y := cy * chunkHeight; y < (cy*chunkHeight)+h; y++ {
+				row := make([]byte, chunkWidth*spp)
+				for x := 0; x < chunkWidth; x++ {
+					if (cx*chunkWidth+x < width) && (y < height) {
+						copy(row[x*spp:], sample(cx*chunkWidth+x, y))
+					}
+				}
+				if *predictorFlag == 2 {
+					for i := len(row) - 1; i >= spp; i-- {
+						row[i] -= row[i-spp]
+					}
+				}
+				raw = append(raw, row...)
+			}
+			compressed, err := compress(compression, raw)
+			if err != nil {
+				return err
+			}
+			offsets = append(offsets, uint32(out.Len()))
+			byteCounts = append(byteCounts, uint32(len(compressed)))
+			out.Write(compressed)
+			if (out.Len() & 1) != 0 {
+				out.WriteByte(0)
+			}
+		}
+	}
+
+	bitsPerSample := make([]uint32, spp)
+	for i := range bitsPerSample {
+		bitsPerSample[i] = 8
+	}
+	e := &ifdEncoder{}
+	e.add(256, 4, uint32(width))
+	e.add(257, 4, uint32(height))
+	e.add(258, 3, bitsPerSample...)
+	e.add(259, 3, compression)
+	e.add(262, 3, photometric)
+	e.add(277, 3, uint32(spp))
+	e.add(284, 3, 1)
+	if tiled {
+		e.add(322, 4, uint32(chunkWidth))
+		e.add(323, 4, uint32(chunkHeight))
+		e.add(324, 4, offsets...)
+		e.add(325, 4, byteCounts...)
+	} else {
+		e.add(273, 4, offsets...)
+		e.add(278, 4, uint32(chunkHeight))
+		e.add(279, 4, byteCounts...)
+	}
+	if *predictorFlag != 1 {
+		e.add(317, 3, uint32(*predictorFlag))
+	}
+	if palette != nil {
+		colorMap := make([]uint32, 3*256)
+		for i, c := range palette {
+			r, g, b, _ := c.RGBA()
+			colorMap[i+0*256] = r
+			colorMap[i+1*256] = g
+			colorMap[i+2*256] = b
+		}
+		e.add(320, 3, colorMap...)
+	}
+	if spp == 4 {
+		e.add(338, 3, 2) // Unassociated alpha.
+	}
+
+	order.PutUint32(out.Bytes()[4:], uint32(out.Len()))
+	e.write(out, order)
+	_, err = os.Stdout.Write(out.Bytes())
+	return err
+}
+
+func isOpaque(m image.Image) bool {
+	if o, ok := m.(interface{ Opaque() bool }); ok {
+		return o.Opaque()
+	}
+	return false
+}
+
+func compress(compression uint32, raw []byte) ([]byte, error) {
+	switch compression {
+	case 5:
+		return compressTIFFLZW(raw), nil
+	case 8:
+		buf := &bytes.Buffer{}
+		w := zlib.NewWriter(buf)
+		if _, err := w.Write(raw); err != nil {
+			return nil, err
+		}
+		if err := w.Close(); err != nil {
+			return nil, err
+		}
+		return buf.Bytes(), nil
+	case 32773:
+		return packBits(nil, raw), nil
+	}
+	return raw, nil
+}
+
+type ifdEntry struct {
+	tag    uint16
+	typ    uint16
+	values []uint32
+}
+
+// ifdEncoder writes an IFD (Image File Directory) and, after it, any of its
+// entries' values that do not fit in 4 bytes.
+type ifdEncoder struct {
+	entries []ifdEntry
+}
+
+func (e *ifdEncoder) add(tag uint16, typ uint16, values ...uint32) {
+	e.entries = append(e.entries, ifdEntry{tag, typ, values})
+}
+
+func (e *ifdEncoder) write(out *bytes.Buffer, order binary.ByteOrder) {
+	sort.Slice(e.entries, func(i int, j int) bool {
+		return e.entries[i].tag < e.entries[j].tag
+	})
+	extra := &bytes.Buffer{}
+	extraOffset := out.Len() + 2 + (12 * len(e.entries)) + 4
+	binary.Write(out, order, uint16(len(e.entries)))
+	for _, x := range e.entries {
+		elemSize := 4
+		if x.typ == 3 {
+			elemSize = 2
+		}
+		values := &bytes.Buffer{}
+		for _, v := range x.values {
+			if elemSize == 2 {
+				binary.Write(values, order, uint16(v))
+			} else {
+				binary.Write(values, order, v)
+			}
+		}
+		binary.Write(out, order, x.tag)
+		binary.Write(out, order, x.typ)
+		binary.Write(out, order, uint32(len(x.values)))
+		if values.Len() <= 4 {
+			out.Write(values.Bytes())
+			out.Write(make([]byte, 4-values.Len()))
+		} else {
+			binary.Write(out, order, uint32(extraOffset+extra.Len()))
+			extra.Write(values.Bytes())
+		}
+	}
+	binary.Write(out, order, uint32(0)) // No next IFD.
+	out.Write(extra.Bytes())
+}
+
+// compressTIFFLZW is as per script/compress-tifflzw.go, with early change.
+func compressTIFFLZW(src []byte) []byte {
+	const (
+		clearCode = 256
+		endCode   = 257
+	)
+	out := []byte(nil)
+	bits, nBits, width := uint32(0), uint32(0), uint32(9)
+	emit := func(code uint32) {
+		bits |= code << (32 - width - nBits)
+		nBits += width
+		for nBits >= 8 {
+			out = append(out, uint8(bits>>24))
+			bits <<= 8
+			nBits -= 8
+		}
+	}
+
+	table := map[uint32]uint32{}
+	saveCode := uint32(endCode)
+	emit(clearCode)
+	prefix, hasPrefix := uint32(0), false
+	for _, x := range src {
+		c := uint32(x)
+		if !hasPrefix {
+			prefix, hasPrefix = c, true
+			continue
+		}
+		if code, ok := table[prefix<<8|c]; ok {
+			prefix = code
+			continue
+		}
+		emit(prefix)
+		saveCode++
+		table[prefix<<8|c] = saveCode
+		if (saveCode == (1<<width)-1) && (width < 12) {
+			width++
+		}
+		prefix = c
+		if saveCode >= 4093 {
+			emit(clearCode)
+			width = 9
+			table = map[uint32]uint32{}
+			saveCode = endCode
+		}
+	}
+	if hasPrefix {
+		emit(prefix)
+		saveCode++
+		if (saveCode == (1<<width)-1) && (width < 12) {
+			width++
+		}
+	}
+	emit(endCode)
+	if nBits > 0 {
+		out = append(out, uint8(bits>>24))
+	}
+	return out
+}
+
+// packBits is as per script/compress-packbits.go.
+func packBits(dst []byte, src []byte) []byte {
+	for len(src) > 0 {
+		n := 1
+		for (n < len(src)) && (n < 128) && (src[n] == src[0]) {
+			n++
+		}
+		if n >= 3 {
+			dst = append(dst, uint8(257-n), src[0])
+			src = src[n:]
+			continue
+		}
+		n = 0
+		for (n < len(src)) && (n < 128) {
+			if (n+2 < len(src)) && (src[n] == src[n+1]) && (src[n] == src[n+2]) {
+				break
+			}
+			n++
+		}
+		dst = append(dst, uint8(n-1))
+		dst = append(dst, src[:n]...)
+		src = src[n:]
+	}
+	return dst
+}
@@ -0,0 +1,1749 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test base" or
+"wuffs bench base" commands. It tests the base library's own functionality,
+such as its pixel swizzlers, row filters and resamplers, rather than any one
+std package.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror base.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench".
+*/
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__BASE
+//
+// The GIF decoder is a source of animation frames for the compositor tests,
+// and the PNG decoder is a source of rows for the streaming resampler tests.
+#define WUFFS_CONFIG__MODULE__ADLER32
+#define WUFFS_CONFIG__MODULE__CRC32
+#define WUFFS_CONFIG__MODULE__DEFLATE
+#define WUFFS_CONFIG__MODULE__GIF
+#define WUFFS_CONFIG__MODULE__LZW
+#define WUFFS_CONFIG__MODULE__PNG
+#define WUFFS_CONFIG__MODULE__ZLIB
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../release/c/wuffs-unsupported-snapshot.h"
+#include "testlib/testlib.c"
+
+// ---------------- Pixel Swizzle Tests
+
+typedef uint64_t (*pixel_swizzle_func)(wuffs_base__table_u8 dst,
+                                       wuffs_base__table_u8 src,
+                                       wuffs_base__slice_u8 palette);
+
+// fill_pixel_swizzle_src fills a palette and a src table with pseudo-random
+// data. Every 7th palette entry is transparent.
+void fill_pixel_swizzle_src(wuffs_base__slice_u8 palette,
+                            wuffs_base__table_u8 src) {
+  uint32_t x = 0x12345678;
+  size_t i;
+  for (i = 0; i < palette.len; i++) {
+    x = (x * 1103515245) + 12345;
+    palette.ptr[i] = (uint8_t)(x >> 16);
+  }
+  for (i = 0; i < (palette.len / 4); i += 7) {
+    palette.ptr[(4 * i) + 3] = 0;
+  }
+  for (i = 0; i < (src.height * src.stride); i++) {
+    x = (x * 1103515245) + 12345;
+    src.ptr[i] = (uint8_t)(x >> 16);
+  }
+}
+
+void do_test_wuffs_base_pixel_swizzle(pixel_swizzle_func f,
+                                      uint32_t dst_bytes_per_pixel,
+                                      bool transparent) {
+  const size_t width = 37;
+  const size_t height = 5;
+
+  wuffs_base__slice_u8 palette = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = 1024,
+  });
+  wuffs_base__table_u8 src = ((wuffs_base__table_u8){
+      .ptr = global_src_array,
+      .width = width,
+      .height = height,
+      .stride = width + 13,
+  });
+  fill_pixel_swizzle_src(palette, src);
+
+  // The dst table is wider and taller than src, with a stride that isn't a
+  // multiple of dst_bytes_per_pixel. Only the top-left width × height pixels
+  // should be written to.
+  wuffs_base__table_u8 got = ((wuffs_base__table_u8){
+      .ptr = global_got_array,
+      .width = (width + 3) * dst_bytes_per_pixel,
+      .height = height + 1,
+      .stride = ((width + 4) * dst_bytes_per_pixel) + 3,
+  });
+  wuffs_base__table_u8 want = got;
+  want.ptr = global_want_array;
+  memset(got.ptr, 0x55, got.height * got.stride);
+  memset(want.ptr, 0x55, want.height * want.stride);
+
+  size_t y;
+  for (y = 0; y < height; y++) {
+    size_t x;
+    for (x = 0; x < width; x++) {
+      uint8_t* c = palette.ptr + (4 * src.ptr[(y * src.stride) + x]);
+      uint8_t* d = want.ptr + (y * want.stride) + (x * dst_bytes_per_pixel);
+      if (transparent && !c[3]) {
+        continue;
+      }
+      switch (dst_bytes_per_pixel) {
+        case 2: {
+          uint32_t v = ((c[2] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[0] >> 3);
+          d[0] = (uint8_t)(v >> 0);
+          d[1] = (uint8_t)(v >> 8);
+          break;
+        }
+        case 3:
+          d[0] = c[2];
+          d[1] = c[1];
+          d[2] = c[0];
+          break;
+        case 4:
+          memcpy(d, c, 4);
+          break;
+      }
+    }
+  }
+
+  uint64_t n = f(got, src, palette);
+  if (n != width * height) {
+    FAIL("num pixels: got %" PRIu64 ", want %" PRIu64, n,
+         (uint64_t)(width * height));
+    return;
+  }
+  size_t i;
+  for (i = 0; i < got.height * got.stride; i++) {
+    if (got.ptr[i] != want.ptr[i]) {
+      FAIL("byte %zu (row %zu): got 0x%02X, want 0x%02X", i, i / got.stride,
+           got.ptr[i], want.ptr[i]);
+      return;
+    }
+  }
+
+  // A palette of the wrong length should convert nothing.
+  palette.len = 1023;
+  n = f(got, src, palette);
+  if (n != 0) {
+    FAIL("num pixels with a short palette: got %" PRIu64 ", want 0", n);
+    return;
+  }
+}
+
+void test_wuffs_base_pixel_swizzle_indexed_to_bgr_565() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_bgr_565, 2, false);
+}
+
+void test_wuffs_base_pixel_swizzle_indexed_to_bgr_565_transparent() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_bgr_565__transparent, 2, true);
+}
+
+void test_wuffs_base_pixel_swizzle_indexed_to_bgra() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_pixel_swizzle(wuffs_base__pixel_swizzle__indexed_to_bgra,
+                                   4, false);
+}
+
+void test_wuffs_base_pixel_swizzle_indexed_to_bgra_transparent() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_bgra__transparent, 4, true);
+}
+
+void test_wuffs_base_pixel_swizzle_indexed_to_rgb() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_pixel_swizzle(wuffs_base__pixel_swizzle__indexed_to_rgb, 3,
+                                   false);
+}
+
+void test_wuffs_base_pixel_swizzle_indexed_to_rgb_transparent() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_rgb__transparent, 3, true);
+}
+
+// ---------------- Animation Compositor Tests
+
+// gifplayer_canvas and its functions mimic how example/gifplayer/gifplayer.c
+// composites an animation: it snapshots the whole canvas before every
+// RESTORE_PREVIOUS frame and composites one pixel at a time.
+typedef struct {
+  uint8_t* curr;
+  uint8_t* prev;
+  size_t width;
+  size_t height;
+} gifplayer_canvas;
+
+void gifplayer_compose(gifplayer_canvas* c,
+                       wuffs_base__frame_config* fc,
+                       wuffs_base__pixel_buffer* pb) {
+  if (wuffs_base__frame_config__disposal(fc) ==
+      WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS) {
+    memcpy(c->prev, c->curr, c->width * c->height * 4);
+  }
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(pb);
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(pb, 0);
+  wuffs_base__rect_ie_u32 bounds = wuffs_base__frame_config__bounds(fc);
+  size_t y;
+  for (y = bounds.min_incl_y; y < bounds.max_excl_y; y++) {
+    uint8_t* d = c->curr + (((y * c->width) + bounds.min_incl_x) * 4);
+    uint8_t* s = tab.ptr + (y * tab.stride) + bounds.min_incl_x;
+    size_t x;
+    for (x = bounds.min_incl_x; x < bounds.max_excl_x; x++) {
+      uint8_t* p = palette.ptr + (4 * *s++);
+      if (p[0] | p[1] | p[2] | p[3]) {
+        memcpy(d, p, 4);
+      }
+      d += 4;
+    }
+  }
+}
+
+void gifplayer_dispose(gifplayer_canvas* c, wuffs_base__frame_config* fc) {
+  wuffs_base__rect_ie_u32 bounds = wuffs_base__frame_config__bounds(fc);
+  switch (wuffs_base__frame_config__disposal(fc)) {
+    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_BACKGROUND: {
+      size_t y;
+      for (y = bounds.min_incl_y; y < bounds.max_excl_y; y++) {
+        memset(c->curr + (((y * c->width) + bounds.min_incl_x) * 4), 0,
+               wuffs_base__rect_ie_u32__width(&bounds) * 4);
+      }
+      break;
+    }
+    case WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_PREVIOUS: {
+      uint8_t* swap = c->curr;
+      c->curr = c->prev;
+      c->prev = swap;
+      break;
+    }
+  }
+}
+
+bool do_test_wuffs_base_animation_compositor(const char* filename,
+                                             const char* want_final_canvas) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    FAIL("decode_image_config: \"%s\"", z);
+    return false;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  size_t canvas_len = ((size_t)width) * ((size_t)height) * 4;
+  if (canvas_len > (BUFFER_SIZE / 3)) {
+    FAIL("canvas is too large");
+    return false;
+  }
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                               global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+  wuffs_base__pixel_buffer canvas = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&canvas, &pc, global_got_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+
+  // The compositor's snapshot is deliberately smaller than the canvas. For
+  // these test images, RESTORE_PREVIOUS frames cover at most half of it.
+  wuffs_base__animation_compositor comp =
+      ((wuffs_base__animation_compositor){});
+  z = wuffs_base__animation_compositor__initialize(
+      &comp, &canvas,
+      ((wuffs_base__slice_u8){
+          .ptr = global_work_array + (BUFFER_SIZE / 2),
+          .len = canvas_len / 2,
+      }));
+  if (z) {
+    FAIL("initialize: \"%s\"", z);
+    return false;
+  }
+
+  // The want canvas, its gifplayer snapshot and a copy of the previous frame's
+  // canvas, to check that pixels outside the dirty rectangle are unchanged.
+  gifplayer_canvas want = ((gifplayer_canvas){
+      .curr = global_want_array,
+      .prev = global_want_array + (BUFFER_SIZE / 3),
+      .width = width,
+      .height = height,
+  });
+  uint8_t* prev_got = global_want_array + (2 * (BUFFER_SIZE / 3));
+  memset(want.curr, 0, canvas_len);
+  memset(prev_got, 0, canvas_len);
+
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+
+  uint32_t i;
+  for (i = 0;; i++) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+    if (z == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (z) {
+      FAIL("decode_frame_config #%" PRIu32 ": \"%s\"", i, z);
+      return false;
+    }
+    z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+    if (z) {
+      FAIL("decode_frame #%" PRIu32 ": \"%s\"", i, z);
+      return false;
+    }
+
+    wuffs_base__rect_ie_u32 dirty = ((wuffs_base__rect_ie_u32){});
+    z = wuffs_base__animation_compositor__composite(&comp, &dirty, &fc, &pb);
+    if (z) {
+      FAIL("composite #%" PRIu32 ": \"%s\"", i, z);
+      return false;
+    }
+    gifplayer_compose(&want, &fc, &pb);
+
+    size_t j;
+    for (j = 0; j < canvas_len; j++) {
+      uint32_t x = (j / 4) % width;
+      uint32_t y = (j / 4) / width;
+      if (global_got_array[j] != want.curr[j]) {
+        FAIL("frame #%" PRIu32 ", pixel (%" PRIu32 ", %" PRIu32
+             "): got 0x%02X, want 0x%02X",
+             i, x, y, global_got_array[j], want.curr[j]);
+        return false;
+      }
+      if ((global_got_array[j] != prev_got[j]) &&
+          !wuffs_base__rect_ie_u32__contains(&dirty, x, y)) {
+        FAIL("frame #%" PRIu32 ", pixel (%" PRIu32 ", %" PRIu32
+             "): changed outside of the dirty rectangle",
+             i, x, y);
+        return false;
+      }
+    }
+    memcpy(prev_got, global_got_array, canvas_len);
+    gifplayer_dispose(&want, &fc);
+  }
+
+  if (want_final_canvas &&
+      memcmp(global_got_array, want_final_canvas, canvas_len)) {
+    FAIL("final canvas: got and want differ");
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_base_animation_compositor_animated_red_blue() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_animation_compositor("../data/animated-red-blue.gif",
+                                          NULL);
+}
+
+void test_wuffs_base_animation_compositor_disposal() {
+  CHECK_FOCUS(__func__);
+  // In BGRA order: red, green and transparent black.
+#define R "\x00\x00\xFF\xFF"
+#define G "\x00\xFF\x00\xFF"
+#define T "\x00\x00\x00\x00"
+  do_test_wuffs_base_animation_compositor("../data/artificial/gif-disposal.gif",
+                                          R R T T      //
+                                              R G G T  //
+                                                  R R R R);
+#undef R
+#undef G
+#undef T
+}
+
+void test_wuffs_base_animation_compositor_frame_out_of_canvas() {
+  CHECK_FOCUS(__func__);
+
+  // A 4x4 canvas and a 4x4 source whose every pixel is opaque red.
+  wuffs_base__pixel_config src_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &src_pc, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0, 4, 4);
+  wuffs_base__pixel_buffer src = ((wuffs_base__pixel_buffer){});
+  wuffs_base__status z = wuffs_base__pixel_buffer__set_from_slice(
+      &src, &src_pc, global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+  memset(src.private_impl.planes[0].ptr, 1, 4 * 4);
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(&src);
+  memset(palette.ptr, 0, palette.len);
+  memcpy(palette.ptr + 4, "\x00\x00\xFF\xFF", 4);
+
+  wuffs_base__pixel_config canvas_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &canvas_pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 4, 4);
+  wuffs_base__pixel_buffer canvas = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&canvas, &canvas_pc,
+                                               global_got_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+  wuffs_base__animation_compositor comp =
+      ((wuffs_base__animation_compositor){});
+  z = wuffs_base__animation_compositor__initialize(&comp, &canvas,
+                                                   ((wuffs_base__slice_u8){}));
+  if (z) {
+    FAIL("initialize: \"%s\"", z);
+    return;
+  }
+
+  // The second frame lies wholly outside of the canvas. Compositing it, and
+  // disposing of it by restoring the background, must change nothing.
+  struct {
+    wuffs_base__rect_ie_u32 bounds;
+    wuffs_base__animation_disposal disposal;
+    wuffs_base__rect_ie_u32 want_dirty;
+  } frames[3] = {
+      {make_rect_ie_u32(0, 0, 2, 2), WUFFS_BASE__ANIMATION_DISPOSAL__NONE,
+       make_rect_ie_u32(0, 0, 2, 2)},
+      {make_rect_ie_u32(10, 10, 20, 20),
+       WUFFS_BASE__ANIMATION_DISPOSAL__RESTORE_BACKGROUND,
+       make_rect_ie_u32(0, 0, 0, 0)},
+      {make_rect_ie_u32(3, 3, 4, 4), WUFFS_BASE__ANIMATION_DISPOSAL__NONE,
+       make_rect_ie_u32(3, 3, 4, 4)},
+  };
+  int i;
+  for (i = 0; i < 3; i++) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    wuffs_base__frame_config__update(&fc, frames[i].bounds, 0, i, 0,
+                                     WUFFS_BASE__ANIMATION_BLEND__OPAQUE,
+                                     frames[i].disposal);
+    wuffs_base__rect_ie_u32 dirty = make_rect_ie_u32(9, 9, 9, 9);
+    z = wuffs_base__animation_compositor__composite(&comp, &dirty, &fc, &src);
+    if (z) {
+      FAIL("composite #%d: \"%s\"", i, z);
+      return;
+    }
+    wuffs_base__rect_ie_u32 want = frames[i].want_dirty;
+    if ((dirty.min_incl_x != want.min_incl_x) ||
+        (dirty.min_incl_y != want.min_incl_y) ||
+        (dirty.max_excl_x != want.max_excl_x) ||
+        (dirty.max_excl_y != want.max_excl_y)) {
+      FAIL("frame #%d: dirty: got (%" PRIu32 ", %" PRIu32 ")-(%" PRIu32
+           ", %" PRIu32 "), want (%" PRIu32 ", %" PRIu32 ")-(%" PRIu32
+           ", %" PRIu32 ")",
+           i, dirty.min_incl_x, dirty.min_incl_y, dirty.max_excl_x,
+           dirty.max_excl_y, want.min_incl_x, want.min_incl_y, want.max_excl_x,
+           want.max_excl_y);
+      return;
+    }
+  }
+
+  // In BGRA order: red and transparent black.
+#define R "\x00\x00\xFF\xFF"
+#define T "\x00\x00\x00\x00"
+  const char* want_canvas = R R T T  //
+      R R T T                        //
+          T T T T                    //
+              T T T R;
+#undef R
+#undef T
+  if (memcmp(global_got_array, want_canvas, 4 * 4 * 4)) {
+    FAIL("final canvas: got and want differ");
+    return;
+  }
+}
+
+void test_wuffs_base_animation_compositor_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_animation_compositor("../data/gifplayer-muybridge.gif",
+                                          NULL);
+}
+
+// ---------------- Unfilter Tests
+
+typedef void (*unfilter_func)(wuffs_base__slice_u8 curr,
+                              wuffs_base__slice_u8 prev,
+                              uint32_t distance);
+
+// The unfilter_etc functions adapt the wuffs_base__slice_u8__unfilter_etc
+// functions to the common unfilter_func signature.
+
+void unfilter_average(wuffs_base__slice_u8 curr,
+                      wuffs_base__slice_u8 prev,
+                      uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_average(curr, prev, distance);
+}
+
+void unfilter_average__fallback(wuffs_base__slice_u8 curr,
+                                wuffs_base__slice_u8 prev,
+                                uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_average__fallback(curr, prev, distance);
+}
+
+void unfilter_paeth(wuffs_base__slice_u8 curr,
+                    wuffs_base__slice_u8 prev,
+                    uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_paeth(curr, prev, distance);
+}
+
+void unfilter_paeth__fallback(wuffs_base__slice_u8 curr,
+                              wuffs_base__slice_u8 prev,
+                              uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_paeth__fallback(curr, prev, distance);
+}
+
+void unfilter_sub(wuffs_base__slice_u8 curr,
+                  wuffs_base__slice_u8 prev,
+                  uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_sub(curr, distance);
+}
+
+void unfilter_up(wuffs_base__slice_u8 curr,
+                 wuffs_base__slice_u8 prev,
+                 uint32_t distance) {
+  wuffs_base__slice_u8__unfilter_up(curr, prev);
+}
+
+// fill_unfilter_src fills s with pseudo-random data.
+void fill_unfilter_src(wuffs_base__slice_u8 s, uint32_t seed) {
+  uint32_t x = seed;
+  size_t i;
+  for (i = 0; i < s.len; i++) {
+    x = (x * 1103515245) + 12345;
+    s.ptr[i] = (uint8_t)(x >> 16);
+  }
+}
+
+// do_test_wuffs_base_unfilter checks that f, which may use SIMD, matches
+// f_fallback, for every distance and for rows with and without a row above,
+// including rows whose length is not a multiple of the distance.
+void do_test_wuffs_base_unfilter(unfilter_func f, unfilter_func f_fallback) {
+  const size_t lengths[] = {0, 1, 2, 3, 4, 7, 8, 16, 17, 99, 1024};
+  wuffs_base__slice_u8 prev = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+  });
+  wuffs_base__slice_u8 got = ((wuffs_base__slice_u8){
+      .ptr = global_got_array,
+  });
+  wuffs_base__slice_u8 want = ((wuffs_base__slice_u8){
+      .ptr = global_want_array,
+  });
+
+  size_t i;
+  for (i = 0; i < WUFFS_TESTLIB_ARRAY_SIZE(lengths); i++) {
+    uint32_t distance;
+    for (distance = 0; distance <= 8; distance++) {
+      int has_prev;
+      for (has_prev = 0; has_prev < 2; has_prev++) {
+        prev.len = has_prev ? lengths[i] : 0;
+        got.len = lengths[i];
+        want.len = lengths[i];
+        fill_unfilter_src(prev, 0x12345678);
+        fill_unfilter_src(got, 0x9ABCDEF0 ^ distance);
+        fill_unfilter_src(want, 0x9ABCDEF0 ^ distance);
+
+        f(got, prev, distance);
+        f_fallback(want, prev, distance);
+        if (memcmp(got.ptr, want.ptr, want.len)) {
+          FAIL("length=%zu, distance=%" PRIu32 ", has_prev=%d: results differ",
+               lengths[i], distance, has_prev);
+          return;
+        }
+      }
+    }
+  }
+}
+
+void test_wuffs_base_unfilter_average() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_unfilter(unfilter_average, unfilter_average__fallback);
+}
+
+void test_wuffs_base_unfilter_paeth() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_unfilter(unfilter_paeth, unfilter_paeth__fallback);
+}
+
+// ---------------- Filter Tests
+
+typedef uint64_t (*filter_func)(wuffs_base__slice_u8 dst,
+                                wuffs_base__slice_u8 curr,
+                                wuffs_base__slice_u8 prev,
+                                uint32_t distance);
+
+// The filter_etc functions adapt the wuffs_base__slice_u8__filter_etc
+// functions to the common filter_func signature.
+
+uint64_t filter_average(wuffs_base__slice_u8 dst,
+                        wuffs_base__slice_u8 curr,
+                        wuffs_base__slice_u8 prev,
+                        uint32_t distance) {
+  return wuffs_base__slice_u8__filter_average(dst, curr, prev, distance);
+}
+
+uint64_t filter_paeth(wuffs_base__slice_u8 dst,
+                      wuffs_base__slice_u8 curr,
+                      wuffs_base__slice_u8 prev,
+                      uint32_t distance) {
+  return wuffs_base__slice_u8__filter_paeth(dst, curr, prev, distance);
+}
+
+uint64_t filter_sub(wuffs_base__slice_u8 dst,
+                    wuffs_base__slice_u8 curr,
+                    wuffs_base__slice_u8 prev,
+                    uint32_t distance) {
+  return wuffs_base__slice_u8__filter_sub(dst, curr, distance);
+}
+
+uint64_t filter_up(wuffs_base__slice_u8 dst,
+                   wuffs_base__slice_u8 curr,
+                   wuffs_base__slice_u8 prev,
+                   uint32_t distance) {
+  return wuffs_base__slice_u8__filter_up(dst, curr, prev);
+}
+
+// do_test_wuffs_base_filter checks that f, which may use SIMD, is the inverse
+// of uf, and that it returns the filtered bytes' sum of absolute values. Like
+// PNG rows, the rows are at least distance bytes long.
+void do_test_wuffs_base_filter(filter_func f, unfilter_func uf) {
+  const size_t lengths[] = {1, 2, 3, 4, 7, 8, 16, 17, 99, 1024};
+  wuffs_base__slice_u8 prev = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+  });
+  wuffs_base__slice_u8 got = ((wuffs_base__slice_u8){
+      .ptr = global_got_array,
+  });
+  wuffs_base__slice_u8 want = ((wuffs_base__slice_u8){
+      .ptr = global_want_array,
+  });
+
+  size_t i;
+  for (i = 0; i < WUFFS_TESTLIB_ARRAY_SIZE(lengths); i++) {
+    uint32_t distance;
+    for (distance = 1; (distance <= 8) && (distance <= lengths[i]);
+         distance++) {
+      int has_prev;
+      for (has_prev = 0; has_prev < 2; has_prev++) {
+        prev.len = has_prev ? lengths[i] : 0;
+        got.len = lengths[i];
+        want.len = lengths[i];
+        fill_unfilter_src(prev, 0x12345678);
+        fill_unfilter_src(want, 0x9ABCDEF0 ^ distance);
+
+        uint64_t sum = f(got, want, prev, distance);
+        uint64_t want_sum = 0;
+        size_t j;
+        for (j = 0; j < got.len; j++) {
+          int8_t x = (int8_t)(got.ptr[j]);
+          want_sum += (x < 0) ? -x : x;
+        }
+        if (sum != want_sum) {
+          FAIL("length=%zu, distance=%" PRIu32
+               ", has_prev=%d: sum: got %" PRIu64 ", want %" PRIu64,
+               lengths[i], distance, has_prev, sum, want_sum);
+          return;
+        }
+
+        uf(got, prev, distance);
+        if (memcmp(got.ptr, want.ptr, want.len)) {
+          FAIL("length=%zu, distance=%" PRIu32
+               ", has_prev=%d: round trip differs",
+               lengths[i], distance, has_prev);
+          return;
+        }
+      }
+    }
+  }
+}
+
+void test_wuffs_base_filter_average() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_filter(filter_average, unfilter_average__fallback);
+}
+
+void test_wuffs_base_filter_paeth() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_filter(filter_paeth, unfilter_paeth__fallback);
+}
+
+void test_wuffs_base_filter_sub() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_filter(filter_sub, unfilter_sub);
+}
+
+void test_wuffs_base_filter_up() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_base_filter(filter_up, unfilter_up);
+}
+
+// ---------------- Resampler Tests
+
+// do_wuffs_base_resample scales the tightly packed src_width × src_height
+// pixels in src to the dst_width × dst_height pixels in dst, both in the
+// given pixel format.
+const char* do_wuffs_base_resample(wuffs_base__slice_u8 dst,
+                                   uint32_t dst_width,
+                                   uint32_t dst_height,
+                                   wuffs_base__slice_u8 src,
+                                   uint32_t src_width,
+                                   uint32_t src_height,
+                                   wuffs_base__pixel_format pixfmt,
+                                   wuffs_base__resampler_filter filter) {
+  wuffs_base__pixel_config src_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&src_pc, pixfmt, 0, src_width,
+                                       src_height);
+  wuffs_base__pixel_buffer src_pb = ((wuffs_base__pixel_buffer){});
+  wuffs_base__status z =
+      wuffs_base__pixel_buffer__set_from_slice(&src_pb, &src_pc, src);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config dst_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&dst_pc, pixfmt, 0, dst_width,
+                                       dst_height);
+  wuffs_base__pixel_buffer dst_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&dst_pb, &dst_pc, dst);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__resampler__workbuf_len(
+      filter, src_width, src_height, dst_width, dst_height);
+  if ((workbuf_len == 0) || (workbuf_len > BUFFER_SIZE)) {
+    return "resampler: bad work buffer size";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  wuffs_base__resampler r = ((wuffs_base__resampler){});
+  z = wuffs_base__resampler__initialize(&r, filter, src_width, src_height,
+                                        &dst_pb, workbuf);
+  if (z) {
+    return z;
+  }
+  z = wuffs_base__resampler__resample(&r, &src_pb);
+  if (z) {
+    return z;
+  }
+  if (wuffs_base__resampler__num_dst_rows(&r) != dst_height) {
+    return "num_dst_rows: unexpected value";
+  }
+  return NULL;
+}
+
+void test_wuffs_base_resample_box_downscale() {
+  CHECK_FOCUS(__func__);
+
+  // Each 2×2 block of src averages to the corresponding dst pixel. The values
+  // are chosen so that the vertical pass's intermediate results are exact.
+  uint8_t src[4 * 4 * 2] = {
+      0x00, 0x10, 0x20, 0xFF, 0x02, 0x12, 0x22, 0xFF,  //
+      0x80, 0x40, 0x00, 0xFF, 0x90, 0x60, 0x10, 0xFF,  //
+      0x04, 0x14, 0x24, 0xFF, 0x06, 0x16, 0x26, 0xFF,  //
+      0xA0, 0x20, 0x40, 0xFF, 0xB0, 0x00, 0x50, 0xFF,  //
+  };
+  uint8_t want[4 * 2 * 1] = {
+      0x03, 0x13, 0x23, 0xFF, 0x98, 0x30, 0x28, 0xFF,  //
+  };
+  uint8_t got[4 * 2 * 1] = {0};
+
+  const char* z = do_wuffs_base_resample(
+      ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 2, 1,
+      ((wuffs_base__slice_u8){.ptr = src, .len = sizeof src}), 4, 2,
+      WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, WUFFS_BASE__RESAMPLER_FILTER__BOX);
+  if (z) {
+    FAIL("resample: %s", z);
+    return;
+  }
+  size_t i;
+  for (i = 0; i < sizeof want; i++) {
+    if (got[i] != want[i]) {
+      FAIL("i=%zu: got 0x%02X, want 0x%02X", i, got[i], want[i]);
+      return;
+    }
+  }
+}
+
+void test_wuffs_base_resample_constant() {
+  CHECK_FOCUS(__func__);
+
+  // The weights for each destination pixel sum to exactly 1, so a solid
+  // color stays solid, whether scaling down or up.
+  const uint32_t src_width = 97;
+  const uint32_t src_height = 61;
+  size_t n = 4 * src_width * src_height;
+  size_t i;
+  for (i = 0; i < n; i += 4) {
+    global_src_array[i + 0] = 0x35;
+    global_src_array[i + 1] = 0x7A;
+    global_src_array[i + 2] = 0xC4;
+    global_src_array[i + 3] = 0xFF;
+  }
+
+  wuffs_base__resampler_filter filters[3] = {
+      WUFFS_BASE__RESAMPLER_FILTER__BOX,
+      WUFFS_BASE__RESAMPLER_FILTER__BILINEAR,
+      WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3,
+  };
+  uint32_t sizes[2][2] = {{20, 13}, {150, 100}};
+
+  int f;
+  for (f = 0; f < 3; f++) {
+    int s;
+    for (s = 0; s < 2; s++) {
+      uint32_t dst_width = sizes[s][0];
+      uint32_t dst_height = sizes[s][1];
+      memset(global_got_array, 0, 4 * dst_width * dst_height);
+      const char* z = do_wuffs_base_resample(
+          ((wuffs_base__slice_u8){
+              .ptr = global_got_array,
+              .len = 4 * dst_width * dst_height,
+          }),
+          dst_width, dst_height,
+          ((wuffs_base__slice_u8){.ptr = global_src_array, .len = n}),
+          src_width, src_height, WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL,
+          filters[f]);
+      if (z) {
+        FAIL("f=%d, s=%d: resample: %s", f, s, z);
+        return;
+      }
+      for (i = 0; i < 4 * dst_width * dst_height; i++) {
+        if (global_got_array[i] != global_src_array[i & 3]) {
+          FAIL("f=%d, s=%d, i=%zu: got 0x%02X, want 0x%02X", f, s, i,
+               global_got_array[i], global_src_array[i & 3]);
+          return;
+        }
+      }
+    }
+  }
+}
+
+void test_wuffs_base_resample_identity() {
+  CHECK_FOCUS(__func__);
+
+  // Scaling to the same size is a no-op, for every filter. The source image
+  // is opaque, so that converting to and from premultiplied alpha is lossless.
+  const uint32_t width = 301;
+  const uint32_t height = 67;
+  size_t n = 4 * width * height;
+  wuffs_base__slice_u8 src = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+      .len = n,
+  });
+  fill_unfilter_src(src, 0x12345678);
+  size_t i;
+  for (i = 3; i < n; i += 4) {
+    src.ptr[i] = 0xFF;
+  }
+
+  wuffs_base__resampler_filter filters[3] = {
+      WUFFS_BASE__RESAMPLER_FILTER__BOX,
+      WUFFS_BASE__RESAMPLER_FILTER__BILINEAR,
+      WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3,
+  };
+  int f;
+  for (f = 0; f < 3; f++) {
+    memset(global_got_array, 0, n);
+    const char* z = do_wuffs_base_resample(
+        ((wuffs_base__slice_u8){.ptr = global_got_array, .len = n}), width,
+        height, src, width, height, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+        filters[f]);
+    if (z) {
+      FAIL("f=%d: resample: %s", f, z);
+      return;
+    }
+    for (i = 0; i < n; i++) {
+      if (global_got_array[i] != src.ptr[i]) {
+        FAIL("f=%d, i=%zu: got 0x%02X, want 0x%02X", f, i, global_got_array[i],
+             src.ptr[i]);
+        return;
+      }
+    }
+  }
+}
+
+void test_wuffs_base_resample_nonpremul() {
+  CHECK_FOCUS(__func__);
+
+  // Averaging opaque blue and transparent red gives half-transparent blue.
+  // The transparent pixel's red does not bleed into the result.
+  uint8_t src[4 * 2] = {
+      0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00,  //
+  };
+  uint8_t want[4] = {0xFF, 0x00, 0x00, 0x80};
+  uint8_t got[4] = {0};
+
+  const char* z = do_wuffs_base_resample(
+      ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 1, 1,
+      ((wuffs_base__slice_u8){.ptr = src, .len = sizeof src}), 2, 1,
+      WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+      WUFFS_BASE__RESAMPLER_FILTER__BOX);
+  if (z) {
+    FAIL("resample: %s", z);
+    return;
+  }
+  size_t i;
+  for (i = 0; i < sizeof want; i++) {
+    if (got[i] != want[i]) {
+      FAIL("i=%zu: got 0x%02X, want 0x%02X", i, got[i], want[i]);
+      return;
+    }
+  }
+}
+
+void test_wuffs_base_resample_premul_overshoot() {
+  CHECK_FOCUS(__func__);
+
+  // A checkerboard of opaque white and transparent black rings when scaled up
+  // with Lanczos. The premultiplied results must still have each color
+  // channel no greater than the alpha channel.
+  const uint32_t src_width = 16;
+  const uint32_t src_height = 16;
+  uint32_t y;
+  for (y = 0; y < src_height; y++) {
+    uint32_t x;
+    for (x = 0; x < src_width; x++) {
+      uint8_t v = ((x ^ y) & 2) ? 0xFF : 0x00;
+      memset(global_src_array + (4 * ((y * src_width) + x)), v, 4);
+    }
+  }
+
+  const uint32_t dst_width = 40;
+  const uint32_t dst_height = 40;
+  const char* z = do_wuffs_base_resample(
+      ((wuffs_base__slice_u8){
+          .ptr = global_got_array,
+          .len = 4 * dst_width * dst_height,
+      }),
+      dst_width, dst_height,
+      ((wuffs_base__slice_u8){
+          .ptr = global_src_array,
+          .len = 4 * src_width * src_height,
+      }),
+      src_width, src_height, WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL,
+      WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3);
+  if (z) {
+    FAIL("resample: %s", z);
+    return;
+  }
+  size_t i;
+  for (i = 0; i < 4 * dst_width * dst_height; i += 4) {
+    uint8_t a = global_got_array[i + 3];
+    if ((global_got_array[i + 0] > a) || (global_got_array[i + 1] > a) ||
+        (global_got_array[i + 2] > a)) {
+      FAIL("pixel %zu: color exceeds alpha", i / 4);
+      return;
+    }
+  }
+}
+
+// do_wuffs_base_resample_png decodes src's PNG image and scales it to
+// dst_width × dst_height, appending the result to dst. If rows is true, each
+// row is fed to the resampler as soon as it is decoded, via the PNG decoder's
+// report_rows option, and the full size image is never held in memory.
+// Otherwise, the whole image is decoded first and then resampled.
+const char* do_wuffs_base_resample_png(wuffs_base__io_buffer* dst,
+                                       wuffs_base__io_buffer* src,
+                                       uint32_t dst_width,
+                                       uint32_t dst_height,
+                                       wuffs_base__resampler_filter filter,
+                                       bool rows) {
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_png__decoder__decode_image_config(
+      &dec, &ic, wuffs_base__io_buffer__reader(src));
+  if (z) {
+    return z;
+  }
+
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&pc,
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, width, rows ? 1 : height);
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config dst_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&dst_pc,
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, dst_width, dst_height);
+  wuffs_base__pixel_buffer dst_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(
+      &dst_pb, &dst_pc,
+      ((wuffs_base__slice_u8){
+          .ptr = dst->data.ptr + dst->meta.wi,
+          .len = dst->data.len - dst->meta.wi,
+      }));
+  if (z) {
+    return z;
+  }
+
+  // The decoder's and the resampler's work buffers share global_work_array.
+  wuffs_base__range_ii_u64 dec_workbuf_range =
+      wuffs_base__image_config__workbuf_len(&ic);
+  uint64_t dec_workbuf_len =
+      ((rows ? dec_workbuf_range.min_incl : dec_workbuf_range.max_incl) + 15) &
+      ~15;
+  uint64_t res_workbuf_len = wuffs_base__resampler__workbuf_len(
+      filter, width, height, dst_width, dst_height);
+  if ((res_workbuf_len == 0) ||
+      (dec_workbuf_len + res_workbuf_len > BUFFER_SIZE)) {
+    return "work buffer size is too large";
+  }
+  wuffs_base__slice_u8 dec_workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = dec_workbuf_len,
+  });
+  wuffs_base__slice_u8 res_workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array + dec_workbuf_len,
+      .len = res_workbuf_len,
+  });
+
+  wuffs_base__resampler r = ((wuffs_base__resampler){});
+  z = wuffs_base__resampler__initialize(&r, filter, width, height, &dst_pb,
+                                        res_workbuf);
+  if (z) {
+    return z;
+  }
+
+  if (rows) {
+    wuffs_base__decode_frame_options opts =
+        ((wuffs_base__decode_frame_options){});
+    wuffs_base__decode_frame_options__initialize(&opts, 0, false, true);
+    while (true) {
+      z = wuffs_png__decoder__decode_frame(
+          &dec, &pb, wuffs_base__io_buffer__reader(src), dec_workbuf, &opts);
+      if (z && (z != wuffs_png__suspension__end_of_row)) {
+        return z;
+      }
+      wuffs_base__status z2 = wuffs_base__resampler__consume_row(
+          &r, wuffs_base__table_u8__row(wuffs_base__pixel_buffer__plane(&pb, 0),
+                                        0));
+      if (z2) {
+        return z2;
+      }
+      if (!z) {
+        break;
+      }
+    }
+  } else {
+    z = wuffs_png__decoder__decode_frame(
+        &dec, &pb, wuffs_base__io_buffer__reader(src), dec_workbuf, NULL);
+    if (z) {
+      return z;
+    }
+    z = wuffs_base__resampler__resample(&r, &pb);
+    if (z) {
+      return z;
+    }
+  }
+
+  if (wuffs_base__resampler__num_dst_rows(&r) != dst_height) {
+    return "num_dst_rows: unexpected value";
+  }
+  dst->meta.wi += 4 * (size_t)dst_width * (size_t)dst_height;
+  return NULL;
+}
+
+void test_wuffs_base_resample_png_rows_harvesters() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../data/harvesters.png")) {
+    return;
+  }
+
+  // Resampling row by row, as the rows are decoded, matches resampling the
+  // fully decoded image.
+  const uint32_t dst_width = 256;
+  const uint32_t dst_height = 189;
+  wuffs_base__resampler_filter filters[3] = {
+      WUFFS_BASE__RESAMPLER_FILTER__BOX,
+      WUFFS_BASE__RESAMPLER_FILTER__BILINEAR,
+      WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3,
+  };
+  int f;
+  for (f = 0; f < 3; f++) {
+    wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+        .data = global_got_slice,
+    });
+    wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+        .data = global_want_slice,
+    });
+
+    src.meta.ri = 0;
+    const char* z = do_wuffs_base_resample_png(&want, &src, dst_width,
+                                               dst_height, filters[f], false);
+    if (z) {
+      FAIL("f=%d: full: %s", f, z);
+      return;
+    }
+
+    src.meta.ri = 0;
+    z = do_wuffs_base_resample_png(&got, &src, dst_width, dst_height,
+                                   filters[f], true);
+    if (z) {
+      FAIL("f=%d: rows: %s", f, z);
+      return;
+    }
+
+    char prefix[16];
+    snprintf(prefix, sizeof prefix, "f=%d: ", f);
+    if (!io_buffers_equal(prefix, &got, &want)) {
+      return;
+    }
+  }
+}
+
+void test_wuffs_base_resample_workbuf() {
+  CHECK_FOCUS(__func__);
+
+  const uint32_t src_width = 97;
+  const uint32_t src_height = 61;
+  const uint32_t dst_width = 40;
+  const uint32_t dst_height = 25;
+  const wuffs_base__resampler_filter filter =
+      WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3;
+  size_t n = 4 * dst_width * dst_height;
+
+  wuffs_base__pixel_config src_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &src_pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, 0, src_width, src_height);
+  wuffs_base__pixel_buffer src_pb = ((wuffs_base__pixel_buffer){});
+  wuffs_base__slice_u8 src = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+      .len = 4 * src_width * src_height,
+  });
+  fill_unfilter_src(src, 0x12345678);
+  const char* z =
+      wuffs_base__pixel_buffer__set_from_slice(&src_pb, &src_pc, src);
+  if (z) {
+    FAIL("set_from_slice: %s", z);
+    return;
+  }
+
+  z = do_wuffs_base_resample(
+      ((wuffs_base__slice_u8){.ptr = global_want_array, .len = n}), dst_width,
+      dst_height, src, src_width, src_height,
+      WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, filter);
+  if (z) {
+    FAIL("resample: %s", z);
+    return;
+  }
+
+  wuffs_base__pixel_config dst_pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &dst_pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, 0, dst_width, dst_height);
+  wuffs_base__pixel_buffer dst_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(
+      &dst_pb, &dst_pc,
+      ((wuffs_base__slice_u8){.ptr = global_got_array, .len = n}));
+  if (z) {
+    FAIL("set_from_slice: %s", z);
+    return;
+  }
+
+  uint64_t workbuf_len = wuffs_base__resampler__workbuf_len(
+      filter, src_width, src_height, dst_width, dst_height);
+  if ((workbuf_len == 0) || (workbuf_len + 16 > BUFFER_SIZE)) {
+    FAIL("bad work buffer size");
+    return;
+  }
+
+  // The work buffer need not be aligned. Initializing twice with the same
+  // work buffer re-uses its weights, which must give the same results.
+  wuffs_base__resampler r = ((wuffs_base__resampler){});
+  int offset;
+  for (offset = 0; offset < 16; offset++) {
+    wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+        .ptr = global_work_array + offset,
+        .len = workbuf_len,
+    });
+    int j;
+    for (j = 0; j < 2; j++) {
+      memset(global_got_array, 0, n);
+      z = wuffs_base__resampler__initialize(&r, filter, src_width, src_height,
+                                            &dst_pb, workbuf);
+      if (z) {
+        FAIL("offset=%d, j=%d: initialize: %s", offset, j, z);
+        return;
+      }
+      z = wuffs_base__resampler__resample(&r, &src_pb);
+      if (z) {
+        FAIL("offset=%d, j=%d: resample: %s", offset, j, z);
+        return;
+      }
+      size_t i;
+      for (i = 0; i < n; i++) {
+        if (global_got_array[i] != global_want_array[i]) {
+          FAIL("offset=%d, j=%d, i=%zu: got 0x%02X, want 0x%02X", offset, j, i,
+               global_got_array[i], global_want_array[i]);
+          return;
+        }
+      }
+    }
+  }
+}
+
+// ---------------- Pixel Swizzle Benches
+
+// do_bench_wuffs_base_pixel_swizzle converts 1024 pixel wide rows. Its
+// throughput numbers count src bytes (i.e. pixels), not dst bytes, so that
+// they are comparable across dst pixel formats.
+bool do_bench_wuffs_base_pixel_swizzle(pixel_swizzle_func f,
+                                       uint32_t dst_bytes_per_pixel,
+                                       uint64_t iters_unscaled) {
+  const size_t width = 1024;
+  const size_t height = 64;
+
+  wuffs_base__slice_u8 palette = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = 1024,
+  });
+  wuffs_base__table_u8 src = ((wuffs_base__table_u8){
+      .ptr = global_src_array,
+      .width = width,
+      .height = height,
+      .stride = width,
+  });
+  fill_pixel_swizzle_src(palette, src);
+  wuffs_base__table_u8 dst = ((wuffs_base__table_u8){
+      .ptr = global_got_array,
+      .width = width * dst_bytes_per_pixel,
+      .height = height,
+      .stride = width * dst_bytes_per_pixel,
+  });
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    n_bytes += f(dst, src, palette);
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_base_pixel_swizzle_indexed_to_bgr_565() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_bgr_565, 2, 50);
+}
+
+void bench_wuffs_base_pixel_swizzle_indexed_to_bgr_565_transparent() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_bgr_565__transparent, 2, 50);
+}
+
+void bench_wuffs_base_pixel_swizzle_indexed_to_bgra() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_pixel_swizzle(wuffs_base__pixel_swizzle__indexed_to_bgra,
+                                    4, 50);
+}
+
+void bench_wuffs_base_pixel_swizzle_indexed_to_bgra_transparent() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_bgra__transparent, 4, 50);
+}
+
+void bench_wuffs_base_pixel_swizzle_indexed_to_rgb() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_pixel_swizzle(wuffs_base__pixel_swizzle__indexed_to_rgb,
+                                    3, 50);
+}
+
+void bench_wuffs_base_pixel_swizzle_indexed_to_rgb_transparent() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_pixel_swizzle(
+      wuffs_base__pixel_swizzle__indexed_to_rgb__transparent, 3, 50);
+}
+
+// ---------------- Animation Compositor Benches
+
+// do_bench_wuffs_base_playback decodes and composites every frame of an
+// animated GIF and then repaints a screen buffer from the canvas. With the
+// compositor, it repaints only the dirty rectangle. Without, it mimics
+// example/gifplayer/gifplayer.c and repaints the whole canvas. Throughput
+// counts width × height × 4 canvas bytes per frame, for both.
+bool do_bench_wuffs_base_playback(bool use_compositor,
+                                  const char* filename,
+                                  uint64_t iters_unscaled) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  uint8_t* screen = global_pixel_array + (BUFFER_SIZE / 2);
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    src.meta.ri = 0;
+    wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+    wuffs_base__status z = wuffs_gif__decoder__check_wuffs_version(
+        &dec, sizeof dec, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return false;
+    }
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+    wuffs_base__image_config ic = ((wuffs_base__image_config){});
+    z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z) {
+      FAIL("decode_image_config: \"%s\"", z);
+      return false;
+    }
+    uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+    uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+    size_t canvas_len = ((size_t)width) * ((size_t)height) * 4;
+    if (canvas_len > (BUFFER_SIZE / 2)) {
+      FAIL("canvas is too large");
+      return false;
+    }
+
+    wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+    z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                                 ((wuffs_base__slice_u8){
+                                                     .ptr = global_pixel_array,
+                                                     .len = BUFFER_SIZE / 2,
+                                                 }));
+    if (z) {
+      FAIL("set_from_slice: \"%s\"", z);
+      return false;
+    }
+    wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+        .ptr = global_work_array,
+        .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+    });
+
+    wuffs_base__animation_compositor comp =
+        ((wuffs_base__animation_compositor){});
+    gifplayer_canvas gc = ((gifplayer_canvas){
+        .curr = global_want_array,
+        .prev = global_want_array + (BUFFER_SIZE / 2),
+        .width = width,
+        .height = height,
+    });
+    if (use_compositor) {
+      wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+      wuffs_base__pixel_config__initialize(
+          &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+      wuffs_base__pixel_buffer canvas = ((wuffs_base__pixel_buffer){});
+      z = wuffs_base__pixel_buffer__set_from_slice(&canvas, &pc,
+                                                   global_got_slice);
+      if (!z) {
+        z = wuffs_base__animation_compositor__initialize(
+            &comp, &canvas,
+            ((wuffs_base__slice_u8){
+                .ptr = global_work_array + (BUFFER_SIZE / 2),
+                .len = BUFFER_SIZE / 2,
+            }));
+      }
+      if (z) {
+        FAIL("initialize: \"%s\"", z);
+        return false;
+      }
+    } else {
+      memset(gc.curr, 0, canvas_len);
+    }
+
+    while (true) {
+      wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+      z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+      if (z == wuffs_base__warning__end_of_data) {
+        break;
+      } else if (z) {
+        FAIL("decode_frame_config: \"%s\"", z);
+        return false;
+      }
+      z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                           NULL);
+      if (z) {
+        FAIL("decode_frame: \"%s\"", z);
+        return false;
+      }
+
+      if (use_compositor) {
+        wuffs_base__rect_ie_u32 dirty = ((wuffs_base__rect_ie_u32){});
+        z = wuffs_base__animation_compositor__composite(&comp, &dirty, &fc,
+                                                        &pb);
+        if (z) {
+          FAIL("composite: \"%s\"", z);
+          return false;
+        }
+        size_t offset = ((dirty.min_incl_y * width) + dirty.min_incl_x) * 4;
+        size_t n = wuffs_base__rect_ie_u32__width(&dirty) * 4;
+        size_t y;
+        for (y = dirty.min_incl_y; y < dirty.max_excl_y; y++) {
+          memcpy(screen + offset, global_got_array + offset, n);
+          offset += width * 4;
+        }
+      } else {
+        gifplayer_compose(&gc, &fc, &pb);
+        memcpy(screen, gc.curr, canvas_len);
+        gifplayer_dispose(&gc, &fc);
+      }
+      n_bytes += canvas_len;
+    }
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_base_playback_compositor_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_playback(true, "../data/muybridge.gif", 300);
+}
+
+void bench_wuffs_base_playback_compositor_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_playback(true, "../data/gifplayer-muybridge.gif", 3);
+}
+
+void bench_wuffs_base_playback_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_playback(false, "../data/muybridge.gif", 300);
+}
+
+void bench_wuffs_base_playback_gifplayer_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_playback(false, "../data/gifplayer-muybridge.gif", 3);
+}
+
+// ---------------- Unfilter Benches
+
+// do_bench_wuffs_base_unfilter unfilters 64 rows, each 1024 pixels wide.
+bool do_bench_wuffs_base_unfilter(unfilter_func f,
+                                  uint32_t distance,
+                                  uint64_t iters_unscaled) {
+  const size_t width = 1024 * distance;
+  const size_t height = 64;
+
+  wuffs_base__slice_u8 rows = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+      .len = width * height,
+  });
+  fill_unfilter_src(rows, 0x12345678);
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    wuffs_base__slice_u8 prev = ((wuffs_base__slice_u8){});
+    size_t y;
+    for (y = 0; y < height; y++) {
+      wuffs_base__slice_u8 curr = ((wuffs_base__slice_u8){
+          .ptr = rows.ptr + (y * width),
+          .len = width,
+      });
+      f(curr, prev, distance);
+      prev = curr;
+    }
+    n_bytes += width * height;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_base_unfilter_average_3() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_average, 3, 20);
+}
+
+void bench_wuffs_base_unfilter_average_4() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_average, 4, 20);
+}
+
+void bench_wuffs_base_unfilter_average_4_fallback() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_average__fallback, 4, 20);
+}
+
+void bench_wuffs_base_unfilter_paeth_3() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_paeth, 3, 20);
+}
+
+void bench_wuffs_base_unfilter_paeth_4() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_paeth, 4, 20);
+}
+
+void bench_wuffs_base_unfilter_paeth_4_fallback() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_paeth__fallback, 4, 20);
+}
+
+void bench_wuffs_base_unfilter_sub_3() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_sub, 3, 20);
+}
+
+void bench_wuffs_base_unfilter_sub_4() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_sub, 4, 20);
+}
+
+void bench_wuffs_base_unfilter_up_4() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_unfilter(unfilter_up, 4, 20);
+}
+
+// ---------------- Resampler Benches
+
+// do_bench_wuffs_base_resample scales a 3840 × 2160 (4K) image down to
+// 256 × 144, as when thumbnailing.
+bool do_bench_wuffs_base_resample(wuffs_base__resampler_filter filter,
+                                  wuffs_base__pixel_format pixfmt,
+                                  uint64_t iters_unscaled) {
+  const uint32_t src_width = 3840;
+  const uint32_t src_height = 2160;
+  const uint32_t dst_width = 256;
+  const uint32_t dst_height = 144;
+
+  wuffs_base__slice_u8 src = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+      .len = 4 * src_width * src_height,
+  });
+  fill_unfilter_src(src, 0x12345678);
+  wuffs_base__slice_u8 dst = ((wuffs_base__slice_u8){
+      .ptr = global_got_array,
+      .len = 4 * dst_width * dst_height,
+  });
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    const char* z = do_wuffs_base_resample(
+        dst, dst_width, dst_height, src, src_width, src_height, pixfmt, filter);
+    if (z) {
+      FAIL("resample: %s", z);
+      return false;
+    }
+    n_bytes += src.len;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_base_resample_box_4k_to_256() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_resample(WUFFS_BASE__RESAMPLER_FILTER__BOX,
+                               WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, 1);
+}
+
+void bench_wuffs_base_resample_bilinear_4k_to_256() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_resample(WUFFS_BASE__RESAMPLER_FILTER__BILINEAR,
+                               WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, 1);
+}
+
+void bench_wuffs_base_resample_lanczos3_4k_to_256() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_resample(WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3,
+                               WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL, 1);
+}
+
+void bench_wuffs_base_resample_lanczos3_4k_to_256_nonpremul() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_resample(WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3,
+                               WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 1);
+}
+
+// bench_wuffs_base_resample_png_rows_1000k_24bpp makes a 256 pixel wide
+// Lanczos thumbnail of harvesters.png without ever holding the full size
+// image. Like the std/png decode benchmarks, the throughput is measured in
+// decoded (not scaled) pixel bytes.
+void bench_wuffs_base_resample_png_rows_1000k_24bpp() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../data/harvesters.png")) {
+    return;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iterscale;
+  for (i = 0; i < iters; i++) {
+    wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+        .data = global_got_slice,
+    });
+    src.meta.ri = 0;
+    const char* z = do_wuffs_base_resample_png(
+        &got, &src, 256, 189, WUFFS_BASE__RESAMPLER_FILTER__LANCZOS3, true);
+    if (z) {
+      FAIL("resample: %s", z);
+      return;
+    }
+    n_bytes += 4 * 1165 * 859;
+  }
+  bench_finish(iters, n_bytes);
+}
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_base_pixel_swizzle_indexed_to_bgr_565,              //
+    test_wuffs_base_pixel_swizzle_indexed_to_bgr_565_transparent,  //
+    test_wuffs_base_pixel_swizzle_indexed_to_bgra,                 //
+    test_wuffs_base_pixel_swizzle_indexed_to_bgra_transparent,     //
+    test_wuffs_base_pixel_swizzle_indexed_to_rgb,                  //
+    test_wuffs_base_pixel_swizzle_indexed_to_rgb_transparent,      //
+
+    test_wuffs_base_animation_compositor_animated_red_blue,    //
+    test_wuffs_base_animation_compositor_disposal,             //
+    test_wuffs_base_animation_compositor_frame_out_of_canvas,  //
+    test_wuffs_base_animation_compositor_gifplayer_muybridge,  //
+
+    test_wuffs_base_unfilter_average,  //
+    test_wuffs_base_unfilter_paeth,    //
+    test_wuffs_base_filter_average,    //
+    test_wuffs_base_filter_paeth,      //
+    test_wuffs_base_filter_sub,        //
+    test_wuffs_base_filter_up,         //
+
+    test_wuffs_base_resample_box_downscale,        //
+    test_wuffs_base_resample_constant,             //
+    test_wuffs_base_resample_identity,             //
+    test_wuffs_base_resample_nonpremul,            //
+    test_wuffs_base_resample_png_rows_harvesters,  //
+    test_wuffs_base_resample_premul_overshoot,     //
+    test_wuffs_base_resample_workbuf,              //
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_base_pixel_swizzle_indexed_to_bgr_565,              //
+    bench_wuffs_base_pixel_swizzle_indexed_to_bgr_565_transparent,  //
+    bench_wuffs_base_pixel_swizzle_indexed_to_bgra,                 //
+    bench_wuffs_base_pixel_swizzle_indexed_to_bgra_transparent,     //
+    bench_wuffs_base_pixel_swizzle_indexed_to_rgb,                  //
+    bench_wuffs_base_pixel_swizzle_indexed_to_rgb_transparent,      //
+
+    bench_wuffs_base_playback_compositor_muybridge,            //
+    bench_wuffs_base_playback_compositor_gifplayer_muybridge,  //
+    bench_wuffs_base_playback_gifplayer_muybridge,             //
+    bench_wuffs_base_playback_gifplayer_gifplayer_muybridge,   //
+
+    bench_wuffs_base_unfilter_average_3,           //
+    bench_wuffs_base_unfilter_average_4,           //
+    bench_wuffs_base_unfilter_average_4_fallback,  //
+    bench_wuffs_base_unfilter_paeth_3,             //
+    bench_wuffs_base_unfilter_paeth_4,             //
+    bench_wuffs_base_unfilter_paeth_4_fallback,    //
+    bench_wuffs_base_unfilter_sub_3,               //
+    bench_wuffs_base_unfilter_sub_4,               //
+    bench_wuffs_base_unfilter_up_4,                //
+
+    bench_wuffs_base_resample_bilinear_4k_to_256,            //
+    bench_wuffs_base_resample_box_4k_to_256,                 //
+    bench_wuffs_base_resample_lanczos3_4k_to_256,            //
+    bench_wuffs_base_resample_lanczos3_4k_to_256_nonpremul,  //
+    bench_wuffs_base_resample_png_rows_1000k_24bpp,          //
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "base";
+  return test_main(argc, argv, tests, benches);
+}
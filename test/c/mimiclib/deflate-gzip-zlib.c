@@ -74,6 +74,12 @@ const char* mimic_zlib_decode(wuffs_base__io_buffer* dst,
   return mimic_deflate_zlib_decode(dst, src, wlimit, rlimit, false);
 }
 
+const char* mimic_deflate_encode(wuffs_base__io_buffer* dst,
+                                 wuffs_base__io_buffer* src,
+                                 int level) {
+  return "miniz_tinfl.c does not implement deflate encoding";
+}
+
 #else  // WUFFS_MIMICLIB_USE_MINIZ_INSTEAD_OF_ZLIB
 #include "zlib.h"
 
@@ -192,6 +198,41 @@ const char* mimic_deflate_decode(wuffs_base__io_buffer* dst,
                                         zlib_flavor_raw);
 }
 
+const char* mimic_deflate_encode(wuffs_base__io_buffer* dst,
+                                 wuffs_base__io_buffer* src,
+                                 int level) {
+  const char* ret = NULL;
+  z_stream z = {0};
+  // A negative window_bits means raw deflate, without a zlib wrapper.
+  int di2_err = deflateInit2(&z, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+  if (di2_err != Z_OK) {
+    ret = "deflateInit2 failed";
+    goto cleanup0;
+  }
+
+  z.avail_in = src->meta.wi - src->meta.ri;
+  z.next_in = src->data.ptr + src->meta.ri;
+  z.avail_out = dst->data.len - dst->meta.wi;
+  z.next_out = dst->data.ptr + dst->meta.wi;
+
+  int d_err = deflate(&z, Z_FINISH);
+  if (d_err != Z_STREAM_END) {
+    ret = "deflate failed";
+    goto cleanup1;
+  }
+  src->meta.ri = src->meta.wi - z.avail_in;
+  dst->meta.wi = dst->data.len - z.avail_out;
+
+cleanup1:;
+  int de_err = deflateEnd(&z);
+  if ((de_err != Z_OK) && !ret) {
+    ret = "deflateEnd failed";
+  }
+
+cleanup0:;
+  return ret;
+}
+
 const char* mimic_gzip_decode(wuffs_base__io_buffer* dst,
                               wuffs_base__io_buffer* src,
                               uint64_t wlimit,
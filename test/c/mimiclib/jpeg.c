@@ -0,0 +1,78 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <setjmp.h>
+
+#include "jpeglib.h"
+
+struct mimic_jpeg_error_mgr {
+  struct jpeg_error_mgr pub;
+  jmp_buf jmpbuf;
+};
+
+void mimic_jpeg_error_exit(j_common_ptr cinfo) {
+  longjmp(((struct mimic_jpeg_error_mgr*)(cinfo->err))->jmpbuf, 1);
+}
+
+// mimic_jpeg_decode_downscaled decodes src's image to dst, as BGRA_NONPREMUL
+// pixels, at 1/(1 << downscale_shift) scale. It uses libjpeg-turbo's
+// JCS_EXT_BGRA output color space, with the default (integer, "islow") IDCT
+// and "fancy" chroma upsampling. Downscaling uses libjpeg's scale_denom.
+const char* mimic_jpeg_decode_downscaled(wuffs_base__io_buffer* dst,
+                                         wuffs_base__io_buffer* src,
+                                         uint32_t downscale_shift) {
+  const char* ret = NULL;
+
+  struct jpeg_decompress_struct cinfo;
+  struct mimic_jpeg_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = mimic_jpeg_error_exit;
+  jpeg_create_decompress(&cinfo);
+  if (setjmp(jerr.jmpbuf)) {
+    ret = "libjpeg failed";
+    goto cleanup0;
+  }
+  jpeg_mem_src(&cinfo, src->data.ptr + src->meta.ri,
+               src->meta.wi - src->meta.ri);
+  jpeg_read_header(&cinfo, TRUE);
+  cinfo.out_color_space = JCS_EXT_BGRA;
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = 1 << downscale_shift;
+  jpeg_start_decompress(&cinfo);
+
+  size_t stride = 4 * ((size_t)cinfo.output_width);
+  size_t height = cinfo.output_height;
+  size_t num_dst = dst->data.len - dst->meta.wi;
+  if ((num_dst / stride) < height) {
+    ret = "JPEG image's pixel data won't fit in the dst buffer";
+    goto cleanup0;
+  }
+  while (cinfo.output_scanline < cinfo.output_height) {
+    JSAMPROW row =
+        dst->data.ptr + dst->meta.wi + (cinfo.output_scanline * stride);
+    jpeg_read_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_decompress(&cinfo);
+  dst->meta.wi += height * stride;
+  src->meta.ri = src->meta.wi;
+
+cleanup0:
+  jpeg_destroy_decompress(&cinfo);
+  return ret;
+}
+
+const char* mimic_jpeg_decode(wuffs_base__io_buffer* dst,
+                              wuffs_base__io_buffer* src) {
+  return mimic_jpeg_decode_downscaled(dst, src, 0);
+}
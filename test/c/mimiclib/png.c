@@ -0,0 +1,149 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "png.h"
+
+void mimic_png_read_func(png_structp png, png_bytep ptr, png_size_t len) {
+  wuffs_base__io_buffer* src = (wuffs_base__io_buffer*)(png_get_io_ptr(png));
+  if (len > (src->meta.wi - src->meta.ri)) {
+    png_error(png, "unexpected end of data");
+  }
+  memmove(ptr, src->data.ptr + src->meta.ri, len);
+  src->meta.ri += len;
+}
+
+// mimic_png_decode decodes src's image to dst, as BGRA_NONPREMUL pixels. It
+// uses libpng's transformations, not its "simplified API", as the latter also
+// applies gamma correction when converting gray to color.
+const char* mimic_png_decode(wuffs_base__io_buffer* dst,
+                             wuffs_base__io_buffer* src) {
+  const char* ret = NULL;
+
+  png_structp png =
+      png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (!png) {
+    ret = "png_create_read_struct failed";
+    goto cleanup0;
+  }
+  png_infop info = png_create_info_struct(png);
+  if (!info) {
+    ret = "png_create_info_struct failed";
+    goto cleanup1;
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    ret = "libpng failed";
+    goto cleanup1;
+  }
+  png_set_read_fn(png, src, mimic_png_read_func);
+  png_read_info(png, info);
+
+  png_set_expand(png);
+  png_set_strip_16(png);
+  png_set_gray_to_rgb(png);
+  png_set_bgr(png);
+  png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+  int num_passes = png_set_interlace_handling(png);
+  png_read_update_info(png, info);
+
+  size_t width = png_get_image_width(png, info);
+  size_t height = png_get_image_height(png, info);
+  size_t stride = png_get_rowbytes(png, info);
+  if (stride != (4 * width)) {
+    ret = "unexpected row length";
+    goto cleanup1;
+  }
+  size_t num_dst = dst->data.len - dst->meta.wi;
+  if ((num_dst / stride) < height) {
+    ret = "PNG image's pixel data won't fit in the dst buffer";
+    goto cleanup1;
+  }
+  // For interlaced images, png_read_row is called once per row per pass.
+  int pass;
+  for (pass = 0; pass < num_passes; pass++) {
+    size_t y;
+    for (y = 0; y < height; y++) {
+      png_read_row(png, dst->data.ptr + dst->meta.wi + (y * stride), NULL);
+    }
+  }
+  dst->meta.wi += height * stride;
+
+cleanup1:
+  png_destroy_read_struct(&png, info ? &info : NULL, NULL);
+cleanup0:
+  return ret;
+}
+
+void mimic_png_write_func(png_structp png, png_bytep ptr, png_size_t len) {
+  wuffs_base__io_buffer* dst = (wuffs_base__io_buffer*)(png_get_io_ptr(png));
+  if (len > (dst->data.len - dst->meta.wi)) {
+    png_error(png, "dst buffer is too small");
+  }
+  memmove(dst->data.ptr + dst->meta.wi, ptr, len);
+  dst->meta.wi += len;
+}
+
+void mimic_png_flush_func(png_structp png) {}
+
+// mimic_png_encode encodes src's image, which must be BGRA_NONPREMUL, to dst,
+// as an 8 bit RGBA PNG with the given zlib compression level. Like the Wuffs
+// encoder, it lets libpng pick each row's filter.
+const char* mimic_png_encode(wuffs_base__io_buffer* dst,
+                             wuffs_base__pixel_buffer* src,
+                             int level) {
+  if (wuffs_base__pixel_buffer__pixel_format(src) !=
+      WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) {
+    return "mimic_png_encode: unsupported pixel format";
+  }
+  const char* ret = NULL;
+
+  png_structp png =
+      png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (!png) {
+    ret = "png_create_write_struct failed";
+    goto cleanup0;
+  }
+  png_infop info = png_create_info_struct(png);
+  if (!info) {
+    ret = "png_create_info_struct failed";
+    goto cleanup1;
+  }
+  if (setjmp(png_jmpbuf(png))) {
+    ret = "libpng failed";
+    goto cleanup1;
+  }
+  png_set_write_fn(png, dst, mimic_png_write_func, mimic_png_flush_func);
+  if (level >= 0) {
+    png_set_compression_level(png, level);
+  }
+
+  uint32_t width = wuffs_base__pixel_config__width(&src->pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&src->pixcfg);
+  png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+               PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  png_set_bgr(png);
+
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(src, 0);
+  uint32_t y;
+  for (y = 0; y < height; y++) {
+    png_write_row(png, wuffs_base__table_u8__row(tab, y).ptr);
+  }
+  png_write_end(png, NULL);
+
+cleanup1:
+  png_destroy_write_struct(&png, info ? &info : NULL);
+cleanup0:
+  return ret;
+}
@@ -0,0 +1,41 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "webp/decode.h"
+
+// mimic_webp_decode decodes src's image to dst, as BGRA_NONPREMUL pixels,
+// using libwebp's WebPDecodeBGRAInto.
+const char* mimic_webp_decode(wuffs_base__io_buffer* dst,
+                              wuffs_base__io_buffer* src) {
+  const uint8_t* data = src->data.ptr + src->meta.ri;
+  size_t data_size = src->meta.wi - src->meta.ri;
+  int width = 0;
+  int height = 0;
+  if (!WebPGetInfo(data, data_size, &width, &height)) {
+    return "libwebp: WebPGetInfo failed";
+  }
+
+  size_t stride = 4 * ((size_t)width);
+  size_t num_dst = dst->data.len - dst->meta.wi;
+  if ((num_dst / stride) < ((size_t)height)) {
+    return "WebP image's pixel data won't fit in the dst buffer";
+  }
+  if (!WebPDecodeBGRAInto(data, data_size, dst->data.ptr + dst->meta.wi,
+                          num_dst, (int)stride)) {
+    return "libwebp: WebPDecodeBGRAInto failed";
+  }
+  dst->meta.wi += ((size_t)height) * stride;
+  src->meta.ri = src->meta.wi;
+  return NULL;
+}
@@ -77,6 +77,64 @@ golden_test adler32_pi_gt = {
 
 // ---------------- Adler32 Tests
 
+void test_wuffs_adler32_combine() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, adler32_pi_gt.src_filename)) {
+    return;
+  }
+
+  // The want value is determined by script/checksum.go.
+  uint32_t want = 0xA62F1E51;
+
+  // Split pi.txt into three pieces, at every combination of two of these
+  // offsets, some of which are more than 65521 bytes apart, checksum each
+  // piece independently and then combine them.
+  size_t offsets[] = {0, 1, 5552, 65521, 65522, src.meta.wi - 1, src.meta.wi};
+  int i;
+  for (i = 0; i < WUFFS_TESTLIB_ARRAY_SIZE(offsets); i++) {
+    int j;
+    for (j = i; j < WUFFS_TESTLIB_ARRAY_SIZE(offsets); j++) {
+      size_t bounds[4] = {0, offsets[i], offsets[j], src.meta.wi};
+      wuffs_adler32__hasher whole = ((wuffs_adler32__hasher){});
+      wuffs_base__status z = wuffs_adler32__hasher__check_wuffs_version(
+          &whole, sizeof whole, WUFFS_VERSION);
+      if (z) {
+        FAIL("check_wuffs_version: \"%s\"", z);
+        return;
+      }
+
+      uint32_t got = 0;
+      int k;
+      for (k = 0; k < 3; k++) {
+        wuffs_adler32__hasher piece = ((wuffs_adler32__hasher){});
+        z = wuffs_adler32__hasher__check_wuffs_version(&piece, sizeof piece,
+                                                       WUFFS_VERSION);
+        if (z) {
+          FAIL("check_wuffs_version: \"%s\"", z);
+          return;
+        }
+        size_t n = bounds[k + 1] - bounds[k];
+        uint32_t x = wuffs_adler32__hasher__update(
+            &piece, ((wuffs_base__slice_u8){
+                        .ptr = src.data.ptr + bounds[k],
+                        .len = n,
+                    }));
+        got = wuffs_adler32__hasher__combine(&whole, x, n);
+      }
+
+      if (got != want) {
+        FAIL("i=%d, j=%d: got 0x%08" PRIX32 ", want 0x%08" PRIX32 "\n", i, j,
+             got, want);
+        return;
+      }
+    }
+  }
+}
+
 void test_wuffs_adler32_golden() {
   CHECK_FOCUS(__func__);
 
@@ -248,7 +306,7 @@ void bench_wuffs_adler32_100k() {
   do_bench_io_buffers(wuffs_bench_adler32, tc_src, &adler32_pi_gt, 0, 0, 150);
 }
 
-  // ---------------- Mimic Benches
+// ---------------- Mimic Benches
 
 #ifdef WUFFS_MIMIC
 
@@ -273,8 +331,9 @@ void bench_mimic_adler32_100k() {
 // The empty comments forces clang-format to place one element per line.
 proc tests[] = {
 
-    test_wuffs_adler32_golden,  //
-    test_wuffs_adler32_pi,      //
+    test_wuffs_adler32_combine,  //
+    test_wuffs_adler32_golden,   //
+    test_wuffs_adler32_pi,       //
 
     NULL,
 };
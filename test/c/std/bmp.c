@@ -0,0 +1,1074 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test" or "wuffs
+bench" commands. These commands take an optional "-mimic" flag to check that
+Wuffs' output mimics (i.e. exactly matches) other libraries' output, such as
+giflib for GIF, libpng for PNG, etc.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror bmp.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+Add the "wuffs mimic cflags" (everything after the colon below) to the C
+compiler flags (after the .c file) to run the mimic tests.
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench". Combine these changes with the
+"wuffs mimic cflags" to run the mimic benchmarks.
+*/
+
+// !! wuffs mimic cflags: -DWUFFS_MIMIC
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+//
+// The PNG decoder (and its dependencies) provides the expected pixels for the
+// BMP images that are not paletted.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__ADLER32
+#define WUFFS_CONFIG__MODULE__BASE
+#define WUFFS_CONFIG__MODULE__CRC32
+#define WUFFS_CONFIG__MODULE__BMP
+#define WUFFS_CONFIG__MODULE__DEFLATE
+#define WUFFS_CONFIG__MODULE__PNG
+#define WUFFS_CONFIG__MODULE__ZLIB
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../../release/c/wuffs-unsupported-snapshot.h"
+#include "../testlib/testlib.c"
+
+// ---------------- BMP Tests
+
+// do_wuffs_bmp_decode decodes src's image to dst, in the given pixel format. A
+// zero pixfmt means the decoder's src_pixel_format, so that decoding is a
+// plain copy. A non-zero rlimit means that the src is fed to the decoder at
+// most rlimit bytes at a time.
+const char* do_wuffs_bmp_decode(wuffs_base__io_buffer* dst,
+                                wuffs_base__io_buffer* src,
+                                wuffs_base__pixel_format pixfmt,
+                                uint64_t rlimit) {
+  wuffs_bmp__decoder dec = ((wuffs_bmp__decoder){});
+  wuffs_base__status z =
+      wuffs_bmp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_bmp__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  if (!pixfmt) {
+    pixfmt = wuffs_bmp__decoder__src_pixel_format(&dec);
+    if (!pixfmt) {
+      return "do_wuffs_bmp_decode: no src_pixel_format";
+    }
+  }
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, 0, wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_bmp__decoder__decode_frame(&dec, &pb, src_reader,
+                                         ((wuffs_base__slice_u8){}), NULL);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+const char* wuffs_bmp_decode(wuffs_base__io_buffer* dst,
+                             wuffs_base__io_buffer* src) {
+  return do_wuffs_bmp_decode(dst, src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                             0);
+}
+
+const char* wuffs_bmp_decode_copy(wuffs_base__io_buffer* dst,
+                                  wuffs_base__io_buffer* src) {
+  return do_wuffs_bmp_decode(dst, src, 0, 0);
+}
+
+// make_bmp_view sets view to the pixel data of the BMP image in src, in place,
+// without decoding it. The view's rows are in the order stored: bottom-up
+// unless *top_down is set to true. It fails for compressed images, or for
+// those with fewer than 8 bits per pixel.
+const char* make_bmp_view(wuffs_base__table_u8* view,
+                          bool* top_down,
+                          wuffs_base__io_buffer* src) {
+  wuffs_bmp__decoder dec = ((wuffs_bmp__decoder){});
+  wuffs_base__status z =
+      wuffs_bmp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_bmp__decoder__decode_image_config(
+      &dec, &ic, wuffs_base__io_buffer__reader(src));
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_format pixfmt = wuffs_bmp__decoder__src_pixel_format(&dec);
+  if (!pixfmt) {
+    return "make_bmp_view: no src_pixel_format";
+  }
+  uint64_t pos = wuffs_base__image_config__first_frame_io_position(&ic);
+  uint64_t stride = wuffs_bmp__decoder__src_row_stride(&dec);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  if ((pos > src->meta.wi) || ((src->meta.wi - pos) / stride < height)) {
+    return "make_bmp_view: not enough pixel data";
+  }
+  *view = ((wuffs_base__table_u8){
+      .ptr = src->data.ptr + pos,
+      .width = ((size_t)wuffs_base__pixel_config__width(&ic.pixcfg)) *
+               (wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8),
+      .height = height,
+      .stride = stride,
+  });
+  *top_down = wuffs_bmp__decoder__is_top_down(&dec);
+  return NULL;
+}
+
+// copy_to_io_buffer_from_bmp_view copies the view's rows to dst, top row
+// first.
+const char* copy_to_io_buffer_from_bmp_view(wuffs_base__io_buffer* dst,
+                                            wuffs_base__table_u8 view,
+                                            bool top_down) {
+  uint32_t y;
+  for (y = 0; y < view.height; y++) {
+    wuffs_base__slice_u8 row =
+        wuffs_base__table_u8__row(view, top_down ? y : (view.height - 1 - y));
+    if (row.len > (dst->data.len - dst->meta.wi)) {
+      return "copy_to_io_buffer_from_bmp_view: dst buffer is too small";
+    }
+    memmove(dst->data.ptr + dst->meta.wi, row.ptr, row.len);
+    dst->meta.wi += row.len;
+  }
+  return NULL;
+}
+
+// png_decode decodes the PNG image in src to dst, as BGRA_NONPREMUL pixels.
+const char* png_decode(wuffs_base__io_buffer* dst, wuffs_base__io_buffer* src) {
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+  z = wuffs_png__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "png_decode: work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+  z = wuffs_png__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+  if (z) {
+    return z;
+  }
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+// image_decoder_decode initializes d and then decodes the image in src to dst,
+// as BGRA_NONPREMUL pixels, via the format-agnostic wuffs_base__image_decoder
+// interface.
+const char* image_decoder_decode(wuffs_base__io_buffer* dst,
+                                 wuffs_base__io_buffer* src,
+                                 wuffs_base__image_decoder* d) {
+  wuffs_base__status z = wuffs_base__image_decoder__initialize(d);
+  if (z) {
+    return z;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+  z = wuffs_base__image_decoder__decode_image_config(d, &ic, src_reader);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_decoder__workbuf_len(d).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "image_decoder_decode: work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+  z = wuffs_base__image_decoder__decode_frame(d, &pb, src_reader, workbuf,
+                                              NULL);
+  if (z) {
+    return z;
+  }
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+// make_32bpp_bmp replaces src's contents, an uncompressed 24 bits per pixel
+// bottom-up BMP image, with the same image as a 32 bits per pixel BMP image,
+// with a plain BITMAPINFOHEADER and an opaque fourth byte per pixel. The rows
+// are stored top-down if top_down is true.
+const char* make_32bpp_bmp(wuffs_base__io_buffer* src, bool top_down) {
+  uint8_t* p = src->data.ptr;
+  if ((src->meta.wi < 54) || (wuffs_base__load_u16le(p + 28) != 24)) {
+    return "make_32bpp_bmp: unsupported source image";
+  }
+  uint32_t pix_offset = wuffs_base__load_u32le(p + 10);
+  uint32_t width = wuffs_base__load_u32le(p + 18);
+  uint32_t height = wuffs_base__load_u32le(p + 22);
+  size_t src_stride = ((((size_t)width) * 24 + 31) / 32) * 4;
+  size_t dst_stride = ((size_t)width) * 4;
+  if ((pix_offset > src->meta.wi) ||
+      ((src->meta.wi - pix_offset) / src_stride < height) ||
+      ((src->data.len - src->meta.wi) < (54 + (dst_stride * height)))) {
+    return "make_32bpp_bmp: bad source image";
+  }
+
+  // Build the new image after the old one, then move it to the start.
+  uint8_t* q = p + src->meta.wi;
+  memset(q, 0, 54);
+  q[0] = 'B';
+  q[1] = 'M';
+  wuffs_base__store_u32le(q + 2, 54 + (dst_stride * height));
+  wuffs_base__store_u32le(q + 10, 54);
+  wuffs_base__store_u32le(q + 14, 40);
+  wuffs_base__store_u32le(q + 18, width);
+  wuffs_base__store_u32le(q + 22, top_down ? (0 - height) : height);
+  wuffs_base__store_u16le(q + 26, 1);
+  wuffs_base__store_u16le(q + 28, 32);
+
+  uint32_t y;
+  for (y = 0; y < height; y++) {
+    // Stored row y is the image's row (height - 1 - y) in the source.
+    uint8_t* s = p + pix_offset + (y * src_stride);
+    uint8_t* d = q + 54 + ((top_down ? (height - 1 - y) : y) * dst_stride);
+    uint32_t x;
+    for (x = 0; x < width; x++) {
+      d[(4 * x) + 0] = s[(3 * x) + 0];
+      d[(4 * x) + 1] = s[(3 * x) + 1];
+      d[(4 * x) + 2] = s[(3 * x) + 2];
+      d[(4 * x) + 3] = 0xFF;
+    }
+  }
+
+  size_t n = 54 + (dst_stride * height);
+  memmove(p, q, n);
+  src->meta.ri = 0;
+  src->meta.wi = n;
+  return NULL;
+}
+
+bool do_test_wuffs_bmp_decode(const char* bmp_filename,
+                              const char* png_filename,
+                              uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  const char* msg = png_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, bmp_filename)) {
+    return false;
+  }
+  msg = do_wuffs_bmp_decode(&got, &src,
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, rlimit);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+bool do_test_wuffs_bmp_decode_indexed(const char* bmp_filename,
+                                      const char* palette_filename,
+                                      const char* indexes_filename,
+                                      uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, bmp_filename)) {
+    return false;
+  }
+  const char* msg = do_wuffs_bmp_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, rlimit);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  if (!read_file(&want, indexes_filename)) {
+    return false;
+  }
+  if (!io_buffers_equal("indexes ", &got, &want)) {
+    return false;
+  }
+  if (!palette_filename) {
+    return true;
+  }
+
+  // do_wuffs_bmp_decode decoded into global_pixel_slice. Where a pixel buffer
+  // set from that slice places its palette does not depend on the image size.
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0, 1, 1);
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  msg = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(&pb);
+  got = ((wuffs_base__io_buffer){
+      .data = palette,
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = palette.len,
+      }),
+  });
+  want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  if (!read_file(&want, palette_filename)) {
+    return false;
+  }
+  return io_buffers_equal("palette ", &got, &want);
+}
+
+// do_test_wuffs_bmp_view checks that, for the 32 bits per pixel version of the
+// given 24 bits per pixel BMP image, the in place view, a plain copy and
+// conversion to BGRA all match the PNG version of that image.
+bool do_test_wuffs_bmp_view(const char* bmp_filename,
+                            const char* png_filename,
+                            bool top_down) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  const char* msg = png_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, bmp_filename)) {
+    return false;
+  }
+  msg = make_32bpp_bmp(&src, top_down);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  wuffs_base__table_u8 view = ((wuffs_base__table_u8){});
+  bool view_top_down = false;
+  msg = make_bmp_view(&view, &view_top_down, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  if (view_top_down != top_down) {
+    FAIL("is_top_down: got %d, want %d", view_top_down, top_down);
+    return false;
+  }
+  msg = copy_to_io_buffer_from_bmp_view(&got, view, view_top_down);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  if (!io_buffers_equal("view ", &got, &want)) {
+    return false;
+  }
+
+  int i;
+  for (i = 0; i < 2; i++) {
+    got.meta = ((wuffs_base__io_buffer_meta){});
+    src.meta.ri = 0;
+    msg = do_wuffs_bmp_decode(
+        &got, &src, i ? WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL : 0, 0);
+    if (msg) {
+      FAIL("%s", msg);
+      return false;
+    }
+    if (!io_buffers_equal(i ? "bgra " : "copy ", &got, &want)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void test_wuffs_bmp_call_sequence() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/hat.bmp")) {
+    return;
+  }
+
+  wuffs_bmp__decoder dec = ((wuffs_bmp__decoder){});
+  wuffs_base__status z =
+      wuffs_bmp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_bmp__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+  z = wuffs_bmp__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z) {
+    FAIL("decode_frame_config #0: got \"%s\"", z);
+    return;
+  }
+
+  z = wuffs_bmp__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z != wuffs_base__warning__end_of_data) {
+    FAIL("decode_frame_config #1: got \"%s\", want \"%s\"", z,
+         wuffs_base__warning__end_of_data);
+    return;
+  }
+
+  z = wuffs_bmp__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z != wuffs_base__error__bad_call_sequence) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__bad_call_sequence);
+    return;
+  }
+}
+
+void test_wuffs_bmp_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode("../../data/bricks-color.bmp",
+                           "../../data/bricks-color.png", 0);
+}
+
+void test_wuffs_bmp_decode_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode_indexed("../../data/bricks-dither.bmp",
+                                   "../../data/bricks-dither.palette",
+                                   "../../data/bricks-dither.indexes", 0);
+}
+
+void test_wuffs_bmp_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode_indexed("../../data/bricks-gray.bmp", NULL,
+                                   "../../data/bricks-gray.indexes", 0);
+}
+
+void test_wuffs_bmp_decode_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode_indexed("../../data/bricks-nodither.bmp",
+                                   "../../data/bricks-nodither.palette",
+                                   "../../data/bricks-nodither.indexes", 0);
+}
+
+void test_wuffs_bmp_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode("../../data/harvesters.bmp",
+                           "../../data/harvesters.png", 0);
+}
+
+void test_wuffs_bmp_decode_hippopotamus() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode("../../data/hippopotamus.bmp",
+                           "../../data/hippopotamus.regular.png", 0);
+}
+
+void test_wuffs_bmp_decode_input_is_a_png() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.png")) {
+    return;
+  }
+
+  wuffs_bmp__decoder dec = ((wuffs_bmp__decoder){});
+  wuffs_base__status z =
+      wuffs_bmp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_bmp__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z != wuffs_bmp__error__bad_header) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_bmp__error__bad_header);
+    return;
+  }
+}
+
+void test_wuffs_bmp_decode_image_decoder_pooled() {
+  CHECK_FOCUS(__func__);
+
+  // The one block of memory, large enough for either decoder type, is re-used
+  // for every image, whatever its format.
+  union {
+    wuffs_bmp__decoder bmp;
+    wuffs_png__decoder png;
+  } pool;
+
+  const char* filenames[3] = {
+      "../../data/bricks-color.png",
+      "../../data/bricks-color.bmp",
+      "../../data/bricks-color.png",
+  };
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  int i;
+  for (i = 0; i < 3; i++) {
+    src.meta = ((wuffs_base__io_buffer_meta){});
+    if (!read_file(&src, filenames[i])) {
+      return;
+    }
+    wuffs_base__image_format format =
+        wuffs_base__image_format__sniff(((wuffs_base__slice_u8){
+            .ptr = src.data.ptr,
+            .len = wuffs_base__u64__min(src.meta.wi,
+                                        WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN),
+        }));
+
+    wuffs_base__image_decoder d = ((wuffs_base__image_decoder){});
+    switch (format) {
+      case WUFFS_BASE__IMAGE_FORMAT__BMP:
+        d = wuffs_bmp__decoder__upcast_as__wuffs_base__image_decoder(&pool.bmp);
+        break;
+      case WUFFS_BASE__IMAGE_FORMAT__PNG:
+        d = wuffs_png__decoder__upcast_as__wuffs_base__image_decoder(&pool.png);
+        break;
+      default:
+        FAIL("i=%d: sniff: got 0x%08" PRIX32, i, format);
+        return;
+    }
+
+    got.meta = ((wuffs_base__io_buffer_meta){});
+    const char* msg = image_decoder_decode((i == 0) ? &want : &got, &src, &d);
+    if (msg) {
+      FAIL("i=%d: %s", i, msg);
+      return;
+    }
+    if ((i > 0) && !io_buffers_equal("", &got, &want)) {
+      return;
+    }
+  }
+
+  wuffs_base__image_decoder d = ((wuffs_base__image_decoder){});
+  wuffs_base__status z = wuffs_base__image_decoder__initialize(&d);
+  if (z != wuffs_base__error__bad_receiver) {
+    FAIL("initialize: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__bad_receiver);
+    return;
+  }
+}
+
+void test_wuffs_bmp_decode_many_small_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode("../../data/bricks-color.bmp",
+                           "../../data/bricks-color.png", 13);
+}
+
+void test_wuffs_bmp_decode_many_small_reads_rle() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode_indexed("../../data/bricks-dither.bmp",
+                                   "../../data/bricks-dither.palette",
+                                   "../../data/bricks-dither.indexes", 7);
+}
+
+void test_wuffs_bmp_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_decode("../../data/pjw-thumbnail.bmp",
+                           "../../data/pjw-thumbnail.png", 0);
+}
+
+void test_wuffs_bmp_decode_rle4() {
+  CHECK_FOCUS(__func__);
+
+  // An 8x3 image, RLE4 compressed, with a 16 color palette. The pixel data
+  // is, for the stored (bottom-up) rows:
+  //  - row 0: a run of 4 pixels alternating 1 and 2, a literal run of 3
+  //    pixels (3, 4 and 5) and the end of the row.
+  //  - a delta of 2 pixels right and 1 row up, to row 2.
+  //  - row 2: a literal run of 3 pixels (0xA, 0xB and 0xA), a run of 10
+  //    pixels of 7, clipped to 3, and the end of the image.
+  static const uint8_t pixel_data[] = {
+      0x04, 0x12, 0x00, 0x03, 0x34, 0x50, 0x00, 0x00, 0x00, 0x02,
+      0x02, 0x01, 0x00, 0x03, 0xAB, 0xA0, 0x0A, 0x77, 0x00, 0x01,
+  };
+  static const uint8_t want_indexes[] = {
+      0x0, 0x0, 0xA, 0xB, 0xA, 0x7, 0x7, 0x7,  //
+      0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,  //
+      0x1, 0x2, 0x1, 0x2, 0x3, 0x4, 0x5, 0x0,  //
+  };
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = (uint8_t*)want_indexes,
+          .len = sizeof want_indexes,
+      }),
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = sizeof want_indexes,
+          .closed = true,
+      }),
+  });
+
+  uint8_t* p = src.data.ptr;
+  uint32_t pix_offset = 14 + 40 + (16 * 4);
+  memset(p, 0, pix_offset);
+  p[0] = 'B';
+  p[1] = 'M';
+  wuffs_base__store_u32le(p + 2, pix_offset + sizeof pixel_data);
+  wuffs_base__store_u32le(p + 10, pix_offset);
+  wuffs_base__store_u32le(p + 14, 40);
+  wuffs_base__store_u32le(p + 18, 8);
+  wuffs_base__store_u32le(p + 22, 3);
+  wuffs_base__store_u16le(p + 26, 1);
+  wuffs_base__store_u16le(p + 28, 4);
+  wuffs_base__store_u32le(p + 30, 2);
+  wuffs_base__store_u32le(p + 46, 16);
+  memcpy(p + pix_offset, pixel_data, sizeof pixel_data);
+  src.meta.wi = pix_offset + sizeof pixel_data;
+  src.meta.closed = true;
+
+  const char* msg = do_wuffs_bmp_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  io_buffers_equal("", &got, &want);
+}
+
+void test_wuffs_bmp_decode_truncated() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-color.bmp")) {
+    return;
+  }
+  src.meta.wi /= 2;
+  src.meta.closed = true;
+
+  const char* msg = do_wuffs_bmp_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+  if (msg != wuffs_base__suspension__short_read) {
+    FAIL("got \"%s\", want \"%s\"", msg, wuffs_base__suspension__short_read);
+    return;
+  }
+}
+
+void test_wuffs_bmp_view_24bpp() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, "../../data/hibiscus.bmp")) {
+    return;
+  }
+  const char* msg = wuffs_bmp_decode_copy(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+
+  wuffs_base__table_u8 view = ((wuffs_base__table_u8){});
+  bool top_down = false;
+  src.meta.ri = 0;
+  msg = make_bmp_view(&view, &top_down, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  if (top_down) {
+    FAIL("is_top_down: got true, want false");
+    return;
+  }
+  if ((view.width != 312 * 3) || (view.height != 442) ||
+      (view.stride != 312 * 3)) {
+    FAIL("view: got %zu x %zu (stride %zu), want 936 x 442 (stride 936)",
+         view.width, view.height, view.stride);
+    return;
+  }
+  msg = copy_to_io_buffer_from_bmp_view(&got, view, top_down);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  io_buffers_equal("", &got, &want);
+}
+
+void test_wuffs_bmp_view_32bpp_bottom_up() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_view("../../data/hibiscus.bmp", "../../data/hibiscus.png",
+                         false);
+}
+
+void test_wuffs_bmp_view_32bpp_top_down() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_bmp_view("../../data/hibiscus.bmp", "../../data/hibiscus.png",
+                         true);
+}
+
+void test_wuffs_base_image_format_sniff() {
+  CHECK_FOCUS(__func__);
+
+  struct {
+    const char* filename;
+    wuffs_base__image_format want;
+  } tests[] = {
+      {"../../data/bricks-color.bmp", WUFFS_BASE__IMAGE_FORMAT__BMP},
+      {"../../data/bricks-color.jpeg", WUFFS_BASE__IMAGE_FORMAT__JPEG},
+      {"../../data/bricks-color.lossless.webp", WUFFS_BASE__IMAGE_FORMAT__WEBP},
+      {"../../data/bricks-color.png", WUFFS_BASE__IMAGE_FORMAT__PNG},
+      {"../../data/bricks-color.tiff", WUFFS_BASE__IMAGE_FORMAT__TIFF},
+      {"../../data/bricks-dither.gif", WUFFS_BASE__IMAGE_FORMAT__GIF},
+      {"../../data/hat.tiff", WUFFS_BASE__IMAGE_FORMAT__TIFF},
+      {"../../data/midsummer.txt", 0},
+      {"../../data/midsummer.txt.gz", 0},
+  };
+
+  int tc;
+  for (tc = 0; tc < WUFFS_TESTLIB_ARRAY_SIZE(tests); tc++) {
+    wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+        .data = global_src_slice,
+    });
+    if (!read_file(&src, tests[tc].filename)) {
+      return;
+    }
+
+    wuffs_base__image_format got =
+        wuffs_base__image_format__sniff(((wuffs_base__slice_u8){
+            .ptr = src.data.ptr,
+            .len = wuffs_base__u64__min(src.meta.wi,
+                                        WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN),
+        }));
+    if (got != tests[tc].want) {
+      FAIL("%s: got 0x%08" PRIX32 ", want 0x%08" PRIX32, tests[tc].filename,
+           got, tests[tc].want);
+      return;
+    }
+
+    // A 1-byte prefix is shorter than every format's magic number.
+    got = wuffs_base__image_format__sniff(((wuffs_base__slice_u8){
+        .ptr = src.data.ptr,
+        .len = 1,
+    }));
+    if (got != 0) {
+      FAIL("%s: 1-byte prefix: got 0x%08" PRIX32 ", want 0", tests[tc].filename,
+           got);
+      return;
+    }
+  }
+}
+
+// ---------------- BMP Benches
+
+bool do_bench_bmp_decode(const char* (*decode_func)(wuffs_base__io_buffer*,
+                                                    wuffs_base__io_buffer*),
+                         const char* filename,
+                         bool make_32bpp,
+                         uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  if (make_32bpp) {
+    const char* msg = make_32bpp_bmp(&src, false);
+    if (msg) {
+      FAIL("%s", msg);
+      return false;
+    }
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    const char* error_msg = decode_func(&got, &src);
+    if (error_msg) {
+      FAIL("%s", error_msg);
+      return false;
+    }
+    n_bytes += got.meta.wi;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+// wuffs_bmp_view makes an in place view of src's pixel data. It does not touch
+// the pixels, only the header, so its cost does not depend on the image size.
+// It advances dst->meta.wi by the number of bytes in the view, without
+// writing to dst, so that the benchmarks' throughput numbers are comparable.
+const char* wuffs_bmp_view(wuffs_base__io_buffer* dst,
+                           wuffs_base__io_buffer* src) {
+  wuffs_base__table_u8 view = ((wuffs_base__table_u8){});
+  bool top_down = false;
+  const char* msg = make_bmp_view(&view, &top_down, src);
+  if (msg) {
+    return msg;
+  }
+  dst->meta.wi += view.width * view.height;
+  return NULL;
+}
+
+void bench_wuffs_bmp_decode_19k_8bpp_rle() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_decode, "../../data/bricks-dither.bmp", false,
+                      50);
+}
+
+void bench_wuffs_bmp_decode_138k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_decode, "../../data/hibiscus.bmp", false, 5);
+}
+
+void bench_wuffs_bmp_decode_1000k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_decode, "../../data/harvesters.bmp", false, 1);
+}
+
+void bench_wuffs_bmp_decode_1000k_32bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_decode, "../../data/harvesters.bmp", true, 1);
+}
+
+void bench_wuffs_bmp_decode_copy_1000k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_decode_copy, "../../data/harvesters.bmp", false,
+                      1);
+}
+
+void bench_wuffs_bmp_decode_copy_1000k_32bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_decode_copy, "../../data/harvesters.bmp", true,
+                      1);
+}
+
+void bench_wuffs_bmp_view_1000k_32bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_bmp_decode(wuffs_bmp_view, "../../data/harvesters.bmp", true, 1);
+}
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_bmp_call_sequence,                //
+    test_wuffs_bmp_decode_bricks_color,          //
+    test_wuffs_bmp_decode_bricks_dither,         //
+    test_wuffs_bmp_decode_bricks_gray,           //
+    test_wuffs_bmp_decode_bricks_nodither,       //
+    test_wuffs_bmp_decode_harvesters,            //
+    test_wuffs_bmp_decode_hippopotamus,          //
+    test_wuffs_bmp_decode_image_decoder_pooled,  //
+    test_wuffs_bmp_decode_input_is_a_png,        //
+    test_wuffs_bmp_decode_many_small_reads,      //
+    test_wuffs_bmp_decode_many_small_reads_rle,  //
+    test_wuffs_bmp_decode_pjw_thumbnail,         //
+    test_wuffs_bmp_decode_rle4,                  //
+    test_wuffs_bmp_decode_truncated,             //
+    test_wuffs_bmp_view_24bpp,                   //
+    test_wuffs_bmp_view_32bpp_bottom_up,         //
+    test_wuffs_bmp_view_32bpp_top_down,          //
+    test_wuffs_base_image_format_sniff,          //
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_bmp_decode_19k_8bpp_rle,      //
+    bench_wuffs_bmp_decode_138k_24bpp,        //
+    bench_wuffs_bmp_decode_1000k_24bpp,       //
+    bench_wuffs_bmp_decode_1000k_32bpp,       //
+    bench_wuffs_bmp_decode_copy_1000k_24bpp,  //
+    bench_wuffs_bmp_decode_copy_1000k_32bpp,  //
+    bench_wuffs_bmp_view_1000k_32bpp,         //
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "std/bmp";
+  return test_main(argc, argv, tests, benches);
+}
@@ -588,7 +588,199 @@ void test_wuffs_deflate_table_redirect() {
   }
 }
 
-  // ---------------- Mimic Tests
+bool do_test_wuffs_deflate_encode(wuffs_base__io_buffer* src,
+                                  uint32_t level,
+                                  uint64_t wlimit,
+                                  uint64_t rlimit) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer work = ((wuffs_base__io_buffer){
+      .data = global_work_slice,
+  });
+
+  wuffs_deflate__encoder enc = ((wuffs_deflate__encoder){});
+  wuffs_base__status z = wuffs_deflate__encoder__check_wuffs_version(
+      &enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_deflate__encoder__set_level(&enc, level);
+  int num_iters = 0;
+  while (true) {
+    num_iters++;
+    wuffs_base__io_writer work_writer = wuffs_base__io_buffer__writer(&work);
+    if (wlimit) {
+      set_writer_limit(&work_writer, wlimit);
+    }
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    size_t old_wi = work.meta.wi;
+    size_t old_ri = src->meta.ri;
+
+    z = wuffs_deflate__encoder__encode(&enc, work_writer, src_reader);
+    if (!z) {
+      if (src->meta.ri != src->meta.wi) {
+        FAIL("encode returned \"ok\" but src was not exhausted");
+        return false;
+      }
+      break;
+    }
+    if ((z != wuffs_base__suspension__short_read) &&
+        (z != wuffs_base__suspension__short_write)) {
+      FAIL("encode: got \"%s\", want \"%s\" or \"%s\"", z,
+           wuffs_base__suspension__short_read,
+           wuffs_base__suspension__short_write);
+      return false;
+    }
+    if ((work.meta.wi == old_wi) && (src->meta.ri == old_ri)) {
+      FAIL("no progress was made");
+      return false;
+    }
+  }
+
+  if ((wlimit || rlimit) && (num_iters <= 1)) {
+    FAIL("num_iters: got %d, want > 1", num_iters);
+    return false;
+  }
+  if ((level > 0) && (src->meta.wi >= 1000) && (work.meta.wi >= src->meta.wi)) {
+    FAIL("level %d: encoded %d bytes as %d bytes", (int)(level),
+         (int)(src->meta.wi), (int)(work.meta.wi));
+    return false;
+  }
+  work.meta.closed = true;
+
+  // Round-trip the encoded form through the decoder.
+  z = wuffs_deflate_decode(&got, &work, 0, 0);
+  if (z) {
+    FAIL("level %d: decode: \"%s\"", (int)(level), z);
+    return false;
+  }
+  if (work.meta.ri != work.meta.wi) {
+    FAIL("decode returned \"ok\" but work was not exhausted");
+    return false;
+  }
+  src->meta.ri = 0;
+  return io_buffers_equal("", &got, src);
+}
+
+bool do_test_wuffs_deflate_encode_file(const char* filename,
+                                       uint32_t level,
+                                       uint64_t wlimit,
+                                       uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  return do_test_wuffs_deflate_encode(&src, level, wlimit, rlimit);
+}
+
+void test_wuffs_deflate_encode_empty() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  src.meta.closed = true;
+  do_test_wuffs_deflate_encode(&src, 6, 0, 0);
+}
+
+void test_wuffs_deflate_encode_levels() {
+  CHECK_FOCUS(__func__);
+  uint32_t level;
+  for (level = 0; level <= 9; level++) {
+    if (!do_test_wuffs_deflate_encode_file("../../data/midsummer.txt", level, 0,
+                                           0)) {
+      return;
+    }
+  }
+}
+
+void test_wuffs_deflate_encode_many_small_writes_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_deflate_encode_file("../../data/pi.txt", 6, 41, 43);
+}
+
+void test_wuffs_deflate_encode_pi() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_deflate_encode_file("../../data/pi.txt", 6, 0, 0);
+}
+
+void test_wuffs_deflate_encode_romeo() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_deflate_encode_file("../../data/romeo.txt", 9, 0, 0);
+}
+
+void test_wuffs_deflate_encode_full_flush() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer work = ((wuffs_base__io_buffer){
+      .data = global_work_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/midsummer.txt")) {
+    return;
+  }
+
+  // Encode the three pieces independently, with a fresh encoder for each,
+  // and check that their concatenation is a single valid deflate stream.
+  size_t splits[4] = {0, 1000, 4000, src.meta.wi};
+  int i;
+  for (i = 0; i < 3; i++) {
+    wuffs_base__io_buffer piece = ((wuffs_base__io_buffer){
+        .data = ((wuffs_base__slice_u8){
+            .ptr = src.data.ptr + splits[i],
+            .len = splits[i + 1] - splits[i],
+        }),
+    });
+    piece.meta.wi = piece.data.len;
+    piece.meta.closed = true;
+
+    wuffs_deflate__encoder enc = ((wuffs_deflate__encoder){});
+    wuffs_base__status z = wuffs_deflate__encoder__check_wuffs_version(
+        &enc, sizeof enc, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return;
+    }
+    wuffs_deflate__encoder__set_full_flush(&enc, i < 2);
+    z = wuffs_deflate__encoder__encode(&enc,
+                                       wuffs_base__io_buffer__writer(&work),
+                                       wuffs_base__io_buffer__reader(&piece));
+    if (z) {
+      FAIL("i=%d: encode: \"%s\"", i, z);
+      return;
+    }
+
+    // A full flush ends with an empty stored block: 00 00 FF FF.
+    if (i < 2) {
+      const uint8_t* p = work.data.ptr + work.meta.wi - 4;
+      if ((work.meta.wi < 4) || (p[0] != 0x00) || (p[1] != 0x00) ||
+          (p[2] != 0xFF) || (p[3] != 0xFF)) {
+        FAIL("i=%d: encoded piece does not end with a full flush", i);
+        return;
+      }
+    }
+  }
+  work.meta.closed = true;
+
+  const char* z = wuffs_deflate_decode(&got, &work, 0, 0);
+  if (z) {
+    FAIL("decode: \"%s\"", z);
+    return;
+  }
+  io_buffers_equal("", &got, &src);
+}
+
+// ---------------- Mimic Tests
 
 #ifdef WUFFS_MIMIC
 
@@ -629,6 +821,43 @@ void test_mimic_deflate_decode_romeo_fixed() {
   do_test_io_buffers(mimic_deflate_decode, &deflate_romeo_fixed_gt, 0, 0);
 }
 
+void test_mimic_deflate_decode_wuffs_encoded_pi() {
+  CHECK_FOCUS(__func__);
+  // Check that another deflate implementation can decode Wuffs' encoding.
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer work = ((wuffs_base__io_buffer){
+      .data = global_work_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/pi.txt")) {
+    return;
+  }
+  wuffs_deflate__encoder enc = ((wuffs_deflate__encoder){});
+  wuffs_base__status z = wuffs_deflate__encoder__check_wuffs_version(
+      &enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  z = wuffs_deflate__encoder__encode(&enc, wuffs_base__io_buffer__writer(&work),
+                                     wuffs_base__io_buffer__reader(&src));
+  if (z) {
+    FAIL("encode: \"%s\"", z);
+    return;
+  }
+  const char* zz = mimic_deflate_decode(&got, &work, 0, 0);
+  if (zz) {
+    FAIL("mimic_deflate_decode: \"%s\"", zz);
+    return;
+  }
+  src.meta.ri = 0;
+  io_buffers_equal("", &got, &src);
+}
+
 #endif  // WUFFS_MIMIC
 
 // ---------------- Deflate Benches
@@ -650,7 +879,64 @@ void bench_wuffs_deflate_decode_100k() {
   do_bench_io_buffers(wuffs_deflate_decode, tc_dst, &deflate_pi_gt, 0, 0, 30);
 }
 
-  // ---------------- Mimic Benches
+bool do_bench_deflate_encode(bool mimic,
+                             const char* filename,
+                             uint32_t level,
+                             uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    const char* z = NULL;
+    if (mimic) {
+#ifdef WUFFS_MIMIC
+      z = mimic_deflate_encode(&got, &src, level);
+#endif
+    } else {
+      wuffs_deflate__encoder enc = ((wuffs_deflate__encoder){});
+      z = wuffs_deflate__encoder__check_wuffs_version(&enc, sizeof enc,
+                                                      WUFFS_VERSION);
+      if (!z) {
+        wuffs_deflate__encoder__set_level(&enc, level);
+        z = wuffs_deflate__encoder__encode(&enc,
+                                           wuffs_base__io_buffer__writer(&got),
+                                           wuffs_base__io_buffer__reader(&src));
+      }
+    }
+    if (z) {
+      FAIL("encode: \"%s\"", z);
+      return false;
+    }
+    n_bytes += src.meta.ri;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_deflate_encode_100k_level1() {
+  CHECK_FOCUS(__func__);
+  do_bench_deflate_encode(false, "../../data/pi.txt", 1, 30);
+}
+
+void bench_wuffs_deflate_encode_100k_level6() {
+  CHECK_FOCUS(__func__);
+  do_bench_deflate_encode(false, "../../data/pi.txt", 6, 10);
+}
+
+// ---------------- Mimic Benches
 
 #ifdef WUFFS_MIMIC
 
@@ -671,6 +957,16 @@ void bench_mimic_deflate_decode_100k() {
   do_bench_io_buffers(mimic_deflate_decode, tc_dst, &deflate_pi_gt, 0, 0, 30);
 }
 
+void bench_mimic_deflate_encode_100k_level1() {
+  CHECK_FOCUS(__func__);
+  do_bench_deflate_encode(true, "../../data/pi.txt", 1, 30);
+}
+
+void bench_mimic_deflate_encode_100k_level6() {
+  CHECK_FOCUS(__func__);
+  do_bench_deflate_encode(true, "../../data/pi.txt", 6, 10);
+}
+
 #endif  // WUFFS_MIMIC
 
 // ---------------- Manifest
@@ -689,6 +985,12 @@ proc tests[] = {
     test_wuffs_deflate_decode_romeo,                           //
     test_wuffs_deflate_decode_romeo_fixed,                     //
     test_wuffs_deflate_decode_split_src,                       //
+    test_wuffs_deflate_encode_empty,                           //
+    test_wuffs_deflate_encode_full_flush,                      //
+    test_wuffs_deflate_encode_levels,                          //
+    test_wuffs_deflate_encode_many_small_writes_reads,         //
+    test_wuffs_deflate_encode_pi,                              //
+    test_wuffs_deflate_encode_romeo,                           //
     test_wuffs_deflate_history_full,                           //
     test_wuffs_deflate_history_partial,                        //
     test_wuffs_deflate_table_redirect,                         //
@@ -702,6 +1004,7 @@ proc tests[] = {
     test_mimic_deflate_decode_pi,                              //
     test_mimic_deflate_decode_romeo,                           //
     test_mimic_deflate_decode_romeo_fixed,                     //
+    test_mimic_deflate_decode_wuffs_encoded_pi,                //
 
 #endif  // WUFFS_MIMIC
 
@@ -711,15 +1014,19 @@ proc tests[] = {
 // The empty comments forces clang-format to place one element per line.
 proc benches[] = {
 
-    bench_wuffs_deflate_decode_1k,    //
-    bench_wuffs_deflate_decode_10k,   //
-    bench_wuffs_deflate_decode_100k,  //
+    bench_wuffs_deflate_decode_1k,           //
+    bench_wuffs_deflate_decode_10k,          //
+    bench_wuffs_deflate_decode_100k,         //
+    bench_wuffs_deflate_encode_100k_level1,  //
+    bench_wuffs_deflate_encode_100k_level6,  //
 
 #ifdef WUFFS_MIMIC
 
-    bench_mimic_deflate_decode_1k,    //
-    bench_mimic_deflate_decode_10k,   //
-    bench_mimic_deflate_decode_100k,  //
+    bench_mimic_deflate_decode_1k,           //
+    bench_mimic_deflate_decode_10k,          //
+    bench_mimic_deflate_decode_100k,         //
+    bench_mimic_deflate_encode_100k_level1,  //
+    bench_mimic_deflate_encode_100k_level6,  //
 
 #endif  // WUFFS_MIMIC
 
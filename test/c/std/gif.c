@@ -194,8 +194,42 @@ void test_basic_sub_struct_initializer() {
 
 // ---------------- GIF Tests
 
-const char* wuffs_gif_decode(wuffs_base__io_buffer* dst,
-                             wuffs_base__io_buffer* src) {
+// expand_indexed_to_bgra composes an indexed pixel buffer's r rect onto a
+// BGRA pixel buffer, skipping transparent pixels, as a separate pass after
+// decoding, like example/gifplayer/gifplayer.c's compose function.
+const char* expand_indexed_to_bgra(wuffs_base__pixel_buffer* dst,
+                                   wuffs_base__pixel_buffer* src,
+                                   wuffs_base__rect_ie_u32 r) {
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(src);
+  if (palette.len != 1024) {
+    return "expand_indexed_to_bgra: missing palette";
+  }
+  wuffs_base__table_u8 dst_tab = wuffs_base__pixel_buffer__plane(dst, 0);
+  wuffs_base__table_u8 src_tab = wuffs_base__pixel_buffer__plane(src, 0);
+  uint32_t y;
+  for (y = r.min_incl_y; y < r.max_excl_y; y++) {
+    uint8_t* d = dst_tab.ptr + (y * dst_tab.stride) + (4 * r.min_incl_x);
+    uint8_t* s = src_tab.ptr + (y * src_tab.stride) + r.min_incl_x;
+    uint32_t x;
+    for (x = r.min_incl_x; x < r.max_excl_x; x++) {
+      uint8_t* c = palette.ptr + (4 * *s++);
+      if (c[3]) {
+        memcpy(d, c, 4);
+      }
+      d += 4;
+    }
+  }
+  return NULL;
+}
+
+// do_wuffs_gif_decode decodes every frame to a pixfmt pixel buffer and copies
+// each frame's rect to dst. If via_indexed, it decodes to an indexed pixel
+// buffer instead, and then composes onto a pixfmt (which must be BGRA)
+// pixel buffer as a separate pass.
+const char* do_wuffs_gif_decode(wuffs_base__io_buffer* dst,
+                                wuffs_base__io_buffer* src,
+                                wuffs_base__pixel_format pixfmt,
+                                bool via_indexed) {
   wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
   wuffs_base__status z =
       wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
@@ -211,12 +245,25 @@ const char* wuffs_gif_decode(wuffs_base__io_buffer* dst,
     return z;
   }
 
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, 0, wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+
   wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
-  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
-                                               global_pixel_slice);
+  z = wuffs_base__pixel_buffer__set_from_slice(
+      &pb, via_indexed ? &ic.pixcfg : &pc, global_pixel_slice);
   if (z) {
     return z;
   }
+  wuffs_base__pixel_buffer canvas = ((wuffs_base__pixel_buffer){});
+  if (via_indexed) {
+    z = wuffs_base__pixel_buffer__set_from_slice(&canvas, &pc,
+                                                 global_want_slice);
+    if (z) {
+      return z;
+    }
+  }
 
   uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
   if (workbuf_len > BUFFER_SIZE) {
@@ -241,8 +288,18 @@ const char* wuffs_gif_decode(wuffs_base__io_buffer* dst,
       return z;
     }
 
-    const char* msg = copy_to_io_buffer_from_pixel_buffer(
-        dst, &pb, wuffs_base__frame_config__bounds(&fc));
+    const char* msg = NULL;
+    if (via_indexed) {
+      msg = expand_indexed_to_bgra(&canvas, &pb,
+                                   wuffs_base__frame_config__bounds(&fc));
+      if (!msg) {
+        msg = copy_to_io_buffer_from_pixel_buffer(
+            dst, &canvas, wuffs_base__frame_config__bounds(&fc));
+      }
+    } else {
+      msg = copy_to_io_buffer_from_pixel_buffer(
+          dst, &pb, wuffs_base__frame_config__bounds(&fc));
+    }
     if (msg) {
       return msg;
     }
@@ -250,6 +307,24 @@ const char* wuffs_gif_decode(wuffs_base__io_buffer* dst,
   return NULL;
 }
 
+const char* wuffs_gif_decode(wuffs_base__io_buffer* dst,
+                             wuffs_base__io_buffer* src) {
+  return do_wuffs_gif_decode(
+      dst, src, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, false);
+}
+
+const char* wuffs_gif_decode_bgra(wuffs_base__io_buffer* dst,
+                                  wuffs_base__io_buffer* src) {
+  return do_wuffs_gif_decode(dst, src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                             false);
+}
+
+const char* wuffs_gif_decode_bgra_via_indexed(wuffs_base__io_buffer* dst,
+                                              wuffs_base__io_buffer* src) {
+  return do_wuffs_gif_decode(dst, src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                             true);
+}
+
 bool do_test_wuffs_gif_decode(const char* filename,
                               const char* palette_filename,
                               const char* indexes_filename,
@@ -631,6 +706,301 @@ void test_wuffs_gif_decode_animated_small() {
       want_frame_config_bounds);
 }
 
+// do_test_wuffs_gif_decode_direct decodes the GIF twice, to two indexed pixel
+// buffers: one the size of the image and one a row shorter. A frame that
+// reaches the bottom row lies wholly inside the former but is clipped by the
+// latter. Every frame must give the same pixel indexes for the rows that the
+// two pixel buffers have in common. This guards any fast path that decodes
+// unclipped frames straight into the pixel buffer's rows, instead of via the
+// staging buffer, against diverging from the clipped path.
+bool do_test_wuffs_gif_decode_direct(const char* filename) {
+  wuffs_base__io_buffer src_full = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src_full, filename)) {
+    return false;
+  }
+  wuffs_base__io_buffer src_short = src_full;
+
+  wuffs_gif__decoder dec_full = ((wuffs_gif__decoder){});
+  wuffs_gif__decoder dec_short = ((wuffs_gif__decoder){});
+  wuffs_base__status z = wuffs_gif__decoder__check_wuffs_version(
+      &dec_full, sizeof dec_full, WUFFS_VERSION);
+  if (!z) {
+    z = wuffs_gif__decoder__check_wuffs_version(&dec_short, sizeof dec_short,
+                                                WUFFS_VERSION);
+  }
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+
+  wuffs_base__io_reader reader_full = wuffs_base__io_buffer__reader(&src_full);
+  wuffs_base__io_reader reader_short =
+      wuffs_base__io_buffer__reader(&src_short);
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec_full, &ic, reader_full);
+  if (!z) {
+    z = wuffs_gif__decoder__decode_image_config(&dec_short, NULL, reader_short);
+  }
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return false;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  if (height < 2) {
+    FAIL("image is too short");
+    return false;
+  }
+
+  wuffs_base__pixel_buffer pb_full = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb_full, &ic.pixcfg,
+                                               global_want_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__pixel_config pc_short = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc_short, wuffs_base__pixel_config__pixel_format(&ic.pixcfg), 0, width,
+      height - 1);
+  wuffs_base__pixel_buffer pb_short = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb_short, &pc_short,
+                                               global_got_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+
+  // Both pixel buffers are tightly packed, so their common rows are a common
+  // prefix.
+  size_t common_len = ((size_t)width) * ((size_t)(height - 1));
+  memset(global_want_array, 0, common_len + width);
+  memset(global_got_array, 0, common_len);
+
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+
+  uint32_t i;
+  for (i = 0;; i++) {
+    z = wuffs_gif__decoder__decode_frame(&dec_full, &pb_full, reader_full,
+                                         workbuf, NULL);
+    if (z == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (z) {
+      FAIL("decode_frame #%" PRIu32 " (full): got \"%s\"", i, z);
+      return false;
+    }
+    z = wuffs_gif__decoder__decode_frame(&dec_short, &pb_short, reader_short,
+                                         workbuf, NULL);
+    if (z) {
+      FAIL("decode_frame #%" PRIu32 " (short): got \"%s\"", i, z);
+      return false;
+    }
+
+    wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+        .data = global_got_slice,
+    });
+    got.meta.wi = common_len;
+    wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+        .data = global_want_slice,
+    });
+    want.meta.wi = common_len;
+    char prefix[32];
+    snprintf(prefix, sizeof prefix, "frame #%" PRIu32 ": ", i);
+    if (!io_buffers_equal(prefix, &got, &want)) {
+      return false;
+    }
+  }
+
+  if (i == 0) {
+    FAIL("no frames were decoded");
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_gif_decode_direct_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  // This file's only frame is the whole image, and is not interlaced.
+  do_test_wuffs_gif_decode_direct("../../data/bricks-dither.gif");
+}
+
+void test_wuffs_gif_decode_direct_frame_out_of_bounds() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_direct(
+      "../../data/artificial/gif-frame-out-of-bounds.gif");
+}
+
+void test_wuffs_gif_decode_direct_hippopotamus_interlaced() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_direct("../../data/hippopotamus.interlaced.gif");
+}
+
+void test_wuffs_gif_decode_direct_muybridge() {
+  CHECK_FOCUS(__func__);
+  // This file's 15 frames are each the whole image, and are not interlaced.
+  do_test_wuffs_gif_decode_direct("../../data/muybridge.gif");
+}
+
+// wuffs_gif_decode_first_frame decodes src's first frame to pb, backed by
+// dst_memory, whose width and height are the image's divided by (1 << shift),
+// rounding up. A shift of zero means no downscaling.
+//
+// A non-zero stride_alignment means that pb's rows are padded, rounding each
+// row's stride up to a multiple of stride_alignment bytes. The palette, if
+// any, is then held separately, in dst_memory's first 1024 bytes, and the
+// padding bytes are set to 0xAA so that callers can check that the decoder
+// does not write to them.
+const char* wuffs_gif_decode_first_frame(wuffs_base__pixel_buffer* pb,
+                                         wuffs_base__slice_u8 dst_memory,
+                                         wuffs_base__io_buffer* src,
+                                         wuffs_base__pixel_format pixfmt,
+                                         uint32_t shift,
+                                         uint32_t stride_alignment) {
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    return z;
+  }
+
+  uint32_t round_up = (1 << shift) - 1;
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, 0,
+      (wuffs_base__pixel_config__width(&ic.pixcfg) + round_up) >> shift,
+      (wuffs_base__pixel_config__height(&ic.pixcfg) + round_up) >> shift);
+  if (stride_alignment == 0) {
+    z = wuffs_base__pixel_buffer__set_from_slice(pb, &pc, dst_memory);
+    if (z) {
+      return z;
+    }
+    memset(dst_memory.ptr, 0, wuffs_base__pixel_config__pixbuf_len(&pc));
+  } else {
+    size_t width_in_bytes =
+        ((size_t)wuffs_base__pixel_config__width(&pc)) *
+        (wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8);
+    size_t stride =
+        ((width_in_bytes + stride_alignment - 1) / stride_alignment) *
+        stride_alignment;
+    size_t height = wuffs_base__pixel_config__height(&pc);
+    if ((dst_memory.len < 1024) ||
+        (((dst_memory.len - 1024) / stride) < height)) {
+      return "wuffs_gif_decode_first_frame: dst_memory is too small";
+    }
+    memset(dst_memory.ptr, 0xAA, 1024 + (stride * height));
+    size_t y;
+    for (y = 0; y < height; y++) {
+      memset(dst_memory.ptr + 1024 + (y * stride), 0, width_in_bytes);
+    }
+    wuffs_base__table_u8 primary_memory = ((wuffs_base__table_u8){
+        .ptr = dst_memory.ptr + 1024,
+        .width = width_in_bytes,
+        .height = height,
+        .stride = stride,
+    });
+    wuffs_base__slice_u8 palette_memory = ((wuffs_base__slice_u8){
+        .ptr = dst_memory.ptr,
+        .len = 1024,
+    });
+    z = wuffs_base__pixel_buffer__set_from_table(pb, &pc, primary_memory,
+                                                 palette_memory);
+    if (z) {
+      return z;
+    }
+  }
+
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+  wuffs_base__decode_frame_options opts =
+      ((wuffs_base__decode_frame_options){});
+  wuffs_base__decode_frame_options__initialize(&opts, shift, false, false);
+  return wuffs_gif__decoder__decode_frame(&dec, pb, src_reader, workbuf, &opts);
+}
+
+bool do_test_wuffs_gif_decode_downscale(const char* filename,
+                                        wuffs_base__pixel_format pixfmt,
+                                        uint32_t shift) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  wuffs_base__pixel_buffer want_pb = ((wuffs_base__pixel_buffer){});
+  const char* z = wuffs_gif_decode_first_frame(&want_pb, global_want_slice,
+                                               &src, pixfmt, 0, 0);
+  if (z) {
+    FAIL("decode (full size): \"%s\"", z);
+    return false;
+  }
+  src.meta.ri = 0;
+  wuffs_base__pixel_buffer got_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_gif_decode_first_frame(&got_pb, global_got_slice, &src, pixfmt,
+                                   shift, 0);
+  if (z) {
+    FAIL("decode (downscaled): \"%s\"", z);
+    return false;
+  }
+
+  // The downscaled pixel at (x, y) should be the full size pixel at (x <<
+  // shift, y << shift).
+  size_t bytes_per_pixel = wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8;
+  wuffs_base__table_u8 want_tab = wuffs_base__pixel_buffer__plane(&want_pb, 0);
+  wuffs_base__table_u8 got_tab = wuffs_base__pixel_buffer__plane(&got_pb, 0);
+  uint32_t width = wuffs_base__pixel_config__width(&got_pb.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&got_pb.pixcfg);
+  uint32_t y;
+  for (y = 0; y < height; y++) {
+    uint32_t x;
+    for (x = 0; x < width; x++) {
+      uint8_t* g = got_tab.ptr + (y * got_tab.stride) + (x * bytes_per_pixel);
+      uint8_t* w = want_tab.ptr + ((y << shift) * want_tab.stride) +
+                   ((x << shift) * bytes_per_pixel);
+      if (memcmp(g, w, bytes_per_pixel)) {
+        FAIL("pixel at (%" PRIu32 ", %" PRIu32 "): got 0x%02X, want 0x%02X", x,
+             y, g[0], w[0]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void test_wuffs_gif_decode_downscale_2_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_downscale(
+      "../../data/bricks-dither.gif",
+      WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 1);
+}
+
+void test_wuffs_gif_decode_downscale_4_hippopotamus_interlaced() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_downscale(
+      "../../data/hippopotamus.interlaced.gif",
+      WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 2);
+}
+
+void test_wuffs_gif_decode_downscale_8_harvesters_bgra() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_downscale(
+      "../../data/harvesters.gif", WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 3);
+}
+
 void test_wuffs_gif_decode_frame_out_of_bounds() {
   CHECK_FOCUS(__func__);
   wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
@@ -835,91 +1205,964 @@ void test_wuffs_gif_decode_input_is_a_png() {
   }
 }
 
-bool do_test_wuffs_gif_num_decoded(bool frame_config) {
+void test_wuffs_gif_decode_interlace_passes() {
+  CHECK_FOCUS(__func__);
   wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
       .data = global_src_slice,
   });
-
-  if (!read_file(&src, "../../data/animated-red-blue.gif")) {
-    return false;
+  if (!read_file(&src, "../../data/hippopotamus.interlaced.gif")) {
+    return;
+  }
+  wuffs_base__pixel_buffer want_pb = ((wuffs_base__pixel_buffer){});
+  const char* z = wuffs_gif_decode_first_frame(
+      &want_pb, global_want_slice, &src,
+      WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0, 0);
+  if (z) {
+    FAIL("decode (without interlace passes): \"%s\"", z);
+    return;
   }
+  src.meta.ri = 0;
 
   wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
-  wuffs_base__status z =
-      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  z = wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
   if (z) {
     FAIL("check_wuffs_version: \"%s\"", z);
-    return false;
+    return;
   }
   wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
-
-  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
-  if (!frame_config) {
-    wuffs_base__image_config ic = ((wuffs_base__image_config){});
-    z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
-    if (z) {
-      FAIL("decode_image_config: \"%s\"", z);
-      return false;
-    }
-
-    z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
-                                                 global_pixel_slice);
-    if (z) {
-      FAIL("set_from_slice: \"%s\"", z);
-      return false;
-    }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    FAIL("decode_image_config: \"%s\"", z);
+    return;
+  }
+  wuffs_base__pixel_buffer got_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&got_pb, &ic.pixcfg,
+                                               global_got_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
   }
+  wuffs_base__pixel_buffer preview_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&preview_pb, &ic.pixcfg,
+                                               global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+  size_t pixbuf_len = wuffs_base__pixel_config__pixbuf_len(&ic.pixcfg);
+  memset(global_got_array, 0, pixbuf_len);
 
   wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
       .ptr = global_work_array,
-      .len = 64,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
   });
-
-  const char* method = frame_config ? "decode_frame_config" : "decode_frame";
-  bool end_of_data = false;
-  uint64_t want = 0;
-  while (true) {
-    uint64_t got =
-        frame_config
-            ? (uint64_t)(wuffs_gif__decoder__num_decoded_frame_configs(&dec))
-            : (uint64_t)(wuffs_gif__decoder__num_decoded_frames(&dec));
-    if (got != want) {
-      FAIL("num_%ss: got %" PRIu64 ", want %" PRIu64, method, got, want);
-      return false;
+  wuffs_base__decode_frame_options opts =
+      ((wuffs_base__decode_frame_options){});
+  wuffs_base__decode_frame_options__initialize(&opts, 0, true, false);
+
+  wuffs_base__table_u8 want_tab = wuffs_base__pixel_buffer__plane(&want_pb, 0);
+  wuffs_base__table_u8 got_tab = wuffs_base__pixel_buffer__plane(&got_pb, 0);
+  wuffs_base__table_u8 preview_tab =
+      wuffs_base__pixel_buffer__plane(&preview_pb, 0);
+  uint32_t want_row_strides[3] = {8, 4, 2};
+  int i;
+  for (i = 0; i < 3; i++) {
+    z = wuffs_gif__decoder__decode_frame(&dec, &got_pb, src_reader, workbuf,
+                                         &opts);
+    if (z != wuffs_gif__suspension__end_of_interlace_pass) {
+      FAIL("decode_frame #%d: got \"%s\", want \"%s\"", i, z,
+           wuffs_gif__suspension__end_of_interlace_pass);
+      return;
     }
-
-    if (end_of_data) {
-      break;
+    uint32_t row_stride = wuffs_gif__decoder__interlace_row_stride(&dec);
+    if (row_stride != want_row_strides[i]) {
+      FAIL("interlace_row_stride #%d: got %" PRIu32 ", want %" PRIu32, i,
+           row_stride, want_row_strides[i]);
+      return;
     }
 
-    wuffs_base__status z = NULL;
-    if (frame_config) {
-      z = wuffs_gif__decoder__decode_frame_config(&dec, NULL, src_reader);
-    } else {
-      z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
-                                           NULL);
+    // Every row_stride'th row should be complete, and replicating them should
+    // give a preview where every row is a copy of a complete row.
+    memcpy(global_pixel_array, global_got_array, pixbuf_len);
+    wuffs_base__pixel_buffer__replicate_interlaced_rows(
+        &preview_pb, wuffs_base__pixel_config__bounds(&ic.pixcfg), row_stride);
+    size_t y;
+    for (y = 0; y < got_tab.height; y++) {
+      uint8_t* want_row =
+          want_tab.ptr + ((y - (y % row_stride)) * want_tab.stride);
+      if ((y % row_stride) == 0) {
+        if (memcmp(got_tab.ptr + (y * got_tab.stride), want_row,
+                   want_tab.width)) {
+          FAIL("pass #%d: row %zu is not complete", i, y);
+          return;
+        }
+      }
+      if (memcmp(preview_tab.ptr + (y * preview_tab.stride), want_row,
+                 want_tab.width)) {
+        FAIL("pass #%d: preview row %zu is not a copy of row %zu", i, y,
+             y - (y % row_stride));
+        return;
+      }
     }
+  }
 
-    if (!z) {
-      want++;
-      continue;
-    } else if (z == wuffs_base__warning__end_of_data) {
-      end_of_data = true;
-      continue;
-    }
-    FAIL("%s: \"%s\"", method, z);
+  z = wuffs_gif__decoder__decode_frame(&dec, &got_pb, src_reader, workbuf,
+                                       &opts);
+  if (z) {
+    FAIL("decode_frame (final pass): \"%s\"", z);
+    return;
+  }
+  if (memcmp(global_got_array, global_want_array, pixbuf_len)) {
+    FAIL("final pixels differ");
+    return;
+  }
+  uint32_t row_stride = wuffs_gif__decoder__interlace_row_stride(&dec);
+  if (row_stride != 1) {
+    FAIL("interlace_row_stride (final pass): got %" PRIu32 ", want 1",
+         row_stride);
+    return;
+  }
+}
+
+bool do_test_wuffs_gif_decode_pixfmt(const char* filename,
+                                     wuffs_base__pixel_format pixfmt) {
+  // Decode the GIF twice, to an indexed pixel buffer and straight to pixfmt.
+  // For the former, expand each frame's palette indexes here, skipping the
+  // transparent ones, to build the want canvas.
+  wuffs_base__io_buffer src_indexed = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src_indexed, filename)) {
     return false;
   }
+  wuffs_base__io_buffer src_direct = src_indexed;
 
-  if (want != 4) {
-    FAIL("%s: got %" PRIu64 ", want 4", method, want);
+  wuffs_gif__decoder dec_indexed = ((wuffs_gif__decoder){});
+  wuffs_gif__decoder dec_direct = ((wuffs_gif__decoder){});
+  wuffs_base__status z = wuffs_gif__decoder__check_wuffs_version(
+      &dec_indexed, sizeof dec_indexed, WUFFS_VERSION);
+  if (!z) {
+    z = wuffs_gif__decoder__check_wuffs_version(&dec_direct, sizeof dec_direct,
+                                                WUFFS_VERSION);
+  }
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
     return false;
   }
-  return true;
-}
 
-void test_wuffs_gif_num_decoded_frame_configs() {
-  CHECK_FOCUS(__func__);
+  wuffs_base__io_reader reader_indexed =
+      wuffs_base__io_buffer__reader(&src_indexed);
+  wuffs_base__io_reader reader_direct =
+      wuffs_base__io_buffer__reader(&src_direct);
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec_indexed, &ic,
+                                              reader_indexed);
+  if (!z) {
+    z = wuffs_gif__decoder__decode_image_config(&dec_direct, NULL,
+                                                reader_direct);
+  }
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return false;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  size_t canvas_len = ((size_t)width) * ((size_t)height) * 4;
+  if (canvas_len > BUFFER_SIZE) {
+    FAIL("canvas is too large");
+    return false;
+  }
+
+  wuffs_base__pixel_buffer pb_indexed = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb_indexed, &ic.pixcfg,
+                                               global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__pixel_config pc_direct = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&pc_direct, pixfmt, 0, width, height);
+  wuffs_base__pixel_buffer pb_direct = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb_direct, &pc_direct,
+                                               global_got_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+
+  // Both canvases start with the same non-zero background, which should show
+  // through any transparent pixels.
+  memset(global_got_array, 0x55, canvas_len);
+  memset(global_want_array, 0x55, canvas_len);
+  bool swap_red_blue = (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL) ||
+                       (pixfmt == WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL);
+
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+
+  uint32_t i;
+  for (i = 0;; i++) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    z = wuffs_gif__decoder__decode_frame_config(&dec_indexed, &fc,
+                                                reader_indexed);
+    if (z == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (z) {
+      FAIL("decode_frame_config #%" PRIu32 ": got \"%s\"", i, z);
+      return false;
+    }
+
+    z = wuffs_gif__decoder__decode_frame(&dec_indexed, &pb_indexed,
+                                         reader_indexed, workbuf, NULL);
+    if (z) {
+      FAIL("decode_frame #%" PRIu32 " (indexed): got \"%s\"", i, z);
+      return false;
+    }
+    z = wuffs_gif__decoder__decode_frame(&dec_direct, &pb_direct, reader_direct,
+                                         workbuf, NULL);
+    if (z) {
+      FAIL("decode_frame #%" PRIu32 " (direct): got \"%s\"", i, z);
+      return false;
+    }
+
+    wuffs_base__slice_u8 palette =
+        wuffs_base__pixel_buffer__palette(&pb_indexed);
+    wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(&pb_indexed, 0);
+    wuffs_base__rect_ie_u32 r = wuffs_base__frame_config__bounds(&fc);
+    uint32_t y;
+    for (y = r.min_incl_y; y < r.max_excl_y; y++) {
+      uint32_t x;
+      for (x = r.min_incl_x; x < r.max_excl_x; x++) {
+        uint8_t* c = palette.ptr + (4 * tab.ptr[(y * tab.stride) + x]);
+        if (c[3] == 0) {
+          continue;
+        }
+        uint8_t* w = global_want_array + (4 * ((y * width) + x));
+        w[0] = c[swap_red_blue ? 2 : 0];
+        w[1] = c[1];
+        w[2] = c[swap_red_blue ? 0 : 2];
+        w[3] = c[3];
+      }
+    }
+
+    wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+        .data = global_got_slice,
+    });
+    got.meta.wi = canvas_len;
+    wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+        .data = global_want_slice,
+    });
+    want.meta.wi = canvas_len;
+    if (!io_buffers_equal("canvas ", &got, &want)) {
+      return false;
+    }
+  }
+
+  if (i == 0) {
+    FAIL("no frames were decoded");
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_gif_decode_pixfmt_bgra_nonpremul() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_pixfmt("../../data/animated-red-blue.gif",
+                                  WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL);
+}
+
+void test_wuffs_gif_decode_pixfmt_bgra_premul() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_pixfmt("../../data/gifplayer-muybridge.gif",
+                                  WUFFS_BASE__PIXEL_FORMAT__BGRA_PREMUL);
+}
+
+void test_wuffs_gif_decode_pixfmt_rgba_nonpremul() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_pixfmt("../../data/hippopotamus.interlaced.gif",
+                                  WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL);
+}
+
+void test_wuffs_gif_decode_pixfmt_rgba_premul() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_pixfmt(
+      "../../data/artificial/gif-frame-out-of-bounds.gif",
+      WUFFS_BASE__PIXEL_FORMAT__RGBA_PREMUL);
+}
+
+void test_wuffs_gif_decode_pixfmt_unsupported() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/bricks-dither.gif")) {
+    return;
+  }
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGR, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+  z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+  if (z != wuffs_base__error__unsupported_pixel_format) {
+    FAIL("decode_frame: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__unsupported_pixel_format);
+    return;
+  }
+}
+
+bool do_test_wuffs_gif_decode_strided(const char* filename,
+                                      wuffs_base__pixel_format pixfmt,
+                                      uint32_t shift) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  wuffs_base__pixel_buffer want_pb = ((wuffs_base__pixel_buffer){});
+  const char* z = wuffs_gif_decode_first_frame(&want_pb, global_want_slice,
+                                               &src, pixfmt, shift, 0);
+  if (z) {
+    FAIL("decode (packed): \"%s\"", z);
+    return false;
+  }
+  src.meta.ri = 0;
+  wuffs_base__pixel_buffer got_pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_gif_decode_first_frame(&got_pb, global_got_slice, &src, pixfmt,
+                                   shift, 64);
+  if (z) {
+    FAIL("decode (strided): \"%s\"", z);
+    return false;
+  }
+
+  wuffs_base__table_u8 want_tab = wuffs_base__pixel_buffer__plane(&want_pb, 0);
+  wuffs_base__table_u8 got_tab = wuffs_base__pixel_buffer__plane(&got_pb, 0);
+  if ((got_tab.stride % 64) != 0) {
+    FAIL("stride: got %zu, want a multiple of 64", got_tab.stride);
+    return false;
+  }
+  if ((got_tab.width != want_tab.width) ||
+      (got_tab.height != want_tab.height)) {
+    FAIL("plane size: got %zux%zu, want %zux%zu", got_tab.width, got_tab.height,
+         want_tab.width, want_tab.height);
+    return false;
+  }
+  size_t y;
+  for (y = 0; y < got_tab.height; y++) {
+    uint8_t* g = got_tab.ptr + (y * got_tab.stride);
+    if (memcmp(g, want_tab.ptr + (y * want_tab.stride), got_tab.width)) {
+      FAIL("row %zu: pixels differ", y);
+      return false;
+    }
+    size_t x;
+    for (x = got_tab.width; x < got_tab.stride; x++) {
+      if (g[x] != 0xAA) {
+        FAIL("row %zu: padding byte %zu was overwritten", y, x);
+        return false;
+      }
+    }
+  }
+
+  wuffs_base__slice_u8 want_palette =
+      wuffs_base__pixel_buffer__palette(&want_pb);
+  wuffs_base__slice_u8 got_palette = wuffs_base__pixel_buffer__palette(&got_pb);
+  // The palette is empty, and its ptr may be NULL, for non-indexed pixel
+  // formats. Passing NULL to memcmp is undefined behavior, even for a zero
+  // length.
+  if ((got_palette.len != want_palette.len) ||
+      ((got_palette.len > 0) &&
+       memcmp(got_palette.ptr, want_palette.ptr, got_palette.len))) {
+    FAIL("palettes differ");
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_gif_decode_strided_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_strided(
+      "../../data/bricks-dither.gif",
+      WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0);
+}
+
+void test_wuffs_gif_decode_strided_harvesters_bgra() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_strided("../../data/harvesters.gif",
+                                   WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+}
+
+void test_wuffs_gif_decode_strided_hippopotamus_downscale() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_decode_strided(
+      "../../data/hippopotamus.interlaced.gif",
+      WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 1);
+}
+
+// fill_gradient fills a width by height BGRA pixel buffer with more than 256
+// colors, so that encoding it needs a median cut palette.
+void fill_gradient(wuffs_base__pixel_buffer* pb,
+                   uint32_t width,
+                   uint32_t height) {
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(pb, 0);
+  uint32_t y;
+  for (y = 0; y < height; y++) {
+    uint8_t* p = tab.ptr + (y * tab.stride);
+    uint32_t x;
+    for (x = 0; x < width; x++) {
+      p[0] = (uint8_t)(x);
+      p[1] = (uint8_t)(y);
+      p[2] = (uint8_t)(x ^ y);
+      p[3] = 0xFF;
+      p += 4;
+    }
+  }
+}
+
+// wuffs_gif_encode_composited decodes and composites every frame of src, and
+// re-encodes each composited canvas as a frame of dst. A workbuf long enough
+// for the encoder's frame delta optimization is used if delta is true.
+const char* wuffs_gif_encode_composited(wuffs_base__io_buffer* dst,
+                                        wuffs_base__io_buffer* src,
+                                        bool delta) {
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_gif__encoder enc = ((wuffs_gif__encoder){});
+  z = wuffs_gif__encoder__check_wuffs_version(&enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+  wuffs_base__io_writer dst_writer = wuffs_base__io_buffer__writer(dst);
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    return z;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  size_t canvas_len = ((size_t)width) * ((size_t)height) * 4;
+  if (canvas_len > (BUFFER_SIZE / 3)) {
+    return "wuffs_gif_encode_composited: canvas is too large";
+  }
+  wuffs_gif__encoder__set_num_loops(&enc,
+                                    wuffs_base__image_config__num_loops(&ic));
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                               global_pixel_slice);
+  if (z) {
+    return z;
+  }
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+  wuffs_base__pixel_buffer canvas = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&canvas, &pc, global_want_slice);
+  if (z) {
+    return z;
+  }
+  memset(global_want_array, 0, canvas_len);
+  wuffs_base__animation_compositor comp =
+      ((wuffs_base__animation_compositor){});
+  z = wuffs_base__animation_compositor__initialize(
+      &comp, &canvas,
+      ((wuffs_base__slice_u8){
+          .ptr = global_want_array + (BUFFER_SIZE / 3),
+          .len = canvas_len,
+      }));
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__slice_u8 dec_workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+  wuffs_base__slice_u8 enc_workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array + (BUFFER_SIZE / 2),
+      .len = delta
+                 ? wuffs_gif__encoder__workbuf_len(&enc, width, height).max_incl
+                 : 0,
+  });
+
+  while (true) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+    if (z == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (z) {
+      return z;
+    }
+    z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, dec_workbuf,
+                                         NULL);
+    if (z) {
+      return z;
+    }
+    z = wuffs_base__animation_compositor__composite(&comp, NULL, &fc, &pb);
+    if (z) {
+      return z;
+    }
+    z = wuffs_gif__encoder__encode_frame(
+        &enc, dst_writer, &canvas, wuffs_base__frame_config__duration(&fc),
+        enc_workbuf);
+    if (z) {
+      return z;
+    }
+  }
+  return wuffs_gif__encoder__encode_trailer(&enc, dst_writer);
+}
+
+// wuffs_gif_composite_next_frame decodes and composites src's next frame,
+// returning wuffs_base__warning__end_of_data after the last one.
+const char* wuffs_gif_composite_next_frame(
+    wuffs_gif__decoder* dec,
+    wuffs_base__io_reader src_reader,
+    wuffs_base__pixel_buffer* pb,
+    wuffs_base__animation_compositor* comp,
+    wuffs_base__slice_u8 workbuf,
+    wuffs_base__frame_config* fc) {
+  wuffs_base__status z =
+      wuffs_gif__decoder__decode_frame_config(dec, fc, src_reader);
+  if (z) {
+    return z;
+  }
+  z = wuffs_gif__decoder__decode_frame(dec, pb, src_reader, workbuf, NULL);
+  if (z) {
+    return z;
+  }
+  return wuffs_base__animation_compositor__composite(comp, NULL, fc, pb);
+}
+
+bool do_test_wuffs_gif_encode_animated(const char* filename,
+                                       uint32_t want_num_frames) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = global_src_array,
+          .len = BUFFER_SIZE / 2,
+      }),
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  wuffs_base__io_buffer enc = ((wuffs_base__io_buffer){
+      .data = ((wuffs_base__slice_u8){
+          .ptr = global_src_array + (BUFFER_SIZE / 2),
+          .len = BUFFER_SIZE / 2,
+      }),
+  });
+
+  // Encoding without a workbuf writes every frame in full, so it should be
+  // larger than encoding with the frame delta optimization.
+  const char* z = wuffs_gif_encode_composited(&enc, &src, false);
+  if (z) {
+    FAIL("encode (no delta): \"%s\"", z);
+    return false;
+  }
+  size_t no_delta_len = enc.meta.wi;
+  src.meta.ri = 0;
+  enc.meta.wi = 0;
+  z = wuffs_gif_encode_composited(&enc, &src, true);
+  if (z) {
+    FAIL("encode (delta): \"%s\"", z);
+    return false;
+  }
+  if ((want_num_frames > 1) && (enc.meta.wi >= no_delta_len)) {
+    FAIL("encoded length: got %zu (delta) vs %zu (no delta), want smaller",
+         enc.meta.wi, no_delta_len);
+    return false;
+  }
+  enc.meta.closed = true;
+  src.meta.ri = 0;
+
+  // Decode the original and the re-encoded GIFs in lockstep. Their composited
+  // canvases should match exactly.
+  wuffs_gif__decoder decs[2] = {0};
+  wuffs_base__io_reader readers[2] = {
+      wuffs_base__io_buffer__reader(&src),
+      wuffs_base__io_buffer__reader(&enc),
+  };
+  wuffs_base__image_config ics[2] = {0};
+  wuffs_base__pixel_buffer pbs[2] = {0};
+  wuffs_base__pixel_buffer canvases[2] = {0};
+  wuffs_base__animation_compositor comps[2] = {0};
+  uint8_t* canvas_arrays[2] = {global_want_array, global_got_array};
+  size_t canvas_len = 0;
+  int j;
+  for (j = 0; j < 2; j++) {
+    z = wuffs_gif__decoder__check_wuffs_version(&decs[j], sizeof decs[j],
+                                                WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version #%d: \"%s\"", j, z);
+      return false;
+    }
+    z = wuffs_gif__decoder__decode_image_config(&decs[j], &ics[j], readers[j]);
+    if (z) {
+      FAIL("decode_image_config #%d: \"%s\"", j, z);
+      return false;
+    }
+    uint32_t width = wuffs_base__pixel_config__width(&ics[j].pixcfg);
+    uint32_t height = wuffs_base__pixel_config__height(&ics[j].pixcfg);
+    canvas_len = ((size_t)width) * ((size_t)height) * 4;
+    z = wuffs_base__pixel_buffer__set_from_slice(
+        &pbs[j], &ics[j].pixcfg,
+        ((wuffs_base__slice_u8){
+            .ptr = global_pixel_array + (j * (BUFFER_SIZE / 2)),
+            .len = BUFFER_SIZE / 2,
+        }));
+    if (z) {
+      FAIL("set_from_slice #%d: \"%s\"", j, z);
+      return false;
+    }
+    wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+    wuffs_base__pixel_config__initialize(
+        &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+    z = wuffs_base__pixel_buffer__set_from_slice(&canvases[j], &pc,
+                                                 ((wuffs_base__slice_u8){
+                                                     .ptr = canvas_arrays[j],
+                                                     .len = BUFFER_SIZE / 3,
+                                                 }));
+    if (z) {
+      FAIL("set_from_slice #%d: \"%s\"", j, z);
+      return false;
+    }
+    memset(canvas_arrays[j], 0, canvas_len);
+    z = wuffs_base__animation_compositor__initialize(
+        &comps[j], &canvases[j],
+        ((wuffs_base__slice_u8){
+            .ptr = canvas_arrays[j] + (BUFFER_SIZE / 3),
+            .len = canvas_len,
+        }));
+    if (z) {
+      FAIL("initialize #%d: \"%s\"", j, z);
+      return false;
+    }
+  }
+  if ((wuffs_base__pixel_config__width(&ics[0].pixcfg) !=
+       wuffs_base__pixel_config__width(&ics[1].pixcfg)) ||
+      (wuffs_base__pixel_config__height(&ics[0].pixcfg) !=
+       wuffs_base__pixel_config__height(&ics[1].pixcfg))) {
+    FAIL("image sizes differ");
+    return false;
+  }
+  if (wuffs_base__image_config__num_loops(&ics[0]) !=
+      wuffs_base__image_config__num_loops(&ics[1])) {
+    FAIL("num_loops: got %" PRIu32 ", want %" PRIu32,
+         wuffs_base__image_config__num_loops(&ics[1]),
+         wuffs_base__image_config__num_loops(&ics[0]));
+    return false;
+  }
+
+  uint32_t i;
+  for (i = 0;; i++) {
+    wuffs_base__frame_config fcs[2] = {0};
+    const char* zs[2];
+    for (j = 0; j < 2; j++) {
+      zs[j] = wuffs_gif_composite_next_frame(
+          &decs[j], readers[j], &pbs[j], &comps[j],
+          ((wuffs_base__slice_u8){
+              .ptr = global_work_array + (j * (BUFFER_SIZE / 2)),
+              .len = wuffs_base__image_config__workbuf_len(&ics[j]).max_incl,
+          }),
+          &fcs[j]);
+    }
+    if (zs[0] != zs[1]) {
+      FAIL("frame #%" PRIu32 ": got \"%s\", want \"%s\"", i, zs[1], zs[0]);
+      return false;
+    } else if (zs[0] == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (zs[0]) {
+      FAIL("frame #%" PRIu32 ": \"%s\"", i, zs[0]);
+      return false;
+    }
+    if (wuffs_base__frame_config__duration(&fcs[0]) !=
+        wuffs_base__frame_config__duration(&fcs[1])) {
+      FAIL("frame #%" PRIu32 ": durations differ", i);
+      return false;
+    }
+    if (memcmp(global_got_array, global_want_array, canvas_len)) {
+      FAIL("frame #%" PRIu32 ": canvases differ", i);
+      return false;
+    }
+  }
+  if (i != want_num_frames) {
+    FAIL("num_frames: got %" PRIu32 ", want %" PRIu32, i, want_num_frames);
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_gif_encode_animated_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_encode_animated("../../data/gifplayer-muybridge.gif", 380);
+}
+
+void test_wuffs_gif_encode_animated_red_blue() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_encode_animated("../../data/animated-red-blue.gif", 4);
+}
+
+void test_wuffs_gif_encode_median_cut() {
+  CHECK_FOCUS(__func__);
+  const uint32_t width = 256;
+  const uint32_t height = 256;
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, height);
+  wuffs_base__pixel_buffer want_pb = ((wuffs_base__pixel_buffer){});
+  wuffs_base__status z = wuffs_base__pixel_buffer__set_from_slice(
+      &want_pb, &pc, global_want_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+  fill_gradient(&want_pb, width, height);
+
+  wuffs_gif__encoder enc = ((wuffs_gif__encoder){});
+  z = wuffs_gif__encoder__check_wuffs_version(&enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_writer src_writer = wuffs_base__io_buffer__writer(&src);
+  z = wuffs_gif__encoder__encode_frame(&enc, src_writer, &want_pb, 0,
+                                       ((wuffs_base__slice_u8){}));
+  if (z) {
+    FAIL("encode_frame: \"%s\"", z);
+    return;
+  }
+  z = wuffs_gif__encoder__encode_trailer(&enc, src_writer);
+  if (z) {
+    FAIL("encode_trailer: \"%s\"", z);
+    return;
+  }
+  src.meta.closed = true;
+
+  wuffs_base__pixel_buffer got_pb = ((wuffs_base__pixel_buffer){});
+  const char* zz = wuffs_gif_decode_first_frame(
+      &got_pb, global_got_slice, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+      0, 0);
+  if (zz) {
+    FAIL("decode: \"%s\"", zz);
+    return;
+  }
+
+  // The median cut palette is lossy, but each channel should be close.
+  wuffs_base__table_u8 want_tab = wuffs_base__pixel_buffer__plane(&want_pb, 0);
+  wuffs_base__table_u8 got_tab = wuffs_base__pixel_buffer__plane(&got_pb, 0);
+  uint64_t total_error = 0;
+  size_t n = ((size_t)width) * ((size_t)height) * 4;
+  size_t i;
+  for (i = 0; i < n; i++) {
+    int e = ((int)(got_tab.ptr[i])) - ((int)(want_tab.ptr[i]));
+    total_error += (e < 0) ? -e : e;
+  }
+  uint64_t want_max_mean_error = 16;
+  if ((total_error / n) > want_max_mean_error) {
+    FAIL("mean error: got %" PRIu64 ", want <= %" PRIu64, total_error / n,
+         want_max_mean_error);
+    return;
+  }
+}
+
+void test_wuffs_gif_encode_short_writes() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 256, 256);
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  wuffs_base__status z =
+      wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+  fill_gradient(&pb, 256, 256);
+
+  // Encode the same frame twice: once in one go and once with many short
+  // writes. The two outputs should be identical.
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  int i;
+  for (i = 0; i < 2; i++) {
+    wuffs_base__io_buffer* dst = i ? &got : &want;
+    uint64_t wlimit = i ? 13 : 0;
+    wuffs_gif__encoder enc = ((wuffs_gif__encoder){});
+    z = wuffs_gif__encoder__check_wuffs_version(&enc, sizeof enc,
+                                                WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return;
+    }
+    int num_iters = 0;
+    while (true) {
+      num_iters++;
+      wuffs_base__io_writer dst_writer = wuffs_base__io_buffer__writer(dst);
+      if (wlimit) {
+        set_writer_limit(&dst_writer, wlimit);
+      }
+      size_t old_wi = dst->meta.wi;
+      z = wuffs_gif__encoder__encode_frame(&enc, dst_writer, &pb, 0,
+                                           ((wuffs_base__slice_u8){}));
+      if (!z) {
+        break;
+      }
+      if (z != wuffs_base__suspension__short_write) {
+        FAIL("encode_frame: got \"%s\", want \"%s\"", z,
+             wuffs_base__suspension__short_write);
+        return;
+      }
+      if (dst->meta.wi == old_wi) {
+        FAIL("no progress was made");
+        return;
+      }
+    }
+    if (wlimit && (num_iters <= 1)) {
+      FAIL("num_iters: got %d, want > 1", num_iters);
+      return;
+    }
+  }
+
+  if ((got.meta.wi != want.meta.wi) ||
+      memcmp(got.data.ptr, want.data.ptr, got.meta.wi)) {
+    FAIL("outputs differ: got %zu bytes, want %zu bytes", got.meta.wi,
+         want.meta.wi);
+    return;
+  }
+}
+
+void test_wuffs_gif_encode_single_frame_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_encode_animated("../../data/bricks-dither.gif", 1);
+}
+
+bool do_test_wuffs_gif_num_decoded(bool frame_config) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/animated-red-blue.gif")) {
+    return false;
+  }
+
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  if (!frame_config) {
+    wuffs_base__image_config ic = ((wuffs_base__image_config){});
+    z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z) {
+      FAIL("decode_image_config: \"%s\"", z);
+      return false;
+    }
+
+    z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                                 global_pixel_slice);
+    if (z) {
+      FAIL("set_from_slice: \"%s\"", z);
+      return false;
+    }
+  }
+
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = 64,
+  });
+
+  const char* method = frame_config ? "decode_frame_config" : "decode_frame";
+  bool end_of_data = false;
+  uint64_t want = 0;
+  while (true) {
+    uint64_t got =
+        frame_config
+            ? (uint64_t)(wuffs_gif__decoder__num_decoded_frame_configs(&dec))
+            : (uint64_t)(wuffs_gif__decoder__num_decoded_frames(&dec));
+    if (got != want) {
+      FAIL("num_%ss: got %" PRIu64 ", want %" PRIu64, method, got, want);
+      return false;
+    }
+
+    if (end_of_data) {
+      break;
+    }
+
+    wuffs_base__status z = NULL;
+    if (frame_config) {
+      z = wuffs_gif__decoder__decode_frame_config(&dec, NULL, src_reader);
+    } else {
+      z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                           NULL);
+    }
+
+    if (!z) {
+      want++;
+      continue;
+    } else if (z == wuffs_base__warning__end_of_data) {
+      end_of_data = true;
+      continue;
+    }
+    FAIL("%s: \"%s\"", method, z);
+    return false;
+  }
+
+  if (want != 4) {
+    FAIL("%s: got %" PRIu64 ", want 4", method, want);
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_gif_num_decoded_frame_configs() {
+  CHECK_FOCUS(__func__);
   do_test_wuffs_gif_num_decoded(true);
 }
 
@@ -1025,88 +2268,347 @@ bool do_test_wuffs_gif_io_position(bool chunked) {
       FAIL("io_position #%d: got %" PRIu64 ", was too small", i, pos_got);
       return false;
     }
-    uint64_t src_ptr_offset = pos_got - src.meta.pos;
-    if (src_ptr_offset >= src.meta.wi) {
-      FAIL("io_position #%d: got %" PRIu64 ", was too large", i, pos_got);
+    uint64_t src_ptr_offset = pos_got - src.meta.pos;
+    if (src_ptr_offset >= src.meta.wi) {
+      FAIL("io_position #%d: got %" PRIu64 ", was too large", i, pos_got);
+      return false;
+    }
+    uint8_t x = src.data.ptr[src_ptr_offset];
+    if (x != 0x21) {
+      FAIL("Image Descriptor byte #%d: got 0x%02X, want 0x2C", i, (int)x);
+      return false;
+    }
+  }
+
+  z = wuffs_gif__decoder__decode_frame_config(&dec, NULL, src_reader);
+  if (z != wuffs_base__warning__end_of_data) {
+    FAIL("decode_frame_config EOD: \"%s\"", z);
+    return false;
+  }
+
+  // If we're chunked, we've discarded some source bytes due to an earlier
+  // wuffs_base__io_buffer__compact call. We won't bother testing
+  // wuffs_gif__decoder__restart_frame in that case.
+  if (chunked) {
+    return true;
+  }
+
+  for (i = 0; i < 4; i++) {
+    src.meta.ri = pos_wants[i];
+
+    z = wuffs_gif__decoder__restart_frame(
+        &dec, i, wuffs_base__frame_config__io_position(&fcs[i]));
+    if (z) {
+      FAIL("restart_frame #%d: \"%s\"", i, z);
+      return false;
+    }
+
+    int j;
+    for (j = i; j < 4; j++) {
+      wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+      z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+      if (z) {
+        FAIL("decode_frame_config #%d, #%d: \"%s\"", i, j, z);
+        return false;
+      }
+
+      uint64_t index_got = wuffs_base__frame_config__index(&fc);
+      uint64_t index_want = j;
+      if (index_got != index_want) {
+        FAIL("index #%d, #%d: got %" PRIu64 ", want %" PRIu64, i, j, index_got,
+             index_want);
+        return false;
+      }
+
+      uint32_t width_got = wuffs_base__frame_config__width(&fc);
+      uint32_t width_want = width_wants[j];
+      if (width_got != width_want) {
+        FAIL("width #%d, #%d: got %" PRIu32 ", want %" PRIu32, i, j, width_got,
+             width_want);
+        return false;
+      }
+    }
+
+    z = wuffs_gif__decoder__decode_frame_config(&dec, NULL, src_reader);
+    if (z != wuffs_base__warning__end_of_data) {
+      FAIL("decode_frame_config EOD #%d: \"%s\"", i, z);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void test_wuffs_gif_io_position_one_chunk() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_io_position(false);
+}
+
+void test_wuffs_gif_io_position_two_chunks() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_io_position(true);
+}
+
+// gif_frame_index_entry is a compact summary of one frame of an animated GIF:
+// enough to schedule the frame and to seek to it via restart_frame.
+typedef struct {
+  uint64_t io_position;
+  wuffs_base__rect_ie_u32 bounds;
+  wuffs_base__flicks duration;
+} gif_frame_index_entry;
+
+#define GIF_FRAME_INDEX_LEN 4096
+
+gif_frame_index_entry global_gif_frame_index[GIF_FRAME_INDEX_LEN];
+
+// wuffs_gif_scan fills global_gif_frame_index, and sets *num_frames and
+// *total_duration, by calling decode_frame_config and skip_frame. It does not
+// decode any pixels.
+const char* wuffs_gif_scan(uint64_t* num_frames,
+                           wuffs_base__flicks* total_duration,
+                           wuffs_base__io_buffer* src) {
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+
+  *num_frames = 0;
+  *total_duration = 0;
+  while (true) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+    if (z == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (z) {
+      return z;
+    }
+    z = wuffs_gif__decoder__skip_frame(&dec, src_reader);
+    if (z) {
+      return z;
+    }
+
+    if (*num_frames >= GIF_FRAME_INDEX_LEN) {
+      return "too many frames";
+    }
+    gif_frame_index_entry* e = &global_gif_frame_index[*num_frames];
+    e->io_position = wuffs_base__frame_config__io_position(&fc);
+    e->bounds = wuffs_base__frame_config__bounds(&fc);
+    e->duration = wuffs_base__frame_config__duration(&fc);
+    *total_duration += e->duration;
+    (*num_frames)++;
+  }
+  return NULL;
+}
+
+bool do_test_wuffs_gif_scan(const char* filename, uint64_t want_num_frames) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  uint64_t num_frames = 0;
+  wuffs_base__flicks total_duration = 0;
+  const char* msg = wuffs_gif_scan(&num_frames, &total_duration, &src);
+  if (msg) {
+    FAIL("wuffs_gif_scan: \"%s\"", msg);
+    return false;
+  }
+  if (num_frames != want_num_frames) {
+    FAIL("num_frames: got %" PRIu64 ", want %" PRIu64, num_frames,
+         want_num_frames);
+    return false;
+  }
+
+  // Decode every frame's pixels, and check that the frame configs match the
+  // scanned index.
+  wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+  wuffs_base__status z =
+      wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  src.meta.ri = 0;
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    FAIL("decode_image_config: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                               global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+  });
+
+  wuffs_base__flicks want_total_duration = 0;
+  uint64_t i;
+  for (i = 0;; i++) {
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+    if (z == wuffs_base__warning__end_of_data) {
+      break;
+    } else if (z) {
+      FAIL("decode_frame_config #%" PRIu64 ": \"%s\"", i, z);
+      return false;
+    }
+    if (i >= num_frames) {
+      FAIL("too many decoded frames");
       return false;
     }
-    uint8_t x = src.data.ptr[src_ptr_offset];
-    if (x != 0x21) {
-      FAIL("Image Descriptor byte #%d: got 0x%02X, want 0x2C", i, (int)x);
+    gif_frame_index_entry* e = &global_gif_frame_index[i];
+    wuffs_base__rect_ie_u32 bounds = wuffs_base__frame_config__bounds(&fc);
+    if ((e->io_position != wuffs_base__frame_config__io_position(&fc)) ||
+        !wuffs_base__rect_ie_u32__equals(&e->bounds, bounds) ||
+        (e->duration != wuffs_base__frame_config__duration(&fc))) {
+      FAIL("frame #%" PRIu64 ": scanned and decoded frame configs differ", i);
       return false;
     }
-  }
+    want_total_duration += e->duration;
 
-  z = wuffs_gif__decoder__decode_frame_config(&dec, NULL, src_reader);
-  if (z != wuffs_base__warning__end_of_data) {
-    FAIL("decode_frame_config EOD: \"%s\"", z);
+    z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+    if (z) {
+      FAIL("decode_frame #%" PRIu64 ": \"%s\"", i, z);
+      return false;
+    }
+  }
+  if (i != num_frames) {
+    FAIL("num decoded frames: got %" PRIu64 ", want %" PRIu64, i, num_frames);
     return false;
   }
-
-  // If we're chunked, we've discarded some source bytes due to an earlier
-  // wuffs_base__io_buffer__compact call. We won't bother testing
-  // wuffs_gif__decoder__restart_frame in that case.
-  if (chunked) {
-    return true;
+  if (total_duration != want_total_duration) {
+    FAIL("total_duration: got %" PRIu64 ", want %" PRIu64, total_duration,
+         want_total_duration);
+    return false;
   }
+  return true;
+}
 
-  for (i = 0; i < 4; i++) {
-    src.meta.ri = pos_wants[i];
+void test_wuffs_gif_scan_1000_frames() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_scan("../../data/artificial/gif-1000-frames.gif", 1000);
+}
 
-    z = wuffs_gif__decoder__restart_frame(
-        &dec, i, wuffs_base__frame_config__io_position(&fcs[i]));
-    if (z) {
-      FAIL("restart_frame #%d: \"%s\"", i, z);
-      return false;
-    }
+void test_wuffs_gif_scan_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_gif_scan("../../data/gifplayer-muybridge.gif", 380);
+}
 
-    int j;
-    for (j = i; j < 4; j++) {
-      wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
-      z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
-      if (z) {
-        FAIL("decode_frame_config #%d, #%d: \"%s\"", i, j, z);
-        return false;
-      }
+void test_wuffs_gif_skip_frame() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/animated-red-blue.gif")) {
+    return;
+  }
 
-      uint64_t index_got = wuffs_base__frame_config__index(&fc);
-      uint64_t index_want = j;
-      if (index_got != index_want) {
-        FAIL("index #%d, #%d: got %" PRIu64 ", want %" PRIu64, i, j, index_got,
-             index_want);
-        return false;
+  // Decode frame #2 twice: with one decoder, after decoding frames #0 and #1,
+  // and with another, after skipping them. The latter's skip_frame calls
+  // implicitly decode the frame configs.
+  uint8_t* frames[2] = {global_got_array, global_want_array};
+  wuffs_base__rect_ie_u32 bounds = ((wuffs_base__rect_ie_u32){});
+  uint32_t stride = 0;
+  int d;
+  for (d = 0; d < 2; d++) {
+    wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+    wuffs_base__status z = wuffs_gif__decoder__check_wuffs_version(
+        &dec, sizeof dec, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return;
+    }
+    src.meta.ri = 0;
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+    wuffs_base__image_config ic = ((wuffs_base__image_config){});
+    z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z) {
+      FAIL("decode_image_config: \"%s\"", z);
+      return;
+    }
+    memset(frames[d], 0, BUFFER_SIZE);
+    wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+    z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                                 ((wuffs_base__slice_u8){
+                                                     .ptr = frames[d],
+                                                     .len = BUFFER_SIZE,
+                                                 }));
+    if (z) {
+      FAIL("set_from_slice: \"%s\"", z);
+      return;
+    }
+    wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+        .ptr = global_work_array,
+        .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+    });
+
+    int i;
+    for (i = 0; i < 2; i++) {
+      if (d == 0) {
+        z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                             NULL);
+      } else {
+        z = wuffs_gif__decoder__skip_frame(&dec, src_reader);
       }
-
-      uint32_t width_got = wuffs_base__frame_config__width(&fc);
-      uint32_t width_want = width_wants[j];
-      if (width_got != width_want) {
-        FAIL("width #%d, #%d: got %" PRIu32 ", want %" PRIu32, i, j, width_got,
-             width_want);
-        return false;
+      if (z) {
+        FAIL("d=%d, frame #%d: \"%s\"", d, i, z);
+        return;
       }
     }
+    if (wuffs_gif__decoder__num_decoded_frames(&dec) != 2) {
+      FAIL("d=%d: num_decoded_frames: got %" PRIu64 ", want 2", d,
+           wuffs_gif__decoder__num_decoded_frames(&dec));
+      return;
+    }
 
-    z = wuffs_gif__decoder__decode_frame_config(&dec, NULL, src_reader);
-    if (z != wuffs_base__warning__end_of_data) {
-      FAIL("decode_frame_config EOD #%d: \"%s\"", i, z);
-      return false;
+    wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+    z = wuffs_gif__decoder__decode_frame_config(&dec, &fc, src_reader);
+    if (!z) {
+      z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                           NULL);
+    }
+    if (z) {
+      FAIL("d=%d, frame #2: \"%s\"", d, z);
+      return;
+    }
+    bounds = wuffs_base__frame_config__bounds(&fc);
+    stride = wuffs_base__pixel_config__width(&ic.pixcfg);
+    if (wuffs_base__rect_ie_u32__is_empty(&bounds)) {
+      FAIL("d=%d, frame #2: empty bounds", d);
+      return;
     }
   }
 
-  return true;
-}
-
-void test_wuffs_gif_io_position_one_chunk() {
-  CHECK_FOCUS(__func__);
-  do_test_wuffs_gif_io_position(false);
-}
-
-void test_wuffs_gif_io_position_two_chunks() {
-  CHECK_FOCUS(__func__);
-  do_test_wuffs_gif_io_position(true);
+  // The palettes should be equal.
+  if (memcmp(global_got_array, global_want_array, 1024)) {
+    FAIL("palettes differ");
+    return;
+  }
+  // The frame #2 pixels, within its bounds, should be equal.
+  uint32_t y;
+  for (y = bounds.min_incl_y; y < bounds.max_excl_y; y++) {
+    size_t offset = 1024 + (y * stride) + bounds.min_incl_x;
+    if (memcmp(global_got_array + offset, global_want_array + offset,
+               wuffs_base__rect_ie_u32__width(&bounds))) {
+      FAIL("frame #2 pixels differ, at row %" PRIu32, y);
+      return;
+    }
+  }
 }
 
-  // ---------------- Mimic Tests
+// ---------------- Mimic Tests
 
 #ifdef WUFFS_MIMIC
 
@@ -1271,7 +2773,263 @@ void bench_wuffs_gif_decode_1000k() {
   do_bench_gif_decode(wuffs_gif_decode, "../../data/harvesters.gif", 1);
 }
 
-  // ---------------- Mimic Benches
+void bench_wuffs_gif_decode_1000k_bgra() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_decode(wuffs_gif_decode_bgra, "../../data/harvesters.gif", 1);
+}
+
+void bench_wuffs_gif_decode_1000k_bgra_via_indexed() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_decode(wuffs_gif_decode_bgra_via_indexed,
+                      "../../data/harvesters.gif", 1);
+}
+
+// do_bench_gif_decode_interlaced measures the latency of decoding an
+// interlaced GIF's first frame, either until its first interlace pass is
+// complete, for a coarse preview, or until all passes are complete.
+bool do_bench_gif_decode_interlaced(bool first_pass_only,
+                                    const char* filename,
+                                    uint64_t iters_unscaled) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    src.meta.ri = 0;
+    wuffs_gif__decoder dec = ((wuffs_gif__decoder){});
+    const char* z = wuffs_gif__decoder__check_wuffs_version(&dec, sizeof dec,
+                                                            WUFFS_VERSION);
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+    wuffs_base__image_config ic = ((wuffs_base__image_config){});
+    if (!z) {
+      z = wuffs_gif__decoder__decode_image_config(&dec, &ic, src_reader);
+    }
+    wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+    if (!z) {
+      z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                                   global_pixel_slice);
+    }
+    wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+        .ptr = global_work_array,
+        .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+    });
+    wuffs_base__decode_frame_options opts =
+        ((wuffs_base__decode_frame_options){});
+    wuffs_base__decode_frame_options__initialize(&opts, 0, first_pass_only,
+                                                 false);
+    if (!z) {
+      z = wuffs_gif__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                           &opts);
+      if (first_pass_only &&
+          (z == wuffs_gif__suspension__end_of_interlace_pass)) {
+        z = NULL;
+      }
+    }
+    if (z) {
+      FAIL("%s", z);
+      return false;
+    }
+    n_bytes += src.meta.ri;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_gif_decode_interlaced_all_passes() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_decode_interlaced(
+      false, "../../data/hippopotamus.interlaced.gif", 1000);
+}
+
+void bench_wuffs_gif_decode_interlaced_first_pass() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_decode_interlaced(true, "../../data/hippopotamus.interlaced.gif",
+                                 1000);
+}
+
+// do_bench_gif_encode encodes the first frame of filename, decoded as BGRA,
+// or if filename is NULL, a gradient that needs a median cut palette. The
+// throughput is measured in terms of source pixel bytes.
+bool do_bench_gif_encode(const char* filename, uint64_t iters_unscaled) {
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  if (filename) {
+    wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+        .data = global_src_slice,
+    });
+    if (!read_file(&src, filename)) {
+      return false;
+    }
+    const char* z = wuffs_gif_decode_first_frame(
+        &pb, global_want_slice, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+        0, 0);
+    if (z) {
+      FAIL("decode: \"%s\"", z);
+      return false;
+    }
+  } else {
+    wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+    wuffs_base__pixel_config__initialize(
+        &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 256, 256);
+    wuffs_base__status z =
+        wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_want_slice);
+    if (z) {
+      FAIL("set_from_slice: \"%s\"", z);
+      return false;
+    }
+    fill_gradient(&pb, 256, 256);
+  }
+  wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(&pb, 0);
+
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    wuffs_gif__encoder enc = ((wuffs_gif__encoder){});
+    wuffs_base__status z = wuffs_gif__encoder__check_wuffs_version(
+        &enc, sizeof enc, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return false;
+    }
+    wuffs_base__io_writer got_writer = wuffs_base__io_buffer__writer(&got);
+    z = wuffs_gif__encoder__encode_frame(&enc, got_writer, &pb, 0,
+                                         ((wuffs_base__slice_u8){}));
+    if (z) {
+      FAIL("encode_frame: \"%s\"", z);
+      return false;
+    }
+    n_bytes += tab.width * tab.height;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_gif_encode_1000k_bgra() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_encode("../../data/harvesters.gif", 1);
+}
+
+void bench_wuffs_gif_encode_256k_median_cut() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_encode(NULL, 3);
+}
+
+// do_bench_gif_scan's throughput numbers count src bytes scanned.
+bool do_bench_gif_scan(const char* filename, uint64_t iters_unscaled) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    src.meta.ri = 0;
+    uint64_t num_frames = 0;
+    wuffs_base__flicks total_duration = 0;
+    const char* msg = wuffs_gif_scan(&num_frames, &total_duration, &src);
+    if (msg) {
+      FAIL("%s", msg);
+      return false;
+    }
+    n_bytes += src.meta.ri;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_gif_scan_1000_frames() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_scan("../../data/artificial/gif-1000-frames.gif", 300);
+}
+
+void bench_wuffs_gif_scan_gifplayer_muybridge() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_scan("../../data/gifplayer-muybridge.gif", 300);
+}
+
+// do_bench_gif_thumbnail decodes the first frame of a GIF image to a BGRA
+// thumbnail that is 1/8 of the image's width and height. It either downscales
+// while decoding or, to compare against, decodes at full size and then drops
+// the rows and columns that the thumbnail doesn't need.
+bool do_bench_gif_thumbnail(bool downscale,
+                            const char* filename,
+                            uint64_t iters_unscaled) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  const uint32_t shift = 3;
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    src.meta.ri = 0;
+    wuffs_base__pixel_buffer got_pb = ((wuffs_base__pixel_buffer){});
+    const char* z = wuffs_gif_decode_first_frame(
+        &got_pb, global_got_slice, &src,
+        WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, downscale ? shift : 0, 0);
+    if (z) {
+      FAIL("decode: \"%s\"", z);
+      return false;
+    }
+
+    if (!downscale) {
+      wuffs_base__table_u8 full_tab =
+          wuffs_base__pixel_buffer__plane(&got_pb, 0);
+      uint32_t width = (full_tab.width / 4 + 7) >> shift;
+      uint32_t height = (full_tab.height + 7) >> shift;
+      uint8_t* d = global_want_array;
+      uint32_t y;
+      for (y = 0; y < height; y++) {
+        uint8_t* s = full_tab.ptr + ((y << shift) * full_tab.stride);
+        uint32_t x;
+        for (x = 0; x < width; x++) {
+          memcpy(d, s + ((x << shift) * 4), 4);
+          d += 4;
+        }
+      }
+      n_bytes += d - global_want_array;
+    } else {
+      n_bytes += wuffs_base__pixel_config__pixbuf_len(&got_pb.pixcfg);
+    }
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_gif_thumbnail_1000k_downscale() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_thumbnail(true, "../../data/harvesters.gif", 1);
+}
+
+void bench_wuffs_gif_thumbnail_1000k_resize() {
+  CHECK_FOCUS(__func__);
+  do_bench_gif_thumbnail(false, "../../data/harvesters.gif", 1);
+}
+
+// ---------------- Mimic Benches
 
 #ifdef WUFFS_MIMIC
 
@@ -1320,20 +3078,44 @@ proc tests[] = {
     test_basic_status_used_package,             //
     test_basic_sub_struct_initializer,          //
 
-    test_wuffs_gif_call_sequence,                            //
-    test_wuffs_gif_decode_animated_big,                      //
-    test_wuffs_gif_decode_animated_medium,                   //
-    test_wuffs_gif_decode_animated_small,                    //
-    test_wuffs_gif_decode_frame_out_of_bounds,               //
-    test_wuffs_gif_decode_input_is_a_gif,                    //
-    test_wuffs_gif_decode_input_is_a_gif_many_big_reads,     //
-    test_wuffs_gif_decode_input_is_a_gif_many_medium_reads,  //
-    test_wuffs_gif_decode_input_is_a_gif_many_small_reads,   //
-    test_wuffs_gif_decode_input_is_a_png,                    //
-    test_wuffs_gif_num_decoded_frame_configs,                //
-    test_wuffs_gif_num_decoded_frames,                       //
-    test_wuffs_gif_io_position_one_chunk,                    //
-    test_wuffs_gif_io_position_two_chunks,                   //
+    test_wuffs_gif_call_sequence,                               //
+    test_wuffs_gif_decode_animated_big,                         //
+    test_wuffs_gif_decode_animated_medium,                      //
+    test_wuffs_gif_decode_animated_small,                       //
+    test_wuffs_gif_decode_direct_bricks_dither,                 //
+    test_wuffs_gif_decode_direct_frame_out_of_bounds,           //
+    test_wuffs_gif_decode_direct_hippopotamus_interlaced,       //
+    test_wuffs_gif_decode_direct_muybridge,                     //
+    test_wuffs_gif_decode_downscale_2_bricks_dither,            //
+    test_wuffs_gif_decode_downscale_4_hippopotamus_interlaced,  //
+    test_wuffs_gif_decode_downscale_8_harvesters_bgra,          //
+    test_wuffs_gif_decode_frame_out_of_bounds,                  //
+    test_wuffs_gif_decode_input_is_a_gif,                       //
+    test_wuffs_gif_decode_input_is_a_gif_many_big_reads,        //
+    test_wuffs_gif_decode_input_is_a_gif_many_medium_reads,     //
+    test_wuffs_gif_decode_input_is_a_gif_many_small_reads,      //
+    test_wuffs_gif_decode_input_is_a_png,                       //
+    test_wuffs_gif_decode_interlace_passes,                     //
+    test_wuffs_gif_decode_pixfmt_bgra_nonpremul,                //
+    test_wuffs_gif_decode_pixfmt_bgra_premul,                   //
+    test_wuffs_gif_decode_pixfmt_rgba_nonpremul,                //
+    test_wuffs_gif_decode_pixfmt_rgba_premul,                   //
+    test_wuffs_gif_decode_pixfmt_unsupported,                   //
+    test_wuffs_gif_decode_strided_bricks_dither,                //
+    test_wuffs_gif_decode_strided_harvesters_bgra,              //
+    test_wuffs_gif_decode_strided_hippopotamus_downscale,       //
+    test_wuffs_gif_encode_animated_gifplayer_muybridge,         //
+    test_wuffs_gif_encode_animated_red_blue,                    //
+    test_wuffs_gif_encode_median_cut,                           //
+    test_wuffs_gif_encode_short_writes,                         //
+    test_wuffs_gif_encode_single_frame_bricks_dither,           //
+    test_wuffs_gif_num_decoded_frame_configs,                   //
+    test_wuffs_gif_num_decoded_frames,                          //
+    test_wuffs_gif_io_position_one_chunk,                       //
+    test_wuffs_gif_io_position_two_chunks,                      //
+    test_wuffs_gif_scan_1000_frames,                            //
+    test_wuffs_gif_scan_gifplayer_muybridge,                    //
+    test_wuffs_gif_skip_frame,                                  //
 
 #ifdef WUFFS_MIMIC
 
@@ -1358,11 +3140,21 @@ proc tests[] = {
 // The empty comments forces clang-format to place one element per line.
 proc benches[] = {
 
-    bench_wuffs_gif_decode_1k_bw,     //
-    bench_wuffs_gif_decode_1k_color,  //
-    bench_wuffs_gif_decode_10k,       //
-    bench_wuffs_gif_decode_100k,      //
-    bench_wuffs_gif_decode_1000k,     //
+    bench_wuffs_gif_decode_1k_bw,                   //
+    bench_wuffs_gif_decode_1k_color,                //
+    bench_wuffs_gif_decode_10k,                     //
+    bench_wuffs_gif_decode_100k,                    //
+    bench_wuffs_gif_decode_1000k,                   //
+    bench_wuffs_gif_decode_1000k_bgra,              //
+    bench_wuffs_gif_decode_1000k_bgra_via_indexed,  //
+    bench_wuffs_gif_decode_interlaced_all_passes,   //
+    bench_wuffs_gif_decode_interlaced_first_pass,   //
+    bench_wuffs_gif_encode_1000k_bgra,              //
+    bench_wuffs_gif_encode_256k_median_cut,         //
+    bench_wuffs_gif_scan_1000_frames,               //
+    bench_wuffs_gif_scan_gifplayer_muybridge,       //
+    bench_wuffs_gif_thumbnail_1000k_downscale,      //
+    bench_wuffs_gif_thumbnail_1000k_resize,         //
 
 #ifdef WUFFS_MIMIC
 
@@ -0,0 +1,1503 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test" or "wuffs
+bench" commands. These commands take an optional "-mimic" flag to check that
+Wuffs' output mimics (i.e. exactly matches) other libraries' output, such as
+giflib for GIF, libpng for PNG, etc.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror jpeg.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+Add the "wuffs mimic cflags" (everything after the colon below) to the C
+compiler flags (after the .c file) to run the mimic tests.
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench". Combine these changes with the
+"wuffs mimic cflags" to run the mimic benchmarks.
+*/
+
+// !! wuffs mimic cflags: -DWUFFS_MIMIC -ljpeg
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+//
+// The Adler-32 checksum summarizes the expected pixels, which were produced
+// by libjpeg-turbo, so that the test data doesn't need a copy of each image's
+// pixels.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__ADLER32
+#define WUFFS_CONFIG__MODULE__BASE
+#define WUFFS_CONFIG__MODULE__JPEG
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../../release/c/wuffs-unsupported-snapshot.h"
+#include "../testlib/testlib.c"
+#ifdef WUFFS_MIMIC
+#include "../mimiclib/jpeg.c"
+#endif
+
+// ---------------- IDCT and Color Conversion Tests
+
+// The wuffs_base__slice_u8__idct_8x8 and wuffs_base__slice_u8__convert_ycc
+// functions aren't specific to the std/jpeg code, but JPEG is the only format
+// that uses them so far, so putting their tests and benches here is as good
+// as any other place.
+
+// fill_dct_block fills coeffs with 64 pseudo-random i16le coefficients, in
+// natural order, whose magnitudes shrink with frequency, like those of real
+// images, and quant with u16le quantization factors that grow with frequency.
+void fill_dct_block(uint8_t* coeffs, uint8_t* quant, uint32_t seed) {
+  uint32_t x = seed;
+  int i;
+  for (i = 0; i < 64; i++) {
+    int u = i & 7;
+    int v = i >> 3;
+    x = (x * 1103515245) + 12345;
+    int32_t q = 1 + (int32_t)((x >> 16) & 7) + (2 * (u + v));
+    x = (x * 1103515245) + 12345;
+    int32_t range = (i == 0) ? (1024 / q) : (256 / (q * (1 + u + v)));
+    int32_t c = ((int32_t)((x >> 16) % (uint32_t)(2 * range + 1))) - range;
+    wuffs_base__store_u16le(coeffs + (2 * i), (uint16_t)(c));
+    wuffs_base__store_u16le(quant + (2 * i), (uint16_t)(q));
+  }
+}
+
+// fill_hostile_dct_block fills coeffs and quant with arbitrary, rather than
+// realistic, values, many of them at the extremes of their 16 bit ranges.
+void fill_hostile_dct_block(uint8_t* coeffs, uint8_t* quant, uint32_t seed) {
+  static const uint16_t extremes[8] = {
+      0x0000, 0x0001, 0x00FF, 0x03E8, 0x7FFF, 0x8000, 0xFC18, 0xFFFF,
+  };
+  uint32_t x = seed;
+  int i;
+  for (i = 0; i < 64; i++) {
+    x = (x * 1103515245) + 12345;
+    uint16_t c = (uint16_t)(x >> 16);
+    x = (x * 1103515245) + 12345;
+    uint16_t q = (uint16_t)(x >> 16);
+    if (seed & 1) {
+      c = extremes[c & 7];
+    }
+    if (seed & 2) {
+      q = extremes[q & 7];
+    }
+    wuffs_base__store_u16le(coeffs + (2 * i), c);
+    wuffs_base__store_u16le(quant + (2 * i), q);
+  }
+}
+
+void test_wuffs_base_idct_8x8_hostile() {
+  CHECK_FOCUS(__func__);
+
+  uint8_t coeffs[128];
+  uint8_t quant[128];
+  uint8_t got[8 * 13];
+  uint8_t want[8 * 13];
+  wuffs_base__slice_u8 c = ((wuffs_base__slice_u8){.ptr = coeffs, .len = 128});
+  wuffs_base__slice_u8 q = ((wuffs_base__slice_u8){.ptr = quant, .len = 128});
+
+  // Extreme inputs must not overflow (which -fsanitize=undefined would
+  // catch), and the SIMD implementation, if any, must still match the
+  // fallback.
+  uint32_t seed;
+  for (seed = 0; seed < 10000; seed++) {
+    fill_hostile_dct_block(coeffs, quant, seed);
+    memset(got, 0xAA, sizeof got);
+    memset(want, 0xAA, sizeof want);
+    wuffs_base__slice_u8__idct_8x8(
+        ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 13, c, q);
+    wuffs_base__slice_u8__idct_8x8__fallback(
+        ((wuffs_base__slice_u8){.ptr = want, .len = sizeof want}), 13, c, q);
+    if (memcmp(got, want, sizeof want)) {
+      FAIL("seed=%" PRIu32 ": results differ", seed);
+      return;
+    }
+  }
+}
+
+void test_wuffs_base_idct_8x8() {
+  CHECK_FOCUS(__func__);
+
+  uint8_t coeffs[128];
+  uint8_t quant[128];
+  uint8_t got[8 * 13];
+  uint8_t want[8 * 13];
+  wuffs_base__slice_u8 c = ((wuffs_base__slice_u8){.ptr = coeffs, .len = 128});
+  wuffs_base__slice_u8 q = ((wuffs_base__slice_u8){.ptr = quant, .len = 128});
+
+  uint32_t seed;
+  for (seed = 0; seed < 10000; seed++) {
+    fill_dct_block(coeffs, quant, seed);
+    memset(got, 0xAA, sizeof got);
+    memset(want, 0xAA, sizeof want);
+    wuffs_base__slice_u8__idct_8x8(
+        ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 13, c, q);
+    wuffs_base__slice_u8__idct_8x8__fallback(
+        ((wuffs_base__slice_u8){.ptr = want, .len = sizeof want}), 13, c, q);
+    if (memcmp(got, want, sizeof want)) {
+      FAIL("seed=%" PRIu32 ": results differ", seed);
+      return;
+    }
+  }
+
+  // A DC-only block is a flat block, and a too-short dst is left untouched.
+  memset(coeffs, 0, sizeof coeffs);
+  wuffs_base__store_u16le(coeffs, 5);
+  wuffs_base__store_u16le(quant, 16);
+  memset(got, 0, sizeof got);
+  wuffs_base__slice_u8__idct_8x8(
+      ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 13, c, q);
+  if ((got[0] != 138) || (got[7] != 138) || (got[8] != 0) ||
+      (got[(7 * 13) + 7] != 138)) {
+    FAIL("DC only: got %d, %d, %d, %d, want 138, 138, 0, 138", got[0], got[7],
+         got[8], got[(7 * 13) + 7]);
+    return;
+  }
+  memset(got, 0, sizeof got);
+  wuffs_base__slice_u8__idct_8x8(
+      ((wuffs_base__slice_u8){.ptr = got, .len = (7 * 13) + 7}), 13, c, q);
+  if (got[0] != 0) {
+    FAIL("short dst: got %d, want 0", got[0]);
+    return;
+  }
+}
+
+void test_wuffs_base_idct_8x8_downscaled() {
+  CHECK_FOCUS(__func__);
+
+  uint8_t coeffs[128];
+  uint8_t quant[128];
+  uint8_t got[8 * 13];
+  wuffs_base__slice_u8 c = ((wuffs_base__slice_u8){.ptr = coeffs, .len = 128});
+  wuffs_base__slice_u8 q = ((wuffs_base__slice_u8){.ptr = quant, .len = 128});
+
+  // A DC-only block is a flat block at every scale, and only the top-left
+  // (8 >> shift) × (8 >> shift) samples are written.
+  memset(coeffs, 0, sizeof coeffs);
+  memset(quant, 0, sizeof quant);
+  wuffs_base__store_u16le(coeffs, 5);
+  wuffs_base__store_u16le(quant, 16);
+  uint32_t shift;
+  for (shift = 0; shift < 4; shift++) {
+    memset(got, 0, sizeof got);
+    wuffs_base__slice_u8__idct_8x8_downscaled(
+        ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 13, c, q,
+        shift);
+    uint32_t n = 8 >> shift;
+    uint32_t x;
+    uint32_t y;
+    for (y = 0; y < 8; y++) {
+      for (x = 0; x < 8; x++) {
+        uint8_t want = ((x < n) && (y < n)) ? 138 : 0;
+        if (got[(13 * y) + x] != want) {
+          FAIL("shift=%" PRIu32 ", x=%" PRIu32 ", y=%" PRIu32
+               ": got %d, want %d",
+               shift, x, y, got[(13 * y) + x], want);
+          return;
+        }
+      }
+    }
+  }
+}
+
+void test_wuffs_base_idct_8x8_downscaled_hostile() {
+  CHECK_FOCUS(__func__);
+
+  uint8_t coeffs[128];
+  uint8_t quant[128];
+  uint8_t got[8 * 13];
+  wuffs_base__slice_u8 c = ((wuffs_base__slice_u8){.ptr = coeffs, .len = 128});
+  wuffs_base__slice_u8 q = ((wuffs_base__slice_u8){.ptr = quant, .len = 128});
+
+  // Extreme inputs must not overflow, which -fsanitize=undefined would catch.
+  uint32_t seed;
+  uint32_t shift;
+  for (seed = 0; seed < 10000; seed++) {
+    fill_hostile_dct_block(coeffs, quant, seed);
+    for (shift = 1; shift < 4; shift++) {
+      wuffs_base__slice_u8__idct_8x8_downscaled(
+          ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 13, c, q,
+          shift);
+    }
+  }
+
+  // The largest magnitude DC-only blocks saturate to flat white or black, at
+  // every scale.
+  int sign;
+  for (sign = 0; sign < 2; sign++) {
+    memset(coeffs, 0, sizeof coeffs);
+    memset(quant, 0xFF, sizeof quant);
+    wuffs_base__store_u16le(coeffs, sign ? 0x8000 : 0x7FFF);
+    uint8_t want = sign ? 0 : 255;
+    for (shift = 0; shift < 4; shift++) {
+      memset(got, 0xAA, sizeof got);
+      wuffs_base__slice_u8__idct_8x8_downscaled(
+          ((wuffs_base__slice_u8){.ptr = got, .len = sizeof got}), 13, c, q,
+          shift);
+      uint32_t n = 8 >> shift;
+      uint32_t x;
+      uint32_t y;
+      for (y = 0; y < n; y++) {
+        for (x = 0; x < n; x++) {
+          if (got[(13 * y) + x] != want) {
+            FAIL("sign=%d, shift=%" PRIu32 ", x=%" PRIu32 ", y=%" PRIu32
+                 ": got %d, want %d",
+                 sign, shift, x, y, got[(13 * y) + x], want);
+            return;
+          }
+        }
+      }
+    }
+  }
+}
+
+void test_wuffs_base_convert_ycc() {
+  CHECK_FOCUS(__func__);
+
+  const wuffs_base__pixel_format pixfmts[] = {
+      WUFFS_BASE__PIXEL_FORMAT__BGR,
+      WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+      WUFFS_BASE__PIXEL_FORMAT__RGB,
+      WUFFS_BASE__PIXEL_FORMAT__RGBX,
+  };
+  const size_t widths[] = {1, 7, 8, 9, 63, 64, 65, 200};
+  uint8_t y[256];
+  uint8_t cb[256];
+  uint8_t cr[256];
+  uint8_t got[4 * 256];
+  uint8_t want[4 * 256];
+
+  size_t i;
+  for (i = 0; i < 256; i++) {
+    y[i] = (uint8_t)(i * 7);
+    cb[i] = (uint8_t)(i * 13 + 5);
+    cr[i] = (uint8_t)(255 - (i * 11));
+  }
+
+  size_t p;
+  for (p = 0; p < WUFFS_TESTLIB_ARRAY_SIZE(pixfmts); p++) {
+    size_t bpp = wuffs_base__pixel_format__bits_per_pixel(pixfmts[p]) / 8;
+    bool rgb = (pixfmts[p] == WUFFS_BASE__PIXEL_FORMAT__RGB) ||
+               (pixfmts[p] == WUFFS_BASE__PIXEL_FORMAT__RGBX);
+    size_t w;
+    for (w = 0; w < WUFFS_TESTLIB_ARRAY_SIZE(widths); w++) {
+      size_t n = widths[w];
+      memset(got, 0, sizeof got);
+      memset(want, 0, sizeof want);
+      wuffs_base__slice_u8__convert_ycc(
+          ((wuffs_base__slice_u8){.ptr = got, .len = bpp * n}),
+          ((wuffs_base__slice_u8){.ptr = y, .len = n}),
+          ((wuffs_base__slice_u8){.ptr = cb, .len = n}),
+          ((wuffs_base__slice_u8){.ptr = cr, .len = n}),
+          ((wuffs_base__slice_u8){}), ((wuffs_base__slice_u8){}), pixfmts[p],
+          0);
+      wuffs_base__private_convert_ycc__fallback(want, bpp, rgb, y, cb, cr, n);
+      if (memcmp(got, want, sizeof want)) {
+        FAIL("pixfmt=0x%08" PRIX32 ", width=%zu: results differ", pixfmts[p],
+             n);
+        return;
+      }
+    }
+  }
+}
+
+// ---------------- JPEG Tests
+
+// copy_to_io_buffer_from_planes copies each plane of the pixel buffer, which
+// has the planar pixel format and subsampling of the image config, to dst.
+const char* copy_to_io_buffer_from_planes(wuffs_base__io_buffer* dst,
+                                          wuffs_base__pixel_buffer* pb,
+                                          wuffs_base__pixel_config* pc) {
+  wuffs_base__pixel_format pixfmt = wuffs_base__pixel_config__pixel_format(pc);
+  wuffs_base__pixel_subsampling pixsub =
+      wuffs_base__pixel_config__pixel_subsampling(pc);
+  uint32_t p;
+  for (p = 0; p < wuffs_base__pixel_format__num_planes(pixfmt); p++) {
+    wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(pb, p);
+    uint32_t w = wuffs_base__pixel_subsampling__plane_width(
+        pixsub, p, wuffs_base__pixel_config__width(pc));
+    uint32_t h = wuffs_base__pixel_subsampling__plane_height(
+        pixsub, p, wuffs_base__pixel_config__height(pc));
+    uint32_t y;
+    for (y = 0; y < h; y++) {
+      wuffs_base__slice_u8 row = wuffs_base__table_u8__row(tab, y);
+      if ((w > row.len) || (w > (dst->data.len - dst->meta.wi))) {
+        return "copy_to_io_buffer_from_planes: dst buffer is too small";
+      }
+      memmove(dst->data.ptr + dst->meta.wi, row.ptr, w);
+      dst->meta.wi += w;
+    }
+  }
+  return NULL;
+}
+
+// do_wuffs_jpeg_decode decodes src's image to dst, in the given pixel format.
+// A zero pixfmt means the image's own (planar) pixel format and subsampling,
+// so that each plane is copied as is. A non-zero rlimit means that the src is
+// fed to the decoder at most rlimit bytes at a time.
+//
+// The downscale_shift is passed to set_downscale_shift, before decoding the
+// image config, and the opts_downscale_shift is passed to decode_frame as a
+// decode_frame_options' downscale shift, for a correspondingly smaller pixel
+// buffer.
+const char* do_wuffs_jpeg_decode(wuffs_base__io_buffer* dst,
+                                 wuffs_base__io_buffer* src,
+                                 wuffs_base__pixel_format pixfmt,
+                                 uint64_t rlimit,
+                                 uint32_t downscale_shift,
+                                 uint32_t opts_downscale_shift) {
+  wuffs_jpeg__decoder dec = ((wuffs_jpeg__decoder){});
+  wuffs_base__status z =
+      wuffs_jpeg__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_jpeg__decoder__set_downscale_shift(&dec, downscale_shift);
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_jpeg__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_subsampling pixsub = 0;
+  if (!pixfmt) {
+    pixfmt = wuffs_base__pixel_config__pixel_format(&ic.pixcfg);
+    pixsub = wuffs_base__pixel_config__pixel_subsampling(&ic.pixcfg);
+  }
+  uint32_t k = opts_downscale_shift;
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, pixsub,
+      (wuffs_base__pixel_config__width(&ic.pixcfg) + (1 << k) - 1) >> k,
+      (wuffs_base__pixel_config__height(&ic.pixcfg) + (1 << k) - 1) >> k);
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    wuffs_base__decode_frame_options opts =
+        ((wuffs_base__decode_frame_options){});
+    wuffs_base__decode_frame_options__initialize(&opts, opts_downscale_shift,
+                                                 false, false);
+    z = wuffs_jpeg__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                          &opts);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  if (wuffs_base__pixel_format__is_planar_8_bit(pixfmt)) {
+    return copy_to_io_buffer_from_planes(dst, &pb, &pc);
+  }
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+const char* wuffs_jpeg_decode(wuffs_base__io_buffer* dst,
+                              wuffs_base__io_buffer* src) {
+  return do_wuffs_jpeg_decode(
+      dst, src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 0, 0);
+}
+
+const char* wuffs_jpeg_decode_planes(wuffs_base__io_buffer* dst,
+                                     wuffs_base__io_buffer* src) {
+  return do_wuffs_jpeg_decode(dst, src, 0, 0, 0, 0);
+}
+
+const char* wuffs_jpeg_decode_thumbnail(wuffs_base__io_buffer* dst,
+                                        wuffs_base__io_buffer* src) {
+  return do_wuffs_jpeg_decode(
+      dst, src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 3, 0);
+}
+
+// do_test_wuffs_jpeg_decode_downscaled checks the Adler-32 checksum of the
+// decoded pixels against want_checksum, calculated from libjpeg-turbo's output.
+bool do_test_wuffs_jpeg_decode_downscaled(const char* filename,
+                                          wuffs_base__pixel_format pixfmt,
+                                          uint64_t rlimit,
+                                          uint32_t downscale_shift,
+                                          uint32_t opts_downscale_shift,
+                                          uint64_t want_num_bytes,
+                                          uint32_t want_checksum) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  const char* msg = do_wuffs_jpeg_decode(&got, &src, pixfmt, rlimit,
+                                         downscale_shift, opts_downscale_shift);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  if (got.meta.wi != want_num_bytes) {
+    FAIL("num_bytes: got %zu, want %" PRIu64, got.meta.wi, want_num_bytes);
+    return false;
+  }
+
+  wuffs_adler32__hasher checksum = ((wuffs_adler32__hasher){});
+  wuffs_base__status z = wuffs_adler32__hasher__check_wuffs_version(
+      &checksum, sizeof checksum, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  uint32_t got_checksum =
+      wuffs_adler32__hasher__update(&checksum, ((wuffs_base__slice_u8){
+                                                   .ptr = got.data.ptr,
+                                                   .len = got.meta.wi,
+                                               }));
+  if (got_checksum != want_checksum) {
+    FAIL("checksum: got 0x%08" PRIX32 ", want 0x%08" PRIX32, got_checksum,
+         want_checksum);
+    return false;
+  }
+  return true;
+}
+
+bool do_test_wuffs_jpeg_decode(const char* filename,
+                               wuffs_base__pixel_format pixfmt,
+                               uint64_t rlimit,
+                               uint64_t want_num_bytes,
+                               uint32_t want_checksum) {
+  return do_test_wuffs_jpeg_decode_downscaled(filename, pixfmt, rlimit, 0, 0,
+                                              want_num_bytes, want_checksum);
+}
+
+void test_wuffs_jpeg_call_sequence() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/hat.jpeg")) {
+    return;
+  }
+
+  wuffs_jpeg__decoder dec = ((wuffs_jpeg__decoder){});
+  wuffs_base__status z =
+      wuffs_jpeg__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_jpeg__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+  z = wuffs_jpeg__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z) {
+    FAIL("decode_frame_config #0: got \"%s\"", z);
+    return;
+  }
+
+  z = wuffs_jpeg__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z != wuffs_base__warning__end_of_data) {
+    FAIL("decode_frame_config #1: got \"%s\", want \"%s\"", z,
+         wuffs_base__warning__end_of_data);
+    return;
+  }
+
+  z = wuffs_jpeg__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z != wuffs_base__error__bad_call_sequence) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__bad_call_sequence);
+    return;
+  }
+}
+
+void test_wuffs_jpeg_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0x8E9935DC);
+}
+
+void test_wuffs_jpeg_decode_bricks_color_422() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.422.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0x5B014D6A);
+}
+
+void test_wuffs_jpeg_decode_bricks_color_440() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.440.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0xC12B6A5F);
+}
+
+void test_wuffs_jpeg_decode_bricks_color_progressive() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.progressive.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0x8E9935DC);
+}
+
+void test_wuffs_jpeg_decode_bricks_color_restart() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.restart.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0x8E9935DC);
+}
+
+void test_wuffs_jpeg_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-gray.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0xF42BAAE7);
+}
+
+void test_wuffs_jpeg_decode_downscaled_bricks_color_half() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 1, 0, 80 * 60 * 4, 0x884E4E1E);
+}
+
+void test_wuffs_jpeg_decode_downscaled_bricks_color_quarter() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 2, 0, 40 * 30 * 4, 0xA94B5205);
+}
+
+void test_wuffs_jpeg_decode_downscaled_bricks_color_eighth() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 3, 0, 20 * 15 * 4, 0x3BC7549E);
+}
+
+void test_wuffs_jpeg_decode_downscaled_bricks_color_422_half() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.422.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 1, 0, 80 * 60 * 4, 0xC2965373);
+}
+
+void test_wuffs_jpeg_decode_downscaled_bricks_color_progressive_eighth() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled(
+      "../../data/bricks-color.progressive.jpeg",
+      WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 3, 0, 20 * 15 * 4,
+      0x3BC7549E);
+}
+
+void test_wuffs_jpeg_decode_downscaled_bricks_gray_quarter() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-gray.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 2, 0, 40 * 30 * 4, 0x6E50EA8B);
+}
+
+void test_wuffs_jpeg_decode_downscaled_frame_options() {
+  CHECK_FOCUS(__func__);
+  // A set_downscale_shift of 1 and a decode_frame_options' downscale shift of
+  // 2 add up to 1/8 scale.
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 1, 2, 20 * 15 * 4, 0x3BC7549E);
+}
+
+void test_wuffs_jpeg_decode_downscaled_harvesters_eighth() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/harvesters.jpeg",
+                                       WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                       0, 3, 0, 146 * 108 * 4, 0x4164F76A);
+}
+
+void test_wuffs_jpeg_decode_downscaled_planes_bricks_color_half() {
+  CHECK_FOCUS(__func__);
+  // At 1/2 scale, the 4:2:0 chroma blocks are transformed to 8×8 samples, not
+  // 4×4, so all three planes are 80×60.
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.jpeg", 0, 0, 1,
+                                       0, 3 * 80 * 60, 0x5C9F6D8B);
+}
+
+void test_wuffs_jpeg_decode_downscaled_planes_bricks_color_eighth() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode_downscaled("../../data/bricks-color.jpeg", 0, 0, 3,
+                                       0, 3 * 20 * 15, 0x5F3086E8);
+}
+
+void test_wuffs_jpeg_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/harvesters.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            1165 * 859 * 4, 0x77D5828A);
+}
+
+void test_wuffs_jpeg_decode_hippopotamus() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/hippopotamus.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            36 * 28 * 4, 0xAFAA5EC6);
+}
+
+void test_wuffs_jpeg_decode_image_config() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  const char* filenames[] = {
+      "../../data/bricks-color.jpeg",     "../../data/bricks-color.422.jpeg",
+      "../../data/bricks-color.440.jpeg", "../../data/bricks-gray.jpeg",
+      "../../data/hippopotamus.jpeg",
+  };
+  const wuffs_base__pixel_format want_pixfmts[] = {
+      WUFFS_BASE__PIXEL_FORMAT__YUV, WUFFS_BASE__PIXEL_FORMAT__YUV,
+      WUFFS_BASE__PIXEL_FORMAT__YUV, WUFFS_BASE__PIXEL_FORMAT__Y,
+      WUFFS_BASE__PIXEL_FORMAT__YUV,
+  };
+  const wuffs_base__pixel_subsampling want_pixsubs[] = {
+      WUFFS_BASE__PIXEL_SUBSAMPLING__420,  WUFFS_BASE__PIXEL_SUBSAMPLING__422,
+      WUFFS_BASE__PIXEL_SUBSAMPLING__440,  WUFFS_BASE__PIXEL_SUBSAMPLING__NONE,
+      WUFFS_BASE__PIXEL_SUBSAMPLING__NONE,
+  };
+
+  size_t i;
+  for (i = 0; i < WUFFS_TESTLIB_ARRAY_SIZE(filenames); i++) {
+    src.meta = ((wuffs_base__io_buffer_meta){});
+    if (!read_file(&src, filenames[i])) {
+      return;
+    }
+
+    wuffs_jpeg__decoder dec = ((wuffs_jpeg__decoder){});
+    wuffs_base__status z = wuffs_jpeg__decoder__check_wuffs_version(
+        &dec, sizeof dec, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return;
+    }
+    wuffs_base__image_config ic = ((wuffs_base__image_config){});
+    z = wuffs_jpeg__decoder__decode_image_config(
+        &dec, &ic, wuffs_base__io_buffer__reader(&src));
+    if (z) {
+      FAIL("%s: decode_image_config: got \"%s\"", filenames[i], z);
+      return;
+    }
+
+    wuffs_base__pixel_format got_pixfmt =
+        wuffs_base__pixel_config__pixel_format(&ic.pixcfg);
+    if (got_pixfmt != want_pixfmts[i]) {
+      FAIL("%s: pixel_format: got 0x%08" PRIX32 ", want 0x%08" PRIX32,
+           filenames[i], got_pixfmt, want_pixfmts[i]);
+      return;
+    }
+    wuffs_base__pixel_subsampling got_pixsub =
+        wuffs_base__pixel_config__pixel_subsampling(&ic.pixcfg);
+    if (got_pixsub != want_pixsubs[i]) {
+      FAIL("%s: pixel_subsampling: got 0x%08" PRIX32 ", want 0x%08" PRIX32,
+           filenames[i], got_pixsub, want_pixsubs[i]);
+      return;
+    }
+    if (!wuffs_base__image_config__first_frame_is_opaque(&ic)) {
+      FAIL("%s: first_frame_is_opaque: got false, want true", filenames[i]);
+      return;
+    }
+  }
+}
+
+void test_wuffs_jpeg_decode_image_config_downscaled() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/harvesters.jpeg")) {
+    return;
+  }
+
+  const uint32_t want_widths[] = {1165, 583, 292, 146};
+  const uint32_t want_heights[] = {859, 430, 215, 108};
+  const wuffs_base__pixel_subsampling want_pixsubs[] = {
+      WUFFS_BASE__PIXEL_SUBSAMPLING__420,
+      WUFFS_BASE__PIXEL_SUBSAMPLING__NONE,
+      WUFFS_BASE__PIXEL_SUBSAMPLING__NONE,
+      WUFFS_BASE__PIXEL_SUBSAMPLING__NONE,
+  };
+  uint64_t prev_workbuf_len = 0;
+
+  uint32_t shift;
+  for (shift = 0; shift < 4; shift++) {
+    src.meta.ri = 0;
+    wuffs_jpeg__decoder dec = ((wuffs_jpeg__decoder){});
+    wuffs_base__status z = wuffs_jpeg__decoder__check_wuffs_version(
+        &dec, sizeof dec, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return;
+    }
+    wuffs_jpeg__decoder__set_downscale_shift(&dec, shift);
+    wuffs_base__image_config ic = ((wuffs_base__image_config){});
+    z = wuffs_jpeg__decoder__decode_image_config(
+        &dec, &ic, wuffs_base__io_buffer__reader(&src));
+    if (z) {
+      FAIL("shift=%" PRIu32 ": decode_image_config: got \"%s\"", shift, z);
+      return;
+    }
+
+    uint32_t got_width = wuffs_base__pixel_config__width(&ic.pixcfg);
+    uint32_t got_height = wuffs_base__pixel_config__height(&ic.pixcfg);
+    if ((got_width != want_widths[shift]) ||
+        (got_height != want_heights[shift])) {
+      FAIL("shift=%" PRIu32 ": dimensions: got %" PRIu32 "×%" PRIu32
+           ", want %" PRIu32 "×%" PRIu32,
+           shift, got_width, got_height, want_widths[shift],
+           want_heights[shift]);
+      return;
+    }
+    wuffs_base__pixel_subsampling got_pixsub =
+        wuffs_base__pixel_config__pixel_subsampling(&ic.pixcfg);
+    if (got_pixsub != want_pixsubs[shift]) {
+      FAIL("shift=%" PRIu32 ": pixel_subsampling: got 0x%08" PRIX32
+           ", want 0x%08" PRIX32,
+           shift, got_pixsub, want_pixsubs[shift]);
+      return;
+    }
+    uint64_t got_workbuf_len =
+        wuffs_base__image_config__workbuf_len(&ic).max_incl;
+    if ((shift > 0) && (got_workbuf_len >= prev_workbuf_len)) {
+      FAIL("shift=%" PRIu32 ": workbuf_len: got %" PRIu64
+           ", want less than %" PRIu64,
+           shift, got_workbuf_len, prev_workbuf_len);
+      return;
+    }
+    prev_workbuf_len = got_workbuf_len;
+  }
+}
+
+void test_wuffs_jpeg_decode_image_decoder() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-color.jpeg")) {
+    return;
+  }
+  const char* msg = wuffs_jpeg_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  src.meta.ri = 0;
+
+  wuffs_base__image_format format =
+      wuffs_base__image_format__sniff(((wuffs_base__slice_u8){
+          .ptr = src.data.ptr,
+          .len = wuffs_base__u64__min(src.meta.wi,
+                                      WUFFS_BASE__IMAGE_FORMAT__SNIFF_LEN),
+      }));
+  if (format != WUFFS_BASE__IMAGE_FORMAT__JPEG) {
+    FAIL("sniff: got 0x%08" PRIX32 ", want 0x%08" PRIX32, format,
+         WUFFS_BASE__IMAGE_FORMAT__JPEG);
+    return;
+  }
+
+  wuffs_jpeg__decoder dec;
+  wuffs_base__image_decoder d =
+      wuffs_jpeg__decoder__upcast_as__wuffs_base__image_decoder(&dec);
+  if (wuffs_base__image_decoder__sizeof_star_self(&d) != sizeof dec) {
+    FAIL("sizeof_star_self: got %zu, want %zu",
+         wuffs_base__image_decoder__sizeof_star_self(&d), sizeof dec);
+    return;
+  }
+  wuffs_base__status z = wuffs_base__image_decoder__initialize(&d);
+  if (z) {
+    FAIL("initialize: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+  z = wuffs_base__image_decoder__decode_image_config(&d, &ic, src_reader);
+  if (z) {
+    FAIL("decode_image_config: \"%s\"", z);
+    return;
+  }
+  wuffs_base__range_ii_u64 workbuf_len =
+      wuffs_base__image_decoder__workbuf_len(&d);
+  if (!wuffs_base__range_ii_u64__equals(
+          &workbuf_len, wuffs_base__image_config__workbuf_len(&ic))) {
+    FAIL("workbuf_len: got [%" PRIu64 ", %" PRIu64 "], want [%" PRIu64
+         ", %" PRIu64 "]",
+         workbuf_len.min_incl, workbuf_len.max_incl,
+         wuffs_base__image_config__workbuf_len(&ic).min_incl,
+         wuffs_base__image_config__workbuf_len(&ic).max_incl);
+    return;
+  }
+  if (workbuf_len.max_incl > BUFFER_SIZE) {
+    FAIL("work buffer size is too large");
+    return;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+  z = wuffs_base__image_decoder__decode_frame_config(&d, &fc, src_reader);
+  if (z) {
+    FAIL("decode_frame_config: \"%s\"", z);
+    return;
+  }
+  z = wuffs_base__image_decoder__decode_frame(&d, &pb, src_reader,
+                                              ((wuffs_base__slice_u8){
+                                                  .ptr = global_work_array,
+                                                  .len = workbuf_len.max_incl,
+                                              }),
+                                              NULL);
+  if (z) {
+    FAIL("decode_frame: \"%s\"", z);
+    return;
+  }
+
+  msg = copy_to_io_buffer_from_pixel_buffer(
+      &got, &pb, wuffs_base__pixel_config__bounds(&pc));
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  io_buffers_equal("", &got, &want);
+}
+
+void test_wuffs_jpeg_decode_input_is_a_png() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.png")) {
+    return;
+  }
+
+  wuffs_jpeg__decoder dec = ((wuffs_jpeg__decoder){});
+  wuffs_base__status z =
+      wuffs_jpeg__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_jpeg__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z != wuffs_jpeg__error__bad_header) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_jpeg__error__bad_header);
+    return;
+  }
+}
+
+void test_wuffs_jpeg_decode_many_small_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 11,
+                            160 * 120 * 4, 0x8E9935DC);
+}
+
+void test_wuffs_jpeg_decode_many_small_reads_progressive() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.progressive.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 11,
+                            160 * 120 * 4, 0x8E9935DC);
+}
+
+void test_wuffs_jpeg_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/pjw-thumbnail.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            32 * 32 * 4, 0x0A065D86);
+}
+
+void test_wuffs_jpeg_decode_planes_bricks_color() {
+  CHECK_FOCUS(__func__);
+  // The Y plane is 160×120 and the 4:2:0 subsampled Cb and Cr planes are each
+  // 80×60.
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.jpeg", 0, 0,
+                            (160 * 120) + (2 * 80 * 60), 0x2C2FC58D);
+}
+
+void test_wuffs_jpeg_decode_planes_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-gray.jpeg", 0, 0, 160 * 120,
+                            0x59D0FB22);
+}
+
+void test_wuffs_jpeg_decode_rgb() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_jpeg_decode("../../data/bricks-color.jpeg",
+                            WUFFS_BASE__PIXEL_FORMAT__RGB, 0, 160 * 120 * 3,
+                            0xB55C7C77);
+}
+
+void test_wuffs_jpeg_decode_truncated() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-color.jpeg")) {
+    return;
+  }
+  src.meta.wi /= 2;
+  src.meta.closed = true;
+
+  const char* msg = do_wuffs_jpeg_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, 0, 0);
+  if (msg != wuffs_base__suspension__short_read) {
+    FAIL("got \"%s\", want \"%s\"", msg, wuffs_base__suspension__short_read);
+    return;
+  }
+}
+
+// ---------------- Mimic Tests
+
+#ifdef WUFFS_MIMIC
+
+bool do_test_mimic_jpeg_decode_downscaled(const char* filename,
+                                          uint32_t downscale_shift) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  src.meta.ri = 0;
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  const char* got_msg =
+      do_wuffs_jpeg_decode(&got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                           0, downscale_shift, 0);
+  if (got_msg) {
+    FAIL("%s", got_msg);
+    return false;
+  }
+
+  src.meta.ri = 0;
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  const char* want_msg =
+      mimic_jpeg_decode_downscaled(&want, &src, downscale_shift);
+  if (want_msg) {
+    FAIL("%s", want_msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+bool do_test_mimic_jpeg_decode(const char* filename) {
+  return do_test_mimic_jpeg_decode_downscaled(filename, 0);
+}
+
+void test_mimic_jpeg_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/bricks-color.jpeg");
+}
+
+void test_mimic_jpeg_decode_bricks_color_422() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/bricks-color.422.jpeg");
+}
+
+void test_mimic_jpeg_decode_bricks_color_440() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/bricks-color.440.jpeg");
+}
+
+void test_mimic_jpeg_decode_bricks_color_progressive() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/bricks-color.progressive.jpeg");
+}
+
+void test_mimic_jpeg_decode_bricks_color_restart() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/bricks-color.restart.jpeg");
+}
+
+void test_mimic_jpeg_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/bricks-gray.jpeg");
+}
+
+// do_test_mimic_jpeg_decode_downscaled_all compares every JPEG test image,
+// decoded at 1/(1 << downscale_shift) scale, with libjpeg-turbo's decoding.
+void do_test_mimic_jpeg_decode_downscaled_all(uint32_t downscale_shift) {
+  const char* filenames[] = {
+      "../../data/bricks-color.jpeg",
+      "../../data/bricks-color.422.jpeg",
+      "../../data/bricks-color.440.jpeg",
+      "../../data/bricks-color.progressive.jpeg",
+      "../../data/bricks-color.restart.jpeg",
+      "../../data/bricks-gray.jpeg",
+      "../../data/harvesters.jpeg",
+      "../../data/harvesters.progressive.jpeg",
+      "../../data/hat.jpeg",
+      "../../data/hibiscus.jpeg",
+      "../../data/hippopotamus.jpeg",
+      "../../data/pjw-thumbnail.jpeg",
+  };
+  size_t i;
+  for (i = 0; i < WUFFS_TESTLIB_ARRAY_SIZE(filenames); i++) {
+    if (!do_test_mimic_jpeg_decode_downscaled(filenames[i], downscale_shift)) {
+      return;
+    }
+  }
+}
+
+void test_mimic_jpeg_decode_downscaled_half() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode_downscaled_all(1);
+}
+
+void test_mimic_jpeg_decode_downscaled_quarter() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode_downscaled_all(2);
+}
+
+void test_mimic_jpeg_decode_downscaled_eighth() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode_downscaled_all(3);
+}
+
+void test_mimic_jpeg_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/harvesters.jpeg");
+}
+
+void test_mimic_jpeg_decode_harvesters_progressive() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/harvesters.progressive.jpeg");
+}
+
+void test_mimic_jpeg_decode_hat() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/hat.jpeg");
+}
+
+void test_mimic_jpeg_decode_hibiscus() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/hibiscus.jpeg");
+}
+
+void test_mimic_jpeg_decode_hippopotamus() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/hippopotamus.jpeg");
+}
+
+void test_mimic_jpeg_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_jpeg_decode("../../data/pjw-thumbnail.jpeg");
+}
+
+#endif  // WUFFS_MIMIC
+
+// ---------------- IDCT and Color Conversion Benches
+
+// do_bench_wuffs_base_idct_8x8 transforms 4096 blocks, each to its own 8×8
+// dst, so that the compiler can't elide all but the last transform.
+bool do_bench_wuffs_base_idct_8x8(void (*f)(wuffs_base__slice_u8,
+                                            uint64_t,
+                                            wuffs_base__slice_u8,
+                                            wuffs_base__slice_u8),
+                                  uint64_t iters_unscaled) {
+  uint8_t* coeffs = global_src_array;
+  uint8_t quant[128];
+  uint32_t b;
+  for (b = 0; b < 4096; b++) {
+    fill_dct_block(coeffs + (128 * b), quant, b);
+  }
+  wuffs_base__slice_u8 q = ((wuffs_base__slice_u8){.ptr = quant, .len = 128});
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    for (b = 0; b < 4096; b++) {
+      f(((wuffs_base__slice_u8){.ptr = global_got_array + (64 * b), .len = 64}),
+        8, ((wuffs_base__slice_u8){.ptr = coeffs + (128 * b), .len = 128}), q);
+    }
+    n_bytes += 4096 * 64;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+// do_bench_wuffs_base_convert_ycc converts 64 rows, each 1024 pixels wide,
+// from 4:2:0 subsampled YCbCr to BGRA.
+bool do_bench_wuffs_base_convert_ycc(uint32_t upsample,
+                                     uint64_t iters_unscaled) {
+  wuffs_base__slice_u8 y = ((wuffs_base__slice_u8){
+      .ptr = global_src_array,
+      .len = 1024,
+  });
+  wuffs_base__slice_u8 cb = ((wuffs_base__slice_u8){
+      .ptr = global_src_array + 1024,
+      .len = upsample ? 512 : 1024,
+  });
+  wuffs_base__slice_u8 cr = ((wuffs_base__slice_u8){
+      .ptr = global_src_array + 2048,
+      .len = upsample ? 512 : 1024,
+  });
+  wuffs_base__slice_u8 cb_far = ((wuffs_base__slice_u8){
+      .ptr = global_src_array + 3072,
+      .len = upsample ? 512 : 1024,
+  });
+  wuffs_base__slice_u8 cr_far = ((wuffs_base__slice_u8){
+      .ptr = global_src_array + 4096,
+      .len = upsample ? 512 : 1024,
+  });
+  uint32_t j;
+  for (j = 0; j < 5 * 1024; j++) {
+    global_src_array[j] = (uint8_t)((j * 7) ^ (j >> 3));
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    for (j = 0; j < 64; j++) {
+      wuffs_base__slice_u8__convert_ycc(
+          ((wuffs_base__slice_u8){
+              .ptr = global_got_array + (4096 * j),
+              .len = 4096,
+          }),
+          y, cb, cr, cb_far, cr_far, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+          upsample);
+    }
+    n_bytes += 64 * 4096;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_base_idct_8x8() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_idct_8x8(wuffs_base__slice_u8__idct_8x8, 10);
+}
+
+void bench_wuffs_base_idct_8x8__fallback() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_idct_8x8(wuffs_base__slice_u8__idct_8x8__fallback, 10);
+}
+
+void bench_wuffs_base_convert_ycc_444() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_convert_ycc(0, 100);
+}
+
+void bench_wuffs_base_convert_ycc_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_base_convert_ycc(4, 100);
+}
+
+// ---------------- JPEG Benches
+
+bool do_bench_jpeg_decode(const char* (*decode_func)(wuffs_base__io_buffer*,
+                                                     wuffs_base__io_buffer*),
+                          const char* filename,
+                          uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    const char* error_msg = decode_func(&got, &src);
+    if (error_msg) {
+      FAIL("%s", error_msg);
+      return false;
+    }
+    n_bytes += got.meta.wi;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_jpeg_decode_9k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(wuffs_jpeg_decode, "../../data/bricks-color.jpeg", 50);
+}
+
+void bench_wuffs_jpeg_decode_9k_progressive() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(wuffs_jpeg_decode,
+                       "../../data/bricks-color.progressive.jpeg", 50);
+}
+
+void bench_wuffs_jpeg_decode_59k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(wuffs_jpeg_decode, "../../data/hibiscus.jpeg", 5);
+}
+
+void bench_wuffs_jpeg_decode_402k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(wuffs_jpeg_decode, "../../data/harvesters.jpeg", 1);
+}
+
+void bench_wuffs_jpeg_decode_planes_402k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(wuffs_jpeg_decode_planes, "../../data/harvesters.jpeg",
+                       1);
+}
+
+void bench_wuffs_jpeg_decode_thumbnail_402k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(wuffs_jpeg_decode_thumbnail,
+                       "../../data/harvesters.jpeg", 1);
+}
+
+// ---------------- Mimic Benches
+
+#ifdef WUFFS_MIMIC
+
+void bench_mimic_jpeg_decode_9k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(mimic_jpeg_decode, "../../data/bricks-color.jpeg", 50);
+}
+
+void bench_mimic_jpeg_decode_9k_progressive() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(mimic_jpeg_decode,
+                       "../../data/bricks-color.progressive.jpeg", 50);
+}
+
+void bench_mimic_jpeg_decode_59k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(mimic_jpeg_decode, "../../data/hibiscus.jpeg", 5);
+}
+
+void bench_mimic_jpeg_decode_402k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(mimic_jpeg_decode, "../../data/harvesters.jpeg", 1);
+}
+
+const char* mimic_jpeg_decode_thumbnail(wuffs_base__io_buffer* dst,
+                                        wuffs_base__io_buffer* src) {
+  return mimic_jpeg_decode_downscaled(dst, src, 3);
+}
+
+void bench_mimic_jpeg_decode_thumbnail_402k_420() {
+  CHECK_FOCUS(__func__);
+  do_bench_jpeg_decode(mimic_jpeg_decode_thumbnail,
+                       "../../data/harvesters.jpeg", 1);
+}
+
+#endif  // WUFFS_MIMIC
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_base_convert_ycc,                                        //
+    test_wuffs_base_idct_8x8,                                           //
+    test_wuffs_base_idct_8x8_downscaled,                                //
+    test_wuffs_base_idct_8x8_downscaled_hostile,                        //
+    test_wuffs_base_idct_8x8_hostile,                                   //
+    test_wuffs_jpeg_call_sequence,                                      //
+    test_wuffs_jpeg_decode_bricks_color,                                //
+    test_wuffs_jpeg_decode_bricks_color_422,                            //
+    test_wuffs_jpeg_decode_bricks_color_440,                            //
+    test_wuffs_jpeg_decode_bricks_color_progressive,                    //
+    test_wuffs_jpeg_decode_bricks_color_restart,                        //
+    test_wuffs_jpeg_decode_bricks_gray,                                 //
+    test_wuffs_jpeg_decode_downscaled_bricks_color_half,                //
+    test_wuffs_jpeg_decode_downscaled_bricks_color_quarter,             //
+    test_wuffs_jpeg_decode_downscaled_bricks_color_eighth,              //
+    test_wuffs_jpeg_decode_downscaled_bricks_color_422_half,            //
+    test_wuffs_jpeg_decode_downscaled_bricks_color_progressive_eighth,  //
+    test_wuffs_jpeg_decode_downscaled_bricks_gray_quarter,              //
+    test_wuffs_jpeg_decode_downscaled_frame_options,                    //
+    test_wuffs_jpeg_decode_downscaled_harvesters_eighth,                //
+    test_wuffs_jpeg_decode_downscaled_planes_bricks_color_half,         //
+    test_wuffs_jpeg_decode_downscaled_planes_bricks_color_eighth,       //
+    test_wuffs_jpeg_decode_harvesters,                                  //
+    test_wuffs_jpeg_decode_hippopotamus,                                //
+    test_wuffs_jpeg_decode_image_config,                                //
+    test_wuffs_jpeg_decode_image_config_downscaled,                     //
+    test_wuffs_jpeg_decode_image_decoder,
+    test_wuffs_jpeg_decode_input_is_a_png,                //
+    test_wuffs_jpeg_decode_many_small_reads,              //
+    test_wuffs_jpeg_decode_many_small_reads_progressive,  //
+    test_wuffs_jpeg_decode_pjw_thumbnail,                 //
+    test_wuffs_jpeg_decode_planes_bricks_color,           //
+    test_wuffs_jpeg_decode_planes_bricks_gray,            //
+    test_wuffs_jpeg_decode_rgb,                           //
+    test_wuffs_jpeg_decode_truncated,                     //
+
+#ifdef WUFFS_MIMIC
+
+    test_mimic_jpeg_decode_bricks_color,              //
+    test_mimic_jpeg_decode_bricks_color_422,          //
+    test_mimic_jpeg_decode_bricks_color_440,          //
+    test_mimic_jpeg_decode_bricks_color_progressive,  //
+    test_mimic_jpeg_decode_bricks_color_restart,      //
+    test_mimic_jpeg_decode_bricks_gray,               //
+    test_mimic_jpeg_decode_downscaled_half,           //
+    test_mimic_jpeg_decode_downscaled_quarter,        //
+    test_mimic_jpeg_decode_downscaled_eighth,         //
+    test_mimic_jpeg_decode_harvesters,                //
+    test_mimic_jpeg_decode_harvesters_progressive,    //
+    test_mimic_jpeg_decode_hat,                       //
+    test_mimic_jpeg_decode_hibiscus,                  //
+    test_mimic_jpeg_decode_hippopotamus,              //
+    test_mimic_jpeg_decode_pjw_thumbnail,             //
+
+#endif  // WUFFS_MIMIC
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_base_convert_ycc_420,            //
+    bench_wuffs_base_convert_ycc_444,            //
+    bench_wuffs_base_idct_8x8,                   //
+    bench_wuffs_base_idct_8x8__fallback,         //
+    bench_wuffs_jpeg_decode_9k_420,              //
+    bench_wuffs_jpeg_decode_9k_progressive,      //
+    bench_wuffs_jpeg_decode_59k_420,             //
+    bench_wuffs_jpeg_decode_402k_420,            //
+    bench_wuffs_jpeg_decode_planes_402k_420,     //
+    bench_wuffs_jpeg_decode_thumbnail_402k_420,  //
+#ifdef WUFFS_MIMIC
+
+    bench_mimic_jpeg_decode_9k_420,              //
+    bench_mimic_jpeg_decode_9k_progressive,      //
+    bench_mimic_jpeg_decode_59k_420,             //
+    bench_mimic_jpeg_decode_402k_420,            //
+    bench_mimic_jpeg_decode_thumbnail_402k_420,  //
+#endif                                           // WUFFS_MIMIC
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "std/jpeg";
+  return test_main(argc, argv, tests, benches);
+}
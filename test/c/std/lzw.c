@@ -64,12 +64,17 @@ the first "./a.out" with "./a.out -bench". Combine these changes with the
 
 // ---------------- LZW Tests
 
-bool do_test_wuffs_lzw_decode(const char* src_filename,
-                              uint64_t src_size,
-                              const char* want_filename,
-                              uint64_t want_size,
-                              uint64_t wlimit,
-                              uint64_t rlimit) {
+// do_test_wuffs_lzw_decode_flavor tests decoding GIF flavored LZW, where the
+// src file starts with a literal width byte and codes are LSB first, or, if
+// msb_first, TIFF or PDF flavored LZW, with no literal width byte.
+bool do_test_wuffs_lzw_decode_flavor(const char* src_filename,
+                                     uint64_t src_size,
+                                     const char* want_filename,
+                                     uint64_t want_size,
+                                     bool msb_first,
+                                     bool early_change,
+                                     uint64_t wlimit,
+                                     uint64_t rlimit) {
   wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
       .data = global_got_slice,
   });
@@ -87,13 +92,16 @@ bool do_test_wuffs_lzw_decode(const char* src_filename,
     FAIL("src size: got %d, want %d", (int)(src.meta.wi), (int)(src_size));
     return false;
   }
-  // The first byte in that file, the LZW literal width, should be 0x08.
-  uint8_t literal_width = src.data.ptr[0];
-  if (literal_width != 0x08) {
-    FAIL("LZW literal width: got %d, want %d", (int)(src.data.ptr[0]), 0x08);
-    return false;
+  uint8_t literal_width = 8;
+  if (!msb_first) {
+    // The first byte in that file, the LZW literal width, should be 0x08.
+    literal_width = src.data.ptr[0];
+    if (literal_width != 0x08) {
+      FAIL("LZW literal width: got %d, want %d", (int)(src.data.ptr[0]), 0x08);
+      return false;
+    }
+    src.meta.ri++;
   }
-  src.meta.ri++;
 
   if (!read_file(&want, want_filename)) {
     return false;
@@ -111,6 +119,8 @@ bool do_test_wuffs_lzw_decode(const char* src_filename,
     return false;
   }
   wuffs_lzw__decoder__set_literal_width(&dec, literal_width);
+  wuffs_lzw__decoder__set_msb_first(&dec, msb_first);
+  wuffs_lzw__decoder__set_early_change(&dec, early_change);
   int num_iters = 0;
   while (true) {
     num_iters++;
@@ -170,6 +180,17 @@ bool do_test_wuffs_lzw_decode(const char* src_filename,
   return io_buffers_equal("", &got, &want);
 }
 
+bool do_test_wuffs_lzw_decode(const char* src_filename,
+                              uint64_t src_size,
+                              const char* want_filename,
+                              uint64_t want_size,
+                              uint64_t wlimit,
+                              uint64_t rlimit) {
+  return do_test_wuffs_lzw_decode_flavor(src_filename, src_size, want_filename,
+                                         want_size, false, false, wlimit,
+                                         rlimit);
+}
+
 void test_wuffs_lzw_decode_many_big_reads() {
   CHECK_FOCUS(__func__);
   do_test_wuffs_lzw_decode("../../data/bricks-gray.indexes.giflzw", 14731,
@@ -200,9 +221,263 @@ void test_wuffs_lzw_decode_pi() {
                            "../../data/pi.txt", 100003, 0, 0);
 }
 
+void test_wuffs_lzw_decode_msb_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_decode_flavor("../../data/bricks-nodither.indexes.msblzw",
+                                  13396, "../../data/bricks-nodither.indexes",
+                                  19200, true, false, 0, 0);
+}
+
+void test_wuffs_lzw_decode_msb_early_change_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_decode_flavor("../../data/bricks-gray.indexes.tifflzw",
+                                  14729, "../../data/bricks-gray.indexes",
+                                  19200, true, true, 0, 0);
+}
+
+void test_wuffs_lzw_decode_msb_early_change_many_small_writes_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_decode_flavor("../../data/bricks-gray.indexes.tifflzw",
+                                  14729, "../../data/bricks-gray.indexes",
+                                  19200, true, true, 41, 43);
+}
+
+void test_wuffs_lzw_decode_msb_early_change_pi() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_decode_flavor("../../data/pi.txt.tifflzw", 50571,
+                                  "../../data/pi.txt", 100003, true, true, 0,
+                                  0);
+}
+
+// do_wuffs_lzw_encode encodes all of src, appending to dst. A non-zero wlimit
+// or rlimit means that the encoder is given at most that many bytes at a time.
+bool do_wuffs_lzw_encode(wuffs_base__io_buffer* dst,
+                         wuffs_base__io_buffer* src,
+                         uint32_t literal_width,
+                         uint64_t wlimit,
+                         uint64_t rlimit) {
+  wuffs_lzw__encoder enc = ((wuffs_lzw__encoder){});
+  wuffs_base__status z =
+      wuffs_lzw__encoder__check_wuffs_version(&enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_lzw__encoder__set_literal_width(&enc, literal_width);
+  int num_iters = 0;
+  while (true) {
+    num_iters++;
+    wuffs_base__io_writer dst_writer = wuffs_base__io_buffer__writer(dst);
+    if (wlimit) {
+      set_writer_limit(&dst_writer, wlimit);
+    }
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    size_t old_wi = dst->meta.wi;
+    size_t old_ri = src->meta.ri;
+
+    z = wuffs_lzw__encoder__encode(&enc, dst_writer, src_reader);
+    if (!z) {
+      if (src->meta.ri != src->meta.wi) {
+        FAIL("encode returned \"ok\" but src was not exhausted");
+        return false;
+      }
+      break;
+    }
+    if ((z != wuffs_base__suspension__short_read) &&
+        (z != wuffs_base__suspension__short_write)) {
+      FAIL("encode: got \"%s\", want \"%s\" or \"%s\"", z,
+           wuffs_base__suspension__short_read,
+           wuffs_base__suspension__short_write);
+      return false;
+    }
+    if ((dst->meta.wi == old_wi) && (src->meta.ri == old_ri)) {
+      FAIL("no progress was made");
+      return false;
+    }
+  }
+
+  if ((wlimit || rlimit) && (num_iters <= 1)) {
+    FAIL("num_iters: got %d, want > 1", num_iters);
+    return false;
+  }
+  return true;
+}
+
+bool do_test_wuffs_lzw_encode(wuffs_base__io_buffer* src,
+                              uint32_t literal_width,
+                              uint64_t wlimit,
+                              uint64_t rlimit) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer work = ((wuffs_base__io_buffer){
+      .data = global_work_slice,
+  });
+
+  if (!do_wuffs_lzw_encode(&work, src, literal_width, wlimit, rlimit)) {
+    return false;
+  }
+  work.meta.closed = true;
+
+  // Round-trip the encoded form through the decoder.
+  wuffs_lzw__decoder dec = ((wuffs_lzw__decoder){});
+  wuffs_base__status z =
+      wuffs_lzw__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_lzw__decoder__set_literal_width(&dec, literal_width);
+  z = wuffs_lzw__decoder__decode(&dec, wuffs_base__io_buffer__writer(&got),
+                                 wuffs_base__io_buffer__reader(&work));
+  if (z) {
+    FAIL("decode: \"%s\"", z);
+    return false;
+  }
+  if (work.meta.ri != work.meta.wi) {
+    FAIL("decode returned \"ok\" but work was not exhausted");
+    return false;
+  }
+  src->meta.ri = 0;
+  return io_buffers_equal("", &got, src);
+}
+
+bool do_test_wuffs_lzw_encode_file(const char* filename,
+                                   uint64_t size,
+                                   uint64_t wlimit,
+                                   uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  if (src.meta.wi != size) {
+    FAIL("src size: got %d, want %d", (int)(src.meta.wi), (int)(size));
+    return false;
+  }
+  return do_test_wuffs_lzw_encode(&src, 8, wlimit, rlimit);
+}
+
+// do_test_wuffs_lzw_encode_matches checks that encoding src_filename gives
+// exactly want_filename, a GIF flavored LZW file (with a literal width byte)
+// that was extracted from a GIF made by another encoder. Unlike round-tripping
+// through this package's decoder, this catches encoder bugs that the decoder
+// shares, such as when to widen codes or to clear the dictionary.
+bool do_test_wuffs_lzw_encode_matches(const char* src_filename,
+                                      const char* want_filename,
+                                      uint64_t wlimit,
+                                      uint64_t rlimit) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, src_filename) || !read_file(&want, want_filename)) {
+    return false;
+  }
+  if (want.meta.wi == 0) {
+    FAIL("want is empty");
+    return false;
+  }
+  uint8_t literal_width = want.data.ptr[0];
+  got.data.ptr[got.meta.wi++] = literal_width;
+  if (!do_wuffs_lzw_encode(&got, &src, literal_width, wlimit, rlimit)) {
+    return false;
+  }
+  return io_buffers_equal("", &got, &want);
+}
+
+void test_wuffs_lzw_encode_matches_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_matches("../../data/bricks-dither.indexes",
+                                   "../../data/bricks-dither.indexes.giflzw", 0,
+                                   0);
+}
+
+void test_wuffs_lzw_encode_matches_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_matches("../../data/bricks-gray.indexes",
+                                   "../../data/bricks-gray.indexes.giflzw", 0,
+                                   0);
+}
+
+void test_wuffs_lzw_encode_matches_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_matches("../../data/bricks-nodither.indexes",
+                                   "../../data/bricks-nodither.indexes.giflzw",
+                                   0, 0);
+}
+
+void test_wuffs_lzw_encode_matches_many_small_writes_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_matches("../../data/bricks-gray.indexes",
+                                   "../../data/bricks-gray.indexes.giflzw", 41,
+                                   43);
+}
+
+// There is no test that encoding pi.txt matches pi.txt.giflzw. That file's
+// encoder did not start with a clear code, which is valid but not what this
+// package's encoder does.
+
+void test_wuffs_lzw_encode_many_small_writes_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_file("../../data/bricks-gray.indexes", 19200, 41,
+                                43);
+}
+
+void test_wuffs_lzw_encode_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_file("../../data/bricks-dither.indexes", 19200, 0,
+                                0);
+}
+
+void test_wuffs_lzw_encode_empty() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  src.meta.closed = true;
+  do_test_wuffs_lzw_encode(&src, 8, 0, 0);
+}
+
+void test_wuffs_lzw_encode_literal_width_2() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  // A long, only partly repetitive sequence of 2-bit values, so that the
+  // dictionary fills up (and is cleared) many times.
+  uint32_t x = 1;
+  size_t i;
+  for (i = 0; i < 100000; i++) {
+    x = (x * 1103515245) + 12345;
+    src.data.ptr[i] = (uint8_t)((x >> 16) & 3) & (uint8_t)(i >> 12);
+  }
+  src.meta.wi = 100000;
+  src.meta.closed = true;
+  do_test_wuffs_lzw_encode(&src, 2, 0, 0);
+}
+
+void test_wuffs_lzw_encode_pi() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_lzw_encode_file("../../data/pi.txt", 100003, 0, 0);
+}
+
 // ---------------- LZW Benches
 
-bool do_bench_wuffs_lzw_decode(const char* filename, uint64_t iters_unscaled) {
+bool do_bench_wuffs_lzw_decode_flavor(const char* filename,
+                                      bool msb_first,
+                                      bool early_change,
+                                      uint64_t iters_unscaled) {
   wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
       .data = global_got_slice,
   });
@@ -219,10 +494,14 @@ bool do_bench_wuffs_lzw_decode(const char* filename, uint64_t iters_unscaled) {
     FAIL("src size: got %d, want > 0", (int)(src.meta.wi));
     return false;
   }
-  uint8_t literal_width = src.data.ptr[0];
-  if (literal_width != 0x08) {
-    FAIL("LZW literal width: got %d, want %d", (int)(src.data.ptr[0]), 0x08);
-    return false;
+  size_t src_ri = 0;
+  if (!msb_first) {
+    uint8_t literal_width = src.data.ptr[0];
+    if (literal_width != 0x08) {
+      FAIL("LZW literal width: got %d, want %d", (int)(src.data.ptr[0]), 0x08);
+      return false;
+    }
+    src_ri = 1;  // Skip the literal width.
   }
 
   bench_start();
@@ -231,7 +510,7 @@ bool do_bench_wuffs_lzw_decode(const char* filename, uint64_t iters_unscaled) {
   uint64_t iters = iters_unscaled * iterscale;
   for (i = 0; i < iters; i++) {
     got.meta.wi = 0;
-    src.meta.ri = 1;  // Skip the literal width.
+    src.meta.ri = src_ri;
     wuffs_lzw__decoder dec = ((wuffs_lzw__decoder){});
     wuffs_base__status z = wuffs_lzw__decoder__check_wuffs_version(
         &dec, sizeof dec, WUFFS_VERSION);
@@ -239,6 +518,8 @@ bool do_bench_wuffs_lzw_decode(const char* filename, uint64_t iters_unscaled) {
       FAIL("check_wuffs_version: \"%s\"", z);
       return false;
     }
+    wuffs_lzw__decoder__set_msb_first(&dec, msb_first);
+    wuffs_lzw__decoder__set_early_change(&dec, early_change);
     z = wuffs_lzw__decoder__decode(&dec, got_writer, src_reader);
     if (z) {
       FAIL("decode: \"%s\"", z);
@@ -252,12 +533,78 @@ bool do_bench_wuffs_lzw_decode(const char* filename, uint64_t iters_unscaled) {
 
 void bench_wuffs_lzw_decode_20k() {
   CHECK_FOCUS(__func__);
-  do_bench_wuffs_lzw_decode("../../data/bricks-gray.indexes.giflzw", 50);
+  do_bench_wuffs_lzw_decode_flavor("../../data/bricks-gray.indexes.giflzw",
+                                   false, false, 50);
 }
 
 void bench_wuffs_lzw_decode_100k() {
   CHECK_FOCUS(__func__);
-  do_bench_wuffs_lzw_decode("../../data/pi.txt.giflzw", 10);
+  do_bench_wuffs_lzw_decode_flavor("../../data/pi.txt.giflzw", false, false,
+                                   10);
+}
+
+void bench_wuffs_lzw_decode_tiff_20k() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_lzw_decode_flavor("../../data/bricks-gray.indexes.tifflzw",
+                                   true, true, 50);
+}
+
+void bench_wuffs_lzw_decode_tiff_100k() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_lzw_decode_flavor("../../data/pi.txt.tifflzw", true, true, 10);
+}
+
+bool do_bench_wuffs_lzw_encode(const char* filename, uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_writer got_writer = wuffs_base__io_buffer__writer(&got);
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  if (src.meta.wi <= 0) {
+    FAIL("src size: got %d, want > 0", (int)(src.meta.wi));
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    wuffs_lzw__encoder enc = ((wuffs_lzw__encoder){});
+    wuffs_base__status z = wuffs_lzw__encoder__check_wuffs_version(
+        &enc, sizeof enc, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return false;
+    }
+    z = wuffs_lzw__encoder__encode(&enc, got_writer, src_reader);
+    if (z) {
+      FAIL("encode: \"%s\"", z);
+      return false;
+    }
+    n_bytes += src.meta.ri;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_lzw_encode_20k() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_lzw_encode("../../data/bricks-gray.indexes", 50);
+}
+
+void bench_wuffs_lzw_encode_100k() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_lzw_encode("../../data/pi.txt", 10);
 }
 
 // ---------------- Manifest
@@ -265,11 +612,24 @@ void bench_wuffs_lzw_decode_100k() {
 // The empty comments forces clang-format to place one element per line.
 proc tests[] = {
 
-    test_wuffs_lzw_decode_many_big_reads,           //
-    test_wuffs_lzw_decode_many_small_writes_reads,  //
-    test_wuffs_lzw_decode_bricks_dither,            //
-    test_wuffs_lzw_decode_bricks_nodither,          //
-    test_wuffs_lzw_decode_pi,                       //
+    test_wuffs_lzw_decode_many_big_reads,                            //
+    test_wuffs_lzw_decode_many_small_writes_reads,                   //
+    test_wuffs_lzw_decode_bricks_dither,                             //
+    test_wuffs_lzw_decode_bricks_nodither,                           //
+    test_wuffs_lzw_decode_msb_bricks_nodither,                       //
+    test_wuffs_lzw_decode_msb_early_change_bricks_gray,              //
+    test_wuffs_lzw_decode_msb_early_change_many_small_writes_reads,  //
+    test_wuffs_lzw_decode_msb_early_change_pi,                       //
+    test_wuffs_lzw_decode_pi,                                        //
+    test_wuffs_lzw_encode_bricks_dither,                             //
+    test_wuffs_lzw_encode_empty,                                     //
+    test_wuffs_lzw_encode_literal_width_2,                           //
+    test_wuffs_lzw_encode_many_small_writes_reads,                   //
+    test_wuffs_lzw_encode_matches_bricks_dither,                     //
+    test_wuffs_lzw_encode_matches_bricks_gray,                       //
+    test_wuffs_lzw_encode_matches_bricks_nodither,                   //
+    test_wuffs_lzw_encode_matches_many_small_writes_reads,           //
+    test_wuffs_lzw_encode_pi,                                        //
 
     NULL,
 };
@@ -277,8 +637,12 @@ proc tests[] = {
 // The empty comments forces clang-format to place one element per line.
 proc benches[] = {
 
-    bench_wuffs_lzw_decode_20k,   //
-    bench_wuffs_lzw_decode_100k,  //
+    bench_wuffs_lzw_decode_20k,        //
+    bench_wuffs_lzw_decode_100k,       //
+    bench_wuffs_lzw_decode_tiff_20k,   //
+    bench_wuffs_lzw_decode_tiff_100k,  //
+    bench_wuffs_lzw_encode_20k,        //
+    bench_wuffs_lzw_encode_100k,       //
 
     NULL,
 };
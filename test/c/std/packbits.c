@@ -0,0 +1,344 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test" or "wuffs
+bench" commands. These commands take an optional "-mimic" flag to check that
+Wuffs' output mimics (i.e. exactly matches) other libraries' output, such as
+giflib for GIF, libpng for PNG, etc.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror packbits.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+Add the "wuffs mimic cflags" (everything after the colon below) to the C
+compiler flags (after the .c file) to run the mimic tests.
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench". Combine these changes with the
+"wuffs mimic cflags" to run the mimic benchmarks.
+*/
+
+// !! wuffs mimic cflags: -DWUFFS_MIMIC
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__BASE
+#define WUFFS_CONFIG__MODULE__PACKBITS
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../../release/c/wuffs-unsupported-snapshot.h"
+#include "../testlib/testlib.c"
+
+// ---------------- PackBits Tests
+
+bool do_test_wuffs_packbits_decode(wuffs_base__io_buffer* src,
+                                   wuffs_base__io_buffer* want,
+                                   uint64_t wlimit,
+                                   uint64_t rlimit) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  wuffs_packbits__decoder dec = ((wuffs_packbits__decoder){});
+  wuffs_base__status z = wuffs_packbits__decoder__check_wuffs_version(
+      &dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  int num_iters = 0;
+  while (true) {
+    num_iters++;
+    wuffs_base__io_writer got_writer = wuffs_base__io_buffer__writer(&got);
+    if (wlimit) {
+      set_writer_limit(&got_writer, wlimit);
+    }
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    size_t old_wi = got.meta.wi;
+    size_t old_ri = src->meta.ri;
+
+    z = wuffs_packbits__decoder__decode(&dec, got_writer, src_reader);
+    if (!z) {
+      if (src->meta.ri != src->meta.wi) {
+        FAIL("decode returned \"ok\" but src was not exhausted");
+        return false;
+      }
+      break;
+    }
+    if ((z != wuffs_base__suspension__short_read) &&
+        (z != wuffs_base__suspension__short_write)) {
+      FAIL("decode: got \"%s\", want \"%s\" or \"%s\"", z,
+           wuffs_base__suspension__short_read,
+           wuffs_base__suspension__short_write);
+      return false;
+    }
+
+    if (got.meta.wi < old_wi) {
+      FAIL("write index got.wi went backwards");
+      return false;
+    }
+    if (src->meta.ri < old_ri) {
+      FAIL("read index src.ri went backwards");
+      return false;
+    }
+    if ((got.meta.wi == old_wi) && (src->meta.ri == old_ri)) {
+      FAIL("no progress was made");
+      return false;
+    }
+  }
+
+  if (wlimit || rlimit) {
+    if (num_iters <= 1) {
+      FAIL("num_iters: got %d, want > 1", num_iters);
+      return false;
+    }
+  } else {
+    if (num_iters != 1) {
+      FAIL("num_iters: got %d, want 1", num_iters);
+      return false;
+    }
+  }
+
+  return io_buffers_equal("", &got, want);
+}
+
+bool do_test_wuffs_packbits_decode_file(const char* src_filename,
+                                        uint64_t src_size,
+                                        const char* want_filename,
+                                        uint64_t want_size,
+                                        uint64_t wlimit,
+                                        uint64_t rlimit) {
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, src_filename)) {
+    return false;
+  }
+  if (src.meta.wi != src_size) {
+    FAIL("src size: got %d, want %d", (int)(src.meta.wi), (int)(src_size));
+    return false;
+  }
+  if (!read_file(&want, want_filename)) {
+    return false;
+  }
+  if (want.meta.wi != want_size) {
+    FAIL("want size: got %d, want %d", (int)(want.meta.wi), (int)(want_size));
+    return false;
+  }
+  return do_test_wuffs_packbits_decode(&src, &want, wlimit, rlimit);
+}
+
+void test_wuffs_packbits_decode_many_big_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_packbits_decode_file(
+      "../../data/bricks-nodither.indexes.packbits", 16327,
+      "../../data/bricks-nodither.indexes", 19200, 0, 4096);
+}
+
+void test_wuffs_packbits_decode_many_small_writes_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_packbits_decode_file(
+      "../../data/bricks-nodither.indexes.packbits", 16327,
+      "../../data/bricks-nodither.indexes", 19200, 41, 43);
+}
+
+void test_wuffs_packbits_decode_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_packbits_decode_file(
+      "../../data/bricks-nodither.indexes.packbits", 16327,
+      "../../data/bricks-nodither.indexes", 19200, 0, 0);
+}
+
+void test_wuffs_packbits_decode_pi() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_packbits_decode_file("../../data/pi.txt.packbits", 100280,
+                                     "../../data/pi.txt", 100003, 0, 0);
+}
+
+void test_wuffs_packbits_decode_tn1023() {
+  CHECK_FOCUS(__func__);
+  // This is the example from Apple's Technical Note TN1023, with a -128
+  // no-op header byte inserted.
+  static const uint8_t src_bytes[] = {
+      0xFE, 0xAA, 0x02, 0x80, 0x00, 0x2A, 0x80, 0xFD,
+      0xAA, 0x03, 0x80, 0x00, 0x2A, 0x22, 0xF7, 0xAA,
+  };
+  static const uint8_t want_bytes[] = {
+      0xAA, 0xAA, 0xAA, 0x80, 0x00, 0x2A, 0xAA, 0xAA, 0xAA, 0xAA, 0x80, 0x00,
+      0x2A, 0x22, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+  };
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  memcpy(src.data.ptr, src_bytes, sizeof src_bytes);
+  src.meta.wi = sizeof src_bytes;
+  src.meta.closed = true;
+  memcpy(want.data.ptr, want_bytes, sizeof want_bytes);
+  want.meta.wi = sizeof want_bytes;
+  do_test_wuffs_packbits_decode(&src, &want, 0, 0);
+}
+
+void test_wuffs_packbits_decode_truncated_input() {
+  CHECK_FOCUS(__func__);
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  // A literal run header promises 4 bytes, but only 2 follow.
+  src.data.ptr[0] = 0x03;
+  src.data.ptr[1] = 0x41;
+  src.data.ptr[2] = 0x42;
+  src.meta.wi = 3;
+  src.meta.closed = true;
+
+  wuffs_packbits__decoder dec = ((wuffs_packbits__decoder){});
+  wuffs_base__status z = wuffs_packbits__decoder__check_wuffs_version(
+      &dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  z = wuffs_packbits__decoder__decode(&dec, wuffs_base__io_buffer__writer(&got),
+                                      wuffs_base__io_buffer__reader(&src));
+  if (z != wuffs_packbits__error__truncated_input) {
+    FAIL("decode: got \"%s\", want \"%s\"", z,
+         wuffs_packbits__error__truncated_input);
+    return;
+  }
+  if (got.meta.wi != 2) {
+    FAIL("got.meta.wi: got %d, want 2", (int)(got.meta.wi));
+    return;
+  }
+}
+
+// ---------------- PackBits Benches
+
+bool do_bench_wuffs_packbits_decode(const char* filename,
+                                    uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_writer got_writer = wuffs_base__io_buffer__writer(&got);
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  if (src.meta.wi <= 0) {
+    FAIL("src size: got %d, want > 0", (int)(src.meta.wi));
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    wuffs_packbits__decoder dec = ((wuffs_packbits__decoder){});
+    wuffs_base__status z = wuffs_packbits__decoder__check_wuffs_version(
+        &dec, sizeof dec, WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return false;
+    }
+    z = wuffs_packbits__decoder__decode(&dec, got_writer, src_reader);
+    if (z) {
+      FAIL("decode: \"%s\"", z);
+      return false;
+    }
+    n_bytes += got.meta.wi;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_packbits_decode_20k() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_packbits_decode("../../data/bricks-nodither.indexes.packbits",
+                                 50);
+}
+
+void bench_wuffs_packbits_decode_100k() {
+  CHECK_FOCUS(__func__);
+  do_bench_wuffs_packbits_decode("../../data/pi.txt.packbits", 10);
+}
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_packbits_decode_bricks_nodither,          //
+    test_wuffs_packbits_decode_many_big_reads,           //
+    test_wuffs_packbits_decode_many_small_writes_reads,  //
+    test_wuffs_packbits_decode_pi,                       //
+    test_wuffs_packbits_decode_tn1023,                   //
+    test_wuffs_packbits_decode_truncated_input,          //
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_packbits_decode_20k,   //
+    bench_wuffs_packbits_decode_100k,  //
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "std/packbits";
+  return test_main(argc, argv, tests, benches);
+}
@@ -0,0 +1,1632 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test" or "wuffs
+bench" commands. These commands take an optional "-mimic" flag to check that
+Wuffs' output mimics (i.e. exactly matches) other libraries' output, such as
+giflib for GIF, libpng for PNG, etc.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror png.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+Add the "wuffs mimic cflags" (everything after the colon below) to the C
+compiler flags (after the .c file) to run the mimic tests.
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench". Combine these changes with the
+"wuffs mimic cflags" to run the mimic benchmarks.
+*/
+
+// !! wuffs mimic cflags: -DWUFFS_MIMIC -lpng
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__ADLER32
+#define WUFFS_CONFIG__MODULE__BASE
+#define WUFFS_CONFIG__MODULE__CRC32
+#define WUFFS_CONFIG__MODULE__DEFLATE
+#define WUFFS_CONFIG__MODULE__PNG
+#define WUFFS_CONFIG__MODULE__ZLIB
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../../release/c/wuffs-unsupported-snapshot.h"
+#include "../testlib/testlib.c"
+#ifdef WUFFS_MIMIC
+#include "../mimiclib/png.c"
+#endif
+
+// ---------------- PNG Tests
+
+// do_wuffs_png_decode decodes src's image to dst, in the given pixel format.
+// A non-zero rlimit means that the src is fed to the decoder at most rlimit
+// bytes at a time.
+const char* do_wuffs_png_decode(wuffs_base__io_buffer* dst,
+                                wuffs_base__io_buffer* src,
+                                wuffs_base__pixel_format pixfmt,
+                                uint64_t rlimit) {
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_png__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, 0, wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_png__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+const char* wuffs_png_decode(wuffs_base__io_buffer* dst,
+                             wuffs_base__io_buffer* src) {
+  return do_wuffs_png_decode(dst, src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                             0);
+}
+
+// do_wuffs_png_decode_rows is like do_wuffs_png_decode, but decodes one row at
+// a time, into a pixel buffer only one row high and with the smallest workbuf
+// that the decoder allows. Each row is copied to dst as soon as it is decoded.
+const char* do_wuffs_png_decode_rows(wuffs_base__io_buffer* dst,
+                                     wuffs_base__io_buffer* src,
+                                     uint64_t rlimit) {
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_png__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0, width, 1);
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).min_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  wuffs_base__decode_frame_options opts =
+      ((wuffs_base__decode_frame_options){});
+  wuffs_base__decode_frame_options__initialize(&opts, 0, false, true);
+
+  uint32_t y = 0;
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_png__decoder__decode_frame(&dec, &pb, src_reader, workbuf, &opts);
+    if (z == wuffs_base__suspension__short_read) {
+      if (src->meta.ri == src->meta.wi) {
+        break;
+      }
+      continue;
+    } else if (z && (z != wuffs_png__suspension__end_of_row)) {
+      break;
+    }
+
+    if (wuffs_png__decoder__num_decoded_rows(&dec) != (y + 1)) {
+      return "num_decoded_rows: unexpected value";
+    }
+    y++;
+    const char* msg = copy_to_io_buffer_from_pixel_buffer(
+        dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+    if (msg) {
+      return msg;
+    }
+    if (!z) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+  if (y != height) {
+    return "decoded rows: unexpected count";
+  }
+  return NULL;
+}
+
+const char* wuffs_png_decode_rows(wuffs_base__io_buffer* dst,
+                                  wuffs_base__io_buffer* src) {
+  return do_wuffs_png_decode_rows(dst, src, 0);
+}
+
+// bmp_decode decodes the uncompressed, bottom-up, 1, 8 or 24 bits per pixel
+// BMP image in src to dst, as BGRA_NONPREMUL pixels. The test/data BMP files
+// hold the same images as their PNG counterparts, so that they can serve as a
+// simple, independent source of truth. The 8 bits per pixel ones are RLE
+// compressed, which bmp_decode does not support, so their PNG counterparts
+// are instead checked against the GIF-derived *.palette and *.indexes files.
+const char* bmp_decode(wuffs_base__io_buffer* dst, wuffs_base__io_buffer* src) {
+  uint8_t* p = src->data.ptr + src->meta.ri;
+  size_t n = src->meta.wi - src->meta.ri;
+  if ((n < 54) || (p[0] != 'B') || (p[1] != 'M')) {
+    return "bmp_decode: bad header";
+  }
+  uint32_t pix_offset = wuffs_base__load_u32le(p + 10);
+  uint32_t hdr_size = wuffs_base__load_u32le(p + 14);
+  uint32_t width = wuffs_base__load_u32le(p + 18);
+  uint32_t height = wuffs_base__load_u32le(p + 22);
+  uint32_t bpp = wuffs_base__load_u16le(p + 28);
+  if ((bpp != 1) && (bpp != 8) && (bpp != 24)) {
+    return "bmp_decode: unsupported bits per pixel";
+  }
+  if (wuffs_base__load_u32le(p + 30) != 0) {
+    return "bmp_decode: unsupported compression";
+  }
+  if ((width > 0x4000) || (height > 0x4000) || (pix_offset > n) ||
+      (hdr_size > (pix_offset - 14))) {
+    return "bmp_decode: bad header";
+  }
+  const uint8_t* palette = p + 14 + hdr_size;
+  size_t palette_len = (pix_offset - 14 - hdr_size) / 4;
+  size_t stride = ((((size_t)width) * bpp + 31) / 32) * 4;
+  if ((n - pix_offset) / stride < height) {
+    return "bmp_decode: not enough pixel data";
+  }
+  if ((dst->data.len - dst->meta.wi) / 4 / width < height) {
+    return "bmp_decode: dst buffer is too small";
+  }
+
+  uint8_t* d = dst->data.ptr + dst->meta.wi;
+  uint32_t y;
+  for (y = 0; y < height; y++) {
+    const uint8_t* row = p + pix_offset + ((height - 1 - y) * stride);
+    uint32_t x;
+    for (x = 0; x < width; x++) {
+      if (bpp == 24) {
+        d[0] = row[(3 * x) + 0];
+        d[1] = row[(3 * x) + 1];
+        d[2] = row[(3 * x) + 2];
+      } else {
+        size_t i = (bpp == 8) ? row[x] : (1 & (row[x / 8] >> (7 - (x % 8))));
+        if (i >= palette_len) {
+          return "bmp_decode: palette index out of range";
+        }
+        d[0] = palette[(4 * i) + 0];
+        d[1] = palette[(4 * i) + 1];
+        d[2] = palette[(4 * i) + 2];
+      }
+      d[3] = 0xFF;
+      d += 4;
+    }
+  }
+  dst->meta.wi += ((size_t)width) * height * 4;
+  return NULL;
+}
+
+bool do_test_wuffs_png_decode(const char* png_filename,
+                              const char* bmp_filename,
+                              uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, bmp_filename)) {
+    return false;
+  }
+  const char* msg = bmp_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  msg = do_wuffs_png_decode(&got, &src,
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, rlimit);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+bool do_test_wuffs_png_decode_rows(const char* png_filename,
+                                   const char* bmp_filename,
+                                   uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, bmp_filename)) {
+    return false;
+  }
+  const char* msg = bmp_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  msg = do_wuffs_png_decode_rows(&got, &src, rlimit);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+bool do_test_wuffs_png_decode_indexed(const char* png_filename,
+                                      const char* palette_filename,
+                                      const char* indexes_filename) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  const char* msg = do_wuffs_png_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  if (!read_file(&want, indexes_filename)) {
+    return false;
+  }
+  if (!io_buffers_equal("indexes ", &got, &want)) {
+    return false;
+  }
+
+  // do_wuffs_png_decode decoded into global_pixel_slice. Where a pixel buffer
+  // set from that slice places its palette does not depend on the image size.
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0, 1, 1);
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  msg = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(&pb);
+  got = ((wuffs_base__io_buffer){
+      .data = palette,
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = palette.len,
+      }),
+  });
+  want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  if (!read_file(&want, palette_filename)) {
+    return false;
+  }
+  return io_buffers_equal("palette ", &got, &want);
+}
+
+// gather_idats replaces src's contents, a PNG file, with the concatenation of
+// its IDAT chunks' payloads: its zlib stream.
+const char* gather_idats(wuffs_base__io_buffer* src) {
+  uint8_t* p = src->data.ptr;
+  size_t n = src->meta.wi;
+  size_t i = 8;
+  size_t j = 0;
+  while ((i < n) && (12 <= (n - i))) {
+    uint32_t len = wuffs_base__load_u32be(p + i);
+    if (len > (n - i - 12)) {
+      return "gather_idats: bad chunk length";
+    }
+    if (!memcmp(p + i + 4, "IDAT", 4)) {
+      memmove(p + j, p + i + 8, len);
+      j += len;
+    }
+    i += 12 + len;
+  }
+  src->meta.ri = 0;
+  src->meta.wi = j;
+  return NULL;
+}
+
+void test_wuffs_png_call_sequence() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.png")) {
+    return;
+  }
+
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_png__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+  z = wuffs_png__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z) {
+    FAIL("decode_frame_config #0: got \"%s\"", z);
+    return;
+  }
+
+  z = wuffs_png__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z != wuffs_base__warning__end_of_data) {
+    FAIL("decode_frame_config #1: got \"%s\", want \"%s\"", z,
+         wuffs_base__warning__end_of_data);
+    return;
+  }
+
+  z = wuffs_png__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z != wuffs_base__error__bad_call_sequence) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__bad_call_sequence);
+    return;
+  }
+}
+
+// do_test_wuffs_png_checksum flips a bit in the CRC-32 checksum of every
+// chunk of the given type, and decodes the result. A non-zero rlimit means that
+// the src is fed to the decoder at most rlimit bytes at a time.
+bool do_test_wuffs_png_checksum(const char* filename,
+                                const char* chunk_type,
+                                bool ignore_checksum,
+                                uint64_t rlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  uint8_t* p = src.data.ptr;
+  size_t n = src.meta.wi;
+  size_t i = 8;
+  int num_flipped = 0;
+  while ((i < n) && (12 <= (n - i))) {
+    uint32_t len = wuffs_base__load_u32be(p + i);
+    if (len > (n - i - 12)) {
+      FAIL("bad chunk length");
+      return false;
+    }
+    if (!memcmp(p + i + 4, chunk_type, 4)) {
+      p[i + 8 + len] ^= 1;
+      num_flipped++;
+    }
+    i += 12 + len;
+  }
+  if (num_flipped == 0) {
+    FAIL("no \"%s\" chunks", chunk_type);
+    return false;
+  }
+
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_png__decoder__set_ignore_checksum(&dec, ignore_checksum);
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  int stage;
+  for (stage = 0; stage < 2; stage++) {
+    while (true) {
+      wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+      if (rlimit) {
+        set_reader_limit(&src_reader, rlimit);
+      }
+      if (stage == 0) {
+        z = wuffs_png__decoder__decode_image_config(&dec, &ic, src_reader);
+      } else {
+        wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+            .ptr = global_work_array,
+            .len = wuffs_base__image_config__workbuf_len(&ic).max_incl,
+        });
+        z = wuffs_png__decoder__decode_frame(&dec, &pb, src_reader, workbuf,
+                                             NULL);
+      }
+      if ((z != wuffs_base__suspension__short_read) ||
+          (src.meta.ri == src.meta.wi)) {
+        break;
+      }
+    }
+    if (z) {
+      break;
+    }
+    if (stage == 0) {
+      z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                                   global_pixel_slice);
+      if (z) {
+        FAIL("set_from_slice: \"%s\"", z);
+        return false;
+      }
+    }
+  }
+
+  const char* want_z = ignore_checksum ? NULL : wuffs_png__error__bad_checksum;
+  if (z != want_z) {
+    FAIL("%s, rlimit=%" PRIu64 ": got \"%s\", want \"%s\"", chunk_type, rlimit,
+         z, want_z);
+    return false;
+  }
+  return true;
+}
+
+// png_checksum_cases lists files and chunk types whose CRC-32 checksums the
+// checksum tests corrupt. They cover a skipped ancillary chunk, the single IDAT
+// chunk of bricks-dither.png and the several IDAT chunks of bricks-color.png.
+const char* png_checksum_cases[5][2] = {
+    {"../../data/bricks-dither.png", "IHDR"},
+    {"../../data/bricks-dither.png", "gAMA"},
+    {"../../data/bricks-dither.png", "PLTE"},
+    {"../../data/bricks-dither.png", "IDAT"},
+    {"../../data/bricks-color.png", "IDAT"},
+};
+
+void test_wuffs_png_checksum_ignore() {
+  CHECK_FOCUS(__func__);
+  int i;
+  for (i = 0; i < 5; i++) {
+    if (!do_test_wuffs_png_checksum(png_checksum_cases[i][0],
+                                    png_checksum_cases[i][1], true, 0)) {
+      return;
+    }
+  }
+}
+
+void test_wuffs_png_checksum_verify_bad() {
+  CHECK_FOCUS(__func__);
+  uint64_t rlimits[3] = {0, 1, 97};
+  int i;
+  for (i = 0; i < 5; i++) {
+    int j;
+    for (j = 0; j < 3; j++) {
+      if (!do_test_wuffs_png_checksum(png_checksum_cases[i][0],
+                                      png_checksum_cases[i][1], false,
+                                      rlimits[j])) {
+        return;
+      }
+    }
+  }
+}
+
+void test_wuffs_png_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/bricks-color.png",
+                           "../../data/bricks-color.bmp", 0);
+}
+
+void test_wuffs_png_decode_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode_indexed("../../data/bricks-dither.png",
+                                   "../../data/bricks-dither.palette",
+                                   "../../data/bricks-dither.indexes");
+}
+
+void test_wuffs_png_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-gray.png")) {
+    return;
+  }
+  const char* msg = wuffs_png_decode(&got, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  // The GIF version's palette maps each index to the gray of that value.
+  if (!read_file(&want, "../../data/bricks-gray.indexes")) {
+    return;
+  }
+  if ((got.meta.wi / 4) != want.meta.wi) {
+    FAIL("pixel count: got %zu, want %zu", got.meta.wi / 4, want.meta.wi);
+    return;
+  }
+  size_t i;
+  for (i = 0; i < want.meta.wi; i++) {
+    uint8_t* p = got.data.ptr + (4 * i);
+    uint8_t w = want.data.ptr[i];
+    if ((p[0] != w) || (p[1] != w) || (p[2] != w) || (p[3] != 0xFF)) {
+      FAIL("pixel #%zu: got 0x%02X%02X%02X%02X, want 0x%02X%02X%02XFF", i, p[0],
+           p[1], p[2], p[3], w, w, w);
+      return;
+    }
+  }
+}
+
+void test_wuffs_png_decode_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode_indexed("../../data/bricks-nodither.png",
+                                   "../../data/bricks-nodither.palette",
+                                   "../../data/bricks-nodither.indexes");
+}
+
+void test_wuffs_png_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/harvesters.png",
+                           "../../data/harvesters.bmp", 0);
+}
+
+void test_wuffs_png_decode_hippopotamus_interlaced() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/hippopotamus.interlaced.png",
+                           "../../data/hippopotamus.bmp", 0);
+}
+
+void test_wuffs_png_decode_hippopotamus_regular() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/hippopotamus.regular.png",
+                           "../../data/hippopotamus.bmp", 0);
+}
+
+void test_wuffs_png_decode_input_is_a_gif() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.gif")) {
+    return;
+  }
+
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_png__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z != wuffs_png__error__bad_header) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_png__error__bad_header);
+    return;
+  }
+}
+
+void test_wuffs_png_decode_interlaced_matches_regular() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  // Decode to RGBA, not BGRA, to exercise the red-blue swap.
+  if (!read_file(&src, "../../data/hippopotamus.regular.png")) {
+    return;
+  }
+  const char* msg = do_wuffs_png_decode(
+      &want, &src, WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL, 0);
+  if (msg) {
+    FAIL("regular: %s", msg);
+    return;
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, "../../data/hippopotamus.interlaced.png")) {
+    return;
+  }
+  msg = do_wuffs_png_decode(&got, &src,
+                            WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL, 0);
+  if (msg) {
+    FAIL("interlaced: %s", msg);
+    return;
+  }
+
+  io_buffers_equal("", &got, &want);
+}
+
+void test_wuffs_png_decode_many_small_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/bricks-color.png",
+                           "../../data/bricks-color.bmp", 13);
+}
+
+void test_wuffs_png_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/pjw-thumbnail.png",
+                           "../../data/pjw-thumbnail.bmp", 0);
+}
+
+void test_wuffs_png_decode_full_flush() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode("../../data/bricks-color.full-flush.png",
+                           "../../data/bricks-color.bmp", 0);
+}
+
+void test_wuffs_png_decode_row_group() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  wuffs_base__io_buffer work = ((wuffs_base__io_buffer){
+      .data = global_work_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-color.bmp")) {
+    return;
+  }
+  const char* msg = bmp_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+
+  // Two decoders, as if on two threads, each decode the image config.
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, "../../data/bricks-color.full-flush.png")) {
+    return;
+  }
+  wuffs_png__decoder decs[2];
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  int i;
+  for (i = 0; i < 2; i++) {
+    decs[i] = ((wuffs_png__decoder){});
+    wuffs_base__status z = wuffs_png__decoder__check_wuffs_version(
+        &decs[i], sizeof decs[i], WUFFS_VERSION);
+    if (z) {
+      FAIL("check_wuffs_version: \"%s\"", z);
+      return;
+    }
+    src.meta.ri = 0;
+    z = wuffs_png__decoder__decode_image_config(
+        &decs[i], &ic, wuffs_base__io_buffer__reader(&src));
+    if (z) {
+      FAIL("decode_image_config: \"%s\"", z);
+      return;
+    }
+  }
+
+  // Decompress the filtered rows all at once. Each group of 16 rows starts
+  // with a Sub filtered row.
+  msg = gather_idats(&src);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  src.meta.closed = true;
+  wuffs_zlib__decoder zdec = ((wuffs_zlib__decoder){});
+  wuffs_base__status z = wuffs_zlib__decoder__check_wuffs_version(
+      &zdec, sizeof zdec, WUFFS_VERSION);
+  if (!z) {
+    z = wuffs_zlib__decoder__decode(&zdec, wuffs_base__io_buffer__writer(&work),
+                                    wuffs_base__io_buffer__reader(&src));
+  }
+  if (z) {
+    FAIL("zlib decode: \"%s\"", z);
+    return;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  size_t row_length = 1 + (3 * (size_t)width);
+  if ((height <= 64) || (work.meta.wi != (height * row_length))) {
+    FAIL("filtered rows: unexpected length");
+    return;
+  }
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &ic.pixcfg,
+                                               global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+
+  // Decode the second group of rows before the first.
+  z = wuffs_png__decoder__decode_row_group(
+      &decs[1], &pb,
+      ((wuffs_base__slice_u8){
+          .ptr = work.data.ptr + (64 * row_length),
+          .len = (height - 64) * row_length,
+      }),
+      64);
+  if (z) {
+    FAIL("decode_row_group #1: \"%s\"", z);
+    return;
+  }
+  z = wuffs_png__decoder__decode_row_group(&decs[0], &pb,
+                                           ((wuffs_base__slice_u8){
+                                               .ptr = work.data.ptr,
+                                               .len = 64 * row_length,
+                                           }),
+                                           0);
+  if (z) {
+    FAIL("decode_row_group #0: \"%s\"", z);
+    return;
+  }
+  msg = copy_to_io_buffer_from_pixel_buffer(
+      &got, &pb, wuffs_base__pixel_config__bounds(&ic.pixcfg));
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  if (!io_buffers_equal("", &got, &want)) {
+    return;
+  }
+
+  // Row 63 is Paeth filtered, so it cannot start a group.
+  z = wuffs_png__decoder__decode_row_group(
+      &decs[1], &pb,
+      ((wuffs_base__slice_u8){
+          .ptr = work.data.ptr + (63 * row_length),
+          .len = row_length,
+      }),
+      63);
+  if (z != wuffs_png__error__bad_row_group) {
+    FAIL("decode_row_group #2: got \"%s\", want \"%s\"", z,
+         wuffs_png__error__bad_row_group);
+    return;
+  }
+}
+
+void test_wuffs_png_decode_rows_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode_rows("../../data/harvesters.png",
+                                "../../data/harvesters.bmp", 0);
+}
+
+void test_wuffs_png_decode_rows_many_small_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_decode_rows("../../data/bricks-color.png",
+                                "../../data/bricks-color.bmp", 13);
+}
+
+void test_wuffs_png_decode_rows_workbuf_len() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/harvesters.png")) {
+    return;
+  }
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_png__decoder__decode_image_config(
+      &dec, &ic, wuffs_base__io_buffer__reader(&src));
+  if (z) {
+    FAIL("decode_image_config: \"%s\"", z);
+    return;
+  }
+
+  // harvesters.png is a non-interlaced, 1165 x 859, 24 bits per pixel image,
+  // so that each filtered row is 1 + (1165 * 3) = 3496 bytes long.
+  wuffs_base__range_ii_u64 workbuf_len =
+      wuffs_base__image_config__workbuf_len(&ic);
+  if (workbuf_len.min_incl != 2 * 3496) {
+    FAIL("workbuf_len.min_incl: got %" PRIu64 ", want %" PRIu64,
+         workbuf_len.min_incl, (uint64_t)(2 * 3496));
+    return;
+  }
+  if (workbuf_len.max_incl != 859 * 3496) {
+    FAIL("workbuf_len.max_incl: got %" PRIu64 ", want %" PRIu64,
+         workbuf_len.max_incl, (uint64_t)(859 * 3496));
+    return;
+  }
+}
+
+void test_wuffs_png_decode_truncated() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-color.png")) {
+    return;
+  }
+  src.meta.wi /= 2;
+  src.meta.closed = true;
+
+  const char* msg = do_wuffs_png_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+  if (msg != wuffs_base__suspension__short_read) {
+    FAIL("got \"%s\", want \"%s\"", msg, wuffs_base__suspension__short_read);
+    return;
+  }
+}
+
+// do_wuffs_png_encode encodes src's image to dst. A negative level means the
+// encoder's default level. A non-zero wlimit means that the encoder writes at
+// most wlimit bytes at a time.
+const char* do_wuffs_png_encode(wuffs_base__io_buffer* dst,
+                                wuffs_base__pixel_buffer* src,
+                                int level,
+                                uint64_t wlimit) {
+  wuffs_png__encoder enc = ((wuffs_png__encoder){});
+  wuffs_base__status z =
+      wuffs_png__encoder__check_wuffs_version(&enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  if (level >= 0) {
+    wuffs_png__encoder__set_level(&enc, level);
+  }
+
+  uint64_t workbuf_len =
+      wuffs_png__encoder__workbuf_len(
+          &enc, wuffs_base__pixel_config__width(&src->pixcfg))
+          .max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  while (true) {
+    wuffs_base__io_writer dst_writer = wuffs_base__io_buffer__writer(dst);
+    if (wlimit) {
+      set_writer_limit(&dst_writer, wlimit);
+    }
+    size_t old_wi = dst->meta.wi;
+    z = wuffs_png__encoder__encode_image(&enc, dst_writer, src, workbuf);
+    if ((z != wuffs_base__suspension__short_write) ||
+        (dst->meta.wi == old_wi)) {
+      break;
+    }
+  }
+  return z;
+}
+
+// decode_pixel_buffer decodes src's PNG image to dst, as per
+// do_wuffs_png_decode, and sets pb to a pixel buffer holding the decoded
+// pixels, in global_pixel_slice.
+const char* decode_pixel_buffer(wuffs_base__pixel_buffer* pb,
+                                wuffs_base__io_buffer* dst,
+                                wuffs_base__io_buffer* src,
+                                wuffs_base__pixel_format pixfmt) {
+  if ((src->meta.wi - src->meta.ri) < 24) {
+    return "decode_pixel_buffer: src is too short";
+  }
+  uint32_t width = wuffs_base__load_u32be(src->data.ptr + src->meta.ri + 16);
+  uint32_t height = wuffs_base__load_u32be(src->data.ptr + src->meta.ri + 20);
+  const char* msg = do_wuffs_png_decode(dst, src, pixfmt, 0);
+  if (msg) {
+    return msg;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(&pc, pixfmt, 0, width, height);
+  *pb = ((wuffs_base__pixel_buffer){});
+  return wuffs_base__pixel_buffer__set_from_slice(pb, &pc, global_pixel_slice);
+}
+
+// do_test_wuffs_png_encode decodes a PNG file to the given pixel format,
+// encodes it with the given level and wlimit and then checks that decoding
+// that gives the same pixels (and palette).
+bool do_test_wuffs_png_encode(const char* png_filename,
+                              wuffs_base__pixel_format pixfmt,
+                              int level,
+                              uint64_t wlimit) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  wuffs_base__pixel_buffer pb;
+  const char* msg = decode_pixel_buffer(&pb, &want, &src, pixfmt);
+  if (msg) {
+    FAIL("decode: %s", msg);
+    return false;
+  }
+  uint8_t want_palette[1024];
+  if (pixfmt == WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL) {
+    memmove(want_palette, wuffs_base__pixel_buffer__palette(&pb).ptr, 1024);
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  msg = do_wuffs_png_encode(&src, &pb, level, wlimit);
+  if (msg) {
+    FAIL("encode: %s", msg);
+    return false;
+  }
+  src.meta.closed = true;
+  if ((level != 0) && (src.meta.wi >= want.meta.wi)) {
+    FAIL("level %d: encoded %zu bytes of pixels as %zu bytes", level,
+         want.meta.wi, src.meta.wi);
+    return false;
+  }
+
+  msg = do_wuffs_png_decode(&got, &src, pixfmt, 0);
+  if (msg) {
+    FAIL("decode encoded: %s", msg);
+    return false;
+  }
+  if (!io_buffers_equal("pixels ", &got, &want)) {
+    return false;
+  }
+  if ((pixfmt == WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL) &&
+      memcmp(want_palette, wuffs_base__pixel_buffer__palette(&pb).ptr, 1024)) {
+    FAIL("palettes differ");
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_png_encode_bricks_dither_indexed() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_encode("../../data/bricks-dither.png",
+                           WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL,
+                           -1, 0);
+}
+
+void test_wuffs_png_encode_harvesters_bgra() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_encode("../../data/harvesters.png",
+                           WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, -1, 0);
+}
+
+void test_wuffs_png_encode_hibiscus_rgba() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_encode("../../data/hibiscus.png",
+                           WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL, 6, 0);
+}
+
+void test_wuffs_png_encode_levels() {
+  CHECK_FOCUS(__func__);
+  int level;
+  for (level = 0; level <= 9; level++) {
+    if (!do_test_wuffs_png_encode("../../data/pjw-thumbnail.png",
+                                  WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL,
+                                  level, 0)) {
+      return;
+    }
+  }
+}
+
+void test_wuffs_png_encode_many_small_writes() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_png_encode("../../data/bricks-color.png",
+                           WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 1, 11);
+}
+
+void test_wuffs_png_encode_row_groups() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, "../../data/hippopotamus.regular.png")) {
+    return;
+  }
+  wuffs_base__pixel_buffer pb;
+  const char* msg = decode_pixel_buffer(
+      &pb, &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL);
+  if (msg) {
+    FAIL("decode: %s", msg);
+    return;
+  }
+  uint32_t width = wuffs_base__pixel_config__width(&pb.pixcfg);
+  uint32_t height = wuffs_base__pixel_config__height(&pb.pixcfg);
+
+  // Filtering the image in groups of 5 rows should give the same rows as the
+  // unfiltering (in place) that the decoder does, once every group's first
+  // row is unfiltered without a row above.
+  wuffs_png__encoder enc = ((wuffs_png__encoder){});
+  wuffs_base__status z =
+      wuffs_png__encoder__check_wuffs_version(&enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  size_t row_length = 4 * (size_t)width;
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = 3 * row_length,
+  });
+  uint32_t y;
+  for (y = 0; y < height; y += 5) {
+    wuffs_base__slice_u8 dst = ((wuffs_base__slice_u8){
+        .ptr = global_want_array,
+        .len = 5 * (1 + row_length),
+    });
+    z = wuffs_png__encoder__filter_row_group(&enc, dst, &pb, y, workbuf);
+    if (z) {
+      FAIL("filter_row_group: \"%s\"", z);
+      return;
+    }
+    uint32_t i;
+    for (i = 0; (i < 5) && ((y + i) < height); i++) {
+      uint8_t* p = global_want_array + (i * (1 + row_length));
+      wuffs_base__slice_u8 curr = ((wuffs_base__slice_u8){
+          .ptr = p + 1,
+          .len = row_length,
+      });
+      wuffs_base__slice_u8 prev = ((wuffs_base__slice_u8){
+          .ptr = p + 1 - (1 + row_length),
+          .len = (i > 0) ? row_length : 0,
+      });
+      if ((i == 0) && (p[0] > 1)) {
+        FAIL("y=%" PRIu32 ": filter type: got %d, want 0 or 1", y, p[0]);
+        return;
+      }
+      switch (p[0]) {
+        case 0:
+          break;
+        case 1:
+          wuffs_base__slice_u8__unfilter_sub(curr, 4);
+          break;
+        case 2:
+          wuffs_base__slice_u8__unfilter_up(curr, prev);
+          break;
+        case 3:
+          wuffs_base__slice_u8__unfilter_average(curr, prev, 4);
+          break;
+        case 4:
+          wuffs_base__slice_u8__unfilter_paeth(curr, prev, 4);
+          break;
+        default:
+          FAIL("y=%" PRIu32 ": bad filter type %d", y + i, p[0]);
+          return;
+      }
+      // The encoder writes RGBA_NONPREMUL rows.
+      uint8_t* q = got.data.ptr + (((size_t)(y + i)) * row_length);
+      size_t x;
+      for (x = 0; x < row_length; x += 4) {
+        if ((curr.ptr[x + 0] != q[x + 2]) || (curr.ptr[x + 1] != q[x + 1]) ||
+            (curr.ptr[x + 2] != q[x + 0]) || (curr.ptr[x + 3] != q[x + 3])) {
+          FAIL("y=%" PRIu32 ", x=%zu: pixels differ", y + i, x / 4);
+          return;
+        }
+      }
+    }
+  }
+}
+
+// ---------------- Mimic Tests
+
+#ifdef WUFFS_MIMIC
+
+bool do_test_mimic_png_decode(const char* filename) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  src.meta.ri = 0;
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  const char* got_msg = wuffs_png_decode(&got, &src);
+  if (got_msg) {
+    FAIL("%s", got_msg);
+    return false;
+  }
+
+  src.meta.ri = 0;
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  const char* want_msg = mimic_png_decode(&want, &src);
+  if (want_msg) {
+    FAIL("%s", want_msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+void test_mimic_png_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/bricks-color.png");
+}
+
+void test_mimic_png_decode_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/bricks-dither.png");
+}
+
+void test_mimic_png_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/bricks-gray.png");
+}
+
+void test_mimic_png_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/harvesters.png");
+}
+
+void test_mimic_png_decode_hat() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/hat.png");
+}
+
+void test_mimic_png_decode_hibiscus() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/hibiscus.png");
+}
+
+void test_mimic_png_decode_hippopotamus_interlaced() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/hippopotamus.interlaced.png");
+}
+
+void test_mimic_png_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_png_decode("../../data/pjw-thumbnail.png");
+}
+
+void test_mimic_png_decode_wuffs_encoded_harvesters() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, "../../data/harvesters.png")) {
+    return;
+  }
+  wuffs_base__pixel_buffer pb;
+  const char* msg = decode_pixel_buffer(
+      &pb, &want, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL);
+  if (msg) {
+    FAIL("decode: %s", msg);
+    return;
+  }
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  msg = do_wuffs_png_encode(&src, &pb, -1, 0);
+  if (msg) {
+    FAIL("encode: %s", msg);
+    return;
+  }
+  msg = mimic_png_decode(&got, &src);
+  if (msg) {
+    FAIL("mimic_png_decode: %s", msg);
+    return;
+  }
+  io_buffers_equal("", &got, &want);
+}
+
+#endif  // WUFFS_MIMIC
+
+// ---------------- PNG Benches
+
+bool do_bench_png_decode(const char* (*decode_func)(wuffs_base__io_buffer*,
+                                                    wuffs_base__io_buffer*),
+                         const char* filename,
+                         uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    const char* error_msg = decode_func(&got, &src);
+    if (error_msg) {
+      FAIL("%s", error_msg);
+      return false;
+    }
+    n_bytes += got.meta.wi;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_png_decode_1k_interlaced() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(wuffs_png_decode,
+                      "../../data/hippopotamus.interlaced.png", 200);
+}
+
+void bench_wuffs_png_decode_19k_8bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(wuffs_png_decode, "../../data/bricks-dither.png", 50);
+}
+
+void bench_wuffs_png_decode_138k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(wuffs_png_decode, "../../data/hibiscus.png", 5);
+}
+
+void bench_wuffs_png_decode_1000k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(wuffs_png_decode, "../../data/harvesters.png", 1);
+}
+
+void bench_wuffs_png_decode_rows_138k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(wuffs_png_decode_rows, "../../data/hibiscus.png", 5);
+}
+
+void bench_wuffs_png_decode_rows_1000k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(wuffs_png_decode_rows, "../../data/harvesters.png", 1);
+}
+
+// wuffs_png_encode_etc adapt do_wuffs_png_encode to the encode_func
+// signature.
+const char* wuffs_png_encode(wuffs_base__io_buffer* dst,
+                             wuffs_base__pixel_buffer* src,
+                             int level) {
+  return do_wuffs_png_encode(dst, src, level, 0);
+}
+
+// do_bench_png_encode encodes a PNG file's pixels, decoded as BGRA_NONPREMUL.
+// The throughput is measured in (uncompressed) pixel bytes.
+bool do_bench_png_encode(const char* (*encode_func)(wuffs_base__io_buffer*,
+                                                    wuffs_base__pixel_buffer*,
+                                                    int),
+                         const char* filename,
+                         int level,
+                         uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  wuffs_base__pixel_buffer pb;
+  const char* msg = decode_pixel_buffer(
+      &pb, &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL);
+  if (msg) {
+    FAIL("decode: %s", msg);
+    return false;
+  }
+  uint64_t n_pixel_bytes = got.meta.wi;
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    const char* error_msg = encode_func(&got, &pb, level);
+    if (error_msg) {
+      FAIL("%s", error_msg);
+      return false;
+    }
+    n_bytes += n_pixel_bytes;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_png_encode_1000k_24bpp_level1() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_encode(wuffs_png_encode, "../../data/harvesters.png", 1, 1);
+}
+
+void bench_wuffs_png_encode_1000k_24bpp_level6() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_encode(wuffs_png_encode, "../../data/harvesters.png", 6, 1);
+}
+
+// ---------------- Mimic Benches
+
+#ifdef WUFFS_MIMIC
+
+void bench_mimic_png_decode_1k_interlaced() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(mimic_png_decode,
+                      "../../data/hippopotamus.interlaced.png", 200);
+}
+
+void bench_mimic_png_decode_19k_8bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(mimic_png_decode, "../../data/bricks-dither.png", 50);
+}
+
+void bench_mimic_png_decode_138k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(mimic_png_decode, "../../data/hibiscus.png", 5);
+}
+
+void bench_mimic_png_decode_1000k_24bpp() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_decode(mimic_png_decode, "../../data/harvesters.png", 1);
+}
+
+void bench_mimic_png_encode_1000k_24bpp_level1() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_encode(mimic_png_encode, "../../data/harvesters.png", 1, 1);
+}
+
+void bench_mimic_png_encode_1000k_24bpp_level6() {
+  CHECK_FOCUS(__func__);
+  do_bench_png_encode(mimic_png_encode, "../../data/harvesters.png", 6, 1);
+}
+
+#endif  // WUFFS_MIMIC
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_png_call_sequence,                      //
+    test_wuffs_png_checksum_ignore,                    //
+    test_wuffs_png_checksum_verify_bad,                //
+    test_wuffs_png_decode_bricks_color,                //
+    test_wuffs_png_decode_bricks_dither,               //
+    test_wuffs_png_decode_bricks_gray,                 //
+    test_wuffs_png_decode_bricks_nodither,             //
+    test_wuffs_png_decode_full_flush,                  //
+    test_wuffs_png_decode_harvesters,                  //
+    test_wuffs_png_decode_hippopotamus_interlaced,     //
+    test_wuffs_png_decode_hippopotamus_regular,        //
+    test_wuffs_png_decode_input_is_a_gif,              //
+    test_wuffs_png_decode_interlaced_matches_regular,  //
+    test_wuffs_png_decode_many_small_reads,            //
+    test_wuffs_png_decode_pjw_thumbnail,               //
+    test_wuffs_png_decode_row_group,                   //
+    test_wuffs_png_decode_rows_harvesters,             //
+    test_wuffs_png_decode_rows_many_small_reads,       //
+    test_wuffs_png_decode_rows_workbuf_len,            //
+    test_wuffs_png_decode_truncated,                   //
+    test_wuffs_png_encode_bricks_dither_indexed,       //
+    test_wuffs_png_encode_harvesters_bgra,             //
+    test_wuffs_png_encode_hibiscus_rgba,               //
+    test_wuffs_png_encode_levels,                      //
+    test_wuffs_png_encode_many_small_writes,           //
+    test_wuffs_png_encode_row_groups,                  //
+
+#ifdef WUFFS_MIMIC
+
+    test_mimic_png_decode_bricks_color,              //
+    test_mimic_png_decode_bricks_dither,             //
+    test_mimic_png_decode_bricks_gray,               //
+    test_mimic_png_decode_harvesters,                //
+    test_mimic_png_decode_hat,                       //
+    test_mimic_png_decode_hibiscus,                  //
+    test_mimic_png_decode_hippopotamus_interlaced,   //
+    test_mimic_png_decode_pjw_thumbnail,             //
+    test_mimic_png_decode_wuffs_encoded_harvesters,  //
+
+#endif  // WUFFS_MIMIC
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_png_decode_1k_interlaced,       //
+    bench_wuffs_png_decode_19k_8bpp,            //
+    bench_wuffs_png_decode_138k_24bpp,          //
+    bench_wuffs_png_decode_1000k_24bpp,         //
+    bench_wuffs_png_decode_rows_138k_24bpp,     //
+    bench_wuffs_png_decode_rows_1000k_24bpp,    //
+    bench_wuffs_png_encode_1000k_24bpp_level1,  //
+    bench_wuffs_png_encode_1000k_24bpp_level6,  //
+
+#ifdef WUFFS_MIMIC
+
+    bench_mimic_png_decode_1k_interlaced,       //
+    bench_mimic_png_decode_19k_8bpp,            //
+    bench_mimic_png_decode_138k_24bpp,          //
+    bench_mimic_png_decode_1000k_24bpp,         //
+    bench_mimic_png_encode_1000k_24bpp_level1,  //
+    bench_mimic_png_encode_1000k_24bpp_level6,  //
+
+#endif  // WUFFS_MIMIC
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "std/png";
+  return test_main(argc, argv, tests, benches);
+}
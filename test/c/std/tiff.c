@@ -0,0 +1,857 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test" or "wuffs
+bench" commands. These commands take an optional "-mimic" flag to check that
+Wuffs' output mimics (i.e. exactly matches) other libraries' output, such as
+giflib for GIF, libpng for PNG, etc.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror tiff.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+Add the "wuffs mimic cflags" (everything after the colon below) to the C
+compiler flags (after the .c file) to run the mimic tests.
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench". Combine these changes with the
+"wuffs mimic cflags" to run the mimic benchmarks.
+*/
+
+// !! wuffs mimic cflags: -DWUFFS_MIMIC
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+//
+// The PNG decoder provides the expected pixels for the TIFF images.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__ADLER32
+#define WUFFS_CONFIG__MODULE__BASE
+#define WUFFS_CONFIG__MODULE__CRC32
+#define WUFFS_CONFIG__MODULE__DEFLATE
+#define WUFFS_CONFIG__MODULE__LZW
+#define WUFFS_CONFIG__MODULE__PACKBITS
+#define WUFFS_CONFIG__MODULE__PNG
+#define WUFFS_CONFIG__MODULE__TIFF
+#define WUFFS_CONFIG__MODULE__ZLIB
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../../release/c/wuffs-unsupported-snapshot.h"
+#include "../testlib/testlib.c"
+
+// ---------------- TIFF Tests
+
+// reposition_tiff_src handles a "$mispositioned read" status by moving src's
+// read index to the decoder's seek_position, as src holds the entire file.
+const char* reposition_tiff_src(wuffs_tiff__decoder* dec,
+                                wuffs_base__io_buffer* src) {
+  uint64_t pos = wuffs_tiff__decoder__seek_position(dec);
+  if ((pos < src->meta.pos) || ((pos - src->meta.pos) > src->meta.wi)) {
+    return "reposition_tiff_src: seek position is out of bounds";
+  }
+  src->meta.ri = pos - src->meta.pos;
+  return NULL;
+}
+
+// do_wuffs_tiff_decode decodes src's image to dst, in the given pixel format.
+// A non-zero rlimit means that the src is fed to the decoder at most rlimit
+// bytes at a time.
+const char* do_wuffs_tiff_decode(wuffs_base__io_buffer* dst,
+                                 wuffs_base__io_buffer* src,
+                                 wuffs_base__pixel_format pixfmt,
+                                 uint64_t rlimit) {
+  wuffs_tiff__decoder dec = ((wuffs_tiff__decoder){});
+  wuffs_base__status z =
+      wuffs_tiff__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_tiff__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z == wuffs_tiff__suspension__mispositioned_read) {
+      const char* msg = reposition_tiff_src(&dec, src);
+      if (msg) {
+        return msg;
+      }
+      continue;
+    }
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, 0, wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "do_wuffs_tiff_decode: work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_tiff__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+    if (z == wuffs_tiff__suspension__mispositioned_read) {
+      const char* msg = reposition_tiff_src(&dec, src);
+      if (msg) {
+        return msg;
+      }
+      continue;
+    }
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+const char* wuffs_tiff_decode(wuffs_base__io_buffer* dst,
+                              wuffs_base__io_buffer* src) {
+  return do_wuffs_tiff_decode(dst, src,
+                              WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+}
+
+// wuffs_tiff_decode_chunks decodes src's image to dst, as BGRA_NONPREMUL
+// pixels, one chunk (strip or tile) at a time and in reverse order, via the
+// decode_chunk_table and decode_chunk methods. Each chunk is decoded by one of
+// two decoders, in turn, as a multi-threaded program might do.
+const char* wuffs_tiff_decode_chunks(wuffs_base__io_buffer* dst,
+                                     wuffs_base__io_buffer* src) {
+  wuffs_tiff__decoder decs[2] = {0};
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  int d;
+  for (d = 0; d < 2; d++) {
+    wuffs_base__status z = wuffs_tiff__decoder__check_wuffs_version(
+        &decs[d], sizeof decs[d], WUFFS_VERSION);
+    if (z) {
+      return z;
+    }
+    src->meta.ri = 0;
+    while (true) {
+      z = wuffs_tiff__decoder__decode_image_config(
+          &decs[d], &ic, wuffs_base__io_buffer__reader(src));
+      if (z != wuffs_tiff__suspension__mispositioned_read) {
+        break;
+      }
+      const char* msg = reposition_tiff_src(&decs[d], src);
+      if (msg) {
+        return msg;
+      }
+    }
+    if (z) {
+      return z;
+    }
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  wuffs_base__status z =
+      wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  // The chunk table goes at the start of global_work_array and each
+  // decoder's workbuf goes after that.
+  uint32_t num_chunks = wuffs_tiff__decoder__num_chunks(&decs[0]);
+  uint64_t table_len = ((uint64_t)num_chunks) * 8;
+  uint64_t chunk_workbuf_len = wuffs_tiff__decoder__chunk_workbuf_len(&decs[0]);
+  if ((chunk_workbuf_len > BUFFER_SIZE / 4) || (table_len > BUFFER_SIZE / 4)) {
+    return "wuffs_tiff_decode_chunks: work buffer size is too large";
+  }
+  wuffs_base__slice_u8 table = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = table_len,
+  });
+  while (true) {
+    z = wuffs_tiff__decoder__decode_chunk_table(
+        &decs[0], table, wuffs_base__io_buffer__reader(src));
+    if (z != wuffs_tiff__suspension__mispositioned_read) {
+      break;
+    }
+    const char* msg = reposition_tiff_src(&decs[0], src);
+    if (msg) {
+      return msg;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  uint32_t i = num_chunks;
+  while (i > 0) {
+    i--;
+    d = i & 1;
+    wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+        .ptr = global_work_array + table_len + (d * chunk_workbuf_len),
+        .len = chunk_workbuf_len,
+    });
+    while (true) {
+      z = wuffs_tiff__decoder__decode_chunk(
+          &decs[d], &pb, wuffs_base__io_buffer__reader(src), workbuf, i,
+          wuffs_base__load_u32le(table.ptr + (8 * i) + 0),
+          wuffs_base__load_u32le(table.ptr + (8 * i) + 4));
+      if (z != wuffs_tiff__suspension__mispositioned_read) {
+        break;
+      }
+      const char* msg = reposition_tiff_src(&decs[d], src);
+      if (msg) {
+        return msg;
+      }
+    }
+    if (z) {
+      return z;
+    }
+  }
+
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+// png_decode decodes the PNG image in src to dst, as BGRA_NONPREMUL pixels.
+const char* png_decode(wuffs_base__io_buffer* dst, wuffs_base__io_buffer* src) {
+  wuffs_png__decoder dec = ((wuffs_png__decoder){});
+  wuffs_base__status z =
+      wuffs_png__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+  z = wuffs_png__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "png_decode: work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+  z = wuffs_png__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+  if (z) {
+    return z;
+  }
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+bool do_test_wuffs_tiff_decode(
+    const char* (*decode_func)(wuffs_base__io_buffer*, wuffs_base__io_buffer*),
+    const char* tiff_filename,
+    const char* png_filename) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, png_filename)) {
+    return false;
+  }
+  const char* msg = png_decode(&want, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  src.meta = ((wuffs_base__io_buffer_meta){});
+  if (!read_file(&src, tiff_filename)) {
+    return false;
+  }
+  msg = decode_func(&got, &src);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+void test_wuffs_tiff_call_sequence() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/hat.tiff")) {
+    return;
+  }
+
+  wuffs_tiff__decoder dec = ((wuffs_tiff__decoder){});
+  wuffs_base__status z =
+      wuffs_tiff__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_tiff__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+  z = wuffs_tiff__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z) {
+    FAIL("decode_frame_config #0: got \"%s\"", z);
+    return;
+  }
+
+  z = wuffs_tiff__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z != wuffs_base__warning__end_of_data) {
+    FAIL("decode_frame_config #1: got \"%s\", want \"%s\"", z,
+         wuffs_base__warning__end_of_data);
+    return;
+  }
+
+  z = wuffs_tiff__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z != wuffs_base__error__bad_call_sequence) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__bad_call_sequence);
+    return;
+  }
+}
+
+void test_wuffs_tiff_decode_bad_chunk() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-color.lzw-strips.tiff")) {
+    return;
+  }
+
+  wuffs_tiff__decoder dec = ((wuffs_tiff__decoder){});
+  wuffs_base__status z =
+      wuffs_tiff__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    z = wuffs_tiff__decoder__decode_image_config(
+        &dec, &ic, wuffs_base__io_buffer__reader(&src));
+    if (z != wuffs_tiff__suspension__mispositioned_read) {
+      break;
+    }
+    const char* msg = reposition_tiff_src(&dec, &src);
+    if (msg) {
+      FAIL("%s", msg);
+      return;
+    }
+  }
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  // The 120 pixel high image has 16 rows per strip.
+  uint32_t num_chunks = wuffs_tiff__decoder__num_chunks(&dec);
+  if (num_chunks != 8) {
+    FAIL("num_chunks: got %" PRIu32 ", want 8", num_chunks);
+    return;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return;
+  }
+  z = wuffs_tiff__decoder__decode_chunk(&dec, &pb,
+                                        wuffs_base__io_buffer__reader(&src),
+                                        global_work_slice, num_chunks, 8, 1);
+  if (z != wuffs_tiff__error__bad_chunk) {
+    FAIL("decode_chunk: got \"%s\", want \"%s\"", z,
+         wuffs_tiff__error__bad_chunk);
+    return;
+  }
+}
+
+void test_wuffs_tiff_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode, "../../data/bricks-color.tiff",
+                            "../../data/bricks-color.png");
+}
+
+void test_wuffs_tiff_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode, "../../data/bricks-gray.tiff",
+                            "../../data/bricks-gray.png");
+}
+
+void test_wuffs_tiff_decode_chunks_lzw_strips() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode_chunks,
+                            "../../data/bricks-color.lzw-strips.tiff",
+                            "../../data/bricks-color.png");
+}
+
+void test_wuffs_tiff_decode_chunks_packbits_tiles() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode_chunks,
+                            "../../data/bricks-color.packbits-tiles.tiff",
+                            "../../data/bricks-color.png");
+}
+
+void test_wuffs_tiff_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode, "../../data/harvesters.tiff",
+                            "../../data/harvesters.png");
+}
+
+void test_wuffs_tiff_decode_hippopotamus() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode, "../../data/hippopotamus.tiff",
+                            "../../data/hippopotamus.regular.png");
+}
+
+void test_wuffs_tiff_decode_indexed_big_endian() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.none-strips.tiff")) {
+    return;
+  }
+  const char* msg = do_wuffs_tiff_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  if (!read_file(&want, "../../data/bricks-dither.indexes")) {
+    return;
+  }
+  if (!io_buffers_equal("indexes ", &got, &want)) {
+    return;
+  }
+
+  // do_wuffs_tiff_decode decoded into global_pixel_slice. Where a pixel
+  // buffer set from that slice places its palette does not depend on the
+  // image size.
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__INDEXED__BGRA_NONPREMUL, 0, 1, 1);
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  msg = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (msg) {
+    FAIL("%s", msg);
+    return;
+  }
+  wuffs_base__slice_u8 palette = wuffs_base__pixel_buffer__palette(&pb);
+  got = ((wuffs_base__io_buffer){
+      .data = palette,
+      .meta = ((wuffs_base__io_buffer_meta){
+          .wi = palette.len,
+      }),
+  });
+  want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  if (!read_file(&want, "../../data/bricks-dither.palette")) {
+    return;
+  }
+  io_buffers_equal("palette ", &got, &want);
+}
+
+void test_wuffs_tiff_decode_input_is_a_png() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.png")) {
+    return;
+  }
+
+  wuffs_tiff__decoder dec = ((wuffs_tiff__decoder){});
+  wuffs_base__status z =
+      wuffs_tiff__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_tiff__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z != wuffs_tiff__error__bad_header) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_tiff__error__bad_header);
+    return;
+  }
+}
+
+void test_wuffs_tiff_decode_lzw_strips() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode,
+                            "../../data/bricks-color.lzw-strips.tiff",
+                            "../../data/bricks-color.png");
+}
+
+const char* wuffs_tiff_decode_many_small_reads(wuffs_base__io_buffer* dst,
+                                               wuffs_base__io_buffer* src) {
+  return do_wuffs_tiff_decode(dst, src,
+                              WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 13);
+}
+
+void test_wuffs_tiff_decode_many_small_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode_many_small_reads,
+                            "../../data/bricks-color.lzw-strips.tiff",
+                            "../../data/bricks-color.png");
+}
+
+void test_wuffs_tiff_decode_many_small_reads_packbits() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode_many_small_reads,
+                            "../../data/bricks-color.packbits-tiles.tiff",
+                            "../../data/bricks-color.png");
+}
+
+void test_wuffs_tiff_decode_none_strips() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode,
+                            "../../data/bricks-dither.none-strips.tiff",
+                            "../../data/bricks-dither.png");
+}
+
+void test_wuffs_tiff_decode_packbits_tiles() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode,
+                            "../../data/bricks-color.packbits-tiles.tiff",
+                            "../../data/bricks-color.png");
+}
+
+void test_wuffs_tiff_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_tiff_decode(wuffs_tiff_decode, "../../data/pjw-thumbnail.tiff",
+                            "../../data/pjw-thumbnail.png");
+}
+
+// ---------------- TIFF Benches
+
+bool do_bench_tiff_decode(const char* (*decode_func)(wuffs_base__io_buffer*,
+                                                     wuffs_base__io_buffer*),
+                          const char* filename,
+                          uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    const char* error_msg = decode_func(&got, &src);
+    if (error_msg) {
+      FAIL("%s", error_msg);
+      return false;
+    }
+    n_bytes += got.meta.wi;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+// do_bench_tiff_decode_chunk times decoding a single chunk (strip or tile),
+// the unit of work for a multi-threaded decoder, after decoding the image
+// config and the chunk table once, outside of the timed loop.
+bool do_bench_tiff_decode_chunk(const char* filename,
+                                uint32_t chunk_index,
+                                uint64_t iters_unscaled) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  wuffs_tiff__decoder dec = ((wuffs_tiff__decoder){});
+  wuffs_base__status z =
+      wuffs_tiff__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  uint8_t table[8] = {0};
+  int j;
+  for (j = 0; j < 2; j++) {
+    while (true) {
+      wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+      if (j == 0) {
+        z = wuffs_tiff__decoder__decode_image_config(&dec, &ic, src_reader);
+      } else {
+        wuffs_base__slice_u8 all = ((wuffs_base__slice_u8){
+            .ptr = global_work_array,
+            .len = ((size_t)wuffs_tiff__decoder__num_chunks(&dec)) * 8,
+        });
+        z = wuffs_tiff__decoder__decode_chunk_table(&dec, all, src_reader);
+      }
+      if (z != wuffs_tiff__suspension__mispositioned_read) {
+        break;
+      }
+      const char* msg = reposition_tiff_src(&dec, &src);
+      if (msg) {
+        FAIL("%s", msg);
+        return false;
+      }
+    }
+    if (z) {
+      FAIL("decode_%s: \"%s\"", j ? "chunk_table" : "image_config", z);
+      return false;
+    }
+  }
+  if (chunk_index >= wuffs_tiff__decoder__num_chunks(&dec)) {
+    FAIL("chunk_index is out of range");
+    return false;
+  }
+  memcpy(table, global_work_array + (8 * chunk_index), 8);
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+      wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    FAIL("set_from_slice: \"%s\"", z);
+    return false;
+  }
+
+  uint64_t chunk_workbuf_len = wuffs_tiff__decoder__chunk_workbuf_len(&dec);
+  if (chunk_workbuf_len > BUFFER_SIZE) {
+    FAIL("work buffer size is too large");
+    return false;
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = chunk_workbuf_len,
+  });
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    src.meta.ri = wuffs_base__load_u32le(table + 0);
+    z = wuffs_tiff__decoder__decode_chunk(
+        &dec, &pb, wuffs_base__io_buffer__reader(&src), workbuf, chunk_index,
+        wuffs_base__load_u32le(table + 0), wuffs_base__load_u32le(table + 4));
+    if (z) {
+      FAIL("decode_chunk: \"%s\"", z);
+      return false;
+    }
+    n_bytes += chunk_workbuf_len;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_tiff_decode_19k_deflate() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode(wuffs_tiff_decode, "../../data/bricks-color.tiff", 50);
+}
+
+void bench_wuffs_tiff_decode_19k_lzw_strips() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode(wuffs_tiff_decode,
+                       "../../data/bricks-color.lzw-strips.tiff", 50);
+}
+
+void bench_wuffs_tiff_decode_19k_none_strips() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode(wuffs_tiff_decode,
+                       "../../data/bricks-dither.none-strips.tiff", 50);
+}
+
+void bench_wuffs_tiff_decode_19k_packbits_tiles() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode(wuffs_tiff_decode,
+                       "../../data/bricks-color.packbits-tiles.tiff", 50);
+}
+
+void bench_wuffs_tiff_decode_1000k_deflate() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode(wuffs_tiff_decode, "../../data/harvesters.tiff", 1);
+}
+
+void bench_wuffs_tiff_decode_chunk_lzw_strip() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode_chunk("../../data/bricks-color.lzw-strips.tiff", 3, 400);
+}
+
+void bench_wuffs_tiff_decode_chunk_packbits_tile() {
+  CHECK_FOCUS(__func__);
+  do_bench_tiff_decode_chunk("../../data/bricks-color.packbits-tiles.tiff", 5,
+                             400);
+}
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_tiff_call_sequence,                     //
+    test_wuffs_tiff_decode_bad_chunk,                  //
+    test_wuffs_tiff_decode_bricks_color,               //
+    test_wuffs_tiff_decode_bricks_gray,                //
+    test_wuffs_tiff_decode_chunks_lzw_strips,          //
+    test_wuffs_tiff_decode_chunks_packbits_tiles,      //
+    test_wuffs_tiff_decode_harvesters,                 //
+    test_wuffs_tiff_decode_hippopotamus,               //
+    test_wuffs_tiff_decode_indexed_big_endian,         //
+    test_wuffs_tiff_decode_input_is_a_png,             //
+    test_wuffs_tiff_decode_lzw_strips,                 //
+    test_wuffs_tiff_decode_many_small_reads,           //
+    test_wuffs_tiff_decode_many_small_reads_packbits,  //
+    test_wuffs_tiff_decode_none_strips,                //
+    test_wuffs_tiff_decode_packbits_tiles,             //
+    test_wuffs_tiff_decode_pjw_thumbnail,              //
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_tiff_decode_19k_deflate,          //
+    bench_wuffs_tiff_decode_19k_lzw_strips,       //
+    bench_wuffs_tiff_decode_19k_none_strips,      //
+    bench_wuffs_tiff_decode_19k_packbits_tiles,   //
+    bench_wuffs_tiff_decode_1000k_deflate,        //
+    bench_wuffs_tiff_decode_chunk_lzw_strip,      //
+    bench_wuffs_tiff_decode_chunk_packbits_tile,  //
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "std/tiff";
+  return test_main(argc, argv, tests, benches);
+}
@@ -0,0 +1,667 @@
+// Copyright 2018 The Wuffs Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+This test program is typically run indirectly, by the "wuffs test" or "wuffs
+bench" commands. These commands take an optional "-mimic" flag to check that
+Wuffs' output mimics (i.e. exactly matches) other libraries' output, such as
+giflib for GIF, libpng for PNG, etc.
+
+To manually run this test:
+
+for CC in clang gcc; do
+  $CC -std=c99 -Wall -Werror webp.c && ./a.out
+  rm -f a.out
+done
+
+Each edition should print "PASS", amongst other information, and exit(0).
+
+Add the "wuffs mimic cflags" (everything after the colon below) to the C
+compiler flags (after the .c file) to run the mimic tests.
+
+To manually run the benchmarks, replace "-Wall -Werror" with "-O3" and replace
+the first "./a.out" with "./a.out -bench". Combine these changes with the
+"wuffs mimic cflags" to run the mimic benchmarks.
+*/
+
+// !! wuffs mimic cflags: -DWUFFS_MIMIC -lwebp
+
+// Wuffs ships as a "single file C library" or "header file library" as per
+// https://github.com/nothings/stb/blob/master/docs/stb_howto.txt
+//
+// To use that single file as a "foo.c"-like implementation, instead of a
+// "foo.h"-like header, #define WUFFS_IMPLEMENTATION before #include'ing or
+// compiling it.
+#define WUFFS_IMPLEMENTATION
+
+// Defining the WUFFS_CONFIG__MODULE* macros are optional, but it lets users of
+// release/c/etc.h whitelist which parts of Wuffs to build. That file contains
+// the entire Wuffs standard library, implementing a variety of codecs and file
+// formats. Without this macro definition, an optimizing compiler or linker may
+// very well discard Wuffs code for unused codecs, but listing the Wuffs
+// modules we use makes that process explicit. Preprocessing means that such
+// code simply isn't compiled.
+//
+// The Adler-32 checksum summarizes the expected pixels, which were produced
+// by libwebp, so that the test data doesn't need a copy of each image's
+// pixels.
+#define WUFFS_CONFIG__MODULES
+#define WUFFS_CONFIG__MODULE__ADLER32
+#define WUFFS_CONFIG__MODULE__BASE
+#define WUFFS_CONFIG__MODULE__WEBP
+
+// If building this program in an environment that doesn't easily accommodate
+// relative includes, you can use the script/inline-c-relative-includes.go
+// program to generate a stand-alone C file.
+#include "../../../release/c/wuffs-unsupported-snapshot.h"
+#include "../testlib/testlib.c"
+#ifdef WUFFS_MIMIC
+#include "../mimiclib/webp.c"
+#endif
+
+// ---------------- WebP Tests
+
+// do_wuffs_webp_decode decodes src's image to dst, in the given pixel format.
+// A non-zero rlimit means that the src is fed to the decoder at most rlimit
+// bytes at a time.
+const char* do_wuffs_webp_decode(wuffs_base__io_buffer* dst,
+                                 wuffs_base__io_buffer* src,
+                                 wuffs_base__pixel_format pixfmt,
+                                 uint64_t rlimit) {
+  wuffs_webp__decoder dec = ((wuffs_webp__decoder){});
+  wuffs_base__status z =
+      wuffs_webp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_webp__decoder__decode_image_config(&dec, &ic, src_reader);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  wuffs_base__pixel_config pc = ((wuffs_base__pixel_config){});
+  wuffs_base__pixel_config__initialize(
+      &pc, pixfmt, 0, wuffs_base__pixel_config__width(&ic.pixcfg),
+      wuffs_base__pixel_config__height(&ic.pixcfg));
+
+  wuffs_base__pixel_buffer pb = ((wuffs_base__pixel_buffer){});
+  z = wuffs_base__pixel_buffer__set_from_slice(&pb, &pc, global_pixel_slice);
+  if (z) {
+    return z;
+  }
+
+  uint64_t workbuf_len = wuffs_base__image_config__workbuf_len(&ic).max_incl;
+  if (workbuf_len > BUFFER_SIZE) {
+    return "work buffer size is too large";
+  }
+  wuffs_base__slice_u8 workbuf = ((wuffs_base__slice_u8){
+      .ptr = global_work_array,
+      .len = workbuf_len,
+  });
+
+  while (true) {
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_webp__decoder__decode_frame(&dec, &pb, src_reader, workbuf, NULL);
+    if (z != wuffs_base__suspension__short_read) {
+      break;
+    }
+    if (src->meta.ri == src->meta.wi) {
+      break;
+    }
+  }
+  if (z) {
+    return z;
+  }
+
+  return copy_to_io_buffer_from_pixel_buffer(
+      dst, &pb, wuffs_base__pixel_config__bounds(&pc));
+}
+
+const char* wuffs_webp_decode(wuffs_base__io_buffer* dst,
+                              wuffs_base__io_buffer* src) {
+  return do_wuffs_webp_decode(dst, src,
+                              WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+}
+
+// do_test_wuffs_webp_decode checks the Adler-32 checksum of the decoded pixels
+// against want_checksum, calculated from libwebp's output.
+bool do_test_wuffs_webp_decode(const char* filename,
+                               wuffs_base__pixel_format pixfmt,
+                               uint64_t rlimit,
+                               uint64_t want_num_bytes,
+                               uint32_t want_checksum) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+  const char* msg = do_wuffs_webp_decode(&got, &src, pixfmt, rlimit);
+  if (msg) {
+    FAIL("%s", msg);
+    return false;
+  }
+  if (got.meta.wi != want_num_bytes) {
+    FAIL("num_bytes: got %zu, want %" PRIu64, got.meta.wi, want_num_bytes);
+    return false;
+  }
+
+  wuffs_adler32__hasher checksum = ((wuffs_adler32__hasher){});
+  wuffs_base__status z = wuffs_adler32__hasher__check_wuffs_version(
+      &checksum, sizeof checksum, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  uint32_t got_checksum =
+      wuffs_adler32__hasher__update(&checksum, ((wuffs_base__slice_u8){
+                                                   .ptr = got.data.ptr,
+                                                   .len = got.meta.wi,
+                                               }));
+  if (got_checksum != want_checksum) {
+    FAIL("checksum: got 0x%08" PRIX32 ", want 0x%08" PRIX32, got_checksum,
+         want_checksum);
+    return false;
+  }
+  return true;
+}
+
+void test_wuffs_webp_call_sequence() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/hat.lossless.webp")) {
+    return;
+  }
+
+  wuffs_webp__decoder dec = ((wuffs_webp__decoder){});
+  wuffs_base__status z =
+      wuffs_webp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_webp__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  wuffs_base__frame_config fc = ((wuffs_base__frame_config){});
+  z = wuffs_webp__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z) {
+    FAIL("decode_frame_config #0: got \"%s\"", z);
+    return;
+  }
+
+  z = wuffs_webp__decoder__decode_frame_config(&dec, &fc, src_reader);
+  if (z != wuffs_base__warning__end_of_data) {
+    FAIL("decode_frame_config #1: got \"%s\", want \"%s\"", z,
+         wuffs_base__warning__end_of_data);
+    return;
+  }
+
+  z = wuffs_webp__decoder__decode_image_config(&dec, NULL, src_reader);
+  if (z != wuffs_base__error__bad_call_sequence) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_base__error__bad_call_sequence);
+    return;
+  }
+}
+
+void test_wuffs_webp_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/bricks-color.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0x87A61292);
+}
+
+void test_wuffs_webp_decode_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/bricks-dither.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0xB3EE31B6);
+}
+
+void test_wuffs_webp_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/bricks-gray.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0xC881A961);
+}
+
+void test_wuffs_webp_decode_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/bricks-nodither.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            160 * 120 * 4, 0x3A68FE62);
+}
+
+void test_wuffs_webp_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/harvesters.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            1165 * 859 * 4, 0x58747939);
+}
+
+void test_wuffs_webp_decode_hat() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/hat.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            90 * 112 * 4, 0x6695FA71);
+}
+
+void test_wuffs_webp_decode_hibiscus() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/hibiscus.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            312 * 442 * 4, 0x74BC912C);
+}
+
+void test_wuffs_webp_decode_hippopotamus() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/hippopotamus.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            36 * 28 * 4, 0xFF055E22);
+}
+
+void test_wuffs_webp_decode_image_config() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, "../../data/hibiscus.lossless.webp")) {
+    return;
+  }
+
+  wuffs_webp__decoder dec = ((wuffs_webp__decoder){});
+  wuffs_base__status z =
+      wuffs_webp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  z = wuffs_webp__decoder__decode_image_config(
+      &dec, &ic, wuffs_base__io_buffer__reader(&src));
+  if (z) {
+    FAIL("decode_image_config: got \"%s\"", z);
+    return;
+  }
+
+  uint32_t got_width = wuffs_base__pixel_config__width(&ic.pixcfg);
+  uint32_t got_height = wuffs_base__pixel_config__height(&ic.pixcfg);
+  if ((got_width != 312) || (got_height != 442)) {
+    FAIL("dimensions: got %" PRIu32 "×%" PRIu32 ", want 312×442", got_width,
+         got_height);
+    return;
+  }
+  wuffs_base__pixel_format got_pixfmt =
+      wuffs_base__pixel_config__pixel_format(&ic.pixcfg);
+  if (got_pixfmt != WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL) {
+    FAIL("pixel_format: got 0x%08" PRIX32 ", want 0x%08" PRIX32, got_pixfmt,
+         WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL);
+    return;
+  }
+  if (!wuffs_base__image_config__first_frame_is_opaque(&ic)) {
+    FAIL("first_frame_is_opaque: got false, want true");
+    return;
+  }
+}
+
+void test_wuffs_webp_decode_input_is_a_png() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, "../../data/bricks-dither.png")) {
+    return;
+  }
+
+  wuffs_webp__decoder dec = ((wuffs_webp__decoder){});
+  wuffs_base__status z =
+      wuffs_webp__decoder__check_wuffs_version(&dec, sizeof dec, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return;
+  }
+  wuffs_base__image_config ic = ((wuffs_base__image_config){});
+  wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+
+  z = wuffs_webp__decoder__decode_image_config(&dec, &ic, src_reader);
+  if (z != wuffs_webp__error__bad_header) {
+    FAIL("decode_image_config: got \"%s\", want \"%s\"", z,
+         wuffs_webp__error__bad_header);
+    return;
+  }
+}
+
+void test_wuffs_webp_decode_lossy() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  // Only the lossless format (a "VP8L" chunk) is supported.
+  if (!read_file(&src, "../../data/hat.lossy.webp")) {
+    return;
+  }
+  const char* msg = do_wuffs_webp_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+  if (!wuffs_base__status__is_error(msg)) {
+    FAIL("got \"%s\", want an error", msg);
+    return;
+  }
+}
+
+void test_wuffs_webp_decode_many_small_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/hat.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 11,
+                            90 * 112 * 4, 0x6695FA71);
+}
+
+void test_wuffs_webp_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/pjw-thumbnail.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0,
+                            32 * 32 * 4, 0x975A603B);
+}
+
+void test_wuffs_webp_decode_rgba() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_webp_decode("../../data/hat.lossless.webp",
+                            WUFFS_BASE__PIXEL_FORMAT__RGBA_NONPREMUL, 0,
+                            90 * 112 * 4, 0x147FFA71);
+}
+
+void test_wuffs_webp_decode_truncated() {
+  CHECK_FOCUS(__func__);
+
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+
+  if (!read_file(&src, "../../data/hat.lossless.webp")) {
+    return;
+  }
+  src.meta.wi /= 2;
+  src.meta.closed = true;
+
+  const char* msg = do_wuffs_webp_decode(
+      &got, &src, WUFFS_BASE__PIXEL_FORMAT__BGRA_NONPREMUL, 0);
+  if (msg != wuffs_webp__error__not_enough_pixel_data) {
+    FAIL("got \"%s\", want \"%s\"", msg,
+         wuffs_webp__error__not_enough_pixel_data);
+    return;
+  }
+}
+
+// ---------------- Mimic Tests
+
+#ifdef WUFFS_MIMIC
+
+bool do_test_mimic_webp_decode(const char* filename) {
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  src.meta.ri = 0;
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  const char* got_msg = wuffs_webp_decode(&got, &src);
+  if (got_msg) {
+    FAIL("%s", got_msg);
+    return false;
+  }
+
+  src.meta.ri = 0;
+  wuffs_base__io_buffer want = ((wuffs_base__io_buffer){
+      .data = global_want_slice,
+  });
+  const char* want_msg = mimic_webp_decode(&want, &src);
+  if (want_msg) {
+    FAIL("%s", want_msg);
+    return false;
+  }
+
+  return io_buffers_equal("", &got, &want);
+}
+
+void test_mimic_webp_decode_bricks_color() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/bricks-color.lossless.webp");
+}
+
+void test_mimic_webp_decode_bricks_dither() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/bricks-dither.lossless.webp");
+}
+
+void test_mimic_webp_decode_bricks_gray() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/bricks-gray.lossless.webp");
+}
+
+void test_mimic_webp_decode_bricks_nodither() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/bricks-nodither.lossless.webp");
+}
+
+void test_mimic_webp_decode_harvesters() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/harvesters.lossless.webp");
+}
+
+void test_mimic_webp_decode_hat() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/hat.lossless.webp");
+}
+
+void test_mimic_webp_decode_hibiscus() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/hibiscus.lossless.webp");
+}
+
+void test_mimic_webp_decode_hippopotamus() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/hippopotamus.lossless.webp");
+}
+
+void test_mimic_webp_decode_pjw_thumbnail() {
+  CHECK_FOCUS(__func__);
+  do_test_mimic_webp_decode("../../data/pjw-thumbnail.lossless.webp");
+}
+
+#endif  // WUFFS_MIMIC
+
+// ---------------- WebP Benches
+
+bool do_bench_webp_decode(const char* (*decode_func)(wuffs_base__io_buffer*,
+                                                     wuffs_base__io_buffer*),
+                          const char* filename,
+                          uint64_t iters_unscaled) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  bench_start();
+  uint64_t n_bytes = 0;
+  uint64_t i;
+  uint64_t iters = iters_unscaled * iterscale;
+  for (i = 0; i < iters; i++) {
+    got.meta.wi = 0;
+    src.meta.ri = 0;
+    const char* error_msg = decode_func(&got, &src);
+    if (error_msg) {
+      FAIL("%s", error_msg);
+      return false;
+    }
+    n_bytes += got.meta.wi;
+  }
+  bench_finish(iters, n_bytes);
+  return true;
+}
+
+void bench_wuffs_webp_decode_29k() {
+  CHECK_FOCUS(__func__);
+  do_bench_webp_decode(wuffs_webp_decode,
+                       "../../data/bricks-color.lossless.webp", 50);
+}
+
+void bench_wuffs_webp_decode_206k() {
+  CHECK_FOCUS(__func__);
+  do_bench_webp_decode(wuffs_webp_decode, "../../data/hibiscus.lossless.webp",
+                       5);
+}
+
+void bench_wuffs_webp_decode_1466k() {
+  CHECK_FOCUS(__func__);
+  do_bench_webp_decode(wuffs_webp_decode, "../../data/harvesters.lossless.webp",
+                       1);
+}
+
+// ---------------- Mimic Benches
+
+#ifdef WUFFS_MIMIC
+
+void bench_mimic_webp_decode_29k() {
+  CHECK_FOCUS(__func__);
+  do_bench_webp_decode(mimic_webp_decode,
+                       "../../data/bricks-color.lossless.webp", 50);
+}
+
+void bench_mimic_webp_decode_206k() {
+  CHECK_FOCUS(__func__);
+  do_bench_webp_decode(mimic_webp_decode, "../../data/hibiscus.lossless.webp",
+                       5);
+}
+
+void bench_mimic_webp_decode_1466k() {
+  CHECK_FOCUS(__func__);
+  do_bench_webp_decode(mimic_webp_decode, "../../data/harvesters.lossless.webp",
+                       1);
+}
+
+#endif  // WUFFS_MIMIC
+
+// ---------------- Manifest
+
+// The empty comments forces clang-format to place one element per line.
+proc tests[] = {
+
+    test_wuffs_webp_call_sequence,            //
+    test_wuffs_webp_decode_bricks_color,      //
+    test_wuffs_webp_decode_bricks_dither,     //
+    test_wuffs_webp_decode_bricks_gray,       //
+    test_wuffs_webp_decode_bricks_nodither,   //
+    test_wuffs_webp_decode_harvesters,        //
+    test_wuffs_webp_decode_hat,               //
+    test_wuffs_webp_decode_hibiscus,          //
+    test_wuffs_webp_decode_hippopotamus,      //
+    test_wuffs_webp_decode_image_config,      //
+    test_wuffs_webp_decode_input_is_a_png,    //
+    test_wuffs_webp_decode_lossy,             //
+    test_wuffs_webp_decode_many_small_reads,  //
+    test_wuffs_webp_decode_pjw_thumbnail,     //
+    test_wuffs_webp_decode_rgba,              //
+    test_wuffs_webp_decode_truncated,         //
+
+#ifdef WUFFS_MIMIC
+
+    test_mimic_webp_decode_bricks_color,     //
+    test_mimic_webp_decode_bricks_dither,    //
+    test_mimic_webp_decode_bricks_gray,      //
+    test_mimic_webp_decode_bricks_nodither,  //
+    test_mimic_webp_decode_harvesters,       //
+    test_mimic_webp_decode_hat,              //
+    test_mimic_webp_decode_hibiscus,         //
+    test_mimic_webp_decode_hippopotamus,     //
+    test_mimic_webp_decode_pjw_thumbnail,    //
+
+#endif  // WUFFS_MIMIC
+
+    NULL,
+};
+
+// The empty comments forces clang-format to place one element per line.
+proc benches[] = {
+
+    bench_wuffs_webp_decode_29k,    //
+    bench_wuffs_webp_decode_206k,   //
+    bench_wuffs_webp_decode_1466k,  //
+
+#ifdef WUFFS_MIMIC
+
+    bench_mimic_webp_decode_29k,    //
+    bench_mimic_webp_decode_206k,   //
+    bench_mimic_webp_decode_1466k,  //
+
+#endif  // WUFFS_MIMIC
+
+    NULL,
+};
+
+int main(int argc, char** argv) {
+  proc_package_name = "std/webp";
+  return test_main(argc, argv, tests, benches);
+}
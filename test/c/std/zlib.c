@@ -205,7 +205,77 @@ void test_wuffs_zlib_decode_pi() {
   do_test_io_buffers(wuffs_zlib_decode, &zlib_pi_gt, 0, 0);
 }
 
-  // ---------------- Mimic Tests
+bool do_test_wuffs_zlib_encode(
+    const char* (*decode_func)(wuffs_base__io_buffer*,
+                               wuffs_base__io_buffer*,
+                               uint64_t,
+                               uint64_t),
+    const char* filename,
+    uint64_t wlimit,
+    uint64_t rlimit) {
+  wuffs_base__io_buffer got = ((wuffs_base__io_buffer){
+      .data = global_got_slice,
+  });
+  wuffs_base__io_buffer work = ((wuffs_base__io_buffer){
+      .data = global_work_slice,
+  });
+  wuffs_base__io_buffer src = ((wuffs_base__io_buffer){
+      .data = global_src_slice,
+  });
+  if (!read_file(&src, filename)) {
+    return false;
+  }
+
+  wuffs_zlib__encoder enc = ((wuffs_zlib__encoder){});
+  wuffs_base__status z =
+      wuffs_zlib__encoder__check_wuffs_version(&enc, sizeof enc, WUFFS_VERSION);
+  if (z) {
+    FAIL("check_wuffs_version: \"%s\"", z);
+    return false;
+  }
+  while (true) {
+    wuffs_base__io_writer work_writer = wuffs_base__io_buffer__writer(&work);
+    if (wlimit) {
+      set_writer_limit(&work_writer, wlimit);
+    }
+    wuffs_base__io_reader src_reader = wuffs_base__io_buffer__reader(&src);
+    if (rlimit) {
+      set_reader_limit(&src_reader, rlimit);
+    }
+    z = wuffs_zlib__encoder__encode(&enc, work_writer, src_reader);
+    if ((wlimit && (z == wuffs_base__suspension__short_write)) ||
+        (rlimit && (z == wuffs_base__suspension__short_read))) {
+      continue;
+    }
+    if (z) {
+      FAIL("encode: \"%s\"", z);
+      return false;
+    }
+    break;
+  }
+  work.meta.closed = true;
+
+  z = decode_func(&got, &work, 0, 0);
+  if (z) {
+    FAIL("decode: \"%s\"", z);
+    return false;
+  }
+  src.meta.ri = 0;
+  return io_buffers_equal("", &got, &src);
+}
+
+void test_wuffs_zlib_encode_midsummer() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_zlib_encode(wuffs_zlib_decode, "../../data/midsummer.txt", 0,
+                            0);
+}
+
+void test_wuffs_zlib_encode_pi_many_small_writes_reads() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_zlib_encode(wuffs_zlib_decode, "../../data/pi.txt", 41, 43);
+}
+
+// ---------------- Mimic Tests
 
 #ifdef WUFFS_MIMIC
 
@@ -219,6 +289,11 @@ void test_mimic_zlib_decode_pi() {
   do_test_io_buffers(mimic_zlib_decode, &zlib_pi_gt, 0, 0);
 }
 
+void test_mimic_zlib_decode_wuffs_encoded_pi() {
+  CHECK_FOCUS(__func__);
+  do_test_wuffs_zlib_encode(mimic_zlib_decode, "../../data/pi.txt", 0, 0);
+}
+
 #endif  // WUFFS_MIMIC
 
 // ---------------- Zlib Benches
@@ -233,7 +308,7 @@ void bench_wuffs_zlib_decode_100k() {
   do_bench_io_buffers(wuffs_zlib_decode, tc_dst, &zlib_pi_gt, 0, 0, 30);
 }
 
-  // ---------------- Mimic Benches
+// ---------------- Mimic Benches
 
 #ifdef WUFFS_MIMIC
 
@@ -254,16 +329,19 @@ void bench_mimic_zlib_decode_100k() {
 // The empty comments forces clang-format to place one element per line.
 proc tests[] = {
 
-    test_wuffs_zlib_checksum_ignore,       //
-    test_wuffs_zlib_checksum_verify_bad,   //
-    test_wuffs_zlib_checksum_verify_good,  //
-    test_wuffs_zlib_decode_midsummer,      //
-    test_wuffs_zlib_decode_pi,             //
+    test_wuffs_zlib_checksum_ignore,                    //
+    test_wuffs_zlib_checksum_verify_bad,                //
+    test_wuffs_zlib_checksum_verify_good,               //
+    test_wuffs_zlib_decode_midsummer,                   //
+    test_wuffs_zlib_decode_pi,                          //
+    test_wuffs_zlib_encode_midsummer,                   //
+    test_wuffs_zlib_encode_pi_many_small_writes_reads,  //
 
 #ifdef WUFFS_MIMIC
 
-    test_mimic_zlib_decode_midsummer,  //
-    test_mimic_zlib_decode_pi,         //
+    test_mimic_zlib_decode_midsummer,         //
+    test_mimic_zlib_decode_pi,                //
+    test_mimic_zlib_decode_wuffs_encoded_pi,  //
 
 #endif  // WUFFS_MIMIC
 
@@ -360,20 +360,28 @@ const char* copy_to_io_buffer_from_pixel_buffer(wuffs_base__io_buffer* dst,
                                                 wuffs_base__pixel_buffer* src,
                                                 wuffs_base__rect_ie_u32 r) {
   // TODO: don't assume 1 plane or WUFFS_BASE__PIXEL_SUBSAMPLING__NONE.
+  wuffs_base__pixel_format pixfmt = wuffs_base__pixel_buffer__pixel_format(src);
+  uint32_t bytes_per_pixel =
+      wuffs_base__pixel_format__bits_per_pixel(pixfmt) / 8;
+  if (bytes_per_pixel == 0) {
+    return "copy_to_io_buffer_from_pixel_buffer: unsupported pixel format";
+  }
   uint32_t p;
   for (p = 0; p < 1; p++) {
     wuffs_base__table_u8 tab = wuffs_base__pixel_buffer__plane(src, p);
     uint32_t y;
     for (y = r.min_incl_y; y < r.max_excl_y; y++) {
       wuffs_base__slice_u8 row = wuffs_base__table_u8__row(tab, y);
-      if ((r.min_incl_x >= r.max_excl_x) || (r.max_excl_x > row.len)) {
+      if ((r.min_incl_x >= r.max_excl_x) ||
+          (((uint64_t)r.max_excl_x) * bytes_per_pixel > row.len)) {
         break;
       }
-      uint32_t n = r.max_excl_x - r.min_incl_x;
+      size_t n = ((size_t)(r.max_excl_x - r.min_incl_x)) * bytes_per_pixel;
       if (n > (dst->data.len - dst->meta.wi)) {
         return "copy_to_io_buffer_from_pixel_buffer: dst buffer is too small";
       }
-      memmove(dst->data.ptr + dst->meta.wi, row.ptr + r.min_incl_x, n);
+      memmove(dst->data.ptr + dst->meta.wi,
+              row.ptr + (((size_t)r.min_incl_x) * bytes_per_pixel), n);
       dst->meta.wi += n;
     }
   }